@@ -33,6 +33,7 @@ LOCAL_SRC_FILES := $(ADDRLIB_FILES)
 LOCAL_CFLAGS := -DBRAHMA_BUILD=1
 
 LOCAL_C_INCLUDES := \
+	$(MESA_TOP)/include \
 	$(MESA_TOP)/src \
 	$(MESA_TOP)/src/amd/common \
 	$(MESA_TOP)/src/amd/addrlib \
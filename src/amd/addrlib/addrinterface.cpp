@@ -35,6 +35,157 @@
 
 #include "addrcommon.h"
 
+#include "c11/threads.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//                                    Result cache
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Number of entries of each result cache, must be a power of two
+static const UINT_32 AddrResultCacheSize = 256;
+
+/**
+***************************************************************************************************
+*   AddrSurfaceInfoKey
+*
+*   @brief
+*       Cache key of AddrComputeSurfaceInfo, the input with the tile info it points to
+***************************************************************************************************
+*/
+struct AddrSurfaceInfoKey
+{
+    ADDR_HANDLE                     hLib;
+    ADDR_COMPUTE_SURFACE_INFO_INPUT in;         ///< Input with pTileInfo cleared
+    ADDR_TILEINFO                   tileInfo;   ///< *pIn->pTileInfo, or 0's if NULL
+    BOOL_32                         hasTileInfo;
+};
+
+/**
+***************************************************************************************************
+*   AddrHtileInfoKey
+*
+*   @brief
+*       Cache key of AddrComputeHtileInfo, the input with the tile info it points to
+***************************************************************************************************
+*/
+struct AddrHtileInfoKey
+{
+    ADDR_HANDLE                     hLib;
+    ADDR_COMPUTE_HTILE_INFO_INPUT   in;         ///< Input with pTileInfo cleared
+    ADDR_TILEINFO                   tileInfo;   ///< *pIn->pTileInfo, or 0's if NULL
+    BOOL_32                         hasTileInfo;
+};
+
+/**
+***************************************************************************************************
+*   AddrDccInfoKey
+*
+*   @brief
+*       Cache key of AddrComputeDccInfo
+***************************************************************************************************
+*/
+struct AddrDccInfoKey
+{
+    ADDR_HANDLE                     hLib;
+    ADDR_COMPUTE_DCCINFO_INPUT      in;
+};
+
+/**
+***************************************************************************************************
+*   AddrResultCache
+*
+*   @brief
+*       Direct-mapped cache of the successful results of one of the compute functions.
+*
+*   @note
+*       Clients create the same surfaces over and over again, and the results only depend on
+*       the input and on the chip the handle was created for. Keys are compared bytewise and
+*       must be fully initialized, padding included. Output pointers are never cached, the
+*       tile info they point to is kept next to the output instead.
+***************************************************************************************************
+*/
+template <typename Key, typename Output>
+class AddrResultCache
+{
+public:
+    BOOL_32 Lookup(const Key* pKey, Output* pOut, ADDR_TILEINFO* pTileInfo)
+    {
+        const Entry* pEntry = &m_entries[Hash(pKey)];
+        BOOL_32 found = FALSE;
+
+        mtx_lock(&m_mutex);
+        if (pEntry->valid && (memcmp(&pEntry->key, pKey, sizeof(Key)) == 0))
+        {
+            *pOut = pEntry->out;
+            *pTileInfo = pEntry->tileInfo;
+            found = TRUE;
+        }
+        mtx_unlock(&m_mutex);
+
+        return found;
+    }
+
+    VOID Insert(const Key* pKey, const Output* pOut, const ADDR_TILEINFO* pTileInfo)
+    {
+        Entry* pEntry = &m_entries[Hash(pKey)];
+
+        mtx_lock(&m_mutex);
+        memcpy(&pEntry->key, pKey, sizeof(Key));
+        pEntry->out = *pOut;
+        pEntry->tileInfo = *pTileInfo;
+        pEntry->valid = TRUE;
+        mtx_unlock(&m_mutex);
+    }
+
+    /// Drops the results of a handle that is being destroyed
+    VOID Invalidate(ADDR_HANDLE hLib)
+    {
+        mtx_lock(&m_mutex);
+        for (UINT_32 i = 0; i < AddrResultCacheSize; i++)
+        {
+            if (m_entries[i].key.hLib == hLib)
+            {
+                m_entries[i].valid = FALSE;
+            }
+        }
+        mtx_unlock(&m_mutex);
+    }
+
+private:
+    struct Entry
+    {
+        Key             key;
+        Output          out;
+        ADDR_TILEINFO   tileInfo;
+        BOOL_32         valid;
+    };
+
+    static UINT_32 Hash(const Key* pKey)
+    {
+        // FNV-1a
+        const UINT_8* pData = reinterpret_cast<const UINT_8*>(pKey);
+        UINT_32 hash = 2166136261u;
+
+        for (UINT_32 i = 0; i < sizeof(Key); i++)
+        {
+            hash = (hash ^ pData[i]) * 16777619u;
+        }
+
+        return hash & (AddrResultCacheSize - 1);
+    }
+
+    Entry m_entries[AddrResultCacheSize];
+
+    static mtx_t m_mutex;
+};
+
+template <typename Key, typename Output>
+mtx_t AddrResultCache<Key, Output>::m_mutex = _MTX_INITIALIZER_NP;
+
+static AddrResultCache<AddrSurfaceInfoKey, ADDR_COMPUTE_SURFACE_INFO_OUTPUT> s_surfaceInfoCache;
+static AddrResultCache<AddrHtileInfoKey, ADDR_COMPUTE_HTILE_INFO_OUTPUT> s_htileInfoCache;
+static AddrResultCache<AddrDccInfoKey, ADDR_COMPUTE_DCCINFO_OUTPUT> s_dccInfoCache;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 //                               Create/Destroy/Config functions
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -83,6 +234,11 @@ ADDR_E_RETURNCODE ADDR_API AddrDestroy(
     {
         AddrLib* pLib = AddrLib::GetAddrLib(hLib);
         pLib->Destroy();
+
+        // A new handle may be created at the same address
+        s_surfaceInfoCache.Invalidate(hLib);
+        s_htileInfoCache.Invalidate(hLib);
+        s_dccInfoCache.Invalidate(hLib);
     }
     else
     {
@@ -120,7 +276,42 @@ ADDR_E_RETURNCODE ADDR_API AddrComputeSurfaceInfo(
 
     if (pLib != NULL)
     {
+        // Stereo info is only filled on request, and the tile info is needed to replay a result
+        BOOL_32 cacheable = (pIn->size == sizeof(ADDR_COMPUTE_SURFACE_INFO_INPUT)) &&
+                            (pOut->size == sizeof(ADDR_COMPUTE_SURFACE_INFO_OUTPUT)) &&
+                            (pIn->flags.qbStereo == FALSE) &&
+                            (pOut->pTileInfo != NULL);
+        AddrSurfaceInfoKey key;
+
+        if (cacheable)
+        {
+            memset(&key, 0, sizeof(key));
+            key.hLib = hLib;
+            memcpy(&key.in, pIn, sizeof(key.in));
+            key.in.pTileInfo = NULL;
+            if (pIn->pTileInfo != NULL)
+            {
+                key.tileInfo = *pIn->pTileInfo;
+                key.hasTileInfo = TRUE;
+            }
+
+            ADDR_TILEINFO* pTileInfo = pOut->pTileInfo;
+            ADDR_QBSTEREOINFO* pStereoInfo = pOut->pStereoInfo;
+
+            if (s_surfaceInfoCache.Lookup(&key, pOut, pTileInfo))
+            {
+                pOut->pTileInfo = pTileInfo;
+                pOut->pStereoInfo = pStereoInfo;
+                return ADDR_OK;
+            }
+        }
+
         returnCode = pLib->ComputeSurfaceInfo(pIn, pOut);
+
+        if (cacheable && (returnCode == ADDR_OK))
+        {
+            s_surfaceInfoCache.Insert(&key, pOut, pOut->pTileInfo);
+        }
     }
     else
     {
@@ -164,6 +355,40 @@ ADDR_E_RETURNCODE ADDR_API AddrComputeSurfaceAddrFromCoord(
     return returnCode;
 }
 
+/**
+***************************************************************************************************
+*   AddrComputeSurfaceAddrsFromCoords
+*
+*   @brief
+*       Compute surface addresses of a rectangle of coordinates
+*
+*   @return
+*       ADDR_OK if successful, otherwise an error code of ADDR_E_RETURNCODE
+***************************************************************************************************
+*/
+ADDR_E_RETURNCODE ADDR_API AddrComputeSurfaceAddrsFromCoords(
+    ADDR_HANDLE                                         hLib, ///< [in] address lib handle
+    const ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_INPUT*   pIn,  ///< [in] surface info and rectangle
+    ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_OUTPUT*        pOut) ///< [out] surface addresses
+{
+    AddrLib* pLib = AddrLib::GetAddrLib(hLib);
+
+    ADDR_E_RETURNCODE returnCode = ADDR_OK;
+
+    if (pLib != NULL)
+    {
+        returnCode = pLib->ComputeSurfaceAddrsFromCoords(pIn, pOut);
+    }
+    else
+    {
+        returnCode = ADDR_ERROR;
+    }
+
+    return returnCode;
+}
+
+
+
 /**
 ***************************************************************************************************
 *   AddrComputeSurfaceCoordFromAddr
@@ -224,7 +449,35 @@ ADDR_E_RETURNCODE ADDR_API AddrComputeHtileInfo(
 
     if (pLib != NULL)
     {
+        BOOL_32 cacheable = (pIn->size == sizeof(ADDR_COMPUTE_HTILE_INFO_INPUT)) &&
+                            (pOut->size == sizeof(ADDR_COMPUTE_HTILE_INFO_OUTPUT));
+        AddrHtileInfoKey key;
+        ADDR_TILEINFO tileInfo = {0};
+
+        if (cacheable)
+        {
+            memset(&key, 0, sizeof(key));
+            key.hLib = hLib;
+            memcpy(&key.in, pIn, sizeof(key.in));
+            key.in.pTileInfo = NULL;
+            if (pIn->pTileInfo != NULL)
+            {
+                key.tileInfo = *pIn->pTileInfo;
+                key.hasTileInfo = TRUE;
+            }
+
+            if (s_htileInfoCache.Lookup(&key, pOut, &tileInfo))
+            {
+                return ADDR_OK;
+            }
+        }
+
         returnCode = pLib->ComputeHtileInfo(pIn, pOut);
+
+        if (cacheable && (returnCode == ADDR_OK))
+        {
+            s_htileInfoCache.Insert(&key, pOut, &tileInfo);
+        }
     }
     else
     {
@@ -531,7 +784,29 @@ ADDR_E_RETURNCODE ADDR_API AddrComputeDccInfo(
 
     if (pLib != NULL)
     {
+       BOOL_32 cacheable = (pIn->size == sizeof(ADDR_COMPUTE_DCCINFO_INPUT)) &&
+                           (pOut->size == sizeof(ADDR_COMPUTE_DCCINFO_OUTPUT));
+       AddrDccInfoKey key;
+       ADDR_TILEINFO tileInfo = {0};
+
+       if (cacheable)
+       {
+          memset(&key, 0, sizeof(key));
+          key.hLib = hLib;
+          memcpy(&key.in, pIn, sizeof(key.in));
+
+          if (s_dccInfoCache.Lookup(&key, pOut, &tileInfo))
+          {
+             return ADDR_OK;
+          }
+       }
+
        returnCode = pLib->ComputeDccInfo(pIn, pOut);
+
+       if (cacheable && (returnCode == ADDR_OK))
+       {
+          s_dccInfoCache.Insert(&key, pOut, &tileInfo);
+       }
     }
     else
     {
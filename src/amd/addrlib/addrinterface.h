@@ -669,6 +669,59 @@ ADDR_E_RETURNCODE ADDR_API AddrComputeSurfaceAddrFromCoord(
 
 
 
+/**
+***************************************************************************************************
+*   ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_INPUT
+*
+*   @brief
+*       Input structure for AddrComputeSurfaceAddrsFromCoords
+***************************************************************************************************
+*/
+typedef struct _ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_INPUT
+{
+    UINT_32         size;               ///< Size of this structure in bytes
+
+    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT surf;  ///< Surface parameters, x and y are the
+                                                    ///  coordinates of the top left element
+    UINT_32         width;              ///< Number of coordinates per row
+    UINT_32         height;             ///< Number of rows
+} ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_INPUT;
+
+/**
+***************************************************************************************************
+*   ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_OUTPUT
+*
+*   @brief
+*       Output structure for AddrComputeSurfaceAddrsFromCoords
+***************************************************************************************************
+*/
+typedef struct _ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_OUTPUT
+{
+    UINT_32         size;               ///< Size of this structure in bytes
+
+    UINT_64*        pAddr;              ///< width * height byte addresses, row by row. Client
+                                        ///  must provide the array
+    UINT_32*        pBitPosition;       ///< Bit positions within the addresses, 0-7, in the same
+                                        ///  order. May be NULL if surface bpp >= 8
+} ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_OUTPUT;
+
+/**
+***************************************************************************************************
+*   AddrComputeSurfaceAddrsFromCoords
+*
+*   @brief
+*       Compute surface addresses of a rectangle of coordinates. This is equivalent to calling
+*       AddrComputeSurfaceAddrFromCoord for each coordinate, but the tile config is only set up
+*       and validated once.
+***************************************************************************************************
+*/
+ADDR_E_RETURNCODE ADDR_API AddrComputeSurfaceAddrsFromCoords(
+    ADDR_HANDLE                                         hLib,
+    const ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_INPUT*   pIn,
+    ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_OUTPUT*        pOut);
+
+
+
 /**
 ***************************************************************************************************
 *   ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT
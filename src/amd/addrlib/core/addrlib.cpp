@@ -684,29 +684,7 @@ ADDR_E_RETURNCODE AddrLib::ComputeSurfaceAddrFromCoord(
             // Use temp tile info for calcalation
             input.pTileInfo = &tileInfoNull;
 
-            const ADDR_SURFACE_FLAGS flags = {{0}};
-            UINT_32 numSamples = GetNumFragments(pIn->numSamples, pIn->numFrags);
-
-            // Try finding a macroModeIndex
-            INT_32 macroModeIndex = HwlComputeMacroModeIndex(input.tileIndex,
-                                                             flags,
-                                                             input.bpp,
-                                                             numSamples,
-                                                             input.pTileInfo,
-                                                             &input.tileMode,
-                                                             &input.tileType);
-
-            // If macroModeIndex is not needed, then call HwlSetupTileCfg to get tile info
-            if (macroModeIndex == TileIndexNoMacroIndex)
-            {
-                returnCode = HwlSetupTileCfg(input.tileIndex, macroModeIndex,
-                                             input.pTileInfo, &input.tileMode, &input.tileType);
-            }
-            // If macroModeIndex is invalid, then assert this is not macro tiled
-            else if (macroModeIndex == TileIndexInvalid)
-            {
-                ADDR_ASSERT(!IsMacroTiled(input.tileMode));
-            }
+            returnCode = SetupSurfaceAddrFromCoordTileCfg(&input);
 
             // Change the input structure
             pIn = &input;
@@ -726,6 +704,125 @@ ADDR_E_RETURNCODE AddrLib::ComputeSurfaceAddrFromCoord(
     return returnCode;
 }
 
+/**
+***************************************************************************************************
+*   AddrLib::ComputeSurfaceAddrsFromCoords
+*
+*   @brief
+*       Interface function stub of AddrComputeSurfaceAddrsFromCoords.
+*
+*   @return
+*       ADDR_E_RETURNCODE
+***************************************************************************************************
+*/
+ADDR_E_RETURNCODE AddrLib::ComputeSurfaceAddrsFromCoords(
+    const ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_INPUT*   pIn,    ///< [in] input structure
+    ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_OUTPUT*        pOut    ///< [out] output structure
+    ) const
+{
+    ADDR_E_RETURNCODE returnCode = ADDR_OK;
+
+    if (GetFillSizeFieldsFlags() == TRUE)
+    {
+        if ((pIn->size != sizeof(ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_INPUT)) ||
+            (pIn->surf.size != sizeof(ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT)) ||
+            (pOut->size != sizeof(ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_OUTPUT)))
+        {
+            returnCode = ADDR_PARAMSIZEMISMATCH;
+        }
+    }
+
+    if ((returnCode == ADDR_OK) && (pOut->pAddr == NULL))
+    {
+        returnCode = ADDR_INVALIDPARAMS;
+    }
+
+    if (returnCode == ADDR_OK)
+    {
+        ADDR_TILEINFO tileInfoNull;
+        ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT input = pIn->surf;
+        ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT output = {0};
+
+        output.size = sizeof(output);
+
+        // The tile config doesn't depend on the coordinates, so only look it up once
+        if (UseTileIndex(input.tileIndex))
+        {
+            input.pTileInfo = &tileInfoNull;
+
+            returnCode = SetupSurfaceAddrFromCoordTileCfg(&input);
+        }
+
+        for (UINT_32 y = 0; (y < pIn->height) && (returnCode == ADDR_OK); y++)
+        {
+            UINT_32 i = y * pIn->width;
+
+            input.y = pIn->surf.y + y;
+
+            for (UINT_32 x = 0; (x < pIn->width) && (returnCode == ADDR_OK); x++, i++)
+            {
+                input.x = pIn->surf.x + x;
+
+                returnCode = HwlComputeSurfaceAddrFromCoord(&input, &output);
+
+                pOut->pAddr[i] = output.addr;
+                if (pOut->pBitPosition != NULL)
+                {
+                    pOut->pBitPosition[i] = output.bitPosition;
+                }
+            }
+        }
+    }
+
+    return returnCode;
+}
+
+/**
+***************************************************************************************************
+*   AddrLib::SetupSurfaceAddrFromCoordTileCfg
+*
+*   @brief
+*       Replace the tile index of an AddrComputeSurfaceAddrFromCoord input by the tile mode,
+*       tile type and tile info it stands for. pIn->pTileInfo must point to storage for the
+*       latter.
+*
+*   @return
+*       ADDR_E_RETURNCODE
+***************************************************************************************************
+*/
+ADDR_E_RETURNCODE AddrLib::SetupSurfaceAddrFromCoordTileCfg(
+    ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn   ///< [in,out] input structure
+    ) const
+{
+    ADDR_E_RETURNCODE returnCode = ADDR_OK;
+
+    const ADDR_SURFACE_FLAGS flags = {{0}};
+    UINT_32 numSamples = GetNumFragments(pIn->numSamples, pIn->numFrags);
+
+    // Try finding a macroModeIndex
+    INT_32 macroModeIndex = HwlComputeMacroModeIndex(pIn->tileIndex,
+                                                     flags,
+                                                     pIn->bpp,
+                                                     numSamples,
+                                                     pIn->pTileInfo,
+                                                     &pIn->tileMode,
+                                                     &pIn->tileType);
+
+    // If macroModeIndex is not needed, then call HwlSetupTileCfg to get tile info
+    if (macroModeIndex == TileIndexNoMacroIndex)
+    {
+        returnCode = HwlSetupTileCfg(pIn->tileIndex, macroModeIndex,
+                                     pIn->pTileInfo, &pIn->tileMode, &pIn->tileType);
+    }
+    // If macroModeIndex is invalid, then assert this is not macro tiled
+    else if (macroModeIndex == TileIndexInvalid)
+    {
+        ADDR_ASSERT(!IsMacroTiled(pIn->tileMode));
+    }
+
+    return returnCode;
+}
+
 /**
 ***************************************************************************************************
 *   AddrLib::ComputeSurfaceCoordFromAddr
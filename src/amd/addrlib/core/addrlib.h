@@ -221,6 +221,10 @@ public:
         const ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn,
         ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_OUTPUT* pOut) const;
 
+    ADDR_E_RETURNCODE ComputeSurfaceAddrsFromCoords(
+        const ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_INPUT* pIn,
+        ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_OUTPUT* pOut) const;
+
     ADDR_E_RETURNCODE ComputeSurfaceCoordFromAddr(
         const ADDR_COMPUTE_SURFACE_COORDFROMADDR_INPUT*  pIn,
         ADDR_COMPUTE_SURFACE_COORDFROMADDR_OUTPUT* pOut) const;
@@ -655,6 +659,9 @@ private:
     BOOL_32 DegradeBaseLevel(
         const ADDR_COMPUTE_SURFACE_INFO_INPUT* pIn, AddrTileMode* pTileMode) const;
 
+    ADDR_E_RETURNCODE SetupSurfaceAddrFromCoordTileCfg(
+        ADDR_COMPUTE_SURFACE_ADDRFROMCOORD_INPUT* pIn) const;
+
 protected:
     AddrLibClass        m_class;        ///< Store class type (HWL type)
 
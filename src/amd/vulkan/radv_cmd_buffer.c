@@ -510,22 +510,53 @@ radv_emit_fragment_shader(struct radv_cmd_buffer *cmd_buffer,
 	}
 }
 
+/* Whether a group of precomputed registers differs between two pipelines. */
+#define radv_pipeline_state_changed(old, new, state) \
+	(!(old) || memcmp(&(old)->graphics.state, &(new)->graphics.state, \
+			  sizeof((new)->graphics.state)) != 0)
+
 static void
 radv_emit_graphics_pipeline(struct radv_cmd_buffer *cmd_buffer,
 			    struct radv_pipeline *pipeline)
 {
-	if (!pipeline || cmd_buffer->state.emitted_pipeline == pipeline)
-		return;
+	struct radv_pipeline *old_pipeline = cmd_buffer->state.emitted_pipeline;
+	bool vs_changed, ps_changed;
 
-	radv_emit_graphics_depth_stencil_state(cmd_buffer, pipeline);
-	radv_emit_graphics_blend_state(cmd_buffer, pipeline);
-	radv_emit_graphics_raster_state(cmd_buffer, pipeline);
-	radv_update_multisample_state(cmd_buffer, pipeline);
-	radv_emit_vertex_shader(cmd_buffer, pipeline);
-	radv_emit_fragment_shader(cmd_buffer, pipeline);
+	if (!pipeline || old_pipeline == pipeline)
+		return;
 
-	radeon_set_context_reg(cmd_buffer->cs, R_028A94_VGT_MULTI_PRIM_IB_RESET_EN,
-			       pipeline->graphics.prim_restart_enable);
+	/* Only emit the state groups that differ from the previous pipeline
+	 * of this command buffer; consecutive pipelines usually share most of
+	 * them, and often their shaders.
+	 */
+	vs_changed = !old_pipeline ||
+		     old_pipeline->shaders[MESA_SHADER_VERTEX] != pipeline->shaders[MESA_SHADER_VERTEX];
+	ps_changed = !old_pipeline ||
+		     old_pipeline->shaders[MESA_SHADER_FRAGMENT] != pipeline->shaders[MESA_SHADER_FRAGMENT];
+
+	if (radv_pipeline_state_changed(old_pipeline, pipeline, ds))
+		radv_emit_graphics_depth_stencil_state(cmd_buffer, pipeline);
+	if (radv_pipeline_state_changed(old_pipeline, pipeline, blend))
+		radv_emit_graphics_blend_state(cmd_buffer, pipeline);
+	if (radv_pipeline_state_changed(old_pipeline, pipeline, raster))
+		radv_emit_graphics_raster_state(cmd_buffer, pipeline);
+	if (radv_pipeline_state_changed(old_pipeline, pipeline, ms))
+		radv_update_multisample_state(cmd_buffer, pipeline);
+
+	/* PA_CL_VS_OUT_CNTL comes from the raster state. */
+	if (vs_changed || radv_pipeline_state_changed(old_pipeline, pipeline, raster))
+		radv_emit_vertex_shader(cmd_buffer, pipeline);
+
+	/* The PS inputs depend on the VS outputs, and the export formats and
+	 * masks come from the blend state.
+	 */
+	if (vs_changed || ps_changed ||
+	    radv_pipeline_state_changed(old_pipeline, pipeline, blend))
+		radv_emit_fragment_shader(cmd_buffer, pipeline);
+
+	if (radv_pipeline_state_changed(old_pipeline, pipeline, prim_restart_enable))
+		radeon_set_context_reg(cmd_buffer->cs, R_028A94_VGT_MULTI_PRIM_IB_RESET_EN,
+				       pipeline->graphics.prim_restart_enable);
 
 	cmd_buffer->state.emitted_pipeline = pipeline;
 }
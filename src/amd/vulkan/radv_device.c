@@ -32,6 +32,7 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include "radv_private.h"
+#include "util/disk_cache.h"
 #include "util/strtod.h"
 
 #include <xf86drm.h>
@@ -130,6 +131,8 @@ radv_physical_device_init(struct radv_physical_device *device,
 		goto fail;
 	}
 
+	device->disk_cache = disk_cache_create();
+
 	fprintf(stderr, "WARNING: radv is not a conformant vulkan implementation, testing use only.\n");
 	device->name = device->rad_info.name;
 	close(fd);
@@ -143,6 +146,8 @@ fail:
 static void
 radv_physical_device_finish(struct radv_physical_device *device)
 {
+	if (device->disk_cache)
+		disk_cache_destroy(device->disk_cache);
 	radv_finish_wsi(device);
 	device->ws->destroy(device->ws);
 }
@@ -626,6 +631,14 @@ radv_queue_finish(struct radv_queue *queue)
 {
 }
 
+static void
+radv_device_finish_target_machines(struct radv_device *device)
+{
+	for (unsigned i = 0; i < device->num_idle_tms; i++)
+		LLVMDisposeTargetMachine(device->idle_tms[i]);
+	pthread_mutex_destroy(&device->tm_mutex);
+}
+
 VkResult radv_CreateDevice(
 	VkPhysicalDevice                            physicalDevice,
 	const VkDeviceCreateInfo*                   pCreateInfo,
@@ -673,8 +686,26 @@ VkResult radv_CreateDevice(
 
 	radv_queue_init(device, &device->queue);
 
+	device->mem_cache.alloc = device->alloc;
+	radv_pipeline_cache_init(&device->mem_cache, device);
+
+	pthread_mutex_init(&device->tm_mutex, NULL);
+	device->num_idle_tms = 0;
+
+	/* Each pipeline compiles with its own LLVM context and target
+	 * machine, so one thread per CPU can work on a batch at once. */
+	long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	device->has_pipeline_queue =
+		num_cpus > 1 &&
+		util_queue_init(&device->pipeline_queue, "radv_pipeline",
+				32, num_cpus);
+
 	result = radv_device_init_meta(device);
 	if (result != VK_SUCCESS) {
+		if (device->has_pipeline_queue)
+			util_queue_destroy(&device->pipeline_queue);
+		radv_device_finish_target_machines(device);
+		radv_pipeline_cache_finish(&device->mem_cache);
 		device->ws->ctx_destroy(device->hw_ctx);
 		goto fail_free;
 	}
@@ -707,6 +738,10 @@ void radv_DestroyDevice(
 	device->ws->ctx_destroy(device->hw_ctx);
 	radv_queue_finish(&device->queue);
 	radv_device_finish_meta(device);
+	if (device->has_pipeline_queue)
+		util_queue_destroy(&device->pipeline_queue);
+	radv_device_finish_target_machines(device);
+	radv_pipeline_cache_finish(&device->mem_cache);
 
 	vk_free(&device->alloc, device);
 }
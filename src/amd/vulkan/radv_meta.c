@@ -280,10 +280,41 @@ fail:
 	unlink(path2);
 }
 
+static const struct {
+	VkResult (*init)(struct radv_device *device);
+	void (*finish)(struct radv_device *device);
+} radv_meta_states[] = {
+	{ radv_device_init_meta_clear_state, radv_device_finish_meta_clear_state },
+	{ radv_device_init_meta_resolve_state, radv_device_finish_meta_resolve_state },
+	{ radv_device_init_meta_blit_state, radv_device_finish_meta_blit_state },
+	{ radv_device_init_meta_blit2d_state, radv_device_finish_meta_blit2d_state },
+	{ radv_device_init_meta_bufimage_state, radv_device_finish_meta_bufimage_state },
+	{ radv_device_init_meta_depth_decomp_state, radv_device_finish_meta_depth_decomp_state },
+	{ radv_device_init_meta_buffer_state, radv_device_finish_meta_buffer_state },
+	{ radv_device_init_meta_fast_clear_flush_state, radv_device_finish_meta_fast_clear_flush_state },
+	{ radv_device_init_meta_resolve_compute_state, radv_device_finish_meta_resolve_compute_state },
+};
+
+struct radv_meta_init_job {
+	struct util_queue_fence fence;
+	struct radv_device *device;
+	unsigned index;
+	VkResult result;
+};
+
+static void
+radv_meta_init_job(void *data, int thread_index)
+{
+	struct radv_meta_init_job *job = data;
+
+	job->result = radv_meta_states[job->index].init(job->device);
+}
+
 VkResult
 radv_device_init_meta(struct radv_device *device)
 {
-	VkResult result;
+	struct radv_meta_init_job jobs[ARRAY_SIZE(radv_meta_states)];
+	VkResult result = VK_SUCCESS;
 
 	device->meta_state.alloc = (VkAllocationCallbacks) {
 		.pUserData = device,
@@ -296,76 +327,50 @@ radv_device_init_meta(struct radv_device *device)
 	radv_pipeline_cache_init(&device->meta_state.cache, device);
 	radv_load_meta_pipeline(device);
 
-	result = radv_device_init_meta_clear_state(device);
-	if (result != VK_SUCCESS)
-		goto fail_clear;
-
-	result = radv_device_init_meta_resolve_state(device);
-	if (result != VK_SUCCESS)
-		goto fail_resolve;
-
-	result = radv_device_init_meta_blit_state(device);
-	if (result != VK_SUCCESS)
-		goto fail_blit;
-
-	result = radv_device_init_meta_blit2d_state(device);
-	if (result != VK_SUCCESS)
-		goto fail_blit2d;
-
-	result = radv_device_init_meta_bufimage_state(device);
-	if (result != VK_SUCCESS)
-		goto fail_bufimage;
-
-	result = radv_device_init_meta_depth_decomp_state(device);
-	if (result != VK_SUCCESS)
-		goto fail_depth_decomp;
-
-	result = radv_device_init_meta_buffer_state(device);
-	if (result != VK_SUCCESS)
-		goto fail_buffer;
-
-	result = radv_device_init_meta_fast_clear_flush_state(device);
-	if (result != VK_SUCCESS)
-		goto fail_fast_clear;
-
-	result = radv_device_init_meta_resolve_compute_state(device);
-	if (result != VK_SUCCESS)
-		goto fail_resolve_compute;
-	return VK_SUCCESS;
-
-fail_resolve_compute:
-	radv_device_finish_meta_fast_clear_flush_state(device);
-fail_fast_clear:
-	radv_device_finish_meta_buffer_state(device);
-fail_buffer:
-	radv_device_finish_meta_depth_decomp_state(device);
-fail_depth_decomp:
-	radv_device_finish_meta_bufimage_state(device);
-fail_bufimage:
-	radv_device_finish_meta_blit2d_state(device);
-fail_blit2d:
-	radv_device_finish_meta_blit_state(device);
-fail_blit:
-	radv_device_finish_meta_resolve_state(device);
-fail_resolve:
-	radv_device_finish_meta_clear_state(device);
-fail_clear:
-	radv_pipeline_cache_finish(&device->meta_state.cache);
+	/* The meta states are independent of each other, and compiling their
+	 * shaders is most of the device creation time, so build them all at
+	 * once on the pipeline queue. Each init function cleans up after
+	 * itself when it fails.
+	 */
+	for (unsigned i = 0; i < ARRAY_SIZE(radv_meta_states); i++) {
+		jobs[i].device = device;
+		jobs[i].index = i;
+
+		if (device->has_pipeline_queue) {
+			util_queue_fence_init(&jobs[i].fence);
+			util_queue_add_job(&device->pipeline_queue, &jobs[i],
+					   &jobs[i].fence, radv_meta_init_job, NULL);
+		} else {
+			radv_meta_init_job(&jobs[i], 0);
+		}
+	}
+
+	for (unsigned i = 0; i < ARRAY_SIZE(radv_meta_states); i++) {
+		if (device->has_pipeline_queue) {
+			util_queue_job_wait(&jobs[i].fence);
+			util_queue_fence_destroy(&jobs[i].fence);
+		}
+
+		if (jobs[i].result != VK_SUCCESS && result == VK_SUCCESS)
+			result = jobs[i].result;
+	}
+
+	if (result != VK_SUCCESS) {
+		for (unsigned i = 0; i < ARRAY_SIZE(radv_meta_states); i++) {
+			if (jobs[i].result == VK_SUCCESS)
+				radv_meta_states[i].finish(device);
+		}
+		radv_pipeline_cache_finish(&device->meta_state.cache);
+	}
+
 	return result;
 }
 
 void
 radv_device_finish_meta(struct radv_device *device)
 {
-	radv_device_finish_meta_clear_state(device);
-	radv_device_finish_meta_resolve_state(device);
-	radv_device_finish_meta_blit_state(device);
-	radv_device_finish_meta_blit2d_state(device);
-	radv_device_finish_meta_bufimage_state(device);
-	radv_device_finish_meta_depth_decomp_state(device);
-	radv_device_finish_meta_buffer_state(device);
-	radv_device_finish_meta_fast_clear_flush_state(device);
-	radv_device_finish_meta_resolve_compute_state(device);
+	for (unsigned i = 0; i < ARRAY_SIZE(radv_meta_states); i++)
+		radv_meta_states[i].finish(device);
 
 	radv_store_meta_pipeline(device);
 	radv_pipeline_cache_finish(&device->meta_state.cache);
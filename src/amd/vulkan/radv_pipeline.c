@@ -59,6 +59,7 @@ static const struct nir_shader_compiler_options nir_options = {
 	.lower_unpack_unorm_4x8 = true,
 	.lower_extract_byte = true,
 	.lower_extract_word = true,
+	.max_unroll_iterations = 32,
 };
 
 VkResult radv_CreateShaderModule(
@@ -139,7 +140,10 @@ radv_optimize_nir(struct nir_shader *shader)
                 NIR_PASS(progress, shader, nir_opt_remove_phis);
                 NIR_PASS(progress, shader, nir_opt_dce);
                 NIR_PASS(progress, shader, nir_opt_dead_cf);
+                NIR_PASS(progress, shader, nir_opt_loop_unroll);
+                NIR_PASS(progress, shader, nir_opt_licm);
                 NIR_PASS(progress, shader, nir_opt_cse);
+                NIR_PASS(progress, shader, nir_opt_vectorize_io);
                 NIR_PASS(progress, shader, nir_opt_peephole_select, 8);
                 NIR_PASS(progress, shader, nir_opt_algebraic);
                 NIR_PASS(progress, shader, nir_opt_constant_folding);
@@ -342,6 +346,35 @@ void radv_shader_variant_destroy(struct radv_device *device,
 	free(variant);
 }
 
+static LLVMTargetMachineRef
+radv_get_target_machine(struct radv_device *device)
+{
+	LLVMTargetMachineRef tm = NULL;
+
+	pthread_mutex_lock(&device->tm_mutex);
+	if (device->num_idle_tms)
+		tm = device->idle_tms[--device->num_idle_tms];
+	pthread_mutex_unlock(&device->tm_mutex);
+
+	if (!tm)
+		tm = ac_create_target_machine(device->instance->physicalDevice.rad_info.family);
+	return tm;
+}
+
+static void
+radv_put_target_machine(struct radv_device *device, LLVMTargetMachineRef tm)
+{
+	pthread_mutex_lock(&device->tm_mutex);
+	if (device->num_idle_tms < ARRAY_SIZE(device->idle_tms)) {
+		device->idle_tms[device->num_idle_tms++] = tm;
+		tm = NULL;
+	}
+	pthread_mutex_unlock(&device->tm_mutex);
+
+	if (tm)
+		LLVMDisposeTargetMachine(tm);
+}
+
 static
 struct radv_shader_variant *radv_shader_variant_create(struct radv_device *device,
                                                        struct nir_shader *shader,
@@ -367,10 +400,10 @@ struct radv_shader_variant *radv_shader_variant_create(struct radv_device *devic
 	options.unsafe_math = env_var_as_boolean("RADV_UNSAFE_MATH", false);
 	options.family = chip_family;
 	options.chip_class = device->instance->physicalDevice.rad_info.chip_class;
-	tm = ac_create_target_machine(chip_family);
+	tm = radv_get_target_machine(device);
 	ac_compile_nir_shader(tm, &binary, &variant->config,
 			      &variant->info, shader, &options, dump);
-	LLVMDisposeTargetMachine(tm);
+	radv_put_target_machine(device, tm);
 
 	variant->code_size = binary.code_size;
 	bool scratch_enabled = variant->config.scratch_bytes_per_wave > 0;
@@ -461,11 +494,27 @@ radv_pipeline_compile(struct radv_pipeline *pipeline,
 			return variant;
 	}
 
-	nir = radv_shader_compile_to_nir(pipeline->device,
-				         module, entrypoint, stage,
-					 spec_info, dump);
-	if (nir == NULL)
-		return NULL;
+	/* Shaders handed to us as NIR (meta) are not worth caching. */
+	unsigned char nir_sha1[20];
+	nir = NULL;
+	if (cache && !module->nir) {
+		radv_hash_nir(nir_sha1, module, entrypoint, stage, spec_info);
+		nir = radv_pipeline_cache_search_nir(cache, nir_sha1,
+						     &nir_options);
+		if (nir && dump)
+			nir_print_shader(nir, stderr);
+	}
+
+	if (!nir) {
+		nir = radv_shader_compile_to_nir(pipeline->device,
+						 module, entrypoint, stage,
+						 spec_info, dump);
+		if (nir == NULL)
+			return NULL;
+
+		if (cache && !module->nir)
+			radv_pipeline_cache_insert_nir(cache, nir_sha1, nir);
+	}
 
 	variant = radv_shader_variant_create(pipeline->device, nir, layout, key,
 					     &code, &code_size, dump);
@@ -1421,6 +1470,9 @@ radv_graphics_pipeline_create(
 	struct radv_pipeline *pipeline;
 	VkResult result;
 
+	if (!cache)
+		cache = &device->mem_cache;
+
 	pipeline = vk_alloc2(&device->alloc, pAllocator, sizeof(*pipeline), 8,
 			       VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
 	if (pipeline == NULL)
@@ -1439,6 +1491,102 @@ radv_graphics_pipeline_create(
 	return VK_SUCCESS;
 }
 
+struct radv_pipeline_job {
+	struct util_queue_fence fence;
+	VkDevice device;
+	VkPipelineCache cache;
+	const void *create_info;
+	const VkAllocationCallbacks *alloc;
+	VkPipeline *pipeline;
+	VkResult result;
+};
+
+/* Creates the pipelines of a vkCreate*Pipelines call, on the device's
+ * pipeline queue when there is more than one. The pipeline caches only
+ * hold their lock around table accesses, so the compiles don't serialize
+ * on them.
+ */
+static VkResult
+radv_create_pipelines(VkDevice _device,
+		      VkPipelineCache pipelineCache,
+		      uint32_t count,
+		      const void *create_infos,
+		      size_t create_info_size,
+		      util_queue_execute_func execute,
+		      const VkAllocationCallbacks *pAllocator,
+		      VkPipeline *pPipelines)
+{
+	RADV_FROM_HANDLE(radv_device, device, _device);
+	struct radv_pipeline_job *jobs;
+	VkResult result = VK_SUCCESS;
+	bool threaded = count > 1 && device->has_pipeline_queue;
+
+	if (!count)
+		return VK_SUCCESS;
+
+	jobs = vk_alloc2(&device->alloc, pAllocator, count * sizeof(*jobs), 8,
+			 VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+	if (!jobs)
+		return vk_error(VK_ERROR_OUT_OF_HOST_MEMORY);
+
+	for (unsigned i = 0; i < count; i++) {
+		struct radv_pipeline_job *job = &jobs[i];
+
+		job->device = _device;
+		job->cache = pipelineCache;
+		job->create_info = (const char *)create_infos + i * create_info_size;
+		job->alloc = pAllocator;
+		job->pipeline = &pPipelines[i];
+		job->result = VK_SUCCESS;
+
+		if (threaded) {
+			util_queue_fence_init(&job->fence);
+			util_queue_add_job(&device->pipeline_queue, job,
+					   &job->fence, execute, NULL);
+		} else {
+			execute(job, 0);
+			if (job->result != VK_SUCCESS) {
+				count = i + 1;
+				break;
+			}
+		}
+	}
+
+	if (threaded) {
+		for (unsigned i = 0; i < count; i++) {
+			util_queue_job_wait(&jobs[i].fence);
+			util_queue_fence_destroy(&jobs[i].fence);
+		}
+	}
+
+	for (unsigned i = 0; i < count; i++) {
+		if (jobs[i].result != VK_SUCCESS) {
+			result = jobs[i].result;
+			break;
+		}
+	}
+
+	if (result != VK_SUCCESS) {
+		for (unsigned i = 0; i < count; i++) {
+			if (jobs[i].result == VK_SUCCESS)
+				radv_DestroyPipeline(_device, pPipelines[i], pAllocator);
+		}
+	}
+
+	vk_free2(&device->alloc, pAllocator, jobs);
+	return result;
+}
+
+static void
+radv_graphics_pipeline_job(void *data, int thread_index)
+{
+	struct radv_pipeline_job *job = data;
+
+	job->result = radv_graphics_pipeline_create(job->device, job->cache,
+						    job->create_info, NULL,
+						    job->alloc, job->pipeline);
+}
+
 VkResult radv_CreateGraphicsPipelines(
 	VkDevice                                    _device,
 	VkPipelineCache                             pipelineCache,
@@ -1447,24 +1595,10 @@ VkResult radv_CreateGraphicsPipelines(
 	const VkAllocationCallbacks*                pAllocator,
 	VkPipeline*                                 pPipelines)
 {
-	VkResult result = VK_SUCCESS;
-	unsigned i = 0;
-
-	for (; i < count; i++) {
-		result = radv_graphics_pipeline_create(_device,
-						       pipelineCache,
-						       &pCreateInfos[i],
-						       NULL, pAllocator, &pPipelines[i]);
-		if (result != VK_SUCCESS) {
-			for (unsigned j = 0; j < i; j++) {
-				radv_DestroyPipeline(_device, pPipelines[j], pAllocator);
-			}
-
-			return result;
-		}
-	}
-
-	return VK_SUCCESS;
+	return radv_create_pipelines(_device, pipelineCache, count,
+				     pCreateInfos, sizeof(*pCreateInfos),
+				     radv_graphics_pipeline_job,
+				     pAllocator, pPipelines);
 }
 
 static VkResult radv_compute_pipeline_create(
@@ -1480,6 +1614,9 @@ static VkResult radv_compute_pipeline_create(
 	struct radv_pipeline *pipeline;
 	bool dump = getenv("RADV_DUMP_SHADERS");
 
+	if (!cache)
+		cache = &device->mem_cache;
+
 	pipeline = vk_alloc2(&device->alloc, pAllocator, sizeof(*pipeline), 8,
 			       VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
 	if (pipeline == NULL)
@@ -1503,6 +1640,16 @@ static VkResult radv_compute_pipeline_create(
 	}
 	return VK_SUCCESS;
 }
+static void
+radv_compute_pipeline_job(void *data, int thread_index)
+{
+	struct radv_pipeline_job *job = data;
+
+	job->result = radv_compute_pipeline_create(job->device, job->cache,
+						   job->create_info,
+						   job->alloc, job->pipeline);
+}
+
 VkResult radv_CreateComputePipelines(
 	VkDevice                                    _device,
 	VkPipelineCache                             pipelineCache,
@@ -1511,21 +1658,8 @@ VkResult radv_CreateComputePipelines(
 	const VkAllocationCallbacks*                pAllocator,
 	VkPipeline*                                 pPipelines)
 {
-	VkResult result = VK_SUCCESS;
-
-	unsigned i = 0;
-	for (; i < count; i++) {
-		result = radv_compute_pipeline_create(_device, pipelineCache,
-						      &pCreateInfos[i],
-						      pAllocator, &pPipelines[i]);
-		if (result != VK_SUCCESS) {
-			for (unsigned j = 0; j < i; j++) {
-				radv_DestroyPipeline(_device, pPipelines[j], pAllocator);
-			}
-
-			return result;
-		}
-	}
-
-	return VK_SUCCESS;
+	return radv_create_pipelines(_device, pipelineCache, count,
+				     pCreateInfos, sizeof(*pCreateInfos),
+				     radv_compute_pipeline_job,
+				     pAllocator, pPipelines);
 }
@@ -23,7 +23,10 @@
 
 #include "util/mesa-sha1.h"
 #include "util/debug.h"
+#include "util/disk_cache.h"
+#include "util/hash_table.h"
 #include "radv_private.h"
+#include "nir/nir_serialize.h"
 
 #include "ac_nir_to_llvm.h"
 
@@ -40,6 +43,18 @@ struct cache_entry {
 	uint32_t code[0];
 };
 
+static uint32_t
+sha1_hash_func(const void *sha1)
+{
+	return _mesa_hash_data(sha1, 20);
+}
+
+static bool
+sha1_compare_func(const void *sha1_a, const void *sha1_b)
+{
+	return memcmp(sha1_a, sha1_b, 20) == 0;
+}
+
 void
 radv_pipeline_cache_init(struct radv_pipeline_cache *cache,
 			 struct radv_device *device)
@@ -61,6 +76,11 @@ radv_pipeline_cache_init(struct radv_pipeline_cache *cache,
 		cache->table_size = 0;
 	else
 		memset(cache->hash_table, 0, byte_size);
+
+	cache->nir_cache = NULL;
+	if (cache->table_size)
+		cache->nir_cache = _mesa_hash_table_create(NULL, sha1_hash_func,
+							   sha1_compare_func);
 }
 
 void
@@ -75,6 +95,10 @@ radv_pipeline_cache_finish(struct radv_pipeline_cache *cache)
 		}
 	pthread_mutex_destroy(&cache->mutex);
 	free(cache->hash_table);
+
+	/* The keys and blobs are allocated out of the table itself. */
+	if (cache->nir_cache)
+		_mesa_hash_table_destroy(cache->nir_cache, NULL);
 }
 
 static uint32_t
@@ -107,6 +131,23 @@ radv_hash_shader(unsigned char *hash, struct radv_shader_module *module,
 	_mesa_sha1_final(ctx, hash);
 }
 
+void
+radv_hash_nir(unsigned char *hash, struct radv_shader_module *module,
+	      const char *entrypoint, gl_shader_stage stage,
+	      const VkSpecializationInfo *spec_info)
+{
+	unsigned char shader_sha1[20];
+	struct mesa_sha1 *ctx;
+
+	/* The NIR depends on neither the layout nor the variant key. */
+	radv_hash_shader(shader_sha1, module, entrypoint, spec_info, NULL, NULL);
+
+	ctx = _mesa_sha1_init();
+	_mesa_sha1_update(ctx, shader_sha1, sizeof(shader_sha1));
+	_mesa_sha1_update(ctx, &stage, sizeof(stage));
+	_mesa_sha1_final(ctx, hash);
+}
+
 
 static struct cache_entry *
 radv_pipeline_cache_search_unlocked(struct radv_pipeline_cache *cache,
@@ -115,6 +156,9 @@ radv_pipeline_cache_search_unlocked(struct radv_pipeline_cache *cache,
 	const uint32_t mask = cache->table_size - 1;
 	const uint32_t start = (*(uint32_t *) sha1);
 
+	if (cache->table_size == 0)
+		return NULL;
+
 	for (uint32_t i = 0; i < cache->table_size; i++) {
 		const uint32_t index = (start + i) & mask;
 		struct cache_entry *entry = cache->hash_table[index];
@@ -145,6 +189,10 @@ radv_pipeline_cache_search(struct radv_pipeline_cache *cache,
 	return entry;
 }
 
+static struct cache_entry *
+radv_pipeline_cache_load_from_disk(struct radv_pipeline_cache *cache,
+				   const unsigned char *sha1);
+
 struct radv_shader_variant *
 radv_create_shader_variant_from_pipeline_cache(struct radv_device *device,
 					       struct radv_pipeline_cache *cache,
@@ -152,6 +200,8 @@ radv_create_shader_variant_from_pipeline_cache(struct radv_device *device,
 {
 	struct cache_entry *entry = radv_pipeline_cache_search(cache, sha1);
 
+	if (!entry)
+		entry = radv_pipeline_cache_load_from_disk(cache, sha1);
 	if (!entry)
 		return NULL;
 
@@ -238,7 +288,7 @@ radv_pipeline_cache_grow(struct radv_pipeline_cache *cache)
 	return VK_SUCCESS;
 }
 
-static void
+static bool
 radv_pipeline_cache_add_entry(struct radv_pipeline_cache *cache,
 			      struct cache_entry *entry)
 {
@@ -248,8 +298,94 @@ radv_pipeline_cache_add_entry(struct radv_pipeline_cache *cache,
 	/* Failing to grow that hash table isn't fatal, but may mean we don't
 	 * have enough space to add this new kernel. Only add it if there's room.
 	 */
-	if (cache->kernel_count < cache->table_size / 2)
-		radv_pipeline_cache_set_entry(cache, entry);
+	if (cache->kernel_count >= cache->table_size / 2)
+		return false;
+
+	radv_pipeline_cache_set_entry(cache, entry);
+	return true;
+}
+
+/* The on-disk cache is shared with other drivers and builds, so the key
+ * also covers the device and the build through the cache UUID. */
+static void
+radv_disk_cache_key(struct radv_device *device, const unsigned char *sha1,
+		    cache_key key)
+{
+	struct radv_physical_device *pdevice = &device->instance->physicalDevice;
+	struct mesa_sha1 *ctx;
+
+	ctx = _mesa_sha1_init();
+	_mesa_sha1_update(ctx, pdevice->uuid, VK_UUID_SIZE);
+	_mesa_sha1_update(ctx, sha1, 20);
+	_mesa_sha1_final(ctx, key);
+}
+
+static struct cache_entry *
+radv_pipeline_cache_load_from_disk(struct radv_pipeline_cache *cache,
+				   const unsigned char *sha1)
+{
+	struct disk_cache *disk_cache =
+		cache->device->instance->physicalDevice.disk_cache;
+	struct cache_entry *entry, *dest_entry;
+	cache_key key;
+	size_t size;
+
+	if (!disk_cache || !cache->table_size)
+		return NULL;
+
+	radv_disk_cache_key(cache->device, sha1, key);
+	entry = disk_cache_get(disk_cache, key, &size);
+	if (!entry)
+		return NULL;
+
+	if (size < sizeof(*entry) || size != entry_size(entry) ||
+	    memcmp(entry->sha1, sha1, sizeof(entry->sha1)) != 0) {
+		free(entry);
+		return NULL;
+	}
+
+	dest_entry = vk_alloc(&cache->alloc, size, 8,
+			      VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
+	if (dest_entry) {
+		memcpy(dest_entry, entry, size);
+		dest_entry->variant = NULL;
+
+		pthread_mutex_lock(&cache->mutex);
+		struct cache_entry *other = radv_pipeline_cache_search_unlocked(cache, sha1);
+		if (other || !radv_pipeline_cache_add_entry(cache, dest_entry)) {
+			vk_free(&cache->alloc, dest_entry);
+			dest_entry = other;
+		}
+		pthread_mutex_unlock(&cache->mutex);
+	}
+
+	free(entry);
+	return dest_entry;
+}
+
+static void
+radv_pipeline_cache_store_to_disk(struct radv_pipeline_cache *cache,
+				  const struct cache_entry *entry)
+{
+	struct disk_cache *disk_cache =
+		cache->device->instance->physicalDevice.disk_cache;
+	const uint32_t size = entry_size((struct cache_entry *) entry);
+	struct cache_entry *data;
+	cache_key key;
+
+	if (!disk_cache || !cache->table_size)
+		return;
+
+	data = malloc(size);
+	if (!data)
+		return;
+
+	memcpy(data, entry, size);
+	data->variant = NULL;
+
+	radv_disk_cache_key(cache->device, entry->sha1, key);
+	disk_cache_put(disk_cache, key, data, size);
+	free(data);
 }
 
 struct radv_shader_variant *
@@ -289,13 +425,67 @@ radv_pipeline_cache_insert_shader(struct radv_pipeline_cache *cache,
 	entry->variant = variant;
 	__sync_fetch_and_add(&variant->ref_count, 1);
 
-	radv_pipeline_cache_add_entry(cache, entry);
+	radv_pipeline_cache_store_to_disk(cache, entry);
+
+	if (!radv_pipeline_cache_add_entry(cache, entry)) {
+		/* The variant reference is the one handed to the caller. */
+		__sync_fetch_and_sub(&variant->ref_count, 1);
+		vk_free(&cache->alloc, entry);
+	}
 
 	cache->modified = true;
 	pthread_mutex_unlock(&cache->mutex);
 	return variant;
 }
 
+struct nir_shader *
+radv_pipeline_cache_search_nir(struct radv_pipeline_cache *cache,
+			       const unsigned char *sha1,
+			       const struct nir_shader_compiler_options *options)
+{
+	nir_shader *nir = NULL;
+
+	if (!cache->nir_cache)
+		return NULL;
+
+	pthread_mutex_lock(&cache->mutex);
+
+	struct hash_entry *entry = _mesa_hash_table_search(cache->nir_cache, sha1);
+	if (entry) {
+		const struct blob *blob = entry->data;
+		struct blob_reader reader;
+
+		blob_reader_init(&reader, blob->data, blob->size);
+		nir = nir_deserialize(NULL, options, &reader);
+	}
+
+	pthread_mutex_unlock(&cache->mutex);
+	return nir;
+}
+
+void
+radv_pipeline_cache_insert_nir(struct radv_pipeline_cache *cache,
+			       const unsigned char *sha1,
+			       const struct nir_shader *nir)
+{
+	if (!cache->nir_cache)
+		return;
+
+	pthread_mutex_lock(&cache->mutex);
+
+	if (!_mesa_hash_table_search(cache->nir_cache, sha1)) {
+		struct blob *blob = blob_create(cache->nir_cache);
+		if (blob) {
+			nir_serialize(blob, nir);
+			void *key = ralloc_size(cache->nir_cache, 20);
+			memcpy(key, sha1, 20);
+			_mesa_hash_table_insert(cache->nir_cache, key, blob);
+		}
+	}
+
+	pthread_mutex_unlock(&cache->mutex);
+}
+
 struct cache_header {
 	uint32_t header_size;
 	uint32_t header_version;
@@ -47,6 +47,7 @@
 #include "compiler/shader_enums.h"
 #include "util/macros.h"
 #include "util/list.h"
+#include "util/u_queue.h"
 #include "util/vk_alloc.h"
 #include "main/macros.h"
 
@@ -81,6 +82,7 @@ typedef uint32_t xcb_window_t;
 #define MAX_DYNAMIC_BUFFERS 16
 #define MAX_IMAGES 8
 #define MAX_SAMPLES_LOG2 4 /* SKL supports 16 samples */
+#define MAX_IDLE_TARGET_MACHINES 16
 #define NUM_META_FS_KEYS 11
 
 #define NUM_DEPTH_CLEAR_PIPELINES 3
@@ -266,6 +268,9 @@ struct radv_physical_device {
 
 	uint8_t                                     uuid[VK_UUID_SIZE];
 
+	/* Backs the pipeline caches across runs; NULL if disabled. */
+	struct disk_cache *                          disk_cache;
+
 	struct wsi_device                       wsi_device;
 };
 
@@ -294,6 +299,12 @@ struct radv_pipeline_cache {
 	struct cache_entry **                        hash_table;
 	bool                                         modified;
 
+	/* Serialized NIR keyed by radv_hash_nir(), so that pipelines using the
+	 * same shader with a different variant key or layout skip spirv_to_nir
+	 * and the NIR optimization loop.  Not saved by
+	 * vkGetPipelineCacheData. */
+	struct hash_table *                          nir_cache;
+
 	VkAllocationCallbacks                        alloc;
 };
 
@@ -317,6 +328,18 @@ radv_pipeline_cache_insert_shader(struct radv_pipeline_cache *cache,
 				  struct radv_shader_variant *variant,
 				  const void *code, unsigned code_size);
 
+struct nir_shader_compiler_options;
+
+struct nir_shader *
+radv_pipeline_cache_search_nir(struct radv_pipeline_cache *cache,
+			       const unsigned char *sha1,
+			       const struct nir_shader_compiler_options *options);
+
+void
+radv_pipeline_cache_insert_nir(struct radv_pipeline_cache *cache,
+			       const unsigned char *sha1,
+			       const struct nir_shader *nir);
+
 void radv_shader_variant_destroy(struct radv_device *device,
 				 struct radv_shader_variant *variant);
 
@@ -448,6 +471,21 @@ struct radv_device {
 	struct radv_queue                            queue;
 	struct radeon_winsys_cs *empty_cs;
 
+	/* Used for pipelines created without a VkPipelineCache, so that they
+	 * still go through the on-disk cache. */
+	struct radv_pipeline_cache                   mem_cache;
+
+	/* Compiles the pipelines of vkCreate*Pipelines calls in parallel. */
+	struct util_queue                            pipeline_queue;
+	bool                                         has_pipeline_queue;
+
+	/* LLVM target machines kept around between shader compiles, as they
+	 * are expensive to create. Each one is only used by one compile at a
+	 * time. */
+	pthread_mutex_t                              tm_mutex;
+	LLVMTargetMachineRef                         idle_tms[MAX_IDLE_TARGET_MACHINES];
+	unsigned                                     num_idle_tms;
+
 	bool allow_fast_clears;
 	bool allow_dcc;
 	bool shader_stats_dump;
@@ -772,6 +810,11 @@ radv_hash_shader(unsigned char *hash, struct radv_shader_module *module,
 		 const struct radv_pipeline_layout *layout,
 		 const union ac_shader_variant_key *key);
 
+void
+radv_hash_nir(unsigned char *hash, struct radv_shader_module *module,
+	      const char *entrypoint, gl_shader_stage stage,
+	      const VkSpecializationInfo *spec_info);
+
 static inline gl_shader_stage
 vk_to_mesa_shader_stage(VkShaderStageFlagBits vk_stage)
 {
@@ -32,6 +32,7 @@
 #include "radv_amdgpu_cs.h"
 #include "radv_amdgpu_bo.h"
 #include "sid.h"
+#include "util/bitscan.h"
 
 struct radv_amdgpu_cs {
 	struct radeon_winsys_cs base;
@@ -102,17 +103,72 @@ static bool radv_amdgpu_fence_wait(struct radeon_winsys *_ws,
 	return false;
 }
 
+/* Returns an IB buffer of at least min_size bytes, preferably an idle one
+ * from the pool.
+ */
+static struct radeon_winsys_bo *
+radv_amdgpu_ib_buffer_get(struct radv_amdgpu_winsys *ws, uint64_t min_size)
+{
+	struct radeon_winsys_bo *bo = NULL;
+	unsigned order = MAX2(util_last_bit64(min_size - 1),
+			      RADV_AMDGPU_IB_MIN_ORDER);
+
+	/* Bigger ones are allocated as asked, and not pooled. */
+	if (order > RADV_AMDGPU_IB_MAX_ORDER)
+		return ws->base.buffer_create(&ws->base, min_size, 0,
+					      RADEON_DOMAIN_GTT,
+					      RADEON_FLAG_CPU_ACCESS);
+
+	unsigned index = order - RADV_AMDGPU_IB_MIN_ORDER;
+
+	pthread_mutex_lock(&ws->ib_pool_lock);
+	if (ws->ib_pool_count[index])
+		bo = ws->ib_pool[index][--ws->ib_pool_count[index]];
+	pthread_mutex_unlock(&ws->ib_pool_lock);
+
+	if (!bo)
+		bo = ws->base.buffer_create(&ws->base, 1ull << order, 0,
+					    RADEON_DOMAIN_GTT,
+					    RADEON_FLAG_CPU_ACCESS);
+	return bo;
+}
+
+/* Gives back an IB buffer the GPU is done with. */
+static void
+radv_amdgpu_ib_buffer_put(struct radv_amdgpu_winsys *ws,
+			  struct radeon_winsys_bo *bo)
+{
+	uint64_t size = radv_amdgpu_winsys_bo(bo)->size;
+	unsigned order = util_last_bit64(size) - 1;
+
+	if (size == 1ull << order &&
+	    order >= RADV_AMDGPU_IB_MIN_ORDER &&
+	    order <= RADV_AMDGPU_IB_MAX_ORDER) {
+		unsigned index = order - RADV_AMDGPU_IB_MIN_ORDER;
+
+		pthread_mutex_lock(&ws->ib_pool_lock);
+		if (ws->ib_pool_count[index] < RADV_AMDGPU_IB_POOL_SIZE) {
+			ws->ib_pool[index][ws->ib_pool_count[index]++] = bo;
+			bo = NULL;
+		}
+		pthread_mutex_unlock(&ws->ib_pool_lock);
+	}
+
+	if (bo)
+		ws->base.buffer_destroy(bo);
+}
+
 static void radv_amdgpu_cs_destroy(struct radeon_winsys_cs *rcs)
 {
 	struct radv_amdgpu_cs *cs = radv_amdgpu_cs(rcs);
 
 	if (cs->ib_buffer)
-		cs->ws->base.buffer_destroy(cs->ib_buffer);
+		radv_amdgpu_ib_buffer_put(cs->ws, cs->ib_buffer);
 	else
 		free(cs->base.buf);
 
 	for (unsigned i = 0; i < cs->num_old_ib_buffers; ++i)
-		cs->ws->base.buffer_destroy(cs->old_ib_buffers[i]);
+		radv_amdgpu_ib_buffer_put(cs->ws, cs->old_ib_buffers[i]);
 
 	free(cs->old_ib_buffers);
 	free(cs->handles);
@@ -143,9 +199,7 @@ radv_amdgpu_cs_create(struct radeon_winsys *ws,
 	radv_amdgpu_init_cs(cs, RING_GFX);
 
 	if (cs->ws->use_ib_bos) {
-		cs->ib_buffer = ws->buffer_create(ws, ib_size, 0,
-						RADEON_DOMAIN_GTT,
-						RADEON_FLAG_CPU_ACCESS);
+		cs->ib_buffer = radv_amdgpu_ib_buffer_get(cs->ws, ib_size);
 		if (!cs->ib_buffer) {
 			free(cs);
 			return NULL;
@@ -153,11 +207,12 @@ radv_amdgpu_cs_create(struct radeon_winsys *ws,
 
 		cs->ib_mapped = ws->buffer_map(cs->ib_buffer);
 		if (!cs->ib_mapped) {
-			ws->buffer_destroy(cs->ib_buffer);
+			radv_amdgpu_ib_buffer_put(cs->ws, cs->ib_buffer);
 			free(cs);
 			return NULL;
 		}
 
+		ib_size = radv_amdgpu_winsys_bo(cs->ib_buffer)->size;
 		cs->ib.ib_mc_address = radv_amdgpu_winsys_bo(cs->ib_buffer)->va;
 		cs->base.buf = (uint32_t *)cs->ib_mapped;
 		cs->base.max_dw = ib_size / 4 - 4;
@@ -228,9 +283,7 @@ static void radv_amdgpu_cs_grow(struct radeon_winsys_cs *_cs, size_t min_size)
 
 	cs->old_ib_buffers[cs->num_old_ib_buffers++] = cs->ib_buffer;
 
-	cs->ib_buffer = cs->ws->base.buffer_create(&cs->ws->base, ib_size, 0,
-						   RADEON_DOMAIN_GTT,
-						   RADEON_FLAG_CPU_ACCESS);
+	cs->ib_buffer = radv_amdgpu_ib_buffer_get(cs->ws, ib_size);
 
 	if (!cs->ib_buffer) {
 		cs->base.cdw = 0;
@@ -240,7 +293,7 @@ static void radv_amdgpu_cs_grow(struct radeon_winsys_cs *_cs, size_t min_size)
 
 	cs->ib_mapped = cs->ws->base.buffer_map(cs->ib_buffer);
 	if (!cs->ib_mapped) {
-		cs->ws->base.buffer_destroy(cs->ib_buffer);
+		radv_amdgpu_ib_buffer_put(cs->ws, cs->ib_buffer);
 		cs->base.cdw = 0;
 		cs->failed = true;
 		cs->ib_buffer = cs->old_ib_buffers[--cs->num_old_ib_buffers];
@@ -256,7 +309,7 @@ static void radv_amdgpu_cs_grow(struct radeon_winsys_cs *_cs, size_t min_size)
 
 	cs->base.buf = (uint32_t *)cs->ib_mapped;
 	cs->base.cdw = 0;
-	cs->base.max_dw = ib_size / 4 - 4;
+	cs->base.max_dw = radv_amdgpu_winsys_bo(cs->ib_buffer)->size / 4 - 4;
 
 }
 
@@ -293,8 +346,10 @@ static void radv_amdgpu_cs_reset(struct radeon_winsys_cs *_cs)
 	if (cs->ws->use_ib_bos) {
 		cs->ws->base.cs_add_buffer(&cs->base, cs->ib_buffer, 8);
 
+		/* The command stream keeps its last, biggest buffer, and the
+		 * others go back to the pool for the next streams to grow. */
 		for (unsigned i = 0; i < cs->num_old_ib_buffers; ++i)
-			cs->ws->base.buffer_destroy(cs->old_ib_buffers[i]);
+			radv_amdgpu_ib_buffer_put(cs->ws, cs->old_ib_buffers[i]);
 
 		cs->num_old_ib_buffers = 0;
 		cs->ib.ib_mc_address = radv_amdgpu_winsys_bo(cs->ib_buffer)->va;
@@ -778,6 +833,9 @@ static bool radv_amdgpu_ctx_wait_idle(struct radeon_winsys_ctx *rwctx)
 
 void radv_amdgpu_cs_init_functions(struct radv_amdgpu_winsys *ws)
 {
+	pthread_mutex_init(&ws->ib_pool_lock, NULL);
+
+
 	ws->base.ctx_create = radv_amdgpu_ctx_create;
 	ws->base.ctx_destroy = radv_amdgpu_ctx_destroy;
 	ws->base.ctx_wait_idle = radv_amdgpu_ctx_wait_idle;
@@ -793,3 +851,14 @@ void radv_amdgpu_cs_init_functions(struct radv_amdgpu_winsys *ws)
 	ws->base.destroy_fence = radv_amdgpu_destroy_fence;
 	ws->base.fence_wait = radv_amdgpu_fence_wait;
 }
+
+void radv_amdgpu_cs_finish(struct radv_amdgpu_winsys *ws)
+{
+	for (unsigned i = 0; i < RADV_AMDGPU_IB_NUM_ORDERS; ++i) {
+		for (unsigned j = 0; j < ws->ib_pool_count[i]; ++j)
+			ws->base.buffer_destroy(ws->ib_pool[i][j]);
+		ws->ib_pool_count[i] = 0;
+	}
+
+	pthread_mutex_destroy(&ws->ib_pool_lock);
+}
@@ -51,5 +51,6 @@ radv_amdgpu_ctx(struct radeon_winsys_ctx *base)
 }
 
 void radv_amdgpu_cs_init_functions(struct radv_amdgpu_winsys *ws);
+void radv_amdgpu_cs_finish(struct radv_amdgpu_winsys *ws);
 
 #endif /* RADV_AMDGPU_CS_H */
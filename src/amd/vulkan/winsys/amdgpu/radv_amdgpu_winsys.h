@@ -33,6 +33,14 @@
 #include <amdgpu.h>
 #include "util/list.h"
 
+/* IB buffers are allocated in power-of-two sizes from 64 KiB to 512 KiB,
+ * and idle ones are kept in a pool per size for reuse by command streams.
+ */
+#define RADV_AMDGPU_IB_MIN_ORDER 16
+#define RADV_AMDGPU_IB_MAX_ORDER 19
+#define RADV_AMDGPU_IB_NUM_ORDERS (RADV_AMDGPU_IB_MAX_ORDER - RADV_AMDGPU_IB_MIN_ORDER + 1)
+#define RADV_AMDGPU_IB_POOL_SIZE 32
+
 struct radv_amdgpu_winsys {
 	struct radeon_winsys base;
 	amdgpu_device_handle dev;
@@ -50,6 +58,10 @@ struct radv_amdgpu_winsys {
 	unsigned num_buffers;
 
 	bool use_ib_bos;
+
+	pthread_mutex_t ib_pool_lock;
+	struct radeon_winsys_bo *ib_pool[RADV_AMDGPU_IB_NUM_ORDERS][RADV_AMDGPU_IB_POOL_SIZE];
+	unsigned ib_pool_count[RADV_AMDGPU_IB_NUM_ORDERS];
 };
 
 static inline struct radv_amdgpu_winsys *
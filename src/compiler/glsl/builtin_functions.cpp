@@ -60,6 +60,8 @@
 #include "ir_builder.h"
 #include "glsl_parser_extras.h"
 #include "program/prog_instruction.h"
+#include "util/hash_table.h"
+#include "util/set.h"
 #include <math.h>
 
 #define M_PIf   ((float) M_PI)
@@ -579,18 +581,52 @@ public:
    ir_function_signature *find(_mesa_glsl_parse_state *state,
                                const char *name, exec_list *actual_parameters);
 
+   /**
+    * Look up the built-in function \c name, building it first if nothing
+    * has asked for it yet.
+    */
+   ir_function *get_function(const char *name);
+
    /**
     * A shader to hold all the built-in signatures; created by this module.
     *
     * This includes signatures for every built-in, regardless of version or
     * enabled extensions.  The availability predicate associated with each
     * signature allows matching_signature() to filter out the irrelevant ones.
+    *
+    * Built-in functions are only added to it the first time they are looked
+    * up through get_function(); intrinsics are always present.
     */
    gl_shader *shader;
 
 private:
    void *mem_ctx;
 
+   /**
+    * \name Lazy construction of built-in functions
+    *
+    * Building the IR of every built-in up front was a significant part of
+    * the first shader compile.  Instead, initialize() runs create_builtins()
+    * once in \c record_names mode to collect the built-in names, and each
+    * name is built on its first lookup by running it again in \c build_one
+    * mode, which skips evaluating the signatures of every other function.
+    */
+   /*@{*/
+   enum {
+      build_all,
+      record_names,
+      build_one,
+   } build_mode;
+
+   /** Name of the function to build in \c build_one mode */
+   const char *build_name;
+
+   /** Names of the built-in functions that haven't been built yet */
+   struct set *unbuilt_functions;
+
+   bool wants_function(const char *name);
+   /*@}*/
+
    void create_shader();
    void create_intrinsics();
    void create_builtins();
@@ -918,6 +954,9 @@ builtin_builder::builtin_builder()
    : shader(NULL)
 {
    mem_ctx = NULL;
+   build_mode = build_all;
+   build_name = NULL;
+   unbuilt_functions = NULL;
 }
 
 builtin_builder::~builtin_builder()
@@ -938,7 +977,7 @@ builtin_builder::find(_mesa_glsl_parse_state *state,
     */
    state->uses_builtin_functions = true;
 
-   ir_function *f = shader->symbols->get_function(name);
+   ir_function *f = get_function(name);
    if (f == NULL)
       return NULL;
 
@@ -960,7 +999,50 @@ builtin_builder::initialize()
    mem_ctx = ralloc_context(NULL);
    create_shader();
    create_intrinsics();
+
+   unbuilt_functions = _mesa_set_create(mem_ctx, _mesa_key_hash_string,
+                                        _mesa_key_string_equal);
+   build_mode = record_names;
    create_builtins();
+   build_mode = build_all;
+}
+
+ir_function *
+builtin_builder::get_function(const char *name)
+{
+   ir_function *f = shader->symbols->get_function(name);
+   if (f != NULL)
+      return f;
+
+   struct set_entry *entry = _mesa_set_search(unbuilt_functions, name);
+   if (entry == NULL)
+      return NULL;
+
+   _mesa_set_remove(unbuilt_functions, entry);
+
+   build_mode = build_one;
+   build_name = name;
+   create_builtins();
+   build_mode = build_all;
+   build_name = NULL;
+
+   return shader->symbols->get_function(name);
+}
+
+bool
+builtin_builder::wants_function(const char *name)
+{
+   switch (build_mode) {
+   case build_all:
+      return true;
+   case record_names:
+      _mesa_set_add(unbuilt_functions, name);
+      return false;
+   case build_one:
+      return strcmp(name, build_name) == 0;
+   }
+
+   unreachable("invalid build mode");
 }
 
 void
@@ -968,6 +1050,7 @@ builtin_builder::release()
 {
    ralloc_free(mem_ctx);
    mem_ctx = NULL;
+   unbuilt_functions = NULL;
 
    ralloc_free(shader);
    shader = NULL;
@@ -1128,6 +1211,15 @@ builtin_builder::create_intrinsics()
 void
 builtin_builder::create_builtins()
 {
+   /* Only evaluate the signatures of the functions we were asked for; see
+    * wants_function().
+    */
+#define add_function(NAME, ...)                  \
+   do {                                          \
+      if (wants_function(NAME))                  \
+         add_function(NAME, __VA_ARGS__);        \
+   } while (0)
+
 #define F(NAME)                                 \
    add_function(#NAME,                          \
                 _##NAME(glsl_type::float_type), \
@@ -2991,6 +3083,7 @@ builtin_builder::create_builtins()
    add_function("allInvocationsARB", _vote(ir_unop_vote_all), NULL);
    add_function("allInvocationsEqualARB", _vote(ir_unop_vote_eq), NULL);
 
+#undef add_function
 #undef F
 #undef FI
 #undef FIUD
@@ -3032,6 +3125,9 @@ builtin_builder::add_image_function(const char *name,
                                     unsigned flags,
                                     enum ir_intrinsic_id intrinsic_id)
 {
+   if (!wants_function(name))
+      return;
+
    static const glsl_type *const types[] = {
       glsl_type::image1D_type,
       glsl_type::image2D_type,
@@ -5744,7 +5840,7 @@ _mesa_glsl_find_builtin_function_by_name(const char *name)
 {
    ir_function *f;
    mtx_lock(&builtins_lock);
-   f = builtins.shader->symbols->get_function(name);
+   f = builtins.get_function(name);
    mtx_unlock(&builtins_lock);
    return f;
 }
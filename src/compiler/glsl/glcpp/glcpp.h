@@ -241,6 +241,9 @@ glcpp_preprocess(void *ralloc_ctx, const char **shader, char **info_log,
 		 glcpp_extension_iterator extensions, void *state,
 		 struct gl_context *g_ctx);
 
+bool
+glcpp_skip_preprocessing(void *ralloc_ctx, const char **shader);
+
 /* Functions for writing to the info log */
 
 void
@@ -211,6 +211,172 @@ remove_line_continuations(glcpp_parser_t *ctx, const char *shader)
 	return clean;
 }
 
+/* Whether the identifier or number of length len at str may be subject to
+ * macro expansion without any #define in the shader, that is whether it is
+ * one of __LINE__, __FILE__, __VERSION__, GL_ES, GL_core_profile,
+ * GL_FRAGMENT_PRECISION_HIGH or an extension name.  This errs on the side
+ * of caution for numbers immediately followed by an identifier.
+ */
+static bool
+may_be_predefined_macro(const char *str, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i + 1 < len; i++) {
+		if (str[i] == '_' && str[i + 1] == '_')
+			return true;
+		if (i + 2 < len &&
+		    str[i] == 'G' && str[i + 1] == 'L' && str[i + 2] == '_')
+			return true;
+	}
+
+	return false;
+}
+
+static bool
+is_identifier_char(char c)
+{
+	return isalnum((unsigned char) c) || c == '_';
+}
+
+/* Most shaders only ever use #version, #extension and #pragma, which glcpp
+ * passes through to the GLSL lexer.  If a shader has no other directive, no
+ * line continuation and no reference to a predefined macro, preprocessing
+ * only removes its comments, so we do that here instead of running it
+ * through the glcpp lexer and parser.
+ *
+ * Comments are replaced with a single space, and the newlines they contain
+ * are emitted at the end of the line, as glcpp does.
+ *
+ * Returns false, leaving *shader untouched, if the shader needs the full
+ * preprocessor.
+ */
+bool
+glcpp_skip_preprocessing(void *ralloc_ctx, const char **shader)
+{
+	const char *src = *shader;
+	char *output, *out;
+	bool has_comments = false;
+	bool line_start = true;
+	unsigned commented_newlines = 0;
+
+	/* The output is never longer than the input, since comments are at
+	 * least as long as the space and the newlines they are replaced
+	 * with.
+	 */
+	output = ralloc_size(ralloc_ctx, strlen(src) + 1);
+	if (output == NULL)
+		return false;
+	out = output;
+
+	while (*src) {
+		if (src[0] == '/' && src[1] == '*') {
+			const char *end = strstr(src + 2, "*/");
+
+			if (end == NULL)
+				goto fail;
+
+			for (src += 2; src < end; src++) {
+				if (*src == '\n')
+					commented_newlines++;
+			}
+			src = end + 2;
+			*out++ = ' ';
+			has_comments = true;
+		} else if (src[0] == '/' && src[1] == '/') {
+			while (*src && *src != '\n' && *src != '\r')
+				src++;
+			has_comments = true;
+		} else if (*src == '\n') {
+			*out++ = *src++;
+			while (commented_newlines) {
+				*out++ = '\n';
+				commented_newlines--;
+			}
+			line_start = true;
+		} else if (*src == '\r') {
+			/* Only "\r\n" and "\n\r" line endings keep the line
+			 * numbers of the GLSL lexer in sync.
+			 */
+			if (src[1] != '\n' && (src == *shader || src[-1] != '\n'))
+				goto fail;
+			*out++ = *src++;
+		} else if (*src == ' ' || *src == '\t') {
+			*out++ = *src++;
+		} else if (*src == '#') {
+			const char *directive = src + 1;
+			const char *end;
+
+			if (!line_start || commented_newlines)
+				goto fail;
+
+			while (*directive == ' ' || *directive == '\t')
+				directive++;
+			for (end = directive; is_identifier_char(*end); end++)
+				;
+
+			if (end - directive == 7 &&
+			    strncmp(directive, "version", 7) == 0) {
+				/* The rest of the line is preprocessed as
+				 * usual.
+				 */
+				memcpy(out, src, end - src);
+				out += end - src;
+				src = end;
+			} else if ((end - directive == 9 &&
+				    strncmp(directive, "extension", 9) == 0) ||
+				   (end - directive == 6 &&
+				    strncmp(directive, "pragma", 6) == 0 &&
+				    (*end == ' ' || *end == '\t'))) {
+				/* glcpp copies these lines as they are,
+				 * comments included.
+				 */
+				while (*end && *end != '\n' && *end != '\r')
+					end++;
+				memcpy(out, src, end - src);
+				out += end - src;
+				src = end;
+			} else {
+				goto fail;
+			}
+			line_start = false;
+		} else if (*src == '\\') {
+			goto fail;
+		} else if (is_identifier_char(*src)) {
+			const char *end = src;
+
+			while (is_identifier_char(*end))
+				end++;
+			if (may_be_predefined_macro(src, end - src))
+				goto fail;
+			memcpy(out, src, end - src);
+			out += end - src;
+			src = end;
+			line_start = false;
+		} else {
+			*out++ = *src++;
+			line_start = false;
+		}
+	}
+
+	while (commented_newlines) {
+		*out++ = '\n';
+		commented_newlines--;
+	}
+	*out = '\0';
+
+	if (has_comments)
+		*shader = output;
+	else
+		ralloc_free(output);
+
+	return true;
+
+fail:
+	ralloc_free(output);
+	return false;
+}
+
 int
 glcpp_preprocess(void *ralloc_ctx, const char **shader, char **info_log,
                  glcpp_extension_iterator extensions, void *state,
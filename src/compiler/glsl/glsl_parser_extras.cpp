@@ -24,12 +24,15 @@
 #include <stdarg.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 
 #include "main/core.h" /* for struct gl_context */
 #include "main/context.h"
 #include "main/debug_output.h"
 #include "main/formats.h"
 #include "main/shaderobj.h"
+#include "util/debug.h"
+#include "util/hash_table.h"
 #include "util/u_atomic.h" /* for p_atomic_cmpxchg */
 #include "util/ralloc.h"
 #include "ast.h"
@@ -37,6 +40,8 @@
 #include "glsl_parser.h"
 #include "ir_optimization.h"
 #include "loop_analysis.h"
+#include "program.h"
+#include "shader_cache.h"
 
 /**
  * Format a short human-readable description of the given GLSL version.
@@ -1819,6 +1824,20 @@ set_shader_inout_layout(struct gl_shader *shader,
    }
 }
 
+namespace {
+uint64_t opt_time_ns(void);
+}
+
+/* Adds the time since *start to *phase, and restarts the clock. */
+static void
+end_compile_phase(uint64_t *phase, uint64_t *start)
+{
+   const uint64_t now = opt_time_ns();
+
+   *phase += now - *start;
+   *start = now;
+}
+
 extern "C" {
 
 static void
@@ -1891,20 +1910,63 @@ do_late_parsing_checks(struct _mesa_glsl_parse_state *state)
    }
 }
 
+/** Source of gl_shader::CompileSerial values */
+static unsigned compile_serial;
+
 void
 _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
-                          bool dump_ast, bool dump_hir)
+                          bool dump_ast, bool dump_hir, bool force_recompile)
 {
+   _mesa_glsl_compile_shader_timed(ctx, shader, dump_ast, dump_hir,
+                                   force_recompile, NULL);
+}
+
+/**
+ * Compiles \p shader like _mesa_glsl_compile_shader(), adding the time
+ * spent in each phase to \p times unless it is NULL.
+ */
+void
+_mesa_glsl_compile_shader_timed(struct gl_context *ctx,
+                                struct gl_shader *shader,
+                                bool dump_ast, bool dump_hir,
+                                bool force_recompile,
+                                struct glsl_compile_times *times)
+{
+   const char *source = shader->Source;
+   uint64_t start = times ? opt_time_ns() : 0;
+
+   if (ctx->Cache && !force_recompile) {
+      shader_cache_compute_shader_key(ctx, shader);
+
+      /* A shader that has been seen before is only compiled if linking
+       * misses the cache; see link_shaders().
+       */
+      if (disk_cache_has_key(ctx->Cache, shader->sha1)) {
+         ralloc_free(shader->ir);
+         shader->ir = NULL;
+         shader->symbols = NULL;
+         shader->CompileSerial = p_atomic_inc_return(&compile_serial);
+         ralloc_free(shader->InfoLog);
+         shader->InfoLog = ralloc_strdup(shader, "");
+         shader->CompileStatus = compile_skipped;
+         return;
+      }
+   }
+
    struct _mesa_glsl_parse_state *state =
       new(shader) _mesa_glsl_parse_state(ctx, shader->Stage, shader);
-   const char *source = shader->Source;
 
    if (ctx->Const.GenerateTemporaryNames)
       (void) p_atomic_cmpxchg(&ir_variable::temporaries_allocate_names,
                               false, true);
 
-   state->error = glcpp_preprocess(state, &source, &state->info_log,
-                             add_builtin_defines, state, ctx);
+   if (!glcpp_skip_preprocessing(state, &source)) {
+      state->error = glcpp_preprocess(state, &source, &state->info_log,
+                                      add_builtin_defines, state, ctx);
+   }
+
+   if (times)
+      end_compile_phase(&times->preprocess, &start);
 
    if (!state->error) {
      _mesa_glsl_lexer_ctor(state, source);
@@ -1913,6 +1975,9 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
      do_late_parsing_checks(state);
    }
 
+   if (times)
+      end_compile_phase(&times->parse, &start);
+
    if (dump_ast) {
       foreach_list_typed(ast_node, ast, link, &state->translation_unit) {
          ast->print();
@@ -1922,6 +1987,7 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
 
    ralloc_free(shader->ir);
    shader->ir = new(shader) exec_list;
+   shader->CompileSerial = p_atomic_inc_return(&compile_serial);
    if (!state->error && !state->translation_unit.is_empty())
       _mesa_ast_to_hir(shader->ir, state);
 
@@ -1934,6 +2000,8 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
       }
    }
 
+   if (times)
+      end_compile_phase(&times->ast_to_hir, &start);
 
    if (!state->error && !shader->ir->is_empty()) {
       struct gl_shader_compiler_options *options =
@@ -1945,7 +2013,7 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
        * and reduce later work if the same shader is linked multiple times
        */
       while (do_common_optimization(shader->ir, false, false, options,
-                                    ctx->Const.NativeIntegers))
+                                    ctx->Const.NativeIntegers, times))
          ;
 
       validate_ir_tree(shader->ir);
@@ -1971,6 +2039,9 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
       validate_ir_tree(shader->ir);
    }
 
+   if (times)
+      end_compile_phase(&times->optimize, &start);
+
    if (shader->InfoLog)
       ralloc_free(shader->InfoLog);
 
@@ -1978,7 +2049,7 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
       set_shader_inout_layout(shader, state);
 
    shader->symbols = new(shader->ir) glsl_symbol_table;
-   shader->CompileStatus = !state->error;
+   shader->CompileStatus = state->error ? compile_failure : compile_success;
    shader->InfoLog = state->info_log;
    shader->Version = state->language_version;
    shader->IsES = state->es_shader;
@@ -2015,14 +2086,215 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
 
    _mesa_glsl_initialize_derived_variables(ctx, shader);
 
+   if (ctx->Cache && shader->CompileStatus == compile_success)
+      disk_cache_put_key(ctx->Cache, shader->sha1);
+
    delete state->symbols;
    ralloc_free(state);
 }
 
 } /* extern "C" */
+
+namespace {
+
+/**
+ * Bookkeeping that lets do_common_optimization() iterate to a fixed point
+ * without re-running a pass over IR it has already seen and left alone.
+ *
+ * Passes are numbered in the order they run within a sweep.  Passes that
+ * only look at one function body at a time are run separately on each
+ * function signature, so a change in one function only makes the others'
+ * passes rerun if a whole-shader pass reacts to it.
+ */
+struct opt_state {
+   exec_list *ir;
+
+   /** Set if every top-level instruction is a declaration or a function. */
+   bool per_function;
+
+   /** Index of the next pass in the current sweep. */
+   unsigned pass;
+
+   /** Whole-shader passes that made no progress since the IR last changed. */
+   unsigned clean;
+
+   /** For every signature, the per-function passes that are up to date. */
+   struct hash_table *clean_functions;
+
+   bool progress;
+   bool sweep_progress;
+
+   /** Per-pass statistics, collected if MESA_GLSL_OPT_TIME is set. */
+   bool time;
+   struct {
+      const char *name;
+      unsigned runs;
+      uint64_t ns;
+   } stats[32];
+};
+
+static const bool debug = false;
+
+uint64_t
+opt_time_ns(void)
+{
+#if defined(__linux__)
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#else
+   return 0;
+#endif
+}
+
+bool
+opt_time_enabled(void)
+{
+   static int enabled = -1;
+
+   if (enabled < 0)
+      enabled = env_var_as_boolean("MESA_GLSL_OPT_TIME", false);
+
+   return enabled;
+}
+
+unsigned
+opt_begin_pass(opt_state *s, const char *name)
+{
+   const unsigned idx = s->pass++;
+
+   assert(idx < ARRAY_SIZE(s->stats));
+   s->stats[idx].name = name;
+
+   return 1u << idx;
+}
+
+bool
+opt_is_clean(const opt_state *s, ir_function_signature *sig, unsigned bit)
+{
+   if (sig == NULL)
+      return s->clean & bit;
+
+   hash_entry *entry = _mesa_hash_table_search(s->clean_functions, sig);
+   return entry && ((uintptr_t) entry->data & bit);
+}
+
+void
+opt_end_pass(opt_state *s, ir_function_signature *sig, unsigned bit,
+             bool progress, uint64_t start)
+{
+   const unsigned idx = ffs(bit) - 1;
+
+   if (s->time) {
+      s->stats[idx].runs++;
+      s->stats[idx].ns += opt_time_ns() - start;
+   }
+
+   if (debug) {
+      if (progress)
+         _mesa_print_ir(stderr, s->ir, NULL);
+      fprintf(stderr, "GLSL optimization %s: %s progress\n",
+              s->stats[idx].name, progress ? "made" : "no");
+   }
+
+   if (progress) {
+      s->sweep_progress = true;
+
+      /* Whole-shader passes have to look at the IR again.  If the change
+       * wasn't confined to one function, so do all per-function passes.
+       */
+      s->clean = 0;
+      if (sig == NULL)
+         _mesa_hash_table_clear(s->clean_functions, NULL);
+      else
+         _mesa_hash_table_insert(s->clean_functions, sig, (void *) 0);
+   } else if (sig == NULL) {
+      s->clean |= bit;
+   } else {
+      hash_entry *entry = _mesa_hash_table_search(s->clean_functions, sig);
+      uintptr_t mask = entry ? (uintptr_t) entry->data : 0;
+      _mesa_hash_table_insert(s->clean_functions, sig,
+                              (void *) (mask | bit));
+   }
+}
+
+bool
+opt_can_run_per_function(exec_list *ir)
+{
+   foreach_in_list(ir_instruction, node, ir) {
+      if (node->ir_type != ir_type_variable &&
+          node->ir_type != ir_type_function)
+         return false;
+   }
+
+   return true;
+}
+
+bool
+optimize_loops(exec_list *ir, const struct gl_shader_compiler_options *options)
+{
+   bool progress = false;
+   loop_state *ls = analyze_loop_variables(ir);
+
+   if (ls->loop_found) {
+      progress = set_loop_controls(ir, ls) || progress;
+      progress = unroll_loops(ir, ls, options) || progress;
+   }
+
+   delete ls;
+   return progress;
+}
+
+void
+opt_print_times(const opt_state *s, unsigned sweeps)
+{
+   fprintf(stderr, "GLSL optimization: %u sweeps\n", sweeps);
+   for (unsigned i = 0; i < s->pass; i++) {
+      if (s->stats[i].runs == 0)
+         continue;
+
+      fprintf(stderr, "   %-32s %6u runs %10.3f ms\n", s->stats[i].name,
+              s->stats[i].runs, s->stats[i].ns / 1000000.0);
+   }
+}
+
+void
+opt_add_times(const opt_state *s, struct glsl_compile_times *times)
+{
+   for (unsigned i = 0; i < s->pass; i++) {
+      unsigned j;
+
+      if (s->stats[i].runs == 0)
+         continue;
+
+      for (j = 0; j < times->num_passes; j++) {
+         if (strcmp(times->passes[j].name, s->stats[i].name) == 0)
+            break;
+      }
+
+      if (j == times->num_passes) {
+         if (j == ARRAY_SIZE(times->passes))
+            continue;
+
+         times->passes[j].name = s->stats[i].name;
+         times->passes[j].runs = 0;
+         times->passes[j].ns = 0;
+         times->num_passes++;
+      }
+
+      times->passes[j].runs += s->stats[i].runs;
+      times->passes[j].ns += s->stats[i].ns;
+   }
+}
+
+} /* anonymous namespace */
+
 /**
  * Do the set of common optimizations passes
  *
+ * The passes are repeated until none of them makes progress, so callers
+ * that loop on the return value will normally stop after the second call.
+ *
  * \param ir                          List of instructions to be optimized
  * \param linked                      Is the shader linked?  This enables
  *                                    optimizations passes that remove code at
@@ -2038,87 +2310,134 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
  *                                    implementations supporting integers
  *                                    natively (as opposed to supporting
  *                                    integers in floating point registers).
+ * \param times                       If not NULL, the time spent in each
+ *                                    pass is added to it.
  */
 bool
 do_common_optimization(exec_list *ir, bool linked,
 		       bool uniform_locations_assigned,
                        const struct gl_shader_compiler_options *options,
-                       bool native_integers)
+                       bool native_integers,
+                       struct glsl_compile_times *times)
 {
-   const bool debug = false;
-   GLboolean progress = GL_FALSE;
-
-#define OPT(PASS, ...) do {                                             \
-      if (debug) {                                                      \
-         fprintf(stderr, "START GLSL optimization %s\n", #PASS);        \
+   opt_state s;
+   unsigned sweeps = 0;
+
+   memset(&s, 0, sizeof(s));
+   s.ir = ir;
+   s.time = times != NULL || opt_time_enabled();
+   s.clean_functions = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
+                                               _mesa_key_pointer_equal);
+
+   /* Run a pass over the whole shader, or over one function if SIG is set. */
+#define OPT_RUN(SIG, PASS, ...) do {                                    \
+      if (!opt_is_clean(&s, SIG, bit)) {                                \
+         const uint64_t start = s.time ? opt_time_ns() : 0;            \
+         if (debug)                                                     \
+            fprintf(stderr, "START GLSL optimization %s\n", #PASS);     \
          const bool opt_progress = PASS(__VA_ARGS__);                   \
-         progress = opt_progress || progress;                           \
-         if (opt_progress)                                              \
-            _mesa_print_ir(stderr, ir, NULL);                           \
-         fprintf(stderr, "GLSL optimization %s: %s progress\n",         \
-                 #PASS, opt_progress ? "made" : "no");                  \
-      } else {                                                          \
-         progress = PASS(__VA_ARGS__) || progress;                      \
+         opt_end_pass(&s, SIG, bit, opt_progress, start);               \
       }                                                                 \
    } while (false)
 
-   OPT(lower_instructions, ir, SUB_TO_ADD_NEG);
+   /* A pass that has to see the whole shader. */
+#define OPT(PASS, ...) do {                                             \
+      const unsigned bit = opt_begin_pass(&s, #PASS);                   \
+      OPT_RUN(NULL, PASS, __VA_ARGS__);                                 \
+   } while (false)
 
-   if (linked) {
-      OPT(do_function_inlining, ir);
-      OPT(do_dead_functions, ir);
-      OPT(do_structure_splitting, ir);
-   }
-   propagate_invariance(ir);
-   OPT(do_if_simplification, ir);
-   OPT(opt_flatten_nested_if_blocks, ir);
-   OPT(opt_conditional_discard, ir);
-   OPT(do_copy_propagation, ir);
-   OPT(do_copy_propagation_elements, ir);
+   /* A pass that only looks at one function body at a time.  The body to
+    * work on is passed as \c body.
+    */
+#define OPT_LOCAL(PASS, ...) do {                                       \
+      const unsigned bit = opt_begin_pass(&s, #PASS);                   \
+      if (!s.per_function) {                                            \
+         exec_list *const body = ir;                                    \
+         OPT_RUN(NULL, PASS, __VA_ARGS__);                              \
+         break;                                                         \
+      }                                                                 \
+      foreach_in_list(ir_instruction, node, ir) {                       \
+         ir_function *const f = node->as_function();                    \
+         if (f == NULL)                                                 \
+            continue;                                                   \
+         foreach_in_list(ir_function_signature, sig, &f->signatures) {  \
+            if (!sig->is_defined)                                       \
+               continue;                                                \
+            exec_list *const body = &sig->body;                         \
+            OPT_RUN(sig, PASS, __VA_ARGS__);                            \
+         }                                                              \
+      }                                                                 \
+   } while (false)
 
-   if (options->OptimizeForAOS && !linked)
-      OPT(opt_flip_matrices, ir);
+   do {
+      s.pass = 0;
+      s.sweep_progress = false;
+      s.per_function = opt_can_run_per_function(ir);
+      sweeps++;
 
-   if (linked && options->OptimizeForAOS) {
-      OPT(do_vectorize, ir);
-   }
+      OPT_LOCAL(lower_instructions, body, SUB_TO_ADD_NEG);
 
-   if (linked)
-      OPT(do_dead_code, ir, uniform_locations_assigned);
-   else
-      OPT(do_dead_code_unlinked, ir);
-   OPT(do_dead_code_local, ir);
-   OPT(do_tree_grafting, ir);
-   OPT(do_constant_propagation, ir);
-   if (linked)
-      OPT(do_constant_variable, ir);
-   else
-      OPT(do_constant_variable_unlinked, ir);
-   OPT(do_constant_folding, ir);
-   OPT(do_minmax_prune, ir);
-   OPT(do_rebalance_tree, ir);
-   OPT(do_algebraic, ir, native_integers, options);
-   OPT(do_lower_jumps, ir);
-   OPT(do_vec_index_to_swizzle, ir);
-   OPT(lower_vector_insert, ir, false);
-   OPT(do_swizzle_swizzle, ir);
-   OPT(do_noop_swizzle, ir);
-
-   OPT(optimize_split_arrays, ir, linked);
-   OPT(optimize_redundant_jumps, ir);
-
-   if (options->MaxUnrollIterations) {
-      loop_state *ls = analyze_loop_variables(ir);
-      if (ls->loop_found) {
-         OPT(set_loop_controls, ir, ls);
-         OPT(unroll_loops, ir, ls, options);
+      if (linked) {
+         OPT(do_function_inlining, ir);
+         OPT(do_dead_functions, ir);
+         OPT(do_structure_splitting, ir);
+      }
+      propagate_invariance(ir);
+      OPT_LOCAL(do_if_simplification, body);
+      OPT_LOCAL(opt_flatten_nested_if_blocks, body);
+      OPT_LOCAL(opt_conditional_discard, body);
+      OPT_LOCAL(do_copy_propagation, body);
+      OPT_LOCAL(do_copy_propagation_elements, body);
+
+      if (options->OptimizeForAOS && !linked)
+         OPT(opt_flip_matrices, ir);
+
+      if (linked && options->OptimizeForAOS) {
+         OPT(do_vectorize, ir);
       }
-      delete ls;
-   }
 
+      if (linked)
+         OPT(do_dead_code, ir, uniform_locations_assigned);
+      else
+         OPT(do_dead_code_unlinked, ir);
+      OPT_LOCAL(do_dead_code_local, body);
+      OPT(do_tree_grafting, ir);
+      OPT_LOCAL(do_constant_propagation, body);
+      if (linked)
+         OPT(do_constant_variable, ir);
+      else
+         OPT(do_constant_variable_unlinked, ir);
+      OPT_LOCAL(do_constant_folding, body);
+      OPT_LOCAL(do_minmax_prune, body);
+      OPT_LOCAL(do_rebalance_tree, body);
+      OPT_LOCAL(do_algebraic, body, native_integers, options);
+      OPT(do_lower_jumps, ir);
+      OPT_LOCAL(do_vec_index_to_swizzle, body);
+      OPT_LOCAL(lower_vector_insert, body, false);
+      OPT_LOCAL(do_swizzle_swizzle, body);
+      OPT_LOCAL(do_noop_swizzle, body);
+
+      OPT(optimize_split_arrays, ir, linked);
+      OPT_LOCAL(optimize_redundant_jumps, body);
+
+      if (options->MaxUnrollIterations)
+         OPT(optimize_loops, ir, options);
+
+      s.progress = s.progress || s.sweep_progress;
+   } while (s.sweep_progress);
+
+#undef OPT_LOCAL
 #undef OPT
+#undef OPT_RUN
 
-   return progress;
+   if (times)
+      opt_add_times(&s, times);
+   if (opt_time_enabled())
+      opt_print_times(&s, sweeps);
+
+   _mesa_hash_table_destroy(s.clean_functions, NULL);
+
+   return s.progress;
 }
 
 extern "C" {
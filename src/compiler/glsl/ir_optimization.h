@@ -75,10 +75,13 @@ enum lower_packing_builtins_op {
    LOWER_PACK_USE_BFE                   = 0x0800,
 };
 
+struct glsl_compile_times;
+
 bool do_common_optimization(exec_list *ir, bool linked,
 			    bool uniform_locations_assigned,
                             const struct gl_shader_compiler_options *options,
-                            bool native_integers);
+                            bool native_integers,
+                            struct glsl_compile_times *times = NULL);
 
 bool ir_constant_fold(ir_rvalue **rvalue);
 
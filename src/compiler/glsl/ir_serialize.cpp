@@ -0,0 +1,887 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file ir_serialize.cpp
+ *
+ * A serialized instruction list has three parts:
+ *
+ *  - A variable table holding the declaration of every ir_variable that
+ *    appears anywhere in the list (globals, locals and function parameters).
+ *    Dereferences and declarations refer to variables by their index in this
+ *    table, so the order of the instruction stream doesn't matter.
+ *
+ *  - A function table holding the prototype of every function defined in
+ *    the list, followed by prototypes for any signature that is called but
+ *    not defined in the list (intrinsics, mostly).  Calls refer to
+ *    signatures by their index in this table.
+ *
+ *  - The instruction stream itself.  Function bodies are written where the
+ *    ir_function appears in the list.
+ */
+
+#include <string.h>
+#include "main/compiler.h"
+#include "ir.h"
+#include "ir_serialize.h"
+#include "blob.h"
+#include "compiler/glsl_types.h"
+#include "util/hash_table.h"
+
+namespace {
+
+/**
+ * Entry of the function table.
+ *
+ * Functions defined in the list are written with all of their signatures.
+ * Signatures that are only called are written one per entry, as a function
+ * with a single signature.
+ */
+struct function_entry {
+   const ir_function *func;
+   ir_function_signature *sig;
+};
+
+struct serialize_state {
+   struct blob *blob;
+
+   /** Maps ir_variable to (index in the variable table + 1) */
+   struct hash_table *var_ids;
+   unsigned num_vars;
+
+   /** Maps ir_function_signature to (index in the function table + 1) */
+   struct hash_table *sig_ids;
+   unsigned num_sigs;
+
+   /** Maps ir_function to (index in the function table + 1) */
+   struct hash_table *func_ids;
+   function_entry *funcs;
+   unsigned num_funcs;
+
+   bool ok;
+};
+
+void write_rvalue(serialize_state *s, ir_rvalue *ir);
+void write_instruction(serialize_state *s, ir_instruction *ir);
+
+unsigned
+lookup_id(struct hash_table *ht, const void *ptr)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(ht, ptr);
+   return entry ? (unsigned) (uintptr_t) entry->data : 0;
+}
+
+void
+add_function(serialize_state *s, const ir_function *func,
+             ir_function_signature *sig)
+{
+   s->funcs = reralloc(s->var_ids, s->funcs, function_entry, s->num_funcs + 1);
+   s->funcs[s->num_funcs].func = func;
+   s->funcs[s->num_funcs].sig = sig;
+   s->num_funcs++;
+   if (sig == NULL)
+      _mesa_hash_table_insert(s->func_ids, func,
+                              (void *) (uintptr_t) s->num_funcs);
+}
+
+void
+add_signature(serialize_state *s, const ir_function_signature *sig)
+{
+   _mesa_hash_table_insert(s->sig_ids, sig, (void *) (uintptr_t) ++s->num_sigs);
+}
+
+void
+write_variable(serialize_state *s, ir_variable *var)
+{
+   if (lookup_id(s->var_ids, var) != 0)
+      return;
+
+   _mesa_hash_table_insert(s->var_ids, var, (void *) (uintptr_t) ++s->num_vars);
+
+   blob_write_uint32(s->blob, 1);
+   encode_type_to_blob(s->blob, var->type);
+
+   blob_write_string(s->blob, var->name);
+
+   blob_write_bytes(s->blob, &var->data, sizeof(var->data));
+
+   const glsl_type *ifc_type = var->get_interface_type();
+   encode_type_to_blob(s->blob, ifc_type);
+   if (var->is_interface_instance()) {
+      blob_write_bytes(s->blob, var->get_max_ifc_array_access(),
+                       ifc_type->length * sizeof(int));
+   } else if (var->get_num_state_slots()) {
+      blob_write_bytes(s->blob, var->get_state_slots(),
+                       var->get_num_state_slots() * sizeof(ir_state_slot));
+   }
+
+   write_rvalue(s, var->constant_value);
+   write_rvalue(s, var->constant_initializer);
+}
+
+/**
+ * Writes the variable table and collects the signatures for the function
+ * table.
+ */
+class collect_visitor : public ir_hierarchical_visitor {
+public:
+   collect_visitor(serialize_state *s)
+      : s(s)
+   {
+   }
+
+   virtual ir_visitor_status visit(ir_variable *var)
+   {
+      write_variable(s, var);
+      return visit_continue;
+   }
+
+   virtual ir_visitor_status visit_enter(ir_call *call)
+   {
+      ir_function_signature *callee = call->callee;
+
+      if (lookup_id(s->sig_ids, callee) == 0) {
+         add_signature(s, callee);
+         add_function(s, callee->function(), callee);
+
+         foreach_in_list(ir_variable, param, &callee->parameters)
+            write_variable(s, param);
+      }
+
+      return visit_continue;
+   }
+
+   serialize_state *s;
+};
+
+void
+write_variable_ref(serialize_state *s, ir_variable *var)
+{
+   unsigned id = var ? lookup_id(s->var_ids, var) : 0;
+
+   /* A dereference of a variable that isn't declared in the list can't be
+    * reconstructed.
+    */
+   if (var != NULL && id == 0)
+      s->ok = false;
+
+   blob_write_uint32(s->blob, id);
+}
+
+void
+write_signature(serialize_state *s, const ir_function_signature *sig)
+{
+   encode_type_to_blob(s->blob, sig->return_type);
+   blob_write_uint32(s->blob, sig->is_defined);
+   blob_write_uint32(s->blob, sig->intrinsic_id);
+   blob_write_uint32(s->blob, sig->is_builtin());
+   blob_write_uint32(s->blob, sig->parameters.length());
+   foreach_in_list(ir_variable, param, &sig->parameters)
+      write_variable_ref(s, param);
+}
+
+void
+write_function_table(serialize_state *s)
+{
+   blob_write_uint32(s->blob, s->num_funcs);
+
+   for (unsigned i = 0; i < s->num_funcs; i++) {
+      const ir_function *func = s->funcs[i].func;
+
+      blob_write_string(s->blob, func->name);
+      blob_write_uint32(s->blob, func->is_subroutine);
+      blob_write_uint32(s->blob, func->subroutine_index);
+      blob_write_uint32(s->blob, func->num_subroutine_types);
+      for (int j = 0; j < func->num_subroutine_types; j++)
+         encode_type_to_blob(s->blob, func->subroutine_types[j]);
+
+      if (s->funcs[i].sig != NULL) {
+         blob_write_uint32(s->blob, 1);
+         write_signature(s, s->funcs[i].sig);
+      } else {
+         blob_write_uint32(s->blob, func->signatures.length());
+         foreach_in_list(ir_function_signature, sig, &func->signatures)
+            write_signature(s, sig);
+      }
+   }
+}
+
+void
+write_list(serialize_state *s, exec_list *list)
+{
+   blob_write_uint32(s->blob, list->length());
+   foreach_in_list(ir_instruction, ir, list)
+      write_instruction(s, ir);
+}
+
+void
+write_rvalue(serialize_state *s, ir_rvalue *ir)
+{
+   write_instruction(s, ir);
+}
+
+void
+write_texture(serialize_state *s, ir_texture *tex)
+{
+   blob_write_uint32(s->blob, tex->op);
+   encode_type_to_blob(s->blob, tex->type);
+   write_rvalue(s, tex->sampler);
+   write_rvalue(s, tex->coordinate);
+   write_rvalue(s, tex->projector);
+   write_rvalue(s, tex->shadow_comparitor);
+   write_rvalue(s, tex->offset);
+
+   switch (tex->op) {
+   case ir_tex:
+   case ir_lod:
+   case ir_query_levels:
+   case ir_texture_samples:
+   case ir_samples_identical:
+      break;
+   case ir_txb:
+      write_rvalue(s, tex->lod_info.bias);
+      break;
+   case ir_txl:
+   case ir_txf:
+   case ir_txs:
+      write_rvalue(s, tex->lod_info.lod);
+      break;
+   case ir_txf_ms:
+      write_rvalue(s, tex->lod_info.sample_index);
+      break;
+   case ir_txd:
+      write_rvalue(s, tex->lod_info.grad.dPdx);
+      write_rvalue(s, tex->lod_info.grad.dPdy);
+      break;
+   case ir_tg4:
+      write_rvalue(s, tex->lod_info.component);
+      break;
+   }
+}
+
+void
+write_instruction(serialize_state *s, ir_instruction *ir)
+{
+   if (ir == NULL) {
+      blob_write_uint32(s->blob, ir_type_unset);
+      return;
+   }
+
+   blob_write_uint32(s->blob, ir->ir_type);
+
+   switch (ir->ir_type) {
+   case ir_type_dereference_array: {
+      ir_dereference_array *deref = (ir_dereference_array *) ir;
+      write_rvalue(s, deref->array);
+      write_rvalue(s, deref->array_index);
+      break;
+   }
+   case ir_type_dereference_record: {
+      ir_dereference_record *deref = (ir_dereference_record *) ir;
+      write_rvalue(s, deref->record);
+      blob_write_string(s->blob, deref->field);
+      break;
+   }
+   case ir_type_dereference_variable:
+      write_variable_ref(s, ((ir_dereference_variable *) ir)->var);
+      break;
+   case ir_type_constant: {
+      ir_constant *c = (ir_constant *) ir;
+      encode_type_to_blob(s->blob, c->type);
+      if (c->type->is_array()) {
+         for (unsigned i = 0; i < c->type->length; i++)
+            write_rvalue(s, c->array_elements[i]);
+      } else if (c->type->is_record()) {
+         foreach_in_list(ir_constant, field, &c->components)
+            write_rvalue(s, field);
+      } else {
+         blob_write_bytes(s->blob, &c->value, sizeof(c->value));
+      }
+      break;
+   }
+   case ir_type_expression: {
+      ir_expression *expr = (ir_expression *) ir;
+      encode_type_to_blob(s->blob, expr->type);
+      blob_write_uint32(s->blob, expr->operation);
+      for (unsigned i = 0; i < ARRAY_SIZE(expr->operands); i++)
+         write_rvalue(s, i < expr->get_num_operands() ? expr->operands[i]
+                                                      : NULL);
+      break;
+   }
+   case ir_type_swizzle: {
+      ir_swizzle *swiz = (ir_swizzle *) ir;
+      write_rvalue(s, swiz->val);
+      blob_write_bytes(s->blob, &swiz->mask, sizeof(swiz->mask));
+      break;
+   }
+   case ir_type_texture:
+      write_texture(s, (ir_texture *) ir);
+      break;
+   case ir_type_variable:
+      write_variable_ref(s, (ir_variable *) ir);
+      break;
+   case ir_type_assignment: {
+      ir_assignment *assign = (ir_assignment *) ir;
+      write_rvalue(s, assign->lhs);
+      write_rvalue(s, assign->rhs);
+      write_rvalue(s, assign->condition);
+      blob_write_uint32(s->blob, assign->write_mask);
+      break;
+   }
+   case ir_type_call: {
+      ir_call *call = (ir_call *) ir;
+      blob_write_uint32(s->blob, lookup_id(s->sig_ids, call->callee));
+      write_rvalue(s, call->return_deref);
+      write_list(s, &call->actual_parameters);
+      write_variable_ref(s, call->sub_var);
+      write_rvalue(s, call->array_idx);
+      break;
+   }
+   case ir_type_function: {
+      ir_function *func = (ir_function *) ir;
+      blob_write_uint32(s->blob, lookup_id(s->func_ids, func));
+      foreach_in_list(ir_function_signature, sig, &func->signatures)
+         write_list(s, &sig->body);
+      break;
+   }
+   case ir_type_if: {
+      ir_if *iff = (ir_if *) ir;
+      write_rvalue(s, iff->condition);
+      write_list(s, &iff->then_instructions);
+      write_list(s, &iff->else_instructions);
+      break;
+   }
+   case ir_type_loop:
+      write_list(s, &((ir_loop *) ir)->body_instructions);
+      break;
+   case ir_type_loop_jump:
+      blob_write_uint32(s->blob, ((ir_loop_jump *) ir)->mode);
+      break;
+   case ir_type_return:
+      write_rvalue(s, ((ir_return *) ir)->value);
+      break;
+   case ir_type_discard:
+      write_rvalue(s, ((ir_discard *) ir)->condition);
+      break;
+   case ir_type_emit_vertex:
+      write_rvalue(s, ((ir_emit_vertex *) ir)->stream);
+      break;
+   case ir_type_end_primitive:
+      write_rvalue(s, ((ir_end_primitive *) ir)->stream);
+      break;
+   case ir_type_barrier:
+      break;
+   case ir_type_function_signature:
+   case ir_type_unset:
+      s->ok = false;
+      break;
+   }
+}
+
+struct deserialize_state {
+   struct blob_reader *blob;
+   void *mem_ctx;
+
+   ir_variable **vars;
+   unsigned num_vars;
+
+   ir_function **funcs;
+   unsigned num_funcs;
+
+   ir_function_signature **sigs;
+   unsigned num_sigs;
+
+   bool ok;
+};
+
+ir_instruction *read_instruction(deserialize_state *s);
+
+bool
+builtin_always_available(const _mesa_glsl_parse_state *)
+{
+   return true;
+}
+
+/**
+ * Read an optional rvalue; sets the error flag if what was read isn't an
+ * rvalue.
+ */
+ir_rvalue *
+read_rvalue(deserialize_state *s)
+{
+   ir_instruction *ir = read_instruction(s);
+
+   if (ir == NULL)
+      return NULL;
+
+   if (!ir->is_rvalue()) {
+      s->ok = false;
+      return NULL;
+   }
+
+   return (ir_rvalue *) ir;
+}
+
+/**
+ * Read a mandatory rvalue.
+ */
+ir_rvalue *
+read_required_rvalue(deserialize_state *s)
+{
+   ir_rvalue *rv = read_rvalue(s);
+   if (rv == NULL)
+      s->ok = false;
+   return rv;
+}
+
+ir_variable *
+read_variable_ref(deserialize_state *s)
+{
+   unsigned id = blob_read_uint32(s->blob);
+
+   if (id == 0)
+      return NULL;
+
+   if (id > s->num_vars) {
+      s->ok = false;
+      return NULL;
+   }
+
+   return s->vars[id - 1];
+}
+
+bool
+read_variables(deserialize_state *s)
+{
+   while (blob_read_uint32(s->blob) == 1 && !s->blob->overrun) {
+      const glsl_type *type = decode_type_from_blob(s->blob);
+      const char *name = blob_read_string(s->blob);
+      ir_variable::ir_variable_data *data = (ir_variable::ir_variable_data *)
+         blob_read_bytes(s->blob, sizeof(*data));
+
+      if (type == NULL || name == NULL || s->blob->overrun)
+         return false;
+
+      ir_variable *var =
+         new(s->mem_ctx) ir_variable(type, name,
+                                     (ir_variable_mode) data->mode);
+
+      const glsl_type *ifc_type = decode_type_from_blob(s->blob);
+      if (ifc_type != NULL)
+         var->init_interface_type(ifc_type);
+
+      memcpy(&var->data, data, sizeof(var->data));
+
+      if (var->is_interface_instance()) {
+         blob_copy_bytes(s->blob, (uint8_t *) var->get_max_ifc_array_access(),
+                         ifc_type->length * sizeof(int));
+      } else if (var->get_num_state_slots()) {
+         ir_state_slot *slots =
+            var->allocate_state_slots(var->get_num_state_slots());
+         blob_copy_bytes(s->blob, (uint8_t *) slots,
+                         var->get_num_state_slots() * sizeof(ir_state_slot));
+      }
+
+      var->constant_value = (ir_constant *) read_rvalue(s);
+      var->constant_initializer = (ir_constant *) read_rvalue(s);
+      if (!s->ok)
+         return false;
+
+      s->vars = reralloc(s->mem_ctx, s->vars, ir_variable *, s->num_vars + 1);
+      s->vars[s->num_vars++] = var;
+   }
+
+   return !s->blob->overrun;
+}
+
+bool
+read_function_table(deserialize_state *s)
+{
+   s->num_funcs = blob_read_uint32(s->blob);
+   if (s->blob->overrun)
+      return false;
+
+   s->funcs = ralloc_array(s->mem_ctx, ir_function *, s->num_funcs);
+
+   for (unsigned i = 0; i < s->num_funcs; i++) {
+      const char *name = blob_read_string(s->blob);
+      if (name == NULL)
+         return false;
+
+      ir_function *func = new(s->mem_ctx) ir_function(name);
+      func->is_subroutine = blob_read_uint32(s->blob);
+      func->subroutine_index = blob_read_uint32(s->blob);
+      func->num_subroutine_types = blob_read_uint32(s->blob);
+      if (s->blob->overrun)
+         return false;
+
+      func->subroutine_types =
+         ralloc_array(s->mem_ctx, const struct glsl_type *,
+                      func->num_subroutine_types);
+      for (int j = 0; j < func->num_subroutine_types; j++)
+         func->subroutine_types[j] = decode_type_from_blob(s->blob);
+
+      unsigned num_sigs = blob_read_uint32(s->blob);
+      for (unsigned j = 0; j < num_sigs && !s->blob->overrun; j++) {
+         const glsl_type *return_type = decode_type_from_blob(s->blob);
+         const bool is_defined = blob_read_uint32(s->blob);
+         const ir_intrinsic_id intrinsic_id =
+            (ir_intrinsic_id) blob_read_uint32(s->blob);
+         const bool is_builtin = blob_read_uint32(s->blob);
+
+         if (return_type == NULL)
+            return false;
+
+         ir_function_signature *sig =
+            new(s->mem_ctx) ir_function_signature(return_type,
+               is_builtin ? builtin_always_available : NULL);
+         sig->is_defined = is_defined;
+         sig->intrinsic_id = intrinsic_id;
+
+         unsigned num_params = blob_read_uint32(s->blob);
+         for (unsigned k = 0; k < num_params && !s->blob->overrun; k++) {
+            ir_variable *param = read_variable_ref(s);
+            if (param == NULL)
+               return false;
+            sig->parameters.push_tail(param);
+         }
+
+         func->add_signature(sig);
+
+         s->sigs = reralloc(s->mem_ctx, s->sigs, ir_function_signature *,
+                            s->num_sigs + 1);
+         s->sigs[s->num_sigs++] = sig;
+      }
+
+      s->funcs[i] = func;
+   }
+
+   return s->ok && !s->blob->overrun;
+}
+
+bool
+read_list(deserialize_state *s, exec_list *list)
+{
+   unsigned length = blob_read_uint32(s->blob);
+
+   for (unsigned i = 0; i < length && s->ok && !s->blob->overrun; i++) {
+      ir_instruction *ir = read_instruction(s);
+      if (ir == NULL) {
+         s->ok = false;
+         break;
+      }
+      list->push_tail(ir);
+   }
+
+   return s->ok && !s->blob->overrun;
+}
+
+ir_texture *
+read_texture(deserialize_state *s)
+{
+   ir_texture *tex =
+      new(s->mem_ctx) ir_texture((ir_texture_opcode) blob_read_uint32(s->blob));
+   const glsl_type *type = decode_type_from_blob(s->blob);
+   ir_rvalue *sampler = read_required_rvalue(s);
+
+   if (!s->ok || type == NULL || sampler->as_dereference() == NULL) {
+      s->ok = false;
+      return NULL;
+   }
+
+   tex->set_sampler(sampler->as_dereference(), type);
+   tex->coordinate = read_rvalue(s);
+   tex->projector = read_rvalue(s);
+   tex->shadow_comparitor = read_rvalue(s);
+   tex->offset = read_rvalue(s);
+
+   switch (tex->op) {
+   case ir_tex:
+   case ir_lod:
+   case ir_query_levels:
+   case ir_texture_samples:
+   case ir_samples_identical:
+      break;
+   case ir_txb:
+      tex->lod_info.bias = read_required_rvalue(s);
+      break;
+   case ir_txl:
+   case ir_txf:
+   case ir_txs:
+      tex->lod_info.lod = read_required_rvalue(s);
+      break;
+   case ir_txf_ms:
+      tex->lod_info.sample_index = read_required_rvalue(s);
+      break;
+   case ir_txd:
+      tex->lod_info.grad.dPdx = read_required_rvalue(s);
+      tex->lod_info.grad.dPdy = read_required_rvalue(s);
+      break;
+   case ir_tg4:
+      tex->lod_info.component = read_required_rvalue(s);
+      break;
+   default:
+      s->ok = false;
+      break;
+   }
+
+   return s->ok ? tex : NULL;
+}
+
+ir_instruction *
+read_instruction(deserialize_state *s)
+{
+   const uint32_t tag = blob_read_uint32(s->blob);
+   void *mem_ctx = s->mem_ctx;
+
+   if (!s->ok || s->blob->overrun || tag == ir_type_unset)
+      return NULL;
+
+   switch ((ir_node_type) tag) {
+   case ir_type_dereference_array: {
+      ir_rvalue *array = read_required_rvalue(s);
+      ir_rvalue *index = read_required_rvalue(s);
+      if (!s->ok)
+         return NULL;
+      return new(mem_ctx) ir_dereference_array(array, index);
+   }
+   case ir_type_dereference_record: {
+      ir_rvalue *record = read_required_rvalue(s);
+      const char *field = blob_read_string(s->blob);
+      if (!s->ok || field == NULL)
+         break;
+      return new(mem_ctx) ir_dereference_record(record, field);
+   }
+   case ir_type_dereference_variable: {
+      ir_variable *var = read_variable_ref(s);
+      if (var == NULL)
+         break;
+      return new(mem_ctx) ir_dereference_variable(var);
+   }
+   case ir_type_constant: {
+      const glsl_type *type = decode_type_from_blob(s->blob);
+      if (type == NULL)
+         break;
+
+      if (type->is_array() || type->is_record()) {
+         exec_list values;
+         for (unsigned i = 0; i < type->length; i++) {
+            ir_rvalue *value = read_required_rvalue(s);
+            if (!s->ok || value->as_constant() == NULL) {
+               s->ok = false;
+               return NULL;
+            }
+            values.push_tail(value);
+         }
+         return new(mem_ctx) ir_constant(type, &values);
+      }
+
+      const ir_constant_data *data = (const ir_constant_data *)
+         blob_read_bytes(s->blob, sizeof(ir_constant_data));
+      if (s->blob->overrun)
+         break;
+      return new(mem_ctx) ir_constant(type, data);
+   }
+   case ir_type_expression: {
+      const glsl_type *type = decode_type_from_blob(s->blob);
+      const ir_expression_operation op =
+         (ir_expression_operation) blob_read_uint32(s->blob);
+      ir_rvalue *operands[4];
+      for (unsigned i = 0; i < ARRAY_SIZE(operands); i++)
+         operands[i] = read_rvalue(s);
+      if (!s->ok || type == NULL || operands[0] == NULL)
+         break;
+      return new(mem_ctx) ir_expression(op, type, operands[0], operands[1],
+                                        operands[2], operands[3]);
+   }
+   case ir_type_swizzle: {
+      ir_rvalue *val = read_required_rvalue(s);
+      ir_swizzle_mask mask;
+      blob_copy_bytes(s->blob, (uint8_t *) &mask, sizeof(mask));
+      if (!s->ok || s->blob->overrun)
+         break;
+      return new(mem_ctx) ir_swizzle(val, mask);
+   }
+   case ir_type_texture:
+      return read_texture(s);
+   case ir_type_variable:
+      return read_variable_ref(s);
+   case ir_type_assignment: {
+      ir_rvalue *lhs = read_required_rvalue(s);
+      ir_rvalue *rhs = read_required_rvalue(s);
+      ir_rvalue *condition = read_rvalue(s);
+      const unsigned write_mask = blob_read_uint32(s->blob);
+      if (!s->ok || s->blob->overrun)
+         break;
+      ir_assignment *assign =
+         new(mem_ctx) ir_assignment(lhs, rhs, condition);
+      assign->write_mask = write_mask;
+      return assign;
+   }
+   case ir_type_call: {
+      const unsigned sig_id = blob_read_uint32(s->blob);
+      ir_rvalue *return_deref = read_rvalue(s);
+      exec_list params;
+      read_list(s, &params);
+      ir_variable *sub_var = read_variable_ref(s);
+      ir_rvalue *array_idx = read_rvalue(s);
+
+      if (!s->ok || sig_id == 0 || sig_id > s->num_sigs ||
+          (return_deref != NULL &&
+           return_deref->ir_type != ir_type_dereference_variable))
+         break;
+
+      return new(mem_ctx) ir_call(s->sigs[sig_id - 1],
+                                  (ir_dereference_variable *) return_deref,
+                                  &params, sub_var, array_idx);
+   }
+   case ir_type_function: {
+      const unsigned func_id = blob_read_uint32(s->blob);
+      if (func_id == 0 || func_id > s->num_funcs)
+         break;
+
+      ir_function *func = s->funcs[func_id - 1];
+      foreach_in_list(ir_function_signature, sig, &func->signatures) {
+         if (!read_list(s, &sig->body))
+            return NULL;
+      }
+      return func;
+   }
+   case ir_type_if: {
+      ir_rvalue *condition = read_required_rvalue(s);
+      if (!s->ok)
+         break;
+
+      ir_if *iff = new(mem_ctx) ir_if(condition);
+      if (!read_list(s, &iff->then_instructions) ||
+          !read_list(s, &iff->else_instructions))
+         break;
+      return iff;
+   }
+   case ir_type_loop: {
+      ir_loop *loop = new(mem_ctx) ir_loop();
+      if (!read_list(s, &loop->body_instructions))
+         break;
+      return loop;
+   }
+   case ir_type_loop_jump:
+      return new(mem_ctx)
+         ir_loop_jump((ir_loop_jump::jump_mode) blob_read_uint32(s->blob));
+   case ir_type_return: {
+      ir_rvalue *value = read_rvalue(s);
+      if (!s->ok)
+         break;
+      return value ? new(mem_ctx) ir_return(value) : new(mem_ctx) ir_return;
+   }
+   case ir_type_discard: {
+      ir_rvalue *condition = read_rvalue(s);
+      if (!s->ok)
+         break;
+      return new(mem_ctx) ir_discard(condition);
+   }
+   case ir_type_emit_vertex: {
+      ir_rvalue *stream = read_required_rvalue(s);
+      if (!s->ok)
+         break;
+      return new(mem_ctx) ir_emit_vertex(stream);
+   }
+   case ir_type_end_primitive: {
+      ir_rvalue *stream = read_required_rvalue(s);
+      if (!s->ok)
+         break;
+      return new(mem_ctx) ir_end_primitive(stream);
+   }
+   case ir_type_barrier:
+      return new(mem_ctx) ir_barrier;
+   default:
+      break;
+   }
+
+   s->ok = false;
+   return NULL;
+}
+
+} /* anonymous namespace */
+
+bool
+serialize_ir(struct blob *blob, exec_list *ir)
+{
+   serialize_state s;
+
+   s.blob = blob;
+   s.var_ids = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
+                                       _mesa_key_pointer_equal);
+   s.sig_ids = _mesa_hash_table_create(s.var_ids, _mesa_hash_pointer,
+                                       _mesa_key_pointer_equal);
+   s.func_ids = _mesa_hash_table_create(s.var_ids, _mesa_hash_pointer,
+                                        _mesa_key_pointer_equal);
+   s.num_vars = 0;
+   s.num_sigs = 0;
+   s.funcs = NULL;
+   s.num_funcs = 0;
+   s.ok = true;
+
+   /* Functions defined in the list get the first entries of the function
+    * table, so calls to them don't get mistaken for external prototypes.
+    */
+   foreach_in_list(ir_instruction, node, ir) {
+      ir_function *func = node->as_function();
+      if (func == NULL)
+         continue;
+
+      add_function(&s, func, NULL);
+      foreach_in_list(ir_function_signature, sig, &func->signatures)
+         add_signature(&s, sig);
+   }
+
+   collect_visitor collect(&s);
+   collect.run(ir);
+   blob_write_uint32(blob, 0);
+
+   write_function_table(&s);
+   write_list(&s, ir);
+
+   _mesa_hash_table_destroy(s.var_ids, NULL);
+
+   return s.ok;
+}
+
+bool
+deserialize_ir(void *mem_ctx, struct blob_reader *blob, exec_list *ir)
+{
+   deserialize_state s;
+
+   s.blob = blob;
+   s.mem_ctx = mem_ctx;
+   s.vars = NULL;
+   s.num_vars = 0;
+   s.funcs = NULL;
+   s.num_funcs = 0;
+   s.sigs = NULL;
+   s.num_sigs = 0;
+   s.ok = true;
+
+   return read_variables(&s) &&
+          read_function_table(&s) &&
+          read_list(&s, ir);
+}
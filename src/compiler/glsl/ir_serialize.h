@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+#ifndef IR_SERIALIZE_H
+#define IR_SERIALIZE_H
+
+/**
+ * \file ir_serialize.h
+ *
+ * Flattening of GLSL IR instruction lists into a blob and back.
+ *
+ * The encoding is private to a single build of Mesa: it records raw
+ * ir_variable_data and ir_constant_data bytes, so callers must make sure a
+ * blob is only ever read back by the same build that wrote it (the shader
+ * cache does this by hashing the build id into its keys).
+ */
+
+struct blob;
+struct blob_reader;
+struct exec_list;
+
+/**
+ * Write the instructions in \c ir to \c blob.
+ *
+ * Every variable dereferenced by \c ir must be declared somewhere in \c ir.
+ * Functions that are called but not defined in \c ir (e.g. intrinsics) are
+ * written as prototypes.
+ *
+ * \return false if the list contains something that can't be serialized, in
+ *         which case the contents of \c blob must be discarded.
+ */
+bool
+serialize_ir(struct blob *blob, exec_list *ir);
+
+/**
+ * Read instructions written by serialize_ir() and append them to \c ir.
+ *
+ * All new IR is allocated out of \c mem_ctx.
+ *
+ * \return false if the data is truncated or malformed.
+ */
+bool
+deserialize_ir(void *mem_ctx, struct blob_reader *blob, exec_list *ir);
+
+#endif /* IR_SERIALIZE_H */
@@ -38,30 +38,18 @@
 ir_variable_refcount_visitor::ir_variable_refcount_visitor()
 {
    this->mem_ctx = ralloc_context(NULL);
+   this->linalloc = linear_alloc_parent(this->mem_ctx, 0);
    this->ht = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
                                       _mesa_key_pointer_equal);
 }
 
-static void
-free_entry(struct hash_entry *entry)
-{
-   ir_variable_refcount_entry *ivre = (ir_variable_refcount_entry *) entry->data;
-
-   /* Free assignment list */
-   exec_node *n;
-   while ((n = ivre->assign_list.pop_head()) != NULL) {
-      struct assignment_entry *assignment_entry =
-         exec_node_data(struct assignment_entry, n, link);
-      free(assignment_entry);
-   }
-
-   delete ivre;
-}
-
 ir_variable_refcount_visitor::~ir_variable_refcount_visitor()
 {
+   /* The entries and their assignment lists all live in the linear
+    * allocator, so freeing mem_ctx releases them in a few large blocks.
+    */
    ralloc_free(this->mem_ctx);
-   _mesa_hash_table_destroy(this->ht, free_entry);
+   _mesa_hash_table_destroy(this->ht, NULL);
 }
 
 // constructor
@@ -79,13 +67,20 @@ ir_variable_refcount_visitor::get_variable_entry(ir_variable *var)
 {
    assert(var);
 
-   struct hash_entry *e = _mesa_hash_table_search(this->ht, var);
+   /* Every reference to a variable not seen before is a search miss
+    * followed by an insert; hash the key only once.
+    */
+   const uint32_t hash = _mesa_hash_pointer(var);
+
+   struct hash_entry *e =
+      _mesa_hash_table_search_pre_hashed(this->ht, hash, var);
    if (e)
       return (ir_variable_refcount_entry *)e->data;
 
-   ir_variable_refcount_entry *entry = new ir_variable_refcount_entry(var);
+   ir_variable_refcount_entry *entry =
+      new(this->linalloc) ir_variable_refcount_entry(var);
    assert(entry->referenced_count == 0);
-   _mesa_hash_table_insert(this->ht, var, entry);
+   _mesa_hash_table_insert_pre_hashed(this->ht, hash, var, entry);
 
    return entry;
 }
@@ -143,7 +138,8 @@ ir_variable_refcount_visitor::visit_leave(ir_assignment *ir)
       assert(entry->referenced_count >= entry->assigned_count);
       if (entry->referenced_count == entry->assigned_count) {
          struct assignment_entry *assignment_entry =
-            (struct assignment_entry *)calloc(1, sizeof(*assignment_entry));
+            (struct assignment_entry *)
+            linear_zalloc_child(this->linalloc, sizeof(*assignment_entry));
          assignment_entry->assign = ir;
          entry->assign_list.push_head(&assignment_entry->link);
       }
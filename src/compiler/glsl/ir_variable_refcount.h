@@ -59,6 +59,8 @@ public:
    unsigned assigned_count;
 
    bool declaration; /* If the variable had a decl in the instruction stream */
+
+   DECLARE_LINEAR_ALLOC_CXX_OPERATORS(ir_variable_refcount_entry)
 };
 
 class ir_variable_refcount_visitor : public ir_hierarchical_visitor {
@@ -83,4 +85,10 @@ public:
    struct hash_table *ht;
 
    void *mem_ctx;
+
+   /**
+    * Linear allocator (child of \c mem_ctx) for the entries in \c ht and
+    * their assignment lists.
+    */
+   void *linalloc;
 };
@@ -1215,6 +1215,8 @@ link_assign_uniform_storage(struct gl_context *ctx,
    union gl_constant_value *data = rzalloc_array(prog->data->UniformStorage,
                                                  union gl_constant_value,
                                                  num_data_slots);
+   prog->data->UniformDataSlots = data;
+   prog->data->NumUniformDataSlots = num_data_slots;
 #ifndef NDEBUG
    union gl_constant_value *data_end = &data[num_data_slots];
 #endif
@@ -1271,6 +1273,8 @@ link_assign_uniform_locations(struct gl_shader_program *prog,
    ralloc_free(prog->data->UniformStorage);
    prog->data->UniformStorage = NULL;
    prog->data->NumUniformStorage = 0;
+   prog->data->UniformDataSlots = NULL;
+   prog->data->NumUniformDataSlots = 0;
 
    if (prog->UniformHash != NULL) {
       prog->UniformHash->clear();
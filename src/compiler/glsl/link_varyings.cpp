@@ -32,11 +32,14 @@
 #include "main/mtypes.h"
 #include "glsl_symbol_table.h"
 #include "glsl_parser_extras.h"
+#include "ir_hierarchical_visitor.h"
 #include "ir_optimization.h"
 #include "linker.h"
 #include "link_varyings.h"
 #include "main/macros.h"
+#include "util/bitscan.h"
 #include "util/hash_table.h"
+#include "util/set.h"
 #include "program.h"
 
 
@@ -1980,6 +1983,188 @@ canonicalize_shader_io(exec_list *ir, enum ir_variable_mode io_mode)
    }
 }
 
+namespace {
+
+/**
+ * Finds the components of the vector shader inputs or outputs that a shader
+ * reads.
+ *
+ * Components read through a swizzle are recorded one by one, and any other
+ * use of a variable counts as a read of all of its components, except for
+ * whole-variable writes.
+ */
+class varying_component_reads : public ir_hierarchical_visitor {
+public:
+   varying_component_reads(ir_variable_mode mode)
+      : mode(mode)
+   {
+      masks = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
+                                      _mesa_key_pointer_equal);
+   }
+
+   ~varying_component_reads()
+   {
+      _mesa_hash_table_destroy(masks, NULL);
+   }
+
+   unsigned get_mask(ir_variable *var) const
+   {
+      hash_entry *entry = _mesa_hash_table_search(masks, var);
+      return entry ? (uintptr_t) entry->data : 0;
+   }
+
+   virtual ir_visitor_status visit_enter(ir_assignment *ir)
+   {
+      ir_dereference_variable *lhs = ir->lhs->as_dereference_variable();
+      if (lhs == NULL || !is_tracked(lhs->var))
+         return visit_continue;
+
+      ir->rhs->accept(this);
+      if (ir->condition)
+         ir->condition->accept(this);
+      return visit_continue_with_parent;
+   }
+
+   virtual ir_visitor_status visit_enter(ir_swizzle *ir)
+   {
+      ir_dereference_variable *deref = ir->val->as_dereference_variable();
+      if (deref == NULL || !is_tracked(deref->var))
+         return visit_continue;
+
+      const unsigned comps[4] = {
+         ir->mask.x, ir->mask.y, ir->mask.z, ir->mask.w
+      };
+      unsigned mask = 0;
+      for (unsigned i = 0; i < ir->mask.num_components; i++)
+         mask |= 1u << comps[i];
+
+      add_mask(deref->var, mask);
+      return visit_continue_with_parent;
+   }
+
+   virtual ir_visitor_status visit(ir_dereference_variable *ir)
+   {
+      if (is_tracked(ir->var))
+         add_mask(ir->var, (1u << ir->var->type->vector_elements) - 1);
+      return visit_continue;
+   }
+
+private:
+   bool is_tracked(const ir_variable *var) const
+   {
+      return var->data.mode == mode && var->type->is_vector();
+   }
+
+   void add_mask(ir_variable *var, unsigned mask)
+   {
+      _mesa_hash_table_insert(masks, var,
+                              (void *) (uintptr_t) (get_mask(var) | mask));
+   }
+
+   ir_variable_mode mode;
+   hash_table *masks;
+};
+
+/**
+ * Updates the IR after narrow_varying() dropped the trailing
+ * components of some variables: dereferences get the new type, and writes
+ * to the dropped components are removed.
+ */
+class narrowed_varying_visitor : public ir_hierarchical_visitor {
+public:
+   narrowed_varying_visitor(set *vars)
+      : vars(vars)
+   {
+   }
+
+   virtual ir_visitor_status visit(ir_dereference_variable *ir)
+   {
+      if (_mesa_set_search(vars, ir->var))
+         ir->type = ir->var->type;
+      return visit_continue;
+   }
+
+   virtual ir_visitor_status visit_leave(ir_assignment *ir)
+   {
+      ir_dereference_variable *lhs = ir->lhs->as_dereference_variable();
+      if (lhs == NULL || !_mesa_set_search(vars, lhs->var))
+         return visit_continue;
+
+      const unsigned kept_mask =
+         ir->write_mask & ((1u << lhs->type->vector_elements) - 1);
+
+      if (kept_mask == ir->write_mask)
+         return visit_continue;
+
+      if (kept_mask == 0) {
+         ir->remove();
+         return visit_continue;
+      }
+
+      /* Component i of the RHS is written to the i-th enabled component. */
+      unsigned comps[4];
+      unsigned count = 0;
+      for (unsigned i = 0; i < 4; i++) {
+         if (kept_mask & (1u << i))
+            comps[count++] = _mesa_bitcount(ir->write_mask & ((1u << i) - 1));
+      }
+
+      ir->rhs = new(ralloc_parent(ir)) ir_swizzle(ir->rhs, comps, count);
+      ir->write_mask = kept_mask;
+      return visit_continue;
+   }
+
+private:
+   set *vars;
+};
+
+} /* anonymous namespace */
+
+/**
+ * Drops the trailing components of a vector varying that neither the
+ * consumer nor the producer reads, e.g. a vec4 that the fragment shader
+ * only reads as .xy becomes a vec2.  varying_matches can then pack the
+ * remaining components with other varyings, which saves varying slots.
+ *
+ * The types of \p output_var and \p input_var are changed right away, so
+ * that they are recorded with their new size; the IR is fixed up later by
+ * narrowed_varying_visitor.
+ */
+static bool
+narrow_varying(ir_variable *output_var, ir_variable *input_var,
+               const varying_component_reads &producer_reads,
+               const varying_component_reads &consumer_reads)
+{
+   const glsl_type *type = output_var->type;
+
+   if (!type->is_vector() || input_var->type != type ||
+       !output_var->data.is_unmatched_generic_inout ||
+       !input_var->data.is_unmatched_generic_inout ||
+       output_var->data.explicit_location ||
+       input_var->data.explicit_location ||
+       output_var->data.explicit_component ||
+       input_var->data.explicit_component ||
+       output_var->get_interface_type() != NULL)
+      return false;
+
+   const unsigned consumer_mask = consumer_reads.get_mask(input_var);
+   const unsigned used_mask = consumer_mask |
+                              producer_reads.get_mask(output_var);
+
+   /* Unread inputs are left to the rest of the linker. */
+   if (consumer_mask == 0)
+      return false;
+
+   const unsigned num_components = util_last_bit(used_mask);
+   if (num_components >= type->vector_elements)
+      return false;
+
+   type = glsl_type::get_instance(type->base_type, num_components, 1);
+   output_var->type = type;
+   input_var->type = type;
+   return true;
+}
+
 /**
  * Generate a bitfield map of the explicit locations for shader varyings.
  *
@@ -2132,6 +2317,22 @@ assign_varying_locations(struct gl_context *ctx,
                                            consumer_interface_inputs,
                                            consumer_inputs_with_locations);
 
+   /* Components of varyings that are never read can only be dropped when
+    * both sides of the interface are known and nothing else looks at it.
+    */
+   const bool narrow_varyings = producer && consumer &&
+      !disable_varying_packing && num_tfeedback_decls == 0;
+   varying_component_reads producer_reads(ir_var_shader_out);
+   varying_component_reads consumer_reads(ir_var_shader_in);
+   set *narrowed_varyings = NULL;
+
+   if (narrow_varyings) {
+      producer_reads.run(producer->ir);
+      consumer_reads.run(consumer->ir);
+      narrowed_varyings = _mesa_set_create(mem_ctx, _mesa_hash_pointer,
+                                           _mesa_key_pointer_equal);
+   }
+
    if (producer) {
       foreach_in_list(ir_instruction, node, producer->ir) {
          ir_variable *const output_var = node->as_variable();
@@ -2161,6 +2362,13 @@ assign_varying_locations(struct gl_context *ctx,
           * Always add TCS outputs. They are shared by all invocations
           * within a patch and can be used as shared memory.
           */
+         if (narrow_varyings && input_var &&
+             narrow_varying(output_var, input_var,
+                            producer_reads, consumer_reads)) {
+            _mesa_set_add(narrowed_varyings, output_var);
+            _mesa_set_add(narrowed_varyings, input_var);
+         }
+
          if (input_var || (prog->SeparateShader && consumer == NULL) ||
              producer->Stage == MESA_SHADER_TESS_CTRL) {
             matches.record(output_var, input_var);
@@ -2194,6 +2402,12 @@ assign_varying_locations(struct gl_context *ctx,
    _mesa_hash_table_destroy(consumer_inputs, NULL);
    _mesa_hash_table_destroy(consumer_interface_inputs, NULL);
 
+   if (narrowed_varyings && narrowed_varyings->entries) {
+      narrowed_varying_visitor v(narrowed_varyings);
+      v.run(producer->ir);
+      v.run(consumer->ir);
+   }
+
    for (unsigned i = 0; i < num_tfeedback_decls; ++i) {
       if (!tfeedback_decls[i].is_varying())
          continue;
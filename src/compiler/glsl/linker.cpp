@@ -80,6 +80,7 @@
 #include "ir_optimization.h"
 #include "ir_rvalue_visitor.h"
 #include "ir_uniform.h"
+#include "shader_cache.h"
 
 #include "main/shaderobj.h"
 #include "main/enums.h"
@@ -2090,6 +2091,85 @@ link_cs_input_layout_qualifiers(struct gl_shader_program *prog,
 }
 
 
+/**
+ * Merged IR of one stage, kept from an earlier link of the same program.
+ *
+ * Applications that swap a single stage and relink would otherwise redo the
+ * intrastage merge (cloning every compilation unit, resolving calls and
+ * pulling in built-in functions) for the stages that did not change.  The
+ * snapshot is taken before any program-wide processing touches the IR, and
+ * is only reused if the stage is made of the same shader objects, in the
+ * same order, and none of them has been recompiled since.
+ */
+struct intrastage_snapshot {
+   unsigned num_shaders;
+   struct gl_shader **shaders;
+   unsigned *serials;
+   exec_list *ir;
+};
+
+struct gl_link_cache {
+   /** Number of times link_shaders() ran for the program */
+   unsigned num_links;
+
+   struct intrastage_snapshot *stages[MESA_SHADER_STAGES];
+};
+
+static const intrastage_snapshot *
+find_intrastage_snapshot(const struct gl_shader_program *prog,
+                         struct gl_shader **shader_list,
+                         unsigned num_shaders)
+{
+   if (prog->LinkCache == NULL)
+      return NULL;
+
+   const intrastage_snapshot *const snap =
+      prog->LinkCache->stages[shader_list[0]->Stage];
+
+   if (snap == NULL || snap->num_shaders != num_shaders)
+      return NULL;
+
+   for (unsigned i = 0; i < num_shaders; i++) {
+      if (snap->shaders[i] != shader_list[i] ||
+          snap->serials[i] != shader_list[i]->CompileSerial)
+         return NULL;
+   }
+
+   return snap;
+}
+
+static void
+save_intrastage_snapshot(struct gl_shader_program *prog,
+                         struct gl_shader **shader_list,
+                         unsigned num_shaders, exec_list *ir)
+{
+   /* Most programs are only ever linked once.  Don't pay for a copy of the
+    * IR until the program is relinked.
+    */
+   if (prog->LinkCache == NULL || prog->LinkCache->num_links < 2)
+      return;
+
+   const gl_shader_stage stage = shader_list[0]->Stage;
+
+   ralloc_free(prog->LinkCache->stages[stage]);
+
+   intrastage_snapshot *const snap =
+      ralloc(prog->LinkCache, intrastage_snapshot);
+   snap->num_shaders = num_shaders;
+   snap->shaders = ralloc_array(snap, gl_shader *, num_shaders);
+   snap->serials = ralloc_array(snap, unsigned, num_shaders);
+   for (unsigned i = 0; i < num_shaders; i++) {
+      snap->shaders[i] = shader_list[i];
+      snap->serials[i] = shader_list[i]->CompileSerial;
+   }
+
+   snap->ir = new(snap) exec_list;
+   clone_ir_list(snap, snap->ir, ir);
+
+   prog->LinkCache->stages[stage] = snap;
+}
+
+
 /**
  * Combine a group of shaders for a single stage to generate a linked shader
  *
@@ -2110,84 +2190,97 @@ link_intrastage_shaders(void *mem_ctx,
    unsigned num_ubo_blocks = 0;
    unsigned num_ssbo_blocks = 0;
 
-   /* Check that global variables defined in multiple shaders are consistent.
+   /* A stage made of the same shaders as in the previous link of this
+    * program already passed the checks below, and its merged IR can be
+    * copied instead of being rebuilt.
     */
-   glsl_symbol_table variables;
-   for (unsigned i = 0; i < num_shaders; i++) {
-      if (shader_list[i] == NULL)
-         continue;
-      cross_validate_globals(prog, shader_list[i]->ir, &variables, false);
-   }
-
-   if (!prog->data->LinkStatus)
-      return NULL;
+   const intrastage_snapshot *const snapshot = allow_missing_main ? NULL :
+      find_intrastage_snapshot(prog, shader_list, num_shaders);
+   gl_shader *main = NULL;
 
-   /* Check that interface blocks defined in multiple shaders are consistent.
-    */
-   validate_intrastage_interface_blocks(prog, (const gl_shader **)shader_list,
-                                        num_shaders);
-   if (!prog->data->LinkStatus)
-      return NULL;
+   if (snapshot == NULL) {
+      /* Check that global variables defined in multiple shaders are
+       * consistent.
+       */
+      glsl_symbol_table variables;
+      for (unsigned i = 0; i < num_shaders; i++) {
+         if (shader_list[i] == NULL)
+            continue;
+         cross_validate_globals(prog, shader_list[i]->ir, &variables, false);
+      }
 
-   /* Check that there is only a single definition of each function signature
-    * across all shaders.
-    */
-   for (unsigned i = 0; i < (num_shaders - 1); i++) {
-      foreach_in_list(ir_instruction, node, shader_list[i]->ir) {
-         ir_function *const f = node->as_function();
+      if (!prog->data->LinkStatus)
+         return NULL;
 
-         if (f == NULL)
-            continue;
+      /* Check that interface blocks defined in multiple shaders are
+       * consistent.
+       */
+      validate_intrastage_interface_blocks(prog,
+                                           (const gl_shader **)shader_list,
+                                           num_shaders);
+      if (!prog->data->LinkStatus)
+         return NULL;
 
-         for (unsigned j = i + 1; j < num_shaders; j++) {
-            ir_function *const other =
-               shader_list[j]->symbols->get_function(f->name);
+      /* Check that there is only a single definition of each function
+       * signature across all shaders.
+       */
+      for (unsigned i = 0; i < (num_shaders - 1); i++) {
+         foreach_in_list(ir_instruction, node, shader_list[i]->ir) {
+            ir_function *const f = node->as_function();
 
-            /* If the other shader has no function (and therefore no function
-             * signatures) with the same name, skip to the next shader.
-             */
-            if (other == NULL)
+            if (f == NULL)
                continue;
 
-            foreach_in_list(ir_function_signature, sig, &f->signatures) {
-               if (!sig->is_defined)
+            for (unsigned j = i + 1; j < num_shaders; j++) {
+               ir_function *const other =
+                  shader_list[j]->symbols->get_function(f->name);
+
+               /* If the other shader has no function (and therefore no
+                * function signatures) with the same name, skip to the next
+                * shader.
+                */
+               if (other == NULL)
                   continue;
 
-               ir_function_signature *other_sig =
-                  other->exact_matching_signature(NULL, &sig->parameters);
+               foreach_in_list(ir_function_signature, sig, &f->signatures) {
+                  if (!sig->is_defined)
+                     continue;
+
+                  ir_function_signature *other_sig =
+                     other->exact_matching_signature(NULL, &sig->parameters);
 
-               if (other_sig != NULL && other_sig->is_defined) {
-                  linker_error(prog, "function `%s' is multiply defined\n",
-                               f->name);
-                  return NULL;
+                  if (other_sig != NULL && other_sig->is_defined) {
+                     linker_error(prog, "function `%s' is multiply defined\n",
+                                  f->name);
+                     return NULL;
+                  }
                }
             }
          }
       }
-   }
 
-   /* Find the shader that defines main, and make a clone of it.
-    *
-    * Starting with the clone, search for undefined references.  If one is
-    * found, find the shader that defines it.  Clone the reference and add
-    * it to the shader.  Repeat until there are no undefined references or
-    * until a reference cannot be resolved.
-    */
-   gl_shader *main = NULL;
-   for (unsigned i = 0; i < num_shaders; i++) {
-      if (_mesa_get_main_function_signature(shader_list[i]->symbols)) {
-         main = shader_list[i];
-         break;
+      /* Find the shader that defines main, and make a clone of it.
+       *
+       * Starting with the clone, search for undefined references.  If one is
+       * found, find the shader that defines it.  Clone the reference and add
+       * it to the shader.  Repeat until there are no undefined references or
+       * until a reference cannot be resolved.
+       */
+      for (unsigned i = 0; i < num_shaders; i++) {
+         if (_mesa_get_main_function_signature(shader_list[i]->symbols)) {
+            main = shader_list[i];
+            break;
+         }
       }
-   }
 
-   if (main == NULL && allow_missing_main)
-      main = shader_list[0];
+      if (main == NULL && allow_missing_main)
+         main = shader_list[0];
 
-   if (main == NULL) {
-      linker_error(prog, "%s shader lacks `main'\n",
-                   _mesa_shader_stage_to_string(shader_list[0]->Stage));
-      return NULL;
+      if (main == NULL) {
+         linker_error(prog, "%s shader lacks `main'\n",
+                      _mesa_shader_stage_to_string(shader_list[0]->Stage));
+         return NULL;
+      }
    }
 
    gl_linked_shader *linked = ctx->Driver.NewShader(shader_list[0]->Stage);
@@ -2207,7 +2300,8 @@ link_intrastage_shaders(void *mem_ctx,
    linked->Program = gl_prog;
 
    linked->ir = new(linked) exec_list;
-   clone_ir_list(mem_ctx, linked->ir, main->ir);
+   clone_ir_list(mem_ctx, linked->ir,
+                 snapshot != NULL ? snapshot->ir : main->ir);
 
    link_fs_inout_layout_qualifiers(prog, linked, shader_list, num_shaders);
    link_tcs_out_layout_qualifiers(prog, linked, shader_list, num_shaders);
@@ -2219,41 +2313,48 @@ link_intrastage_shaders(void *mem_ctx,
 
    populate_symbol_table(linked);
 
-   /* The pointer to the main function in the final linked shader (i.e., the
-    * copy of the original shader that contained the main function).
-    */
-   ir_function_signature *const main_sig =
-      _mesa_get_main_function_signature(linked->symbols);
+   if (snapshot == NULL) {
+      /* The pointer to the main function in the final linked shader (i.e.,
+       * the copy of the original shader that contained the main function).
+       */
+      ir_function_signature *const main_sig =
+         _mesa_get_main_function_signature(linked->symbols);
 
-   /* Move any instructions other than variable declarations or function
-    * declarations into main.
-    */
-   if (main_sig != NULL) {
-      exec_node *insertion_point =
-         move_non_declarations(linked->ir, (exec_node *) &main_sig->body, false,
-                               linked);
+      /* Move any instructions other than variable declarations or function
+       * declarations into main.
+       */
+      if (main_sig != NULL) {
+         exec_node *insertion_point =
+            move_non_declarations(linked->ir, (exec_node *) &main_sig->body,
+                                  false, linked);
 
-      for (unsigned i = 0; i < num_shaders; i++) {
-         if (shader_list[i] == main)
-            continue;
+         for (unsigned i = 0; i < num_shaders; i++) {
+            if (shader_list[i] == main)
+               continue;
 
-         insertion_point = move_non_declarations(shader_list[i]->ir,
-                                                 insertion_point, true, linked);
+            insertion_point = move_non_declarations(shader_list[i]->ir,
+                                                    insertion_point, true,
+                                                    linked);
+         }
       }
-   }
 
-   if (!link_function_calls(prog, linked, shader_list, num_shaders)) {
-      _mesa_delete_linked_shader(ctx, linked);
-      return NULL;
-   }
+      if (!link_function_calls(prog, linked, shader_list, num_shaders)) {
+         _mesa_delete_linked_shader(ctx, linked);
+         return NULL;
+      }
 
-   /* Make a pass over all variable declarations to ensure that arrays with
-    * unspecified sizes have a size specified.  The size is inferred from the
-    * max_array_access field.
-    */
-   array_sizing_visitor v;
-   v.run(linked->ir);
-   v.fixup_unnamed_interface_types();
+      /* Make a pass over all variable declarations to ensure that arrays
+       * with unspecified sizes have a size specified.  The size is inferred
+       * from the max_array_access field.
+       */
+      array_sizing_visitor v;
+      v.run(linked->ir);
+      v.fixup_unnamed_interface_types();
+
+      if (!allow_missing_main)
+         save_intrastage_snapshot(prog, shader_list, num_shaders,
+                                  linked->ir);
+   }
 
    /* Link up uniform blocks defined within this stage. */
    link_uniform_blocks(mem_ctx, ctx, prog, linked, &ubo_blocks,
@@ -4722,6 +4823,94 @@ link_varyings_and_uniforms(unsigned first, unsigned last,
    return true;
 }
 
+/**
+ * Stage-local lowering and optimization done before inter-stage linking.
+ *
+ * Nothing here looks at other stages or modifies \c prog, so the stages of
+ * a program can be processed concurrently.
+ */
+static void
+optimize_linked_shader(struct gl_context *ctx, struct gl_shader_program *prog,
+                       struct gl_linked_shader *sh)
+{
+   const gl_shader_stage stage = sh->Stage;
+
+   if (ctx->Const.ShaderCompilerOptions[stage].LowerCombinedClipCullDistance)
+      lower_clip_cull_distance(prog, sh);
+
+   if (ctx->Const.LowerTessLevel)
+      lower_tess_level(sh);
+
+   while (do_common_optimization(sh->ir, true, false,
+                                 &ctx->Const.ShaderCompilerOptions[stage],
+                                 ctx->Const.NativeIntegers))
+      ;
+
+   lower_const_arrays_to_uniforms(sh->ir, stage);
+   propagate_invariance(sh->ir);
+}
+
+struct optimize_linked_shader_job {
+   struct gl_context *ctx;
+   struct gl_shader_program *prog;
+   struct gl_linked_shader *sh;
+   struct util_queue_fence fence;
+};
+
+static void
+optimize_linked_shader_execute(void *data, int thread_index)
+{
+   struct optimize_linked_shader_job *job =
+      (struct optimize_linked_shader_job *) data;
+
+   optimize_linked_shader(job->ctx, job->prog, job->sh);
+}
+
+/**
+ * Run optimize_linked_shader() on every stage of \c prog.
+ *
+ * If the compiler threads are running (see glCompileShader), all but the
+ * last stage are handed to them and the calling thread takes the last one.
+ */
+static void
+optimize_linked_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
+{
+   struct optimize_linked_shader_job jobs[MESA_SHADER_STAGES];
+   unsigned num_jobs = 0;
+   int last = -1;
+
+   for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+      if (prog->_LinkedShaders[i] != NULL)
+         last = i;
+   }
+
+   for (int i = 0; i < last; i++) {
+      if (prog->_LinkedShaders[i] == NULL)
+         continue;
+
+      if (!util_queue_is_initialized(&ctx->CompileQueue)) {
+         optimize_linked_shader(ctx, prog, prog->_LinkedShaders[i]);
+         continue;
+      }
+
+      struct optimize_linked_shader_job *job = &jobs[num_jobs++];
+      job->ctx = ctx;
+      job->prog = prog;
+      job->sh = prog->_LinkedShaders[i];
+      util_queue_fence_init(&job->fence);
+      util_queue_add_job(&ctx->CompileQueue, job, &job->fence,
+                         optimize_linked_shader_execute, NULL);
+   }
+
+   if (last >= 0)
+      optimize_linked_shader(ctx, prog, prog->_LinkedShaders[last]);
+
+   for (unsigned i = 0; i < num_jobs; i++) {
+      util_queue_job_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+}
+
 void
 link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
 {
@@ -4748,10 +4937,38 @@ link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
       return;
    }
 
+   cache_key program_key;
+   if (ctx->Cache) {
+      shader_cache_compute_program_key(ctx, prog, program_key);
+      memcpy(prog->sha1, program_key, sizeof(prog->sha1));
+      if (shader_cache_read_program(ctx, prog, program_key))
+         return;
+
+      /* Shaders whose compile was skipped because they were in the cache
+       * have to be compiled now.
+       */
+      for (unsigned i = 0; i < prog->NumShaders; i++) {
+         struct gl_shader *sh = prog->Shaders[i];
+
+         if (sh->CompileStatus == compile_skipped) {
+            _mesa_glsl_compile_shader(ctx, sh, false, false, true);
+            if (!sh->CompileStatus) {
+               linker_error(prog, "linking with uncompiled shader");
+               return;
+            }
+         }
+      }
+   }
+
    unsigned int num_explicit_uniform_locs = 0;
 
    void *mem_ctx = ralloc_context(NULL); // temporary linker context
 
+   if (prog->LinkCache == NULL)
+      prog->LinkCache = rzalloc(prog, struct gl_link_cache);
+   if (prog->LinkCache != NULL)
+      prog->LinkCache->num_links++;
+
    prog->ARB_fragment_coord_conventions_enable = false;
 
    /* Separate the shaders into groups based on their type.
@@ -5004,24 +5221,10 @@ link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
       detect_recursion_linked(prog, prog->_LinkedShaders[i]->ir);
       if (!prog->data->LinkStatus)
          goto done;
-
-      if (ctx->Const.ShaderCompilerOptions[i].LowerCombinedClipCullDistance) {
-         lower_clip_cull_distance(prog, prog->_LinkedShaders[i]);
-      }
-
-      if (ctx->Const.LowerTessLevel) {
-         lower_tess_level(prog->_LinkedShaders[i]);
-      }
-
-      while (do_common_optimization(prog->_LinkedShaders[i]->ir, true, false,
-                                    &ctx->Const.ShaderCompilerOptions[i],
-                                    ctx->Const.NativeIntegers))
-         ;
-
-      lower_const_arrays_to_uniforms(prog->_LinkedShaders[i]->ir, i);
-      propagate_invariance(prog->_LinkedShaders[i]->ir);
    }
 
+   optimize_linked_shaders(ctx, prog);
+
    /* Validation for special cases where we allow sampler array indexing
     * with loop induction variable. This check emits a warning or error
     * depending if backend can handle dynamic indexing.
@@ -5099,5 +5302,8 @@ done:
       prog->_LinkedShaders[i]->symbols = NULL;
    }
 
+   if (prog->data->LinkStatus && shader_cache_serialize_program(prog))
+      shader_cache_write_program(ctx, prog, program_key);
+
    ralloc_free(mem_ctx);
 }
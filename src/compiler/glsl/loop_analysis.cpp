@@ -32,6 +32,9 @@ static bool all_expression_operands_are_loop_constant(ir_rvalue *,
 
 static ir_rvalue *get_basic_induction_increment(ir_assignment *, hash_table *);
 
+static ir_rvalue *get_induction_increment(ir_loop *, loop_variable *,
+                                          hash_table *);
+
 
 /**
  * Record the fact that the given loop variable was referenced inside the loop.
@@ -78,6 +81,7 @@ loop_state::loop_state()
    this->ht = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
                                       _mesa_key_pointer_equal);
    this->mem_ctx = ralloc_context(NULL);
+   this->linalloc = linear_alloc_parent(this->mem_ctx, 0);
    this->loop_found = false;
 }
 
@@ -92,7 +96,7 @@ loop_state::~loop_state()
 loop_variable_state *
 loop_state::insert(ir_loop *ir)
 {
-   loop_variable_state *ls = new(this->mem_ctx) loop_variable_state;
+   loop_variable_state *ls = new(this->mem_ctx) loop_variable_state(this->linalloc);
 
    _mesa_hash_table_insert(this->ht, ir, ls);
    this->loop_found = true;
@@ -120,8 +124,7 @@ loop_variable_state::get(const ir_variable *ir)
 loop_variable *
 loop_variable_state::insert(ir_variable *var)
 {
-   void *mem_ctx = ralloc_parent(this);
-   loop_variable *lv = rzalloc(mem_ctx, loop_variable);
+   loop_variable *lv = new(this->linalloc) loop_variable;
 
    lv->var = var;
 
@@ -135,8 +138,7 @@ loop_variable_state::insert(ir_variable *var)
 loop_terminator *
 loop_variable_state::insert(ir_if *if_stmt)
 {
-   void *mem_ctx = ralloc_parent(this);
-   loop_terminator *t = new(mem_ctx) loop_terminator();
+   loop_terminator *t = new(this->linalloc) loop_terminator();
 
    t->ir = if_stmt;
    this->terminators.push_tail(t);
@@ -355,32 +357,24 @@ loop_analysis::visit_leave(ir_loop *ir)
     * induction variables.
     */
    foreach_in_list_safe(loop_variable, lv, &ls->variables) {
-      /* If there is more than one assignment to a variable, it cannot be a
-       * loop induction variable.  This isn't strictly true, but this is a
-       * very simple induction variable detector, and it can't handle more
-       * complex cases.
-       */
-      if (lv->num_assignments > 1)
-	 continue;
-
       /* All of the variables with zero assignments in the loop are loop
        * invariant, and they should have already been filtered out.
        */
-      assert(lv->num_assignments == 1);
+      assert(lv->num_assignments >= 1);
       assert(lv->first_assignment != NULL);
 
-      /* The assignment to the variable in the loop must be unconditional and
-       * not inside a nested loop.
+      /* The assignments to the variable in the loop must be unconditional
+       * and not inside a nested loop.
        */
       if (lv->conditional_or_nested_assignment)
 	 continue;
 
-      /* Basic loop induction variables have a single assignment in the loop
-       * that has the form 'VAR = VAR + i' or 'VAR = VAR - i' where i is a
+      /* Loop induction variables have one or more assignments in the loop,
+       * each of the form 'VAR = VAR + i' or 'VAR = VAR - i' where i is a
        * loop invariant.
        */
       ir_rvalue *const inc =
-	 get_basic_induction_increment(lv->first_assignment, ls->var_hash);
+	 get_induction_increment(ir, lv, ls->var_hash);
       if (inc != NULL) {
 	 lv->increment = inc;
 
@@ -603,6 +597,48 @@ get_basic_induction_increment(ir_assignment *ir, hash_table *var_hash)
 }
 
 
+/**
+ * Get the amount by which \c lv changes over one iteration of \c loop
+ *
+ * A variable that is assigned more than once per iteration (for example
+ * because the loop was partially unrolled) is still an induction variable if
+ * every assignment is a basic induction step.  Since the assignments are
+ * known to be unconditional and outside of nested loops, they are all at the
+ * top level of the loop body, and the loop terminators are all in front of
+ * them, so the increment seen by the terminators is the sum of the steps.
+ */
+ir_rvalue *
+get_induction_increment(ir_loop *loop, loop_variable *lv,
+                        hash_table *var_hash)
+{
+   if (lv->num_assignments == 1)
+      return get_basic_induction_increment(lv->first_assignment, var_hash);
+
+   void *mem_ctx = ralloc_parent(lv->first_assignment);
+   ir_rvalue *total = NULL;
+   unsigned found = 0;
+
+   foreach_in_list(ir_instruction, node, &loop->body_instructions) {
+      ir_assignment *const assign = node->as_assignment();
+      if (assign == NULL || assign->lhs->variable_referenced() != lv->var)
+         continue;
+
+      ir_rvalue *const inc = get_basic_induction_increment(assign, var_hash);
+      if (inc == NULL)
+         return NULL;
+
+      if (total == NULL)
+         total = inc;
+      else
+         total = new(mem_ctx) ir_expression(ir_binop_add, total->type,
+                                            total, inc);
+      found++;
+   }
+
+   return (found == lv->num_assignments) ? total : NULL;
+}
+
+
 /**
  * Detect whether an if-statement is a loop terminating condition
  *
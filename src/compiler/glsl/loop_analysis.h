@@ -126,7 +126,14 @@ public:
     */
    bool contains_calls;
 
-   loop_variable_state()
+   /**
+    * Linear allocator for the \c loop_variable and \c loop_terminator
+    * objects of this loop
+    */
+   void *linalloc;
+
+   loop_variable_state(void *linalloc)
+      : linalloc(linalloc)
    {
       this->num_loop_jumps = 0;
       this->contains_calls = false;
@@ -207,6 +214,8 @@ public:
    void record_reference(bool in_assignee,
                          bool in_conditional_code_or_nested_loop,
                          ir_assignment *current_assignment);
+
+   DECLARE_LINEAR_ZALLOC_CXX_OPERATORS(loop_variable)
 };
 
 
@@ -227,6 +236,8 @@ public:
     * terminate the loop (if that is a fixed value).  Otherwise -1.
     */
    int iterations;
+
+   DECLARE_LINEAR_ZALLOC_CXX_OPERATORS(loop_terminator)
 };
 
 
@@ -253,6 +264,11 @@ private:
 
    void *mem_ctx;
 
+   /**
+    * Linear allocator (child of \c mem_ctx) shared by all analyzed loops.
+    */
+   void *linalloc;
+
    friend loop_state *analyze_loop_variables(exec_list *instructions);
 };
 
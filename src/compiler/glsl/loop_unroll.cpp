@@ -41,6 +41,8 @@ public:
 
    virtual ir_visitor_status visit_leave(ir_loop *ir);
    void simple_unroll(ir_loop *ir, int iterations);
+   void partial_unroll(ir_loop *ir, loop_variable_state *ls, int iterations,
+                       int factor);
    void complex_unroll(ir_loop *ir, int iterations,
                        bool continue_from_then_branch);
    void splice_post_if_instructions(ir_if *ir_if, exec_list *splice_dest);
@@ -65,12 +67,15 @@ public:
    int nodes;
    bool unsupported_variable_indexing;
    bool array_indexed_by_induction_var_with_exact_iterations;
-   /* If there are nested loops, the node count will be inaccurate. */
+   /* If there are nested loops without a known iteration count, the node
+    * count will be inaccurate.
+    */
    bool nested_loop;
 
    loop_unroll_count(exec_list *list, loop_variable_state *ls,
+                     loop_state *state,
                      const struct gl_shader_compiler_options *options)
-      : ls(ls), options(options)
+      : ls(ls), state(state), options(options)
    {
       nodes = 0;
       nested_loop = false;
@@ -92,12 +97,40 @@ public:
       return visit_continue;
    }
 
-   virtual ir_visitor_status visit_enter(ir_loop *)
+   virtual ir_visitor_status visit_enter(ir_texture *)
    {
-      nested_loop = true;
+      nodes++;
       return visit_continue;
    }
 
+   virtual ir_visitor_status visit_enter(ir_loop *ir)
+   {
+      /* A nested loop with a known iteration count costs its body once per
+       * iteration.  Count the body against the outer loop so that accesses
+       * indexed by the outer induction variable are still noticed.
+       */
+      loop_variable_state *const inner = state->get(ir);
+      if (inner == NULL || inner->limiting_terminator == NULL ||
+          inner->limiting_terminator->iterations >
+          (int) options->MaxUnrollIterations) {
+         nested_loop = true;
+         return visit_continue;
+      }
+
+      loop_unroll_count inner_count(&ir->body_instructions, ls, state,
+                                    options);
+
+      nodes += inner_count.nodes * inner->limiting_terminator->iterations;
+      nested_loop = nested_loop || inner_count.nested_loop;
+      unsupported_variable_indexing = unsupported_variable_indexing ||
+         inner_count.unsupported_variable_indexing;
+      array_indexed_by_induction_var_with_exact_iterations =
+         array_indexed_by_induction_var_with_exact_iterations ||
+         inner_count.array_indexed_by_induction_var_with_exact_iterations;
+
+      return visit_continue_with_parent;
+   }
+
    virtual ir_visitor_status visit_enter(ir_dereference_array *ir)
    {
       /* Force unroll in case of dynamic indexing with sampler arrays
@@ -165,6 +198,7 @@ public:
 
 private:
    loop_variable_state *ls;
+   loop_state *state;
    const struct gl_shader_compiler_options *options;
 };
 
@@ -202,6 +236,52 @@ loop_unroll_visitor::simple_unroll(ir_loop *ir, int iterations)
 }
 
 
+/**
+ * Partially unroll a loop which does not contain any jumps other than its
+ * limiting terminator.  For example, if the input is:
+ *
+ *     (loop (terminator ...instrs...))
+ *
+ * And the iteration count is 7 and \c factor is 3, the output will be:
+ *
+ *     ...instrs...
+ *     (loop (terminator ...instrs... ...instrs... ...instrs...))
+ *
+ * The leftover iterations are peeled off in front of the loop, so the
+ * terminator, which is only evaluated once per trip through the body, is
+ * reached at exactly the multiples of \c factor at which it was before.
+ */
+void
+loop_unroll_visitor::partial_unroll(ir_loop *ir, loop_variable_state *ls,
+                                    int iterations, int factor)
+{
+   void *const mem_ctx = ralloc_parent(ir);
+   ir_if *const terminator = ls->limiting_terminator->ir;
+
+   terminator->remove();
+
+   for (int i = 0; i < iterations % factor; i++) {
+      exec_list copy_list;
+
+      copy_list.make_empty();
+      clone_ir_list(mem_ctx, &copy_list, &ir->body_instructions);
+
+      ir->insert_before(&copy_list);
+   }
+
+   exec_list copy_list;
+
+   copy_list.make_empty();
+   for (int i = 1; i < factor; i++)
+      clone_ir_list(mem_ctx, &copy_list, &ir->body_instructions);
+
+   ir->body_instructions.append_list(&copy_list);
+   ir->body_instructions.push_head(terminator);
+
+   this->progress = true;
+}
+
+
 /**
  * Unroll a loop whose last statement is an ir_if.  If \c
  * continue_from_then_branch is true, the loop is repeated only when the
@@ -346,31 +426,45 @@ loop_unroll_visitor::visit_leave(ir_loop *ir)
    iterations = ls->limiting_terminator->iterations;
 
    const int max_iterations = options->MaxUnrollIterations;
+   const int max_cost = options->MaxUnrollCost ?
+      options->MaxUnrollCost : max_iterations * 5;
 
-   /* Don't try to unroll loops that have zillions of iterations either.
+   /* Note: the limiting terminator contributes 1 to ls->num_loop_jumps.
+    * We'll be removing the limiting terminator before we unroll.
     */
-   if (iterations > max_iterations)
+   assert(ls->num_loop_jumps > 0);
+   unsigned predicted_num_loop_jumps = ls->num_loop_jumps - 1;
+
+   if (predicted_num_loop_jumps > 1)
       return visit_continue;
 
-   /* Don't try to unroll nested loops and loops with a huge body.
+   /* Don't try to unroll loops that have zillions of iterations, loops with
+    * a huge body, or loops containing loops of unknown length, unless
+    * unrolling is the only way to avoid unsupported variable indexing.
     */
-   loop_unroll_count count(&ir->body_instructions, ls, options);
+   loop_unroll_count count(&ir->body_instructions, ls, this->state, options);
 
    bool loop_too_large =
-      count.nested_loop || count.nodes * iterations > max_iterations * 5;
+      count.nested_loop || count.nodes * iterations > max_cost;
 
-   if (loop_too_large && !count.unsupported_variable_indexing &&
-       !count.array_indexed_by_induction_var_with_exact_iterations)
-      return visit_continue;
+   if (iterations > max_iterations ||
+       (loop_too_large && !count.unsupported_variable_indexing &&
+        !count.array_indexed_by_induction_var_with_exact_iterations)) {
+      /* Fall back to replicating the body a few times within the loop, as
+       * long as the replicated body still fits the budget.
+       */
+      if (predicted_num_loop_jumps == 0 && !count.nested_loop) {
+         int factor = MIN2((int) options->MaxPartialUnrollFactor, iterations);
 
-   /* Note: the limiting terminator contributes 1 to ls->num_loop_jumps.
-    * We'll be removing the limiting terminator before we unroll.
-    */
-   assert(ls->num_loop_jumps > 0);
-   unsigned predicted_num_loop_jumps = ls->num_loop_jumps - 1;
+         while (factor > 1 && count.nodes * factor > max_cost)
+            factor--;
+
+         if (factor > 1)
+            partial_unroll(ir, ls, iterations, factor);
+      }
 
-   if (predicted_num_loop_jumps > 1)
       return visit_continue;
+   }
 
    if (predicted_num_loop_jumps == 0) {
       ls->limiting_terminator->ir->remove();
@@ -45,6 +45,8 @@ const struct option compiler_opts[] = {
    { "dump-builder", no_argument, &options.dump_builder, 1 },
    { "link",     no_argument, &options.do_link,  1 },
    { "just-log", no_argument, &options.just_log, 1 },
+   { "bench",    no_argument, &options.bench,    1 },
+   { "threads",  required_argument, NULL, 't' },
    { "version",  required_argument, NULL, 'v' },
    { NULL, 0, NULL, 0 }
 };
@@ -58,9 +60,14 @@ usage_fail(const char *name)
 
    const char *header =
       "usage: %s [options] <file.vert | file.tesc | file.tese | file.geom | file.frag | file.comp>\n"
+      "       %s --bench [--threads=N] [options] <directory>...\n"
+      "\n"
+      "With --bench, every subdirectory of the given directories is compiled\n"
+      "and linked as one program, and the time spent in each phase is\n"
+      "printed as JSON.\n"
       "\n"
       "Possible options are:\n";
-   printf(header, name);
+   printf(header, name, name);
    for (const struct option *o = compiler_opts; o->name != 0; ++o) {
       printf("    --%s\n", o->name);
    }
@@ -79,6 +86,9 @@ main(int argc, char * const* argv)
       case 'v':
          options.glsl_version = strtol(optarg, NULL, 10);
          break;
+      case 't':
+         options.threads = strtol(optarg, NULL, 10);
+         break;
       default:
          break;
       }
@@ -87,6 +97,9 @@ main(int argc, char * const* argv)
    if (argc <= optind)
       usage_fail(argv[0]);
 
+   if (options.bench)
+      return standalone_benchmark(&options, argc - optind, &argv[optind]);
+
    struct gl_shader_program *whole_program;
 
    whole_program = standalone_compile_shader(&options, argc - optind, &argv[optind]);
@@ -38,8 +38,8 @@
  *
  * r1.xyz = log2(v0.xyz);
  *
- * We look for consecutive assignments of the same expression (modulo swizzle)
- * to each channel of the same variable.
+ * We look for assignments of the same expression (modulo swizzle) to each
+ * channel of the same variable within a basic block.
  *
  * For instance, we want to convert these three scalar operations
  *
@@ -50,6 +50,18 @@
  * into a single vector operation
  *
  * (assign (xyz) (var_ref r1) (expression vec3 log2 (swiz xyz (var_ref v0))))
+ *
+ * The channels read from each swizzled operand don't have to match the
+ * channel being written, so
+ *
+ * r1.x = v0.y * v1.x;
+ * r1.y = v0.x * v1.x;
+ *
+ * becomes r1.xy = v0.yx * v1.xx.  The assignments don't have to be
+ * consecutive either: several independent groups of assignments may be
+ * interleaved, as long as nothing in between reads the variable being
+ * written or writes anything the expressions read.  Each group is combined
+ * into its last assignment.
  */
 
 #include "ir.h"
@@ -60,42 +72,103 @@
 
 namespace {
 
-class ir_vectorize_visitor : public ir_hierarchical_visitor {
-public:
-   void clear()
-   {
-      assignment[0] = NULL;
-      assignment[1] = NULL;
-      assignment[2] = NULL;
-      assignment[3] = NULL;
-      current_assignment = NULL;
-      last_assignment = NULL;
-      channels = 0;
-      has_swizzle = false;
-   }
+/** Largest number of swizzles tracked in the right-hand side of a lane. */
+#define MAX_LANE_SWIZZLES 16
+
+/** Largest number of groups of assignments tracked at once. */
+#define MAX_GROUPS 8
 
-   ir_vectorize_visitor()
+/**
+ * Checks whether the right-hand side of an assignment can be computed one
+ * channel at a time, and records the swizzles in it.
+ */
+class lane_visitor : public ir_hierarchical_visitor {
+public:
+   lane_visitor(ir_rvalue *rhs)
    {
-      clear();
-      progress = false;
+      ok = true;
+      num_swizzles = 0;
+      rhs->accept(this);
    }
 
-   virtual ir_visitor_status visit_enter(ir_assignment *);
    virtual ir_visitor_status visit_enter(ir_swizzle *);
    virtual ir_visitor_status visit_enter(ir_dereference_array *);
    virtual ir_visitor_status visit_enter(ir_expression *);
-   virtual ir_visitor_status visit_enter(ir_if *);
-   virtual ir_visitor_status visit_enter(ir_loop *);
    virtual ir_visitor_status visit_enter(ir_texture *);
 
-   virtual ir_visitor_status visit_leave(ir_assignment *);
+   bool ok;
+   unsigned num_swizzles;
+   ir_swizzle *swizzles[MAX_LANE_SWIZZLES];
+};
+
+/**
+ * Counts the dereferences of a variable in a tree.
+ */
+class reference_counter : public ir_hierarchical_visitor {
+public:
+   reference_counter(ir_instruction *ir, const ir_variable *var)
+      : var(var), count(0)
+   {
+      ir->accept(this);
+   }
+
+   virtual ir_visitor_status visit(ir_dereference_variable *ir)
+   {
+      if (ir->var == this->var)
+         this->count++;
+      return visit_continue;
+   }
 
-   void try_vectorize();
+   const ir_variable *var;
+   unsigned count;
+};
 
-   ir_assignment *assignment[4];
-   ir_assignment *current_assignment, *last_assignment;
-   unsigned channels;
-   bool has_swizzle;
+/**
+ * Scalar assignments to different channels of the same variable that will be
+ * combined into one.
+ */
+struct vectorize_group {
+   /** The assignment writing each channel, if any. */
+   ir_assignment *lane[4];
+
+   /**
+    * The components read by each swizzle in each lane, in the order the
+    * swizzles are visited.
+    */
+   unsigned char components[4][MAX_LANE_SWIZZLES];
+
+   /** The assignment that the others will be folded into. */
+   ir_assignment *last;
+
+   /** Swizzles in the right-hand side of \c last. */
+   ir_swizzle *swizzles[MAX_LANE_SWIZZLES];
+   unsigned num_swizzles;
+
+   /** The variable written, and the channels written to it so far. */
+   ir_variable *var;
+   unsigned write_mask;
+};
+
+class ir_vectorize_block {
+public:
+   ir_vectorize_block()
+      : num_groups(0), progress(false)
+   {
+   }
+
+   void visit_list(exec_list *instructions);
+   void visit_assignment(ir_assignment *ir);
+
+   bool try_join(vectorize_group *group, ir_assignment *ir,
+                 const lane_visitor &lanes);
+   bool interferes(const vectorize_group *group, ir_instruction *ir,
+                   ir_variable *written);
+
+   void try_vectorize(unsigned i);
+   void try_vectorize_all();
+
+   vectorize_group groups[MAX_GROUPS];
+   unsigned num_groups;
 
    bool progress;
 };
@@ -103,11 +176,74 @@ public:
 } /* unnamed namespace */
 
 /**
- * Rewrites the swizzles and types of a right-hand side of an assignment.
+ * Upon entering an ir_swizzle, record it.  A lane may only contain
+ * single-channel swizzles, since each of them becomes one channel of a
+ * vector swizzle.
+ */
+ir_visitor_status
+lane_visitor::visit_enter(ir_swizzle *ir)
+{
+   if (!ir->type->is_scalar() || this->num_swizzles == MAX_LANE_SWIZZLES) {
+      this->ok = false;
+      return visit_stop;
+   }
+
+   this->swizzles[this->num_swizzles++] = ir;
+   return visit_continue;
+}
+
+/* Upon entering an ir_array_dereference, reject the lane.  Since the index
+ * of an array dereference must scalar, we are not able to vectorize it.
+ *
+ * FINISHME: If all of scalar indices are identical we could vectorize.
+ */
+ir_visitor_status
+lane_visitor::visit_enter(ir_dereference_array *)
+{
+   this->ok = false;
+   return visit_stop;
+}
+
+/**
+ * Upon entering an ir_expression, reject the lane if the expression operates
+ * horizontally on vectors.
+ */
+ir_visitor_status
+lane_visitor::visit_enter(ir_expression *ir)
+{
+   if (ir->is_horizontal() || !ir->type->is_scalar()) {
+      this->ok = false;
+      return visit_stop;
+   }
+
+   for (unsigned i = 0; i < ir->get_num_operands(); i++) {
+      if (!ir->operands[i]->type->is_scalar()) {
+         this->ok = false;
+         return visit_stop;
+      }
+   }
+
+   return visit_continue;
+}
+
+/**
+ * Upon entering an ir_texture, reject the lane.  Vectorizing multiple texture
+ * lookups into one is wrong.
+ */
+ir_visitor_status
+lane_visitor::visit_enter(ir_texture *)
+{
+   this->ok = false;
+   return visit_stop;
+}
+
+/**
+ * Rewrites the types of a right-hand side of an assignment.
  *
  * From the example above, this function would be called (by visit_tree()) on
- * the nodes of the tree (expression float log2 (swiz z   (var_ref v0))),
- * rewriting it into     (expression vec3  log2 (swiz xyz (var_ref v0))).
+ * the nodes of the tree (expression float log2 (swiz y   (var_ref v0))),
+ * rewriting it into     (expression vec3  log2 (swiz xyz (var_ref v0))),
+ * after the swizzle masks have been set up by try_vectorize().
  *
  * The function operates on ir_expressions (and its operands) and ir_swizzles.
  * For expressions it sets a new type and swizzles any non-expression and non-
@@ -123,38 +259,31 @@ public:
  * (assign (xy) (var_ref r1) (expression vec2 + (swiz xy (var_ref v0))
  *                                              (swiz xx (var_ref v1))))
  *
- * For swizzles, it sets a new type, and if the variable being swizzled is a
- * vector it overwrites the swizzle mask with the ir_swizzle_mask passed as the
- * data parameter. If the swizzled variable is scalar, then the swizzle was
- * added by an earlier call to rewrite_swizzle() on an expression, so the
- * mask should not be modified.
+ * For swizzles, it sets a new type matching the mask.
  */
 static void
 rewrite_swizzle(ir_instruction *ir, void *data)
 {
-   ir_swizzle_mask *mask = (ir_swizzle_mask *)data;
+   unsigned num_components = *(unsigned *)data;
 
    switch (ir->ir_type) {
    case ir_type_swizzle: {
       ir_swizzle *swz = (ir_swizzle *)ir;
-      if (swz->val->type->is_vector()) {
-         swz->mask = *mask;
-      }
       swz->type = glsl_type::get_instance(swz->type->base_type,
-                                          mask->num_components, 1);
+                                          num_components, 1);
       break;
    }
    case ir_type_expression: {
       ir_expression *expr = (ir_expression *)ir;
       expr->type = glsl_type::get_instance(expr->type->base_type,
-                                           mask->num_components, 1);
+                                           num_components, 1);
       for (unsigned i = 0; i < 4; i++) {
          if (expr->operands[i]) {
             ir_rvalue *rval = expr->operands[i]->as_rvalue();
             if (rval && rval->type->is_scalar() &&
                 !rval->as_expression() && !rval->as_swizzle()) {
                expr->operands[i] = new(ir) ir_swizzle(rval, 0, 0, 0, 0,
-                                                      mask->num_components);
+                                                      num_components);
             }
          }
       }
@@ -166,45 +295,63 @@ rewrite_swizzle(ir_instruction *ir, void *data)
 }
 
 /**
- * Attempt to vectorize the previously saved assignments, and clear them from
- * consideration.
+ * Attempt to vectorize the assignments of a group, and stop tracking it.
  *
  * If the assignments are able to be combined, it modifies in-place the last
  * assignment seen to be an equivalent vector form of the scalar assignments.
  * It then removes the other now obsolete scalar assignments.
  */
 void
-ir_vectorize_visitor::try_vectorize()
+ir_vectorize_block::try_vectorize(unsigned i)
 {
-   if (this->last_assignment && this->channels > 1) {
-      ir_swizzle_mask mask = {0, 0, 0, 0, channels, 0};
-
-      this->last_assignment->write_mask = 0;
+   vectorize_group *const group = &this->groups[i];
+   unsigned channels = 0;
 
-      for (unsigned i = 0, j = 0; i < 4; i++) {
-         if (this->assignment[i]) {
-            this->last_assignment->write_mask |= 1 << i;
+   for (unsigned c = 0; c < 4; c++) {
+      if (group->lane[c])
+         channels++;
+   }
 
-            if (this->assignment[i] != this->last_assignment) {
-               this->assignment[i]->remove();
+   if (channels > 1) {
+      for (unsigned s = 0; s < group->num_swizzles; s++) {
+         unsigned comp[4] = { 0, 0, 0, 0 };
+         unsigned seen = 0;
+         bool duplicates = false;
+
+         for (unsigned c = 0, j = 0; c < 4; c++) {
+            if (group->lane[c]) {
+               comp[j] = group->components[c][s];
+               duplicates = duplicates || (seen & (1 << comp[j]));
+               seen |= 1 << comp[j];
+               j++;
             }
+         }
 
-            switch (j) {
-            case 0: mask.x = i; break;
-            case 1: mask.y = i; break;
-            case 2: mask.z = i; break;
-            case 3: mask.w = i; break;
-            }
+         ir_swizzle_mask mask = {
+            comp[0], comp[1], comp[2], comp[3], channels, duplicates
+         };
+         group->swizzles[s]->mask = mask;
+      }
 
-            j++;
-         }
+      for (unsigned c = 0; c < 4; c++) {
+         if (group->lane[c] && group->lane[c] != group->last)
+            group->lane[c]->remove();
       }
 
-      visit_tree(this->last_assignment->rhs, rewrite_swizzle, &mask);
+      group->last->write_mask = group->write_mask;
+      visit_tree(group->last->rhs, rewrite_swizzle, &channels);
 
       this->progress = true;
    }
-   clear();
+
+   this->groups[i] = this->groups[--this->num_groups];
+}
+
+void
+ir_vectorize_block::try_vectorize_all()
+{
+   while (this->num_groups > 0)
+      try_vectorize(this->num_groups - 1);
 }
 
 /**
@@ -232,160 +379,169 @@ write_mask_to_swizzle(unsigned write_mask)
 }
 
 /**
- * Returns whether a single-channeled write mask matches a swizzle.
+ * Returns whether \c ir can't be moved across the assignments of \c group,
+ * or the other way around.
+ *
+ * That is the case if \c ir touches the variable written by the group, or if
+ * it writes \c written and the group reads it.  A NULL \c written means that
+ * \c ir may write anything.
  */
-static bool
-write_mask_matches_swizzle(unsigned write_mask,
-                           const ir_swizzle *swz)
+bool
+ir_vectorize_block::interferes(const vectorize_group *group,
+                               ir_instruction *ir, ir_variable *written)
 {
-   return ((write_mask == WRITEMASK_X && swz->mask.x == SWIZZLE_X) ||
-           (write_mask == WRITEMASK_Y && swz->mask.x == SWIZZLE_Y) ||
-           (write_mask == WRITEMASK_Z && swz->mask.x == SWIZZLE_Z) ||
-           (write_mask == WRITEMASK_W && swz->mask.x == SWIZZLE_W));
-}
+   if (written == NULL)
+      return true;
 
-/**
- * Upon entering an ir_assignment, attempt to vectorize the currently tracked
- * assignments if the current assignment is not suitable. Keep a pointer to
- * the current assignment.
- */
-ir_visitor_status
-ir_vectorize_visitor::visit_enter(ir_assignment *ir)
-{
-   ir_dereference *lhs = this->last_assignment != NULL ?
-                         this->last_assignment->lhs : NULL;
-   ir_rvalue *rhs = this->last_assignment != NULL ?
-                    this->last_assignment->rhs : NULL;
-
-   if (ir->condition ||
-       this->channels >= 4 ||
-       !single_channel_write_mask(ir->write_mask) ||
-       this->assignment[write_mask_to_swizzle(ir->write_mask)] != NULL ||
-       (lhs && !ir->lhs->equals(lhs)) ||
-       (rhs && !ir->rhs->equals(rhs, ir_type_swizzle))) {
-      try_vectorize();
-   }
+   if (reference_counter(ir, group->var).count != 0)
+      return true;
 
-   this->current_assignment = ir;
+   for (unsigned c = 0; c < 4; c++) {
+      if (group->lane[c] &&
+          reference_counter(group->lane[c]->rhs, written).count != 0)
+         return true;
+   }
 
-   return visit_continue;
+   return false;
 }
 
 /**
- * Upon entering an ir_swizzle, set ::has_swizzle if we're visiting from an
- * ir_assignment (i.e., that ::current_assignment is set) and the swizzle mask
- * matches the current assignment's write mask.
+ * Add \c ir to \c group if it writes a new channel of the same variable with
+ * the same expression (modulo swizzle).
  *
- * If the write mask doesn't match the swizzle mask, remove the current
- * assignment from further consideration.
+ * All the lanes are evaluated before any of the channels are written, so a
+ * lane must not read a channel written by an earlier lane, and may only read
+ * the variable through single-channel swizzles.
  */
-ir_visitor_status
-ir_vectorize_visitor::visit_enter(ir_swizzle *ir)
+bool
+ir_vectorize_block::try_join(vectorize_group *group, ir_assignment *ir,
+                             const lane_visitor &lanes)
 {
-   if (this->current_assignment) {
-      if (write_mask_matches_swizzle(this->current_assignment->write_mask, ir)) {
-         this->has_swizzle = true;
-      } else {
-         this->current_assignment = NULL;
-      }
-   }
-   return visit_continue;
-}
+   const unsigned channel = write_mask_to_swizzle(ir->write_mask);
 
-/* Upon entering an ir_array_dereference, remove the current assignment from
- * further consideration. Since the index of an array dereference must scalar,
- * we are not able to vectorize it.
- *
- * FINISHME: If all of scalar indices are identical we could vectorize.
- */
-ir_visitor_status
-ir_vectorize_visitor::visit_enter(ir_dereference_array *)
-{
-   this->current_assignment = NULL;
-   return visit_continue_with_parent;
-}
+   if (group->lane[channel] != NULL ||
+       !ir->lhs->equals(group->last->lhs) ||
+       !ir->rhs->equals(group->last->rhs, ir_type_swizzle))
+      return false;
 
-/**
- * Upon entering an ir_expression, remove the current assignment from further
- * consideration if the expression operates horizontally on vectors.
- */
-ir_visitor_status
-ir_vectorize_visitor::visit_enter(ir_expression *ir)
-{
-   if (ir->is_horizontal()) {
-      this->current_assignment = NULL;
-      return visit_continue_with_parent;
-   }
-   return visit_continue;
-}
+   assert(lanes.num_swizzles == group->num_swizzles);
 
-/* Since there is no statement to visit between the "then" and "else"
- * instructions try to vectorize before, in between, and after them to avoid
- * combining statements from different basic blocks.
- */
-ir_visitor_status
-ir_vectorize_visitor::visit_enter(ir_if *ir)
-{
-   try_vectorize();
+   unsigned self_reads = 0;
+   for (unsigned s = 0; s < lanes.num_swizzles; s++) {
+      if (lanes.swizzles[s]->val->equals(ir->lhs)) {
+         if (group->write_mask & (1 << lanes.swizzles[s]->mask.x))
+            return false;
+         self_reads++;
+      }
+   }
 
-   visit_list_elements(this, &ir->then_instructions);
-   try_vectorize();
+   if (reference_counter(ir->rhs, group->var).count != self_reads)
+      return false;
 
-   visit_list_elements(this, &ir->else_instructions);
-   try_vectorize();
+   group->lane[channel] = ir;
+   group->last = ir;
+   group->write_mask |= ir->write_mask;
+   for (unsigned s = 0; s < lanes.num_swizzles; s++) {
+      group->components[channel][s] = lanes.swizzles[s]->mask.x;
+      group->swizzles[s] = lanes.swizzles[s];
+   }
 
-   return visit_continue_with_parent;
+   return true;
 }
 
-/* Since there is no statement to visit between the instructions in the body of
- * the loop and the instructions after it try to vectorize before and after the
- * body to avoid combining statements from different basic blocks.
+/**
+ * Add an assignment to the group it belongs to, starting a new group if
+ * there is none, and vectorize all the groups that it can't be moved across.
  */
-ir_visitor_status
-ir_vectorize_visitor::visit_enter(ir_loop *ir)
+void
+ir_vectorize_block::visit_assignment(ir_assignment *ir)
 {
-   try_vectorize();
+   ir_variable *const written = ir->lhs->variable_referenced();
+   bool candidate = written != NULL && ir->condition == NULL &&
+                    single_channel_write_mask(ir->write_mask) &&
+                    lane_visitor(ir->lhs).ok;
+   bool joined = false;
+
+   lane_visitor lanes(ir->rhs);
+   candidate = candidate && lanes.ok && lanes.num_swizzles > 0;
+
+   for (unsigned i = 0; i < this->num_groups; /* empty */) {
+      if (candidate && !joined &&
+          try_join(&this->groups[i], ir, lanes)) {
+         joined = true;
+         i++;
+      } else if (interferes(&this->groups[i], ir, written)) {
+         try_vectorize(i);
+      } else {
+         i++;
+      }
+   }
 
-   visit_list_elements(this, &ir->body_instructions);
-   try_vectorize();
+   if (!candidate || joined)
+      return;
 
-   return visit_continue_with_parent;
-}
+   if (this->num_groups == MAX_GROUPS)
+      try_vectorize(0);
 
-/**
- * Upon entering an ir_texture, remove the current assignment from
- * further consideration. Vectorizing multiple texture lookups into one
- * is wrong.
- */
-ir_visitor_status
-ir_vectorize_visitor::visit_enter(ir_texture *)
-{
-   this->current_assignment = NULL;
-   return visit_continue_with_parent;
+   vectorize_group *const group = &this->groups[this->num_groups++];
+   const unsigned channel = write_mask_to_swizzle(ir->write_mask);
+
+   memset(group->lane, 0, sizeof(group->lane));
+   group->lane[channel] = ir;
+   group->last = ir;
+   group->var = written;
+   group->write_mask = ir->write_mask;
+   group->num_swizzles = lanes.num_swizzles;
+   for (unsigned s = 0; s < lanes.num_swizzles; s++) {
+      group->components[channel][s] = lanes.swizzles[s]->mask.x;
+      group->swizzles[s] = lanes.swizzles[s];
+   }
 }
 
 /**
- * Upon leaving an ir_assignment, save a pointer to it in ::assignment[] if
- * the swizzle mask(s) found were appropriate. Also save a pointer in
- * ::last_assignment so that we can compare future assignments with it.
+ * Vectorize the assignments in each basic block of \c instructions.
  *
- * Finally, clear ::current_assignment and ::has_swizzle.
+ * Anything other than a plain assignment (calls, control flow, discards,
+ * vertex emission, barriers, ...) ends the current basic block.  The bodies
+ * of if-statements and loops are separate basic blocks.
  */
-ir_visitor_status
-ir_vectorize_visitor::visit_leave(ir_assignment *ir)
+void
+ir_vectorize_block::visit_list(exec_list *instructions)
 {
-   if (this->has_swizzle && this->current_assignment) {
-      assert(this->current_assignment == ir);
-
-      unsigned channel = write_mask_to_swizzle(this->current_assignment->write_mask);
-      this->assignment[channel] = ir;
-      this->channels++;
-
-      this->last_assignment = this->current_assignment;
+   foreach_in_list_safe(ir_instruction, ir, instructions) {
+      switch (ir->ir_type) {
+      case ir_type_assignment:
+         visit_assignment((ir_assignment *) ir);
+         break;
+
+      case ir_type_variable:
+         break;
+
+      case ir_type_function:
+         try_vectorize_all();
+         foreach_in_list(ir_function_signature, sig,
+                         &((ir_function *) ir)->signatures)
+            visit_list(&sig->body);
+         break;
+
+      case ir_type_if:
+         try_vectorize_all();
+         visit_list(&((ir_if *) ir)->then_instructions);
+         visit_list(&((ir_if *) ir)->else_instructions);
+         break;
+
+      case ir_type_loop:
+         try_vectorize_all();
+         visit_list(&((ir_loop *) ir)->body_instructions);
+         break;
+
+      default:
+         try_vectorize_all();
+         break;
+      }
    }
-   this->current_assignment = NULL;
-   this->has_swizzle = false;
-   return visit_continue;
+
+   try_vectorize_all();
 }
 
 /**
@@ -396,12 +552,9 @@ ir_vectorize_visitor::visit_leave(ir_assignment *ir)
 bool
 do_vectorize(exec_list *instructions)
 {
-   ir_vectorize_visitor v;
-
-   v.run(instructions);
+   ir_vectorize_block v;
 
-   /* Try to vectorize the last assignments seen. */
-   v.try_vectorize();
+   v.visit_list(instructions);
 
    return v.progress;
 }
@@ -22,6 +22,7 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,9 +32,37 @@ struct gl_context;
 struct gl_shader;
 struct gl_shader_program;
 
+/**
+ * Time spent in each phase of compiling shaders, in nanoseconds.  Only
+ * collected on request, e.g. by the standalone compiler's --bench mode.
+ */
+struct glsl_compile_times {
+   uint64_t preprocess;
+   uint64_t parse;
+   uint64_t ast_to_hir;
+
+   /** Everything after ast_to_hir, including do_common_optimization(). */
+   uint64_t optimize;
+
+   /** Time of each do_common_optimization() pass, merged by name. */
+   unsigned num_passes;
+   struct {
+      const char *name;
+      unsigned runs;
+      uint64_t ns;
+   } passes[64];
+};
+
 extern void
 _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
-			  bool dump_ast, bool dump_hir);
+			  bool dump_ast, bool dump_hir, bool force_recompile);
+
+extern void
+_mesa_glsl_compile_shader_timed(struct gl_context *ctx,
+                                struct gl_shader *shader,
+                                bool dump_ast, bool dump_hir,
+                                bool force_recompile,
+                                struct glsl_compile_times *times);
 
 #ifdef __cplusplus
 } /* extern "C" */
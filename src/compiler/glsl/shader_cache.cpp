@@ -0,0 +1,943 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file shader_cache.cpp
+ *
+ * The cached representation of a program is everything link_shaders()
+ * leaves behind that the driver's LinkShader hook and the GL API consume:
+ * the uniform storage (with initial values) and remap tables, the buffer
+ * blocks, atomic buffers and transform feedback layout, and for each stage
+ * the linked IR and the per-stage sampler, image and subroutine tables.
+ * The program resource list isn't stored since the driver rebuilds it.
+ *
+ * Drivers don't cache their own binaries in this tree, so a hit still runs
+ * ctx->Driver.LinkShader; it only skips the GLSL front end and the linker.
+ *
+ * The same representation is kept on gl_shader_program_data after every
+ * successful link, since the driver lowers the linked IR in place, and is
+ * what glGetProgramBinary returns.
+ */
+
+#include "main/core.h"
+#include "main/shaderobj.h"
+#include "program/program.h"
+#include "util/mesa-sha1.h"
+#include "util/string_to_uint_map.h"
+#include "blob.h"
+#include "ir.h"
+#include "ir_serialize.h"
+#include "ir_uniform.h"
+#include "shader_cache.h"
+#include "git_sha1.h"
+
+static const char build_id[] =
+#ifdef PACKAGE_VERSION
+   PACKAGE_VERSION
+#endif
+#ifdef MESA_GIT_SHA1
+   MESA_GIT_SHA1
+#endif
+   "";
+
+/**
+ * Hash the parts of the context that affect how GLSL is compiled.
+ */
+static void
+hash_context_state(struct mesa_sha1 *sha1, struct gl_context *ctx)
+{
+   _mesa_sha1_update(sha1, build_id, sizeof(build_id));
+   _mesa_sha1_update(sha1, &ctx->API, sizeof(ctx->API));
+   _mesa_sha1_update(sha1, &ctx->Version, sizeof(ctx->Version));
+   _mesa_sha1_update(sha1, &ctx->Extensions, sizeof(ctx->Extensions));
+   _mesa_sha1_update(sha1, &ctx->_Shader->Flags, sizeof(ctx->_Shader->Flags));
+
+   if (ctx->Driver.GetString) {
+      const char *renderer =
+         (const char *) ctx->Driver.GetString(ctx, GL_RENDERER);
+      if (renderer)
+         _mesa_sha1_update(sha1, renderer, strlen(renderer) + 1);
+   }
+
+   /* The NIR options are a pointer to driver data that can't be hashed as
+    * is, but the driver identity is already part of the key.
+    */
+   struct gl_constants *consts =
+      (struct gl_constants *) malloc(sizeof(*consts));
+   if (consts) {
+      memcpy(consts, &ctx->Const, sizeof(*consts));
+      for (unsigned i = 0; i < MESA_SHADER_STAGES; i++)
+         consts->ShaderCompilerOptions[i].NirOptions = NULL;
+      _mesa_sha1_update(sha1, consts, sizeof(*consts));
+      free(consts);
+   }
+}
+
+void
+shader_cache_compute_driver_sha1(struct gl_context *ctx,
+                                 unsigned char *sha1_out)
+{
+   struct mesa_sha1 *sha1 = _mesa_sha1_init();
+
+   if (!sha1) {
+      memset(sha1_out, 0, 20);
+      return;
+   }
+
+   hash_context_state(sha1, ctx);
+   _mesa_sha1_final(sha1, sha1_out);
+}
+
+void
+shader_cache_compute_shader_key(struct gl_context *ctx,
+                                struct gl_shader *shader)
+{
+   struct mesa_sha1 *sha1 = _mesa_sha1_init();
+
+   if (!sha1) {
+      memset(shader->sha1, 0, sizeof(shader->sha1));
+      return;
+   }
+
+   hash_context_state(sha1, ctx);
+   _mesa_sha1_update(sha1, &shader->Stage, sizeof(shader->Stage));
+   _mesa_sha1_update(sha1, shader->Source, strlen(shader->Source));
+   _mesa_sha1_final(sha1, shader->sha1);
+}
+
+static void
+hash_binding(const char *key, unsigned value, void *closure)
+{
+   struct mesa_sha1 *sha1 = (struct mesa_sha1 *) closure;
+
+   _mesa_sha1_update(sha1, key, strlen(key) + 1);
+   _mesa_sha1_update(sha1, &value, sizeof(value));
+}
+
+static void
+hash_bindings(struct mesa_sha1 *sha1, struct string_to_uint_map *map)
+{
+   static const unsigned separator = ~0u;
+
+   if (map)
+      map->iterate(hash_binding, sha1);
+   _mesa_sha1_update(sha1, &separator, sizeof(separator));
+}
+
+void
+shader_cache_compute_program_key(struct gl_context *ctx,
+                                 struct gl_shader_program *prog,
+                                 cache_key key)
+{
+   struct mesa_sha1 *sha1 = _mesa_sha1_init();
+
+   if (!sha1) {
+      memset(key, 0, CACHE_KEY_SIZE);
+      return;
+   }
+
+   hash_context_state(sha1, ctx);
+
+   for (unsigned i = 0; i < prog->NumShaders; i++)
+      _mesa_sha1_update(sha1, prog->Shaders[i]->sha1,
+                        sizeof(prog->Shaders[i]->sha1));
+
+   _mesa_sha1_update(sha1, &prog->SeparateShader,
+                     sizeof(prog->SeparateShader));
+   hash_bindings(sha1, prog->AttributeBindings);
+   hash_bindings(sha1, prog->FragDataBindings);
+   hash_bindings(sha1, prog->FragDataIndexBindings);
+
+   _mesa_sha1_update(sha1, &prog->TransformFeedback.BufferMode,
+                     sizeof(prog->TransformFeedback.BufferMode));
+   _mesa_sha1_update(sha1, &prog->TransformFeedback.NumVarying,
+                     sizeof(prog->TransformFeedback.NumVarying));
+   for (unsigned i = 0; i < prog->TransformFeedback.NumVarying; i++) {
+      const char *name = prog->TransformFeedback.VaryingNames[i];
+      _mesa_sha1_update(sha1, name, strlen(name) + 1);
+   }
+
+   _mesa_sha1_final(sha1, key);
+}
+
+/* Special entries of the uniform remap tables. */
+#define REMAP_NULL     0xffffffffu
+#define REMAP_INACTIVE 0xfffffffeu
+
+static uint32_t
+uniform_index(struct gl_shader_program *prog, struct gl_uniform_storage *u)
+{
+   if (u == NULL)
+      return REMAP_NULL;
+   if (u == INACTIVE_UNIFORM_EXPLICIT_LOCATION)
+      return REMAP_INACTIVE;
+   return u - prog->data->UniformStorage;
+}
+
+static struct gl_uniform_storage *
+uniform_from_index(struct gl_shader_program *prog, uint32_t index)
+{
+   if (index == REMAP_INACTIVE)
+      return INACTIVE_UNIFORM_EXPLICIT_LOCATION;
+   if (index >= prog->data->NumUniformStorage)
+      return NULL;
+   return &prog->data->UniformStorage[index];
+}
+
+static void
+write_uniforms(struct blob *metadata, struct gl_shader_program *prog)
+{
+   struct gl_shader_program_data *data = prog->data;
+
+   blob_write_uint32(metadata, data->NumUniformStorage);
+   blob_write_uint32(metadata, data->NumHiddenUniforms);
+   blob_write_uint32(metadata, data->NumUniformDataSlots);
+
+   for (unsigned i = 0; i < data->NumUniformStorage; i++) {
+      struct gl_uniform_storage *u = &data->UniformStorage[i];
+
+      blob_write_string(metadata, u->name);
+      encode_type_to_blob(metadata, u->type);
+      blob_write_uint32(metadata, u->array_elements);
+      blob_write_bytes(metadata, u->opaque, sizeof(u->opaque));
+      blob_write_uint32(metadata, u->storage ?
+                        u->storage - data->UniformDataSlots : REMAP_NULL);
+      blob_write_uint32(metadata, u->block_index);
+      blob_write_uint32(metadata, u->offset);
+      blob_write_uint32(metadata, u->matrix_stride);
+      blob_write_uint32(metadata, u->array_stride);
+      blob_write_uint32(metadata, u->row_major);
+      blob_write_uint32(metadata, u->hidden);
+      blob_write_uint32(metadata, u->builtin);
+      blob_write_uint32(metadata, u->is_shader_storage);
+      blob_write_uint32(metadata, u->atomic_buffer_index);
+      blob_write_uint32(metadata, u->remap_location);
+      blob_write_uint32(metadata, u->num_compatible_subroutines);
+      blob_write_uint32(metadata, u->top_level_array_size);
+      blob_write_uint32(metadata, u->top_level_array_stride);
+   }
+
+   /* Uniform initializers have already been applied to the storage. */
+   blob_write_bytes(metadata, data->UniformDataSlots,
+                    data->NumUniformDataSlots * sizeof(gl_constant_value));
+
+   blob_write_uint32(metadata, prog->NumUniformRemapTable);
+   for (unsigned i = 0; i < prog->NumUniformRemapTable; i++)
+      blob_write_uint32(metadata,
+                        uniform_index(prog, prog->UniformRemapTable[i]));
+}
+
+static bool
+read_uniforms(struct blob_reader *metadata, struct gl_shader_program *prog)
+{
+   struct gl_shader_program_data *data = prog->data;
+
+   data->NumUniformStorage = blob_read_uint32(metadata);
+   data->NumHiddenUniforms = blob_read_uint32(metadata);
+   data->NumUniformDataSlots = blob_read_uint32(metadata);
+   if (metadata->overrun)
+      return false;
+
+   data->UniformStorage = rzalloc_array(prog, struct gl_uniform_storage,
+                                        data->NumUniformStorage);
+   data->UniformDataSlots = rzalloc_array(data->UniformStorage,
+                                          union gl_constant_value,
+                                          data->NumUniformDataSlots);
+
+   for (unsigned i = 0; i < data->NumUniformStorage; i++) {
+      struct gl_uniform_storage *u = &data->UniformStorage[i];
+      const char *name = blob_read_string(metadata);
+
+      if (name == NULL)
+         return false;
+
+      u->name = ralloc_strdup(data->UniformStorage, name);
+      u->type = decode_type_from_blob(metadata);
+      u->array_elements = blob_read_uint32(metadata);
+      blob_copy_bytes(metadata, (uint8_t *) u->opaque, sizeof(u->opaque));
+      const uint32_t storage = blob_read_uint32(metadata);
+      u->block_index = blob_read_uint32(metadata);
+      u->offset = blob_read_uint32(metadata);
+      u->matrix_stride = blob_read_uint32(metadata);
+      u->array_stride = blob_read_uint32(metadata);
+      u->row_major = blob_read_uint32(metadata);
+      u->hidden = blob_read_uint32(metadata);
+      u->builtin = blob_read_uint32(metadata);
+      u->is_shader_storage = blob_read_uint32(metadata);
+      u->atomic_buffer_index = blob_read_uint32(metadata);
+      u->remap_location = blob_read_uint32(metadata);
+      u->num_compatible_subroutines = blob_read_uint32(metadata);
+      u->top_level_array_size = blob_read_uint32(metadata);
+      u->top_level_array_stride = blob_read_uint32(metadata);
+
+      if (storage != REMAP_NULL) {
+         if (storage >= data->NumUniformDataSlots)
+            return false;
+         u->storage = &data->UniformDataSlots[storage];
+      }
+   }
+
+   blob_copy_bytes(metadata, (uint8_t *) data->UniformDataSlots,
+                   data->NumUniformDataSlots * sizeof(gl_constant_value));
+
+   prog->NumUniformRemapTable = blob_read_uint32(metadata);
+   if (metadata->overrun)
+      return false;
+
+   prog->UniformRemapTable = rzalloc_array(prog, struct gl_uniform_storage *,
+                                           prog->NumUniformRemapTable);
+   for (unsigned i = 0; i < prog->NumUniformRemapTable; i++)
+      prog->UniformRemapTable[i] =
+         uniform_from_index(prog, blob_read_uint32(metadata));
+
+   return !metadata->overrun;
+}
+
+static void
+write_hash_entry(const char *key, unsigned value, void *closure)
+{
+   struct blob *metadata = (struct blob *) closure;
+
+   blob_write_uint32(metadata, value);
+   blob_write_string(metadata, key);
+}
+
+static void
+write_uniform_hash(struct blob *metadata, struct gl_shader_program *prog)
+{
+   if (prog->UniformHash)
+      prog->UniformHash->iterate(write_hash_entry, metadata);
+   blob_write_uint32(metadata, REMAP_NULL);
+}
+
+static bool
+read_uniform_hash(struct blob_reader *metadata,
+                  struct gl_shader_program *prog)
+{
+   prog->UniformHash = new string_to_uint_map;
+
+   for (;;) {
+      const uint32_t value = blob_read_uint32(metadata);
+      if (value == REMAP_NULL || metadata->overrun)
+         break;
+
+      const char *key = blob_read_string(metadata);
+      if (key == NULL)
+         return false;
+      prog->UniformHash->put(value, key);
+   }
+
+   return !metadata->overrun;
+}
+
+static void
+write_buffer_blocks(struct blob *metadata, struct gl_uniform_block *blocks,
+                    unsigned num_blocks)
+{
+   blob_write_uint32(metadata, num_blocks);
+
+   for (unsigned i = 0; i < num_blocks; i++) {
+      struct gl_uniform_block *b = &blocks[i];
+
+      blob_write_string(metadata, b->Name);
+      blob_write_uint32(metadata, b->NumUniforms);
+      blob_write_uint32(metadata, b->Binding);
+      blob_write_uint32(metadata, b->UniformBufferSize);
+      blob_write_uint32(metadata, b->stageref);
+      blob_write_uint32(metadata, b->_Packing);
+      blob_write_uint32(metadata, b->_RowMajor);
+
+      for (unsigned j = 0; j < b->NumUniforms; j++) {
+         struct gl_uniform_buffer_variable *v = &b->Uniforms[j];
+
+         blob_write_string(metadata, v->Name);
+         blob_write_uint32(metadata, v->IndexName == v->Name);
+         if (v->IndexName != v->Name)
+            blob_write_string(metadata, v->IndexName);
+         encode_type_to_blob(metadata, v->Type);
+         blob_write_uint32(metadata, v->Offset);
+         blob_write_uint32(metadata, v->RowMajor);
+      }
+   }
+}
+
+static bool
+read_buffer_blocks(struct blob_reader *metadata,
+                   struct gl_shader_program *prog,
+                   struct gl_uniform_block **blocks, unsigned *num_blocks)
+{
+   *num_blocks = blob_read_uint32(metadata);
+   if (metadata->overrun)
+      return false;
+
+   *blocks = rzalloc_array(prog, struct gl_uniform_block, *num_blocks);
+
+   for (unsigned i = 0; i < *num_blocks; i++) {
+      struct gl_uniform_block *b = &(*blocks)[i];
+      const char *name = blob_read_string(metadata);
+
+      if (name == NULL)
+         return false;
+
+      b->Name = ralloc_strdup(*blocks, name);
+      b->NumUniforms = blob_read_uint32(metadata);
+      b->Binding = blob_read_uint32(metadata);
+      b->UniformBufferSize = blob_read_uint32(metadata);
+      b->stageref = blob_read_uint32(metadata);
+      b->_Packing = (enum gl_uniform_block_packing) blob_read_uint32(metadata);
+      b->_RowMajor = blob_read_uint32(metadata);
+      if (metadata->overrun)
+         return false;
+
+      b->Uniforms = rzalloc_array(*blocks, struct gl_uniform_buffer_variable,
+                                  b->NumUniforms);
+      for (unsigned j = 0; j < b->NumUniforms; j++) {
+         struct gl_uniform_buffer_variable *v = &b->Uniforms[j];
+         const char *var_name = blob_read_string(metadata);
+
+         if (var_name == NULL)
+            return false;
+
+         v->Name = ralloc_strdup(*blocks, var_name);
+         if (blob_read_uint32(metadata)) {
+            v->IndexName = v->Name;
+         } else {
+            const char *index_name = blob_read_string(metadata);
+            if (index_name == NULL)
+               return false;
+            v->IndexName = ralloc_strdup(*blocks, index_name);
+         }
+         v->Type = decode_type_from_blob(metadata);
+         v->Offset = blob_read_uint32(metadata);
+         v->RowMajor = blob_read_uint32(metadata);
+      }
+   }
+
+   return !metadata->overrun;
+}
+
+static void
+write_atomic_buffers(struct blob *metadata, struct gl_shader_program *prog)
+{
+   blob_write_uint32(metadata, prog->data->NumAtomicBuffers);
+
+   for (unsigned i = 0; i < prog->data->NumAtomicBuffers; i++) {
+      struct gl_active_atomic_buffer *ab = &prog->data->AtomicBuffers[i];
+
+      blob_write_uint32(metadata, ab->Binding);
+      blob_write_uint32(metadata, ab->MinimumSize);
+      blob_write_bytes(metadata, ab->StageReferences,
+                       sizeof(ab->StageReferences));
+      blob_write_uint32(metadata, ab->NumUniforms);
+      blob_write_bytes(metadata, ab->Uniforms,
+                       ab->NumUniforms * sizeof(ab->Uniforms[0]));
+   }
+}
+
+static bool
+read_atomic_buffers(struct blob_reader *metadata,
+                    struct gl_shader_program *prog)
+{
+   struct gl_shader_program_data *data = prog->data;
+
+   data->NumAtomicBuffers = blob_read_uint32(metadata);
+   if (metadata->overrun)
+      return false;
+
+   data->AtomicBuffers = rzalloc_array(prog, gl_active_atomic_buffer,
+                                       data->NumAtomicBuffers);
+
+   for (unsigned i = 0; i < data->NumAtomicBuffers; i++) {
+      struct gl_active_atomic_buffer *ab = &data->AtomicBuffers[i];
+
+      ab->Binding = blob_read_uint32(metadata);
+      ab->MinimumSize = blob_read_uint32(metadata);
+      blob_copy_bytes(metadata, (uint8_t *) ab->StageReferences,
+                      sizeof(ab->StageReferences));
+      ab->NumUniforms = blob_read_uint32(metadata);
+      if (metadata->overrun)
+         return false;
+
+      ab->Uniforms = rzalloc_array(data->AtomicBuffers, GLuint,
+                                   ab->NumUniforms);
+      blob_copy_bytes(metadata, (uint8_t *) ab->Uniforms,
+                      ab->NumUniforms * sizeof(ab->Uniforms[0]));
+   }
+
+   /* Rebuild the per-stage lists the same way
+    * link_assign_atomic_counter_resources() does.
+    */
+   for (unsigned j = 0; j < MESA_SHADER_STAGES; j++) {
+      if (prog->_LinkedShaders[j] == NULL)
+         continue;
+
+      struct gl_program *gl_prog = prog->_LinkedShaders[j]->Program;
+      unsigned num_abos = 0;
+      for (unsigned i = 0; i < data->NumAtomicBuffers; i++)
+         num_abos += data->AtomicBuffers[i].StageReferences[j] != 0;
+
+      if (num_abos == 0)
+         continue;
+
+      gl_prog->info.num_abos = num_abos;
+      gl_prog->sh.AtomicBuffers =
+         rzalloc_array(prog, gl_active_atomic_buffer *, num_abos);
+
+      unsigned intra_stage_idx = 0;
+      for (unsigned i = 0; i < data->NumAtomicBuffers; i++) {
+         if (data->AtomicBuffers[i].StageReferences[j])
+            gl_prog->sh.AtomicBuffers[intra_stage_idx++] =
+               &data->AtomicBuffers[i];
+      }
+   }
+
+   return !metadata->overrun;
+}
+
+static void
+write_xfb(struct blob *metadata, struct gl_shader_program *prog)
+{
+   struct gl_transform_feedback_info *ltf = &prog->LinkedTransformFeedback;
+
+   blob_write_uint32(metadata, ltf->NumOutputs);
+   blob_write_uint32(metadata, ltf->ActiveBuffers);
+   blob_write_uint32(metadata, ltf->NumVarying);
+   blob_write_bytes(metadata, ltf->Outputs,
+                    ltf->NumOutputs * sizeof(ltf->Outputs[0]));
+   blob_write_bytes(metadata, ltf->Buffers, sizeof(ltf->Buffers));
+
+   for (int i = 0; i < ltf->NumVarying; i++) {
+      struct gl_transform_feedback_varying_info *v = &ltf->Varyings[i];
+
+      blob_write_string(metadata, v->Name);
+      blob_write_uint32(metadata, v->Type);
+      blob_write_uint32(metadata, v->BufferIndex);
+      blob_write_uint32(metadata, v->Size);
+      blob_write_uint32(metadata, v->Offset);
+   }
+}
+
+static bool
+read_xfb(struct blob_reader *metadata, struct gl_shader_program *prog)
+{
+   struct gl_transform_feedback_info *ltf = &prog->LinkedTransformFeedback;
+
+   ralloc_free(ltf->Varyings);
+   ralloc_free(ltf->Outputs);
+   memset(ltf, 0, sizeof(*ltf));
+
+   ltf->NumOutputs = blob_read_uint32(metadata);
+   ltf->ActiveBuffers = blob_read_uint32(metadata);
+   ltf->NumVarying = blob_read_uint32(metadata);
+   if (metadata->overrun || ltf->NumVarying < 0)
+      return false;
+
+   ltf->Outputs = rzalloc_array(prog, struct gl_transform_feedback_output,
+                                ltf->NumOutputs);
+   blob_copy_bytes(metadata, (uint8_t *) ltf->Outputs,
+                   ltf->NumOutputs * sizeof(ltf->Outputs[0]));
+   blob_copy_bytes(metadata, (uint8_t *) ltf->Buffers, sizeof(ltf->Buffers));
+
+   ltf->Varyings = rzalloc_array(prog,
+                                 struct gl_transform_feedback_varying_info,
+                                 ltf->NumVarying);
+   for (int i = 0; i < ltf->NumVarying; i++) {
+      struct gl_transform_feedback_varying_info *v = &ltf->Varyings[i];
+      const char *name = blob_read_string(metadata);
+
+      if (name == NULL)
+         return false;
+
+      v->Name = ralloc_strdup(prog, name);
+      v->Type = blob_read_uint32(metadata);
+      v->BufferIndex = blob_read_uint32(metadata);
+      v->Size = blob_read_uint32(metadata);
+      v->Offset = blob_read_uint32(metadata);
+   }
+
+   return !metadata->overrun;
+}
+
+static void
+write_block_indices(struct blob *metadata, struct gl_uniform_block **blocks,
+                    unsigned num_blocks, struct gl_uniform_block *base)
+{
+   blob_write_uint32(metadata, num_blocks);
+   for (unsigned i = 0; i < num_blocks; i++)
+      blob_write_uint32(metadata, blocks[i] - base);
+}
+
+static bool
+read_block_indices(struct blob_reader *metadata,
+                   struct gl_linked_shader *sh,
+                   struct gl_uniform_block ***blocks, unsigned *num_blocks,
+                   struct gl_uniform_block *base, unsigned num_base)
+{
+   *num_blocks = blob_read_uint32(metadata);
+   if (metadata->overrun)
+      return false;
+
+   *blocks = ralloc_array(sh, gl_uniform_block *, *num_blocks);
+   for (unsigned i = 0; i < *num_blocks; i++) {
+      const uint32_t index = blob_read_uint32(metadata);
+      if (index >= num_base)
+         return false;
+      (*blocks)[i] = &base[index];
+   }
+
+   return !metadata->overrun;
+}
+
+static bool
+write_ir_list(struct blob *metadata, exec_list *ir)
+{
+   blob_write_uint32(metadata, ir != NULL);
+   return ir == NULL || serialize_ir(metadata, ir);
+}
+
+static bool
+read_ir_list(struct blob_reader *metadata, struct gl_linked_shader *sh,
+             exec_list **ir)
+{
+   if (!blob_read_uint32(metadata))
+      return !metadata->overrun;
+
+   *ir = new(sh) exec_list;
+   return deserialize_ir(sh, metadata, *ir);
+}
+
+static bool
+write_linked_shader(struct blob *metadata, struct gl_shader_program *prog,
+                    struct gl_linked_shader *sh)
+{
+   blob_write_uint32(metadata, sh->num_samplers);
+   blob_write_uint32(metadata, sh->active_samplers);
+   blob_write_uint32(metadata, sh->shadow_samplers);
+   blob_write_bytes(metadata, sh->SamplerUnits, sizeof(sh->SamplerUnits));
+   blob_write_bytes(metadata, sh->SamplerTargets, sizeof(sh->SamplerTargets));
+   blob_write_uint32(metadata, sh->num_uniform_components);
+   blob_write_uint32(metadata, sh->num_combined_uniform_components);
+   blob_write_bytes(metadata, sh->ImageUnits, sizeof(sh->ImageUnits));
+   blob_write_bytes(metadata, sh->ImageAccess, sizeof(sh->ImageAccess));
+   blob_write_uint32(metadata, sh->NumImages);
+   blob_write_bytes(metadata, &sh->info, sizeof(sh->info));
+
+   write_block_indices(metadata, sh->UniformBlocks, sh->NumUniformBlocks,
+                       prog->data->UniformBlocks);
+   write_block_indices(metadata, sh->ShaderStorageBlocks,
+                       sh->NumShaderStorageBlocks,
+                       prog->data->ShaderStorageBlocks);
+
+   blob_write_uint32(metadata, sh->NumSubroutineUniformTypes);
+   blob_write_uint32(metadata, sh->NumSubroutineUniforms);
+   blob_write_uint32(metadata, sh->NumSubroutineUniformRemapTable);
+   for (unsigned i = 0; i < sh->NumSubroutineUniformRemapTable; i++)
+      blob_write_uint32(metadata,
+                        uniform_index(prog, sh->SubroutineUniformRemapTable[i]));
+
+   blob_write_uint32(metadata, sh->MaxSubroutineFunctionIndex);
+   blob_write_uint32(metadata, sh->NumSubroutineFunctions);
+   for (unsigned i = 0; i < sh->NumSubroutineFunctions; i++) {
+      struct gl_subroutine_function *f = &sh->SubroutineFunctions[i];
+
+      blob_write_string(metadata, f->name);
+      blob_write_uint32(metadata, f->index);
+      blob_write_uint32(metadata, f->num_compat_types);
+      for (int j = 0; j < f->num_compat_types; j++)
+         encode_type_to_blob(metadata, f->types[j]);
+   }
+
+   return write_ir_list(metadata, sh->ir) &&
+          write_ir_list(metadata, sh->packed_varyings) &&
+          write_ir_list(metadata, sh->fragdata_arrays);
+}
+
+static bool
+read_linked_shader(struct blob_reader *metadata,
+                   struct gl_shader_program *prog,
+                   struct gl_linked_shader *sh)
+{
+   sh->num_samplers = blob_read_uint32(metadata);
+   sh->active_samplers = blob_read_uint32(metadata);
+   sh->shadow_samplers = blob_read_uint32(metadata);
+   blob_copy_bytes(metadata, (uint8_t *) sh->SamplerUnits,
+                   sizeof(sh->SamplerUnits));
+   blob_copy_bytes(metadata, (uint8_t *) sh->SamplerTargets,
+                   sizeof(sh->SamplerTargets));
+   sh->num_uniform_components = blob_read_uint32(metadata);
+   sh->num_combined_uniform_components = blob_read_uint32(metadata);
+   blob_copy_bytes(metadata, (uint8_t *) sh->ImageUnits,
+                   sizeof(sh->ImageUnits));
+   blob_copy_bytes(metadata, (uint8_t *) sh->ImageAccess,
+                   sizeof(sh->ImageAccess));
+   sh->NumImages = blob_read_uint32(metadata);
+   blob_copy_bytes(metadata, (uint8_t *) &sh->info, sizeof(sh->info));
+
+   if (!read_block_indices(metadata, sh, &sh->UniformBlocks,
+                           &sh->NumUniformBlocks,
+                           prog->data->UniformBlocks,
+                           prog->data->NumUniformBlocks) ||
+       !read_block_indices(metadata, sh, &sh->ShaderStorageBlocks,
+                           &sh->NumShaderStorageBlocks,
+                           prog->data->ShaderStorageBlocks,
+                           prog->data->NumShaderStorageBlocks))
+      return false;
+
+   sh->NumSubroutineUniformTypes = blob_read_uint32(metadata);
+   sh->NumSubroutineUniforms = blob_read_uint32(metadata);
+   sh->NumSubroutineUniformRemapTable = blob_read_uint32(metadata);
+   if (metadata->overrun)
+      return false;
+
+   sh->SubroutineUniformRemapTable =
+      rzalloc_array(sh, struct gl_uniform_storage *,
+                    sh->NumSubroutineUniformRemapTable);
+   for (unsigned i = 0; i < sh->NumSubroutineUniformRemapTable; i++)
+      sh->SubroutineUniformRemapTable[i] =
+         uniform_from_index(prog, blob_read_uint32(metadata));
+
+   sh->MaxSubroutineFunctionIndex = blob_read_uint32(metadata);
+   sh->NumSubroutineFunctions = blob_read_uint32(metadata);
+   if (metadata->overrun)
+      return false;
+
+   sh->SubroutineFunctions = rzalloc_array(sh, struct gl_subroutine_function,
+                                           sh->NumSubroutineFunctions);
+   for (unsigned i = 0; i < sh->NumSubroutineFunctions; i++) {
+      struct gl_subroutine_function *f = &sh->SubroutineFunctions[i];
+      const char *name = blob_read_string(metadata);
+
+      if (name == NULL)
+         return false;
+
+      f->name = ralloc_strdup(sh, name);
+      f->index = blob_read_uint32(metadata);
+      f->num_compat_types = blob_read_uint32(metadata);
+      if (metadata->overrun || f->num_compat_types < 0)
+         return false;
+
+      f->types = ralloc_array(sh, const struct glsl_type *,
+                              f->num_compat_types);
+      for (int j = 0; j < f->num_compat_types; j++)
+         f->types[j] = decode_type_from_blob(metadata);
+   }
+
+   return read_ir_list(metadata, sh, &sh->ir) &&
+          read_ir_list(metadata, sh, &sh->packed_varyings) &&
+          read_ir_list(metadata, sh, &sh->fragdata_arrays);
+}
+
+static bool
+write_program(struct blob *metadata, struct gl_shader_program *prog)
+{
+   blob_write_uint32(metadata, prog->data->Version);
+   blob_write_uint32(metadata, prog->data->linked_stages);
+   blob_write_uint32(metadata, prog->IsES);
+   blob_write_uint32(metadata, prog->ARB_fragment_coord_conventions_enable);
+   blob_write_string(metadata, prog->data->InfoLog);
+
+   blob_write_uint32(metadata, prog->FragDepthLayout);
+   blob_write_bytes(metadata, &prog->TessEval, sizeof(prog->TessEval));
+   blob_write_bytes(metadata, &prog->Geom, sizeof(prog->Geom));
+   blob_write_bytes(metadata, &prog->Vert, sizeof(prog->Vert));
+   blob_write_bytes(metadata, &prog->Comp, sizeof(prog->Comp));
+   blob_write_uint32(metadata, prog->LastClipDistanceArraySize);
+   blob_write_uint32(metadata, prog->LastCullDistanceArraySize);
+
+   write_uniforms(metadata, prog);
+   write_uniform_hash(metadata, prog);
+   write_buffer_blocks(metadata, prog->data->UniformBlocks,
+                       prog->data->NumUniformBlocks);
+   write_buffer_blocks(metadata, prog->data->ShaderStorageBlocks,
+                       prog->data->NumShaderStorageBlocks);
+   write_xfb(metadata, prog);
+
+   bool ok = true;
+   for (unsigned i = 0; i < MESA_SHADER_STAGES && ok; i++) {
+      struct gl_linked_shader *sh = prog->_LinkedShaders[i];
+
+      blob_write_uint32(metadata, sh != NULL);
+      if (sh)
+         ok = write_linked_shader(metadata, prog, sh);
+   }
+
+   /* The per-stage atomic buffer lists hang off the gl_programs, so these
+    * come after the linked shaders.
+    */
+   write_atomic_buffers(metadata, prog);
+
+   return ok;
+}
+
+bool
+shader_cache_serialize_program(struct gl_shader_program *prog)
+{
+   ralloc_free(prog->data->Binary);
+   prog->data->Binary = NULL;
+   prog->data->BinarySize = 0;
+
+   struct blob *metadata = blob_create(NULL);
+   if (!metadata)
+      return false;
+
+   bool ok = write_program(metadata, prog);
+   if (ok) {
+      prog->data->Binary = (uint8_t *)
+         ralloc_size(prog->data, metadata->size);
+      ok = prog->data->Binary != NULL;
+   }
+
+   if (ok) {
+      memcpy(prog->data->Binary, metadata->data, metadata->size);
+      prog->data->BinarySize = metadata->size;
+   }
+
+   ralloc_free(metadata);
+   return ok;
+}
+
+void
+shader_cache_write_program(struct gl_context *ctx,
+                           struct gl_shader_program *prog,
+                           cache_key key)
+{
+   if (ctx->Cache && prog->data->Binary)
+      disk_cache_put(ctx->Cache, key, prog->data->Binary,
+                     prog->data->BinarySize);
+}
+
+static bool
+read_program(struct gl_context *ctx, struct blob_reader *metadata,
+             struct gl_shader_program *prog)
+{
+   prog->data->Version = blob_read_uint32(metadata);
+   prog->data->linked_stages = blob_read_uint32(metadata);
+   prog->IsES = blob_read_uint32(metadata);
+   prog->ARB_fragment_coord_conventions_enable = blob_read_uint32(metadata);
+
+   const char *info_log = blob_read_string(metadata);
+   if (info_log == NULL)
+      return false;
+   ralloc_free(prog->data->InfoLog);
+   prog->data->InfoLog = ralloc_strdup(prog->data, info_log);
+
+   prog->FragDepthLayout = (enum gl_frag_depth_layout)
+      blob_read_uint32(metadata);
+   blob_copy_bytes(metadata, (uint8_t *) &prog->TessEval,
+                   sizeof(prog->TessEval));
+   blob_copy_bytes(metadata, (uint8_t *) &prog->Geom, sizeof(prog->Geom));
+   blob_copy_bytes(metadata, (uint8_t *) &prog->Vert, sizeof(prog->Vert));
+   blob_copy_bytes(metadata, (uint8_t *) &prog->Comp, sizeof(prog->Comp));
+   prog->LastClipDistanceArraySize = blob_read_uint32(metadata);
+   prog->LastCullDistanceArraySize = blob_read_uint32(metadata);
+
+   if (!read_uniforms(metadata, prog) ||
+       !read_uniform_hash(metadata, prog) ||
+       !read_buffer_blocks(metadata, prog, &prog->data->UniformBlocks,
+                           &prog->data->NumUniformBlocks) ||
+       !read_buffer_blocks(metadata, prog, &prog->data->ShaderStorageBlocks,
+                           &prog->data->NumShaderStorageBlocks) ||
+       !read_xfb(metadata, prog))
+      return false;
+
+   for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+      if (!blob_read_uint32(metadata))
+         continue;
+
+      struct gl_linked_shader *sh = ctx->Driver.NewShader((gl_shader_stage) i);
+      struct gl_program *gl_prog =
+         ctx->Driver.NewProgram(ctx, _mesa_shader_stage_to_program(i),
+                                prog->Name);
+      if (!gl_prog) {
+         _mesa_delete_linked_shader(ctx, sh);
+         return false;
+      }
+
+      /* Don't use _mesa_reference_program() just take ownership */
+      sh->Program = gl_prog;
+      prog->_LinkedShaders[i] = sh;
+
+      if (!read_linked_shader(metadata, prog, sh))
+         return false;
+   }
+
+   return read_atomic_buffers(metadata, prog) &&
+          metadata->current == metadata->end;
+}
+
+bool
+shader_cache_deserialize_program(struct gl_context *ctx,
+                                 struct gl_shader_program *prog,
+                                 const void *data, size_t size)
+{
+   /* Read from a copy, which is kept for glGetProgramBinary; the data given
+    * by the application isn't necessarily aligned.
+    */
+   uint8_t *copy = (uint8_t *) ralloc_size(prog->data, size);
+   if (copy == NULL)
+      return false;
+   memcpy(copy, data, size);
+
+   struct blob_reader metadata;
+   blob_reader_init(&metadata, copy, size);
+
+   if (read_program(ctx, &metadata, prog)) {
+      ralloc_free(prog->data->Binary);
+      prog->data->Binary = copy;
+      prog->data->BinarySize = size;
+      return true;
+   }
+
+   /* Throw away whatever was partially restored. */
+   ralloc_free(copy);
+   _mesa_clear_shader_program_data(ctx, prog);
+   prog->data->LinkStatus = true;
+   return false;
+}
+
+bool
+shader_cache_read_program(struct gl_context *ctx,
+                          struct gl_shader_program *prog,
+                          cache_key key)
+{
+   if (!ctx->Cache)
+      return false;
+
+   size_t size;
+   uint8_t *buffer = (uint8_t *) disk_cache_get(ctx->Cache, key, &size);
+   if (buffer == NULL)
+      return false;
+
+   /* On failure, the caller links the program from scratch. */
+   const bool ok = shader_cache_deserialize_program(ctx, prog, buffer, size);
+   free(buffer);
+
+   if (!ok)
+      return false;
+
+   if (ctx->_Shader->Flags & GLSL_DUMP)
+      fprintf(stderr, "GLSL program %u restored from the shader cache\n",
+              prog->Name);
+
+   return true;
+}
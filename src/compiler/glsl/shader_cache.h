@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+/**
+ * \file shader_cache.h
+ *
+ * Persistent cache of linked GLSL programs, built on util/disk_cache.
+ *
+ * Shaders are keyed by the SHA-1 of their source together with everything
+ * in the context that can change the result of compiling them (the build,
+ * the API, the enabled extensions and the driver's gl_constants).  A shader
+ * whose key is already known is not compiled at all; its compile status is
+ * set to \c compile_skipped and the work is deferred to link time.
+ *
+ * Programs are keyed by the keys of their shaders plus the link-time state
+ * (attribute and fragment data bindings, transform feedback varyings, ...).
+ * On a hit, link_shaders() rebuilds the linked shaders and the program's
+ * uniform, block and transform feedback state straight from the cache.  On
+ * a miss, any skipped shader is compiled before linking and the result of
+ * the link is written back to the cache.
+ *
+ * The serialized program is also what glGetProgramBinary returns, prefixed
+ * with the hash of the context state so that glProgramBinary can reject
+ * binaries from another driver or build.
+ */
+
+#include "util/disk_cache.h"
+
+struct gl_context;
+struct gl_shader;
+struct gl_shader_program;
+
+/**
+ * Compute the 20-byte hash of the build and of the context state that
+ * affects compiling and linking, without any shader in it.
+ */
+void
+shader_cache_compute_driver_sha1(struct gl_context *ctx,
+                                 unsigned char *sha1);
+
+/**
+ * Compute gl_shader::sha1 from the shader source and the context state.
+ */
+void
+shader_cache_compute_shader_key(struct gl_context *ctx,
+                                struct gl_shader *shader);
+
+/**
+ * Compute the cache key for linking \c prog with its current shaders.
+ */
+void
+shader_cache_compute_program_key(struct gl_context *ctx,
+                                 struct gl_shader_program *prog,
+                                 cache_key key);
+
+/**
+ * Try to restore the result of linking \c prog from the cache.
+ *
+ * \return true if \c prog was restored; false (leaving \c prog cleared) if
+ *         it must be linked normally.
+ */
+bool
+shader_cache_read_program(struct gl_context *ctx,
+                          struct gl_shader_program *prog,
+                          cache_key key);
+
+/**
+ * Serialize the result of successfully linking \c prog into
+ * gl_shader_program_data::Binary.  Must be called before the driver's
+ * LinkShader hook lowers the linked IR.
+ */
+bool
+shader_cache_serialize_program(struct gl_shader_program *prog);
+
+/**
+ * Restore the result of linking \c prog from \c data, as produced by
+ * shader_cache_serialize_program().
+ *
+ * \return true on success; false (leaving \c prog cleared) if \c data is
+ *         malformed.
+ */
+bool
+shader_cache_deserialize_program(struct gl_context *ctx,
+                                 struct gl_shader_program *prog,
+                                 const void *data, size_t size);
+
+/**
+ * Store gl_shader_program_data::Binary, the result of successfully linking
+ * \c prog, in the cache.
+ */
+void
+shader_cache_write_program(struct gl_context *ctx,
+                           struct gl_shader_program *prog,
+                           cache_key key);
+
+#endif /* SHADER_CACHE_H */
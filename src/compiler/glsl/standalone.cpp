@@ -21,6 +21,10 @@
  * DEALINGS IN THE SOFTWARE.
  */
 #include <getopt.h>
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
 
 /** @file standalone.cpp
  *
@@ -33,11 +37,13 @@
 #include "glsl_parser_extras.h"
 #include "ir_optimization.h"
 #include "program.h"
+#include "glsl_to_nir.h"
 #include "loop_analysis.h"
 #include "standalone_scaffolding.h"
 #include "standalone.h"
 #include "util/string_to_uint_map.h"
 #include "util/set.h"
+#include "util/u_atomic.h"
 #include "linker.h"
 #include "glsl_parser_extras.h"
 #include "ir_builder_print_visitor.h"
@@ -384,7 +390,8 @@ compile_shader(struct gl_context *ctx, struct gl_shader *shader)
    struct _mesa_glsl_parse_state *state =
       new(shader) _mesa_glsl_parse_state(ctx, shader->Stage, shader);
 
-   _mesa_glsl_compile_shader(ctx, shader, options->dump_ast, options->dump_hir);
+   _mesa_glsl_compile_shader(ctx, shader, options->dump_ast,
+                             options->dump_hir, true);
 
    /* Print out the resulting IR */
    if (!state->error && options->dump_lir) {
@@ -394,22 +401,15 @@ compile_shader(struct gl_context *ctx, struct gl_shader *shader)
    return;
 }
 
-extern "C" struct gl_shader_program *
-standalone_compile_shader(const struct standalone_options *_options,
-      unsigned num_files, char* const* files)
+/* Returns the API to compile GLSL \p version shaders for. */
+static bool
+get_glsl_api(int version, gl_api *api)
 {
-   int status = EXIT_SUCCESS;
-   static struct gl_context local_ctx;
-   struct gl_context *ctx = &local_ctx;
-   bool glsl_es = false;
-
-   options = _options;
-
-   switch (options->glsl_version) {
+   switch (version) {
    case 100:
    case 300:
-      glsl_es = true;
-      break;
+      *api = API_OPENGLES2;
+      return true;
    case 110:
    case 120:
    case 130:
@@ -422,18 +422,55 @@ standalone_compile_shader(const struct standalone_options *_options,
    case 430:
    case 440:
    case 450:
-      glsl_es = false;
-      break;
+      *api = version > 130 ? API_OPENGL_CORE : API_OPENGL_COMPAT;
+      return true;
    default:
-      fprintf(stderr, "Unrecognized GLSL version `%d'\n", options->glsl_version);
-      return NULL;
+      fprintf(stderr, "Unrecognized GLSL version `%d'\n", version);
+      return false;
    }
+}
 
-   if (glsl_es) {
-      initialize_context(ctx, API_OPENGLES2);
-   } else {
-      initialize_context(ctx, options->glsl_version > 130 ? API_OPENGL_CORE : API_OPENGL_COMPAT);
-   }
+/* Returns the shader type for a file name extension, or 0. */
+static GLenum
+get_shader_type(const char *file_name)
+{
+   const unsigned len = strlen(file_name);
+   if (len < 6)
+      return 0;
+
+   const char *const ext = & file_name[len - 5];
+   /* TODO add support to read a .shader_test */
+   if (strncmp(".vert", ext, 5) == 0 || strncmp(".glsl", ext, 5) == 0)
+      return GL_VERTEX_SHADER;
+   else if (strncmp(".tesc", ext, 5) == 0)
+      return GL_TESS_CONTROL_SHADER;
+   else if (strncmp(".tese", ext, 5) == 0)
+      return GL_TESS_EVALUATION_SHADER;
+   else if (strncmp(".geom", ext, 5) == 0)
+      return GL_GEOMETRY_SHADER;
+   else if (strncmp(".frag", ext, 5) == 0)
+      return GL_FRAGMENT_SHADER;
+   else if (strncmp(".comp", ext, 5) == 0)
+      return GL_COMPUTE_SHADER;
+   else
+      return 0;
+}
+
+extern "C" struct gl_shader_program *
+standalone_compile_shader(const struct standalone_options *_options,
+      unsigned num_files, char* const* files)
+{
+   int status = EXIT_SUCCESS;
+   static struct gl_context local_ctx;
+   struct gl_context *ctx = &local_ctx;
+   gl_api api;
+
+   options = _options;
+
+   if (!get_glsl_api(options->glsl_version, &api))
+      return NULL;
+
+   initialize_context(ctx, api);
 
    struct gl_shader_program *whole_program;
 
@@ -459,25 +496,8 @@ standalone_compile_shader(const struct standalone_options *_options,
       whole_program->Shaders[whole_program->NumShaders] = shader;
       whole_program->NumShaders++;
 
-      const unsigned len = strlen(files[i]);
-      if (len < 6)
-         goto fail;
-
-      const char *const ext = & files[i][len - 5];
-      /* TODO add support to read a .shader_test */
-      if (strncmp(".vert", ext, 5) == 0 || strncmp(".glsl", ext, 5) == 0)
-	 shader->Type = GL_VERTEX_SHADER;
-      else if (strncmp(".tesc", ext, 5) == 0)
-	 shader->Type = GL_TESS_CONTROL_SHADER;
-      else if (strncmp(".tese", ext, 5) == 0)
-	 shader->Type = GL_TESS_EVALUATION_SHADER;
-      else if (strncmp(".geom", ext, 5) == 0)
-	 shader->Type = GL_GEOMETRY_SHADER;
-      else if (strncmp(".frag", ext, 5) == 0)
-	 shader->Type = GL_FRAGMENT_SHADER;
-      else if (strncmp(".comp", ext, 5) == 0)
-         shader->Type = GL_COMPUTE_SHADER;
-      else
+      shader->Type = get_shader_type(files[i]);
+      if (shader->Type == 0)
          goto fail;
       shader->Stage = _mesa_shader_enum_to_shader_stage(shader->Type);
 
@@ -596,8 +616,8 @@ fail:
    return NULL;
 }
 
-extern "C" void
-standalone_compiler_cleanup(struct gl_shader_program *whole_program)
+static void
+free_shader_program(struct gl_shader_program *whole_program)
 {
    for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
       if (whole_program->_LinkedShaders[i])
@@ -609,6 +629,380 @@ standalone_compiler_cleanup(struct gl_shader_program *whole_program)
    delete whole_program->FragDataIndexBindings;
 
    ralloc_free(whole_program);
+}
+
+extern "C" void
+standalone_compiler_cleanup(struct gl_shader_program *whole_program)
+{
+   free_shader_program(whole_program);
    _mesa_glsl_release_types();
    _mesa_glsl_release_builtin_functions();
 }
+
+/* A program of the --bench mode: all the shaders of one directory. */
+struct bench_program {
+   char *name;
+   unsigned num_files;
+   char **files;
+
+   bool compiled;
+   bool linked;
+   struct glsl_compile_times times;
+   uint64_t link;
+   uint64_t glsl_to_nir;
+};
+
+struct bench_state {
+   gl_api api;
+   nir_shader_compiler_options nir_options;
+
+   unsigned num_programs;
+   struct bench_program *programs;
+
+   /** Index of the next program to compile, shared by the threads. */
+   unsigned next;
+};
+
+static uint64_t
+bench_time_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int
+compare_strings(const void *a, const void *b)
+{
+   return strcmp(*(const char *const *) a, *(const char *const *) b);
+}
+
+static int
+compare_programs(const void *a, const void *b)
+{
+   return strcmp(((const struct bench_program *) a)->name,
+                 ((const struct bench_program *) b)->name);
+}
+
+static bool
+is_directory(const char *path)
+{
+   struct stat st;
+   return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/**
+ * Adds a program for every subdirectory of \p dir that contains shaders.
+ */
+static void
+bench_add_programs(void *mem_ctx, struct bench_state *bench, const char *dir)
+{
+   DIR *d = opendir(dir);
+   struct dirent *entry;
+
+   if (!d) {
+      fprintf(stderr, "Cannot open directory \"%s\".\n", dir);
+      return;
+   }
+
+   while ((entry = readdir(d)) != NULL) {
+      if (entry->d_name[0] == '.')
+         continue;
+
+      char *path = ralloc_asprintf(mem_ctx, "%s/%s", dir, entry->d_name);
+      DIR *program_dir;
+      if (!is_directory(path) || !(program_dir = opendir(path)))
+         continue;
+
+      struct bench_program prog;
+      memset(&prog, 0, sizeof(prog));
+      prog.name = path;
+
+      struct dirent *file;
+      while ((file = readdir(program_dir)) != NULL) {
+         if (file->d_name[0] == '.' || get_shader_type(file->d_name) == 0)
+            continue;
+
+         prog.files = reralloc(mem_ctx, prog.files, char *,
+                               prog.num_files + 1);
+         prog.files[prog.num_files++] =
+            ralloc_asprintf(mem_ctx, "%s/%s", path, file->d_name);
+      }
+      closedir(program_dir);
+
+      if (prog.num_files == 0)
+         continue;
+
+      qsort(prog.files, prog.num_files, sizeof(char *), compare_strings);
+
+      bench->programs = reralloc(mem_ctx, bench->programs,
+                                 struct bench_program,
+                                 bench->num_programs + 1);
+      bench->programs[bench->num_programs++] = prog;
+   }
+
+   closedir(d);
+}
+
+/**
+ * Compiles and links one program like standalone_compile_shader() with
+ * --link, and converts the linked shaders to NIR, timing every step.
+ */
+static void
+bench_run_program(struct gl_context *ctx, const struct bench_state *bench,
+                  struct bench_program *prog)
+{
+   struct gl_shader_program *whole_program;
+
+   whole_program = rzalloc (NULL, struct gl_shader_program);
+   assert(whole_program != NULL);
+   whole_program->data = rzalloc(whole_program, struct gl_shader_program_data);
+   assert(whole_program->data != NULL);
+   whole_program->data->InfoLog = ralloc_strdup(whole_program->data, "");
+
+   whole_program->AttributeBindings = new string_to_uint_map;
+   whole_program->FragDataBindings = new string_to_uint_map;
+   whole_program->FragDataIndexBindings = new string_to_uint_map;
+
+   whole_program->Shaders = ralloc_array(whole_program, struct gl_shader *,
+                                         prog->num_files);
+   assert(whole_program->Shaders != NULL);
+
+   prog->compiled = true;
+   for (unsigned i = 0; i < prog->num_files; i++) {
+      struct gl_shader *shader = rzalloc(whole_program, gl_shader);
+
+      whole_program->Shaders[whole_program->NumShaders] = shader;
+      whole_program->NumShaders++;
+
+      shader->Type = get_shader_type(prog->files[i]);
+      shader->Stage = _mesa_shader_enum_to_shader_stage(shader->Type);
+      shader->Source = load_text_file(whole_program, prog->files[i]);
+      if (shader->Source == NULL) {
+         prog->compiled = false;
+         break;
+      }
+
+      _mesa_glsl_compile_shader_timed(ctx, shader, false, false, true,
+                                      &prog->times);
+      if (!shader->CompileStatus) {
+         prog->compiled = false;
+         break;
+      }
+   }
+
+   if (prog->compiled) {
+      uint64_t start = bench_time_ns();
+
+      _mesa_clear_shader_program_data(ctx, whole_program);
+      link_shaders(ctx, whole_program);
+      prog->linked = whole_program->data->LinkStatus;
+      prog->link = bench_time_ns() - start;
+
+      if (prog->linked) {
+         start = bench_time_ns();
+         for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+            if (!whole_program->_LinkedShaders[i])
+               continue;
+
+            nir_shader *nir = glsl_to_nir(whole_program, (gl_shader_stage) i,
+                                          &bench->nir_options);
+            ralloc_free(nir);
+         }
+         prog->glsl_to_nir = bench_time_ns() - start;
+      }
+   }
+
+   free_shader_program(whole_program);
+}
+
+static int
+bench_thread(void *data)
+{
+   struct bench_state *bench = (struct bench_state *) data;
+   struct gl_context *ctx = (struct gl_context *) calloc(1, sizeof(*ctx));
+
+   if (!ctx)
+      return 1;
+
+   initialize_context(ctx, bench->api);
+
+   while (true) {
+      const unsigned i = p_atomic_inc_return(&bench->next) - 1;
+      if (i >= bench->num_programs)
+         break;
+
+      bench_run_program(ctx, bench, &bench->programs[i]);
+   }
+
+   free(ctx);
+   return 0;
+}
+
+static void
+bench_add_times(struct glsl_compile_times *total,
+                const struct glsl_compile_times *times)
+{
+   total->preprocess += times->preprocess;
+   total->parse += times->parse;
+   total->ast_to_hir += times->ast_to_hir;
+   total->optimize += times->optimize;
+
+   for (unsigned i = 0; i < times->num_passes; i++) {
+      unsigned j;
+
+      for (j = 0; j < total->num_passes; j++) {
+         if (strcmp(total->passes[j].name, times->passes[i].name) == 0)
+            break;
+      }
+
+      if (j == total->num_passes) {
+         if (j == ARRAY_SIZE(total->passes))
+            continue;
+
+         total->passes[j].name = times->passes[i].name;
+         total->num_passes++;
+      }
+
+      total->passes[j].runs += times->passes[i].runs;
+      total->passes[j].ns += times->passes[i].ns;
+   }
+}
+
+static void
+print_json_string(const char *str)
+{
+   putchar('"');
+   for (; *str; str++) {
+      if (*str == '"' || *str == '\\')
+         putchar('\\');
+      putchar(*str);
+   }
+   putchar('"');
+}
+
+static void
+print_phase_times(const struct glsl_compile_times *times, uint64_t link,
+                  uint64_t glsl_to_nir)
+{
+   printf("\"preprocess_ms\": %.3f, \"parse_ms\": %.3f, "
+          "\"ast_to_hir_ms\": %.3f, \"optimize_ms\": %.3f, "
+          "\"link_ms\": %.3f, \"glsl_to_nir_ms\": %.3f",
+          times->preprocess / 1000000.0, times->parse / 1000000.0,
+          times->ast_to_hir / 1000000.0, times->optimize / 1000000.0,
+          link / 1000000.0, glsl_to_nir / 1000000.0);
+}
+
+/**
+ * Compiles, links and converts to NIR every program found in \p dirs on
+ * options->threads threads, and prints the time spent in each phase as
+ * JSON.
+ */
+extern "C" int
+standalone_benchmark(const struct standalone_options *_options,
+                     unsigned num_dirs, char* const* dirs)
+{
+   void *mem_ctx = ralloc_context(NULL);
+   struct bench_state bench;
+   unsigned num_threads = MAX2(_options->threads, 1);
+   unsigned num_started = 0;
+   unsigned failed = 0;
+
+   options = _options;
+
+   memset(&bench, 0, sizeof(bench));
+   if (!get_glsl_api(options->glsl_version, &bench.api)) {
+      ralloc_free(mem_ctx);
+      return EXIT_FAILURE;
+   }
+   bench.nir_options.native_integers = true;
+
+   for (unsigned i = 0; i < num_dirs; i++)
+      bench_add_programs(mem_ctx, &bench, dirs[i]);
+
+   if (bench.num_programs == 0) {
+      fprintf(stderr, "No shader programs found.\n");
+      ralloc_free(mem_ctx);
+      return EXIT_FAILURE;
+   }
+
+   qsort(bench.programs, bench.num_programs, sizeof(struct bench_program),
+         compare_programs);
+
+   thrd_t *threads = ralloc_array(mem_ctx, thrd_t, num_threads);
+   const uint64_t start = bench_time_ns();
+
+   for (unsigned i = 0; i < num_threads; i++) {
+      if (thrd_create(&threads[i], bench_thread, &bench) != thrd_success)
+         break;
+      num_started++;
+   }
+
+   /* Compile on this thread if none could be started. */
+   if (num_started == 0)
+      bench_thread(&bench);
+
+   for (unsigned i = 0; i < num_started; i++)
+      thrd_join(threads[i], NULL);
+
+   const uint64_t wall = bench_time_ns() - start;
+
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+
+   struct glsl_compile_times *total = rzalloc(mem_ctx,
+                                              struct glsl_compile_times);
+   uint64_t link = 0, glsl_to_nir = 0;
+
+   for (unsigned i = 0; i < bench.num_programs; i++) {
+      const struct bench_program *prog = &bench.programs[i];
+
+      bench_add_times(total, &prog->times);
+      link += prog->link;
+      glsl_to_nir += prog->glsl_to_nir;
+      if (!prog->linked)
+         failed++;
+   }
+
+   printf("{\n");
+   printf("  \"threads\": %u,\n", MAX2(num_started, 1));
+   printf("  \"programs\": %u,\n", bench.num_programs);
+   printf("  \"failed\": %u,\n", failed);
+   printf("  \"wall_ms\": %.3f,\n", wall / 1000000.0);
+   /* ru_maxrss is in kilobytes on Linux. */
+   printf("  \"peak_rss_kb\": %ld,\n", usage.ru_maxrss);
+   printf("  \"total\": { ");
+   print_phase_times(total, link, glsl_to_nir);
+   printf(" },\n");
+
+   printf("  \"passes\": [\n");
+   for (unsigned i = 0; i < total->num_passes; i++) {
+      printf("    { \"name\": ");
+      print_json_string(total->passes[i].name);
+      printf(", \"runs\": %u, \"ms\": %.3f }%s\n", total->passes[i].runs,
+             total->passes[i].ns / 1000000.0,
+             i + 1 < total->num_passes ? "," : "");
+   }
+   printf("  ],\n");
+
+   printf("  \"per_program\": [\n");
+   for (unsigned i = 0; i < bench.num_programs; i++) {
+      const struct bench_program *prog = &bench.programs[i];
+
+      printf("    { \"name\": ");
+      print_json_string(prog->name);
+      printf(", \"status\": \"%s\", ",
+             prog->linked ? "ok" :
+             prog->compiled ? "link_failed" : "compile_failed");
+      print_phase_times(&prog->times, prog->link, prog->glsl_to_nir);
+      printf(" }%s\n", i + 1 < bench.num_programs ? "," : "");
+   }
+   printf("  ]\n");
+   printf("}\n");
+
+   ralloc_free(mem_ctx);
+   _mesa_glsl_release_types();
+   _mesa_glsl_release_builtin_functions();
+
+   return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
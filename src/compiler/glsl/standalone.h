@@ -36,6 +36,8 @@ struct standalone_options {
    int dump_builder;
    int do_link;
    int just_log;
+   int bench;
+   int threads;
 };
 
 struct gl_shader_program;
@@ -46,6 +48,9 @@ struct gl_shader_program * standalone_compile_shader(
 
 void standalone_compiler_cleanup(struct gl_shader_program *prog);
 
+int standalone_benchmark(const struct standalone_options *options,
+                         unsigned num_dirs, char* const* dirs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -263,6 +263,9 @@ test_put_and_get(void)
 
    free(one_KB);
 
+   /* Let the eviction happen. */
+   disk_cache_wait_for_idle(cache);
+
    result = disk_cache_get(cache, one_KB_key, &size);
    expect_non_null(result, "3rd disk_cache_get of existing item (pointer)");
    expect_equal(size, 1024, "3rd disk_cache_get of existing item (size)");
@@ -314,6 +317,8 @@ test_put_and_get(void)
 
    free(one_MB);
 
+   disk_cache_wait_for_idle(cache);
+
    count = 0;
    if (does_cache_contain(cache, blob_key))
        count++;
@@ -380,6 +385,90 @@ test_put_key_and_get_key(void)
 
    disk_cache_destroy(cache);
 }
+
+static void
+test_archive(void)
+{
+   struct disk_cache *cache;
+   char blob[] = "This is a blob of thirty-seven bytes";
+   uint8_t blob_key[20];
+   uint8_t *item[3];
+   uint8_t item_key[3][20];
+   char *result;
+   size_t size;
+   int i, j;
+
+   setenv("MESA_GLSL_CACHE_ARCHIVE", "1", 1);
+   setenv("MESA_GLSL_CACHE_MAX_SIZE", "1M", 1);
+
+   cache = disk_cache_create();
+   expect_non_null(cache, "disk_cache_create with MESA_GLSL_CACHE_ARCHIVE");
+
+   _mesa_sha1_compute(blob, sizeof(blob), blob_key);
+   result = disk_cache_get(cache, blob_key, &size);
+   expect_null(result, "archive get of non-existent item");
+
+   /* Items are readable before and after they are written out. */
+   disk_cache_put(cache, blob_key, blob, sizeof(blob));
+   result = disk_cache_get(cache, blob_key, &size);
+   expect_equal_str(blob, result, "archive get of pending item (pointer)");
+   expect_equal(size, sizeof(blob), "archive get of pending item (size)");
+   free(result);
+
+   disk_cache_destroy(cache);
+   cache = disk_cache_create();
+
+   result = disk_cache_get(cache, blob_key, &size);
+   expect_equal_str(blob, result, "archive get of stored item (pointer)");
+   expect_equal(size, sizeof(blob), "archive get of stored item (size)");
+   free(result);
+
+   disk_cache_destroy(cache);
+
+   /* Fill a 2K cache with two incompressible 700 byte items, use the
+    * first one and add a third one: the second one is the least recently
+    * used and must be the one evicted.
+    */
+   setenv("MESA_GLSL_CACHE_MAX_SIZE", "2K", 1);
+
+   for (i = 0; i < 3; i++) {
+      item[i] = malloc(700);
+      for (j = 0; j < 700; j++)
+         item[i][j] = rand();
+      _mesa_sha1_compute(item[i], 700, item_key[i]);
+   }
+
+   cache = disk_cache_create();
+   disk_cache_put(cache, item_key[0], item[0], 700);
+   disk_cache_put(cache, item_key[1], item[1], 700);
+   disk_cache_destroy(cache);
+
+   cache = disk_cache_create();
+   result = disk_cache_get(cache, item_key[0], &size);
+   expect_non_null(result, "archive get before eviction");
+   expect_equal(size, 700, "archive get before eviction (size)");
+   if (result)
+      expect_equal(memcmp(result, item[0], 700), 0,
+                   "archive get before eviction (data)");
+   free(result);
+
+   disk_cache_put(cache, item_key[2], item[2], 700);
+   disk_cache_destroy(cache);
+
+   cache = disk_cache_create();
+   expect_equal(does_cache_contain(cache, item_key[0]), 1,
+                "archive keeps the recently used item");
+   expect_equal(does_cache_contain(cache, item_key[1]), 0,
+                "archive evicts the least recently used item");
+   expect_equal(does_cache_contain(cache, item_key[2]), 1,
+                "archive keeps the new item");
+   disk_cache_destroy(cache);
+
+   for (i = 0; i < 3; i++)
+      free(item[i]);
+
+   unsetenv("MESA_GLSL_CACHE_ARCHIVE");
+}
 #endif /* ENABLE_SHADER_CACHE */
 
 int
@@ -394,6 +483,8 @@ main(void)
 
    test_put_key_and_get_key();
 
+   test_archive();
+
    err = rmrf_local(CACHE_TEST_TMP);
    expect_equal(err, 0, "Removing " CACHE_TEST_TMP " again");
 #endif /* ENABLE_SHADER_CACHE */
@@ -26,16 +26,184 @@
 #include "compiler/glsl/glsl_parser_extras.h"
 #include "glsl_types.h"
 #include "util/hash_table.h"
+#include "util/u_atomic.h"
+#include "compiler/glsl/blob.h"
 
 
 mtx_t glsl_type::mutex = _MTX_INITIALIZER_NP;
-hash_table *glsl_type::array_types = NULL;
-hash_table *glsl_type::record_types = NULL;
-hash_table *glsl_type::interface_types = NULL;
-hash_table *glsl_type::function_types = NULL;
-hash_table *glsl_type::subroutine_types = NULL;
 void *glsl_type::mem_ctx = NULL;
 
+
+/**
+ * \name Tables of derived types
+ *
+ * Array, record, interface, subroutine and function types are interned in
+ * insert-only open-addressing tables so that looking up a type that already
+ * exists never takes a lock.  A slot is published by storing its type
+ * pointer with release semantics after its hash, and a table that fills up
+ * is replaced by a larger copy rather than rehashed in place.  A reader that
+ * raced with an insertion therefore sees either the old or the new storage,
+ * both of which live until _mesa_glsl_release_types().  Lookups that miss
+ * are retried under \c type_table_mutex before the new type is added.
+ */
+/*@{*/
+namespace {
+
+struct type_table_slot {
+   uint32_t hash;
+   const glsl_type *type;
+};
+
+struct type_table_storage {
+   /** Storage this one replaced, freed along with it. */
+   type_table_storage *prev;
+
+   /** Number of slots, always a power of two. */
+   unsigned size;
+   unsigned entries;
+   type_table_slot *slots;
+};
+
+struct type_table {
+   type_table_storage *storage;
+};
+
+/** Array types are keyed on the base type pointer and the array size. */
+struct array_type_key {
+   const glsl_type *base;
+   unsigned size;
+};
+
+} /* anonymous namespace */
+
+typedef bool (*type_key_match_func)(const glsl_type *type, const void *key);
+
+static mtx_t type_table_mutex = _MTX_INITIALIZER_NP;
+
+static type_table array_types;
+static type_table record_types;
+static type_table interface_types;
+static type_table subroutine_types;
+static type_table function_types;
+
+static const glsl_type *
+type_table_search(type_table *table, uint32_t hash, const void *key,
+                  type_key_match_func match)
+{
+   const type_table_storage *const s = p_atomic_read(&table->storage);
+
+   if (s == NULL)
+      return NULL;
+
+   const unsigned mask = s->size - 1;
+
+   /* The table is never more than half full, so this always terminates. */
+   for (unsigned i = hash & mask; ; i = (i + 1) & mask) {
+      const glsl_type *const t = p_atomic_read(&s->slots[i].type);
+
+      if (t == NULL)
+         return NULL;
+
+      if (s->slots[i].hash == hash && match(t, key))
+         return t;
+   }
+}
+
+/**
+ * Replace the storage of \c table with one twice as large.
+ *
+ * Must be called with \c type_table_mutex held.
+ */
+static bool
+type_table_grow(type_table *table)
+{
+   type_table_storage *const old = table->storage;
+   const unsigned size = old != NULL ? old->size * 2 : 64;
+   const unsigned mask = size - 1;
+
+   type_table_storage *const s = (type_table_storage *)
+      calloc(1, sizeof(*s) + size * sizeof(s->slots[0]));
+   if (s == NULL)
+      return false;
+
+   s->prev = old;
+   s->size = size;
+   s->slots = (type_table_slot *) (s + 1);
+
+   if (old != NULL) {
+      for (unsigned i = 0; i < old->size; i++) {
+         if (old->slots[i].type == NULL)
+            continue;
+
+         unsigned j = old->slots[i].hash & mask;
+         while (s->slots[j].type != NULL)
+            j = (j + 1) & mask;
+
+         s->slots[j] = old->slots[i];
+      }
+
+      s->entries = old->entries;
+   }
+
+   p_atomic_set(&table->storage, s);
+   return true;
+}
+
+/**
+ * Add \c type to \c table unless another thread added a matching type first.
+ *
+ * \return the type that is now in the table for \c key.
+ */
+static const glsl_type *
+type_table_insert(type_table *table, uint32_t hash, const void *key,
+                  type_key_match_func match, const glsl_type *type)
+{
+   mtx_lock(&type_table_mutex);
+
+   const glsl_type *t = type_table_search(table, hash, key, match);
+   if (t == NULL) {
+      type_table_storage *s = table->storage;
+
+      if (s == NULL || (s->entries + 1) * 2 > s->size) {
+         if (!type_table_grow(table)) {
+            mtx_unlock(&type_table_mutex);
+            return type;
+         }
+         s = table->storage;
+      }
+
+      const unsigned mask = s->size - 1;
+      unsigned i = hash & mask;
+      while (s->slots[i].type != NULL)
+         i = (i + 1) & mask;
+
+      s->slots[i].hash = hash;
+      p_atomic_set(&s->slots[i].type, type);
+      s->entries++;
+
+      t = type;
+   }
+
+   mtx_unlock(&type_table_mutex);
+
+   return t;
+}
+
+static void
+type_table_destroy(type_table *table)
+{
+   type_table_storage *s = table->storage;
+
+   while (s != NULL) {
+      type_table_storage *const prev = s->prev;
+      free(s);
+      s = prev;
+   }
+
+   table->storage = NULL;
+}
+/*@}*/
+
 void
 glsl_type::init_ralloc_type_ctx(void)
 {
@@ -394,20 +562,11 @@ _mesa_glsl_release_types(void)
     * object, or if process terminates), so no mutex-locking should be
     * necessary.
     */
-   if (glsl_type::array_types != NULL) {
-      _mesa_hash_table_destroy(glsl_type::array_types, NULL);
-      glsl_type::array_types = NULL;
-   }
-
-   if (glsl_type::record_types != NULL) {
-      _mesa_hash_table_destroy(glsl_type::record_types, NULL);
-      glsl_type::record_types = NULL;
-   }
-
-   if (glsl_type::interface_types != NULL) {
-      _mesa_hash_table_destroy(glsl_type::interface_types, NULL);
-      glsl_type::interface_types = NULL;
-   }
+   type_table_destroy(&array_types);
+   type_table_destroy(&record_types);
+   type_table_destroy(&interface_types);
+   type_table_destroy(&subroutine_types);
+   type_table_destroy(&function_types);
 }
 
 
@@ -813,42 +972,90 @@ glsl_type::get_image_instance(enum glsl_sampler_dim dim,
    unreachable("switch statement above should be complete");
 }
 
+static bool
+array_key_match(const glsl_type *type, const void *key)
+{
+   const array_type_key *const k = (const array_type_key *) key;
+
+   return type->fields.array == k->base && type->length == k->size;
+}
+
 const glsl_type *
 glsl_type::get_array_instance(const glsl_type *base, unsigned array_size)
 {
-   /* Generate a name using the base type pointer in the key.  This is
-    * done because the name of the base type may not be unique across
-    * shaders.  For example, two shaders may have different record types
-    * named 'foo'.
+   /* Key on the base type pointer rather than its name.  This is done
+    * because the name of the base type may not be unique across shaders.
+    * For example, two shaders may have different record types named 'foo'.
     */
-   char key[128];
-   snprintf(key, sizeof(key), "%p[%u]", (void *) base, array_size);
+   const array_type_key key = { base, array_size };
 
-   mtx_lock(&glsl_type::mutex);
+   uint32_t hash = _mesa_fnv32_1a_offset_bias;
+   hash = _mesa_fnv32_1a_accumulate(hash, base);
+   hash = _mesa_fnv32_1a_accumulate(hash, array_size);
+
+   const glsl_type *t = type_table_search(&array_types, hash, &key,
+                                          array_key_match);
+   if (t == NULL) {
+      glsl_type *const created = new glsl_type(base, array_size);
 
-   if (array_types == NULL) {
-      array_types = _mesa_hash_table_create(NULL, _mesa_key_hash_string,
-                                            _mesa_key_string_equal);
+      t = type_table_insert(&array_types, hash, &key, array_key_match,
+                            created);
+      if (t != created)
+         delete created;
    }
 
-   const struct hash_entry *entry = _mesa_hash_table_search(array_types, key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(base, array_size);
-      mtx_lock(&glsl_type::mutex);
+   assert(t->base_type == GLSL_TYPE_ARRAY);
+   assert(t->length == array_size);
+   assert(t->fields.array == base);
 
-      entry = _mesa_hash_table_insert(array_types,
-                                      ralloc_strdup(mem_ctx, key),
-                                      (void *) t);
-   }
+   return t;
+}
 
-   assert(((glsl_type *) entry->data)->base_type == GLSL_TYPE_ARRAY);
-   assert(((glsl_type *) entry->data)->length == array_size);
-   assert(((glsl_type *) entry->data)->fields.array == base);
 
-   mtx_unlock(&glsl_type::mutex);
+static bool
+record_fields_compare(const glsl_struct_field *a, const glsl_struct_field *b,
+                      unsigned length, bool match_locations)
+{
+   for (unsigned i = 0; i < length; i++) {
+      if (a[i].type != b[i].type)
+         return false;
+      if (strcmp(a[i].name, b[i].name) != 0)
+         return false;
+      if (a[i].matrix_layout != b[i].matrix_layout)
+        return false;
+      if (match_locations && a[i].location != b[i].location)
+         return false;
+      if (a[i].offset != b[i].offset)
+         return false;
+      if (a[i].interpolation != b[i].interpolation)
+         return false;
+      if (a[i].centroid != b[i].centroid)
+         return false;
+      if (a[i].sample != b[i].sample)
+         return false;
+      if (a[i].patch != b[i].patch)
+         return false;
+      if (a[i].image_read_only != b[i].image_read_only)
+         return false;
+      if (a[i].image_write_only != b[i].image_write_only)
+         return false;
+      if (a[i].image_coherent != b[i].image_coherent)
+         return false;
+      if (a[i].image_volatile != b[i].image_volatile)
+         return false;
+      if (a[i].image_restrict != b[i].image_restrict)
+         return false;
+      if (a[i].precision != b[i].precision)
+         return false;
+      if (a[i].explicit_xfb_buffer != b[i].explicit_xfb_buffer)
+         return false;
+      if (a[i].xfb_buffer != b[i].xfb_buffer)
+         return false;
+      if (a[i].xfb_stride != b[i].xfb_stride)
+         return false;
+   }
 
-   return (glsl_type *) entry->data;
+   return true;
 }
 
 
@@ -878,97 +1085,51 @@ glsl_type::record_compare(const glsl_type *b, bool match_locations) const
       if (strcmp(this->name, b->name) != 0)
          return false;
 
-   for (unsigned i = 0; i < this->length; i++) {
-      if (this->fields.structure[i].type != b->fields.structure[i].type)
-         return false;
-      if (strcmp(this->fields.structure[i].name,
-                 b->fields.structure[i].name) != 0)
-         return false;
-      if (this->fields.structure[i].matrix_layout
-         != b->fields.structure[i].matrix_layout)
-        return false;
-      if (match_locations && this->fields.structure[i].location
-          != b->fields.structure[i].location)
-         return false;
-      if (this->fields.structure[i].offset
-          != b->fields.structure[i].offset)
-         return false;
-      if (this->fields.structure[i].interpolation
-          != b->fields.structure[i].interpolation)
-         return false;
-      if (this->fields.structure[i].centroid
-          != b->fields.structure[i].centroid)
-         return false;
-      if (this->fields.structure[i].sample
-          != b->fields.structure[i].sample)
-         return false;
-      if (this->fields.structure[i].patch
-          != b->fields.structure[i].patch)
-         return false;
-      if (this->fields.structure[i].image_read_only
-          != b->fields.structure[i].image_read_only)
-         return false;
-      if (this->fields.structure[i].image_write_only
-          != b->fields.structure[i].image_write_only)
-         return false;
-      if (this->fields.structure[i].image_coherent
-          != b->fields.structure[i].image_coherent)
-         return false;
-      if (this->fields.structure[i].image_volatile
-          != b->fields.structure[i].image_volatile)
-         return false;
-      if (this->fields.structure[i].image_restrict
-          != b->fields.structure[i].image_restrict)
-         return false;
-      if (this->fields.structure[i].precision
-          != b->fields.structure[i].precision)
-         return false;
-      if (this->fields.structure[i].explicit_xfb_buffer
-          != b->fields.structure[i].explicit_xfb_buffer)
-         return false;
-      if (this->fields.structure[i].xfb_buffer
-          != b->fields.structure[i].xfb_buffer)
-         return false;
-      if (this->fields.structure[i].xfb_stride
-          != b->fields.structure[i].xfb_stride)
-         return false;
-   }
-
-   return true;
+   return record_fields_compare(this->fields.structure, b->fields.structure,
+                                this->length, match_locations);
 }
 
 
-bool
-glsl_type::record_key_compare(const void *a, const void *b)
-{
-   const glsl_type *const key1 = (glsl_type *) a;
-   const glsl_type *const key2 = (glsl_type *) b;
+namespace {
+
+/** Lookup key for record and interface types. */
+struct record_type_key {
+   const glsl_struct_field *fields;
+   unsigned num_fields;
+   unsigned packing;
+   bool row_major;
+   const char *name;
+};
 
-   return strcmp(key1->name, key2->name) == 0 && key1->record_compare(key2);
+} /* anonymous namespace */
+
+static bool
+record_key_match(const glsl_type *type, const void *key)
+{
+   const record_type_key *const k = (const record_type_key *) key;
+
+   return type->length == k->num_fields &&
+          type->interface_packing == k->packing &&
+          type->interface_row_major == k->row_major &&
+          strcmp(type->name, k->name) == 0 &&
+          record_fields_compare(type->fields.structure, k->fields,
+                                k->num_fields, true);
 }
 
 
 /**
- * Generate an integer hash value for a glsl_type structure type.
+ * Generate an integer hash value for a record or interface type key.
  */
-unsigned
-glsl_type::record_key_hash(const void *a)
+static uint32_t
+record_key_hash(const record_type_key *key)
 {
-   const glsl_type *const key = (glsl_type *) a;
-   uintptr_t hash = key->length;
-   unsigned retval;
-
-   for (unsigned i = 0; i < key->length; i++) {
-      /* casting pointer to uintptr_t */
-      hash = (hash * 13 ) + (uintptr_t) key->fields.structure[i].type;
-   }
+   uint32_t hash = _mesa_hash_string(key->name);
 
-   if (sizeof(hash) == 8)
-      retval = (hash & 0xffffffff) ^ ((uint64_t) hash >> 32);
-   else
-      retval = hash;
+   hash = _mesa_fnv32_1a_accumulate(hash, key->num_fields);
+   for (unsigned i = 0; i < key->num_fields; i++)
+      hash = _mesa_fnv32_1a_accumulate(hash, key->fields[i].type);
 
-   return retval;
+   return hash;
 }
 
 
@@ -977,32 +1138,25 @@ glsl_type::get_record_instance(const glsl_struct_field *fields,
                                unsigned num_fields,
                                const char *name)
 {
-   const glsl_type key(fields, num_fields, name);
-
-   mtx_lock(&glsl_type::mutex);
-
-   if (record_types == NULL) {
-      record_types = _mesa_hash_table_create(NULL, record_key_hash,
-                                             record_key_compare);
+   const record_type_key key = { fields, num_fields, 0, false, name };
+   const uint32_t hash = record_key_hash(&key);
+
+   const glsl_type *t = type_table_search(&record_types, hash, &key,
+                                          record_key_match);
+   if (t == NULL) {
+      glsl_type *const created = new glsl_type(fields, num_fields, name);
+
+      t = type_table_insert(&record_types, hash, &key, record_key_match,
+                            created);
+      if (t != created)
+         delete created;
    }
 
-   const struct hash_entry *entry = _mesa_hash_table_search(record_types,
-                                                            &key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(fields, num_fields, name);
-      mtx_lock(&glsl_type::mutex);
+   assert(t->base_type == GLSL_TYPE_STRUCT);
+   assert(t->length == num_fields);
+   assert(strcmp(t->name, name) == 0);
 
-      entry = _mesa_hash_table_insert(record_types, t, (void *) t);
-   }
-
-   assert(((glsl_type *) entry->data)->base_type == GLSL_TYPE_STRUCT);
-   assert(((glsl_type *) entry->data)->length == num_fields);
-   assert(strcmp(((glsl_type *) entry->data)->name, name) == 0);
-
-   mtx_unlock(&glsl_type::mutex);
-
-   return (glsl_type *) entry->data;
+   return t;
 }
 
 
@@ -1013,86 +1167,111 @@ glsl_type::get_interface_instance(const glsl_struct_field *fields,
                                   bool row_major,
                                   const char *block_name)
 {
-   const glsl_type key(fields, num_fields, packing, row_major, block_name);
-
-   mtx_lock(&glsl_type::mutex);
-
-   if (interface_types == NULL) {
-      interface_types = _mesa_hash_table_create(NULL, record_key_hash,
-                                                record_key_compare);
+   const record_type_key key = {
+      fields, num_fields, (unsigned) packing, row_major, block_name
+   };
+   const uint32_t hash = record_key_hash(&key);
+
+   const glsl_type *t = type_table_search(&interface_types, hash, &key,
+                                          record_key_match);
+   if (t == NULL) {
+      glsl_type *const created = new glsl_type(fields, num_fields,
+                                               packing, row_major,
+                                               block_name);
+
+      t = type_table_insert(&interface_types, hash, &key, record_key_match,
+                            created);
+      if (t != created)
+         delete created;
    }
 
-   const struct hash_entry *entry = _mesa_hash_table_search(interface_types,
-                                                            &key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(fields, num_fields,
-                                         packing, row_major, block_name);
-      mtx_lock(&glsl_type::mutex);
-
-      entry = _mesa_hash_table_insert(interface_types, t, (void *) t);
-   }
+   assert(t->base_type == GLSL_TYPE_INTERFACE);
+   assert(t->length == num_fields);
+   assert(strcmp(t->name, block_name) == 0);
 
-   assert(((glsl_type *) entry->data)->base_type == GLSL_TYPE_INTERFACE);
-   assert(((glsl_type *) entry->data)->length == num_fields);
-   assert(strcmp(((glsl_type *) entry->data)->name, block_name) == 0);
+   return t;
+}
 
-   mtx_unlock(&glsl_type::mutex);
 
-   return (glsl_type *) entry->data;
+static bool
+subroutine_key_match(const glsl_type *type, const void *key)
+{
+   return strcmp(type->name, (const char *) key) == 0;
 }
 
 const glsl_type *
 glsl_type::get_subroutine_instance(const char *subroutine_name)
 {
-   const glsl_type key(subroutine_name);
-
-   mtx_lock(&glsl_type::mutex);
-
-   if (subroutine_types == NULL) {
-      subroutine_types = _mesa_hash_table_create(NULL, record_key_hash,
-                                                 record_key_compare);
+   const uint32_t hash = _mesa_hash_string(subroutine_name);
+
+   const glsl_type *t = type_table_search(&subroutine_types, hash,
+                                          subroutine_name,
+                                          subroutine_key_match);
+   if (t == NULL) {
+      glsl_type *const created = new glsl_type(subroutine_name);
+
+      t = type_table_insert(&subroutine_types, hash, subroutine_name,
+                            subroutine_key_match, created);
+      if (t != created)
+         delete created;
    }
 
-   const struct hash_entry *entry = _mesa_hash_table_search(subroutine_types,
-                                                            &key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(subroutine_name);
-      mtx_lock(&glsl_type::mutex);
+   assert(t->base_type == GLSL_TYPE_SUBROUTINE);
+   assert(strcmp(t->name, subroutine_name) == 0);
 
-      entry = _mesa_hash_table_insert(subroutine_types, t, (void *) t);
-   }
+   return t;
+}
 
-   assert(((glsl_type *) entry->data)->base_type == GLSL_TYPE_SUBROUTINE);
-   assert(strcmp(((glsl_type *) entry->data)->name, subroutine_name) == 0);
 
-   mtx_unlock(&glsl_type::mutex);
+namespace {
 
-   return (glsl_type *) entry->data;
-}
+/** Lookup key for function types. */
+struct function_type_key {
+   const glsl_type *return_type;
+   const glsl_function_param *params;
+   unsigned num_params;
+};
 
+} /* anonymous namespace */
 
 static bool
-function_key_compare(const void *a, const void *b)
+function_key_match(const glsl_type *type, const void *key)
 {
-   const glsl_type *const key1 = (glsl_type *) a;
-   const glsl_type *const key2 = (glsl_type *) b;
+   const function_type_key *const k = (const function_type_key *) key;
+
+   if (type->length != k->num_params)
+      return false;
 
-   if (key1->length != key2->length)
+   /* The return type is stored as the first parameter. */
+   if (type->fields.parameters[0].type != k->return_type)
       return false;
 
-   return memcmp(key1->fields.parameters, key2->fields.parameters,
-                 (key1->length + 1) * sizeof(*key1->fields.parameters)) == 0;
+   for (unsigned i = 0; i < k->num_params; i++) {
+      const glsl_function_param *const p = &type->fields.parameters[i + 1];
+
+      if (p->type != k->params[i].type ||
+          p->in != k->params[i].in ||
+          p->out != k->params[i].out)
+         return false;
+   }
+
+   return true;
 }
 
 
 static uint32_t
-function_key_hash(const void *a)
+function_key_hash(const function_type_key *key)
 {
-   const glsl_type *const key = (glsl_type *) a;
-   return _mesa_hash_data(key->fields.parameters,
-                          (key->length + 1) * sizeof(*key->fields.parameters));
+   uint32_t hash = _mesa_fnv32_1a_offset_bias;
+
+   hash = _mesa_fnv32_1a_accumulate(hash, key->return_type);
+   for (unsigned i = 0; i < key->num_params; i++) {
+      hash = _mesa_fnv32_1a_accumulate(hash, key->params[i].type);
+      hash = _mesa_fnv32_1a_accumulate(hash, key->params[i].in);
+      hash = _mesa_fnv32_1a_accumulate(hash, key->params[i].out);
+   }
+
+   return hash;
 }
 
 const glsl_type *
@@ -1100,31 +1279,24 @@ glsl_type::get_function_instance(const glsl_type *return_type,
                                  const glsl_function_param *params,
                                  unsigned num_params)
 {
-   const glsl_type key(return_type, params, num_params);
-
-   mtx_lock(&glsl_type::mutex);
-
-   if (function_types == NULL) {
-      function_types = _mesa_hash_table_create(NULL, function_key_hash,
-                                               function_key_compare);
+   const function_type_key key = { return_type, params, num_params };
+   const uint32_t hash = function_key_hash(&key);
+
+   const glsl_type *t = type_table_search(&function_types, hash, &key,
+                                          function_key_match);
+   if (t == NULL) {
+      glsl_type *const created = new glsl_type(return_type, params,
+                                               num_params);
+
+      t = type_table_insert(&function_types, hash, &key, function_key_match,
+                            created);
+      if (t != created)
+         delete created;
    }
 
-   struct hash_entry *entry = _mesa_hash_table_search(function_types, &key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(return_type, params, num_params);
-      mtx_lock(&glsl_type::mutex);
-
-      entry = _mesa_hash_table_insert(function_types, t, (void *) t);
-   }
-
-   const glsl_type *t = (const glsl_type *)entry->data;
-
    assert(t->base_type == GLSL_TYPE_FUNCTION);
    assert(t->length == num_params);
 
-   mtx_unlock(&glsl_type::mutex);
-
    return t;
 }
 
@@ -2007,3 +2179,152 @@ glsl_type::coordinate_components() const
 
 #include "compiler/builtin_type_macros.h"
 /** @} */
+
+void
+encode_type_to_blob(struct blob *blob, const glsl_type *type)
+{
+   if (type == NULL) {
+      blob_write_uint32(blob, 0);
+      return;
+   }
+
+   blob_write_uint32(blob, type->base_type + 1);
+
+   switch (type->base_type) {
+   case GLSL_TYPE_UINT:
+   case GLSL_TYPE_INT:
+   case GLSL_TYPE_FLOAT:
+   case GLSL_TYPE_DOUBLE:
+   case GLSL_TYPE_BOOL:
+      blob_write_uint32(blob, (type->vector_elements << 8) |
+                              type->matrix_columns);
+      return;
+   case GLSL_TYPE_SAMPLER:
+   case GLSL_TYPE_IMAGE:
+      blob_write_uint32(blob, (type->sampler_dimensionality << 8) |
+                              (type->sampler_shadow << 4) |
+                              (type->sampler_array << 2) |
+                              type->sampled_type);
+      return;
+   case GLSL_TYPE_ARRAY:
+      blob_write_uint32(blob, type->length);
+      encode_type_to_blob(blob, type->fields.array);
+      return;
+   case GLSL_TYPE_STRUCT:
+   case GLSL_TYPE_INTERFACE:
+      blob_write_string(blob, type->name);
+      blob_write_uint32(blob, type->length);
+      blob_write_uint32(blob, (type->interface_packing << 1) |
+                              type->interface_row_major);
+      for (unsigned i = 0; i < type->length; i++) {
+         const glsl_struct_field *field = &type->fields.structure[i];
+
+         encode_type_to_blob(blob, field->type);
+         blob_write_string(blob, field->name);
+         blob_write_bytes(blob, &field->location,
+                          sizeof(glsl_struct_field) -
+                          offsetof(glsl_struct_field, location));
+      }
+      return;
+   case GLSL_TYPE_SUBROUTINE:
+      blob_write_string(blob, type->name);
+      return;
+   case GLSL_TYPE_ATOMIC_UINT:
+   case GLSL_TYPE_VOID:
+   case GLSL_TYPE_FUNCTION:
+   case GLSL_TYPE_ERROR:
+      return;
+   }
+}
+
+const glsl_type *
+decode_type_from_blob(struct blob_reader *blob)
+{
+   uint32_t tag = blob_read_uint32(blob);
+
+   if (tag == 0)
+      return NULL;
+
+   const glsl_base_type base_type = (glsl_base_type) (tag - 1);
+
+   switch (base_type) {
+   case GLSL_TYPE_UINT:
+   case GLSL_TYPE_INT:
+   case GLSL_TYPE_FLOAT:
+   case GLSL_TYPE_DOUBLE:
+   case GLSL_TYPE_BOOL: {
+      uint32_t encoding = blob_read_uint32(blob);
+      return glsl_type::get_instance(base_type, (encoding >> 8) & 0xff,
+                                     encoding & 0xff);
+   }
+   case GLSL_TYPE_SAMPLER:
+   case GLSL_TYPE_IMAGE: {
+      uint32_t encoding = blob_read_uint32(blob);
+      glsl_sampler_dim dim = (glsl_sampler_dim) ((encoding >> 8) & 0xf);
+      bool shadow = (encoding >> 4) & 1;
+      bool array = (encoding >> 2) & 1;
+      glsl_base_type sampled = (glsl_base_type) (encoding & 3);
+
+      if (base_type == GLSL_TYPE_SAMPLER)
+         return glsl_type::get_sampler_instance(dim, shadow, array, sampled);
+      return glsl_type::get_image_instance(dim, array, sampled);
+   }
+   case GLSL_TYPE_ARRAY: {
+      unsigned length = blob_read_uint32(blob);
+      const glsl_type *element = decode_type_from_blob(blob);
+      if (element == NULL)
+         return glsl_type::error_type;
+      return glsl_type::get_array_instance(element, length);
+   }
+   case GLSL_TYPE_STRUCT:
+   case GLSL_TYPE_INTERFACE: {
+      char *name = blob_read_string(blob);
+      unsigned length = blob_read_uint32(blob);
+      uint32_t layout = blob_read_uint32(blob);
+
+      if (name == NULL || blob->overrun)
+         return glsl_type::error_type;
+
+      glsl_struct_field *fields =
+         ralloc_array(NULL, glsl_struct_field, length);
+      for (unsigned i = 0; i < length; i++) {
+         fields[i].type = decode_type_from_blob(blob);
+         fields[i].name = blob_read_string(blob);
+         blob_copy_bytes(blob, (uint8_t *) &fields[i].location,
+                         sizeof(glsl_struct_field) -
+                         offsetof(glsl_struct_field, location));
+         if (fields[i].type == NULL || fields[i].name == NULL ||
+             blob->overrun) {
+            ralloc_free(fields);
+            return glsl_type::error_type;
+         }
+      }
+
+      const glsl_type *type;
+      if (base_type == GLSL_TYPE_STRUCT) {
+         type = glsl_type::get_record_instance(fields, length, name);
+      } else {
+         type = glsl_type::get_interface_instance(fields, length,
+                   (glsl_interface_packing) (layout >> 1),
+                   layout & 1, name);
+      }
+      ralloc_free(fields);
+      return type;
+   }
+   case GLSL_TYPE_SUBROUTINE: {
+      char *name = blob_read_string(blob);
+      if (name == NULL)
+         return glsl_type::error_type;
+      return glsl_type::get_subroutine_instance(name);
+   }
+   case GLSL_TYPE_ATOMIC_UINT:
+      return glsl_type::atomic_uint_type;
+   case GLSL_TYPE_VOID:
+      return glsl_type::void_type;
+   case GLSL_TYPE_FUNCTION:
+   case GLSL_TYPE_ERROR:
+      break;
+   }
+
+   return glsl_type::error_type;
+}
@@ -1779,6 +1779,12 @@ typedef struct nir_shader_compiler_options {
     * information must be inferred from the list of input nir_variables.
     */
    bool use_interpolated_input_intrinsics;
+
+   /**
+    * Maximum number of iterations of a loop nir_opt_loop_unroll() will
+    * unroll.  Zero disables loop unrolling.
+    */
+   unsigned max_unroll_iterations;
 } nir_shader_compiler_options;
 
 typedef struct nir_shader {
@@ -1826,6 +1832,12 @@ typedef struct nir_shader {
 
    /** The shader stage, such as MESA_SHADER_VERTEX. */
    gl_shader_stage stage;
+
+   /**
+    * Hash identifying the shader in NIR_PASS statistics, computed from its
+    * contents before the first pass runs.  NULL unless NIR_PASS_STATS is set.
+    */
+   char *pass_stats_id;
 } nir_shader;
 
 static inline nir_function_impl *
@@ -2254,8 +2266,43 @@ static inline void nir_metadata_check_validation_flag(nir_shader *shader) { (voi
 static inline bool should_clone_nir(void) { return false; }
 #endif /* DEBUG */
 
-#define _PASS(nir, do_pass) do {                                     \
+/** Instruction-level statistics about a shader */
+typedef struct {
+   unsigned num_instrs;
+   unsigned num_ssa_defs;
+
+   /** Largest number of SSA values live at the same time in a function */
+   unsigned max_live_ssa_defs;
+} nir_shader_stats;
+
+void nir_gather_shader_stats(nir_shader *shader, nir_shader_stats *stats);
+
+/**
+ * State for recording statistics around a single NIR_PASS.
+ *
+ * If the NIR_PASS_STATS environment variable names a file (or "stderr"),
+ * every pass run through NIR_PASS or NIR_PASS_V appends a CSV row with the
+ * shader's statistics before and after the pass and the time it took.
+ */
+typedef struct {
+   nir_shader_stats before;
+   uint64_t start_ns;
+} nir_pass_stats;
+
+bool nir_pass_stats_enabled(void);
+void nir_pass_stats_begin(nir_shader *shader, nir_pass_stats *stats);
+void nir_pass_stats_end(nir_shader *shader, nir_pass_stats *stats,
+                        const char *pass, int progress);
+
+#define _PASS(nir, pass, do_pass) do {                               \
+   nir_pass_stats _pass_stats;                                       \
+   const bool _collect_stats = nir_pass_stats_enabled();             \
+   int _pass_progress = -1;                                          \
+   if (_collect_stats)                                               \
+      nir_pass_stats_begin(nir, &_pass_stats);                       \
    do_pass                                                           \
+   if (_collect_stats)                                               \
+      nir_pass_stats_end(nir, &_pass_stats, #pass, _pass_progress);  \
    nir_validate_shader(nir);                                         \
    if (should_clone_nir()) {                                         \
       nir_shader *clone = nir_shader_clone(ralloc_parent(nir), nir); \
@@ -2264,15 +2311,16 @@ static inline bool should_clone_nir(void) { return false; }
    }                                                                 \
 } while (0)
 
-#define NIR_PASS(progress, nir, pass, ...) _PASS(nir,                \
+#define NIR_PASS(progress, nir, pass, ...) _PASS(nir, pass,          \
    nir_metadata_set_validation_flag(nir);                            \
-   if (pass(nir, ##__VA_ARGS__)) {                                   \
+   _pass_progress = pass(nir, ##__VA_ARGS__);                        \
+   if (_pass_progress) {                                             \
       progress = true;                                               \
       nir_metadata_check_validation_flag(nir);                       \
    }                                                                 \
 )
 
-#define NIR_PASS_V(nir, pass, ...) _PASS(nir,                        \
+#define NIR_PASS_V(nir, pass, ...) _PASS(nir, pass,                  \
    pass(nir, ##__VA_ARGS__);                                         \
 )
 
@@ -2525,12 +2573,18 @@ bool nir_opt_dead_cf(nir_shader *shader);
 
 bool nir_opt_gcm(nir_shader *shader, bool value_number);
 
+bool nir_opt_licm(nir_shader *shader);
+
+bool nir_opt_loop_unroll(nir_shader *shader);
+
 bool nir_opt_peephole_select(nir_shader *shader, unsigned limit);
 
 bool nir_opt_remove_phis(nir_shader *shader);
 
 bool nir_opt_undef(nir_shader *shader);
 
+bool nir_opt_vectorize_io(nir_shader *shader);
+
 bool nir_opt_conditional_discard(nir_shader *shader);
 
 void nir_sweep(nir_shader *shader);
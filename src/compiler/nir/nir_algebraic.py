@@ -494,87 +494,190 @@ class SearchAndReplace(object):
 
       BitSizeValidator(varset).validate(self.search, self.replace)
 
-_algebraic_pass_template = mako.template.Template("""
-#include "nir.h"
-#include "nir_search.h"
+class TreeAutomaton(object):
+   """A bottom-up tree automaton recognizing the search expressions of a pass.
+
+   Each search expression is broken down into "items": one for every
+   sub-expression, with all variables collapsed into a single wildcard item
+   and all constants (and variables which must be constant) into a single
+   constant item.  The state of an SSA value is the set of items it may
+   match.  For an ALU instruction, that set only depends on the opcode and
+   the states of its sources, so the transitions can be computed here ahead
+   of time and looked up in a table at compile time.  Only the transforms
+   whose search expression is in the state of an instruction need to be
+   tried with nir_replace_instr(), which still does the exact matching.
+
+   Tables are indexed by the states of every source, so to keep them small
+   the source states are first projected through a per-opcode filter which
+   only keeps the items that are used as a source of that opcode.
+   """
 
-#ifndef NIR_OPT_ALGEBRAIC_STRUCT_DEFS
-#define NIR_OPT_ALGEBRAIC_STRUCT_DEFS
+   WILDCARD = 0
+   CONSTANT = 1
 
-struct transform {
-   const nir_search_expression *search;
-   const nir_search_value *replace;
-   unsigned condition_offset;
-};
+   def __init__(self, transforms):
+      self._items = {}
+      self._item_list = []
+      self._op_items = {}
+      self._op_srcs = {}
+
+      assert self._get_item(('__wildcard',)) == self.WILDCARD
+      assert self._get_item(('__const',)) == self.CONSTANT
+
+      self.roots = [self._build_item(xform.search) for xform in transforms]
+      self.opcodes = sorted(self._op_items.keys())
+
+      self._build_states()
+
+   def _get_item(self, item):
+      if item not in self._items:
+         self._items[item] = len(self._item_list)
+         self._item_list.append(item)
+      return self._items[item]
+
+   def _build_item(self, val):
+      if isinstance(val, Constant):
+         return self.CONSTANT
+      elif isinstance(val, Variable):
+         return self.CONSTANT if val.is_constant else self.WILDCARD
+
+      assert isinstance(val, Expression)
+      srcs = tuple(self._build_item(src) for src in val.sources)
+      item = self._get_item((val.opcode, srcs))
+
+      self._op_items.setdefault(val.opcode, set()).add(item)
+      self._op_srcs.setdefault(val.opcode, set()).update(srcs)
+      return item
+
+   def _transition(self, opcode, src_sets):
+      commutative = 'commutative' in opcodes[opcode].algebraic_properties
+      state = set([self.WILDCARD])
+      for item in self._op_items[opcode]:
+         srcs = self._item_list[item][1]
+         if all(src in src_sets[i] for i, src in enumerate(srcs)):
+            state.add(item)
+         elif commutative and srcs[0] in src_sets[1] and srcs[1] in src_sets[0]:
+            state.add(item)
+      return frozenset(state)
+
+   def _build_states(self):
+      self.states = []
+      state_index = {}
+      worklist = []
+
+      def add_state(state):
+         if state not in state_index:
+            state_index[state] = len(self.states)
+            self.states.append(state)
+            worklist.append(state)
+         return state_index[state]
+
+      # One list of filtered states per opcode, the filter mapping every
+      # state to its filtered state, and the flattened transition table.
+      filtered = dict((op, []) for op in self.opcodes)
+      filtered_index = dict((op, {}) for op in self.opcodes)
+      self.filters = dict((op, []) for op in self.opcodes)
+      tables = dict((op, {}) for op in self.opcodes)
+
+      assert add_state(frozenset([self.WILDCARD])) == self.WILDCARD
+      assert add_state(frozenset([self.WILDCARD,
+                                  self.CONSTANT])) == self.CONSTANT
+
+      # States are processed in the order they are created so that the
+      # filters end up indexed by state.
+      while worklist:
+         state = worklist.pop(0)
+         for op in self.opcodes:
+            projected = state & self._op_srcs[op]
+            if projected in filtered_index[op]:
+               self.filters[op].append(filtered_index[op][projected])
+               continue
+
+            new = len(filtered[op])
+            filtered_index[op][projected] = new
+            filtered[op].append(projected)
+            self.filters[op].append(new)
+
+            num_srcs = opcodes[op].num_inputs
+            for srcs in itertools.product(range(len(filtered[op])),
+                                          repeat=num_srcs):
+               if new not in srcs:
+                  continue
+               src_sets = [filtered[op][i] for i in srcs]
+               tables[op][srcs] = add_state(self._transition(op, src_sets))
+
+      assert len(self.states) < (1 << 16)
+
+      self.num_filtered = dict((op, len(filtered[op])) for op in self.opcodes)
+      self.tables = {}
+      for op in self.opcodes:
+         num_srcs = opcodes[op].num_inputs
+         self.tables[op] = \
+            [tables[op][srcs] for srcs in
+             itertools.product(range(self.num_filtered[op]), repeat=num_srcs)]
+
+      # The transforms to try for each state, in their original order.
+      self.state_xforms = [[i for i, root in enumerate(self.roots)
+                            if root in state] for state in self.states]
 
-#endif
+_algebraic_pass_template = mako.template.Template("""
+#include "nir.h"
+#include "nir_search.h"
 
-% for (opcode, xform_list) in xform_dict.iteritems():
-% for xform in xform_list:
+% for xform in xforms:
    ${xform.search.render()}
    ${xform.replace.render()}
 % endfor
 
-static const struct transform ${pass_name}_${opcode}_xforms[] = {
-% for xform in xform_list:
-   { &${xform.search.name}, ${xform.replace.c_ptr}, ${xform.condition_index} },
+% for state_id, state_xforms in enumerate(automaton.state_xforms):
+% if state_xforms:
+static const struct transform ${pass_name}_state${state_id}_xforms[] = {
+% for i in state_xforms:
+   { &${xforms[i].search.name}, ${xforms[i].replace.c_ptr}, ${xforms[i].condition_index} },
 % endfor
 };
+% endif
 % endfor
 
-static bool
-${pass_name}_block(nir_block *block, const bool *condition_flags,
-                   void *mem_ctx)
-{
-   bool progress = false;
-
-   nir_foreach_instr_reverse_safe(instr, block) {
-      if (instr->type != nir_instr_type_alu)
-         continue;
-
-      nir_alu_instr *alu = nir_instr_as_alu(instr);
-      if (!alu->dest.dest.is_ssa)
-         continue;
-
-      switch (alu->op) {
-      % for opcode in xform_dict.keys():
-      case nir_op_${opcode}:
-         for (unsigned i = 0; i < ARRAY_SIZE(${pass_name}_${opcode}_xforms); i++) {
-            const struct transform *xform = &${pass_name}_${opcode}_xforms[i];
-            if (condition_flags[xform->condition_offset] &&
-                nir_replace_instr(alu, xform->search, xform->replace,
-                                  mem_ctx)) {
-               progress = true;
-               break;
-            }
-         }
-         break;
-      % endfor
-      default:
-         break;
-      }
-   }
-
-   return progress;
-}
-
-static bool
-${pass_name}_impl(nir_function_impl *impl, const bool *condition_flags)
-{
-   void *mem_ctx = ralloc_parent(impl);
-   bool progress = false;
+static const struct transform *${pass_name}_state_xforms[] = {
+% for state_id, state_xforms in enumerate(automaton.state_xforms):
+% if state_xforms:
+   ${pass_name}_state${state_id}_xforms,
+% else:
+   NULL,
+% endif
+% endfor
+};
 
-   nir_foreach_block_reverse(block, impl) {
-      progress |= ${pass_name}_block(block, condition_flags, mem_ctx);
-   }
+static const uint16_t ${pass_name}_state_xform_counts[] = {
+% for i in range(0, len(automaton.state_xforms), 16):
+   ${', '.join(str(len(x)) for x in automaton.state_xforms[i:i + 16])},
+% endfor
+};
 
-   if (progress)
-      nir_metadata_preserve(impl, nir_metadata_block_index |
-                                  nir_metadata_dominance);
+% for op in automaton.opcodes:
+static const uint16_t ${pass_name}_${op}_filter[] = {
+% for i in range(0, len(automaton.filters[op]), 16):
+   ${', '.join(str(x) for x in automaton.filters[op][i:i + 16])},
+% endfor
+};
 
-   return progress;
-}
+static const uint16_t ${pass_name}_${op}_table[] = {
+% for i in range(0, len(automaton.tables[op]), 16):
+   ${', '.join(str(x) for x in automaton.tables[op][i:i + 16])},
+% endfor
+};
 
+% endfor
+static const struct per_op_table ${pass_name}_table[nir_num_opcodes] = {
+% for op in automaton.opcodes:
+   [nir_op_${op}] = {
+      ${pass_name}_${op}_filter,
+      ${pass_name}_${op}_table,
+      ${automaton.num_filtered[op]},
+   },
+% endfor
+};
 
 bool
 ${pass_name}(nir_shader *shader)
@@ -589,8 +692,12 @@ ${pass_name}(nir_shader *shader)
    % endfor
 
    nir_foreach_function(function, shader) {
-      if (function->impl)
-         progress |= ${pass_name}_impl(function->impl, condition_flags);
+      if (function->impl) {
+         progress |= nir_algebraic_impl(function->impl, condition_flags,
+                                        ${pass_name}_state_xforms,
+                                        ${pass_name}_state_xform_counts,
+                                        ${pass_name}_table);
+      }
    }
 
    return progress;
@@ -599,7 +706,7 @@ ${pass_name}(nir_shader *shader)
 
 class AlgebraicPass(object):
    def __init__(self, pass_name, transforms):
-      self.xform_dict = {}
+      self.xforms = []
       self.pass_name = pass_name
 
       error = False
@@ -616,15 +723,15 @@ class AlgebraicPass(object):
                error = True
                continue
 
-         if xform.search.opcode not in self.xform_dict:
-            self.xform_dict[xform.search.opcode] = []
-
-         self.xform_dict[xform.search.opcode].append(xform)
+         self.xforms.append(xform)
 
       if error:
          sys.exit(1)
 
+      self.automaton = TreeAutomaton(self.xforms)
+
    def render(self):
       return _algebraic_pass_template.render(pass_name=self.pass_name,
-                                             xform_dict=self.xform_dict,
+                                             xforms=self.xforms,
+                                             automaton=self.automaton,
                                              condition_list=condition_list)
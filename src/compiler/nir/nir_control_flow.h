@@ -141,6 +141,16 @@ void nir_cf_reinsert(nir_cf_list *cf_list, nir_cursor cursor);
 
 void nir_cf_delete(nir_cf_list *cf_list);
 
+/** clones a detached list of control flow nodes
+ *
+ * Instructions in \p src referencing SSA values, blocks or registers that
+ * are not part of the list keep referencing the originals.  If
+ * \p remap_table is not NULL, it is used to record the mapping from the old
+ * objects to their clones, and it may be pre-populated by the caller.
+ */
+void nir_cf_list_clone(nir_cf_list *dst, nir_cf_list *src, nir_cf_node *parent,
+                       struct hash_table *remap_table);
+
 static inline void
 nir_cf_list_extract(nir_cf_list *extracted, struct exec_list *cf_list)
 {
@@ -27,6 +27,7 @@
 
 #include "nir.h"
 #include "nir_vla.h"
+#include "util/pointer_hash_table.h"
 
 /*
  * This file implements an out-of-SSA pass as described in "Revisiting
@@ -38,7 +39,7 @@ struct from_ssa_state {
    void *mem_ctx;
    void *dead_ctx;
    bool phi_webs_only;
-   struct hash_table *merge_node_table;
+   struct pointer_hash_table *merge_node_table;
    nir_instr *instr;
    nir_function_impl *impl;
 };
@@ -119,8 +120,8 @@ merge_set_dump(merge_set *set, FILE *fp)
 static merge_node *
 get_merge_node(nir_ssa_def *def, struct from_ssa_state *state)
 {
-   struct hash_entry *entry =
-      _mesa_hash_table_search(state->merge_node_table, def);
+   struct pointer_hash_entry *entry =
+      _mesa_pointer_hash_table_search(state->merge_node_table, def);
    if (entry)
       return entry->data;
 
@@ -134,7 +135,7 @@ get_merge_node(nir_ssa_def *def, struct from_ssa_state *state)
    node->def = def;
    exec_list_push_head(&set->nodes, &node->node);
 
-   _mesa_hash_table_insert(state->merge_node_table, def, node);
+   _mesa_pointer_hash_table_insert(state->merge_node_table, def, node);
 
    return node;
 }
@@ -453,8 +454,8 @@ rewrite_ssa_def(nir_ssa_def *def, void *void_state)
    struct from_ssa_state *state = void_state;
    nir_register *reg;
 
-   struct hash_entry *entry =
-      _mesa_hash_table_search(state->merge_node_table, def);
+   struct pointer_hash_entry *entry =
+      _mesa_pointer_hash_table_search(state->merge_node_table, def);
    if (entry) {
       /* In this case, we're part of a phi web.  Use the web's register. */
       merge_node *node = (merge_node *)entry->data;
@@ -760,8 +761,7 @@ nir_convert_from_ssa_impl(nir_function_impl *impl, bool phi_webs_only)
    state.dead_ctx = ralloc_context(NULL);
    state.impl = impl;
    state.phi_webs_only = phi_webs_only;
-   state.merge_node_table = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
-                                                    _mesa_key_pointer_equal);
+   state.merge_node_table = _mesa_pointer_hash_table_create(NULL);
 
    nir_foreach_block(block, impl) {
       add_parallel_copy_to_end_of_block(block, state.dead_ctx);
@@ -798,7 +798,7 @@ nir_convert_from_ssa_impl(nir_function_impl *impl, bool phi_webs_only)
                                nir_metadata_dominance);
 
    /* Clean up dead instructions and the hash tables */
-   _mesa_hash_table_destroy(state.merge_node_table, NULL);
+   _mesa_pointer_hash_table_destroy(state.merge_node_table, NULL);
    ralloc_free(state.dead_ctx);
 }
 
@@ -0,0 +1,279 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nir_loop_analyze.h"
+#include "nir_constant_expressions.h"
+
+/* Returns the innermost loop containing the given control flow node */
+static nir_loop *
+get_enclosing_loop(nir_cf_node *node)
+{
+   for (nir_cf_node *cf = node->parent; cf != NULL; cf = cf->parent) {
+      if (cf->type == nir_cf_node_loop)
+         return nir_cf_node_as_loop(cf);
+   }
+
+   return NULL;
+}
+
+static void
+copy_const_component(nir_const_value *dst, const nir_load_const_instr *lc,
+                     unsigned comp)
+{
+   if (lc->def.bit_size == 64)
+      dst->u64[0] = lc->value.u64[comp];
+   else
+      dst->u32[0] = lc->value.u32[comp];
+}
+
+/* Returns the scalar SSA value read by an unmodified ALU source */
+static nir_ssa_def *
+get_scalar_ssa_src(nir_alu_instr *alu, unsigned src)
+{
+   nir_alu_src *asrc = &alu->src[src];
+
+   if (!asrc->src.is_ssa || asrc->abs || asrc->negate ||
+       asrc->src.ssa->num_components != 1)
+      return NULL;
+
+   return asrc->src.ssa;
+}
+
+/* Reads the first channel of an unmodified constant ALU source */
+static bool
+get_scalar_const_src(nir_alu_instr *alu, unsigned src, nir_const_value *value)
+{
+   nir_alu_src *asrc = &alu->src[src];
+
+   if (!asrc->src.is_ssa || asrc->abs || asrc->negate ||
+       asrc->src.ssa->parent_instr->type != nir_instr_type_load_const)
+      return false;
+
+   copy_const_component(value,
+                        nir_instr_as_load_const(asrc->src.ssa->parent_instr),
+                        asrc->swizzle[0]);
+   return true;
+}
+
+/* Matches a basic induction variable, i.e. a phi in the loop header of the
+ * form phi(init, phi + step) with init and step constant.
+ */
+static bool
+get_induction_variable(nir_loop *loop, nir_phi_instr *phi,
+                       nir_alu_instr **update,
+                       nir_const_value *init, nir_const_value *step)
+{
+   nir_block *preheader =
+      nir_cf_node_as_block(nir_cf_node_prev(&loop->cf_node));
+
+   if (phi->instr.block != nir_loop_first_block(loop) ||
+       !phi->dest.is_ssa || phi->dest.ssa.num_components != 1 ||
+       exec_list_length(&phi->srcs) != 2)
+      return false;
+
+   bool found_init = false;
+   nir_alu_instr *alu = NULL;
+
+   nir_foreach_phi_src(src, phi) {
+      if (!src->src.is_ssa)
+         return false;
+
+      nir_instr *instr = src->src.ssa->parent_instr;
+      if (src->pred == preheader) {
+         if (instr->type != nir_instr_type_load_const)
+            return false;
+
+         copy_const_component(init, nir_instr_as_load_const(instr), 0);
+         found_init = true;
+      } else {
+         if (instr->type != nir_instr_type_alu)
+            return false;
+
+         alu = nir_instr_as_alu(instr);
+      }
+   }
+
+   if (!found_init || alu == NULL || alu->dest.saturate ||
+       (alu->op != nir_op_iadd && alu->op != nir_op_fadd))
+      return false;
+
+   for (unsigned i = 0; i < 2; i++) {
+      if (get_scalar_ssa_src(alu, i) == &phi->dest.ssa &&
+          get_scalar_const_src(alu, 1 - i, step)) {
+         *update = alu;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+static bool
+find_terminator(nir_loop *loop, nir_loop_info *info)
+{
+   nir_block *break_block = NULL;
+   bool simple = true;
+
+   nir_foreach_block_in_cf_node(block, &loop->cf_node) {
+      info->num_instructions += exec_list_length(&block->instr_list);
+
+      if (get_enclosing_loop(&block->cf_node) != loop) {
+         info->has_nested_loop = true;
+         continue;
+      }
+
+      nir_instr *last = nir_block_last_instr(block);
+      if (last == NULL || last->type != nir_instr_type_jump)
+         continue;
+
+      /* Only a single break is supported; continues and returns make the
+       * control flow too complicated to reason about here.
+       */
+      if (nir_instr_as_jump(last)->type != nir_jump_break || break_block)
+         simple = false;
+
+      break_block = block;
+   }
+
+   if (!simple || break_block == NULL)
+      return false;
+
+   nir_cf_node *parent = break_block->cf_node.parent;
+   if (parent->type != nir_cf_node_if || parent->parent != &loop->cf_node)
+      return false;
+
+   nir_if *nif = nir_cf_node_as_if(parent);
+   if (break_block == nir_if_first_then_block(nif) &&
+       break_block == nir_if_last_then_block(nif)) {
+      info->terminator.break_in_then = true;
+   } else if (break_block == nir_if_first_else_block(nif) &&
+              break_block == nir_if_last_else_block(nif)) {
+      info->terminator.break_in_then = false;
+   } else {
+      return false;
+   }
+
+   info->terminator.nif = nif;
+   info->terminator.break_block = break_block;
+   return true;
+}
+
+static void
+compute_trip_count(nir_loop *loop, unsigned max_trip_count,
+                   nir_loop_info *info)
+{
+   nir_if *nif = info->terminator.nif;
+
+   if (!nif->condition.is_ssa ||
+       nif->condition.ssa->parent_instr->type != nir_instr_type_alu)
+      return;
+
+   nir_alu_instr *cond = nir_instr_as_alu(nif->condition.ssa->parent_instr);
+   switch (cond->op) {
+   case nir_op_flt:
+   case nir_op_fge:
+   case nir_op_feq:
+   case nir_op_fne:
+   case nir_op_ilt:
+   case nir_op_ige:
+   case nir_op_ieq:
+   case nir_op_ine:
+   case nir_op_ult:
+   case nir_op_uge:
+      break;
+   default:
+      return;
+   }
+
+   for (unsigned i = 0; i < 2; i++) {
+      nir_const_value limit;
+      nir_ssa_def *def = get_scalar_ssa_src(cond, i);
+      if (def == NULL || !get_scalar_const_src(cond, 1 - i, &limit))
+         continue;
+
+      /* The condition may test either the induction variable itself or its
+       * updated value for the next iteration.
+       */
+      nir_phi_instr *phi = NULL;
+      bool tests_update = false;
+      if (def->parent_instr->type == nir_instr_type_phi) {
+         phi = nir_instr_as_phi(def->parent_instr);
+      } else if (def->parent_instr->type == nir_instr_type_alu) {
+         nir_alu_instr *alu = nir_instr_as_alu(def->parent_instr);
+         for (unsigned j = 0; j < nir_op_infos[alu->op].num_inputs; j++) {
+            nir_ssa_def *src = get_scalar_ssa_src(alu, j);
+            if (src && src->parent_instr->type == nir_instr_type_phi) {
+               phi = nir_instr_as_phi(src->parent_instr);
+               break;
+            }
+         }
+         tests_update = true;
+      }
+
+      nir_alu_instr *update;
+      nir_const_value init, step;
+      if (phi == NULL ||
+          !get_induction_variable(loop, phi, &update, &init, &step) ||
+          (tests_update && &update->dest.dest.ssa != def))
+         continue;
+
+      /* Step through the iterations until the break is taken. */
+      const unsigned bit_size = def->bit_size;
+      nir_const_value srcs[2];
+      nir_const_value value = init;
+      if (tests_update) {
+         srcs[0] = value;
+         srcs[1] = step;
+         value = nir_eval_const_opcode(update->op, 1, bit_size, srcs);
+      }
+
+      for (unsigned k = 0; k <= max_trip_count; k++) {
+         srcs[i] = value;
+         srcs[1 - i] = limit;
+         nir_const_value res =
+            nir_eval_const_opcode(cond->op, 1, bit_size, srcs);
+
+         if ((res.u32[0] != 0) == info->terminator.break_in_then) {
+            info->has_trip_count = true;
+            info->trip_count = k;
+            return;
+         }
+
+         srcs[0] = value;
+         srcs[1] = step;
+         value = nir_eval_const_opcode(update->op, 1, bit_size, srcs);
+      }
+
+      return;
+   }
+}
+
+void
+nir_loop_analyze(nir_loop *loop, unsigned max_trip_count, nir_loop_info *info)
+{
+   memset(info, 0, sizeof(*info));
+
+   info->has_terminator = find_terminator(loop, info);
+   if (info->has_terminator)
+      compute_trip_count(loop, max_trip_count, info);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "nir.h"
+
+/** Simple loop analysis for NIR
+ *
+ * This looks for loops of the form
+ *
+ *    loop {
+ *       i = phi(init, i_next)
+ *       ...
+ *       if (i cmp limit)
+ *          break;
+ *       ...
+ *       i_next = i + step
+ *    }
+ *
+ * where init, step and limit are constants, and computes the number of
+ * times the loop body runs to completion before the break is taken.
+ */
+
+typedef struct {
+   /** The if-statement at the top level of the loop body holding the break */
+   nir_if *nif;
+
+   /** The single block of the branch that ends in the break */
+   nir_block *break_block;
+
+   /** True if the break is in the then-branch of \c nif */
+   bool break_in_then;
+} nir_loop_terminator;
+
+typedef struct {
+   /** Number of instructions in the loop body, including nested control flow */
+   unsigned num_instructions;
+
+   /** True if the loop contains another loop */
+   bool has_nested_loop;
+
+   /**
+    * True if the loop has a single terminator we understand and no other
+    * break or continue statements.  If false, nothing else below is valid.
+    */
+   bool has_terminator;
+
+   nir_loop_terminator terminator;
+
+   /**
+    * True if the induction variable feeding the terminator could be
+    * evaluated and the break is taken within the requested number of
+    * iterations.
+    */
+   bool has_trip_count;
+
+   /**
+    * Number of iterations which run past the terminator.  The code before
+    * the terminator runs one more time than this, in the iteration where
+    * the break is taken.
+    */
+   unsigned trip_count;
+} nir_loop_info;
+
+void nir_loop_analyze(nir_loop *loop, unsigned max_trip_count,
+                      nir_loop_info *info);
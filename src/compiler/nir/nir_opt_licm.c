@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nir.h"
+
+/*
+ * Implements loop-invariant code motion.
+ *
+ * An instruction is loop-invariant if all of its sources are defined
+ * outside the loop, either originally or because the instruction defining
+ * them has already been hoisted.  Such instructions are moved to the end of
+ * the block preceding the loop, so they run once instead of once per
+ * iteration.  Running nir_opt_cse afterwards then merges the hoisted copies
+ * of values computed in several loops or both before and inside a loop.
+ *
+ * ALU instructions can be hoisted from anywhere in the loop since
+ * executing them speculatively has no side effects.  Reorderable loads,
+ * such as UBO and push constant loads, are only hoisted from blocks at the
+ * top level of the loop body which don't sit under any if.
+ *
+ * Inner loops are processed first so that what is hoisted out of them can
+ * be hoisted further out of the loops containing them.
+ */
+
+struct licm_state {
+   /* Block indices spanned by the loop being processed */
+   unsigned first_block_index, last_block_index;
+};
+
+static bool
+src_is_invariant(nir_src *src, void *void_state)
+{
+   struct licm_state *state = void_state;
+
+   if (!src->is_ssa)
+      return false;
+
+   unsigned index = src->ssa->parent_instr->block->index;
+   return index < state->first_block_index || index > state->last_block_index;
+}
+
+static bool
+instr_can_hoist(nir_instr *instr, bool top_level)
+{
+   switch (instr->type) {
+   case nir_instr_type_alu:
+      return nir_instr_as_alu(instr)->dest.dest.is_ssa;
+
+   case nir_instr_type_load_const:
+   case nir_instr_type_ssa_undef:
+      return true;
+
+   case nir_instr_type_intrinsic: {
+      nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
+      const nir_intrinsic_info *info = &nir_intrinsic_infos[intrin->intrinsic];
+
+      return top_level &&
+             (info->flags & NIR_INTRINSIC_CAN_ELIMINATE) &&
+             (info->flags & NIR_INTRINSIC_CAN_REORDER) &&
+             info->has_dest && info->num_variables == 0 &&
+             intrin->dest.is_ssa;
+   }
+
+   default:
+      return false;
+   }
+}
+
+static bool
+licm_cf_list(struct exec_list *cf_list);
+
+static bool
+licm_loop(nir_loop *loop)
+{
+   bool progress = licm_cf_list(&loop->body);
+
+   struct licm_state state;
+   state.first_block_index = nir_loop_first_block(loop)->index;
+   state.last_block_index = nir_loop_last_block(loop)->index;
+
+   nir_block *preheader =
+      nir_cf_node_as_block(nir_cf_node_prev(&loop->cf_node));
+
+   nir_foreach_block_in_cf_node(block, &loop->cf_node) {
+      const bool top_level = block->cf_node.parent == &loop->cf_node;
+
+      nir_foreach_instr_safe(instr, block) {
+         if (!instr_can_hoist(instr, top_level) ||
+             !nir_foreach_src(instr, src_is_invariant, &state))
+            continue;
+
+         nir_instr_remove(instr);
+         nir_instr_insert(nir_after_block_before_jump(preheader), instr);
+         progress = true;
+      }
+   }
+
+   return progress;
+}
+
+static bool
+licm_cf_list(struct exec_list *cf_list)
+{
+   bool progress = false;
+
+   foreach_list_typed(nir_cf_node, node, node, cf_list) {
+      switch (node->type) {
+      case nir_cf_node_block:
+         break;
+
+      case nir_cf_node_if: {
+         nir_if *nif = nir_cf_node_as_if(node);
+         progress |= licm_cf_list(&nif->then_list);
+         progress |= licm_cf_list(&nif->else_list);
+         break;
+      }
+
+      case nir_cf_node_loop:
+         progress |= licm_loop(nir_cf_node_as_loop(node));
+         break;
+
+      default:
+         unreachable("Invalid CF node type");
+      }
+   }
+
+   return progress;
+}
+
+static bool
+nir_opt_licm_impl(nir_function_impl *impl)
+{
+   nir_metadata_require(impl, nir_metadata_block_index);
+
+   bool progress = licm_cf_list(&impl->body);
+
+   if (progress) {
+      nir_metadata_preserve(impl, nir_metadata_block_index |
+                                  nir_metadata_dominance);
+   }
+
+   return progress;
+}
+
+bool
+nir_opt_licm(nir_shader *shader)
+{
+   bool progress = false;
+
+   nir_foreach_function(function, shader) {
+      if (function->impl)
+         progress |= nir_opt_licm_impl(function->impl);
+   }
+
+   return progress;
+}
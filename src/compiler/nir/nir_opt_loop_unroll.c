@@ -0,0 +1,340 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nir.h"
+#include "nir_builder.h"
+#include "nir_control_flow.h"
+#include "nir_loop_analyze.h"
+
+/*
+ * This pass fully unrolls loops whose trip count can be determined at
+ * compile time by nir_loop_analyze().  Given a loop of the form
+ *
+ *    loop {
+ *       pre;
+ *       if (cond) {
+ *          brk;
+ *          break;
+ *       }
+ *       post;
+ *    }
+ *
+ * which runs to completion N times, the loop is replaced with N copies of
+ * pre and post followed by a final copy of pre and the contents of the
+ * break branch.
+ *
+ * To keep the cloning simple, the phis at the top of the loop and right
+ * after it are lowered to registers beforehand, as are any SSA values
+ * defined in the loop and used after it.  The function is put back into
+ * SSA form once we are done.
+ */
+
+/* Instruction budget for the unrolled loop, per allowed iteration */
+#define LOOP_UNROLL_INSTRS_PER_ITERATION 16
+
+static bool
+is_cf_node_inside_loop(nir_loop *loop, nir_cf_node *node)
+{
+   for (nir_cf_node *cf = node->parent; cf != NULL; cf = cf->parent) {
+      if (cf == &loop->cf_node)
+         return true;
+   }
+
+   return false;
+}
+
+static bool
+is_src_inside_loop(nir_loop *loop, nir_src *src, bool if_use)
+{
+   if (if_use)
+      return is_cf_node_inside_loop(loop, &src->parent_if->cf_node);
+   else
+      return is_cf_node_inside_loop(loop, &src->parent_instr->block->cf_node);
+}
+
+static void
+write_reg(nir_builder *b, nir_register *reg, nir_ssa_def *def)
+{
+   nir_alu_instr *mov = nir_alu_instr_create(b->shader, nir_op_imov);
+   mov->src[0].src = nir_src_for_ssa(def);
+   mov->dest.dest = nir_dest_for_reg(reg);
+   mov->dest.write_mask = (1 << reg->num_components) - 1;
+   nir_builder_instr_insert(b, &mov->instr);
+}
+
+static nir_register *
+create_reg_for_ssa_def(nir_builder *b, nir_ssa_def *def)
+{
+   nir_register *reg = nir_local_reg_create(b->impl);
+   reg->num_components = def->num_components;
+   reg->bit_size = def->bit_size;
+   return reg;
+}
+
+/* Replaces a phi with writes to a register at the end of each predecessor
+ * and a single read from it at the top of the phi's block.
+ */
+static void
+lower_phi_to_reg(nir_builder *b, nir_phi_instr *phi)
+{
+   assert(phi->dest.is_ssa);
+   nir_register *reg = create_reg_for_ssa_def(b, &phi->dest.ssa);
+
+   nir_foreach_phi_src(src, phi) {
+      assert(src->src.is_ssa);
+      b->cursor = nir_after_block_before_jump(src->pred);
+      write_reg(b, reg, src->src.ssa);
+   }
+
+   b->cursor = nir_after_phis(phi->instr.block);
+   nir_ssa_def *def =
+      nir_ssa_for_src(b, nir_src_for_reg(reg), reg->num_components);
+
+   nir_ssa_def_rewrite_uses(&phi->dest.ssa, nir_src_for_ssa(def));
+   nir_instr_remove(&phi->instr);
+}
+
+static void
+lower_phis_to_regs(nir_builder *b, nir_block *block)
+{
+   nir_foreach_instr_safe(instr, block) {
+      if (instr->type != nir_instr_type_phi)
+         break;
+
+      lower_phi_to_reg(b, nir_instr_as_phi(instr));
+   }
+}
+
+struct live_out_state {
+   nir_builder *b;
+   nir_loop *loop;
+};
+
+/* Routes the uses of an SSA value after the loop through a register so
+ * they do not need to know which copy of the loop body defined it.
+ */
+static bool
+lower_live_out_def(nir_ssa_def *def, void *void_state)
+{
+   struct live_out_state *state = void_state;
+   nir_builder *b = state->b;
+   bool live_out = false;
+
+   nir_foreach_use(use, def)
+      live_out |= !is_src_inside_loop(state->loop, use, false);
+   nir_foreach_if_use(use, def)
+      live_out |= !is_src_inside_loop(state->loop, use, true);
+
+   if (!live_out)
+      return true;
+
+   nir_register *reg = create_reg_for_ssa_def(b, def);
+
+   if (def->parent_instr->type == nir_instr_type_phi)
+      b->cursor = nir_after_phis(def->parent_instr->block);
+   else
+      b->cursor = nir_after_instr(def->parent_instr);
+   write_reg(b, reg, def);
+
+   b->cursor = nir_after_cf_node_and_phis(&state->loop->cf_node);
+   nir_ssa_def *new_def =
+      nir_ssa_for_src(b, nir_src_for_reg(reg), reg->num_components);
+
+   nir_foreach_use_safe(use, def) {
+      if (!is_src_inside_loop(state->loop, use, false))
+         nir_instr_rewrite_src(use->parent_instr, use,
+                               nir_src_for_ssa(new_def));
+   }
+
+   nir_foreach_if_use_safe(use, def) {
+      if (!is_src_inside_loop(state->loop, use, true))
+         nir_if_rewrite_condition(use->parent_if, nir_src_for_ssa(new_def));
+   }
+
+   return true;
+}
+
+static void
+loop_prepare_for_unroll(nir_builder *b, nir_loop *loop)
+{
+   lower_phis_to_regs(b, nir_loop_first_block(loop));
+   lower_phis_to_regs(b, nir_cf_node_as_block(nir_cf_node_next(&loop->cf_node)));
+
+   struct live_out_state state = { b, loop };
+   nir_foreach_block_in_cf_node(block, &loop->cf_node) {
+      nir_foreach_instr_safe(instr, block)
+         nir_foreach_ssa_def(instr, lower_live_out_def, &state);
+   }
+}
+
+static void
+simple_unroll(nir_function_impl *impl, nir_loop *loop, nir_loop_info *info)
+{
+   nir_builder b;
+   nir_builder_init(&b, impl);
+
+   loop_prepare_for_unroll(&b, loop);
+
+   nir_if *nif = info->terminator.nif;
+   struct exec_list *break_list, *continue_list;
+   if (info->terminator.break_in_then) {
+      break_list = &nif->then_list;
+      continue_list = &nif->else_list;
+   } else {
+      break_list = &nif->else_list;
+      continue_list = &nif->then_list;
+   }
+
+   /* The branch without the break only runs when the loop continues, so
+    * its contents can just as well go after the if.
+    */
+   nir_cf_list continue_branch;
+   nir_cf_list_extract(&continue_branch, continue_list);
+   nir_cf_reinsert(&continue_branch, nir_after_cf_node(&nif->cf_node));
+
+   /* Drop the break itself and pull out whatever runs before it. */
+   nir_instr_remove(nir_block_last_instr(info->terminator.break_block));
+
+   nir_cf_list brk, pre, post;
+   nir_cf_list_extract(&brk, break_list);
+   nir_cf_extract(&pre, nir_before_cf_list(&loop->body),
+                  nir_before_cf_node(&nif->cf_node));
+   nir_cf_extract(&post, nir_after_cf_node(&nif->cf_node),
+                  nir_after_cf_list(&loop->body));
+
+   for (unsigned i = 0; i < info->trip_count; i++) {
+      struct hash_table *remap_table =
+         _mesa_hash_table_create(NULL, _mesa_hash_pointer,
+                                 _mesa_key_pointer_equal);
+
+      nir_cf_list pre_clone, post_clone;
+      nir_cf_list_clone(&pre_clone, &pre, loop->cf_node.parent, remap_table);
+      nir_cf_list_clone(&post_clone, &post, loop->cf_node.parent, remap_table);
+
+      nir_cf_reinsert(&pre_clone, nir_before_cf_node(&loop->cf_node));
+      nir_cf_reinsert(&post_clone, nir_before_cf_node(&loop->cf_node));
+
+      _mesa_hash_table_destroy(remap_table, NULL);
+   }
+
+   /* The last iteration runs up to the break */
+   nir_cf_reinsert(&pre, nir_before_cf_node(&loop->cf_node));
+   nir_cf_reinsert(&brk, nir_before_cf_node(&loop->cf_node));
+
+   nir_cf_delete(&post);
+   nir_cf_node_remove(&loop->cf_node);
+}
+
+static bool
+process_cf_list(nir_function_impl *impl, struct exec_list *cf_list,
+                unsigned max_iterations);
+
+static bool
+process_loop(nir_function_impl *impl, nir_loop *loop,
+             unsigned max_iterations)
+{
+   /* Unroll inner loops first.  If one of them changed, the analysis of
+    * this loop has to wait until the shader is back in SSA form.
+    */
+   if (process_cf_list(impl, &loop->body, max_iterations))
+      return true;
+
+   nir_loop_info info;
+   nir_loop_analyze(loop, max_iterations, &info);
+
+   if (!info.has_trip_count || info.has_nested_loop)
+      return false;
+
+   if (info.num_instructions * (info.trip_count + 1) >
+       max_iterations * LOOP_UNROLL_INSTRS_PER_ITERATION)
+      return false;
+
+   simple_unroll(impl, loop, &info);
+   return true;
+}
+
+static bool
+process_cf_list(nir_function_impl *impl, struct exec_list *cf_list,
+                unsigned max_iterations)
+{
+   bool progress = false;
+
+   foreach_list_typed(nir_cf_node, node, node, cf_list) {
+      switch (node->type) {
+      case nir_cf_node_block:
+         break;
+
+      case nir_cf_node_if: {
+         nir_if *nif = nir_cf_node_as_if(node);
+         progress |= process_cf_list(impl, &nif->then_list, max_iterations);
+         progress |= process_cf_list(impl, &nif->else_list, max_iterations);
+         break;
+      }
+
+      case nir_cf_node_loop:
+         /* Unrolling rewrites the surrounding list, so stop walking it.
+          * Anything left over is picked up the next time the pass runs.
+          */
+         if (process_loop(impl, nir_cf_node_as_loop(node), max_iterations))
+            return true;
+         break;
+
+      default:
+         unreachable("Invalid CF node type");
+      }
+   }
+
+   return progress;
+}
+
+static bool
+nir_opt_loop_unroll_impl(nir_function_impl *impl, unsigned max_iterations)
+{
+   bool progress = process_cf_list(impl, &impl->body, max_iterations);
+
+   if (progress) {
+      nir_metadata_preserve(impl, nir_metadata_none);
+      nir_convert_to_ssa_impl(impl);
+   }
+
+   return progress;
+}
+
+bool
+nir_opt_loop_unroll(nir_shader *shader)
+{
+   bool progress = false;
+   const unsigned max_iterations = shader->options->max_unroll_iterations;
+
+   if (max_iterations == 0)
+      return false;
+
+   nir_foreach_function(function, shader) {
+      if (function->impl) {
+         progress |= nir_opt_loop_unroll_impl(function->impl,
+                                              max_iterations);
+      }
+   }
+
+   return progress;
+}
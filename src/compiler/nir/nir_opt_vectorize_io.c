@@ -0,0 +1,462 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nir.h"
+#include "nir_builder.h"
+
+/*
+ * Merges adjacent scalar or narrow memory and input accesses within a block
+ * into wider ones, so that backends issue fewer messages:
+ *
+ *  - load_ubo and load_ssbo from the same buffer at consecutive offsets
+ *  - store_ssbo to the same buffer at consecutive offsets
+ *  - load_input, load_per_vertex_input and load_interpolated_input of
+ *    consecutive components of the same slot
+ *
+ * Offsets are compared as either two constants or the same SSA value plus
+ * two different constants.  Only 32-bit accesses of up to four components
+ * in total are merged.  Constant UBO offsets are not merged across a
+ * 16-byte boundary, where the wider load would have to be split again.
+ *
+ * A merged load takes the place of the earlier load and a merged store
+ * the place of the later store.  Moving the other access there must not
+ * reorder it with anything that may touch the same memory, so the search
+ * for a partner stops at such instructions.
+ */
+
+/* How far back in a block to look for an access to merge with */
+#define SEARCH_WINDOW 64
+
+struct io_offset {
+   nir_ssa_def *base;
+   unsigned base_comp;
+   uint32_t constant;
+};
+
+static bool
+get_scalar_alu_const(nir_alu_src *src, uint32_t *value)
+{
+   if (!src->src.is_ssa || src->abs || src->negate ||
+       src->src.ssa->parent_instr->type != nir_instr_type_load_const)
+      return false;
+
+   nir_load_const_instr *lc =
+      nir_instr_as_load_const(src->src.ssa->parent_instr);
+   *value = lc->value.u32[src->swizzle[0]];
+   return true;
+}
+
+static bool
+parse_offset(nir_src *src, struct io_offset *offset)
+{
+   if (!src->is_ssa || src->ssa->bit_size != 32)
+      return false;
+
+   nir_const_value *const_val = nir_src_as_const_value(*src);
+   if (const_val) {
+      offset->base = NULL;
+      offset->base_comp = 0;
+      offset->constant = const_val->u32[0];
+      return true;
+   }
+
+   nir_instr *parent = src->ssa->parent_instr;
+   if (parent->type == nir_instr_type_alu) {
+      nir_alu_instr *alu = nir_instr_as_alu(parent);
+      if (alu->op == nir_op_iadd && !alu->dest.saturate) {
+         for (unsigned i = 0; i < 2; i++) {
+            nir_alu_src *base = &alu->src[1 - i];
+            if (get_scalar_alu_const(&alu->src[i], &offset->constant) &&
+                base->src.is_ssa && !base->abs && !base->negate) {
+               offset->base = base->src.ssa;
+               offset->base_comp = base->swizzle[0];
+               return true;
+            }
+         }
+      }
+   }
+
+   offset->base = src->ssa;
+   offset->base_comp = 0;
+   offset->constant = 0;
+   return true;
+}
+
+static bool
+same_offset_base(const struct io_offset *a, const struct io_offset *b)
+{
+   return a->base == b->base && a->base_comp == b->base_comp;
+}
+
+static bool
+srcs_equal(nir_src a, nir_src b)
+{
+   if (nir_srcs_equal(a, b))
+      return true;
+
+   nir_const_value *ca = nir_src_as_const_value(a);
+   nir_const_value *cb = nir_src_as_const_value(b);
+   return ca && cb && ca->u32[0] == cb->u32[0];
+}
+
+static nir_ssa_def *
+build_offset(nir_builder *b, const struct io_offset *offset)
+{
+   if (offset->base == NULL)
+      return nir_imm_int(b, offset->constant);
+
+   nir_ssa_def *base = offset->base;
+   if (base->num_components > 1)
+      base = nir_channel(b, base, offset->base_comp);
+
+   if (offset->constant == 0)
+      return base;
+
+   return nir_iadd(b, base, nir_imm_int(b, offset->constant));
+}
+
+/* Returns true if def is available right before instr */
+static bool
+def_available_before(nir_ssa_def *def, nir_instr *instr)
+{
+   if (def == NULL || def->parent_instr->block != instr->block)
+      return true;
+
+   for (nir_instr *prev = nir_instr_prev(instr); prev != NULL;
+        prev = nir_instr_prev(prev)) {
+      if (prev == def->parent_instr)
+         return true;
+   }
+
+   return false;
+}
+
+/* Orders two accesses by offset.  Returns false if b doesn't start right
+ * where a ends or the other way around.
+ */
+static bool
+order_by_offset(nir_intrinsic_instr **lo, struct io_offset *lo_offset,
+                nir_intrinsic_instr **hi, struct io_offset *hi_offset,
+                unsigned offset_src)
+{
+   if (!parse_offset(&(*lo)->src[offset_src], lo_offset) ||
+       !parse_offset(&(*hi)->src[offset_src], hi_offset) ||
+       !same_offset_base(lo_offset, hi_offset))
+      return false;
+
+   if (lo_offset->constant > hi_offset->constant) {
+      nir_intrinsic_instr *tmp = *lo;
+      *lo = *hi;
+      *hi = tmp;
+
+      struct io_offset tmp_offset = *lo_offset;
+      *lo_offset = *hi_offset;
+      *hi_offset = tmp_offset;
+   }
+
+   return lo_offset->constant + (*lo)->num_components * 4 ==
+          hi_offset->constant;
+}
+
+static unsigned
+access_bit_size(nir_intrinsic_instr *intrin)
+{
+   if (intrin->intrinsic == nir_intrinsic_store_ssbo)
+      return intrin->src[0].is_ssa ? intrin->src[0].ssa->bit_size : 0;
+   else
+      return intrin->dest.is_ssa ? intrin->dest.ssa.bit_size : 0;
+}
+
+/* Replaces the uses of two loads with the matching channels of a new one. */
+static void
+rewrite_load_uses(nir_builder *b, nir_intrinsic_instr *load,
+                  nir_intrinsic_instr *lo, nir_intrinsic_instr *hi)
+{
+   b->cursor = nir_after_instr(&load->instr);
+
+   const unsigned lo_mask = (1 << lo->num_components) - 1;
+   const unsigned hi_mask = ((1 << hi->num_components) - 1) <<
+                            lo->num_components;
+
+   nir_ssa_def_rewrite_uses(&lo->dest.ssa,
+      nir_src_for_ssa(nir_channels(b, &load->dest.ssa, lo_mask)));
+   nir_ssa_def_rewrite_uses(&hi->dest.ssa,
+      nir_src_for_ssa(nir_channels(b, &load->dest.ssa, hi_mask)));
+
+   nir_instr_remove(&lo->instr);
+   nir_instr_remove(&hi->instr);
+}
+
+static bool
+try_merge_buffer_loads(nir_builder *b, nir_intrinsic_instr *first,
+                       nir_intrinsic_instr *second)
+{
+   if (!srcs_equal(first->src[0], second->src[0]))
+      return false;
+
+   nir_intrinsic_instr *lo = first, *hi = second;
+   struct io_offset lo_offset, hi_offset;
+   if (!order_by_offset(&lo, &lo_offset, &hi, &hi_offset, 1))
+      return false;
+
+   const unsigned num_components = lo->num_components + hi->num_components;
+   if (first->intrinsic == nir_intrinsic_load_ubo && lo_offset.base == NULL &&
+       lo_offset.constant / 16 !=
+       (lo_offset.constant + num_components * 4 - 1) / 16)
+      return false;
+
+   /* The merged load goes where the first one was. */
+   if (!def_available_before(lo_offset.base, &first->instr))
+      return false;
+
+   b->cursor = nir_before_instr(&first->instr);
+   nir_intrinsic_instr *load =
+      nir_intrinsic_instr_create(b->shader, first->intrinsic);
+   load->num_components = num_components;
+   load->src[0] = nir_src_for_ssa(first->src[0].ssa);
+   load->src[1] = nir_src_for_ssa(build_offset(b, &lo_offset));
+   nir_ssa_dest_init(&load->instr, &load->dest, num_components, 32, NULL);
+   nir_builder_instr_insert(b, &load->instr);
+
+   rewrite_load_uses(b, load, lo, hi);
+   return true;
+}
+
+static bool
+try_merge_input_loads(nir_builder *b, nir_intrinsic_instr *first,
+                      nir_intrinsic_instr *second)
+{
+   if (nir_intrinsic_base(first) != nir_intrinsic_base(second))
+      return false;
+
+   const unsigned num_srcs = nir_intrinsic_infos[first->intrinsic].num_srcs;
+   for (unsigned i = 0; i < num_srcs; i++) {
+      if (!srcs_equal(first->src[i], second->src[i]))
+         return false;
+   }
+
+   nir_intrinsic_instr *lo = first, *hi = second;
+   if (nir_intrinsic_component(lo) > nir_intrinsic_component(hi)) {
+      lo = second;
+      hi = first;
+   }
+
+   if (nir_intrinsic_component(lo) + lo->num_components !=
+       nir_intrinsic_component(hi))
+      return false;
+
+   const unsigned num_components = lo->num_components + hi->num_components;
+
+   nir_intrinsic_instr *load =
+      nir_intrinsic_instr_create(b->shader, first->intrinsic);
+   load->num_components = num_components;
+   for (unsigned i = 0; i < num_srcs; i++)
+      load->src[i] = nir_src_for_ssa(first->src[i].ssa);
+   nir_intrinsic_set_base(load, nir_intrinsic_base(first));
+   nir_intrinsic_set_component(load, nir_intrinsic_component(lo));
+   nir_ssa_dest_init(&load->instr, &load->dest, num_components, 32, NULL);
+   nir_instr_insert_before(&first->instr, &load->instr);
+
+   rewrite_load_uses(b, load, lo, hi);
+   return true;
+}
+
+static bool
+try_merge_stores(nir_builder *b, nir_intrinsic_instr *first,
+                 nir_intrinsic_instr *second)
+{
+   if (!srcs_equal(first->src[1], second->src[1]) ||
+       nir_intrinsic_write_mask(first) != (1u << first->num_components) - 1 ||
+       nir_intrinsic_write_mask(second) != (1u << second->num_components) - 1)
+      return false;
+
+   nir_intrinsic_instr *lo = first, *hi = second;
+   struct io_offset lo_offset, hi_offset;
+   if (!order_by_offset(&lo, &lo_offset, &hi, &hi_offset, 2))
+      return false;
+
+   /* The merged store goes where the second one was.  All of the sources
+    * of both stores are available there.
+    */
+   b->cursor = nir_before_instr(&second->instr);
+
+   nir_ssa_def *comps[4];
+   unsigned num_components = 0;
+   for (unsigned i = 0; i < lo->num_components; i++)
+      comps[num_components++] = nir_channel(b, lo->src[0].ssa, i);
+   for (unsigned i = 0; i < hi->num_components; i++)
+      comps[num_components++] = nir_channel(b, hi->src[0].ssa, i);
+
+   nir_intrinsic_instr *store =
+      nir_intrinsic_instr_create(b->shader, nir_intrinsic_store_ssbo);
+   store->num_components = num_components;
+   store->src[0] = nir_src_for_ssa(nir_vec(b, comps, num_components));
+   store->src[1] = nir_src_for_ssa(first->src[1].ssa);
+   store->src[2] = nir_src_for_ssa(build_offset(b, &lo_offset));
+   nir_intrinsic_set_write_mask(store, (1 << num_components) - 1);
+   nir_builder_instr_insert(b, &store->instr);
+
+   nir_instr_remove(&first->instr);
+   nir_instr_remove(&second->instr);
+   return true;
+}
+
+static bool
+is_input_load(nir_intrinsic_op op)
+{
+   return op == nir_intrinsic_load_input ||
+          op == nir_intrinsic_load_per_vertex_input ||
+          op == nir_intrinsic_load_interpolated_input;
+}
+
+static bool
+is_mergeable(nir_intrinsic_instr *intrin)
+{
+   switch (intrin->intrinsic) {
+   case nir_intrinsic_load_ubo:
+   case nir_intrinsic_load_ssbo:
+   case nir_intrinsic_store_ssbo:
+      break;
+   default:
+      if (!is_input_load(intrin->intrinsic))
+         return false;
+   }
+
+   if (intrin->intrinsic == nir_intrinsic_store_ssbo) {
+      if (!intrin->src[0].is_ssa || !intrin->src[1].is_ssa)
+         return false;
+   } else {
+      for (unsigned i = 0; i < nir_intrinsic_infos[intrin->intrinsic].num_srcs; i++) {
+         if (!intrin->src[i].is_ssa)
+            return false;
+      }
+   }
+
+   return access_bit_size(intrin) == 32;
+}
+
+/* Returns true if the access can't be moved across instr */
+static bool
+is_barrier_for(nir_intrinsic_instr *access, nir_instr *instr)
+{
+   if (instr->type == nir_instr_type_call)
+      return true;
+
+   if (instr->type != nir_instr_type_intrinsic)
+      return false;
+
+   const unsigned flags =
+      nir_intrinsic_infos[nir_instr_as_intrinsic(instr)->intrinsic].flags;
+
+   switch (access->intrinsic) {
+   case nir_intrinsic_load_ssbo:
+      /* Anything that may write memory */
+      return !(flags & NIR_INTRINSIC_CAN_ELIMINATE);
+   case nir_intrinsic_store_ssbo:
+      /* Anything that may read or write memory */
+      return !(flags & NIR_INTRINSIC_CAN_REORDER);
+   default:
+      return false;
+   }
+}
+
+static bool
+try_merge(nir_builder *b, nir_intrinsic_instr *first,
+          nir_intrinsic_instr *second)
+{
+   if (first->intrinsic != second->intrinsic || !is_mergeable(first) ||
+       first->num_components + second->num_components > 4)
+      return false;
+
+   switch (second->intrinsic) {
+   case nir_intrinsic_load_ubo:
+   case nir_intrinsic_load_ssbo:
+      return try_merge_buffer_loads(b, first, second);
+   case nir_intrinsic_store_ssbo:
+      return try_merge_stores(b, first, second);
+   default:
+      return try_merge_input_loads(b, first, second);
+   }
+}
+
+static bool
+vectorize_block(nir_builder *b, nir_block *block)
+{
+   bool progress = false;
+
+   nir_foreach_instr_safe(instr, block) {
+      if (instr->type != nir_instr_type_intrinsic)
+         continue;
+
+      nir_intrinsic_instr *second = nir_instr_as_intrinsic(instr);
+      if (!is_mergeable(second))
+         continue;
+
+      unsigned searched = 0;
+      for (nir_instr *prev = nir_instr_prev(instr);
+           prev != NULL && searched < SEARCH_WINDOW;
+           prev = nir_instr_prev(prev), searched++) {
+         if (prev->type == nir_instr_type_intrinsic &&
+             try_merge(b, nir_instr_as_intrinsic(prev), second)) {
+            progress = true;
+            break;
+         }
+
+         if (is_barrier_for(second, prev))
+            break;
+      }
+   }
+
+   return progress;
+}
+
+static bool
+nir_opt_vectorize_io_impl(nir_function_impl *impl)
+{
+   bool progress = false;
+   nir_builder b;
+   nir_builder_init(&b, impl);
+
+   nir_foreach_block(block, impl)
+      progress |= vectorize_block(&b, block);
+
+   if (progress) {
+      nir_metadata_preserve(impl, nir_metadata_block_index |
+                                  nir_metadata_dominance);
+   }
+
+   return progress;
+}
+
+bool
+nir_opt_vectorize_io(nir_shader *shader)
+{
+   bool progress = false;
+
+   nir_foreach_function(function, shader) {
+      if (function->impl)
+         progress |= nir_opt_vectorize_io_impl(function->impl);
+   }
+
+   return progress;
+}
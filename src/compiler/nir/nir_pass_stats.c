@@ -0,0 +1,261 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nir.h"
+#include "nir_serialize.h"
+#include "c11/threads.h"
+#include "util/mesa-sha1.h"
+
+#include <string.h>
+#include <time.h>
+
+/*
+ * Statistics for tracking how individual NIR passes affect shaders.
+ *
+ * nir_gather_shader_stats() works on any shader.  On top of it, NIR_PASS
+ * and NIR_PASS_V record each pass to the CSV file named by the
+ * NIR_PASS_STATS environment variable, one row per pass:
+ *
+ *    shader,stage,pass,progress,instrs_before,instrs_after,
+ *    ssa_defs_before,ssa_defs_after,max_live_before,max_live_after,time_us
+ *
+ * The shader column is a SHA-1 of the serialized shader as it looked
+ * before the first recorded pass, so results can be aggregated per shader
+ * across runs and driver versions.  progress is empty for NIR_PASS_V,
+ * which does not report it.
+ */
+
+struct live_count_state {
+   BITSET_WORD *live;
+   unsigned count;
+};
+
+static bool
+count_src_live(nir_src *src, void *void_state)
+{
+   struct live_count_state *state = void_state;
+
+   /* Index 0 is shared by all undefs, which are never live. */
+   if (src->is_ssa && src->ssa->live_index != 0 &&
+       !BITSET_TEST(state->live, src->ssa->live_index)) {
+      BITSET_SET(state->live, src->ssa->live_index);
+      state->count++;
+   }
+
+   return true;
+}
+
+static bool
+count_def_dead(nir_ssa_def *def, void *void_state)
+{
+   struct live_count_state *state = void_state;
+
+   if (BITSET_TEST(state->live, def->live_index)) {
+      BITSET_CLEAR(state->live, def->live_index);
+      state->count--;
+   }
+
+   return true;
+}
+
+static bool
+count_ssa_def(nir_ssa_def *def, void *void_count)
+{
+   (*(unsigned *) void_count)++;
+   return true;
+}
+
+/* Counts the indices nir_live_ssa_defs_impl() hands out */
+static bool
+count_live_index(nir_ssa_def *def, void *void_count)
+{
+   if (def->parent_instr->type != nir_instr_type_ssa_undef)
+      (*(unsigned *) void_count)++;
+   return true;
+}
+
+/* Walks each block backwards from its live-out set, the same way liveness
+ * analysis does, and returns the largest number of values live at once.
+ */
+static unsigned
+impl_max_live_ssa_defs(nir_function_impl *impl)
+{
+   nir_metadata_require(impl, nir_metadata_block_index |
+                              nir_metadata_live_ssa_defs);
+
+   unsigned num_defs = 1;
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr(instr, block)
+         nir_foreach_ssa_def(instr, count_live_index, &num_defs);
+   }
+
+   const unsigned words = BITSET_WORDS(num_defs);
+   struct live_count_state state;
+   state.live = malloc(words * sizeof(BITSET_WORD));
+   if (state.live == NULL)
+      return 0;
+
+   unsigned max_live = 0;
+   nir_foreach_block(block, impl) {
+      memcpy(state.live, block->live_out, words * sizeof(BITSET_WORD));
+
+      state.count = 0;
+      for (unsigned i = 0; i < words; i++)
+         state.count += util_bitcount(state.live[i]);
+
+      nir_if *following_if = nir_block_get_following_if(block);
+      if (following_if)
+         count_src_live(&following_if->condition, &state);
+
+      max_live = MAX2(max_live, state.count);
+
+      nir_foreach_instr_reverse(instr, block) {
+         if (instr->type == nir_instr_type_phi)
+            break;
+
+         nir_foreach_ssa_def(instr, count_def_dead, &state);
+         nir_foreach_src(instr, count_src_live, &state);
+         max_live = MAX2(max_live, state.count);
+      }
+   }
+
+   free(state.live);
+
+   return max_live;
+}
+
+void
+nir_gather_shader_stats(nir_shader *shader, nir_shader_stats *stats)
+{
+   memset(stats, 0, sizeof(*stats));
+
+   nir_foreach_function(function, shader) {
+      if (!function->impl)
+         continue;
+
+      nir_foreach_block(block, function->impl) {
+         nir_foreach_instr(instr, block) {
+            stats->num_instrs++;
+            nir_foreach_ssa_def(instr, count_ssa_def, &stats->num_ssa_defs);
+         }
+      }
+
+      stats->max_live_ssa_defs = MAX2(stats->max_live_ssa_defs,
+                                      impl_max_live_ssa_defs(function->impl));
+   }
+}
+
+static uint64_t
+pass_stats_time_ns(void)
+{
+#if defined(__linux__)
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#else
+   return 0;
+#endif
+}
+
+static FILE *pass_stats_file;
+static once_flag pass_stats_once = ONCE_FLAG_INIT;
+
+static void
+pass_stats_init(void)
+{
+   const char *path = getenv("NIR_PASS_STATS");
+   if (path == NULL || path[0] == '\0')
+      return;
+
+   if (strcmp(path, "stderr") == 0) {
+      pass_stats_file = stderr;
+   } else {
+      pass_stats_file = fopen(path, "a");
+      if (pass_stats_file == NULL) {
+         fprintf(stderr, "NIR_PASS_STATS: could not open %s\n", path);
+         return;
+      }
+   }
+
+   if (ftell(pass_stats_file) <= 0) {
+      fprintf(pass_stats_file,
+              "shader,stage,pass,progress,instrs_before,instrs_after,"
+              "ssa_defs_before,ssa_defs_after,max_live_before,max_live_after,"
+              "time_us\n");
+   }
+}
+
+bool
+nir_pass_stats_enabled(void)
+{
+   call_once(&pass_stats_once, pass_stats_init);
+   return pass_stats_file != NULL;
+}
+
+static void
+compute_pass_stats_id(nir_shader *shader)
+{
+   struct blob *blob = blob_create(NULL);
+   nir_serialize(blob, shader);
+
+   unsigned char sha1[20];
+   char id[41];
+   _mesa_sha1_compute(blob->data, blob->size, sha1);
+   _mesa_sha1_format(id, sha1);
+   ralloc_free(blob);
+
+   shader->pass_stats_id = ralloc_strdup(shader, id);
+}
+
+void
+nir_pass_stats_begin(nir_shader *shader, nir_pass_stats *stats)
+{
+   if (shader->pass_stats_id == NULL)
+      compute_pass_stats_id(shader);
+
+   nir_gather_shader_stats(shader, &stats->before);
+   stats->start_ns = pass_stats_time_ns();
+}
+
+void
+nir_pass_stats_end(nir_shader *shader, nir_pass_stats *stats,
+                   const char *pass, int progress)
+{
+   const uint64_t time_ns = pass_stats_time_ns() - stats->start_ns;
+
+   nir_shader_stats after;
+   nir_gather_shader_stats(shader, &after);
+
+   char progress_str[2] = "";
+   if (progress >= 0)
+      progress_str[0] = progress ? '1' : '0';
+
+   /* One fprintf per row keeps rows from different threads intact. */
+   fprintf(pass_stats_file, "%s,%s,%s,%s,%u,%u,%u,%u,%u,%u,%.3f\n",
+           shader->pass_stats_id, _mesa_shader_stage_to_abbrev(shader->stage),
+           pass, progress_str,
+           stats->before.num_instrs, after.num_instrs,
+           stats->before.num_ssa_defs, after.num_ssa_defs,
+           stats->before.max_live_ssa_defs, after.max_live_ssa_defs,
+           time_ns / 1000.0);
+}
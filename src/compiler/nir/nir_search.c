@@ -627,3 +627,166 @@ nir_replace_instr(nir_alu_instr *instr, const nir_search_expression *search,
 
    return mov;
 }
+
+/* The automaton states generated by nir_algebraic.py always start with the
+ * state of a value only matching variables, followed by the state of a
+ * load_const.
+ */
+#define WILDCARD_STATE 0
+#define CONST_STATE 1
+
+struct automaton_states {
+   uint16_t *states;
+   unsigned size;
+};
+
+static uint16_t
+get_src_state(const struct automaton_states *states, nir_src src)
+{
+   if (!src.is_ssa || src.ssa->index >= states->size)
+      return WILDCARD_STATE;
+
+   return states->states[src.ssa->index];
+}
+
+static void
+set_def_state(struct automaton_states *states, nir_ssa_def *def,
+              uint16_t state)
+{
+   if (def->index >= states->size) {
+      unsigned new_size = MAX2(states->size * 2, def->index + 1);
+      states->states = realloc(states->states,
+                               new_size * sizeof(*states->states));
+      memset(states->states + states->size, 0,
+             (new_size - states->size) * sizeof(*states->states));
+      states->size = new_size;
+   }
+
+   states->states[def->index] = state;
+}
+
+/** Computes the automaton state of the value defined by instr */
+static void
+update_state(struct automaton_states *states, nir_instr *instr,
+             const struct per_op_table *pass_op_table)
+{
+   switch (instr->type) {
+   case nir_instr_type_alu: {
+      nir_alu_instr *alu = nir_instr_as_alu(instr);
+      if (!alu->dest.dest.is_ssa)
+         return;
+
+      const struct per_op_table *tbl = &pass_op_table[alu->op];
+      uint16_t state = WILDCARD_STATE;
+      if (tbl->num_filtered_states > 0) {
+         unsigned index = 0;
+         for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
+            index *= tbl->num_filtered_states;
+            index += tbl->filter[get_src_state(states, alu->src[i].src)];
+         }
+         state = tbl->table[index];
+      }
+
+      set_def_state(states, &alu->dest.dest.ssa, state);
+      break;
+   }
+
+   case nir_instr_type_load_const:
+      set_def_state(states, &nir_instr_as_load_const(instr)->def,
+                    CONST_STATE);
+      break;
+
+   default:
+      /* Anything else only matches variables, which is the default */
+      break;
+   }
+}
+
+static nir_alu_instr *
+try_transforms(nir_alu_instr *alu, const bool *condition_flags,
+               const struct transform *xforms, unsigned num_xforms,
+               void *mem_ctx)
+{
+   for (unsigned i = 0; i < num_xforms; i++) {
+      const struct transform *xform = &xforms[i];
+      if (!condition_flags[xform->condition_offset])
+         continue;
+
+      nir_alu_instr *mov = nir_replace_instr(alu, xform->search,
+                                             xform->replace, mem_ctx);
+      if (mov)
+         return mov;
+   }
+
+   return NULL;
+}
+
+/**
+ * Runs the transforms of an algebraic pass generated by nir_algebraic.py
+ * on impl.
+ *
+ * Instructions are visited in order so that the automaton state of every
+ * source is known by the time an instruction is reached.  Only the
+ * transforms whose search expression can match, according to the state of
+ * the instruction, are then tried.
+ */
+bool
+nir_algebraic_impl(nir_function_impl *impl, const bool *condition_flags,
+                   const struct transform *const *transforms,
+                   const uint16_t *transform_counts,
+                   const struct per_op_table *pass_op_table)
+{
+   void *mem_ctx = ralloc_parent(impl);
+   bool progress = false;
+
+   struct automaton_states states;
+   states.size = impl->ssa_alloc;
+   states.states = calloc(MAX2(states.size, 1), sizeof(*states.states));
+
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr_safe(instr, block) {
+         update_state(&states, instr, pass_op_table);
+
+         if (instr->type != nir_instr_type_alu)
+            continue;
+
+         nir_alu_instr *alu = nir_instr_as_alu(instr);
+         if (!alu->dest.dest.is_ssa)
+            continue;
+
+         uint16_t state = states.states[alu->dest.dest.ssa.index];
+         nir_instr *prev = nir_instr_prev(instr);
+
+         nir_alu_instr *mov = try_transforms(alu, condition_flags,
+                                             transforms[state],
+                                             transform_counts[state],
+                                             mem_ctx);
+         if (!mov)
+            continue;
+
+         progress = true;
+
+         /* The replacement was built right before the instruction, ending
+          * with a mov that took its place.  Compute the states of the new
+          * instructions so that their users see them.  As before, they
+          * only get matched themselves on the next run of the pass.
+          */
+         nir_instr *new_instr = prev ? nir_instr_next(prev) :
+                                       nir_block_first_instr(block);
+         while (true) {
+            update_state(&states, new_instr, pass_op_table);
+            if (new_instr == &mov->instr)
+               break;
+            new_instr = nir_instr_next(new_instr);
+         }
+      }
+   }
+
+   free(states.states);
+
+   if (progress)
+      nir_metadata_preserve(impl, nir_metadata_block_index |
+                                  nir_metadata_dominance);
+
+   return progress;
+}
@@ -115,8 +115,32 @@ NIR_DEFINE_CAST(nir_search_value_as_expression, nir_search_value,
                 nir_search_expression, value,
                 type, nir_search_value_expression)
 
+struct transform {
+   const nir_search_expression *search;
+   const nir_search_value *replace;
+   unsigned condition_offset;
+};
+
+/** Transition table of the matching automaton for one opcode
+ *
+ * The automaton state of every source is first mapped through filter, and
+ * the resulting indices, each less than num_filtered_states, are used as
+ * the digits of the index into table, most significant first.
+ */
+struct per_op_table {
+   const uint16_t *filter;
+   const uint16_t *table;
+   uint16_t num_filtered_states;
+};
+
 nir_alu_instr *
 nir_replace_instr(nir_alu_instr *instr, const nir_search_expression *search,
                   const nir_search_value *replace, void *mem_ctx);
 
+bool
+nir_algebraic_impl(nir_function_impl *impl, const bool *condition_flags,
+                   const struct transform *const *transforms,
+                   const uint16_t *transform_counts,
+                   const struct per_op_table *pass_op_table);
+
 #endif /* _NIR_SEARCH_ */
@@ -0,0 +1,1242 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nir_serialize.h"
+#include "nir_control_flow_private.h"
+#include "compiler/glsl_types.h"
+
+/* The serialized form follows the structure of nir_clone.c.  Every object
+ * that can be pointed to (variables, registers, functions, blocks and SSA
+ * values) is given an index the first time the writer comes across it, and
+ * the index is written both where the object is defined and wherever it is
+ * used.  Phi sources are the only uses that may come before the definition;
+ * the reader fixes them up at the end of each function, like the cloner.
+ *
+ * SSA values also keep their own index field, so that the shader reads back
+ * numbered the same way.
+ */
+
+typedef struct {
+   struct blob *blob;
+
+   /* maps pointer -> index + 1 */
+   struct hash_table *remap_table;
+
+   /* the next index to hand out */
+   uintptr_t next_idx;
+} write_ctx;
+
+/* What an index refers to.  The reader checks it on every lookup so that a
+ * corrupt blob can't make it use one kind of object as another.
+ */
+typedef enum {
+   object_none = 0,
+   object_variable,
+   object_register,
+   object_ssa_def,
+   object_block,
+   object_function,
+} object_type;
+
+typedef struct {
+   void *ptr;
+   object_type type;
+} read_object_entry;
+
+typedef struct {
+   nir_shader *nir;
+
+   struct blob_reader *blob;
+
+   /* maps index -> object */
+   read_object_entry *idx_table;
+   uint32_t idx_table_size;
+
+   /* List of phi sources whose block and SSA value are still indices. */
+   struct list_head phi_srcs;
+
+   /* Set when the data turns out to be inconsistent. */
+   bool error;
+} read_ctx;
+
+static uint32_t
+write_object(write_ctx *ctx, const void *obj)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(ctx->remap_table, obj);
+   if (entry)
+      return (uintptr_t) entry->data - 1;
+
+   uint32_t idx = ctx->next_idx++;
+   _mesa_hash_table_insert(ctx->remap_table, obj, (void *)(uintptr_t)(idx + 1));
+   return idx;
+}
+
+static void
+write_lookup_object(write_ctx *ctx, const void *obj)
+{
+   blob_write_uint32(ctx->blob, obj ? write_object(ctx, obj) + 1 : 0);
+}
+
+static void
+read_set_object(read_ctx *ctx, uint32_t idx, void *obj, object_type type)
+{
+   /* Every object's index is written to the blob at least once. */
+   if (ctx->blob->overrun ||
+       idx >= (ctx->blob->end - ctx->blob->data) / sizeof(uint32_t)) {
+      ctx->error = true;
+      return;
+   }
+
+   if (idx >= ctx->idx_table_size) {
+      uint32_t size = MAX2(2 * ctx->idx_table_size, idx + 1);
+      ctx->idx_table = reralloc(ctx->nir, ctx->idx_table,
+                                read_object_entry, size);
+      memset(ctx->idx_table + ctx->idx_table_size, 0,
+             (size - ctx->idx_table_size) * sizeof(read_object_entry));
+      ctx->idx_table_size = size;
+   }
+
+   if (ctx->idx_table[idx].type != object_none) {
+      ctx->error = true;
+      return;
+   }
+
+   ctx->idx_table[idx].ptr = obj;
+   ctx->idx_table[idx].type = type;
+}
+
+static void
+read_add_object(read_ctx *ctx, void *obj, object_type type)
+{
+   read_set_object(ctx, blob_read_uint32(ctx->blob), obj, type);
+}
+
+static void *
+read_object(read_ctx *ctx, uint32_t idx, object_type type)
+{
+   if (idx >= ctx->idx_table_size || ctx->idx_table[idx].type != type) {
+      ctx->error = true;
+      return NULL;
+   }
+
+   return ctx->idx_table[idx].ptr;
+}
+
+/* Reads a reference written by write_lookup_object(); NULL is allowed. */
+static void *
+read_lookup_object(read_ctx *ctx, object_type type)
+{
+   uint32_t idx = blob_read_uint32(ctx->blob);
+   return idx ? read_object(ctx, idx - 1, type) : NULL;
+}
+
+/* Reads the length of an array whose elements take up at least \p elem_size
+ * bytes each in the blob, so that bad data can't ask for huge allocations.
+ */
+static uint32_t
+read_count(read_ctx *ctx, size_t elem_size)
+{
+   uint32_t count = blob_read_uint32(ctx->blob);
+   if (ctx->blob->overrun ||
+       count > (ctx->blob->end - ctx->blob->current) / elem_size) {
+      ctx->error = true;
+      return 0;
+   }
+
+   return count;
+}
+
+static void
+write_string(write_ctx *ctx, const char *str)
+{
+   blob_write_uint32(ctx->blob, str != NULL);
+   if (str)
+      blob_write_string(ctx->blob, str);
+}
+
+static char *
+read_string(read_ctx *ctx, void *mem_ctx)
+{
+   if (!blob_read_uint32(ctx->blob))
+      return NULL;
+
+   const char *str = blob_read_string(ctx->blob);
+   return str ? ralloc_strdup(mem_ctx, str) : NULL;
+}
+
+static void
+write_constant(write_ctx *ctx, const nir_constant *c)
+{
+   blob_write_bytes(ctx->blob, c->values, sizeof(c->values));
+   blob_write_uint32(ctx->blob, c->num_elements);
+   for (unsigned i = 0; i < c->num_elements; i++)
+      write_constant(ctx, c->elements[i]);
+}
+
+static nir_constant *
+read_constant(read_ctx *ctx, nir_variable *nvar)
+{
+   nir_constant *c = ralloc(nvar, nir_constant);
+
+   blob_copy_bytes(ctx->blob, (uint8_t *) c->values, sizeof(c->values));
+   c->num_elements = read_count(ctx, sizeof(c->values) + sizeof(uint32_t));
+   c->elements = ralloc_array(nvar, nir_constant *, c->num_elements);
+   for (unsigned i = 0; i < c->num_elements; i++)
+      c->elements[i] = read_constant(ctx, nvar);
+
+   return c;
+}
+
+static void
+write_variable(write_ctx *ctx, const nir_variable *var)
+{
+   blob_write_uint32(ctx->blob, write_object(ctx, var));
+   encode_type_to_blob(ctx->blob, var->type);
+   write_string(ctx, var->name);
+   blob_write_bytes(ctx->blob, &var->data, sizeof(var->data));
+   blob_write_uint32(ctx->blob, var->num_state_slots);
+   blob_write_bytes(ctx->blob, var->state_slots,
+                    var->num_state_slots * sizeof(nir_state_slot));
+   blob_write_uint32(ctx->blob, var->constant_initializer != NULL);
+   if (var->constant_initializer)
+      write_constant(ctx, var->constant_initializer);
+   encode_type_to_blob(ctx->blob, var->interface_type);
+}
+
+/* NOTE: like nir_variable_clone(), bypass nir_variable_create to avoid
+ * having to deal with locals and globals separately:
+ */
+static nir_variable *
+read_variable(read_ctx *ctx)
+{
+   nir_variable *var = rzalloc(ctx->nir, nir_variable);
+   read_add_object(ctx, var, object_variable);
+
+   var->type = decode_type_from_blob(ctx->blob);
+   var->name = read_string(ctx, var);
+   blob_copy_bytes(ctx->blob, (uint8_t *) &var->data, sizeof(var->data));
+   var->num_state_slots = read_count(ctx, sizeof(nir_state_slot));
+   var->state_slots = ralloc_array(var, nir_state_slot, var->num_state_slots);
+   blob_copy_bytes(ctx->blob, (uint8_t *) var->state_slots,
+                   var->num_state_slots * sizeof(nir_state_slot));
+   if (blob_read_uint32(ctx->blob))
+      var->constant_initializer = read_constant(ctx, var);
+   var->interface_type = decode_type_from_blob(ctx->blob);
+
+   return var;
+}
+
+static void
+write_var_list(write_ctx *ctx, const struct exec_list *list)
+{
+   blob_write_uint32(ctx->blob, exec_list_length(list));
+   foreach_list_typed(nir_variable, var, node, list)
+      write_variable(ctx, var);
+}
+
+static void
+read_var_list(read_ctx *ctx, struct exec_list *dst)
+{
+   exec_list_make_empty(dst);
+   unsigned num_vars = read_count(ctx, sizeof(uint32_t));
+   for (unsigned i = 0; i < num_vars && !ctx->error; i++) {
+      nir_variable *var = read_variable(ctx);
+      exec_list_push_tail(dst, &var->node);
+   }
+}
+
+static void
+write_register(write_ctx *ctx, const nir_register *reg)
+{
+   blob_write_uint32(ctx->blob, write_object(ctx, reg));
+   blob_write_uint32(ctx->blob, reg->num_components);
+   blob_write_uint32(ctx->blob, reg->bit_size);
+   blob_write_uint32(ctx->blob, reg->num_array_elems);
+   blob_write_uint32(ctx->blob, reg->index);
+   write_string(ctx, reg->name);
+   blob_write_uint32(ctx->blob, reg->is_global);
+   blob_write_uint32(ctx->blob, reg->is_packed);
+}
+
+/* NOTE: like clone_register(), bypass nir_global/local_reg_create() to avoid
+ * having to deal with locals and globals separately:
+ */
+static nir_register *
+read_register(read_ctx *ctx)
+{
+   nir_register *reg = rzalloc(ctx->nir, nir_register);
+   read_add_object(ctx, reg, object_register);
+
+   reg->num_components = blob_read_uint32(ctx->blob);
+   reg->bit_size = blob_read_uint32(ctx->blob);
+   reg->num_array_elems = blob_read_uint32(ctx->blob);
+   reg->index = blob_read_uint32(ctx->blob);
+   reg->name = read_string(ctx, reg);
+   reg->is_global = blob_read_uint32(ctx->blob);
+   reg->is_packed = blob_read_uint32(ctx->blob);
+
+   /* reconstructing uses/defs/if_uses handled by nir_instr_insert() */
+   list_inithead(&reg->uses);
+   list_inithead(&reg->defs);
+   list_inithead(&reg->if_uses);
+
+   return reg;
+}
+
+static void
+write_reg_list(write_ctx *ctx, const struct exec_list *list)
+{
+   blob_write_uint32(ctx->blob, exec_list_length(list));
+   foreach_list_typed(nir_register, reg, node, list)
+      write_register(ctx, reg);
+}
+
+static void
+read_reg_list(read_ctx *ctx, struct exec_list *dst)
+{
+   exec_list_make_empty(dst);
+   unsigned num_regs = read_count(ctx, sizeof(uint32_t));
+   for (unsigned i = 0; i < num_regs && !ctx->error; i++) {
+      nir_register *reg = read_register(ctx);
+      exec_list_push_tail(dst, &reg->node);
+   }
+}
+
+static void
+write_src(write_ctx *ctx, const nir_src *src)
+{
+   blob_write_uint32(ctx->blob, src->is_ssa);
+   if (src->is_ssa) {
+      write_lookup_object(ctx, src->ssa);
+   } else {
+      write_lookup_object(ctx, src->reg.reg);
+      blob_write_uint32(ctx->blob, src->reg.base_offset);
+      blob_write_uint32(ctx->blob, src->reg.indirect != NULL);
+      if (src->reg.indirect)
+         write_src(ctx, src->reg.indirect);
+   }
+}
+
+static void
+read_src(read_ctx *ctx, void *ninstr_or_if, nir_src *src)
+{
+   src->is_ssa = blob_read_uint32(ctx->blob);
+   if (src->is_ssa) {
+      src->ssa = read_lookup_object(ctx, object_ssa_def);
+      if (src->ssa == NULL)
+         ctx->error = true;
+   } else {
+      src->reg.reg = read_lookup_object(ctx, object_register);
+      if (src->reg.reg == NULL)
+         ctx->error = true;
+      src->reg.base_offset = blob_read_uint32(ctx->blob);
+      if (blob_read_uint32(ctx->blob) && !ctx->error) {
+         src->reg.indirect = ralloc(ninstr_or_if, nir_src);
+         read_src(ctx, ninstr_or_if, src->reg.indirect);
+      } else {
+         src->reg.indirect = NULL;
+      }
+   }
+}
+
+static void
+write_dest(write_ctx *ctx, const nir_dest *dst)
+{
+   blob_write_uint32(ctx->blob, dst->is_ssa);
+   if (dst->is_ssa) {
+      blob_write_uint32(ctx->blob, write_object(ctx, &dst->ssa));
+      blob_write_uint32(ctx->blob, dst->ssa.index);
+      blob_write_uint32(ctx->blob, dst->ssa.num_components);
+      blob_write_uint32(ctx->blob, dst->ssa.bit_size);
+      write_string(ctx, dst->ssa.name);
+   } else {
+      write_lookup_object(ctx, dst->reg.reg);
+      blob_write_uint32(ctx->blob, dst->reg.base_offset);
+      blob_write_uint32(ctx->blob, dst->reg.indirect != NULL);
+      if (dst->reg.indirect)
+         write_src(ctx, dst->reg.indirect);
+   }
+}
+
+static void
+read_dest(read_ctx *ctx, nir_instr *instr, nir_dest *dst)
+{
+   dst->is_ssa = blob_read_uint32(ctx->blob);
+   if (dst->is_ssa) {
+      uint32_t idx = blob_read_uint32(ctx->blob);
+      unsigned index = blob_read_uint32(ctx->blob);
+      unsigned num_components = blob_read_uint32(ctx->blob);
+      unsigned bit_size = blob_read_uint32(ctx->blob);
+      char *name = read_string(ctx, NULL);
+
+      nir_ssa_dest_init(instr, dst, num_components, bit_size, name);
+      dst->ssa.index = index;
+      ralloc_free(name);
+      read_set_object(ctx, idx, &dst->ssa, object_ssa_def);
+   } else {
+      dst->reg.reg = read_lookup_object(ctx, object_register);
+      if (dst->reg.reg == NULL)
+         ctx->error = true;
+      dst->reg.base_offset = blob_read_uint32(ctx->blob);
+      if (blob_read_uint32(ctx->blob) && !ctx->error) {
+         dst->reg.indirect = ralloc(instr, nir_src);
+         read_src(ctx, instr, dst->reg.indirect);
+      } else {
+         dst->reg.indirect = NULL;
+      }
+   }
+}
+
+static void
+write_deref_var(write_ctx *ctx, const nir_deref_var *dvar)
+{
+   blob_write_uint32(ctx->blob, dvar != NULL);
+   if (!dvar)
+      return;
+
+   write_lookup_object(ctx, dvar->var);
+
+   for (const nir_deref *d = dvar->deref.child; d; d = d->child) {
+      blob_write_uint32(ctx->blob, d->deref_type);
+      encode_type_to_blob(ctx->blob, d->type);
+
+      switch (d->deref_type) {
+      case nir_deref_type_array: {
+         const nir_deref_array *darr = nir_deref_as_array(d);
+         blob_write_uint32(ctx->blob, darr->deref_array_type);
+         blob_write_uint32(ctx->blob, darr->base_offset);
+         if (darr->deref_array_type == nir_deref_array_type_indirect)
+            write_src(ctx, &darr->indirect);
+         break;
+      }
+      case nir_deref_type_struct:
+         blob_write_uint32(ctx->blob, nir_deref_as_struct(d)->index);
+         break;
+      default:
+         unreachable("bad deref type");
+      }
+   }
+
+   /* A variable deref never appears inside a chain, so it ends the chain. */
+   blob_write_uint32(ctx->blob, nir_deref_type_var);
+}
+
+static nir_deref_var *
+read_deref_var(read_ctx *ctx, nir_instr *instr)
+{
+   if (!blob_read_uint32(ctx->blob))
+      return NULL;
+
+   nir_variable *var = read_lookup_object(ctx, object_variable);
+   if (var == NULL)
+      return NULL;
+
+   nir_deref_var *dvar = nir_deref_var_create(instr, var);
+   nir_deref *tail = &dvar->deref;
+
+   while (!ctx->error) {
+      nir_deref_type deref_type = blob_read_uint32(ctx->blob);
+      if (ctx->blob->overrun) {
+         ctx->error = true;
+         break;
+      }
+
+      if (deref_type == nir_deref_type_var)
+         break;
+
+      const struct glsl_type *type = decode_type_from_blob(ctx->blob);
+
+      switch (deref_type) {
+      case nir_deref_type_array: {
+         nir_deref_array *darr = nir_deref_array_create(tail);
+         darr->deref_array_type = blob_read_uint32(ctx->blob);
+         darr->base_offset = blob_read_uint32(ctx->blob);
+         if (darr->deref_array_type == nir_deref_array_type_indirect)
+            read_src(ctx, instr, &darr->indirect);
+         tail->child = &darr->deref;
+         break;
+      }
+      case nir_deref_type_struct: {
+         unsigned index = blob_read_uint32(ctx->blob);
+         tail->child = &nir_deref_struct_create(tail, index)->deref;
+         break;
+      }
+      default:
+         ctx->error = true;
+         return dvar;
+      }
+
+      tail = tail->child;
+      tail->type = type;
+   }
+
+   return dvar;
+}
+
+static void
+write_alu(write_ctx *ctx, const nir_alu_instr *alu)
+{
+   blob_write_uint32(ctx->blob, alu->op);
+   blob_write_uint32(ctx->blob, alu->exact);
+
+   write_dest(ctx, &alu->dest.dest);
+   blob_write_uint32(ctx->blob, alu->dest.saturate);
+   blob_write_uint32(ctx->blob, alu->dest.write_mask);
+
+   for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
+      write_src(ctx, &alu->src[i].src);
+      blob_write_uint32(ctx->blob, alu->src[i].negate);
+      blob_write_uint32(ctx->blob, alu->src[i].abs);
+      blob_write_bytes(ctx->blob, alu->src[i].swizzle,
+                       sizeof(alu->src[i].swizzle));
+   }
+}
+
+static nir_alu_instr *
+read_alu(read_ctx *ctx)
+{
+   nir_op op = blob_read_uint32(ctx->blob);
+   if (op >= nir_num_opcodes) {
+      ctx->error = true;
+      return NULL;
+   }
+
+   nir_alu_instr *alu = nir_alu_instr_create(ctx->nir, op);
+   alu->exact = blob_read_uint32(ctx->blob);
+
+   read_dest(ctx, &alu->instr, &alu->dest.dest);
+   alu->dest.saturate = blob_read_uint32(ctx->blob);
+   alu->dest.write_mask = blob_read_uint32(ctx->blob);
+
+   for (unsigned i = 0; i < nir_op_infos[op].num_inputs; i++) {
+      read_src(ctx, &alu->instr, &alu->src[i].src);
+      alu->src[i].negate = blob_read_uint32(ctx->blob);
+      alu->src[i].abs = blob_read_uint32(ctx->blob);
+      blob_copy_bytes(ctx->blob, alu->src[i].swizzle,
+                      sizeof(alu->src[i].swizzle));
+   }
+
+   return alu;
+}
+
+static void
+write_intrinsic(write_ctx *ctx, const nir_intrinsic_instr *intrin)
+{
+   const nir_intrinsic_info *info = &nir_intrinsic_infos[intrin->intrinsic];
+
+   blob_write_uint32(ctx->blob, intrin->intrinsic);
+   blob_write_uint32(ctx->blob, intrin->num_components);
+   blob_write_bytes(ctx->blob, intrin->const_index,
+                    sizeof(intrin->const_index));
+
+   if (info->has_dest)
+      write_dest(ctx, &intrin->dest);
+
+   for (unsigned i = 0; i < info->num_variables; i++)
+      write_deref_var(ctx, intrin->variables[i]);
+
+   for (unsigned i = 0; i < info->num_srcs; i++)
+      write_src(ctx, &intrin->src[i]);
+}
+
+static nir_intrinsic_instr *
+read_intrinsic(read_ctx *ctx)
+{
+   nir_intrinsic_op op = blob_read_uint32(ctx->blob);
+   if (op >= nir_num_intrinsics) {
+      ctx->error = true;
+      return NULL;
+   }
+
+   const nir_intrinsic_info *info = &nir_intrinsic_infos[op];
+   nir_intrinsic_instr *intrin = nir_intrinsic_instr_create(ctx->nir, op);
+
+   intrin->num_components = blob_read_uint32(ctx->blob);
+   blob_copy_bytes(ctx->blob, (uint8_t *) intrin->const_index,
+                   sizeof(intrin->const_index));
+
+   if (info->has_dest)
+      read_dest(ctx, &intrin->instr, &intrin->dest);
+
+   for (unsigned i = 0; i < info->num_variables; i++) {
+      intrin->variables[i] = read_deref_var(ctx, &intrin->instr);
+      if (intrin->variables[i] == NULL)
+         ctx->error = true;
+   }
+
+   for (unsigned i = 0; i < info->num_srcs; i++)
+      read_src(ctx, &intrin->instr, &intrin->src[i]);
+
+   return intrin;
+}
+
+static void
+write_load_const(write_ctx *ctx, const nir_load_const_instr *lc)
+{
+   blob_write_uint32(ctx->blob, write_object(ctx, &lc->def));
+   blob_write_uint32(ctx->blob, lc->def.index);
+   blob_write_uint32(ctx->blob, lc->def.num_components);
+   blob_write_uint32(ctx->blob, lc->def.bit_size);
+   blob_write_bytes(ctx->blob, &lc->value, sizeof(lc->value));
+}
+
+static nir_load_const_instr *
+read_load_const(read_ctx *ctx)
+{
+   uint32_t idx = blob_read_uint32(ctx->blob);
+   unsigned index = blob_read_uint32(ctx->blob);
+   unsigned num_components = blob_read_uint32(ctx->blob);
+   unsigned bit_size = blob_read_uint32(ctx->blob);
+
+   nir_load_const_instr *lc =
+      nir_load_const_instr_create(ctx->nir, num_components, bit_size);
+   lc->def.index = index;
+   blob_copy_bytes(ctx->blob, (uint8_t *) &lc->value, sizeof(lc->value));
+   read_set_object(ctx, idx, &lc->def, object_ssa_def);
+
+   return lc;
+}
+
+static void
+write_ssa_undef(write_ctx *ctx, const nir_ssa_undef_instr *undef)
+{
+   blob_write_uint32(ctx->blob, write_object(ctx, &undef->def));
+   blob_write_uint32(ctx->blob, undef->def.index);
+   blob_write_uint32(ctx->blob, undef->def.num_components);
+   blob_write_uint32(ctx->blob, undef->def.bit_size);
+}
+
+static nir_ssa_undef_instr *
+read_ssa_undef(read_ctx *ctx)
+{
+   uint32_t idx = blob_read_uint32(ctx->blob);
+   unsigned index = blob_read_uint32(ctx->blob);
+   unsigned num_components = blob_read_uint32(ctx->blob);
+   unsigned bit_size = blob_read_uint32(ctx->blob);
+
+   nir_ssa_undef_instr *undef =
+      nir_ssa_undef_instr_create(ctx->nir, num_components, bit_size);
+   undef->def.index = index;
+   read_set_object(ctx, idx, &undef->def, object_ssa_def);
+
+   return undef;
+}
+
+static void
+write_tex(write_ctx *ctx, const nir_tex_instr *tex)
+{
+   blob_write_uint32(ctx->blob, tex->num_srcs);
+   blob_write_uint32(ctx->blob, tex->sampler_dim);
+   blob_write_uint32(ctx->blob, tex->dest_type);
+   blob_write_uint32(ctx->blob, tex->op);
+   write_dest(ctx, &tex->dest);
+   for (unsigned i = 0; i < tex->num_srcs; i++) {
+      blob_write_uint32(ctx->blob, tex->src[i].src_type);
+      write_src(ctx, &tex->src[i].src);
+   }
+   blob_write_uint32(ctx->blob, tex->coord_components);
+   blob_write_uint32(ctx->blob, tex->is_array);
+   blob_write_uint32(ctx->blob, tex->is_shadow);
+   blob_write_uint32(ctx->blob, tex->is_new_style_shadow);
+   blob_write_uint32(ctx->blob, tex->component);
+
+   blob_write_uint32(ctx->blob, tex->texture_index);
+   write_deref_var(ctx, tex->texture);
+   blob_write_uint32(ctx->blob, tex->texture_array_size);
+
+   blob_write_uint32(ctx->blob, tex->sampler_index);
+   write_deref_var(ctx, tex->sampler);
+}
+
+static nir_tex_instr *
+read_tex(read_ctx *ctx)
+{
+   unsigned num_srcs = blob_read_uint32(ctx->blob);
+   if (num_srcs > nir_num_tex_src_types) {
+      ctx->error = true;
+      return NULL;
+   }
+
+   nir_tex_instr *tex = nir_tex_instr_create(ctx->nir, num_srcs);
+
+   tex->sampler_dim = blob_read_uint32(ctx->blob);
+   tex->dest_type = blob_read_uint32(ctx->blob);
+   tex->op = blob_read_uint32(ctx->blob);
+   read_dest(ctx, &tex->instr, &tex->dest);
+   for (unsigned i = 0; i < num_srcs; i++) {
+      tex->src[i].src_type = blob_read_uint32(ctx->blob);
+      read_src(ctx, &tex->instr, &tex->src[i].src);
+   }
+   tex->coord_components = blob_read_uint32(ctx->blob);
+   tex->is_array = blob_read_uint32(ctx->blob);
+   tex->is_shadow = blob_read_uint32(ctx->blob);
+   tex->is_new_style_shadow = blob_read_uint32(ctx->blob);
+   tex->component = blob_read_uint32(ctx->blob);
+
+   tex->texture_index = blob_read_uint32(ctx->blob);
+   tex->texture = read_deref_var(ctx, &tex->instr);
+   tex->texture_array_size = blob_read_uint32(ctx->blob);
+
+   tex->sampler_index = blob_read_uint32(ctx->blob);
+   tex->sampler = read_deref_var(ctx, &tex->instr);
+
+   return tex;
+}
+
+static void
+write_phi(write_ctx *ctx, const nir_phi_instr *phi)
+{
+   write_dest(ctx, &phi->dest);
+
+   blob_write_uint32(ctx->blob, exec_list_length(&phi->srcs));
+   nir_foreach_phi_src(src, phi) {
+      assert(src->src.is_ssa);
+      write_lookup_object(ctx, src->src.ssa);
+      write_lookup_object(ctx, src->pred);
+   }
+}
+
+/* Like clone_phi(), the phi is inserted before its sources are set up, and
+ * the block and SSA value of each source are left as indices until the end
+ * of read_function_impl(), since either may not have been read yet.
+ */
+static void
+read_phi(read_ctx *ctx, nir_block *blk)
+{
+   nir_phi_instr *phi = nir_phi_instr_create(ctx->nir);
+
+   read_dest(ctx, &phi->instr, &phi->dest);
+   if (ctx->error)
+      return;
+
+   nir_instr_insert_after_block(blk, &phi->instr);
+
+   unsigned num_srcs = read_count(ctx, 2 * sizeof(uint32_t));
+   for (unsigned i = 0; i < num_srcs; i++) {
+      nir_phi_src *src = ralloc(phi, nir_phi_src);
+
+      src->src.is_ssa = true;
+      src->src.ssa = (void *)(uintptr_t) blob_read_uint32(ctx->blob);
+      src->pred = (void *)(uintptr_t) blob_read_uint32(ctx->blob);
+      src->src.parent_instr = &phi->instr;
+
+      list_add(&src->src.use_link, &ctx->phi_srcs);
+      exec_list_push_tail(&phi->srcs, &src->node);
+   }
+}
+
+static void
+write_jump(write_ctx *ctx, const nir_jump_instr *jmp)
+{
+   blob_write_uint32(ctx->blob, jmp->type);
+}
+
+static nir_jump_instr *
+read_jump(read_ctx *ctx, nir_block *blk)
+{
+   nir_jump_type type = blob_read_uint32(ctx->blob);
+
+   /* nir_instr_insert() insists on breaks and continues being in a loop. */
+   switch (type) {
+   case nir_jump_return:
+      break;
+   case nir_jump_break:
+   case nir_jump_continue: {
+      nir_cf_node *node = blk->cf_node.parent;
+      while (node && node->type != nir_cf_node_loop)
+         node = node->parent;
+      if (node == NULL)
+         ctx->error = true;
+      break;
+   }
+   default:
+      ctx->error = true;
+      return NULL;
+   }
+
+   return nir_jump_instr_create(ctx->nir, type);
+}
+
+static void
+write_call(write_ctx *ctx, const nir_call_instr *call)
+{
+   write_lookup_object(ctx, call->callee);
+
+   for (unsigned i = 0; i < call->num_params; i++)
+      write_deref_var(ctx, call->params[i]);
+
+   write_deref_var(ctx, call->return_deref);
+}
+
+static nir_call_instr *
+read_call(read_ctx *ctx)
+{
+   nir_function *callee = read_lookup_object(ctx, object_function);
+   if (callee == NULL) {
+      ctx->error = true;
+      return NULL;
+   }
+
+   nir_call_instr *call = nir_call_instr_create(ctx->nir, callee);
+
+   for (unsigned i = 0; i < call->num_params; i++)
+      call->params[i] = read_deref_var(ctx, &call->instr);
+
+   call->return_deref = read_deref_var(ctx, &call->instr);
+
+   return call;
+}
+
+static void
+write_instr(write_ctx *ctx, const nir_instr *instr)
+{
+   blob_write_uint32(ctx->blob, instr->type);
+   switch (instr->type) {
+   case nir_instr_type_alu:
+      write_alu(ctx, nir_instr_as_alu(instr));
+      break;
+   case nir_instr_type_intrinsic:
+      write_intrinsic(ctx, nir_instr_as_intrinsic(instr));
+      break;
+   case nir_instr_type_load_const:
+      write_load_const(ctx, nir_instr_as_load_const(instr));
+      break;
+   case nir_instr_type_ssa_undef:
+      write_ssa_undef(ctx, nir_instr_as_ssa_undef(instr));
+      break;
+   case nir_instr_type_tex:
+      write_tex(ctx, nir_instr_as_tex(instr));
+      break;
+   case nir_instr_type_phi:
+      write_phi(ctx, nir_instr_as_phi(instr));
+      break;
+   case nir_instr_type_jump:
+      write_jump(ctx, nir_instr_as_jump(instr));
+      break;
+   case nir_instr_type_call:
+      write_call(ctx, nir_instr_as_call(instr));
+      break;
+   case nir_instr_type_parallel_copy:
+      unreachable("Cannot serialize parallel copies");
+   default:
+      unreachable("bad instr type");
+   }
+}
+
+static void
+read_instr(read_ctx *ctx, nir_block *blk)
+{
+   nir_instr_type type = blob_read_uint32(ctx->blob);
+   nir_instr *instr;
+
+   switch (type) {
+   case nir_instr_type_alu:
+      instr = &read_alu(ctx)->instr;
+      break;
+   case nir_instr_type_intrinsic:
+      instr = &read_intrinsic(ctx)->instr;
+      break;
+   case nir_instr_type_load_const:
+      instr = &read_load_const(ctx)->instr;
+      break;
+   case nir_instr_type_ssa_undef:
+      instr = &read_ssa_undef(ctx)->instr;
+      break;
+   case nir_instr_type_tex:
+      instr = &read_tex(ctx)->instr;
+      break;
+   case nir_instr_type_phi:
+      /* Phis insert themselves, see read_phi(). */
+      read_phi(ctx, blk);
+      return;
+   case nir_instr_type_jump:
+      instr = &read_jump(ctx, blk)->instr;
+      break;
+   case nir_instr_type_call:
+      instr = &read_call(ctx)->instr;
+      break;
+   default:
+      ctx->error = true;
+      return;
+   }
+
+   /* A half-read instruction may have sources that point nowhere, so don't
+    * let nir_instr_insert() add it to any use lists.
+    */
+   if (ctx->error || ctx->blob->overrun) {
+      ctx->error = true;
+      return;
+   }
+
+   nir_instr_insert_after_block(blk, instr);
+}
+
+static void
+write_block(write_ctx *ctx, const nir_block *blk)
+{
+   blob_write_uint32(ctx->blob, write_object(ctx, blk));
+   blob_write_uint32(ctx->blob, exec_list_length(&blk->instr_list));
+   nir_foreach_instr(instr, blk)
+      write_instr(ctx, instr);
+}
+
+static void
+read_block(read_ctx *ctx, struct exec_list *cf_list)
+{
+   /* Don't actually create a new block.  Just use the one from the tail of
+    * the list, as clone_block() does.  NIR guarantees that the tail of the
+    * list is a block and that no two blocks are side-by-side in the IR.
+    */
+   nir_block *blk =
+      exec_node_data(nir_block, exec_list_get_tail(cf_list), cf_node.node);
+   assert(blk->cf_node.type == nir_cf_node_block);
+   if (!exec_list_is_empty(&blk->instr_list)) {
+      ctx->error = true;
+      return;
+   }
+
+   read_add_object(ctx, blk, object_block);
+
+   unsigned num_instrs = read_count(ctx, sizeof(uint32_t));
+   for (unsigned i = 0; i < num_instrs && !ctx->error; i++)
+      read_instr(ctx, blk);
+}
+
+static void
+write_cf_list(write_ctx *ctx, const struct exec_list *cf_list);
+
+static void
+read_cf_list(read_ctx *ctx, struct exec_list *cf_list);
+
+static void
+write_if(write_ctx *ctx, const nir_if *nif)
+{
+   write_src(ctx, &nif->condition);
+
+   write_cf_list(ctx, &nif->then_list);
+   write_cf_list(ctx, &nif->else_list);
+}
+
+static void
+read_if(read_ctx *ctx, struct exec_list *cf_list)
+{
+   nir_if *nif = nir_if_create(ctx->nir);
+
+   read_src(ctx, nif, &nif->condition);
+   if (ctx->error)
+      return;
+
+   nir_cf_node_insert_end(cf_list, &nif->cf_node);
+
+   read_cf_list(ctx, &nif->then_list);
+   read_cf_list(ctx, &nif->else_list);
+}
+
+static void
+write_loop(write_ctx *ctx, const nir_loop *loop)
+{
+   write_cf_list(ctx, &loop->body);
+}
+
+static void
+read_loop(read_ctx *ctx, struct exec_list *cf_list)
+{
+   nir_loop *loop = nir_loop_create(ctx->nir);
+
+   nir_cf_node_insert_end(cf_list, &loop->cf_node);
+
+   read_cf_list(ctx, &loop->body);
+}
+
+static void
+write_cf_node(write_ctx *ctx, const nir_cf_node *cf)
+{
+   blob_write_uint32(ctx->blob, cf->type);
+
+   switch (cf->type) {
+   case nir_cf_node_block:
+      write_block(ctx, nir_cf_node_as_block(cf));
+      break;
+   case nir_cf_node_if:
+      write_if(ctx, nir_cf_node_as_if(cf));
+      break;
+   case nir_cf_node_loop:
+      write_loop(ctx, nir_cf_node_as_loop(cf));
+      break;
+   default:
+      unreachable("bad cf type");
+   }
+}
+
+static void
+read_cf_node(read_ctx *ctx, struct exec_list *list)
+{
+   nir_cf_node_type type = blob_read_uint32(ctx->blob);
+
+   switch (type) {
+   case nir_cf_node_block:
+      read_block(ctx, list);
+      break;
+   case nir_cf_node_if:
+      read_if(ctx, list);
+      break;
+   case nir_cf_node_loop:
+      read_loop(ctx, list);
+      break;
+   default:
+      ctx->error = true;
+   }
+}
+
+static void
+write_cf_list(write_ctx *ctx, const struct exec_list *cf_list)
+{
+   blob_write_uint32(ctx->blob, exec_list_length(cf_list));
+   foreach_list_typed(nir_cf_node, cf, node, cf_list)
+      write_cf_node(ctx, cf);
+}
+
+static void
+read_cf_list(read_ctx *ctx, struct exec_list *cf_list)
+{
+   uint32_t num_cf_nodes = read_count(ctx, sizeof(uint32_t));
+   for (unsigned i = 0; i < num_cf_nodes && !ctx->error; i++)
+      read_cf_node(ctx, cf_list);
+}
+
+static void
+write_function_impl(write_ctx *ctx, const nir_function_impl *fi)
+{
+   write_var_list(ctx, &fi->locals);
+   write_reg_list(ctx, &fi->registers);
+   blob_write_uint32(ctx->blob, fi->reg_alloc);
+   blob_write_uint32(ctx->blob, fi->ssa_alloc);
+
+   blob_write_uint32(ctx->blob, fi->num_params);
+   for (unsigned i = 0; i < fi->num_params; i++)
+      write_variable(ctx, fi->params[i]);
+
+   blob_write_uint32(ctx->blob, fi->return_var != NULL);
+   if (fi->return_var)
+      write_variable(ctx, fi->return_var);
+
+   write_cf_list(ctx, &fi->body);
+}
+
+static nir_function_impl *
+read_function_impl(read_ctx *ctx, nir_function *fxn)
+{
+   nir_function_impl *fi = nir_function_impl_create_bare(ctx->nir);
+   fi->function = fxn;
+
+   read_var_list(ctx, &fi->locals);
+   read_reg_list(ctx, &fi->registers);
+   fi->reg_alloc = blob_read_uint32(ctx->blob);
+   fi->ssa_alloc = blob_read_uint32(ctx->blob);
+
+   fi->num_params = read_count(ctx, sizeof(uint32_t));
+   fi->params = ralloc_array(ctx->nir, nir_variable *, fi->num_params);
+   for (unsigned i = 0; i < fi->num_params; i++)
+      fi->params[i] = read_variable(ctx);
+
+   if (blob_read_uint32(ctx->blob))
+      fi->return_var = read_variable(ctx);
+
+   assert(list_empty(&ctx->phi_srcs));
+
+   read_cf_list(ctx, &fi->body);
+
+   /* Now that every block and SSA value has been read, resolve the phi
+    * sources, like clone_function_impl() does.
+    */
+   list_for_each_entry_safe(nir_phi_src, src, &ctx->phi_srcs, src.use_link) {
+      uint32_t ssa_idx = (uintptr_t) src->src.ssa;
+      uint32_t pred_idx = (uintptr_t) src->pred;
+
+      list_del(&src->src.use_link);
+
+      src->src.ssa = read_object(ctx, ssa_idx - 1, object_ssa_def);
+      src->pred = read_object(ctx, pred_idx - 1, object_block);
+      if (src->src.ssa == NULL || src->pred == NULL) {
+         ctx->error = true;
+         continue;
+      }
+
+      list_addtail(&src->src.use_link, &src->src.ssa->uses);
+   }
+   assert(list_empty(&ctx->phi_srcs));
+
+   /* Metadata is not serialized */
+   fi->valid_metadata = 0;
+
+   return fi;
+}
+
+static void
+write_function(write_ctx *ctx, const nir_function *fxn)
+{
+   blob_write_uint32(ctx->blob, write_object(ctx, fxn));
+   write_string(ctx, fxn->name);
+
+   blob_write_uint32(ctx->blob, fxn->num_params);
+   for (unsigned i = 0; i < fxn->num_params; i++) {
+      blob_write_uint32(ctx->blob, fxn->params[i].param_type);
+      encode_type_to_blob(ctx->blob, fxn->params[i].type);
+   }
+
+   encode_type_to_blob(ctx->blob, fxn->return_type);
+
+   /* As in clone_function(), the impls are written in a second pass so
+    * that calls can refer to functions that come later in the list.
+    */
+}
+
+static void
+read_function(read_ctx *ctx)
+{
+   uint32_t idx = blob_read_uint32(ctx->blob);
+   char *name = read_string(ctx, NULL);
+   nir_function *fxn = nir_function_create(ctx->nir, name);
+   ralloc_free(name);
+
+   read_set_object(ctx, idx, fxn, object_function);
+
+   fxn->num_params = read_count(ctx, sizeof(uint32_t));
+   fxn->params = ralloc_array(ctx->nir, nir_parameter, fxn->num_params);
+   for (unsigned i = 0; i < fxn->num_params; i++) {
+      fxn->params[i].param_type = blob_read_uint32(ctx->blob);
+      fxn->params[i].type = decode_type_from_blob(ctx->blob);
+   }
+
+   fxn->return_type = decode_type_from_blob(ctx->blob);
+}
+
+void
+nir_serialize(struct blob *blob, const nir_shader *nir)
+{
+   write_ctx ctx;
+   ctx.blob = blob;
+   ctx.remap_table = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
+                                             _mesa_key_pointer_equal);
+   ctx.next_idx = 0;
+
+   blob_write_uint32(blob, nir->stage);
+
+   /* The strings are written separately; keep the pointers out of the blob
+    * so that it only depends on the shader.
+    */
+   shader_info info = *nir->info;
+   info.name = NULL;
+   info.label = NULL;
+   write_string(&ctx, nir->info->name);
+   write_string(&ctx, nir->info->label);
+   blob_write_bytes(blob, &info, sizeof(info));
+
+   write_var_list(&ctx, &nir->uniforms);
+   write_var_list(&ctx, &nir->inputs);
+   write_var_list(&ctx, &nir->outputs);
+   write_var_list(&ctx, &nir->shared);
+   write_var_list(&ctx, &nir->globals);
+   write_var_list(&ctx, &nir->system_values);
+
+   /* Global registers may be used by any impl, so they go first. */
+   write_reg_list(&ctx, &nir->registers);
+   blob_write_uint32(blob, nir->reg_alloc);
+
+   blob_write_uint32(blob, nir->num_inputs);
+   blob_write_uint32(blob, nir->num_uniforms);
+   blob_write_uint32(blob, nir->num_outputs);
+   blob_write_uint32(blob, nir->num_shared);
+
+   blob_write_uint32(blob, exec_list_length(&nir->functions));
+   nir_foreach_function(fxn, nir)
+      write_function(&ctx, fxn);
+
+   nir_foreach_function(fxn, nir) {
+      blob_write_uint32(blob, fxn->impl != NULL);
+      if (fxn->impl)
+         write_function_impl(&ctx, fxn->impl);
+   }
+
+   _mesa_hash_table_destroy(ctx.remap_table, NULL);
+}
+
+nir_shader *
+nir_deserialize(void *mem_ctx,
+                const struct nir_shader_compiler_options *options,
+                struct blob_reader *blob)
+{
+   read_ctx ctx;
+   ctx.blob = blob;
+   ctx.idx_table = NULL;
+   ctx.idx_table_size = 0;
+   ctx.error = false;
+   list_inithead(&ctx.phi_srcs);
+
+   gl_shader_stage stage = blob_read_uint32(blob);
+   if (stage >= MESA_SHADER_STAGES)
+      return NULL;
+
+   ctx.nir = nir_shader_create(mem_ctx, stage, options, NULL);
+
+   char *name = read_string(&ctx, ctx.nir);
+   char *label = read_string(&ctx, ctx.nir);
+   blob_copy_bytes(blob, (uint8_t *) ctx.nir->info, sizeof(*ctx.nir->info));
+   ctx.nir->info->name = name;
+   ctx.nir->info->label = label;
+
+   read_var_list(&ctx, &ctx.nir->uniforms);
+   read_var_list(&ctx, &ctx.nir->inputs);
+   read_var_list(&ctx, &ctx.nir->outputs);
+   read_var_list(&ctx, &ctx.nir->shared);
+   read_var_list(&ctx, &ctx.nir->globals);
+   read_var_list(&ctx, &ctx.nir->system_values);
+
+   read_reg_list(&ctx, &ctx.nir->registers);
+   ctx.nir->reg_alloc = blob_read_uint32(blob);
+
+   ctx.nir->num_inputs = blob_read_uint32(blob);
+   ctx.nir->num_uniforms = blob_read_uint32(blob);
+   ctx.nir->num_outputs = blob_read_uint32(blob);
+   ctx.nir->num_shared = blob_read_uint32(blob);
+
+   unsigned num_functions = read_count(&ctx, sizeof(uint32_t));
+   for (unsigned i = 0; i < num_functions && !ctx.error; i++)
+      read_function(&ctx);
+
+   nir_foreach_function(fxn, ctx.nir) {
+      if (ctx.error || blob->overrun)
+         break;
+      if (blob_read_uint32(blob))
+         fxn->impl = read_function_impl(&ctx, fxn);
+   }
+
+   if (ctx.error || blob->overrun) {
+      ralloc_free(ctx.nir);
+      return NULL;
+   }
+
+   ralloc_free(ctx.idx_table);
+
+   return ctx.nir;
+}
@@ -320,6 +320,22 @@ vtn_foreach_execution_mode(struct vtn_builder *b, struct vtn_value *value,
    }
 }
 
+/* Modules often have several decorations per id, so they are handed out
+ * from zeroed blocks rather than allocated one by one.
+ */
+static struct vtn_decoration *
+vtn_decoration_alloc(struct vtn_builder *b)
+{
+   if (b->decoration_pool_left == 0) {
+      b->decoration_pool_left = 256;
+      b->decoration_pool = rzalloc_array(b, struct vtn_decoration,
+                                         b->decoration_pool_left);
+   }
+
+   b->decoration_pool_left--;
+   return b->decoration_pool++;
+}
+
 static void
 vtn_handle_decoration(struct vtn_builder *b, SpvOp opcode,
                       const uint32_t *w, unsigned count)
@@ -338,7 +354,7 @@ vtn_handle_decoration(struct vtn_builder *b, SpvOp opcode,
    case SpvOpExecutionMode: {
       struct vtn_value *val = &b->values[target];
 
-      struct vtn_decoration *dec = rzalloc(b, struct vtn_decoration);
+      struct vtn_decoration *dec = vtn_decoration_alloc(b);
       switch (opcode) {
       case SpvOpDecorate:
          dec->scope = VTN_DEC_DECORATION;
@@ -368,7 +384,7 @@ vtn_handle_decoration(struct vtn_builder *b, SpvOp opcode,
 
       for (; w < w_end; w++) {
          struct vtn_value *val = vtn_untyped_value(b, *w);
-         struct vtn_decoration *dec = rzalloc(b, struct vtn_decoration);
+         struct vtn_decoration *dec = vtn_decoration_alloc(b);
 
          dec->group = group;
          if (opcode == SpvOpGroupDecorate) {
@@ -375,6 +375,10 @@ struct vtn_builder {
    unsigned value_id_bound;
    struct vtn_value *values;
 
+   /* Decorations not handed out yet, see vtn_decoration_alloc() */
+   struct vtn_decoration *decoration_pool;
+   unsigned decoration_pool_left;
+
    gl_shader_stage entry_point_stage;
    const char *entry_point_name;
    struct vtn_value *entry_point;
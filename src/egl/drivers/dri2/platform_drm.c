@@ -40,6 +40,27 @@
 #include "egl_dri2_fallbacks.h"
 #include "loader.h"
 
+/**
+ * Returns how many color buffers a gbm surface may use, that is how many
+ * frames can be locked or in flight at once.  All of them by default, but
+ * clients that don't pipeline deeply can save memory with
+ * EGL_GBM_NUM_BUFFERS.
+ */
+static unsigned
+get_num_color_buffers(void)
+{
+   const struct dri2_egl_surface *dri2_surf = NULL;
+   const int max = ARRAY_SIZE(dri2_surf->color_buffers);
+   const char *str = getenv("EGL_GBM_NUM_BUFFERS");
+   int num;
+
+   if (!str)
+      return max;
+
+   num = atoi(str);
+   return CLAMP(num, 2, max);
+}
+
 static struct gbm_bo *
 lock_front_buffer(struct gbm_surface *_surf)
 {
@@ -70,7 +91,7 @@ release_buffer(struct gbm_surface *_surf, struct gbm_bo *bo)
    struct dri2_egl_surface *dri2_surf = surf->dri_private;
    unsigned i;
 
-   for (i = 0; i < ARRAY_SIZE(dri2_surf->color_buffers); i++) {
+   for (i = 0; i < dri2_surf->num_color_buffers; i++) {
       if (dri2_surf->color_buffers[i].bo == bo) {
 	 dri2_surf->color_buffers[i].locked = 0;
       }
@@ -84,7 +105,7 @@ has_free_buffers(struct gbm_surface *_surf)
    struct dri2_egl_surface *dri2_surf = surf->dri_private;
    unsigned i;
 
-   for (i = 0; i < ARRAY_SIZE(dri2_surf->color_buffers); i++)
+   for (i = 0; i < dri2_surf->num_color_buffers; i++)
       if (!dri2_surf->color_buffers[i].locked)
 	 return 1;
 
@@ -126,6 +147,7 @@ dri2_drm_create_surface(_EGLDriver *drv, _EGLDisplay *disp, EGLint type,
       dri2_surf->base.Width =  surf->base.width;
       dri2_surf->base.Height = surf->base.height;
       surf->dri_private = dri2_surf;
+      dri2_surf->num_color_buffers = get_num_color_buffers();
       break;
    default:
       goto cleanup_surf;
@@ -193,7 +215,7 @@ dri2_drm_destroy_surface(_EGLDriver *drv, _EGLDisplay *disp, _EGLSurface *surf)
 
    (*dri2_dpy->core->destroyDrawable)(dri2_surf->dri_drawable);
 
-   for (i = 0; i < ARRAY_SIZE(dri2_surf->color_buffers); i++) {
+   for (i = 0; i < dri2_surf->num_color_buffers; i++) {
       if (dri2_surf->color_buffers[i].bo)
 	 gbm_bo_destroy(dri2_surf->color_buffers[i].bo);
    }
@@ -218,7 +240,7 @@ get_back_bo(struct dri2_egl_surface *dri2_surf)
    unsigned i;
 
    if (dri2_surf->back == NULL) {
-      for (i = 0; i < ARRAY_SIZE(dri2_surf->color_buffers); i++) {
+      for (i = 0; i < dri2_surf->num_color_buffers; i++) {
 	 if (!dri2_surf->color_buffers[i].locked) {
 	    dri2_surf->back = &dri2_surf->color_buffers[i];
 	    break;
@@ -419,7 +441,7 @@ dri2_drm_swap_buffers(_EGLDriver *drv, _EGLDisplay *disp, _EGLSurface *draw)
       if (dri2_surf->base.Type == EGL_WINDOW_BIT) {
          if (dri2_surf->current)
             _eglError(EGL_BAD_SURFACE, "dri2_swap_buffers");
-         for (i = 0; i < ARRAY_SIZE(dri2_surf->color_buffers); i++)
+         for (i = 0; i < dri2_surf->num_color_buffers; i++)
             if (dri2_surf->color_buffers[i].age > 0)
                dri2_surf->color_buffers[i].age++;
 
@@ -298,6 +298,15 @@ _eglParseContextAttribList(_EGLContext *ctx, _EGLDisplay *dpy,
             ctx->Flags |= EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE_BIT_KHR;
          break;
 
+      case EGL_CONTEXT_OPENGL_NO_ERROR_KHR:
+         if (!dpy->Extensions.KHR_create_context_no_error) {
+            err = EGL_BAD_ATTRIBUTE;
+            break;
+         }
+
+         ctx->NoError = val == EGL_TRUE;
+         break;
+
       default:
          err = EGL_BAD_ATTRIBUTE;
          break;
@@ -450,6 +459,17 @@ _eglParseContextAttribList(_EGLContext *ctx, _EGLDisplay *dpy,
       err = EGL_BAD_ATTRIBUTE;
    }
 
+   /* The EGL_KHR_create_context_no_error spec says:
+    *
+    *     "BAD_MATCH is generated if the EGL_CONTEXT_OPENGL_NO_ERROR_KHR is TRUE
+    *     at the same time as a debug or robustness context is specified."
+    */
+   if (ctx->NoError &&
+       (ctx->Flags & (EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR |
+                      EGL_CONTEXT_OPENGL_ROBUST_ACCESS_BIT_KHR))) {
+      err = EGL_BAD_MATCH;
+   }
+
    return err;
 }
 
@@ -491,6 +511,7 @@ _eglInitContext(_EGLContext *ctx, _EGLDisplay *dpy, _EGLConfig *conf,
    ctx->Flags = 0;
    ctx->Profile = EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR;
    ctx->ResetNotificationStrategy = EGL_NO_RESET_NOTIFICATION_KHR;
+   ctx->NoError = EGL_FALSE;
 
    err = _eglParseContextAttribList(ctx, dpy, attrib_list);
    if (err == EGL_SUCCESS && ctx->Config) {
@@ -52,10 +52,12 @@ static unsigned hash_key(const void *key, unsigned key_size)
 
    assert(key_size % 4 == 0);
 
-   /* I'm sure this can be improved on:
+   /* FNV-1a over 32-bit words. A plain xor of the words made states
+    * differing in the same bit of two words collide.
     */
+   hash = 2166136261u;
    for (i = 0; i < key_size/4; i++)
-      hash ^= ikey[i];
+      hash = (hash ^ ikey[i]) * 16777619u;
 
    return hash;
 }
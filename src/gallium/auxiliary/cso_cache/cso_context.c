@@ -57,6 +57,10 @@ struct sampler_info
 {
    void *samplers[PIPE_MAX_SAMPLERS];
    unsigned nr_samplers;
+
+   /** The samplers last given to the driver, to skip redundant binds. */
+   void *bound_samplers[PIPE_MAX_SAMPLERS];
+   unsigned nr_bound_samplers;
 };
 
 
@@ -73,8 +77,9 @@ struct cso_context {
 
    unsigned saved_state;  /**< bitmask of CSO_BIT_x flags */
 
-   struct pipe_sampler_view *fragment_views[PIPE_MAX_SHADER_SAMPLER_VIEWS];
-   unsigned nr_fragment_views;
+   /** The sampler views last given to the driver, for each stage. */
+   struct pipe_sampler_view *views[PIPE_SHADER_TYPES][PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   unsigned nr_views[PIPE_SHADER_TYPES];
 
    struct pipe_sampler_view *fragment_views_saved[PIPE_MAX_SHADER_SAMPLER_VIEWS];
    unsigned nr_fragment_views_saved;
@@ -106,6 +111,12 @@ struct cso_context {
    void *blend, *blend_saved;
    void *depth_stencil, *depth_stencil_saved;
    void *rasterizer, *rasterizer_saved;
+   /* The cache entries last bound by cso_set_*, to skip the lookup when
+    * the same state is set again.
+    */
+   struct cso_blend *blend_cso;
+   struct cso_depth_stencil_alpha *depth_stencil_cso;
+   struct cso_rasterizer *rasterizer_cso;
    void *fragment_shader, *fragment_shader_saved;
    void *vertex_shader, *vertex_shader_saved;
    void *geometry_shader, *geometry_shader_saved;
@@ -133,6 +144,9 @@ static boolean delete_blend_state(struct cso_context *ctx, void *state)
    if (ctx->blend == cso->data)
       return FALSE;
 
+   if (ctx->blend_cso == cso)
+      ctx->blend_cso = NULL;
+
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -147,6 +161,9 @@ static boolean delete_depth_stencil_state(struct cso_context *ctx, void *state)
    if (ctx->depth_stencil == cso->data)
       return FALSE;
 
+   if (ctx->depth_stencil_cso == cso)
+      ctx->depth_stencil_cso = NULL;
+
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -157,6 +174,20 @@ static boolean delete_depth_stencil_state(struct cso_context *ctx, void *state)
 static boolean delete_sampler_state(struct cso_context *ctx, void *state)
 {
    struct cso_sampler *cso = (struct cso_sampler *)state;
+   unsigned sh, i;
+
+   /* A new sampler could get the address of a deleted one which is still
+    * bound, and its bind would then be skipped.
+    */
+   for (sh = 0; sh < PIPE_SHADER_TYPES; sh++) {
+      const struct sampler_info *info = &ctx->samplers[sh];
+
+      for (i = 0; i < info->nr_bound_samplers; i++) {
+         if (info->bound_samplers[i] == cso->data)
+            return FALSE;
+      }
+   }
+
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -169,6 +200,8 @@ static boolean delete_rasterizer_state(struct cso_context *ctx, void *state)
 
    if (ctx->rasterizer == cso->data)
       return FALSE;
+   if (ctx->rasterizer_cso == cso)
+      ctx->rasterizer_cso = NULL;
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -359,7 +392,10 @@ void cso_destroy_context( struct cso_context *ctx )
    }
 
    for (i = 0; i < PIPE_MAX_SHADER_SAMPLER_VIEWS; i++) {
-      pipe_sampler_view_reference(&ctx->fragment_views[i], NULL);
+      unsigned sh;
+
+      for (sh = 0; sh < PIPE_SHADER_TYPES; sh++)
+         pipe_sampler_view_reference(&ctx->views[sh][i], NULL);
       pipe_sampler_view_reference(&ctx->fragment_views_saved[i], NULL);
    }
 
@@ -408,17 +444,23 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
 {
    unsigned key_size, hash_key;
    struct cso_hash_iter iter;
+   struct cso_blend *cso;
    void *handle;
 
    key_size = templ->independent_blend_enable ?
       sizeof(struct pipe_blend_state) :
       (char *)&(templ->rt[1]) - (char *)templ;
+
+   if (ctx->blend_cso && ctx->blend == ctx->blend_cso->data &&
+       memcmp(&ctx->blend_cso->state, templ, key_size) == 0)
+      return PIPE_OK;
+
    hash_key = cso_construct_key((void*)templ, key_size);
    iter = cso_find_state_template(ctx->cache, hash_key, CSO_BLEND,
                                   (void*)templ, key_size);
 
    if (cso_hash_iter_is_null(iter)) {
-      struct cso_blend *cso = MALLOC(sizeof(struct cso_blend));
+      cso = MALLOC(sizeof(struct cso_blend));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -437,9 +479,11 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
       handle = cso->data;
    }
    else {
-      handle = ((struct cso_blend *)cso_hash_iter_data(iter))->data;
+      cso = (struct cso_blend *)cso_hash_iter_data(iter);
+      handle = cso->data;
    }
 
+   ctx->blend_cso = cso;
    if (ctx->blend != handle) {
       ctx->blend = handle;
       ctx->pipe->bind_blend_state(ctx->pipe, handle);
@@ -471,16 +515,23 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
                             const struct pipe_depth_stencil_alpha_state *templ)
 {
    unsigned key_size = sizeof(struct pipe_depth_stencil_alpha_state);
-   unsigned hash_key = cso_construct_key((void*)templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(ctx->cache,
-                                                       hash_key,
-                                                       CSO_DEPTH_STENCIL_ALPHA,
-                                                       (void*)templ, key_size);
+   unsigned hash_key;
+   struct cso_hash_iter iter;
+   struct cso_depth_stencil_alpha *cso;
    void *handle;
 
+   if (ctx->depth_stencil_cso &&
+       ctx->depth_stencil == ctx->depth_stencil_cso->data &&
+       memcmp(&ctx->depth_stencil_cso->state, templ, key_size) == 0)
+      return PIPE_OK;
+
+   hash_key = cso_construct_key((void*)templ, key_size);
+   iter = cso_find_state_template(ctx->cache, hash_key,
+                                  CSO_DEPTH_STENCIL_ALPHA,
+                                  (void*)templ, key_size);
+
    if (cso_hash_iter_is_null(iter)) {
-      struct cso_depth_stencil_alpha *cso =
-         MALLOC(sizeof(struct cso_depth_stencil_alpha));
+      cso = MALLOC(sizeof(struct cso_depth_stencil_alpha));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -501,10 +552,11 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
       handle = cso->data;
    }
    else {
-      handle = ((struct cso_depth_stencil_alpha *)
-                cso_hash_iter_data(iter))->data;
+      cso = (struct cso_depth_stencil_alpha *)cso_hash_iter_data(iter);
+      handle = cso->data;
    }
 
+   ctx->depth_stencil_cso = cso;
    if (ctx->depth_stencil != handle) {
       ctx->depth_stencil = handle;
       ctx->pipe->bind_depth_stencil_alpha_state(ctx->pipe, handle);
@@ -536,15 +588,21 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
                                    const struct pipe_rasterizer_state *templ)
 {
    unsigned key_size = sizeof(struct pipe_rasterizer_state);
-   unsigned hash_key = cso_construct_key((void*)templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(ctx->cache,
-                                                       hash_key,
-                                                       CSO_RASTERIZER,
-                                                       (void*)templ, key_size);
+   unsigned hash_key;
+   struct cso_hash_iter iter;
+   struct cso_rasterizer *cso;
    void *handle = NULL;
 
+   if (ctx->rasterizer_cso && ctx->rasterizer == ctx->rasterizer_cso->data &&
+       memcmp(&ctx->rasterizer_cso->state, templ, key_size) == 0)
+      return PIPE_OK;
+
+   hash_key = cso_construct_key((void*)templ, key_size);
+   iter = cso_find_state_template(ctx->cache, hash_key, CSO_RASTERIZER,
+                                  (void*)templ, key_size);
+
    if (cso_hash_iter_is_null(iter)) {
-      struct cso_rasterizer *cso = MALLOC(sizeof(struct cso_rasterizer));
+      cso = MALLOC(sizeof(struct cso_rasterizer));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -563,9 +621,11 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
       handle = cso->data;
    }
    else {
-      handle = ((struct cso_rasterizer *)cso_hash_iter_data(iter))->data;
+      cso = (struct cso_rasterizer *)cso_hash_iter_data(iter);
+      handle = cso->data;
    }
 
+   ctx->rasterizer_cso = cso;
    if (ctx->rasterizer != handle) {
       ctx->rasterizer = handle;
       ctx->pipe->bind_rasterizer_state(ctx->pipe, handle);
@@ -1211,7 +1271,6 @@ cso_single_sampler_done(struct cso_context *ctx,
                         enum pipe_shader_type shader_stage)
 {
    struct sampler_info *info = &ctx->samplers[shader_stage];
-   const unsigned old_nr_samplers = info->nr_samplers;
    unsigned i;
 
    /* find highest non-null sampler */
@@ -1221,9 +1280,19 @@ cso_single_sampler_done(struct cso_context *ctx,
    }
 
    info->nr_samplers = i;
+
+   if (info->nr_samplers == info->nr_bound_samplers &&
+       memcmp(info->samplers, info->bound_samplers,
+              info->nr_samplers * sizeof(info->samplers[0])) == 0)
+      return;
+
    ctx->pipe->bind_sampler_states(ctx->pipe, shader_stage, 0,
-                                  MAX2(old_nr_samplers, info->nr_samplers),
+                                  MAX2(info->nr_bound_samplers,
+                                       info->nr_samplers),
                                   info->samplers);
+
+   memcpy(info->bound_samplers, info->samplers, sizeof(info->samplers));
+   info->nr_bound_samplers = info->nr_samplers;
 }
 
 
@@ -1288,32 +1357,29 @@ cso_set_sampler_views(struct cso_context *ctx,
                       unsigned count,
                       struct pipe_sampler_view **views)
 {
-   if (shader_stage == PIPE_SHADER_FRAGMENT) {
-      unsigned i;
-      boolean any_change = FALSE;
-
-      /* reference new views */
-      for (i = 0; i < count; i++) {
-         any_change |= ctx->fragment_views[i] != views[i];
-         pipe_sampler_view_reference(&ctx->fragment_views[i], views[i]);
-      }
-      /* unref extra old views, if any */
-      for (; i < ctx->nr_fragment_views; i++) {
-         any_change |= ctx->fragment_views[i] != NULL;
-         pipe_sampler_view_reference(&ctx->fragment_views[i], NULL);
-      }
+   struct pipe_sampler_view **bound = ctx->views[shader_stage];
+   unsigned i;
+   boolean any_change = FALSE;
 
-      /* bind the new sampler views */
-      if (any_change) {
-         ctx->pipe->set_sampler_views(ctx->pipe, shader_stage, 0,
-                                      MAX2(ctx->nr_fragment_views, count),
-                                      ctx->fragment_views);
-      }
+   /* reference new views */
+   for (i = 0; i < count; i++) {
+      any_change |= bound[i] != views[i];
+      pipe_sampler_view_reference(&bound[i], views[i]);
+   }
+   /* unref extra old views, if any */
+   for (; i < ctx->nr_views[shader_stage]; i++) {
+      any_change |= bound[i] != NULL;
+      pipe_sampler_view_reference(&bound[i], NULL);
+   }
 
-      ctx->nr_fragment_views = count;
+   /* bind the new sampler views */
+   if (any_change) {
+      ctx->pipe->set_sampler_views(ctx->pipe, shader_stage, 0,
+                                   MAX2(ctx->nr_views[shader_stage], count),
+                                   bound);
    }
-   else
-      ctx->pipe->set_sampler_views(ctx->pipe, shader_stage, 0, count, views);
+
+   ctx->nr_views[shader_stage] = count;
 }
 
 
@@ -1322,12 +1388,12 @@ cso_save_fragment_sampler_views(struct cso_context *ctx)
 {
    unsigned i;
 
-   ctx->nr_fragment_views_saved = ctx->nr_fragment_views;
+   ctx->nr_fragment_views_saved = ctx->nr_views[PIPE_SHADER_FRAGMENT];
 
-   for (i = 0; i < ctx->nr_fragment_views; i++) {
+   for (i = 0; i < ctx->nr_views[PIPE_SHADER_FRAGMENT]; i++) {
       assert(!ctx->fragment_views_saved[i]);
       pipe_sampler_view_reference(&ctx->fragment_views_saved[i],
-                                  ctx->fragment_views[i]);
+                                  ctx->views[PIPE_SHADER_FRAGMENT][i]);
    }
 }
 
@@ -1339,22 +1405,22 @@ cso_restore_fragment_sampler_views(struct cso_context *ctx)
    unsigned num;
 
    for (i = 0; i < nr_saved; i++) {
-      pipe_sampler_view_reference(&ctx->fragment_views[i], NULL);
+      pipe_sampler_view_reference(&ctx->views[PIPE_SHADER_FRAGMENT][i], NULL);
       /* move the reference from one pointer to another */
-      ctx->fragment_views[i] = ctx->fragment_views_saved[i];
+      ctx->views[PIPE_SHADER_FRAGMENT][i] = ctx->fragment_views_saved[i];
       ctx->fragment_views_saved[i] = NULL;
    }
-   for (; i < ctx->nr_fragment_views; i++) {
-      pipe_sampler_view_reference(&ctx->fragment_views[i], NULL);
+   for (; i < ctx->nr_views[PIPE_SHADER_FRAGMENT]; i++) {
+      pipe_sampler_view_reference(&ctx->views[PIPE_SHADER_FRAGMENT][i], NULL);
    }
 
-   num = MAX2(ctx->nr_fragment_views, nr_saved);
+   num = MAX2(ctx->nr_views[PIPE_SHADER_FRAGMENT], nr_saved);
 
    /* bind the old/saved sampler views */
    ctx->pipe->set_sampler_views(ctx->pipe, PIPE_SHADER_FRAGMENT, 0, num,
-                                ctx->fragment_views);
+                                ctx->views[PIPE_SHADER_FRAGMENT]);
 
-   ctx->nr_fragment_views = nr_saved;
+   ctx->nr_views[PIPE_SHADER_FRAGMENT] = nr_saved;
    ctx->nr_fragment_views_saved = 0;
 }
 
@@ -1089,6 +1089,19 @@ draw_collect_pipeline_statistics(struct draw_context *draw,
    draw->collect_statistics = enable;
 }
 
+/**
+ * Returns how many indices indexed draws used so far, and how many vertices
+ * were fetched and shaded for them.  Their ratio tells how much of the
+ * vertex reuse of the index buffers the draw module managed to exploit.
+ */
+void
+draw_get_vertex_reuse(const struct draw_context *draw,
+                      uint64_t *elts, uint64_t *fetches)
+{
+   *elts = draw->pt.reuse.elts;
+   *fetches = draw->pt.reuse.fetches;
+}
+
 /**
  * Computes clipper invocation statistics.
  *
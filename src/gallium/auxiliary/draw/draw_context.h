@@ -291,6 +291,9 @@ void draw_set_force_passthrough( struct draw_context *draw,
 void draw_collect_pipeline_statistics(struct draw_context *draw,
                                       boolean enable);
 
+void draw_get_vertex_reuse(const struct draw_context *draw,
+                           uint64_t *elts, uint64_t *fetches);
+
 /*******************************************************************************
  * Draw pipeline 
  */
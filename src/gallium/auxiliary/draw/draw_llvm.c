@@ -607,6 +607,8 @@ generate_vs(struct draw_llvm_variant *variant,
 {
    struct draw_llvm *llvm = variant->llvm;
    const struct tgsi_token *tokens = llvm->draw->vs.vertex_shader->state.tokens;
+   struct llvm_vertex_shader *shader =
+      llvm_vertex_shader(llvm->draw->vs.vertex_shader);
    LLVMValueRef consts_ptr =
       draw_jit_context_vs_constants(variant->gallivm, context_ptr);
    LLVMValueRef num_consts_ptr =
@@ -614,6 +616,7 @@ generate_vs(struct draw_llvm_variant *variant,
 
    lp_build_tgsi_soa(variant->gallivm,
                      tokens,
+                     shader->parsed,
                      vs_type,
                      NULL /*struct lp_build_mask_context *mask*/,
                      consts_ptr,
@@ -2361,6 +2364,7 @@ draw_gs_llvm_generate(struct draw_llvm *llvm,
 
    lp_build_tgsi_soa(variant->gallivm,
                      tokens,
+                     NULL,
                      gs_type,
                      &mask,
                      consts_ptr,
@@ -421,6 +421,9 @@ struct draw_gs_llvm_variant
 struct llvm_vertex_shader {
    struct draw_vertex_shader base;
 
+   /* decoded once for all the variants, may be NULL */
+   struct tgsi_parsed_shader *parsed;
+
    unsigned variant_key_size;
    struct draw_llvm_variant_list_item variants;
    unsigned variants_created;
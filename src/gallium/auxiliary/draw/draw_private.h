@@ -210,6 +210,12 @@ struct draw_context
          float (*planes)[DRAW_TOTAL_CLIP_PLANES][4]; 
       } user;
 
+      /** indices of indexed draws and vertices fetched for them */
+      struct {
+         uint64_t elts;
+         uint64_t fetches;
+      } reuse;
+
       boolean test_fse;         /* enable FSE even though its not correct (eg for softpipe) */
       boolean no_fse;           /* disable FSE even when it is correct */
    } pt;
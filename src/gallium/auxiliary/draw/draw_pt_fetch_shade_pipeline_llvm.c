@@ -28,6 +28,8 @@
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_prim.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
 #include "draw/draw_context.h"
 #include "draw/draw_gs.h"
 #include "draw/draw_vbuf.h"
@@ -39,6 +41,34 @@
 #include "gallivm/lp_bld_init.h"
 
 
+/** Max number of jobs the vertex shading of a chunk is split into */
+#define LLVM_MAX_VS_JOBS 8
+
+/** Min number of vertices worth handing to another thread */
+#define LLVM_MIN_VS_JOB_VERTS 128
+
+
+struct llvm_middle_end;
+
+/**
+ * A range of the vertices of a chunk, run through the vertex shader by
+ * one thread.
+ */
+struct llvm_vs_job {
+   struct llvm_middle_end *fpme;
+   struct util_queue_fence fence;
+
+   struct vertex_header *verts;
+   const unsigned *elts;
+   unsigned count;
+   unsigned start_or_maxelt;
+   unsigned vid_base;
+   unsigned fpstate;
+
+   boolean clipped;
+};
+
+
 struct llvm_middle_end {
    struct draw_pt_middle_end base;
    struct draw_context *draw;
@@ -56,6 +86,9 @@ struct llvm_middle_end {
 
    struct draw_llvm *llvm;
    struct draw_llvm_variant *current_variant;
+
+   struct util_queue vs_queue;
+   struct llvm_vs_job vs_jobs[LLVM_MAX_VS_JOBS];
 };
 
 
@@ -336,6 +369,98 @@ emit(struct pt_emit *emit,
 }
 
 
+static void
+llvm_vs_job_run(void *data, int thread_index)
+{
+   struct llvm_vs_job *job = (struct llvm_vs_job *) data;
+   struct llvm_middle_end *fpme = job->fpme;
+   struct draw_context *draw = fpme->draw;
+
+   /* queue threads must flush denorms just like the drawing thread */
+   util_fpstate_set(job->fpstate);
+
+   job->clipped = fpme->current_variant->jit_func(&fpme->llvm->jit_context,
+                                                  job->verts,
+                                                  draw->pt.user.vbuffer,
+                                                  job->count,
+                                                  job->start_or_maxelt,
+                                                  fpme->vertex_size,
+                                                  draw->pt.vertex_buffer,
+                                                  draw->instance_id,
+                                                  job->vid_base,
+                                                  draw->start_instance,
+                                                  job->elts);
+}
+
+
+/**
+ * Fetch and shade the vertices of a chunk.
+ *
+ * Large chunks are split in ranges shaded by the vertex shader queue, while
+ * this thread does the first one.  Each range is written to its own part of
+ * the output buffer, so the vertices end up in the same order as if they
+ * had been shaded in one go, and the rest of the pipeline runs unchanged.
+ */
+static boolean
+llvm_middle_end_run_vs(struct llvm_middle_end *fpme,
+                       struct vertex_header *verts,
+                       const struct draw_fetch_info *fetch_info)
+{
+   struct draw_context *draw = fpme->draw;
+   const unsigned vector_length = lp_native_vector_width / 32;
+   const unsigned count = fetch_info->count;
+   const unsigned fpstate = util_fpstate_get();
+   unsigned num_jobs = 1, i;
+   boolean clipped;
+
+   if (util_queue_is_initialized(&fpme->vs_queue)) {
+      num_jobs = MIN2(count / LLVM_MIN_VS_JOB_VERTS,
+                      fpme->vs_queue.num_threads + 1);
+      num_jobs = MAX2(num_jobs, 1);
+   }
+
+   for (i = 0; i < num_jobs; i++) {
+      struct llvm_vs_job *job = &fpme->vs_jobs[i];
+      /* The shader writes whole vectors, so only the last range may end
+       * in a partial one, which the buffer has room for.
+       */
+      const unsigned first = align(count * i / num_jobs, vector_length);
+      const unsigned last = i + 1 < num_jobs ?
+         align(count * (i + 1) / num_jobs, vector_length) : count;
+
+      job->verts = (struct vertex_header *)
+         ((char *) verts + first * fpme->vertex_size);
+      job->count = last - first;
+      job->fpstate = fpstate;
+
+      if (fetch_info->linear) {
+         job->start_or_maxelt = fetch_info->start + first;
+         job->vid_base = draw->start_index;
+         job->elts = NULL;
+      }
+      else {
+         job->start_or_maxelt = draw->pt.user.eltMax;
+         job->vid_base = draw->pt.user.eltBias;
+         job->elts = fetch_info->elts + first;
+      }
+
+      if (i > 0)
+         util_queue_add_job(&fpme->vs_queue, job, &job->fence,
+                            llvm_vs_job_run, NULL);
+   }
+
+   llvm_vs_job_run(&fpme->vs_jobs[0], 0);
+   clipped = fpme->vs_jobs[0].clipped;
+
+   for (i = 1; i < num_jobs; i++) {
+      util_queue_job_wait(&fpme->vs_jobs[i].fence);
+      clipped |= fpme->vs_jobs[i].clipped;
+   }
+
+   return clipped;
+}
+
+
 static void
 llvm_pipeline_generic(struct draw_pt_middle_end *middle,
                       const struct draw_fetch_info *fetch_info,
@@ -354,8 +479,6 @@ llvm_pipeline_generic(struct draw_pt_middle_end *middle,
    boolean free_prim_info = FALSE;
    unsigned opt = fpme->opt;
    boolean clipped = 0;
-   unsigned start_or_maxelt, vid_base;
-   const unsigned *elts;
 
    llvm_vert_info.count = fetch_info->count;
    llvm_vert_info.vertex_size = fpme->vertex_size;
@@ -375,27 +498,7 @@ llvm_pipeline_generic(struct draw_pt_middle_end *middle,
       draw->statistics.vs_invocations += fetch_info->count;
    }
 
-   if (fetch_info->linear) {
-      start_or_maxelt = fetch_info->start;
-      vid_base = draw->start_index;
-      elts = NULL;
-   }
-   else {
-      start_or_maxelt = draw->pt.user.eltMax;
-      vid_base = draw->pt.user.eltBias;
-      elts = fetch_info->elts;
-   }
-   clipped = fpme->current_variant->jit_func(&fpme->llvm->jit_context,
-                                             llvm_vert_info.verts,
-                                             draw->pt.user.vbuffer,
-                                             fetch_info->count,
-                                             start_or_maxelt,
-                                             fpme->vertex_size,
-                                             draw->pt.vertex_buffer,
-                                             draw->instance_id,
-                                             vid_base,
-                                             draw->start_instance,
-                                             elts);
+   clipped = llvm_middle_end_run_vs(fpme, llvm_vert_info.verts, fetch_info);
 
    /* Finished with fetch and vs:
     */
@@ -585,6 +688,13 @@ static void
 llvm_middle_end_destroy(struct draw_pt_middle_end *middle)
 {
    struct llvm_middle_end *fpme = llvm_middle_end(middle);
+   unsigned i;
+
+   if (util_queue_is_initialized(&fpme->vs_queue))
+      util_queue_destroy(&fpme->vs_queue);
+
+   for (i = 0; i < LLVM_MAX_VS_JOBS; i++)
+      util_queue_fence_destroy(&fpme->vs_jobs[i].fence);
 
    if (fpme->fetch)
       draw_pt_fetch_destroy( fpme->fetch );
@@ -606,6 +716,7 @@ struct draw_pt_middle_end *
 draw_pt_fetch_pipeline_or_emit_llvm(struct draw_context *draw)
 {
    struct llvm_middle_end *fpme = 0;
+   unsigned num_threads, i;
 
    if (!draw->llvm)
       return NULL;
@@ -614,6 +725,11 @@ draw_pt_fetch_pipeline_or_emit_llvm(struct draw_context *draw)
    if (!fpme)
       goto fail;
 
+   for (i = 0; i < LLVM_MAX_VS_JOBS; i++) {
+      fpme->vs_jobs[i].fpme = fpme;
+      util_queue_fence_init(&fpme->vs_jobs[i].fence);
+   }
+
    fpme->base.prepare         = llvm_middle_end_prepare;
    fpme->base.bind_parameters = llvm_middle_end_bind_parameters;
    fpme->base.run             = llvm_middle_end_run;
@@ -646,6 +762,15 @@ draw_pt_fetch_pipeline_or_emit_llvm(struct draw_context *draw)
 
    fpme->current_variant = NULL;
 
+   /* The drawing thread shades a range too, so one thread means no queue.
+    */
+   num_threads = debug_get_num_option("DRAW_NUM_THREADS",
+                                      util_cpu_caps.nr_cpus);
+   num_threads = MIN2(num_threads, LLVM_MAX_VS_JOBS);
+   if (num_threads > 1)
+      util_queue_init(&fpme->vs_queue, "draw_vs", LLVM_MAX_VS_JOBS,
+                      num_threads - 1);
+
    return &fpme->base;
 
  fail:
@@ -75,6 +75,7 @@ vs_llvm_delete( struct draw_vertex_shader *dvs )
    }
 
    assert(shader->variants_cached == 0);
+   tgsi_free_parsed_shader(shader->parsed);
    FREE((void*) dvs->state.tokens);
    FREE( dvs );
 }
@@ -97,6 +98,7 @@ draw_create_vs_llvm(struct draw_context *draw,
    }
 
    tgsi_scan_shader(state->tokens, &vs->base.info);
+   vs->parsed = tgsi_parse_shader(vs->base.state.tokens);
 
    vs->variant_key_size = 
       draw_llvm_variant_key_size(
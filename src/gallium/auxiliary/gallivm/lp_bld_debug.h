@@ -47,6 +47,8 @@
 #define GALLIVM_DEBUG_GC            (1 << 8)
 #define GALLIVM_DEBUG_DUMP_BC       (1 << 9)
 
+#define GALLIVM_PERF_QUAD_LOD       (1 << 0)
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +61,9 @@ extern unsigned gallivm_debug;
 #define gallivm_debug 0
 #endif
 
+/* Optimizations trading accuracy for speed, available in release builds. */
+extern unsigned gallivm_perf;
+
 
 static inline void
 lp_build_name(LLVMValueRef val, const char *format, ...)
@@ -401,6 +401,60 @@ lp_build_fetch_rgba_soa(struct gallivm_state *gallivm,
       return;
    }
 
+#ifdef PIPE_ARCH_LITTLE_ENDIAN
+   if (format_desc->layout == UTIL_FORMAT_LAYOUT_PLAIN &&
+       format_desc->colorspace == UTIL_FORMAT_COLORSPACE_RGB &&
+       format_desc->block.width == 1 &&
+       format_desc->block.height == 1 &&
+       format_desc->is_array &&
+       format_desc->channel[0].type == UTIL_FORMAT_TYPE_FLOAT &&
+       format_desc->channel[0].size == 16 &&
+       format_desc->nr_channels != 3 &&
+       type.floating && type.width == 32) {
+      /*
+       * Half float formats (R16F, RG16F, RGBA16F) are too wide for the
+       * above.  Gather them 32 bits at a time instead, and convert all
+       * vector elements of a channel at once.
+       */
+      struct lp_build_context bld;
+      struct lp_type i16_type = lp_type_int_vec(16, 16 * type.length);
+      LLVMValueRef chans[4];
+      unsigned chan;
+
+      lp_build_context_init(&bld, gallivm, type);
+
+      for (chan = 0; chan < format_desc->nr_channels; chan += 2) {
+         LLVMValueRef word_offset, packed, half;
+
+         word_offset = LLVMBuildAdd(builder, offset,
+                                    lp_build_const_int_vec(gallivm, type,
+                                                           chan * 2), "");
+         packed = lp_build_gather(gallivm, type.length,
+                                  MIN2(format_desc->block.bits, 32),
+                                  type.width, TRUE,
+                                  base_ptr, word_offset, FALSE);
+
+         half = LLVMBuildTrunc(builder, packed,
+                               lp_build_vec_type(gallivm, i16_type), "");
+         chans[chan] = lp_build_half_to_float(gallivm, half);
+
+         if (chan + 1 < format_desc->nr_channels) {
+            half = LLVMBuildLShr(builder, packed,
+                                 lp_build_const_int_vec(gallivm, type, 16), "");
+            half = LLVMBuildTrunc(builder, half,
+                                  lp_build_vec_type(gallivm, i16_type), "");
+            chans[chan + 1] = lp_build_half_to_float(gallivm, half);
+         }
+      }
+
+      for (chan = 0; chan < 4; chan++) {
+         rgba_out[chan] = lp_build_swizzle_soa_channel(&bld, chans,
+                                                       format_desc->swizzle[chan]);
+      }
+      return;
+   }
+#endif
+
    if (format_desc->format == PIPE_FORMAT_R11G11B10_FLOAT ||
        format_desc->format == PIPE_FORMAT_R9G9B9E5_FLOAT) {
       /*
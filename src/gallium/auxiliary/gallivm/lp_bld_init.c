@@ -74,6 +74,15 @@ DEBUG_GET_ONCE_FLAGS_OPTION(gallivm_debug, "GALLIVM_DEBUG", lp_bld_debug_flags,
 #endif
 
 
+unsigned gallivm_perf = 0;
+
+static const struct debug_named_value lp_bld_perf_flags[] = {
+   { "quad_lod", GALLIVM_PERF_QUAD_LOD,
+     "use per-quad lod for explicit lod and lod bias in fragment shaders" },
+   DEBUG_NAMED_VALUE_END
+};
+
+
 static boolean gallivm_initialized = FALSE;
 
 unsigned lp_native_vector_width;
@@ -201,6 +210,14 @@ gallivm_free_ir(struct gallivm_state *gallivm)
    if (gallivm->builder)
       LLVMDisposeBuilder(gallivm->builder);
 
+   /* The object cache must outlive the engine, but not the caller's
+    * lp_cached_code it points to. */
+   if (gallivm->cache) {
+      lp_free_objcache(gallivm->cache->jit_obj_cache);
+      gallivm->cache->jit_obj_cache = NULL;
+      gallivm->cache = NULL;
+   }
+
    /* The LLVMContext should be owned by the parent of gallivm. */
 
    gallivm->engine = NULL;
@@ -245,6 +262,7 @@ init_gallivm_engine(struct gallivm_state *gallivm)
 
       ret = lp_build_create_jit_compiler_for_module(&gallivm->engine,
                                                     &gallivm->code,
+                                                    gallivm->cache,
                                                     gallivm->module,
                                                     gallivm->memorymgr,
                                                     (unsigned) optlevel,
@@ -405,6 +423,8 @@ lp_build_init(void)
    gallivm_debug = debug_get_option_gallivm_debug();
 #endif
 
+   gallivm_perf = debug_get_flags_option("GALLIVM_PERF", lp_bld_perf_flags, 0);
+
    lp_set_target_options();
 
    util_cpu_detect();
@@ -462,6 +482,17 @@ lp_build_init(void)
        * MCJIT. */
       util_cpu_caps.has_avx2 = 0;
    }
+   if (HAVE_LLVM < 0x0309 || !util_cpu_caps.has_avx2) {
+      /* Code generation for AVX-512 is unreliable before LLVM 3.9.  Only
+       * the VL forms of the 128/256-bit instructions are used, so AVX-512
+       * goes along with the wider vectors it extends.
+       */
+      util_cpu_caps.has_avx512f = 0;
+      util_cpu_caps.has_avx512dq = 0;
+      util_cpu_caps.has_avx512cd = 0;
+      util_cpu_caps.has_avx512bw = 0;
+      util_cpu_caps.has_avx512vl = 0;
+   }
 
 #ifdef PIPE_ARCH_PPC_64
    /* Set the NJ bit in VSCR to 0 so denormalized values are handled as
@@ -569,9 +600,11 @@ gallivm_compile_module(struct gallivm_state *gallivm)
    if (gallivm_debug & GALLIVM_DEBUG_PERF)
       time_begin = os_time_get();
 
-   /* Run optimization passes */
+   /* Run optimization passes, unless the object code comes from a cache */
    LLVMInitializeFunctionPassManager(gallivm->passmgr);
    func = LLVMGetFirstFunction(gallivm->module);
+   if (gallivm->cache && gallivm->cache->data_size)
+      func = NULL;
    while (func) {
       if (0) {
          debug_printf("optimizing func %s...\n", LLVMGetValueName(func));
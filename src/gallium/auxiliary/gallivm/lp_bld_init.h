@@ -39,6 +39,21 @@
 extern "C" {
 #endif
 
+/**
+ * Object code of a module, as used by shader caches.  If data_size is
+ * non-zero when the module gets compiled, code generation is skipped and
+ * the object in data is loaded instead.  Otherwise data receives a malloc'ed
+ * copy of the object generated, which the caller owns.
+ */
+struct lp_cached_code
+{
+   void *data;
+   size_t data_size;
+   boolean dont_cache;   /**< code references process-specific addresses */
+   void *jit_obj_cache;
+};
+
+
 struct gallivm_state
 {
    char *module_name;
@@ -50,6 +65,7 @@ struct gallivm_state
    LLVMBuilderRef builder;
    LLVMMCJITMemoryManagerRef memorymgr;
    struct lp_generated_code *code;
+   struct lp_cached_code *cache;   /**< optional, owned by the caller */
    unsigned compiled;
 };
 
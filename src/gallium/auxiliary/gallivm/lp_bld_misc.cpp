@@ -49,6 +49,11 @@
 
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
 
 // Workaround http://llvm.org/PR23628
 #if HAVE_LLVM >= 0x0307
@@ -71,8 +76,12 @@
 #else
 #include <llvm/ExecutionEngine/SectionMemoryManager.h>
 #endif
+#if HAVE_LLVM >= 0x0306
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#endif
 #include <llvm/Support/CommandLine.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/Memory.h>
 #include <llvm/Support/PrettyStackTrace.h>
 
 #include <llvm/Support/TargetSelect.h>
@@ -99,7 +108,9 @@
 #include "pipe/p_config.h"
 #include "util/u_debug.h"
 #include "util/u_cpu_detect.h"
+#include "util/u_math.h"
 
+#include "lp_bld_init.h"
 #include "lp_bld_misc.h"
 
 namespace {
@@ -458,6 +469,203 @@ class ShaderMemoryManager : public DelegatingJITMemoryManager {
 };
 
 
+#if HAVE_LLVM >= 0x0306
+/**
+ * MCJIT object cache backed by a caller provided lp_cached_code, holding
+ * the object code of the single module of an engine.
+ */
+class LPObjectCache : public llvm::ObjectCache {
+   struct lp_cached_code *cache_out;
+
+public:
+   LPObjectCache(struct lp_cached_code *cache) : cache_out(cache) {}
+
+   virtual void notifyObjectCompiled(const llvm::Module *M,
+                                     llvm::MemoryBufferRef Obj) {
+      assert(!cache_out->data);
+      cache_out->data_size = Obj.getBufferSize();
+      cache_out->data = malloc(cache_out->data_size);
+      if (cache_out->data)
+         memcpy(cache_out->data, Obj.getBufferStart(), cache_out->data_size);
+      else
+         cache_out->data_size = 0;
+   }
+
+   virtual std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *M) {
+      if (!cache_out->data_size)
+         return NULL;
+
+      return llvm::MemoryBuffer::getMemBuffer(
+         llvm::StringRef((const char *)cache_out->data, cache_out->data_size),
+         "", false);
+   }
+};
+
+
+/**
+ * Process-wide heap the sections of all MCJIT modules are carved from.
+ *
+ * SectionMemoryManager maps whole pages for the code, read-only and
+ * read-write data of each module, and a manager can't release the memory
+ * of a single module.  Shader modules are small and numerous, so they
+ * share large slabs here instead, and give their ranges back when their
+ * code is freed.  Slabs are mapped readable, writable and executable, as
+ * other modules keep running from a slab while new ones are loaded into
+ * it.  Slabs are never unmapped.
+ */
+class CodeHeap {
+   static const size_t SlabSize = 1024 * 1024;
+
+   mtx_t mutex;
+
+   /** Free ranges, by address */
+   std::map<uint8_t *, size_t> FreeRanges;
+
+   bool addSlab(size_t Size) {
+      std::error_code ec;
+      llvm::sys::MemoryBlock MB = llvm::sys::Memory::allocateMappedMemory(
+         Size, NULL,
+         llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_WRITE |
+         llvm::sys::Memory::MF_EXEC, ec);
+      if (ec)
+         return false;
+
+      insertRange((uint8_t *)MB.base(), MB.size());
+      return true;
+   }
+
+   void insertRange(uint8_t *Addr, size_t Size) {
+      std::map<uint8_t *, size_t>::iterator next = FreeRanges.lower_bound(Addr);
+
+      if (next != FreeRanges.end() && Addr + Size == next->first) {
+         Size += next->second;
+         FreeRanges.erase(next++);
+      }
+      if (next != FreeRanges.begin()) {
+         std::map<uint8_t *, size_t>::iterator prev = next;
+         --prev;
+         if (prev->first + prev->second == Addr) {
+            prev->second += Size;
+            return;
+         }
+      }
+      FreeRanges.insert(next, std::make_pair(Addr, Size));
+   }
+
+   uint8_t *allocFromRanges(size_t Size, size_t Alignment) {
+      std::map<uint8_t *, size_t>::iterator i;
+
+      for (i = FreeRanges.begin(); i != FreeRanges.end(); ++i) {
+         uint8_t *start = i->first;
+         uint8_t *end = start + i->second;
+         uint8_t *ptr = (uint8_t *)
+            (((uintptr_t)start + Alignment - 1) & ~(uintptr_t)(Alignment - 1));
+
+         if (ptr + Size > end)
+            continue;
+
+         FreeRanges.erase(i);
+         if (ptr > start)
+            FreeRanges.insert(std::make_pair(start, ptr - start));
+         if (ptr + Size < end)
+            FreeRanges.insert(std::make_pair(ptr + Size, end - (ptr + Size)));
+         return ptr;
+      }
+
+      return NULL;
+   }
+
+public:
+   bool available;
+
+   CodeHeap() {
+      mtx_init(&mutex, mtx_plain);
+      /* Fails where writable code isn't allowed */
+      available = addSlab(SlabSize);
+   }
+
+   uint8_t *allocate(uintptr_t Size, unsigned Alignment) {
+      uint8_t *ptr;
+
+      Alignment = MAX2(Alignment, 16);
+      Size = MAX2(Size, 1);
+
+      mtx_lock(&mutex);
+      ptr = allocFromRanges(Size, Alignment);
+      if (!ptr && addSlab(MAX2(SlabSize, Size + Alignment)))
+         ptr = allocFromRanges(Size, Alignment);
+      mtx_unlock(&mutex);
+
+      return ptr;
+   }
+
+   void release(uint8_t *Addr, size_t Size) {
+      mtx_lock(&mutex);
+      insertRange(Addr, Size);
+      mtx_unlock(&mutex);
+   }
+};
+
+static CodeHeap *code_heap;
+static once_flag code_heap_once_flag = ONCE_FLAG_INIT;
+
+static void
+init_code_heap(void)
+{
+   code_heap = new CodeHeap();
+}
+
+
+/**
+ * Memory manager of one gallivm module, allocating from the CodeHeap.
+ * Ranges go back to the heap when the manager is deleted, that is when
+ * the module's code is freed.
+ */
+class CodeHeapMemoryManager : public llvm::RTDyldMemoryManager {
+   typedef std::vector<std::pair<uint8_t *, size_t> > RangeVec;
+   RangeVec Ranges;
+   size_t NumFinalized;
+
+   uint8_t *allocate(uintptr_t Size, unsigned Alignment) {
+      uint8_t *ptr = code_heap->allocate(Size, Alignment);
+      if (ptr)
+         Ranges.push_back(std::make_pair(ptr, (size_t)MAX2(Size, 1)));
+      return ptr;
+   }
+
+public:
+   CodeHeapMemoryManager() : NumFinalized(0) {}
+
+   virtual ~CodeHeapMemoryManager() {
+      for (RangeVec::iterator i = Ranges.begin(); i != Ranges.end(); ++i)
+         code_heap->release(i->first, i->second);
+   }
+
+   virtual uint8_t *allocateCodeSection(uintptr_t Size,
+                                        unsigned Alignment,
+                                        unsigned SectionID,
+                                        llvm::StringRef SectionName) {
+      return allocate(Size, Alignment);
+   }
+
+   virtual uint8_t *allocateDataSection(uintptr_t Size,
+                                        unsigned Alignment,
+                                        unsigned SectionID,
+                                        llvm::StringRef SectionName,
+                                        bool IsReadOnly) {
+      return allocate(Size, Alignment);
+   }
+
+   virtual bool finalizeMemory(std::string *ErrMsg = 0) {
+      for (; NumFinalized < Ranges.size(); ++NumFinalized)
+         llvm::sys::Memory::InvalidateInstructionCache(
+            Ranges[NumFinalized].first, Ranges[NumFinalized].second);
+      return false;
+   }
+};
+#endif
+
+
 /**
  * Same as LLVMCreateJITCompilerForModule, but:
  * - allows using MCJIT and enabling AVX feature where available.
@@ -472,6 +680,7 @@ extern "C"
 LLVMBool
 lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
                                         lp_generated_code **OutCode,
+                                        struct lp_cached_code *cache_out,
                                         LLVMModuleRef M,
                                         LLVMMCJITMemoryManagerRef CMM,
                                         unsigned OptLevel,
@@ -583,17 +792,21 @@ lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
       MAttrs.push_back("-fma");
    }
    MAttrs.push_back(util_cpu_caps.has_avx2 ? "+avx2" : "-avx2");
-   /* disable avx512 and all subvariants */
+   /*
+    * The EVEX encodings are used on the existing 128/256-bit vectors too
+    * (AVX512VL), giving 32 vector registers and masked moves.  Exponential
+    * and prefetch subvariants are never used.
+    */
 #if HAVE_LLVM >= 0x0304
-   MAttrs.push_back("-avx512cd");
+   MAttrs.push_back(util_cpu_caps.has_avx512cd ? "+avx512cd" : "-avx512cd");
    MAttrs.push_back("-avx512er");
-   MAttrs.push_back("-avx512f");
+   MAttrs.push_back(util_cpu_caps.has_avx512f ? "+avx512f" : "-avx512f");
    MAttrs.push_back("-avx512pf");
 #endif
 #if HAVE_LLVM >= 0x0305
-   MAttrs.push_back("-avx512bw");
-   MAttrs.push_back("-avx512dq");
-   MAttrs.push_back("-avx512vl");
+   MAttrs.push_back(util_cpu_caps.has_avx512bw ? "+avx512bw" : "-avx512bw");
+   MAttrs.push_back(util_cpu_caps.has_avx512dq ? "+avx512dq" : "-avx512dq");
+   MAttrs.push_back(util_cpu_caps.has_avx512vl ? "+avx512vl" : "-avx512vl");
 #endif
 #endif
 
@@ -663,6 +876,13 @@ lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
    JIT->RegisterJITEventListener(JEL);
 #endif
    if (JIT) {
+#if HAVE_LLVM >= 0x0306
+      if (cache_out && useMCJIT) {
+         LPObjectCache *objcache = new LPObjectCache(cache_out);
+         cache_out->jit_obj_cache = (void *)objcache;
+         JIT->setObjectCache(objcache);
+      }
+#endif
       *OutJIT = wrap(JIT);
       return 0;
    }
@@ -681,6 +901,16 @@ lp_free_generated_code(struct lp_generated_code *code)
    ShaderMemoryManager::freeGeneratedCode(code);
 }
 
+extern "C"
+void
+lp_free_objcache(void *objcache_ptr)
+{
+#if HAVE_LLVM >= 0x0306
+   LPObjectCache *objcache = (LPObjectCache *)objcache_ptr;
+   delete objcache;
+#endif
+}
+
 extern "C"
 LLVMMCJITMemoryManagerRef
 lp_get_default_memory_manager()
@@ -689,7 +919,11 @@ lp_get_default_memory_manager()
 #if HAVE_LLVM < 0x0306
    mm = llvm::JITMemoryManager::CreateDefaultMemManager();
 #else
-   mm = new llvm::SectionMemoryManager();
+   call_once(&code_heap_once_flag, init_code_heap);
+   if (code_heap->available)
+      mm = new CodeHeapMemoryManager();
+   else
+      mm = new llvm::SectionMemoryManager();
 #endif
    return reinterpret_cast<LLVMMCJITMemoryManagerRef>(mm);
 }
@@ -2484,7 +2484,7 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
    enum lp_sampler_op_type op_type;
    LLVMValueRef lod_bias = NULL;
    LLVMValueRef explicit_lod = NULL;
-   boolean op_is_tex;
+   boolean op_is_tex, quad_lod;
 
    if (0) {
       enum pipe_format fmt = static_texture_state->format;
@@ -2639,6 +2639,17 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
     */
    bld.num_mips = bld.num_lods = 1;
 
+   /*
+    * Explicit lod and lod bias are normally evaluated per element. Unless
+    * we got explicit derivatives, a scalar lod gives the same result per
+    * quad, and lod that is only known to be the same within a quad can be
+    * evaluated once per quad too when the user asked for speed.
+    */
+   quad_lod = !derivs &&
+              (lod_property == LP_SAMPLER_LOD_SCALAR ||
+               (lod_property == LP_SAMPLER_LOD_PER_QUAD &&
+                (gallivm_perf & GALLIVM_PERF_QUAD_LOD)));
+
    if ((gallivm_debug & GALLIVM_DEBUG_NO_QUAD_LOD) &&
        (gallivm_debug & GALLIVM_DEBUG_NO_RHO_APPROX) &&
        (static_texture_state->target == PIPE_TEXTURE_CUBE ||
@@ -2656,7 +2667,7 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
       bld.num_lods = type.length;
    }
    else if (lod_property == LP_SAMPLER_LOD_PER_ELEMENT ||
-       (explicit_lod || lod_bias || derivs)) {
+            ((explicit_lod || lod_bias || derivs) && !quad_lod)) {
       if ((!op_is_tex && target != PIPE_BUFFER) ||
           (op_is_tex && mip_filter != PIPE_TEX_MIPFILTER_NONE)) {
          bld.num_mips = type.length;
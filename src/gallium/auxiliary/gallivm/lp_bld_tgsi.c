@@ -488,7 +488,12 @@ lp_build_tgsi_llvm(
       return FALSE;
    }
 
-   tgsi_parse_init( &parse, tokens );
+   if (bld_base->parsed) {
+      assert(bld_base->parsed->Tokens == tokens);
+      tgsi_parse_init_parsed(&parse, bld_base->parsed);
+   } else {
+      tgsi_parse_init( &parse, tokens );
+   }
 
    while( !tgsi_parse_end_of_tokens( &parse ) ) {
       tgsi_parse_token( &parse );
@@ -62,6 +62,7 @@ struct tgsi_full_instruction;
 struct tgsi_full_src_register;
 struct tgsi_opcode_info;
 struct tgsi_token;
+struct tgsi_parsed_shader;
 struct tgsi_shader_info;
 struct lp_build_mask_context;
 struct gallivm_state;
@@ -219,6 +220,7 @@ lp_build_tgsi_info(const struct tgsi_token *tokens,
 void
 lp_build_tgsi_soa(struct gallivm_state *gallivm,
                   const struct tgsi_token *tokens,
+                  const struct tgsi_parsed_shader *parsed,
                   struct lp_type type,
                   struct lp_build_mask_context *mask,
                   LLVMValueRef consts_ptr,
@@ -357,6 +359,9 @@ struct lp_build_tgsi_context
    struct lp_build_tgsi_action dsqrt_action;
    const struct tgsi_shader_info *info;
 
+   /** Optional, the decoded tokens of the shader passed to lp_build_tgsi_llvm */
+   const struct tgsi_parsed_shader *parsed;
+
    lp_build_emit_fetch_fn emit_fetch_funcs[TGSI_FILE_COUNT];
 
    LLVMValueRef (*emit_swizzle)(struct lp_build_tgsi_context *,
@@ -3887,6 +3887,7 @@ static void emit_epilogue(struct lp_build_tgsi_context * bld_base)
 void
 lp_build_tgsi_soa(struct gallivm_state *gallivm,
                   const struct tgsi_token *tokens,
+                  const struct tgsi_parsed_shader *parsed,
                   struct lp_type type,
                   struct lp_build_mask_context *mask,
                   LLVMValueRef consts_ptr,
@@ -4055,6 +4056,7 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
 
    bld.system_values = *system_values;
 
+   bld.bld_base.parsed = parsed;
    lp_build_tgsi_llvm(&bld.bld_base, tokens);
 
    if (0) {
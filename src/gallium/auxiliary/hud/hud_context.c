@@ -64,6 +64,9 @@ struct hud_context {
    struct hud_batch_query_context *batch_query;
    struct list_head pane_list;
 
+   /* CPU time spent in each phase of the frame so far, in nanoseconds */
+   uint64_t frame_phase_time[HUD_NUM_FRAME_PHASES];
+
    /* states */
    struct pipe_blend_state no_blend, alpha_blend;
    struct pipe_depth_stencil_alpha_state dsa;
@@ -1029,6 +1032,11 @@ hud_parse_env_var(struct hud_context *hud, const char *env)
       else if (sscanf(name, "cpu%u%s", &i, s) == 1) {
          hud_cpu_graph_install(pane, i);
       }
+      else if (strcmp(name, "frame-phases") == 0) {
+         for (i = 0; i < HUD_NUM_FRAME_PHASES; i++)
+            hud_frame_phase_graph_install(pane, hud->frame_phase_time, i);
+         pane->type = PIPE_DRIVER_QUERY_TYPE_MICROSECONDS;
+      }
 #if HAVE_GALLIUM_EXTRA_HUD
       else if (sscanf(name, "nic-rx-%s", arg_name) == 1) {
          hud_nic_graph_install(pane, arg_name, NIC_DIRECTION_RX);
@@ -1278,6 +1286,8 @@ print_help(struct pipe_screen *screen)
    puts("  Available names:");
    puts("    fps");
    puts("    cpu");
+   puts("    frame-phases (CPU time of state validation, draws, flushes");
+   puts("                  and fence waits per frame, stacked)");
 
    for (i = 0; i < num_cpus; i++)
       printf("    cpu%i\n", i);
@@ -1543,3 +1553,11 @@ hud_destroy(struct hud_context *hud)
    u_upload_destroy(hud->uploader);
    FREE(hud);
 }
+
+void
+hud_add_frame_phase_time(struct hud_context *hud, enum hud_frame_phase phase,
+                         uint64_t nsecs)
+{
+   assert(phase < HUD_NUM_FRAME_PHASES);
+   hud->frame_phase_time[phase] += nsecs;
+}
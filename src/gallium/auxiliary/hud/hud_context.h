@@ -28,11 +28,17 @@
 #ifndef HUD_CONTEXT_H
 #define HUD_CONTEXT_H
 
+#include <stdint.h>
+
 struct hud_context;
 struct cso_context;
 struct pipe_context;
 struct pipe_resource;
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct hud_context *
 hud_create(struct pipe_context *pipe, struct cso_context *cso);
 
@@ -42,4 +48,21 @@ hud_destroy(struct hud_context *hud);
 void
 hud_draw(struct hud_context *hud, struct pipe_resource *tex);
 
+/* Phases of a frame whose CPU time is reported by the state tracker. */
+enum hud_frame_phase {
+   HUD_FRAME_PHASE_VALIDATE,
+   HUD_FRAME_PHASE_DRAW,
+   HUD_FRAME_PHASE_FLUSH,
+   HUD_FRAME_PHASE_FENCE_WAIT,
+   HUD_NUM_FRAME_PHASES
+};
+
+void
+hud_add_frame_phase_time(struct hud_context *hud, enum hud_frame_phase phase,
+                         uint64_t nsecs);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,124 @@
+/**************************************************************************
+ *
+ * Copyright 2016 The Mesa Project
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/* This file contains code for displaying the CPU time spent in each phase
+ * of a frame, as reported by the state tracker with
+ * hud_add_frame_phase_time.
+ *
+ * The graphs of a pane are stacked: each one shows the time of its phase
+ * plus the time of all the phases before it.
+ */
+
+#include "hud/hud_private.h"
+#include "os/os_time.h"
+#include "util/u_memory.h"
+
+static const char *phase_names[HUD_NUM_FRAME_PHASES] = {
+   "validate",
+   "+draw",
+   "+flush",
+   "+fence-wait",
+};
+
+struct frame_phase_info {
+   const uint64_t *phase_time;
+   enum hud_frame_phase phase;
+   int frames;
+   uint64_t last_time;
+   uint64_t last_total;
+};
+
+static uint64_t
+stacked_time(const struct frame_phase_info *info)
+{
+   uint64_t total = 0;
+   unsigned i;
+
+   for (i = 0; i <= info->phase; i++)
+      total += info->phase_time[i];
+   return total;
+}
+
+static void
+query_frame_phase(struct hud_graph *gr)
+{
+   struct frame_phase_info *info = gr->query_data;
+   uint64_t now = os_time_get();
+
+   info->frames++;
+
+   if (info->last_time) {
+      if (info->last_time + gr->pane->period <= now) {
+         uint64_t total = stacked_time(info);
+
+         /* average per frame, in microseconds */
+         hud_graph_add_value(gr, (total - info->last_total) / 1000 /
+                                 info->frames);
+         info->frames = 0;
+         info->last_time = now;
+         info->last_total = total;
+      }
+   }
+   else {
+      info->last_time = now;
+      info->last_total = stacked_time(info);
+   }
+}
+
+static void
+free_query_data(void *p)
+{
+   FREE(p);
+}
+
+void
+hud_frame_phase_graph_install(struct hud_pane *pane,
+                              const uint64_t *phase_time,
+                              enum hud_frame_phase phase)
+{
+   struct hud_graph *gr = CALLOC_STRUCT(hud_graph);
+   struct frame_phase_info *info;
+
+   if (!gr)
+      return;
+
+   strcpy(gr->name, phase_names[phase]);
+   gr->query_data = CALLOC_STRUCT(frame_phase_info);
+   if (!gr->query_data) {
+      FREE(gr);
+      return;
+   }
+
+   info = gr->query_data;
+   info->phase_time = phase_time;
+   info->phase = phase;
+
+   gr->query_new_value = query_frame_phase;
+   gr->free_query_data = free_query_data;
+
+   hud_pane_add_graph(pane, gr);
+}
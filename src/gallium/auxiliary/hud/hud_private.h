@@ -30,6 +30,7 @@
 
 #include "pipe/p_context.h"
 #include "util/list.h"
+#include "hud/hud_context.h"
 
 struct hud_graph {
    /* initialized by common code */
@@ -89,6 +90,9 @@ int hud_get_num_cpus(void);
 
 void hud_fps_graph_install(struct hud_pane *pane);
 void hud_cpu_graph_install(struct hud_pane *pane, unsigned cpu_index);
+void hud_frame_phase_graph_install(struct hud_pane *pane,
+                                   const uint64_t *phase_time,
+                                   enum hud_frame_phase phase);
 void hud_pipe_query_install(struct hud_batch_query_context **pbq,
                             struct hud_pane *pane, struct pipe_context *pipe,
                             const char *name, unsigned query_type,
@@ -85,6 +85,7 @@ def prolog():
 #include "util/u_debug.h"
 #include "pipe/p_defines.h"
 #include "util/u_memory.h"
+#include "util/u_cpu_detect.h"
 
 
 static unsigned out_size_idx( unsigned index_size )
@@ -476,6 +477,11 @@ def emit_init():
     print '  if (!firsttime) return;'
     print '  firsttime = 0;'
     emit_all_inits()
+    print '#if defined(USE_SSE41)'
+    print '  util_cpu_detect();'
+    print '  if (util_cpu_caps.has_sse4_1)'
+    print '    u_index_init_sse41(translate, generate);'
+    print '#endif'
     print '}'
 
 
@@ -40,4 +40,14 @@
 
 #define PRIM_COUNT   (PIPE_PRIM_TRIANGLE_STRIP_ADJACENCY + 1)
 
+
+#if defined(USE_SSE41)
+/* Overrides the generic translators and generators with the SSE4.1 ones
+ * where there is one.  Only call this if the CPU supports SSE4.1.
+ */
+void
+u_index_init_sse41(u_translate_func translate[IN_COUNT][OUT_COUNT][PV_COUNT][PV_COUNT][PR_COUNT][PRIM_COUNT],
+                   u_generate_func generate[OUT_COUNT][PV_COUNT][PV_COUNT][PRIM_COUNT]);
+#endif
+
 #endif
@@ -0,0 +1,365 @@
+/*
+ * Copyright 2016 The Mesa Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * on the rights to use, copy, modify, merge, publish, distribute, sub
+ * license, and/or sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.  IN NO EVENT SHALL
+ * VMWARE AND/OR THEIR SUPPLIERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * SSE4.1 versions of the most used index translators and generators.
+ *
+ * Only the conversions which keep the provoking vertex and produce ushort
+ * indices are covered: triangle fans and quads to triangles, and ubyte to
+ * ushort widening.  They produce exactly the same output as the generated
+ * C functions, which remain in use for everything else and for the tails
+ * of the lists.
+ *
+ * This file is built with -msse4.1, the functions must only be installed
+ * after checking util_cpu_caps.has_sse4_1.
+ */
+
+#include <smmintrin.h>
+
+#include "indices/u_indices.h"
+#include "indices/u_indices_priv.h"
+
+
+/* Shuffle control moving 16-bit word s to the destination word. */
+#define W(s) (char)(2 * (s)), (char)(2 * (s) + 1)
+/* Shuffle control zeroing the destination word. */
+#define Z    (char)0x80, (char)0x80
+
+
+static inline __m128i
+load8_ushort(const ushort *in)
+{
+   return _mm_loadu_si128((const __m128i *)in);
+}
+
+static inline __m128i
+load8_ubyte(const ubyte *in)
+{
+   return _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)in));
+}
+
+
+/**
+ * Eight triangles (s, a[1], a[2]), ..., (s, a[8], a[9]) from v = a[1..8] and
+ * w = a[2..9], where s is the fan center.
+ */
+static inline void
+emit_trifan8(__m128i s, __m128i v, __m128i w, ushort *out)
+{
+   const __m128i shuf0 = _mm_setr_epi8(Z,    W(0), W(1), Z,    W(1), W(2), Z,    W(2));
+   const __m128i shuf1 = _mm_setr_epi8(W(3), Z,    W(3), W(4), Z,    W(4), W(5), Z   );
+   const __m128i shuf2 = _mm_setr_epi8(W(4), W(5), Z,    W(5), W(6), Z,    W(6), W(7));
+
+   _mm_storeu_si128((__m128i *)(out + 0),
+                    _mm_blend_epi16(_mm_shuffle_epi8(v, shuf0), s, 0x49));
+   _mm_storeu_si128((__m128i *)(out + 8),
+                    _mm_blend_epi16(_mm_shuffle_epi8(v, shuf1), s, 0x92));
+   _mm_storeu_si128((__m128i *)(out + 16),
+                    _mm_blend_epi16(_mm_shuffle_epi8(w, shuf2), s, 0x24));
+}
+
+static void
+translate_trifan_ushort2ushort(const void *_in,
+                               unsigned start,
+                               unsigned in_nr,
+                               unsigned out_nr,
+                               unsigned restart_index,
+                               void *_out)
+{
+   const ushort *in = (const ushort *)_in;
+   ushort *out = (ushort *)_out;
+   const __m128i s = _mm_set1_epi16(in[start]);
+   unsigned i, j;
+
+   for (i = start, j = 0; j + 24 <= out_nr; j += 24, i += 8)
+      emit_trifan8(s, load8_ushort(in + i + 1), load8_ushort(in + i + 2),
+                   out + j);
+
+   for (; j < out_nr; j += 3, i++) {
+      out[j + 0] = in[start];
+      out[j + 1] = in[i + 1];
+      out[j + 2] = in[i + 2];
+   }
+}
+
+static void
+translate_trifan_ubyte2ushort(const void *_in,
+                              unsigned start,
+                              unsigned in_nr,
+                              unsigned out_nr,
+                              unsigned restart_index,
+                              void *_out)
+{
+   const ubyte *in = (const ubyte *)_in;
+   ushort *out = (ushort *)_out;
+   const __m128i s = _mm_set1_epi16(in[start]);
+   unsigned i, j;
+
+   for (i = start, j = 0; j + 24 <= out_nr; j += 24, i += 8)
+      emit_trifan8(s, load8_ubyte(in + i + 1), load8_ubyte(in + i + 2),
+                   out + j);
+
+   for (; j < out_nr; j += 3, i++) {
+      out[j + 0] = in[start];
+      out[j + 1] = in[i + 1];
+      out[j + 2] = in[i + 2];
+   }
+}
+
+
+/**
+ * Four quads split in two triangles each, from q0 holding the first two
+ * quads and q1 the last two.  With the first provoking vertex a quad
+ * (v0, v1, v2, v3) becomes (v0, v1, v2), (v0, v2, v3), with the last one it
+ * becomes (v0, v1, v3), (v1, v2, v3), like the generated code does.
+ */
+static inline void
+emit_quads4_first(__m128i q0, __m128i q1, ushort *out)
+{
+   const __m128i shuf0  = _mm_setr_epi8(W(0), W(1), W(2), W(0), W(2), W(3), W(4), W(5));
+   const __m128i shuf1a = _mm_setr_epi8(W(6), W(4), W(6), W(7), Z,    Z,    Z,    Z   );
+   const __m128i shuf1b = _mm_setr_epi8(Z,    Z,    Z,    Z,    W(0), W(1), W(2), W(0));
+   const __m128i shuf2  = _mm_setr_epi8(W(2), W(3), W(4), W(5), W(6), W(4), W(6), W(7));
+
+   _mm_storeu_si128((__m128i *)(out + 0), _mm_shuffle_epi8(q0, shuf0));
+   _mm_storeu_si128((__m128i *)(out + 8),
+                    _mm_or_si128(_mm_shuffle_epi8(q0, shuf1a),
+                                 _mm_shuffle_epi8(q1, shuf1b)));
+   _mm_storeu_si128((__m128i *)(out + 16), _mm_shuffle_epi8(q1, shuf2));
+}
+
+static inline void
+emit_quads4_last(__m128i q0, __m128i q1, ushort *out)
+{
+   const __m128i shuf0  = _mm_setr_epi8(W(0), W(1), W(3), W(1), W(2), W(3), W(4), W(5));
+   const __m128i shuf1a = _mm_setr_epi8(W(7), W(5), W(6), W(7), Z,    Z,    Z,    Z   );
+   const __m128i shuf1b = _mm_setr_epi8(Z,    Z,    Z,    Z,    W(0), W(1), W(3), W(1));
+   const __m128i shuf2  = _mm_setr_epi8(W(2), W(3), W(4), W(5), W(7), W(5), W(6), W(7));
+
+   _mm_storeu_si128((__m128i *)(out + 0), _mm_shuffle_epi8(q0, shuf0));
+   _mm_storeu_si128((__m128i *)(out + 8),
+                    _mm_or_si128(_mm_shuffle_epi8(q0, shuf1a),
+                                 _mm_shuffle_epi8(q1, shuf1b)));
+   _mm_storeu_si128((__m128i *)(out + 16), _mm_shuffle_epi8(q1, shuf2));
+}
+
+#define TRANSLATE_QUADS(intype, pv, PV)                                     \
+static void                                                                 \
+translate_quads_##intype##2ushort_##pv(const void *_in,                     \
+                                       unsigned start,                      \
+                                       unsigned in_nr,                      \
+                                       unsigned out_nr,                     \
+                                       unsigned restart_index,              \
+                                       void *_out)                          \
+{                                                                           \
+   const intype *in = (const intype *)_in;                                  \
+   ushort *out = (ushort *)_out;                                            \
+   unsigned i, j;                                                           \
+                                                                            \
+   for (i = start, j = 0; j + 24 <= out_nr; j += 24, i += 16)               \
+      emit_quads4_##pv(load8_##intype(in + i), load8_##intype(in + i + 8),  \
+                       out + j);                                            \
+                                                                            \
+   for (; j < out_nr; j += 6, i += 4) {                                     \
+      if (PV == PV_FIRST) {                                                 \
+         out[j + 0] = in[i + 0];                                            \
+         out[j + 1] = in[i + 1];                                            \
+         out[j + 2] = in[i + 2];                                            \
+         out[j + 3] = in[i + 0];                                            \
+         out[j + 4] = in[i + 2];                                            \
+         out[j + 5] = in[i + 3];                                            \
+      } else {                                                              \
+         out[j + 0] = in[i + 0];                                            \
+         out[j + 1] = in[i + 1];                                            \
+         out[j + 2] = in[i + 3];                                            \
+         out[j + 3] = in[i + 1];                                            \
+         out[j + 4] = in[i + 2];                                            \
+         out[j + 5] = in[i + 3];                                            \
+      }                                                                     \
+   }                                                                        \
+}
+
+TRANSLATE_QUADS(ushort, first, PV_FIRST)
+TRANSLATE_QUADS(ushort, last, PV_LAST)
+TRANSLATE_QUADS(ubyte, first, PV_FIRST)
+TRANSLATE_QUADS(ubyte, last, PV_LAST)
+
+
+/**
+ * Widening of ubyte indices for the primitives which are passed through
+ * unchanged.  Like the generated functions, these write out[i] for
+ * i in [start, start + out_nr).
+ */
+static void
+translate_linear_ubyte2ushort(const void *_in,
+                              unsigned start,
+                              unsigned in_nr,
+                              unsigned out_nr,
+                              unsigned restart_index,
+                              void *_out)
+{
+   const ubyte *in = (const ubyte *)_in;
+   ushort *out = (ushort *)_out;
+   const unsigned end = start + out_nr;
+   const __m128i zero = _mm_setzero_si128();
+   unsigned i;
+
+   for (i = start; i + 16 <= end; i += 16) {
+      const __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+
+      _mm_storeu_si128((__m128i *)(out + i), _mm_unpacklo_epi8(v, zero));
+      _mm_storeu_si128((__m128i *)(out + i + 8), _mm_unpackhi_epi8(v, zero));
+   }
+
+   for (; i < end; i++)
+      out[i] = in[i];
+}
+
+
+/**
+ * Index generators.  The output only depends on start, so it is the sum of
+ * a fixed pattern and of a per-iteration step: p[k] holds the first 24
+ * indices and inc[k] how much they grow every 24 indices.
+ */
+static inline void
+generate_pattern(const __m128i p[3], const __m128i inc[3],
+                 unsigned out_nr, ushort *out)
+{
+   __m128i v0 = p[0], v1 = p[1], v2 = p[2];
+   unsigned j;
+
+   for (j = 0; j + 24 <= out_nr; j += 24) {
+      _mm_storeu_si128((__m128i *)(out + j + 0), v0);
+      _mm_storeu_si128((__m128i *)(out + j + 8), v1);
+      _mm_storeu_si128((__m128i *)(out + j + 16), v2);
+      v0 = _mm_add_epi16(v0, inc[0]);
+      v1 = _mm_add_epi16(v1, inc[1]);
+      v2 = _mm_add_epi16(v2, inc[2]);
+   }
+}
+
+static void
+generate_trifan_ushort(unsigned start, unsigned out_nr, void *_out)
+{
+   ushort *out = (ushort *)_out;
+   const __m128i s = _mm_set1_epi16(start);
+   const __m128i p[3] = {
+      _mm_add_epi16(s, _mm_setr_epi16(0, 1, 2, 0, 2, 3, 0, 3)),
+      _mm_add_epi16(s, _mm_setr_epi16(4, 0, 4, 5, 0, 5, 6, 0)),
+      _mm_add_epi16(s, _mm_setr_epi16(6, 7, 0, 7, 8, 0, 8, 9)),
+   };
+   const __m128i inc[3] = {
+      _mm_setr_epi16(0, 8, 8, 0, 8, 8, 0, 8),
+      _mm_setr_epi16(8, 0, 8, 8, 0, 8, 8, 0),
+      _mm_setr_epi16(8, 8, 0, 8, 8, 0, 8, 8),
+   };
+   unsigned i, j = out_nr - out_nr % 24;
+
+   generate_pattern(p, inc, out_nr, out);
+
+   for (i = start + j / 3; j < out_nr; j += 3, i++) {
+      out[j + 0] = (ushort)start;
+      out[j + 1] = (ushort)(i + 1);
+      out[j + 2] = (ushort)(i + 2);
+   }
+}
+
+#define GENERATE_QUADS(pv, a, b, c, d, e, f)                            \
+static void                                                                 \
+generate_quads_ushort_##pv(unsigned start, unsigned out_nr, void *_out)     \
+{                                                                           \
+   ushort *out = (ushort *)_out;                                            \
+   const __m128i s = _mm_set1_epi16(start);                                 \
+   const __m128i p[3] = {                                                   \
+      _mm_add_epi16(s, _mm_setr_epi16(a, b, c, d, e, f, a + 4, b + 4)),     \
+      _mm_add_epi16(s, _mm_setr_epi16(c + 4, d + 4, e + 4, f + 4,           \
+                                      a + 8, b + 8, c + 8, d + 8)),         \
+      _mm_add_epi16(s, _mm_setr_epi16(e + 8, f + 8, a + 12, b + 12,         \
+                                      c + 12, d + 12, e + 12, f + 12)),     \
+   };                                                                       \
+   const __m128i inc[3] = {                                                 \
+      _mm_set1_epi16(16), _mm_set1_epi16(16), _mm_set1_epi16(16),           \
+   };                                                                       \
+   unsigned i, j = out_nr - out_nr % 24;                                    \
+                                                                            \
+   generate_pattern(p, inc, out_nr, out);                                   \
+                                                                            \
+   for (i = start + j / 6 * 4; j < out_nr; j += 6, i += 4) {                \
+      out[j + 0] = (ushort)(i + a);                                         \
+      out[j + 1] = (ushort)(i + b);                                         \
+      out[j + 2] = (ushort)(i + c);                                         \
+      out[j + 3] = (ushort)(i + d);                                         \
+      out[j + 4] = (ushort)(i + e);                                         \
+      out[j + 5] = (ushort)(i + f);                                         \
+   }                                                                        \
+}
+
+GENERATE_QUADS(first, 0, 1, 2, 0, 2, 3)
+GENERATE_QUADS(last, 0, 1, 3, 1, 2, 3)
+
+
+void
+u_index_init_sse41(u_translate_func translate[IN_COUNT][OUT_COUNT][PV_COUNT][PV_COUNT][PR_COUNT][PRIM_COUNT],
+                   u_generate_func generate[OUT_COUNT][PV_COUNT][PV_COUNT][PRIM_COUNT])
+{
+   static const enum pipe_prim_type linear_prims[] = {
+      PIPE_PRIM_POINTS,
+      PIPE_PRIM_LINES,
+      PIPE_PRIM_TRIANGLES,
+      PIPE_PRIM_LINES_ADJACENCY,
+      PIPE_PRIM_TRIANGLES_ADJACENCY,
+   };
+   unsigned pv, pr, k;
+
+   for (pv = 0; pv < PV_COUNT; pv++) {
+      /* Fans don't look at the restart index, quads do. */
+      for (pr = 0; pr < PR_COUNT; pr++) {
+         translate[IN_USHORT][OUT_USHORT][pv][pv][pr][PIPE_PRIM_TRIANGLE_FAN] =
+            translate_trifan_ushort2ushort;
+         translate[IN_UBYTE][OUT_USHORT][pv][pv][pr][PIPE_PRIM_TRIANGLE_FAN] =
+            translate_trifan_ubyte2ushort;
+
+         for (k = 0; k < ARRAY_SIZE(linear_prims); k++)
+            translate[IN_UBYTE][OUT_USHORT][pv][pv][pr][linear_prims[k]] =
+               translate_linear_ubyte2ushort;
+      }
+
+      generate[OUT_USHORT][pv][pv][PIPE_PRIM_TRIANGLE_FAN] =
+         generate_trifan_ushort;
+   }
+
+   translate[IN_USHORT][OUT_USHORT][PV_FIRST][PV_FIRST][PR_DISABLE][PIPE_PRIM_QUADS] =
+      translate_quads_ushort2ushort_first;
+   translate[IN_USHORT][OUT_USHORT][PV_LAST][PV_LAST][PR_DISABLE][PIPE_PRIM_QUADS] =
+      translate_quads_ushort2ushort_last;
+   translate[IN_UBYTE][OUT_USHORT][PV_FIRST][PV_FIRST][PR_DISABLE][PIPE_PRIM_QUADS] =
+      translate_quads_ubyte2ushort_first;
+   translate[IN_UBYTE][OUT_USHORT][PV_LAST][PV_LAST][PR_DISABLE][PIPE_PRIM_QUADS] =
+      translate_quads_ubyte2ushort_last;
+
+   generate[OUT_USHORT][PV_FIRST][PV_FIRST][PIPE_PRIM_QUADS] =
+      generate_quads_ushort_first;
+   generate[OUT_USHORT][PV_LAST][PV_LAST][PIPE_PRIM_QUADS] =
+      generate_quads_ushort_last;
+}
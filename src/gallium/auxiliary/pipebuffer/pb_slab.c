@@ -85,29 +85,30 @@ pb_slabs_reclaim_locked(struct pb_slabs *slabs)
    }
 }
 
-/* Allocate a slab entry of the given size from the given heap.
- *
- * This will try to re-use entries that have previously been freed. However,
- * if no entries are free (or all free entries are still "in flight" as
- * determined by the can_reclaim fallback function), a new slab will be
- * requested via the slab_alloc callback.
- *
- * Note that slab_free can also be called by this function.
- */
-struct pb_slab_entry *
-pb_slab_alloc(struct pb_slabs *slabs, unsigned size, unsigned heap)
+static unsigned
+pb_slab_group_index(struct pb_slabs *slabs, unsigned size, unsigned heap,
+                    unsigned *order)
 {
-   unsigned order = MAX2(slabs->min_order, util_logbase2_ceil(size));
-   unsigned group_index;
-   struct pb_slab_group *group;
-   struct pb_slab *slab;
-   struct pb_slab_entry *entry;
+   *order = MAX2(slabs->min_order, util_logbase2_ceil(size));
 
-   assert(order < slabs->min_order + slabs->num_orders);
+   assert(*order < slabs->min_order + slabs->num_orders);
    assert(heap < slabs->num_heaps);
 
-   group_index = heap * slabs->num_orders + (order - slabs->min_order);
-   group = &slabs->groups[group_index];
+   return heap * slabs->num_orders + (*order - slabs->min_order);
+}
+
+/* Move up to max free entries of the given group to the dst list, allocating
+ * a new slab if there are none. Returns the number of entries moved.
+ */
+static unsigned
+pb_slab_alloc_entries(struct pb_slabs *slabs, unsigned size, unsigned heap,
+                      struct list_head *dst, unsigned max)
+{
+   unsigned order;
+   unsigned group_index = pb_slab_group_index(slabs, size, heap, &order);
+   struct pb_slab_group *group = &slabs->groups[group_index];
+   struct pb_slab *slab;
+   unsigned count = 0;
 
    pipe_mutex_lock(slabs->mutex);
 
@@ -138,19 +139,47 @@ pb_slab_alloc(struct pb_slabs *slabs, unsigned size, unsigned heap)
       pipe_mutex_unlock(slabs->mutex);
       slab = slabs->slab_alloc(slabs->priv, heap, 1 << order, group_index);
       if (!slab)
-         return NULL;
+         return 0;
       pipe_mutex_lock(slabs->mutex);
 
       LIST_ADD(&slab->head, &group->slabs);
    }
 
-   entry = LIST_ENTRY(struct pb_slab_entry, slab->free.next, head);
-   LIST_DEL(&entry->head);
-   slab->num_free--;
+   /* Only take entries from the first slab, for locality. */
+   while (count < max && !LIST_IS_EMPTY(&slab->free)) {
+      struct pb_slab_entry *entry =
+         LIST_ENTRY(struct pb_slab_entry, slab->free.next, head);
+
+      LIST_DEL(&entry->head);
+      LIST_ADDTAIL(&entry->head, dst);
+      slab->num_free--;
+      count++;
+   }
 
    pipe_mutex_unlock(slabs->mutex);
 
-   return entry;
+   return count;
+}
+
+/* Allocate a slab entry of the given size from the given heap.
+ *
+ * This will try to re-use entries that have previously been freed. However,
+ * if no entries are free (or all free entries are still "in flight" as
+ * determined by the can_reclaim fallback function), a new slab will be
+ * requested via the slab_alloc callback.
+ *
+ * Note that slab_free can also be called by this function.
+ */
+struct pb_slab_entry *
+pb_slab_alloc(struct pb_slabs *slabs, unsigned size, unsigned heap)
+{
+   struct list_head entries;
+
+   LIST_INITHEAD(&entries);
+   if (!pb_slab_alloc_entries(slabs, size, heap, &entries, 1))
+      return NULL;
+
+   return LIST_ENTRY(struct pb_slab_entry, entries.next, head);
 }
 
 /* Free the given slab entry.
@@ -181,6 +210,132 @@ pb_slabs_reclaim(struct pb_slabs *slabs)
    pipe_mutex_unlock(slabs->mutex);
 }
 
+/* Initialize a magazine for the given slabs manager.
+ *
+ * A magazine keeps a few free entries of every group, and batches the entries
+ * freed through it, so that most allocations and frees don't need to take
+ * the manager's mutex. A magazine is not thread-safe: it is meant to be owned
+ * by a single thread at a time, typically by a context.
+ */
+bool
+pb_slab_magazine_init(struct pb_slab_magazine *mag, struct pb_slabs *slabs)
+{
+   unsigned num_groups = slabs->num_orders * slabs->num_heaps;
+   unsigned i;
+
+   mag->slabs = slabs;
+   mag->cached = CALLOC(num_groups, sizeof(*mag->cached));
+   mag->num_cached = CALLOC(num_groups, sizeof(*mag->num_cached));
+   if (!mag->cached || !mag->num_cached) {
+      FREE(mag->cached);
+      FREE(mag->num_cached);
+      return false;
+   }
+
+   for (i = 0; i < num_groups; ++i)
+      LIST_INITHEAD(&mag->cached[i]);
+
+   LIST_INITHEAD(&mag->freed);
+   mag->num_freed = 0;
+
+   return true;
+}
+
+/* Return all entries held by the magazine to the slabs manager.
+ */
+void
+pb_slab_magazine_flush(struct pb_slab_magazine *mag)
+{
+   struct pb_slabs *slabs = mag->slabs;
+   unsigned num_groups = slabs->num_orders * slabs->num_heaps;
+   unsigned i;
+
+   pipe_mutex_lock(slabs->mutex);
+
+   /* Cached entries are free already, give them back to their slab. */
+   for (i = 0; i < num_groups; ++i) {
+      while (!LIST_IS_EMPTY(&mag->cached[i])) {
+         struct pb_slab_entry *entry =
+            LIST_ENTRY(struct pb_slab_entry, mag->cached[i].next, head);
+         pb_slab_reclaim(slabs, entry);
+      }
+      mag->num_cached[i] = 0;
+   }
+
+   if (mag->num_freed) {
+      list_splicetail(&mag->freed, &slabs->reclaim);
+      LIST_INITHEAD(&mag->freed);
+      mag->num_freed = 0;
+   }
+
+   pipe_mutex_unlock(slabs->mutex);
+}
+
+void
+pb_slab_magazine_deinit(struct pb_slab_magazine *mag)
+{
+   pb_slab_magazine_flush(mag);
+   FREE(mag->cached);
+   FREE(mag->num_cached);
+}
+
+/* Like pb_slab_alloc, but serve the allocation from the magazine if possible,
+ * and refill it with a batch of entries otherwise.
+ */
+struct pb_slab_entry *
+pb_slab_magazine_alloc(struct pb_slab_magazine *mag, unsigned size,
+                       unsigned heap)
+{
+   unsigned order;
+   unsigned group_index =
+      pb_slab_group_index(mag->slabs, size, heap, &order);
+   struct list_head *cached = &mag->cached[group_index];
+   struct pb_slab_entry *entry;
+
+   if (LIST_IS_EMPTY(cached)) {
+      /* Hand the pending frees over first, so that they can be reclaimed by
+       * the refill.
+       */
+      if (mag->num_freed) {
+         pipe_mutex_lock(mag->slabs->mutex);
+         list_splicetail(&mag->freed, &mag->slabs->reclaim);
+         pipe_mutex_unlock(mag->slabs->mutex);
+         LIST_INITHEAD(&mag->freed);
+         mag->num_freed = 0;
+      }
+
+      mag->num_cached[group_index] =
+         pb_slab_alloc_entries(mag->slabs, size, heap, cached,
+                               PB_SLAB_MAGAZINE_SIZE);
+      if (!mag->num_cached[group_index])
+         return NULL;
+   }
+
+   entry = LIST_ENTRY(struct pb_slab_entry, cached->next, head);
+   LIST_DEL(&entry->head);
+   mag->num_cached[group_index]--;
+
+   return entry;
+}
+
+/* Like pb_slab_free. The entries are handed to the slabs manager in batches,
+ * in the order in which they were freed.
+ */
+void
+pb_slab_magazine_free(struct pb_slab_magazine *mag,
+                      struct pb_slab_entry *entry)
+{
+   LIST_ADDTAIL(&entry->head, &mag->freed);
+
+   if (++mag->num_freed >= PB_SLAB_MAGAZINE_SIZE) {
+      pipe_mutex_lock(mag->slabs->mutex);
+      list_splicetail(&mag->freed, &mag->slabs->reclaim);
+      pipe_mutex_unlock(mag->slabs->mutex);
+      LIST_INITHEAD(&mag->freed);
+      mag->num_freed = 0;
+   }
+}
+
 /* Initialize the slabs manager.
  *
  * The minimum and maximum size of slab entries are 2^min_order and
@@ -233,7 +388,7 @@ pb_slabs_init(struct pb_slabs *slabs,
  *
  * This will free all allocated slabs and internal structures, even if some
  * of the slab entries are still in flight (i.e. if can_reclaim would return
- * false).
+ * false). All magazines must have been deinitialized before.
  */
 void
 pb_slabs_deinit(struct pb_slabs *slabs)
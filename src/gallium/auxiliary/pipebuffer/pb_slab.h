@@ -131,6 +131,29 @@ struct pb_slabs
    slab_free_fn *slab_free;
 };
 
+/* Number of entries a magazine keeps per group, and number of frees it
+ * batches before handing them to the manager.
+ */
+#define PB_SLAB_MAGAZINE_SIZE 8
+
+/* Single-threaded cache in front of a pb_slabs manager, see
+ * pb_slab_magazine_init.
+ */
+struct pb_slab_magazine
+{
+   struct pb_slabs *slabs;
+
+   /* Free entries taken from the manager, one list per group. */
+   struct list_head *cached;
+   unsigned *num_cached;
+
+   /* Entries freed through this magazine and not yet handed to the manager's
+    * reclaim list.
+    */
+   struct list_head freed;
+   unsigned num_freed;
+};
+
 struct pb_slab_entry *
 pb_slab_alloc(struct pb_slabs *slabs, unsigned size, unsigned heap);
 
@@ -152,4 +175,21 @@ pb_slabs_init(struct pb_slabs *slabs,
 void
 pb_slabs_deinit(struct pb_slabs *slabs);
 
+bool
+pb_slab_magazine_init(struct pb_slab_magazine *mag, struct pb_slabs *slabs);
+
+void
+pb_slab_magazine_deinit(struct pb_slab_magazine *mag);
+
+void
+pb_slab_magazine_flush(struct pb_slab_magazine *mag);
+
+struct pb_slab_entry *
+pb_slab_magazine_alloc(struct pb_slab_magazine *mag, unsigned size,
+                       unsigned heap);
+
+void
+pb_slab_magazine_free(struct pb_slab_magazine *mag,
+                      struct pb_slab_entry *entry);
+
 #endif
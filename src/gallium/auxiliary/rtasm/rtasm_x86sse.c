@@ -1490,6 +1490,17 @@ void sse2_por( struct x86_function *p, struct x86_reg dst, struct x86_reg src )
    emit_modrm(p, dst, src);
 }
 
+/* VEX.128.66.0F38.W0 13 /r -- only the low 4 halves of src are converted.
+ * No extended registers, so the inverted R, X, B bits are all set.
+ */
+void f16c_vcvtph2ps( struct x86_function *p, struct x86_reg dst, struct x86_reg src )
+{
+   DUMP_RR(dst, src);
+   emit_3ub(p, 0xc4, 0xe2, 0x79);
+   emit_1ub(p, 0x13);
+   emit_modrm(p, dst, src);
+}
+
 void sse2_rcpps( struct x86_function *p,
                  struct x86_reg dst,
                  struct x86_reg src )
@@ -2164,6 +2175,8 @@ static void x86_init_func_common( struct x86_function *p )
       p->caps |= X86_SSE3;
    if(util_cpu_caps.has_sse4_1)
       p->caps |= X86_SSE4_1;
+   if(util_cpu_caps.has_f16c)
+      p->caps |= X86_F16C;
    p->csr = p->store;
    DUMP_START();
 }
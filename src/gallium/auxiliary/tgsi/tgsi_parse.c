@@ -45,6 +45,7 @@ tgsi_parse_init(
 
    ctx->Tokens = tokens;
    ctx->Position = ctx->FullHeader.Header.HeaderSize;
+   ctx->Parsed = NULL;
 
    return TGSI_PARSE_OK;
 }
@@ -55,10 +56,79 @@ tgsi_parse_free(
 {
 }
 
+unsigned
+tgsi_parse_init_parsed(
+   struct tgsi_parse_context *ctx,
+   const struct tgsi_parsed_shader *shader )
+{
+   ctx->Tokens = shader->Tokens;
+   ctx->FullHeader = shader->FullHeader;
+   ctx->Position = 0;
+   ctx->Parsed = shader;
+
+   return TGSI_PARSE_OK;
+}
+
+/**
+ * Decode all the tokens of a shader. The token array must outlive the
+ * result.
+ */
+struct tgsi_parsed_shader *
+tgsi_parse_shader(const struct tgsi_token *tokens)
+{
+   struct tgsi_parse_context parse;
+   struct tgsi_parsed_shader *shader;
+   unsigned n = 0;
+
+   if (tgsi_parse_init(&parse, tokens) != TGSI_PARSE_OK)
+      return NULL;
+
+   while (!tgsi_parse_end_of_tokens(&parse)) {
+      tgsi_parse_token(&parse);
+      n++;
+   }
+
+   shader = CALLOC_STRUCT(tgsi_parsed_shader);
+   if (!shader)
+      return NULL;
+
+   shader->FullTokens = MALLOC(MAX2(n, 1) * sizeof(union tgsi_full_token));
+   if (!shader->FullTokens) {
+      FREE(shader);
+      return NULL;
+   }
+
+   tgsi_parse_init(&parse, tokens);
+   shader->Tokens = tokens;
+   shader->FullHeader = parse.FullHeader;
+   shader->NumTokens = n;
+
+   for (n = 0; n < shader->NumTokens; n++) {
+      tgsi_parse_token(&parse);
+      shader->FullTokens[n] = parse.FullToken;
+   }
+
+   tgsi_parse_free(&parse);
+   return shader;
+}
+
+void
+tgsi_free_parsed_shader(struct tgsi_parsed_shader *shader)
+{
+   if (!shader)
+      return;
+
+   FREE(shader->FullTokens);
+   FREE(shader);
+}
+
 boolean
 tgsi_parse_end_of_tokens(
    struct tgsi_parse_context *ctx )
 {
+   if (ctx->Parsed)
+      return ctx->Position >= ctx->Parsed->NumTokens;
+
    return ctx->Position >=
       ctx->FullHeader.Header.HeaderSize + ctx->FullHeader.Header.BodySize;
 }
@@ -97,6 +167,11 @@ tgsi_parse_token(
    struct tgsi_token token;
    unsigned i;
 
+   if (ctx->Parsed) {
+      ctx->FullToken = ctx->Parsed->FullTokens[ctx->Position++];
+      return;
+   }
+
    next_token( ctx, &token );
 
    switch( token.Type ) {
@@ -112,6 +112,22 @@ struct tgsi_parse_context
    unsigned                   Position;
    struct tgsi_full_header    FullHeader;
    union tgsi_full_token      FullToken;
+
+   /* When set, Position indexes the already decoded tokens of this shader */
+   const struct tgsi_parsed_shader *Parsed;
+};
+
+/**
+ * A shader whose tokens have been decoded once, so that shaders compiled
+ * many times (e.g. for each variant) don't need to be decoded again.
+ * Walk it with tgsi_parse_init_parsed and the usual tgsi_parse_token loop.
+ */
+struct tgsi_parsed_shader
+{
+   const struct tgsi_token    *Tokens;
+   struct tgsi_full_header    FullHeader;
+   unsigned                   NumTokens;
+   union tgsi_full_token      *FullTokens;
 };
 
 #define TGSI_PARSE_OK      0
@@ -126,6 +142,17 @@ void
 tgsi_parse_free(
    struct tgsi_parse_context *ctx );
 
+unsigned
+tgsi_parse_init_parsed(
+   struct tgsi_parse_context *ctx,
+   const struct tgsi_parsed_shader *shader );
+
+struct tgsi_parsed_shader *
+tgsi_parse_shader(const struct tgsi_token *tokens);
+
+void
+tgsi_free_parsed_shader(struct tgsi_parsed_shader *shader);
+
 boolean
 tgsi_parse_end_of_tokens(
    struct tgsi_parse_context *ctx );
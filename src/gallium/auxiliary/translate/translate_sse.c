@@ -64,7 +64,7 @@ struct translate_buffer_variant
 
 #define ELEMENT_BUFFER_INSTANCE_ID  1001
 
-#define NUM_CONSTS 7
+#define NUM_CONSTS 10
 
 enum
 {
@@ -74,7 +74,10 @@ enum
    CONST_INV_32767,
    CONST_INV_65535,
    CONST_INV_2147483647,
-   CONST_255
+   CONST_255,
+   CONST_INV_1023_3,
+   CONST_INV_511_1,
+   CONST_NEG_ONE
 };
 
 #define C(v) {(float)(v), (float)(v), (float)(v), (float)(v)}
@@ -85,7 +88,10 @@ static float consts[NUM_CONSTS][4] = {
    C(1.0 / 32767.0),
    C(1.0 / 65535.0),
    C(1.0 / 2147483647.0),
-   C(255.0)
+   C(255.0),
+   {1.0 / 1023.0, 1.0 / 1023.0, 1.0 / 1023.0, 1.0 / 3.0},
+   {1.0 / 511.0, 1.0 / 511.0, 1.0 / 511.0, 1.0},
+   C(-1.0)
 };
 
 #undef C
@@ -455,6 +461,94 @@ emit_memcpy(struct translate_sse *p, struct x86_reg dst, struct x86_reg src,
    }
 }
 
+/* Channels of the same kind, which only differ in their shift. */
+static boolean
+channels_match(const struct util_format_channel_description *a,
+               const struct util_format_channel_description *b)
+{
+   return a->type == b->type &&
+          a->normalized == b->normalized &&
+          a->pure_integer == b->pure_integer &&
+          a->size == b->size;
+}
+
+
+/* 10_10_10_2 formats, with the channels in their natural order, of
+ * which only the swizzle differs.
+ */
+static boolean
+is_packed_10_10_10_2(const struct util_format_description *desc)
+{
+   unsigned i;
+
+   if (desc->layout != UTIL_FORMAT_LAYOUT_PLAIN ||
+       desc->block.bits != 32 ||
+       desc->nr_channels != 4)
+      return FALSE;
+
+   for (i = 0; i < 4; ++i) {
+      if (desc->channel[i].type != desc->channel[0].type ||
+          desc->channel[i].normalized != desc->channel[0].normalized ||
+          desc->channel[i].pure_integer ||
+          desc->channel[i].size != (i < 3 ? 10 : 2) ||
+          desc->channel[i].shift != i * 10)
+         return FALSE;
+   }
+
+   return desc->channel[0].type == UTIL_FORMAT_TYPE_UNSIGNED ||
+          desc->channel[0].type == UTIL_FORMAT_TYPE_SIGNED;
+}
+
+
+/* Unpack the four channels of a 10_10_10_2 value to floats:
+ *
+ * x x x x
+ * x x>>10 x x>>10
+ * x x>>10 x>>20 x>>30
+ *
+ * followed by a shift back and forth to get rid of the upper channels,
+ * sign extending them for the signed formats.
+ */
+static void
+emit_load_10_10_10_2(struct translate_sse *p, struct x86_reg data,
+                     struct x86_reg src,
+                     const struct util_format_description *desc)
+{
+   struct x86_reg tmpXMM = x86_make_reg(file_XMM, 1);
+   const boolean is_signed = desc->channel[0].type == UTIL_FORMAT_TYPE_SIGNED;
+
+   sse2_movd(p->func, data, src);
+   sse2_pshufd(p->func, data, data, SHUF(X, X, X, X));
+   sse2_movdqa(p->func, tmpXMM, data);
+   if (is_signed)
+      sse2_psrad_imm(p->func, tmpXMM, 10);
+   else
+      sse2_psrld_imm(p->func, tmpXMM, 10);
+   sse2_punpckldq(p->func, data, tmpXMM);
+   sse2_movdqa(p->func, tmpXMM, data);
+   if (is_signed)
+      sse2_psrad_imm(p->func, tmpXMM, 20);
+   else
+      sse2_psrld_imm(p->func, tmpXMM, 20);
+   sse2_punpcklqdq(p->func, data, tmpXMM);
+   sse2_pslld_imm(p->func, data, 22);
+   if (is_signed)
+      sse2_psrad_imm(p->func, data, 22);
+   else
+      sse2_psrld_imm(p->func, data, 22);
+   sse2_cvtdq2ps(p->func, data, data);
+
+   if (desc->channel[0].normalized) {
+      if (is_signed) {
+         sse_mulps(p->func, data, get_const(p, CONST_INV_511_1));
+         sse_maxps(p->func, data, get_const(p, CONST_NEG_ONE));
+      }
+      else
+         sse_mulps(p->func, data, get_const(p, CONST_INV_1023_3));
+   }
+}
+
+
 static boolean
 translate_attr_convert(struct translate_sse *p,
                        const struct translate_element *a,
@@ -471,28 +565,28 @@ translate_attr_convert(struct translate_sse *p,
         PIPE_SWIZZLE_NONE, PIPE_SWIZZLE_NONE };
    unsigned needed_chans = 0;
    unsigned imms[2] = { 0, 0x3f800000 };
+   boolean packed_10_10_10_2;
 
    if (a->output_format == PIPE_FORMAT_NONE
        || a->input_format == PIPE_FORMAT_NONE)
       return FALSE;
 
-   if (input_desc->channel[0].size & 7)
+   packed_10_10_10_2 = is_packed_10_10_10_2(input_desc);
+
+   if ((input_desc->channel[0].size & 7) && !packed_10_10_10_2)
       return FALSE;
 
    if (input_desc->colorspace != output_desc->colorspace)
       return FALSE;
 
-   for (i = 1; i < input_desc->nr_channels; ++i) {
-      if (memcmp
-          (&input_desc->channel[i], &input_desc->channel[0],
-           sizeof(input_desc->channel[0])))
+   for (i = 1; i < input_desc->nr_channels && !packed_10_10_10_2; ++i) {
+      if (!channels_match(&input_desc->channel[i], &input_desc->channel[0]))
          return FALSE;
    }
 
    for (i = 1; i < output_desc->nr_channels; ++i) {
-      if (memcmp
-          (&output_desc->channel[i], &output_desc->channel[0],
-           sizeof(output_desc->channel[0]))) {
+      if (!channels_match(&output_desc->channel[i],
+                          &output_desc->channel[0])) {
          return FALSE;
       }
    }
@@ -527,6 +621,10 @@ translate_attr_convert(struct translate_sse *p,
          case UTIL_FORMAT_TYPE_UNSIGNED:
             if (!(x86_target_caps(p->func) & X86_SSE2))
                return FALSE;
+            if (packed_10_10_10_2) {
+               emit_load_10_10_10_2(p, dataXMM, src, input_desc);
+               break;
+            }
             emit_load_sse2(p, dataXMM, src,
                            input_desc->channel[0].size *
                            input_desc->nr_channels >> 3);
@@ -579,6 +677,10 @@ translate_attr_convert(struct translate_sse *p,
          case UTIL_FORMAT_TYPE_SIGNED:
             if (!(x86_target_caps(p->func) & X86_SSE2))
                return FALSE;
+            if (packed_10_10_10_2) {
+               emit_load_10_10_10_2(p, dataXMM, src, input_desc);
+               break;
+            }
             emit_load_sse2(p, dataXMM, src,
                            input_desc->channel[0].size *
                            input_desc->nr_channels >> 3);
@@ -626,6 +728,17 @@ translate_attr_convert(struct translate_sse *p,
 
             break;
          case UTIL_FORMAT_TYPE_FLOAT:
+            if (input_desc->channel[0].size == 16) {
+               /* missing channels are loaded as zero, and a missing alpha
+                * is stored as an immediate one below
+                */
+               if (!(x86_target_caps(p->func) & X86_F16C))
+                  return FALSE;
+               emit_load_sse2(p, dataXMM, src,
+                              input_desc->nr_channels * 2);
+               f16c_vcvtph2ps(p->func, dataXMM, dataXMM);
+               break;
+            }
             if (input_desc->channel[0].size != 32
                 && input_desc->channel[0].size != 64) {
                return FALSE;
@@ -883,8 +996,8 @@ translate_attr_convert(struct translate_sse *p,
       }
       return TRUE;
    }
-   else if (!memcmp(&output_desc->channel[0], &input_desc->channel[0],
-                    sizeof(output_desc->channel[0]))) {
+   else if (channels_match(&output_desc->channel[0],
+                           &input_desc->channel[0])) {
       struct x86_reg tmp = p->tmp_EAX;
       unsigned i;
 
@@ -32,12 +32,26 @@
 #include "pipe/p_defines.h"
 #include "util/u_inlines.h"
 #include "pipe/p_context.h"
+#include "pipe/p_screen.h"
 #include "util/u_memory.h"
 #include "util/u_math.h"
 
 #include "u_upload_mgr.h"
 
 
+/* Ring mode: the number of flushes whose uploads can be tracked
+ * separately, and the size the ring buffer can grow up to when the GPU
+ * lags behind.
+ */
+#define U_UPLOAD_MAX_FENCES    8
+#define U_UPLOAD_MAX_RING_SIZE (32 * 1024 * 1024)
+
+struct u_upload_fenced_range {
+   struct pipe_fence_handle *fence;
+   unsigned end;  /* offset of the first byte after the range */
+   unsigned lap;
+};
+
 struct u_upload_mgr {
    struct pipe_context *pipe;
 
@@ -52,6 +66,19 @@ struct u_upload_mgr {
    uint8_t *map;    /* Pointer to the mapped upload buffer. */
    unsigned offset; /* Aligned offset to the upload buffer, pointing
                      * at the first unused byte. */
+
+   /* Ring mode. The buffer is reused from the start once the GPU is done
+    * with it: bytes in [tail, offset) are in use when lap == tail_lap,
+    * bytes in [offset, tail) are free when they differ.
+    */
+   boolean ring;
+   unsigned ring_size;
+   unsigned lap;
+   unsigned tail;
+   unsigned tail_lap;
+   /* Fences of the flushes since tail, oldest first. */
+   struct u_upload_fenced_range fences[U_UPLOAD_MAX_FENCES];
+   unsigned num_fences;
 };
 
 
@@ -115,9 +142,133 @@ void u_upload_unmap( struct u_upload_mgr *upload )
 
 static void u_upload_release_buffer(struct u_upload_mgr *upload)
 {
+   struct pipe_screen *screen = upload->pipe->screen;
+   unsigned i;
+
    /* Unmap and unreference the upload buffer. */
    upload_unmap_internal(upload, TRUE);
    pipe_resource_reference( &upload->buffer, NULL );
+
+   for (i = 0; i < upload->num_fences; i++)
+      screen->fence_reference(screen, &upload->fences[i].fence, NULL);
+   upload->num_fences = 0;
+   upload->lap = 0;
+   upload->tail = 0;
+   upload->tail_lap = 0;
+}
+
+
+boolean
+u_upload_enable_ring(struct u_upload_mgr *upload, unsigned size)
+{
+   if (!upload->map_persistent)
+      return FALSE;
+
+   u_upload_release_buffer(upload);
+   upload->ring = TRUE;
+   upload->ring_size = align(size, 4096);
+   return TRUE;
+}
+
+
+void
+u_upload_fence(struct u_upload_mgr *upload, struct pipe_fence_handle *fence)
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+   struct u_upload_fenced_range *range;
+
+   if (!upload->ring || !upload->buffer || !fence)
+      return;
+
+   /* A later fence also covers the uploads of the earlier flushes, so when
+    * out of slots just extend the newest range.
+    */
+   if (upload->num_fences == U_UPLOAD_MAX_FENCES)
+      range = &upload->fences[upload->num_fences - 1];
+   else
+      range = &upload->fences[upload->num_fences++];
+
+   screen->fence_reference(screen, &range->fence, fence);
+   range->end = upload->offset;
+   range->lap = upload->lap;
+}
+
+
+/* Move the tail past the ranges the GPU is done with. */
+static void
+u_upload_ring_reclaim(struct u_upload_mgr *upload)
+{
+   struct pipe_screen *screen = upload->pipe->screen;
+   unsigned i, n = 0;
+
+   while (n < upload->num_fences &&
+          screen->fence_finish(screen, NULL, upload->fences[n].fence, 0)) {
+      upload->tail = upload->fences[n].end;
+      upload->tail_lap = upload->fences[n].lap;
+      screen->fence_reference(screen, &upload->fences[n].fence, NULL);
+      n++;
+   }
+
+   if (!n)
+      return;
+
+   for (i = n; i < upload->num_fences; i++) {
+      upload->fences[i - n] = upload->fences[i];
+      upload->fences[i].fence = NULL;
+   }
+   upload->num_fences -= n;
+}
+
+
+static boolean
+u_upload_ring_fit(struct u_upload_mgr *upload,
+                  unsigned min_out_offset,
+                  unsigned size,
+                  unsigned alignment,
+                  unsigned *out_offset)
+{
+   unsigned offset = MAX2(align(upload->offset, alignment), min_out_offset);
+
+   if (upload->lap == upload->tail_lap) {
+      if (offset + size <= upload->buffer->width0) {
+         *out_offset = offset;
+         return TRUE;
+      }
+
+      /* Wrap around, the start of the buffer must have been released. */
+      if (min_out_offset + size > upload->tail)
+         return FALSE;
+
+      upload->lap++;
+      *out_offset = min_out_offset;
+      return TRUE;
+   }
+
+   if (offset + size > upload->tail)
+      return FALSE;
+
+   *out_offset = offset;
+   return TRUE;
+}
+
+
+static boolean
+u_upload_ring_alloc(struct u_upload_mgr *upload,
+                    unsigned min_out_offset,
+                    unsigned size,
+                    unsigned alignment,
+                    unsigned *out_offset)
+{
+   if (u_upload_ring_fit(upload, min_out_offset, size, alignment, out_offset))
+      return TRUE;
+
+   u_upload_ring_reclaim(upload);
+   if (u_upload_ring_fit(upload, min_out_offset, size, alignment, out_offset))
+      return TRUE;
+
+   /* The GPU lags behind, the next buffer will be larger. */
+   upload->ring_size = MIN2(upload->ring_size * 2, U_UPLOAD_MAX_RING_SIZE);
+   return FALSE;
 }
 
 
@@ -142,7 +293,8 @@ u_upload_alloc_buffer(struct u_upload_mgr *upload,
 
    /* Allocate a new one: 
     */
-   size = align(MAX2(upload->default_size, min_size), 4096);
+   size = align(MAX2(upload->ring ? upload->ring_size : upload->default_size,
+                     min_size), 4096);
 
    memset(&buffer, 0, sizeof buffer);
    buffer.target = PIPE_BUFFER;
@@ -188,15 +340,23 @@ u_upload_alloc(struct u_upload_mgr *upload,
    unsigned buffer_size = upload->buffer ? upload->buffer->width0 : 0;
    unsigned offset;
 
+   boolean fits;
+
    min_out_offset = align(min_out_offset, alignment);
 
-   offset = align(upload->offset, alignment);
-   offset = MAX2(offset, min_out_offset);
+   if (upload->ring && upload->buffer) {
+      fits = u_upload_ring_alloc(upload, min_out_offset, size, alignment,
+                                 &offset);
+   } else {
+      offset = align(upload->offset, alignment);
+      offset = MAX2(offset, min_out_offset);
+      fits = upload->buffer && offset + size <= buffer_size;
+   }
 
    /* Make sure we have enough space in the upload buffer
     * for the sub-allocation.
     */
-   if (unlikely(!upload->buffer || offset + size > buffer_size)) {
+   if (unlikely(!fits)) {
       u_upload_alloc_buffer(upload, min_out_offset + size);
 
       if (unlikely(!upload->buffer)) {
@@ -36,6 +36,7 @@
 #include "pipe/p_defines.h"
 
 struct pipe_context;
+struct pipe_fence_handle;
 struct pipe_resource;
 
 
@@ -56,6 +57,27 @@ u_upload_create(struct pipe_context *pipe, unsigned default_size,
  */
 void u_upload_destroy( struct u_upload_mgr *upload );
 
+/**
+ * Suballocate from a single persistently mapped buffer used as a ring.
+ *
+ * Parts of the buffer are reused once the fences passed to u_upload_fence
+ * have signalled, so in the steady state uploads neither map nor create
+ * buffers. If the ring is full, a new twice as large buffer is allocated.
+ *
+ * \param size  Size of the ring buffer, in bytes.
+ *
+ * Returns FALSE if the driver doesn't support persistent coherent
+ * mappings, in which case the upload manager is unchanged.
+ */
+boolean u_upload_enable_ring(struct u_upload_mgr *upload, unsigned size);
+
+/**
+ * Tell a ring mode upload manager that everything allocated so far is no
+ * longer used by the GPU once \p fence signals.
+ */
+void u_upload_fence(struct u_upload_mgr *upload,
+                    struct pipe_fence_handle *fence);
+
 /**
  * Unmap upload buffer
  *
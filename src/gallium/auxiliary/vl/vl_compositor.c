@@ -269,6 +269,139 @@ create_frag_shader_video_buffer(struct vl_compositor *c)
    return ureg_create_shader_and_destroy(shader, c->pipe);
 }
 
+static void *
+create_frag_shader_video_buffer_bicubic(struct vl_compositor *c)
+{
+   struct pipe_screen *screen = c->pipe->screen;
+   struct ureg_program *shader;
+   struct ureg_src tc;
+   struct ureg_src sampler[3];
+   struct ureg_dst size, inv_size, pos, base, wx, wy, t, coord, row, col, texel;
+   struct ureg_dst fragment;
+   unsigned i, j, k;
+
+   if (!screen->get_shader_param(screen, PIPE_SHADER_FRAGMENT,
+                                 PIPE_SHADER_CAP_INTEGERS))
+      return NULL;
+
+   shader = ureg_create(PIPE_SHADER_FRAGMENT);
+   if (!shader)
+      return NULL;
+
+   tc = ureg_DECL_fs_input(shader, TGSI_SEMANTIC_GENERIC, VS_O_VTEX, TGSI_INTERPOLATE_LINEAR);
+   for (i = 0; i < 3; ++i)
+      sampler[i] = ureg_DECL_sampler(shader, i);
+
+   size = ureg_DECL_temporary(shader);
+   inv_size = ureg_DECL_temporary(shader);
+   pos = ureg_DECL_temporary(shader);
+   base = ureg_DECL_temporary(shader);
+   wx = ureg_DECL_temporary(shader);
+   wy = ureg_DECL_temporary(shader);
+   t = ureg_DECL_temporary(shader);
+   coord = ureg_DECL_temporary(shader);
+   row = ureg_DECL_temporary(shader);
+   col = ureg_DECL_temporary(shader);
+   texel = ureg_DECL_temporary(shader);
+   fragment = ureg_DECL_output(shader, TGSI_SEMANTIC_COLOR, 0);
+
+   ureg_MOV(shader, ureg_writemask(coord, TGSI_WRITEMASK_ZW), tc);
+
+   /* The planes can have different sizes, so each of them is filtered on
+    * its own, with the same Catmull-Rom spline as vl_bicubic_filter.
+    * CSC is affine and the weights sum up to one, so filtering before CSC
+    * gives the same result as filtering the converted picture.
+    */
+   for (i = 0; i < 3; ++i) {
+      /*
+       * size = tex_size(sampler[i])
+       * pos = tc * size - 0.5
+       * t = frac(pos)
+       * base = (floor(pos) - 0.5) / size, the center of the top left texel
+       */
+      ureg_TXQ(shader, size, TGSI_TEXTURE_2D_ARRAY, ureg_imm1u(shader, 0),
+               sampler[i]);
+      ureg_I2F(shader, ureg_writemask(size, TGSI_WRITEMASK_XY), ureg_src(size));
+      ureg_RCP(shader, ureg_writemask(inv_size, TGSI_WRITEMASK_X),
+               ureg_scalar(ureg_src(size), TGSI_SWIZZLE_X));
+      ureg_RCP(shader, ureg_writemask(inv_size, TGSI_WRITEMASK_Y),
+               ureg_scalar(ureg_src(size), TGSI_SWIZZLE_Y));
+      ureg_MAD(shader, ureg_writemask(pos, TGSI_WRITEMASK_XY), tc,
+               ureg_src(size), ureg_imm1f(shader, -0.5f));
+      ureg_FRC(shader, ureg_writemask(t, TGSI_WRITEMASK_XY), ureg_src(pos));
+      ureg_SUB(shader, ureg_writemask(base, TGSI_WRITEMASK_XY),
+               ureg_src(pos), ureg_src(t));
+      ureg_SUB(shader, ureg_writemask(base, TGSI_WRITEMASK_XY),
+               ureg_src(base), ureg_imm1f(shader, 0.5f));
+      ureg_MUL(shader, ureg_writemask(base, TGSI_WRITEMASK_XY),
+               ureg_src(base), ureg_src(inv_size));
+
+      /*
+       * weights of the four taps in each direction
+       * w = 0.5 * |1 t t^2 t^3| * | 0  2  0  0|
+       *                           |-1  0  1  0|
+       *                           | 2 -5  4 -1|
+       *                           |-1  3 -3  1|
+       */
+      for (j = 0; j < 2; ++j) {
+         struct ureg_dst w = j ? wy : wx;
+         struct ureg_src f = ureg_scalar(ureg_src(t), TGSI_SWIZZLE_X + j);
+
+         ureg_MAD(shader, w, ureg_imm4f(shader, -1.0f, 3.0f, -3.0f, 1.0f), f,
+                  ureg_imm4f(shader, 2.0f, -5.0f, 4.0f, -1.0f));
+         ureg_MAD(shader, w, ureg_src(w), f,
+                  ureg_imm4f(shader, -1.0f, 0.0f, 1.0f, 0.0f));
+         ureg_MAD(shader, w, ureg_src(w), f,
+                  ureg_imm4f(shader, 0.0f, 2.0f, 0.0f, 0.0f));
+         ureg_MUL(shader, w, ureg_src(w), ureg_imm1f(shader, 0.5f));
+      }
+
+      /*
+       * row.k = tex(base + (k, j) / size)
+       * col.j = dot(row, wx)
+       * texel.i = dot(col, wy)
+       */
+      for (j = 0; j < 4; ++j) {
+         for (k = 0; k < 4; ++k) {
+            ureg_MAD(shader, ureg_writemask(coord, TGSI_WRITEMASK_XY),
+                     ureg_imm2f(shader, k, j), ureg_src(inv_size), ureg_src(base));
+            /* all the channels of the component views hold the sample,
+             * except alpha */
+            if (k < 3) {
+               ureg_TEX(shader, ureg_writemask(row, TGSI_WRITEMASK_X << k),
+                        TGSI_TEXTURE_2D_ARRAY, ureg_src(coord), sampler[i]);
+            } else {
+               ureg_TEX(shader, ureg_writemask(pos, TGSI_WRITEMASK_X),
+                        TGSI_TEXTURE_2D_ARRAY, ureg_src(coord), sampler[i]);
+               ureg_MOV(shader, ureg_writemask(row, TGSI_WRITEMASK_W),
+                        ureg_scalar(ureg_src(pos), TGSI_SWIZZLE_X));
+            }
+         }
+         ureg_DP4(shader, ureg_writemask(col, TGSI_WRITEMASK_X << j),
+                  ureg_src(row), ureg_src(wx));
+      }
+      ureg_DP4(shader, ureg_writemask(texel, TGSI_WRITEMASK_X << i),
+               ureg_src(col), ureg_src(wy));
+   }
+
+   create_frag_shader_csc(shader, texel, fragment);
+
+   ureg_release_temporary(shader, size);
+   ureg_release_temporary(shader, inv_size);
+   ureg_release_temporary(shader, pos);
+   ureg_release_temporary(shader, base);
+   ureg_release_temporary(shader, wx);
+   ureg_release_temporary(shader, wy);
+   ureg_release_temporary(shader, t);
+   ureg_release_temporary(shader, coord);
+   ureg_release_temporary(shader, row);
+   ureg_release_temporary(shader, col);
+   ureg_release_temporary(shader, texel);
+   ureg_END(shader);
+
+   return ureg_create_shader_and_destroy(shader, c->pipe);
+}
+
 static void *
 create_frag_shader_weave_rgb(struct vl_compositor *c)
 {
@@ -414,6 +547,9 @@ init_shaders(struct vl_compositor *c)
       return false;
    }
 
+   /* optional, vl_compositor_set_layer_bicubic fails without it */
+   c->fs_video_buffer_bicubic = create_frag_shader_video_buffer_bicubic(c);
+
    c->fs_weave_rgb = create_frag_shader_weave_rgb(c);
    if (!c->fs_weave_rgb) {
       debug_printf("Unable to create YCbCr-to-RGB weave fragment shader.\n");
@@ -454,6 +590,8 @@ static void cleanup_shaders(struct vl_compositor *c)
 
    c->pipe->delete_vs_state(c->pipe, c->vs);
    c->pipe->delete_fs_state(c->pipe, c->fs_video_buffer);
+   if (c->fs_video_buffer_bicubic)
+      c->pipe->delete_fs_state(c->pipe, c->fs_video_buffer_bicubic);
    c->pipe->delete_fs_state(c->pipe, c->fs_weave_rgb);
    c->pipe->delete_fs_state(c->pipe, c->fs_weave_yuv.y);
    c->pipe->delete_fs_state(c->pipe, c->fs_weave_yuv.uv);
@@ -1038,6 +1176,23 @@ vl_compositor_set_buffer_layer(struct vl_compositor_state *s,
       s->layers[layer].fs = c->fs_video_buffer;
 }
 
+bool
+vl_compositor_set_layer_bicubic(struct vl_compositor_state *s,
+                                struct vl_compositor *c,
+                                unsigned layer)
+{
+   assert(s && c);
+
+   assert(layer < VL_COMPOSITOR_MAX_LAYERS);
+
+   if (!c->fs_video_buffer_bicubic ||
+       s->layers[layer].fs != c->fs_video_buffer)
+      return false;
+
+   s->layers[layer].fs = c->fs_video_buffer_bicubic;
+   return true;
+}
+
 void
 vl_compositor_set_palette_layer(struct vl_compositor_state *s,
                                 struct vl_compositor *c,
@@ -113,6 +113,7 @@ struct vl_compositor
 
    void *vs;
    void *fs_video_buffer;
+   void *fs_video_buffer_bicubic;
    void *fs_weave_rgb;
    void *fs_rgba;
 
@@ -208,6 +209,18 @@ vl_compositor_set_buffer_layer(struct vl_compositor_state *state,
                                struct u_rect *dst_rect,
                                enum vl_compositor_deinterlace deinterlace);
 
+/**
+ * scale a video buffer layer with a bicubic instead of a bilinear filter,
+ * in the same pass as the color space conversion
+ *
+ * returns false if this isn't supported for the layer, e.g. with weave
+ * deinterlacing
+ */
+bool
+vl_compositor_set_layer_bicubic(struct vl_compositor_state *state,
+                                struct vl_compositor *compositor,
+                                unsigned layer);
+
 /**
  * set a paletted sampler as a layer to render
  */
@@ -46,6 +46,17 @@ struct dct_coeff
    int16_t level;
 };
 
+/* The codes are looked up with 17 bits, but all codes that don't start with
+ * six zeros are at most 10 bits long including the sign. So only those
+ * starting with six zeros need the remaining 11 bits, and the lookup fits in
+ * 3K instead of 128K entries, which keeps the tables in the cache.
+ */
+struct dct_coeff_table
+{
+   struct dct_coeff short_codes[1 << 10];
+   struct dct_coeff long_codes[1 << 11];
+};
+
 struct dct_coeff_compressed
 {
    uint32_t bitcode;
@@ -529,20 +540,41 @@ static struct vl_vlc_entry tbl_B10[1 << 11];
 static struct vl_vlc_entry tbl_B11[1 << 2];
 static struct vl_vlc_entry tbl_B12[1 << 10];
 static struct vl_vlc_entry tbl_B13[1 << 10];
-static struct dct_coeff tbl_B14_DC[1 << 17];
-static struct dct_coeff tbl_B14_AC[1 << 17];
-static struct dct_coeff tbl_B15[1 << 17];
+static struct dct_coeff_table tbl_B14_DC;
+static struct dct_coeff_table tbl_B14_AC;
+static struct dct_coeff_table tbl_B15;
+
+static inline struct dct_coeff *
+dct_coeff_entry(struct dct_coeff_table *tbl, unsigned bits)
+{
+   if (bits >= (1 << 11))
+      return &tbl->short_codes[bits >> 7];
+   else
+      return &tbl->long_codes[bits];
+}
+
+static inline const struct dct_coeff *
+dct_coeff_lookup(struct vl_vlc *vlc, const struct dct_coeff_table *tbl)
+{
+   unsigned bits = vl_vlc_peekbits(vlc, 17);
+
+   if (bits >= (1 << 11))
+      return &tbl->short_codes[bits >> 7];
+   else
+      return &tbl->long_codes[bits];
+}
 
 static inline void
-init_dct_coeff_table(struct dct_coeff *dst, const struct dct_coeff_compressed *src,
+init_dct_coeff_table(struct dct_coeff_table *dst, const struct dct_coeff_compressed *src,
                      unsigned size, bool is_DC)
 {
    unsigned i;
 
    for (i=0;i<(1<<17);++i) {
-      dst[i].length = 0;
-      dst[i].level = 0;
-      dst[i].run = dct_End_of_Block;
+      struct dct_coeff *entry = dct_coeff_entry(dst, i);
+      entry->length = 0;
+      entry->level = 0;
+      entry->run = dct_End_of_Block;
    }
 
    for(; size > 0; --size, ++src) {
@@ -583,13 +615,15 @@ init_dct_coeff_table(struct dct_coeff *dst, const struct dct_coeff_compressed *s
          break;
       }
 
+      assert(src->bitcode >= (1 << 10) || coeff.length <= 10);
+
       for(i = 0; i < (1u << (17 - coeff.length)); ++i)
-         dst[src->bitcode << 1 | i] = coeff;
+         *dct_coeff_entry(dst, src->bitcode << 1 | i) = coeff;
 
       if (has_sign) {
 	 coeff.level = -coeff.level;
          for(; i < (1u << (18 - coeff.length)); ++i)
-            dst[src->bitcode << 1 | i] = coeff;
+            *dct_coeff_entry(dst, src->bitcode << 1 | i) = coeff;
       }
    }
 }
@@ -606,9 +640,9 @@ init_tables()
    vl_vlc_init_table(tbl_B11, ARRAY_SIZE(tbl_B11), dmvector, ARRAY_SIZE(dmvector));
    vl_vlc_init_table(tbl_B12, ARRAY_SIZE(tbl_B12), dct_dc_size_luminance, ARRAY_SIZE(dct_dc_size_luminance));
    vl_vlc_init_table(tbl_B13, ARRAY_SIZE(tbl_B13), dct_dc_size_chrominance, ARRAY_SIZE(dct_dc_size_chrominance));
-   init_dct_coeff_table(tbl_B14_DC, dct_coeff_tbl_zero, ARRAY_SIZE(dct_coeff_tbl_zero), true);
-   init_dct_coeff_table(tbl_B14_AC, dct_coeff_tbl_zero, ARRAY_SIZE(dct_coeff_tbl_zero), false);
-   init_dct_coeff_table(tbl_B15, dct_coeff_tbl_one, ARRAY_SIZE(dct_coeff_tbl_one), false);
+   init_dct_coeff_table(&tbl_B14_DC, dct_coeff_tbl_zero, ARRAY_SIZE(dct_coeff_tbl_zero), true);
+   init_dct_coeff_table(&tbl_B14_AC, dct_coeff_tbl_zero, ARRAY_SIZE(dct_coeff_tbl_zero), false);
+   init_dct_coeff_table(&tbl_B15, dct_coeff_tbl_one, ARRAY_SIZE(dct_coeff_tbl_one), false);
 }
 
 static inline int
@@ -715,7 +749,7 @@ decode_dct(struct vl_mpg12_bs *bs, struct pipe_mpeg12_macroblock *mb, int scale)
    };
 
    bool intra = mb->macroblock_type & PIPE_MPEG12_MB_TYPE_INTRA;
-   const struct dct_coeff *table = intra ? bs->intra_dct_tbl : tbl_B14_AC;
+   const struct dct_coeff_table *table = intra ? bs->intra_dct_tbl : &tbl_B14_AC;
    const struct dct_coeff *entry;
    int i, cbp, blk = 0;
    short *dst = mb->blocks;
@@ -764,7 +798,7 @@ entry:
             if (bs->desc->picture_coding_type == PIPE_MPEG12_PICTURE_CODING_TYPE_D)
                goto next_d;
          } else {
-            entry = tbl_B14_DC + vl_vlc_peekbits(&bs->vlc, 17);
+            entry = dct_coeff_lookup(&bs->vlc, &tbl_B14_DC);
             i = -1;
             continue;
          }
@@ -798,7 +832,7 @@ entry:
       }
 
       vl_vlc_fillbits(&bs->vlc);
-      entry = table + vl_vlc_peekbits(&bs->vlc, 17);
+      entry = dct_coeff_lookup(&bs->vlc, table);
    }
 
    if (bs->desc->picture_coding_type == PIPE_MPEG12_PICTURE_CODING_TYPE_D)
@@ -993,7 +1027,7 @@ vl_mpg12_bs_decode(struct vl_mpg12_bs *bs,
    assert(bs);
 
    bs->desc = picture;
-   bs->intra_dct_tbl = picture->intra_vlc_format ? tbl_B15 : tbl_B14_AC;
+   bs->intra_dct_tbl = picture->intra_vlc_format ? &tbl_B15 : &tbl_B14_AC;
 
    vl_vlc_init(&bs->vlc, num_buffers, buffers, sizes);
    while (vl_vlc_search_byte(&bs->vlc, ~0, 0x00) && vl_vlc_bits_left(&bs->vlc) > 32) {
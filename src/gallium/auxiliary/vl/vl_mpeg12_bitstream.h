@@ -36,7 +36,7 @@ struct vl_mpg12_bs
    struct pipe_video_codec *decoder;
 
    struct pipe_mpeg12_picture_desc *desc;
-   struct dct_coeff *intra_dct_tbl;
+   struct dct_coeff_table *intra_dct_tbl;
 
    struct vl_vlc vlc;
    short pred_dc[3];
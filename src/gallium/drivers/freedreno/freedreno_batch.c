@@ -336,6 +336,7 @@ batch_add_dep(struct fd_batch *batch, struct fd_batch *dep)
 	 */
 	if (batch_depends_on(dep, batch)) {
 		DBG("%p: flush forced on %p!", batch, dep);
+		batch->ctx->stats.batch_dep_flush++;
 		pipe_mutex_unlock(batch->ctx->screen->lock);
 		fd_batch_flush(dep, false);
 		pipe_mutex_lock(batch->ctx->screen->lock);
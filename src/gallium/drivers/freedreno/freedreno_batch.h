@@ -28,6 +28,7 @@
 #define FREEDRENO_BATCH_H_
 
 #include "util/u_inlines.h"
+#include "os/os_thread.h"
 #include "util/u_queue.h"
 #include "util/list.h"
 
@@ -265,6 +265,7 @@ fd_bc_alloc_batch(struct fd_batch_cache *cache, struct fd_context *ctx)
 		 */
 		pipe_mutex_unlock(ctx->screen->lock);
 		DBG("%p: too many batches!  flush forced!", flush_batch);
+		ctx->stats.batch_evicted++;
 		fd_batch_flush(flush_batch, true);
 		pipe_mutex_lock(ctx->screen->lock);
 
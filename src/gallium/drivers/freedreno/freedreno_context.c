@@ -143,6 +143,9 @@ fd_context_destroy(struct pipe_context *pctx)
 		printf("batch_total=%u, batch_sysmem=%u, batch_gmem=%u, batch_restore=%u\n",
 			(uint32_t)ctx->stats.batch_total, (uint32_t)ctx->stats.batch_sysmem,
 			(uint32_t)ctx->stats.batch_gmem, (uint32_t)ctx->stats.batch_restore);
+		printf("batch_evicted=%u, batch_dep_flush=%u\n",
+			(uint32_t)ctx->stats.batch_evicted,
+			(uint32_t)ctx->stats.batch_dep_flush);
 	}
 
 	FREE(ctx);
@@ -154,6 +154,7 @@ struct fd_context {
 		uint64_t prims_generated;
 		uint64_t draw_calls;
 		uint64_t batch_total, batch_sysmem, batch_gmem, batch_restore;
+		uint64_t batch_evicted, batch_dep_flush;
 	} stats;
 
 	/* Current batch.. the rule here is that you can deref ctx->batch
@@ -103,6 +103,50 @@ total_size(uint8_t cbuf_cpp[], uint8_t zsbuf_cpp[2],
 	return total;
 }
 
+/* find a bin size that satisfies the maximum width and the gmem size
+ * restrictions for a width x height render area:
+ */
+static void
+calculate_bins(struct fd_screen *screen, uint8_t cbuf_cpp[], uint8_t zsbuf_cpp[2],
+		uint32_t width, uint32_t height, struct fd_gmem_stateobj *gmem,
+		uint32_t *pnbins_x, uint32_t *pnbins_y, uint32_t *pbin_w, uint32_t *pbin_h)
+{
+	const uint32_t gmem_alignment = screen->gmem_alignment;
+	const uint32_t gmem_size = screen->gmemsize_bytes;
+	uint32_t max_width = bin_width(screen);
+	uint32_t nbins_x = 1, nbins_y = 1;
+	uint32_t bin_w, bin_h;
+
+	bin_w = align(width, gmem_alignment);
+	bin_h = align(height, gmem_alignment);
+
+	/* first, find a bin width that satisfies the maximum width
+	 * restrictions:
+	 */
+	while (bin_w > max_width) {
+		nbins_x++;
+		bin_w = align(width / nbins_x, gmem_alignment);
+	}
+
+	/* then find a bin width/height that satisfies the memory
+	 * constraints:
+	 */
+	while (total_size(cbuf_cpp, zsbuf_cpp, bin_w, bin_h, gmem) > gmem_size) {
+		if (bin_w > bin_h) {
+			nbins_x++;
+			bin_w = align(width / nbins_x, gmem_alignment);
+		} else {
+			nbins_y++;
+			bin_h = align(height / nbins_y, gmem_alignment);
+		}
+	}
+
+	*pnbins_x = nbins_x;
+	*pnbins_y = nbins_y;
+	*pbin_w = bin_w;
+	*pbin_h = bin_h;
+}
+
 static void
 calculate_tiles(struct fd_batch *batch)
 {
@@ -111,11 +155,9 @@ calculate_tiles(struct fd_batch *batch)
 	struct pipe_scissor_state *scissor = &batch->max_scissor;
 	struct pipe_framebuffer_state *pfb = &batch->framebuffer;
 	const uint32_t gmem_alignment = ctx->screen->gmem_alignment;
-	const uint32_t gmem_size = ctx->screen->gmemsize_bytes;
 	uint32_t minx, miny, width, height;
-	uint32_t nbins_x = 1, nbins_y = 1;
+	uint32_t nbins_x, nbins_y;
 	uint32_t bin_w, bin_h;
-	uint32_t max_width = bin_width(ctx->screen);
 	uint8_t cbuf_cpp[MAX_RENDER_TARGETS] = {0}, zsbuf_cpp[2] = {0};
 	uint32_t i, j, t, xoff, yoff;
 	uint32_t tpp_x, tpp_y;
@@ -155,15 +197,23 @@ calculate_tiles(struct fd_batch *batch)
 		height = scissor->maxy - miny;
 	}
 
-	bin_w = align(width, gmem_alignment);
-	bin_h = align(height, gmem_alignment);
+	calculate_bins(ctx->screen, cbuf_cpp, zsbuf_cpp, width, height, gmem,
+			&nbins_x, &nbins_y, &bin_w, &bin_h);
 
-	/* first, find a bin width that satisfies the maximum width
-	 * restrictions:
+	/* a3xx can't combine the scissor optimization with hw binning (see
+	 * use_hw_binning() in fd3_gmem.c).  If the scissored area still
+	 * needs enough bins for the binning pass to be used, skipping the
+	 * vertex work for invisible draws in every tile saves more than the
+	 * smaller render area, so render the whole framebuffer instead:
 	 */
-	while (bin_w > max_width) {
-		nbins_x++;
-		bin_w = align(width / nbins_x, gmem_alignment);
+	if (is_a3xx(ctx->screen) && fd_binning_enabled && (minx || miny) &&
+			((nbins_x * nbins_y) > 2)) {
+		minx = 0;
+		miny = 0;
+		width = pfb->width;
+		height = pfb->height;
+		calculate_bins(ctx->screen, cbuf_cpp, zsbuf_cpp, width, height, gmem,
+				&nbins_x, &nbins_y, &bin_w, &bin_h);
 	}
 
 	if (fd_mesa_debug & FD_DBG_MSGS) {
@@ -174,19 +224,6 @@ calculate_tiles(struct fd_batch *batch)
 				zsbuf_cpp[0], width, height);
 	}
 
-	/* then find a bin width/height that satisfies the memory
-	 * constraints:
-	 */
-	while (total_size(cbuf_cpp, zsbuf_cpp, bin_w, bin_h, gmem) > gmem_size) {
-		if (bin_w > bin_h) {
-			nbins_x++;
-			bin_w = align(width / nbins_x, gmem_alignment);
-		} else {
-			nbins_y++;
-			bin_h = align(height / nbins_y, gmem_alignment);
-		}
-	}
-
 	DBG("using %d bins of size %dx%d", nbins_x*nbins_y, bin_w, bin_h);
 
 	gmem->scissor = *scissor;
@@ -102,6 +102,8 @@ fd_get_driver_query_info(struct pipe_screen *pscreen,
 			{"batches-sysmem", FD_QUERY_BATCH_SYSMEM, {0}},
 			{"batches-gmem", FD_QUERY_BATCH_GMEM, {0}},
 			{"restores", FD_QUERY_BATCH_RESTORE, {0}},
+			{"batches-evicted", FD_QUERY_BATCH_EVICTED, {0}},
+			{"batches-dep-flush", FD_QUERY_BATCH_DEP_FLUSH, {0}},
 			{"prims-emitted", PIPE_QUERY_PRIMITIVES_EMITTED, {0}},
 	};
 
@@ -67,6 +67,10 @@ read_counter(struct fd_context *ctx, int type)
 		return ctx->stats.batch_gmem;
 	case FD_QUERY_BATCH_RESTORE:
 		return ctx->stats.batch_restore;
+	case FD_QUERY_BATCH_EVICTED:
+		return ctx->stats.batch_evicted;
+	case FD_QUERY_BATCH_DEP_FLUSH:
+		return ctx->stats.batch_dep_flush;
 	}
 	return 0;
 }
@@ -79,6 +83,8 @@ is_rate_query(struct fd_query *q)
 	case FD_QUERY_BATCH_SYSMEM:
 	case FD_QUERY_BATCH_GMEM:
 	case FD_QUERY_BATCH_RESTORE:
+	case FD_QUERY_BATCH_EVICTED:
+	case FD_QUERY_BATCH_DEP_FLUSH:
 		return true;
 	default:
 		return false;
@@ -149,6 +155,8 @@ fd_sw_create_query(struct fd_context *ctx, unsigned query_type)
 	case FD_QUERY_BATCH_SYSMEM:
 	case FD_QUERY_BATCH_GMEM:
 	case FD_QUERY_BATCH_RESTORE:
+	case FD_QUERY_BATCH_EVICTED:
+	case FD_QUERY_BATCH_DEP_FLUSH:
 		break;
 	default:
 		return NULL;
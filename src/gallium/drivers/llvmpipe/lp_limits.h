@@ -61,7 +61,17 @@
 #define LP_MAX_WIDTH  (1 << (LP_MAX_TEXTURE_LEVELS - 1))
 
 
-#define LP_MAX_THREADS 16
+/**
+ * Max number of rasterizer threads.  The default is one thread per CPU, up
+ * to this limit.
+ */
+#define LP_MAX_THREADS 64
+
+/**
+ * Max number of chunks the queued triangles are split in, to be binned
+ * concurrently.
+ */
+#define LP_MAX_SETUP_CHUNKS 8
 
 
 /**
@@ -26,6 +26,7 @@
  **************************************************************************/
 
 #include <limits.h>
+#include <float.h>
 #include "util/u_memory.h"
 #include "util/u_math.h"
 #include "util/u_rect.h"
@@ -69,16 +70,28 @@ lp_rast_begin( struct lp_rasterizer *rast,
    LP_DBG(DEBUG_RAST, "%s\n", __FUNCTION__);
 
    lp_scene_begin_rasterization( scene );
-   lp_scene_bin_iter_begin( scene );
+   lp_scene_bin_iter_begin( scene, rast->num_threads );
 }
 
 
 static void
 lp_rast_end( struct lp_rasterizer *rast )
 {
+   struct lp_fence *fence = NULL;
+
+   /* The setup module may recycle the scene as soon as the fence is
+    * signalled, so don't touch the scene after that.
+    */
+   lp_fence_reference(&fence, rast->curr_scene->fence);
+
    lp_scene_end_rasterization( rast->curr_scene );
 
    rast->curr_scene = NULL;
+
+   if (fence) {
+      lp_fence_signal(fence);
+      lp_fence_reference(&fence, NULL);
+   }
 }
 
 
@@ -108,6 +121,17 @@ lp_rast_tile_begin(struct lp_rasterizer_task *task,
    task->thread_data.vis_counter = 0;
    task->ps_invocations = 0;
 
+   task->hiz = FLT_MAX;
+   task->hiz_ulp = 0.0f;
+   if (scene->fb.zsbuf) {
+      unsigned bits = util_format_get_component_bits(scene->fb.zsbuf->format,
+                                                     UTIL_FORMAT_COLORSPACE_ZS,
+                                                     0);
+      /* 32 bits are float, or too fine grained to matter */
+      if (bits && bits < 32)
+         task->hiz_ulp = 1.0f / (float)((1 << bits) - 1);
+   }
+
    for (i = 0; i < task->scene->fb.nr_cbufs; i++) {
       if (task->scene->fb.cbufs[i]) {
          task->color_tiles[i] = scene->cbufs[i].map +
@@ -169,6 +193,113 @@ lp_rast_clear_color(struct lp_rasterizer_task *task,
 }
 
 
+/**
+ * Compute the range of the depth plane of a command over the current tile.
+ * The bounds are widened by the rounding error of evaluating the plane at
+ * a pixel, as the fragment shader does.
+ */
+static void
+lp_rast_depth_bounds(const struct lp_rasterizer_task *task,
+                     const struct lp_rast_shader_inputs *inputs,
+                     float *zmin, float *zmax)
+{
+   const float a0 = GET_A0(inputs)[0][2];
+   const float dzdx = GET_DADX(inputs)[0][2];
+   const float dzdy = GET_DADY(inputs)[0][2];
+   const float x0 = (float)task->x - 1.0f, x1 = (float)(task->x + task->width);
+   const float y0 = (float)task->y - 1.0f, y1 = (float)(task->y + task->height);
+   const float zx0 = dzdx * x0, zx1 = dzdx * x1;
+   const float zy0 = dzdy * y0, zy1 = dzdy * y1;
+   const float err = 1e-6f * (fabsf(a0) +
+                              MAX2(fabsf(zx0), fabsf(zx1)) +
+                              MAX2(fabsf(zy0), fabsf(zy1)));
+
+   *zmin = a0 + MIN2(zx0, zx1) + MIN2(zy0, zy1) - err;
+   *zmax = a0 + MAX2(zx0, zx1) + MAX2(zy0, zy1) + err;
+}
+
+
+/**
+ * Is a triangle or shade command entirely behind the tile's contents?
+ */
+static boolean
+lp_rast_hiz_culled(const struct lp_rasterizer_task *task,
+                   unsigned cmd, union lp_rast_cmd_arg arg)
+{
+   const struct lp_rast_shader_inputs *inputs;
+   float zmin, zmax;
+
+   switch (cmd) {
+   case LP_RAST_OP_SHADE_TILE:
+      inputs = arg.shade_tile;
+      break;
+   case LP_RAST_OP_TRIANGLE_1:
+   case LP_RAST_OP_TRIANGLE_2:
+   case LP_RAST_OP_TRIANGLE_3:
+   case LP_RAST_OP_TRIANGLE_4:
+   case LP_RAST_OP_TRIANGLE_5:
+   case LP_RAST_OP_TRIANGLE_6:
+   case LP_RAST_OP_TRIANGLE_7:
+   case LP_RAST_OP_TRIANGLE_8:
+   case LP_RAST_OP_TRIANGLE_3_4:
+   case LP_RAST_OP_TRIANGLE_3_16:
+   case LP_RAST_OP_TRIANGLE_4_16:
+   case LP_RAST_OP_TRIANGLE_32_1:
+   case LP_RAST_OP_TRIANGLE_32_2:
+   case LP_RAST_OP_TRIANGLE_32_3:
+   case LP_RAST_OP_TRIANGLE_32_4:
+   case LP_RAST_OP_TRIANGLE_32_5:
+   case LP_RAST_OP_TRIANGLE_32_6:
+   case LP_RAST_OP_TRIANGLE_32_7:
+   case LP_RAST_OP_TRIANGLE_32_8:
+   case LP_RAST_OP_TRIANGLE_32_3_4:
+   case LP_RAST_OP_TRIANGLE_32_3_16:
+   case LP_RAST_OP_TRIANGLE_32_4_16:
+      inputs = &arg.triangle.tri->inputs;
+      break;
+   default:
+      return FALSE;
+   }
+
+   if (inputs->disable)
+      return FALSE;
+
+   lp_rast_depth_bounds(task, inputs, &zmin, &zmax);
+
+   /* Even the nearest fragment rounds to a value behind hiz */
+   return zmin > task->hiz + task->hiz_ulp;
+}
+
+
+/**
+ * Set the hierarchical Z of the tile after clearing its depth values.
+ */
+static void
+lp_rast_hiz_clear(struct lp_rasterizer_task *task,
+                  uint64_t value, uint64_t mask)
+{
+   const struct lp_scene *scene = task->scene;
+   const enum pipe_format format = scene->fb.zsbuf->format;
+   const struct util_format_description *desc = util_format_description(format);
+   const uint64_t depth_mask = util_pack64_mask_z(format, 0xffffffff);
+   float z;
+
+   if (!util_format_has_depth(desc) || (mask & depth_mask) == 0) {
+      /* depth values are unchanged */
+      return;
+   }
+
+   /* One hiz value covers a single layer */
+   if ((mask & depth_mask) != depth_mask || scene->fb_max_layer > 0) {
+      task->hiz = FLT_MAX;
+      return;
+   }
+
+   desc->unpack_z_float(&z, 0, (const uint8_t *)&value, 0, 1, 1);
+   task->hiz = z + task->hiz_ulp;
+}
+
+
 /**
  * Clear the rasterizer's current z/stencil tile.
  * This is a bin command called during bin processing.
@@ -280,6 +411,9 @@ lp_rast_clear_zstencil(struct lp_rasterizer_task *task,
          }
          dst_layer += scene->zsbuf.layer_stride;
       }
+
+      lp_rast_hiz_clear(task, arg.clear_zstencil.value,
+                        arg.clear_zstencil.mask);
    }
 }
 
@@ -364,6 +498,14 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
          END_JIT_CALL();
       }
    }
+
+   /* Every depth value in the tile is now at most the plane's */
+   if (task->hiz_write && scene->fb_max_layer == 0) {
+      float zmin, zmax;
+
+      lp_rast_depth_bounds(task, inputs, &zmin, &zmax);
+      task->hiz = MIN2(task->hiz, zmax + task->hiz_ulp);
+   }
 }
 
 
@@ -535,7 +677,38 @@ void
 lp_rast_set_state(struct lp_rasterizer_task *task,
                   const union lp_rast_cmd_arg arg)
 {
+   const struct lp_fragment_shader_variant *variant = arg.state->variant;
+   const struct lp_fragment_shader_variant_key *key = &variant->key;
+   const unsigned func = key->depth.func;
+   boolean depth_lowers;
+
    task->state = arg.state;
+
+   /*
+    * Fragments failing these tests against every depth value in the tile
+    * have no effect, unless the shader picks their depth or the stencil
+    * test updates the stencil buffer anyway.
+    */
+   depth_lowers = key->depth.enabled &&
+                  (func == PIPE_FUNC_LESS || func == PIPE_FUNC_LEQUAL ||
+                   func == PIPE_FUNC_EQUAL || func == PIPE_FUNC_NEVER);
+
+   task->hiz_test = depth_lowers &&
+                    !key->depth_clamp &&
+                    !key->stencil[0].enabled &&
+                    !variant->shader->info.base.writes_z;
+
+   /* Depth writes which may raise a value in the tile lose track of hiz */
+   if (key->depth.enabled && key->depth.writemask && !depth_lowers)
+      task->hiz = FLT_MAX;
+
+   /* A whole tile of such fragments bounds the tile's depth values */
+   task->hiz_write = task->hiz_test &&
+                     key->depth.writemask &&
+                     (func == PIPE_FUNC_LESS || func == PIPE_FUNC_LEQUAL) &&
+                     !key->alpha.enabled &&
+                     !key->blend.alpha_to_coverage &&
+                     !variant->shader->info.base.uses_kill;
 }
 
 
@@ -606,6 +779,12 @@ do_rasterize_bin(struct lp_rasterizer_task *task,
 
    for (block = bin->head; block; block = block->next) {
       for (k = 0; k < block->count; k++) {
+         if (task->hiz_test && task->hiz != FLT_MAX &&
+             lp_rast_hiz_culled(task, block->cmd[k], block->arg[k])) {
+            LP_COUNT(nr_hiz_culled);
+            continue;
+         }
+
          dispatch[block->cmd[k]]( task, block->arg[k] );
       }
    }
@@ -683,7 +862,8 @@ rasterize_scene(struct lp_rasterizer_task *task,
          int i, j;
 
          assert(scene);
-         while ((bin = lp_scene_bin_iter_next(scene, &i, &j))) {
+         while ((bin = lp_scene_bin_iter_next(scene, task->thread_index,
+                                              &i, &j))) {
             if (!is_empty_bin( bin ))
                rasterize_bin(task, bin, i, j);
          }
@@ -705,10 +885,6 @@ rasterize_scene(struct lp_rasterizer_task *task,
    }
 #endif
 
-   if (scene->fence) {
-      lp_fence_signal(scene->fence);
-   }
-
    task->scene = NULL;
 }
 
@@ -757,29 +933,12 @@ lp_rast_queue_scene( struct lp_rasterizer *rast,
 }
 
 
-void
-lp_rast_finish( struct lp_rasterizer *rast )
-{
-   if (rast->num_threads == 0) {
-      /* nothing to do */
-   }
-   else {
-      int i;
-
-      /* wait for work to complete */
-      for (i = 0; i < rast->num_threads; i++) {
-         pipe_semaphore_wait(&rast->tasks[i].work_done);
-      }
-   }
-}
-
-
 /**
  * This is the thread's main entrypoint.
  * It's a simple loop:
  *   1. wait for work
  *   2. do work
- *   3. signal that we're done
+ * Completion of a scene is signalled through its fence.
  */
 static PIPE_THREAD_ROUTINE( thread_function, init_data )
 {
@@ -831,17 +990,12 @@ static PIPE_THREAD_ROUTINE( thread_function, init_data )
       /* wait for all threads to finish with this scene */
       pipe_barrier_wait( &rast->barrier );
 
-      /* XXX: shouldn't be necessary:
-       */
       if (task->thread_index == 0) {
          lp_rast_end( rast );
       }
 
-      /* signal done with work */
       if (debug)
          debug_printf("thread %d done working\n", task->thread_index);
-
-      pipe_semaphore_signal(&task->work_done);
    }
 
 #ifdef _WIN32
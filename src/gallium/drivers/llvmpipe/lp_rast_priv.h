@@ -102,6 +102,16 @@ struct lp_rasterizer_task
    uint64_t ps_invocations;
    uint8_t ps_inv_multiplier;
 
+   /**
+    * Hierarchical Z: a depth no value in the current tile exceeds, rounding
+    * of the depth format included, or FLT_MAX when unknown.  Commands of a
+    * state with hiz_test set and entirely behind it are skipped.
+    */
+   float hiz;
+   float hiz_ulp;    /**< spacing of the depth format's values */
+   boolean hiz_test; /**< can the current state be culled against hiz */
+   boolean hiz_write; /**< does the current state only lower depth values */
+
    pipe_semaphore work_ready;
    pipe_semaphore work_done;
 };
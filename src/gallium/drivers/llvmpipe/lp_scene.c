@@ -204,12 +204,13 @@ lp_scene_begin_rasterization(struct lp_scene *scene)
 
 
 /**
- * Free all the temporary data in a scene.
+ * Unmap the framebuffer of a scene.
+ * Called by the rasterizer once all bins have been processed.
  */
 void
 lp_scene_end_rasterization(struct lp_scene *scene )
 {
-   int i, j;
+   int i;
 
    /* Unmap color buffers */
    for (i = 0; i < scene->fb.nr_cbufs; i++) {
@@ -232,6 +233,18 @@ lp_scene_end_rasterization(struct lp_scene *scene )
                               zsbuf->u.tex.first_layer);
       scene->zsbuf.map = NULL;
    }
+}
+
+
+/**
+ * Free all the temporary data in a scene.
+ * Called by the setup module once the scene's fence has signalled, or if
+ * the scene is abandoned before being rasterized.
+ */
+void
+lp_scene_reset(struct lp_scene *scene )
+{
+   int i, j;
 
    /* Reset all command lists:
     */
@@ -449,56 +462,69 @@ lp_scene_is_resource_referenced(const struct lp_scene *scene,
 
 
 
-/** advance curr_x,y to the next bin */
-static boolean
-next_bin(struct lp_scene *scene)
+/**
+ * Split the bins of the scene in \p num_bands bands of whole rows of
+ * tiles, so that each rasterizer thread starts on a compact region of the
+ * framebuffer.
+ */
+void
+lp_scene_bin_iter_begin( struct lp_scene *scene, unsigned num_bands )
 {
-   scene->curr_x++;
-   if (scene->curr_x >= scene->tiles_x) {
-      scene->curr_x = 0;
-      scene->curr_y++;
-   }
-   if (scene->curr_y >= scene->tiles_y) {
-      /* no more bins */
-      return FALSE;
-   }
-   return TRUE;
-}
+   unsigned i;
 
+   num_bands = MIN3(num_bands, scene->tiles_y, LP_MAX_THREADS);
+   if (num_bands == 0)
+      num_bands = 1;
 
-void
-lp_scene_bin_iter_begin( struct lp_scene *scene )
-{
-   scene->curr_x = scene->curr_y = -1;
+   for (i = 0; i < num_bands; i++) {
+      scene->band[i].next = scene->tiles_y * i / num_bands * scene->tiles_x;
+      scene->band[i].end = scene->tiles_y * (i + 1) / num_bands * scene->tiles_x;
+   }
+   scene->num_bands = num_bands;
 }
 
 
 /**
  * Return pointer to next bin to be rendered.
- * The lp_scene::curr_x and ::curr_y fields will be advanced.
  * Multiple rendering threads will call this function to get a chunk
- * of work (a bin) to work on.
+ * of work (a bin) to work on.  Bins are taken from the front of \p band
+ * while it lasts, then from the back of the band with the most bins left.
  */
 struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene , int *x, int *y)
+lp_scene_bin_iter_next( struct lp_scene *scene, unsigned band,
+                        int *x, int *y)
 {
    struct cmd_bin *bin = NULL;
+   unsigned idx, i;
 
    pipe_mutex_lock(scene->mutex);
 
-   if (scene->curr_x < 0) {
-      /* first bin */
-      scene->curr_x = 0;
-      scene->curr_y = 0;
+   if (band < scene->num_bands &&
+       scene->band[band].next < scene->band[band].end) {
+      idx = scene->band[band].next++;
    }
-   else if (!next_bin(scene)) {
-      /* no more bins left */
-      goto end;
+   else {
+      unsigned busiest = 0, left = 0;
+
+      for (i = 0; i < scene->num_bands; i++) {
+         unsigned n = scene->band[i].end - scene->band[i].next;
+         if (n > left) {
+            busiest = i;
+            left = n;
+         }
+      }
+
+      if (!left) {
+         /* no more bins left */
+         goto end;
+      }
+
+      idx = --scene->band[busiest].end;
    }
 
-   bin = lp_scene_get_bin(scene, scene->curr_x, scene->curr_y);
-   *x = scene->curr_x;
-   *y = scene->curr_y;
+   *x = idx % scene->tiles_x;
+   *y = idx / scene->tiles_x;
+   bin = lp_scene_get_bin(scene, *x, *y);
 
 end:
    /*printf("return bin %p at %d, %d\n", (void *) bin, *bin_x, *bin_y);*/
@@ -549,6 +575,79 @@ void lp_scene_begin_binning( struct lp_scene *scene,
 }
 
 
+/**
+ * Prepare \p chunk for binning part of a draw on behalf of \p scene.
+ * The chunk's bins are appended to the scene's by lp_scene_append_chunk().
+ */
+void
+lp_scene_begin_chunk( struct lp_scene *chunk,
+                      const struct lp_scene *scene )
+{
+   assert(lp_scene_is_empty(chunk));
+
+   chunk->tiles_x = scene->tiles_x;
+   chunk->tiles_y = scene->tiles_y;
+   chunk->fb_max_layer = scene->fb_max_layer;
+}
+
+
+/**
+ * Append the commands binned into \p chunk to the bins of \p scene, and
+ * hand the chunk's data blocks over to the scene.  The chunk is left
+ * empty.
+ *
+ * Returns FALSE, with both scenes unchanged, if out of memory.
+ */
+boolean
+lp_scene_append_chunk( struct lp_scene *scene,
+                       struct lp_scene *chunk )
+{
+   struct data_block *block, *tail;
+   unsigned x, y;
+
+   /* The chunk needs a new block of its own to allocate from */
+   block = MALLOC_STRUCT(data_block);
+   if (!block)
+      return FALSE;
+
+   block->used = 0;
+   block->next = NULL;
+
+   for (tail = chunk->data.head; tail->next; tail = tail->next)
+      ;
+
+   tail->next = scene->data.head->next;
+   scene->data.head->next = chunk->data.head;
+   chunk->data.head = block;
+
+   scene->scene_size += chunk->scene_size;
+   chunk->scene_size = 0;
+
+   for (y = 0; y < chunk->tiles_y; y++) {
+      for (x = 0; x < chunk->tiles_x; x++) {
+         struct cmd_bin *src = lp_scene_get_bin(chunk, x, y);
+         struct cmd_bin *dst = lp_scene_get_bin(scene, x, y);
+
+         if (!src->head)
+            continue;
+
+         if (dst->tail)
+            dst->tail->next = src->head;
+         else
+            dst->head = src->head;
+         dst->tail = src->tail;
+         dst->last_state = src->last_state;
+
+         src->head = NULL;
+         src->tail = NULL;
+         src->last_state = NULL;
+      }
+   }
+
+   return TRUE;
+}
+
+
 void lp_scene_end_binning( struct lp_scene *scene )
 {
    if (LP_DEBUG & DEBUG_SCENE) {
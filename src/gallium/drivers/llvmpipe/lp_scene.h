@@ -173,7 +173,16 @@ struct lp_scene {
     */
    unsigned tiles_x, tiles_y;
 
-   int curr_x, curr_y;  /**< for iterating over bins */
+   /**
+    * For iterating over bins.  The bins are split in one band of
+    * consecutive rows per rasterizer thread, bin indices are in raster
+    * order.  Threads that are done with their own band take the bins at
+    * the end of the busiest remaining one.
+    */
+   struct {
+      unsigned next, end;
+   } band[LP_MAX_THREADS];
+   unsigned num_bands;
    pipe_mutex mutex;
 
    struct cmd_bin tile[TILES_X][TILES_Y];
@@ -379,10 +388,11 @@ lp_scene_get_num_bins( const struct lp_scene *scene )
 
 
 void
-lp_scene_bin_iter_begin( struct lp_scene *scene );
+lp_scene_bin_iter_begin( struct lp_scene *scene, unsigned num_bands );
 
 struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene, int *x, int *y );
+lp_scene_bin_iter_next( struct lp_scene *scene, unsigned band,
+                        int *x, int *y );
 
 
 
@@ -396,6 +406,14 @@ lp_scene_begin_binning( struct lp_scene *scene,
 void
 lp_scene_end_binning( struct lp_scene *scene );
 
+void
+lp_scene_begin_chunk( struct lp_scene *chunk,
+                      const struct lp_scene *scene );
+
+boolean
+lp_scene_append_chunk( struct lp_scene *scene,
+                       struct lp_scene *chunk );
+
 
 /* Begin/end rasterization of a scene
  */
@@ -405,6 +423,9 @@ lp_scene_begin_rasterization(struct lp_scene *scene);
 void
 lp_scene_end_rasterization(struct lp_scene *scene );
 
+void
+lp_scene_reset(struct lp_scene *scene );
+
 
 
 
@@ -36,6 +36,9 @@
 #include "pipe/p_screen.h"
 #include "draw/draw_context.h"
 #include "gallivm/lp_bld_type.h"
+#include "gallivm/lp_bld_init.h"
+#include "gallivm/lp_bld_debug.h"
+#include "util/mesa-sha1.h"
 
 #include "os/os_misc.h"
 #include "os/os_time.h"
@@ -51,6 +54,8 @@
 
 #include "state_tracker/sw_winsys.h"
 
+#include "git_sha1.h"
+
 #ifdef DEBUG
 int LP_DEBUG = 0;
 
@@ -535,6 +540,19 @@ llvmpipe_flush_frontbuffer(struct pipe_screen *_screen,
    struct llvmpipe_screen *screen = llvmpipe_screen(_screen);
    struct sw_winsys *winsys = screen->winsys;
    struct llvmpipe_resource *texture = llvmpipe_resource(resource);
+   struct lp_fence *fence = NULL;
+
+   /* Scenes are rasterized asynchronously, wait for the ones which may
+    * still be drawing to the front buffer.
+    */
+   pipe_mutex_lock(screen->rast_mutex);
+   lp_fence_reference(&fence, screen->last_fence);
+   pipe_mutex_unlock(screen->rast_mutex);
+
+   if (fence) {
+      lp_fence_wait(fence);
+      lp_fence_reference(&fence, NULL);
+   }
 
    assert(texture->dt);
    if (texture->dt)
@@ -550,8 +568,16 @@ llvmpipe_destroy_screen( struct pipe_screen *_screen )
    if (screen->rast)
       lp_rast_destroy(screen->rast);
 
+   lp_fence_reference(&screen->last_fence, NULL);
+
+   if (util_queue_is_initialized(&screen->setup_queue))
+      util_queue_destroy(&screen->setup_queue);
+
    lp_jit_screen_cleanup(screen);
 
+   if (screen->disk_cache)
+      disk_cache_destroy(screen->disk_cache);
+
    if(winsys->destroy)
       winsys->destroy(winsys);
 
@@ -563,6 +589,80 @@ llvmpipe_destroy_screen( struct pipe_screen *_screen )
 
 
 
+/**
+ * Look up the object code of a module in the on-disk cache.
+ *
+ * The key is a hash of the unoptimized IR, which holds everything the
+ * generated code depends on but the build and the host CPU, so these are
+ * hashed too.  Must be called once the IR is complete, before
+ * gallivm_compile_module().  On a hit, code generation is skipped.
+ */
+void
+lp_disk_cache_find_shader(struct llvmpipe_screen *screen,
+                          struct gallivm_state *gallivm,
+                          cache_key key)
+{
+   static const char build_id[] =
+#ifdef PACKAGE_VERSION
+      PACKAGE_VERSION
+#endif
+#ifdef MESA_GIT_SHA1
+      MESA_GIT_SHA1
+#endif
+      "";
+   const unsigned llvm_version = HAVE_LLVM;
+   const unsigned debug_flags = gallivm_debug;
+   struct lp_cached_code *cache = gallivm->cache;
+   struct mesa_sha1 *sha1;
+   char *ir;
+
+   if (!screen->disk_cache || !cache || cache->dont_cache)
+      return;
+
+   sha1 = _mesa_sha1_init();
+   if (!sha1)
+      return;
+
+   ir = LLVMPrintModuleToString(gallivm->module);
+   _mesa_sha1_update(sha1, build_id, sizeof(build_id));
+   _mesa_sha1_update(sha1, &llvm_version, sizeof(llvm_version));
+   _mesa_sha1_update(sha1, &util_cpu_caps, sizeof(util_cpu_caps));
+   _mesa_sha1_update(sha1, &debug_flags, sizeof(debug_flags));
+   _mesa_sha1_update(sha1, ir, strlen(ir));
+   _mesa_sha1_final(sha1, key);
+   LLVMDisposeMessage(ir);
+
+   cache->data = disk_cache_get(screen->disk_cache, key, &cache->data_size);
+   if (!cache->data)
+      cache->data_size = 0;
+}
+
+
+/**
+ * Store the object code of a module compiled after a cache miss, and
+ * release the object buffer.  Must be called once the functions of the
+ * module have been JIT'ed.
+ */
+void
+lp_disk_cache_insert_shader(struct llvmpipe_screen *screen,
+                            struct gallivm_state *gallivm,
+                            cache_key key,
+                            boolean hit)
+{
+   struct lp_cached_code *cache = gallivm->cache;
+
+   if (!cache)
+      return;
+
+   if (!hit && cache->data && !cache->dont_cache)
+      disk_cache_put(screen->disk_cache, key, cache->data, cache->data_size);
+
+   free(cache->data);
+   cache->data = NULL;
+   cache->data_size = 0;
+}
+
+
 /**
  * Fence reference counting.
  */
@@ -649,6 +749,8 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
 
    llvmpipe_init_screen_resource_funcs(&screen->base);
 
+   screen->disk_cache = disk_cache_create();
+
    screen->num_threads = util_cpu_caps.nr_cpus > 1 ? util_cpu_caps.nr_cpus : 0;
 #ifdef PIPE_SUBSYSTEM_EMBEDDED
    screen->num_threads = 0;
@@ -656,6 +758,12 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    screen->num_threads = debug_get_num_option("LP_NUM_THREADS", screen->num_threads);
    screen->num_threads = MIN2(screen->num_threads, LP_MAX_THREADS);
 
+   /* The context's own thread bins a chunk too. */
+   if (screen->num_threads > 1)
+      util_queue_init(&screen->setup_queue, "llvmpipe_setup",
+                      LP_MAX_SETUP_CHUNKS,
+                      MIN2(screen->num_threads, LP_MAX_SETUP_CHUNKS) - 1);
+
    screen->rast = lp_rast_create(screen->num_threads);
    if (!screen->rast) {
       lp_jit_screen_cleanup(screen);
@@ -37,10 +37,15 @@
 #include "pipe/p_screen.h"
 #include "pipe/p_defines.h"
 #include "os/os_thread.h"
+#include "util/u_queue.h"
+#include "util/disk_cache.h"
 #include "gallivm/lp_bld.h"
 
 
 struct sw_winsys;
+struct lp_fence;
+struct lp_cached_code;
+struct gallivm_state;
 
 
 struct llvmpipe_screen
@@ -57,6 +62,15 @@ struct llvmpipe_screen
 
    struct lp_rasterizer *rast;
    pipe_mutex rast_mutex;
+
+   /** Fence of the last scene queued to the rasterizer, by any context */
+   struct lp_fence *last_fence;
+
+   /** Worker threads binning chunks of triangles, for all contexts */
+   struct util_queue setup_queue;
+
+   /** JIT'ed shader objects, may be NULL */
+   struct disk_cache *disk_cache;
 };
 
 
@@ -69,5 +83,17 @@ llvmpipe_screen( struct pipe_screen *pipe )
 }
 
 
+void
+lp_disk_cache_find_shader(struct llvmpipe_screen *screen,
+                          struct gallivm_state *gallivm,
+                          cache_key key);
+
+void
+lp_disk_cache_insert_shader(struct llvmpipe_screen *screen,
+                            struct gallivm_state *gallivm,
+                            cache_key key,
+                            boolean hit);
+
+
 
 #endif /* LP_SCREEN_H */
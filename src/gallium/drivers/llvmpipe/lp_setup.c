@@ -82,6 +82,8 @@ lp_setup_get_empty_scene(struct lp_setup_context *setup)
       lp_fence_wait(setup->scene->fence);
    }
 
+   lp_scene_reset(setup->scene);
+
    lp_scene_begin_binning(setup->scene, &setup->fb, setup->rasterizer_discard);
 
 }
@@ -165,23 +167,15 @@ lp_setup_rasterize_scene( struct lp_setup_context *setup )
    if (setup->last_fence)
       setup->last_fence->issued = TRUE;
 
-   pipe_mutex_lock(screen->rast_mutex);
-
-   /* FIXME: We enqueue the scene then wait on the rasterizer to finish.
-    * This means we never actually run any vertex stuff in parallel to
-    * rasterization (not in the same context at least) which is what the
-    * multiple scenes per setup is about - when we get a new empty scene
-    * any old one is already empty again because we waited here for
-    * raster tasks to be finished. Ideally, we shouldn't need to wait here
-    * and rely on fences elsewhere when waiting is necessary.
-    * Certainly, lp_scene_end_rasterization() would need to be deferred too
-    * and there's probably other bits why this doesn't actually work.
+   /* Don't wait for the rasterizer, binning of the next scene overlaps
+    * with rasterization of this one.  The scene is released when it gets
+    * reused, after its fence has signalled.
     */
+   pipe_mutex_lock(screen->rast_mutex);
+   lp_fence_reference(&screen->last_fence, scene->fence);
    lp_rast_queue_scene(screen->rast, scene);
-   lp_rast_finish(screen->rast);
    pipe_mutex_unlock(screen->rast_mutex);
 
-   lp_scene_end_rasterization(setup->scene);
    lp_setup_reset( setup );
 
    LP_DBG(DEBUG_SETUP, "%s done \n", __FUNCTION__);
@@ -201,7 +195,7 @@ begin_binning( struct lp_setup_context *setup )
 
    /* Always create a fence:
     */
-   scene->fence = lp_fence_create(MAX2(1, setup->num_threads));
+   scene->fence = lp_fence_create(1);
    if (!scene->fence)
       return FALSE;
 
@@ -342,7 +336,7 @@ set_scene_state( struct lp_setup_context *setup,
 
 fail:
    if (setup->scene) {
-      lp_scene_end_rasterization(setup->scene);
+      lp_scene_reset(setup->scene);
       setup->scene = NULL;
    }
 
@@ -357,6 +351,8 @@ lp_setup_flush( struct lp_setup_context *setup,
                 struct pipe_fence_handle **fence,
                 const char *reason)
 {
+   lp_setup_bin_queued_tris(setup);
+
    set_scene_state( setup, SETUP_FLUSHED, reason );
 
    if (fence) {
@@ -369,6 +365,8 @@ void
 lp_setup_bind_framebuffer( struct lp_setup_context *setup,
                            const struct pipe_framebuffer_state *fb )
 {
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    /* Flush any old scene.
@@ -542,6 +540,8 @@ lp_setup_clear( struct lp_setup_context *setup,
 {
    unsigned i;
 
+   lp_setup_bin_queued_tris(setup);
+
    /*
     * Note any of these (max 9) clears could fail (but at most there should
     * be just one failure!). This avoids doing the previous succeeded
@@ -583,6 +583,8 @@ lp_setup_set_triangle_state( struct lp_setup_context *setup,
                              boolean half_pixel_center,
                              boolean bottom_edge_rule)
 {
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    setup->ccw_is_frontface = ccw_is_frontface;
@@ -601,6 +603,8 @@ void
 lp_setup_set_line_state( struct lp_setup_context *setup,
 			 float line_width)
 {
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    setup->line_width = line_width;
@@ -613,6 +617,8 @@ lp_setup_set_point_state( struct lp_setup_context *setup,
                           uint sprite_coord_enable,
                           uint sprite_coord_origin)
 {
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    setup->point_size = point_size;
@@ -625,6 +631,8 @@ void
 lp_setup_set_setup_variant( struct lp_setup_context *setup,
 			    const struct lp_setup_variant *variant)
 {
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
    
    setup->setup.variant = variant;
@@ -634,6 +642,8 @@ void
 lp_setup_set_fs_variant( struct lp_setup_context *setup,
                          struct lp_fragment_shader_variant *variant)
 {
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s %p\n", __FUNCTION__,
           variant);
    /* FIXME: reference count */
@@ -649,6 +659,8 @@ lp_setup_set_fs_constants(struct lp_setup_context *setup,
 {
    unsigned i;
 
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s %p\n", __FUNCTION__, (void *) buffers);
 
    assert(num <= ARRAY_SIZE(setup->constants));
@@ -667,6 +679,8 @@ void
 lp_setup_set_alpha_ref_value( struct lp_setup_context *setup,
                               float alpha_ref_value )
 {
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s %f\n", __FUNCTION__, alpha_ref_value);
 
    if(setup->fs.current.jit_context.alpha_ref_value != alpha_ref_value) {
@@ -679,6 +693,8 @@ void
 lp_setup_set_stencil_ref_values( struct lp_setup_context *setup,
                                  const ubyte refs[2] )
 {
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s %d %d\n", __FUNCTION__, refs[0], refs[1]);
 
    if (setup->fs.current.jit_context.stencil_ref_front != refs[0] ||
@@ -693,6 +709,8 @@ void
 lp_setup_set_blend_color( struct lp_setup_context *setup,
                           const struct pipe_blend_color *blend_color )
 {
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    assert(blend_color);
@@ -709,6 +727,8 @@ lp_setup_set_scissors( struct lp_setup_context *setup,
                        const struct pipe_scissor_state *scissors )
 {
    unsigned i;
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    assert(scissors);
@@ -727,6 +747,8 @@ void
 lp_setup_set_flatshade_first( struct lp_setup_context *setup,
                               boolean flatshade_first )
 {
+   lp_setup_bin_queued_tris(setup);
+
    setup->flatshade_first = flatshade_first;
 }
 
@@ -734,6 +756,8 @@ void
 lp_setup_set_rasterizer_discard( struct lp_setup_context *setup,
                                  boolean rasterizer_discard )
 {
+   lp_setup_bin_queued_tris(setup);
+
    if (setup->rasterizer_discard != rasterizer_discard) {
       setup->rasterizer_discard = rasterizer_discard;
       set_scene_state( setup, SETUP_FLUSHED, __FUNCTION__ );
@@ -744,6 +768,8 @@ void
 lp_setup_set_vertex_info( struct lp_setup_context *setup,
                           struct vertex_info *vertex_info )
 {
+   lp_setup_bin_queued_tris(setup);
+
    /* XXX: just silently holding onto the pointer:
     */
    setup->vertex_info = vertex_info;
@@ -761,6 +787,8 @@ lp_setup_set_viewports(struct lp_setup_context *setup,
    struct llvmpipe_context *lp = llvmpipe_context(setup->pipe);
    unsigned i;
 
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    assert(num_viewports <= PIPE_MAX_VIEWPORTS);
@@ -795,6 +823,8 @@ lp_setup_set_fragment_sampler_views(struct lp_setup_context *setup,
 {
    unsigned i, max_tex_num;
 
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    assert(num <= PIPE_MAX_SHADER_SAMPLER_VIEWS);
@@ -939,6 +969,8 @@ lp_setup_set_fragment_sampler_state(struct lp_setup_context *setup,
 {
    unsigned i;
 
+   lp_setup_bin_queued_tris(setup);
+
    LP_DBG(DEBUG_SETUP, "%s\n", __FUNCTION__);
 
    assert(num <= PIPE_MAX_SAMPLERS);
@@ -981,9 +1013,24 @@ lp_setup_is_resource_referenced( const struct lp_setup_context *setup,
       return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
    }
 
-   /* check textures referenced by the scene */
+   /* check the scenes being binned or rasterized, scenes which are done
+    * only hold references until they get reused
+    */
    for (i = 0; i < ARRAY_SIZE(setup->scenes); i++) {
-      if (lp_scene_is_resource_referenced(setup->scenes[i], texture)) {
+      const struct lp_scene *scene = setup->scenes[i];
+      unsigned j;
+
+      if (scene->fence && lp_fence_signalled(scene->fence))
+         continue;
+
+      for (j = 0; j < scene->fb.nr_cbufs; j++) {
+         if (scene->fb.cbufs[j] && scene->fb.cbufs[j]->texture == texture)
+            return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
+      }
+      if (scene->fb.zsbuf && scene->fb.zsbuf->texture == texture)
+         return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
+
+      if (lp_scene_is_resource_referenced(scene, texture)) {
          return LP_REFERENCED_FOR_READ;
       }
    }
@@ -1213,6 +1260,12 @@ lp_setup_update_state( struct lp_setup_context *setup,
       /* Will probably need to move this somewhere else, just need  
        * to know about vertex shader point size attribute.
        */
+      if (setup->psize_slot != lp->psize_slot ||
+          setup->viewport_index_slot != lp->viewport_index_slot ||
+          setup->layer_slot != lp->layer_slot ||
+          setup->face_slot != lp->face_slot)
+         lp_setup_bin_queued_tris(setup);
+
       setup->psize_slot = lp->psize_slot;
       setup->viewport_index_slot = lp->viewport_index_slot;
       setup->layer_slot = lp->layer_slot;
@@ -1283,6 +1336,18 @@ lp_setup_destroy( struct lp_setup_context *setup )
       pipe_resource_reference(&setup->constants[i].current.buffer, NULL);
    }
 
+   for (i = 0; i < ARRAY_SIZE(setup->chunks); i++) {
+      struct lp_setup_chunk *chunk = setup->chunks[i];
+
+      if (chunk) {
+         lp_scene_destroy(chunk->scene);
+         FREE(chunk);
+      }
+   }
+
+   align_free(setup->queued.data);
+   FREE(setup->queued.verts);
+
    /* free the scenes in the 'empty' queue */
    for (i = 0; i < ARRAY_SIZE(setup->scenes); i++) {
       struct lp_scene *scene = setup->scenes[i];
@@ -1290,6 +1355,7 @@ lp_setup_destroy( struct lp_setup_context *setup )
       if (scene->fence)
          lp_fence_wait(scene->fence);
 
+      lp_scene_reset(scene);
       lp_scene_destroy(scene);
    }
 
@@ -1371,6 +1437,7 @@ void
 lp_setup_begin_query(struct lp_setup_context *setup,
                      struct llvmpipe_query *pq)
 {
+   lp_setup_bin_queued_tris(setup);
 
    set_scene_state(setup, SETUP_ACTIVE, "begin_query");
 
@@ -1415,6 +1482,8 @@ lp_setup_begin_query(struct lp_setup_context *setup,
 void
 lp_setup_end_query(struct lp_setup_context *setup, struct llvmpipe_query *pq)
 {
+   lp_setup_bin_queued_tris(setup);
+
    set_scene_state(setup, SETUP_ACTIVE, "end_query");
 
    assert(setup->scene);
@@ -1489,6 +1558,12 @@ lp_setup_flush_and_restart(struct lp_setup_context *setup)
 
    if (!set_scene_state(setup, SETUP_FLUSHED, __FUNCTION__))
       return FALSE;
+
+   /* Queued triangles go with the setup state they were queued with, the
+    * context's state may have changed since.
+    */
+   if (setup->queued.binning)
+      return set_scene_state(setup, SETUP_ACTIVE, __FUNCTION__);
    
    if (!lp_setup_update_state(setup, TRUE))
       return FALSE;
@@ -1497,3 +1572,150 @@ lp_setup_flush_and_restart(struct lp_setup_context *setup)
 }
 
 
+/**
+ * Bin queued triangles [first, last) on the calling thread.
+ */
+static void
+bin_queued_tris(struct lp_setup_context *setup,
+                unsigned first, unsigned last)
+{
+   const uint8_t *data = setup->queued.data;
+   const unsigned *verts = setup->queued.verts;
+   unsigned i;
+
+   for (i = first; i < last; i++) {
+      setup->triangle(setup,
+                      (const float (*)[4])(data + verts[3 * i + 0]),
+                      (const float (*)[4])(data + verts[3 * i + 1]),
+                      (const float (*)[4])(data + verts[3 * i + 2]));
+
+      if (setup->chunk && setup->chunk->failed) {
+         setup->chunk->failed_tri = i;
+         return;
+      }
+   }
+}
+
+
+static void
+bin_chunk(void *job, int thread_index)
+{
+   struct lp_setup_chunk *chunk = (struct lp_setup_chunk *)job;
+
+   bin_queued_tris(&chunk->setup, chunk->first, chunk->last);
+}
+
+
+static boolean
+alloc_chunks(struct lp_setup_context *setup, unsigned num_chunks)
+{
+   unsigned i;
+
+   for (i = 0; i < num_chunks; i++) {
+      struct lp_setup_chunk *chunk = setup->chunks[i];
+
+      if (chunk)
+         continue;
+
+      chunk = CALLOC_STRUCT(lp_setup_chunk);
+      if (!chunk)
+         return FALSE;
+
+      chunk->scene = lp_scene_create(setup->pipe);
+      if (!chunk->scene) {
+         FREE(chunk);
+         return FALSE;
+      }
+
+      setup->chunks[i] = chunk;
+   }
+
+   return TRUE;
+}
+
+
+/**
+ * Bin the triangles queued by lp_setup_queue_tris().
+ *
+ * Must be called before anything which changes the setup state or puts
+ * other commands in the scene.  The triangles are split in chunks, each
+ * binned into a scene of its own by a worker thread, and the chunks are
+ * then appended to the current scene in order.  Triangles following a
+ * chunk which ran out of memory are binned here, where the scene can be
+ * flushed.
+ */
+void
+lp_setup_bin_queued_tris(struct lp_setup_context *setup)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(setup->pipe->screen);
+   const unsigned num_tris = setup->queued.num_tris;
+   unsigned num_chunks, resume = num_tris, i;
+
+   if (!num_tris)
+      return;
+
+   /* Flushing the scene below comes back here. */
+   setup->queued.num_tris = 0;
+   setup->queued.binning = TRUE;
+
+   assert(setup->state == SETUP_ACTIVE);
+   if (setup->triangle == first_triangle)
+      lp_setup_choose_triangle(setup);
+
+   num_chunks = MIN3(num_tris / LP_SETUP_MIN_CHUNK_TRIS,
+                     LP_MAX_SETUP_CHUNKS,
+                     screen->setup_queue.num_threads + 1);
+
+   if (num_chunks < 2 || !alloc_chunks(setup, num_chunks)) {
+      bin_queued_tris(setup, 0, num_tris);
+      setup->queued.data_used = 0;
+      setup->queued.binning = FALSE;
+      return;
+   }
+
+   for (i = 0; i < num_chunks; i++) {
+      struct lp_setup_chunk *chunk = setup->chunks[i];
+
+      memcpy(&chunk->setup, setup, sizeof *setup);
+      chunk->setup.scene = chunk->scene;
+      chunk->setup.chunk = chunk;
+      chunk->first = num_tris * i / num_chunks;
+      chunk->last = num_tris * (i + 1) / num_chunks;
+      chunk->failed = FALSE;
+      lp_scene_begin_chunk(chunk->scene, setup->scene);
+
+      /* the first chunk is binned by this thread */
+      if (i > 0) {
+         util_queue_fence_init(&chunk->fence);
+         util_queue_add_job(&screen->setup_queue, chunk, &chunk->fence,
+                            bin_chunk, NULL);
+      }
+   }
+
+   bin_chunk(setup->chunks[0], 0);
+
+   for (i = 0; i < num_chunks; i++) {
+      struct lp_setup_chunk *chunk = setup->chunks[i];
+
+      if (i > 0) {
+         util_queue_job_wait(&chunk->fence);
+         util_queue_fence_destroy(&chunk->fence);
+      }
+
+      /* Chunks after the first failure are dropped, and their
+       * triangles binned again below.
+       */
+      if (resume == num_tris) {
+         if (!lp_scene_append_chunk(setup->scene, chunk->scene))
+            resume = chunk->first;
+         else if (chunk->failed)
+            resume = chunk->failed_tri;
+      }
+
+      lp_scene_reset(chunk->scene);
+   }
+
+   bin_queued_tris(setup, resume, num_tris);
+   setup->queued.data_used = 0;
+   setup->queued.binning = FALSE;
+}
@@ -43,6 +43,7 @@
 #include "draw/draw_vbuf.h"
 #include "util/u_rect.h"
 #include "util/u_pack_color.h"
+#include "util/u_queue.h"
 
 #define LP_SETUP_NEW_FS          0x01
 #define LP_SETUP_NEW_CONSTANTS   0x02
@@ -54,10 +55,16 @@
 struct lp_setup_variant;
 
 
-/** Max number of scenes */
-/* XXX: make multiple scenes per context work, see lp_setup_rasterize_scene */
-#define MAX_SCENES 1
+/**
+ * Max number of scenes per context.  Scenes are rasterized asynchronously,
+ * so this is how many the setup module can get ahead of the rasterizer.
+ */
+#define MAX_SCENES 4
 
+/** Min number of triangles in a chunk binned by a worker thread */
+#define LP_SETUP_MIN_CHUNK_TRIS 256
+
+struct lp_setup_chunk;
 
 
 /**
@@ -155,6 +162,23 @@ struct lp_setup_context
 
    unsigned dirty;   /**< bitmask of LP_SETUP_NEW_x bits */
 
+   /**
+    * Triangles of consecutive draws with the same state, waiting to be
+    * binned on several threads.  See lp_setup_bin_queued_tris().
+    */
+   struct {
+      uint8_t *data;            /**< copy of the vertices */
+      unsigned data_used, data_size;
+      unsigned *verts;          /**< offsets into data, 3 per triangle */
+      unsigned num_tris, max_tris;
+      boolean binning;          /**< in lp_setup_bin_queued_tris() */
+   } queued;
+
+   struct lp_setup_chunk *chunks[LP_MAX_SETUP_CHUNKS];
+
+   /** The chunk this copy of the context bins, NULL in the context itself */
+   struct lp_setup_chunk *chunk;
+
    void (*point)( struct lp_setup_context *,
                   const float (*v0)[4]);
 
@@ -168,6 +192,21 @@ struct lp_setup_context
                      const float (*v2)[4]);
 };
 
+/**
+ * A range of the queued triangles, binned by a worker thread into a scene
+ * of its own with a copy of the setup context.  The chunks' bins are then
+ * appended to the current scene in order.
+ */
+struct lp_setup_chunk
+{
+   struct lp_setup_context setup;
+   struct lp_scene *scene;
+   unsigned first, last;     /**< range of queued triangles */
+   boolean failed;           /**< ran out of memory */
+   unsigned failed_tri;      /**< first triangle not binned */
+   struct util_queue_fence fence;
+};
+
 static inline void
 scissor_planes_needed(boolean scis_planes[4], const struct u_rect *bbox,
                       const struct u_rect *scissor)
@@ -196,6 +235,14 @@ void lp_setup_destroy( struct lp_setup_context *setup );
 
 boolean lp_setup_flush_and_restart(struct lp_setup_context *setup);
 
+boolean lp_setup_queue_tris(struct lp_setup_context *setup,
+                            const void *vertex_buffer,
+                            unsigned num_vertices,
+                            const ushort *indices,
+                            unsigned nr);
+
+void lp_setup_bin_queued_tris(struct lp_setup_context *setup);
+
 void
 lp_setup_print_triangle(struct lp_setup_context *setup,
                         const float (*v0)[4],
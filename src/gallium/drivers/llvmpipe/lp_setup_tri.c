@@ -236,8 +236,11 @@ lp_setup_whole_tile(struct lp_setup_context *setup,
        * were just active we also can't do the optimization since to get
        * accurate query results we unfortunately need to execute the rendering
        * commands.
+       * - Bins of a chunk binned on a worker thread get appended to the
+       * scene's, resetting them wouldn't drop what's already in the scene.
        */
-      if (!scene->fb.zsbuf && scene->fb_max_layer == 0 && !scene->had_queries) {
+      if (!setup->chunk &&
+          !scene->fb.zsbuf && scene->fb_max_layer == 0 && !scene->had_queries) {
          /*
           * All previous rendering will be overwritten so reset the bin.
           */
@@ -968,6 +971,7 @@ fail:
 
 /**
  * Try to draw the triangle, restart the scene on failure.
+ * Worker threads can't flush the scene, they only record the failure.
  */
 static void retry_triangle_ccw( struct lp_setup_context *setup,
                                 struct fixed_position* position,
@@ -978,6 +982,11 @@ static void retry_triangle_ccw( struct lp_setup_context *setup,
 {
    if (!do_triangle_ccw( setup, position, v0, v1, v2, front ))
    {
+      if (setup->chunk) {
+         setup->chunk->failed = TRUE;
+         return;
+      }
+
       if (!lp_setup_flush_and_restart(setup))
          return;
 
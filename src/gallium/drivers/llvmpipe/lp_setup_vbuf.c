@@ -38,6 +38,7 @@
 
 #include "lp_setup_context.h"
 #include "lp_context.h"
+#include "lp_screen.h"
 #include "draw/draw_vbuf.h"
 #include "draw/draw_vertex.h"
 #include "util/u_memory.h"
@@ -129,6 +130,79 @@ static inline const_float4_ptr get_vert( const void *vertex_buffer,
    return (const_float4_ptr)((char *)vertex_buffer + index * stride);
 }
 
+/**
+ * Queue a list of triangles, to be binned on several threads.
+ * The vertices are copied, draw reuses the vertex buffer.
+ *
+ * Returns FALSE if the triangles have to be binned right away.
+ */
+boolean
+lp_setup_queue_tris(struct lp_setup_context *setup,
+                    const void *vertex_buffer,
+                    unsigned num_vertices,
+                    const ushort *indices,
+                    unsigned nr)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(setup->pipe->screen);
+   struct llvmpipe_context *lp = llvmpipe_context(setup->pipe);
+   const unsigned stride = setup->vertex_info->size * sizeof(float);
+   const unsigned num_tris = nr / 3;
+   const unsigned size = align(num_vertices * stride, 16);
+   unsigned base, *verts, i;
+
+   if (!util_queue_is_initialized(&screen->setup_queue) ||
+       lp->active_statistics_queries)
+      return FALSE;
+
+   if (setup->queued.data_used + size > setup->queued.data_size) {
+      unsigned data_size = MAX2(2 * setup->queued.data_size,
+                                setup->queued.data_used + size);
+      uint8_t *data = align_malloc(data_size, 16);
+
+      if (!data)
+         goto fail;
+
+      if (setup->queued.data_used)
+         memcpy(data, setup->queued.data, setup->queued.data_used);
+      align_free(setup->queued.data);
+      setup->queued.data = data;
+      setup->queued.data_size = data_size;
+   }
+
+   if (setup->queued.num_tris + num_tris > setup->queued.max_tris) {
+      unsigned max_tris = MAX2(2 * setup->queued.max_tris,
+                               setup->queued.num_tris + num_tris);
+
+      verts = REALLOC(setup->queued.verts,
+                      3 * setup->queued.max_tris * sizeof(*verts),
+                      3 * max_tris * sizeof(*verts));
+      if (!verts)
+         goto fail;
+
+      setup->queued.verts = verts;
+      setup->queued.max_tris = max_tris;
+   }
+
+   base = setup->queued.data_used;
+   memcpy(setup->queued.data + base, vertex_buffer, num_vertices * stride);
+   setup->queued.data_used += size;
+
+   verts = setup->queued.verts + 3 * setup->queued.num_tris;
+   for (i = 0; i < 3 * num_tris; i++)
+      verts[i] = base + (indices ? indices[i] : i) * stride;
+   setup->queued.num_tris += num_tris;
+
+   if (setup->queued.num_tris >= LP_MAX_SETUP_CHUNKS * LP_SETUP_MIN_CHUNK_TRIS)
+      lp_setup_bin_queued_tris(setup);
+
+   return TRUE;
+
+fail:
+   lp_setup_bin_queued_tris(setup);
+   return FALSE;
+}
+
+
 /**
  * draw elements / indexed primitives
  */
@@ -146,6 +220,13 @@ lp_setup_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
    if (!lp_setup_update_state(setup, TRUE))
       return;
 
+   if (setup->prim == PIPE_PRIM_TRIANGLES &&
+       lp_setup_queue_tris(setup, vertex_buffer, setup->nr_vertices,
+                           indices, nr))
+      return;
+
+   lp_setup_bin_queued_tris(setup);
+
    switch (setup->prim) {
    case PIPE_PRIM_POINTS:
       for (i = 0; i < nr; i++) {
@@ -344,6 +425,12 @@ lp_setup_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
    if (!lp_setup_update_state(setup, TRUE))
       return;
 
+   if (setup->prim == PIPE_PRIM_TRIANGLES &&
+       lp_setup_queue_tris(setup, vertex_buffer, nr, NULL, nr))
+      return;
+
+   lp_setup_bin_queued_tris(setup);
+
    switch (setup->prim) {
    case PIPE_PRIM_POINTS:
       for (i = 0; i < nr; i++) {
@@ -101,6 +101,7 @@
 #include "lp_flush.h"
 #include "lp_state_fs.h"
 #include "lp_rast.h"
+#include "lp_screen.h"
 
 
 /** Fragment shader number (for debugging) */
@@ -473,7 +474,7 @@ generate_fs_loop(struct gallivm_state *gallivm,
    lp_build_interp_soa_update_inputs_dyn(interp, gallivm, loop_state.counter);
 
    /* Build the actual shader */
-   lp_build_tgsi_soa(gallivm, tokens, type, &mask,
+   lp_build_tgsi_soa(gallivm, tokens, shader->parsed, type, &mask,
                      consts_ptr, num_consts_ptr, &system_values,
                      interp->inputs,
                      outputs, context_ptr, thread_data_ptr,
@@ -2575,8 +2576,12 @@ generate_variant(struct llvmpipe_context *lp,
                  struct lp_fragment_shader *shader,
                  const struct lp_fragment_shader_variant_key *key)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_fragment_shader_variant *variant;
    const struct util_format_description *cbuf0_format_desc;
+   struct lp_cached_code cached;
+   cache_key hash;
+   boolean cache_hit;
    boolean fullcolormask;
    char module_name[64];
 
@@ -2593,6 +2598,11 @@ generate_variant(struct llvmpipe_context *lp,
       return NULL;
    }
 
+   /* Cleared by gallivm_free_ir(), before cached goes out of scope. */
+   memset(&cached, 0, sizeof cached);
+   if (screen->disk_cache)
+      variant->gallivm->cache = &cached;
+
    variant->shader = shader;
    variant->list_item_global.base = variant;
    variant->list_item_local.base = variant;
@@ -2647,6 +2657,9 @@ generate_variant(struct llvmpipe_context *lp,
     * Compile everything
     */
 
+   lp_disk_cache_find_shader(screen, variant->gallivm, hash);
+   cache_hit = cached.data_size != 0;
+
    gallivm_compile_module(variant->gallivm);
 
    variant->nr_instrs += lp_build_count_ir_module(variant->gallivm->module);
@@ -2665,6 +2678,8 @@ generate_variant(struct llvmpipe_context *lp,
       variant->jit_function[RAST_WHOLE] = variant->jit_function[RAST_EDGE_TEST];
    }
 
+   lp_disk_cache_insert_shader(screen, variant->gallivm, hash, cache_hit);
+
    gallivm_free_ir(variant->gallivm);
 
    return variant;
@@ -2693,9 +2708,11 @@ llvmpipe_create_fs_state(struct pipe_context *pipe,
 
    /* we need to keep a local copy of the tokens */
    shader->base.tokens = tgsi_dup_tokens(templ->tokens);
+   shader->parsed = tgsi_parse_shader(shader->base.tokens);
 
    shader->draw_data = draw_create_fragment_shader(llvmpipe->draw, templ);
    if (shader->draw_data == NULL) {
+      tgsi_free_parsed_shader(shader->parsed);
       FREE((void *) shader->base.tokens);
       FREE(shader);
       return NULL;
@@ -2843,6 +2860,7 @@ llvmpipe_delete_fs_state(struct pipe_context *pipe, void *fs)
 
    /* Delete draw module's data */
    draw_delete_fragment_shader(llvmpipe->draw, shader->draw_data);
+   tgsi_free_parsed_shader(shader->parsed);
 
    assert(shader->variants_cached == 0);
    FREE((void *) shader->base.tokens);
@@ -39,6 +39,7 @@
 
 
 struct tgsi_token;
+struct tgsi_parsed_shader;
 struct lp_fragment_shader;
 
 
@@ -128,6 +129,9 @@ struct lp_fragment_shader
 
    struct lp_tgsi_info info;
 
+   /* decoded once for all the variants, may be NULL */
+   struct tgsi_parsed_shader *parsed;
+
    struct lp_fs_variant_list_item variants;
 
    struct draw_fragment_shader *draw_data;
@@ -707,8 +707,12 @@ static struct lp_setup_variant *
 generate_setup_variant(struct lp_setup_variant_key *key,
                        struct llvmpipe_context *lp)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_setup_variant *variant = NULL;
    struct gallivm_state *gallivm;
+   struct lp_cached_code cached;
+   cache_key hash;
+   boolean cache_hit;
    struct lp_setup_args args;
    char func_name[64];
    LLVMTypeRef vec4f_type;
@@ -718,6 +722,8 @@ generate_setup_variant(struct lp_setup_variant_key *key,
    LLVMBuilderRef builder;
    int64_t t0 = 0, t1;
 
+   memset(&cached, 0, sizeof cached);
+
    if (0)
       goto fail;
 
@@ -735,6 +741,10 @@ generate_setup_variant(struct lp_setup_variant_key *key,
       goto fail;
    }
 
+   /* Cleared by gallivm_free_ir(), before cached goes out of scope. */
+   if (screen->disk_cache)
+      gallivm->cache = &cached;
+
    builder = gallivm->builder;
 
    if (LP_DEBUG & DEBUG_COUNTERS) {
@@ -798,6 +808,9 @@ generate_setup_variant(struct lp_setup_variant_key *key,
 
    gallivm_verify_function(gallivm, variant->function);
 
+   lp_disk_cache_find_shader(screen, gallivm, hash);
+   cache_hit = cached.data_size != 0;
+
    gallivm_compile_module(gallivm);
 
    variant->jit_function = (lp_jit_setup_triangle)
@@ -805,6 +818,8 @@ generate_setup_variant(struct lp_setup_variant_key *key,
    if (!variant->jit_function)
       goto fail;
 
+   lp_disk_cache_insert_shader(screen, gallivm, hash, cache_hit);
+
    gallivm_free_ir(variant->gallivm);
 
    /*
@@ -826,6 +841,8 @@ fail:
       FREE(variant);
    }
 
+   free(cached.data);
+
    return NULL;
 }
 
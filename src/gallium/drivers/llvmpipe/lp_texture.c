@@ -324,7 +324,7 @@ llvmpipe_resource_destroy(struct pipe_screen *pscreen,
    }
    else if (llvmpipe_resource_is_texture(pt)) {
       /* free linear image data */
-      if (lpr->tex_data) {
+      if (lpr->tex_data && !lpr->userBuffer) {
          align_free(lpr->tex_data);
          lpr->tex_data = NULL;
       }
@@ -483,6 +483,61 @@ no_lpr:
 }
 
 
+/**
+ * Create a texture which wraps user memory.
+ *
+ * Only single-level 2D textures whose rows are laid out exactly as
+ * llvmpipe_texture_layout() would lay them out, without any padding, are
+ * supported: the width and height must be multiples of the raster block
+ * size, and the rows must be a multiple of the cache line size.
+ */
+static struct pipe_resource *
+llvmpipe_resource_from_user_memory(struct pipe_screen *_screen,
+                                   const struct pipe_resource *templat,
+                                   void *user_memory)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(_screen);
+   struct llvmpipe_resource *lpr;
+
+   if ((templat->target != PIPE_TEXTURE_2D &&
+        templat->target != PIPE_TEXTURE_RECT) ||
+       templat->last_level != 0 ||
+       templat->depth0 != 1 ||
+       templat->array_size != 1 ||
+       templat->nr_samples > 1 ||
+       util_format_is_compressed(templat->format) ||
+       templat->width0 % LP_RASTER_BLOCK_SIZE != 0 ||
+       templat->height0 % LP_RASTER_BLOCK_SIZE != 0 ||
+       (uintptr_t) user_memory % MAX2(64, util_cpu_caps.cacheline) != 0)
+      return NULL;
+
+   lpr = CALLOC_STRUCT(llvmpipe_resource);
+   if (!lpr)
+      return NULL;
+
+   lpr->base = *templat;
+   pipe_reference_init(&lpr->base.reference, 1);
+   lpr->base.screen = _screen;
+
+   if (!llvmpipe_texture_layout(screen, lpr, false) ||
+       lpr->row_stride[0] != templat->width0 *
+                             util_format_get_blocksize(templat->format)) {
+      FREE(lpr);
+      return NULL;
+   }
+
+   lpr->tex_data = user_memory;
+   lpr->userBuffer = TRUE;
+   lpr->id = id_counter++;
+
+#ifdef DEBUG
+   insert_at_tail(&resource_list, lpr);
+#endif
+
+   return &lpr->base;
+}
+
+
 static boolean
 llvmpipe_resource_get_handle(struct pipe_screen *screen,
                              struct pipe_context *ctx,
@@ -805,6 +860,7 @@ llvmpipe_init_screen_resource_funcs(struct pipe_screen *screen)
 /*   screen->resource_create_front = llvmpipe_resource_create_front; */
    screen->resource_destroy = llvmpipe_resource_destroy;
    screen->resource_from_handle = llvmpipe_resource_from_handle;
+   screen->resource_from_user_memory = llvmpipe_resource_from_user_memory;
    screen->resource_get_handle = llvmpipe_resource_get_handle;
    screen->can_create_resource = llvmpipe_can_create_resource;
 }
@@ -39,6 +39,11 @@ LOCAL_SRC_FILES := \
 LOCAL_SHARED_LIBRARIES := libdrm_nouveau
 LOCAL_MODULE := libmesa_pipe_nouveau
 
+LOCAL_GENERATED_SOURCES := $(MESA_GEN_NIR_H)
+
+# We need libmesa_nir to get NIR's generated include directories.
+LOCAL_STATIC_LIBRARIES := libmesa_nir
+
 ifeq ($(MESA_LOLLIPOP_BUILD),true)
 LOCAL_C_INCLUDES := external/libcxx/include
 else
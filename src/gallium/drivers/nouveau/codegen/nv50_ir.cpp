@@ -144,6 +144,8 @@ ValueRef::set(Value *refVal)
       value->uses.erase(this);
    if (refVal)
       refVal->uses.insert(this);
+   if (insn && insn->bb)
+      insn->bb->invalidateLiveness();
 
    value = refVal;
 }
@@ -157,6 +159,8 @@ ValueDef::set(Value *defVal)
       value->defs.remove(this);
    if (defVal)
       defVal->defs.push_back(this);
+   if (insn && insn->bb)
+      insn->bb->invalidateLiveness();
 
    value = defVal;
 }
@@ -234,6 +238,8 @@ LValue::LValue(Function *fn, DataFile file)
    fixedReg = 0;
    noSpill = 0;
 
+   livei.setPool(&fn->getProgram()->mem_Range);
+
    fn->add(this, this->id);
 }
 
@@ -251,6 +257,8 @@ LValue::LValue(Function *fn, LValue *lval)
    fixedReg = 0;
    noSpill = 0;
 
+   livei.setPool(&fn->getProgram()->mem_Range);
+
    fn->add(this, this->id);
 }
 
@@ -1106,7 +1114,8 @@ Program::Program(Type type, Target *arch)
      mem_FlowInstruction(sizeof(FlowInstruction), 4),
      mem_LValue(sizeof(LValue), 8),
      mem_Symbol(sizeof(Symbol), 7),
-     mem_ImmediateValue(sizeof(ImmediateValue), 7)
+     mem_ImmediateValue(sizeof(ImmediateValue), 7),
+     mem_Range(Interval::getRangeSize(), 8)
 {
    code = NULL;
    binSize = 0;
@@ -1227,6 +1236,9 @@ nv50_ir_generate_code(struct nv50_ir_prog_info *info)
    prog->optLevel = info->optLevel;
 
    switch (info->bin.sourceRep) {
+   case NV50_PROGRAM_IR_NIR:
+      ret = prog->makeFromNIR(info) ? 0 : -2;
+      break;
 #if 0
    case PIPE_IR_LLVM:
    case PIPE_IR_GLSL:
@@ -1256,6 +1268,8 @@ nv50_ir_generate_code(struct nv50_ir_prog_info *info)
    prog->optimizeSSA(info->optLevel);
    prog->getTarget()->runLegalizePass(prog, nv50_ir::CG_STAGE_SSA);
 
+   prog->scheduleInstructions(info->optLevel);
+
    if (prog->dbgFlags & NV50_IR_DEBUG_BASIC)
       prog->print();
 
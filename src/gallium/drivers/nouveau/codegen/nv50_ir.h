@@ -1104,8 +1104,11 @@ public:
    BasicBlock *splitBefore(Instruction *, bool attach = true);
    BasicBlock *splitAfter(Instruction *, bool attach = true);
 
-   DLList& getDF() { return df; }
-   DLList::Iterator iterDF() { return df.iterator(); }
+   // dominance frontier, indexed by block id
+   BitSet& getDF() { return df; }
+
+   // the block's uses and defs have to be rescanned by buildLiveSets
+   inline void invalidateLiveness() { liveValid = false; }
 
    static inline BasicBlock *get(Iterator&);
    static inline BasicBlock *get(Graph::Node *);
@@ -1117,6 +1120,12 @@ public:
    BitSet liveSet;
    BitSet defSet;
 
+   // values used before being assigned and values assigned in the block,
+   // kept between liveness computations while liveValid is set
+   BitSet liveUses;
+   BitSet liveDefs;
+   bool liveValid;
+
    uint32_t binPos;
    uint32_t binSize;
 
@@ -1126,7 +1135,7 @@ public:
 
 private:
    int id;
-   DLList df;
+   BitSet df;
 
    Instruction *phi;
    Instruction *entry;
@@ -1202,7 +1211,7 @@ public:
    ArrayList allLValues;
 
 private:
-   void buildLiveSetsPreSSA(BasicBlock *, const int sequence);
+   void buildLiveUses(BasicBlock *);
    void buildDefSetsPreSSA(BasicBlock *bb, const int seq);
 
 private:
@@ -1244,9 +1253,11 @@ public:
    inline void add(Value *rval, int& id) { allRValues.insert(rval, id); }
 
    bool makeFromTGSI(struct nv50_ir_prog_info *);
+   bool makeFromNIR(struct nv50_ir_prog_info *);
    bool makeFromSM4(struct nv50_ir_prog_info *);
    bool convertToSSA();
    bool optimizeSSA(int level);
+   bool scheduleInstructions(int level);
    bool optimizePostRA(int level);
    bool registerAllocation();
    bool emitBinary(struct nv50_ir_prog_info *);
@@ -1279,6 +1290,7 @@ public:
    MemoryPool mem_LValue;
    MemoryPool mem_Symbol;
    MemoryPool mem_ImmediateValue;
+   MemoryPool mem_Range; // for the live intervals of LValues
 
    uint32_t dbgFlags;
    uint8_t  optLevel;
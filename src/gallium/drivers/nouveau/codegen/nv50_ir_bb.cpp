@@ -82,6 +82,7 @@ BasicBlock::BasicBlock(Function *fn) : cfg(this), dom(this), func(fn)
    binSize = 0;
 
    explicitCont = false;
+   liveValid = false;
 
    func->add(this, this->id);
 }
@@ -134,6 +135,7 @@ BasicBlock::insertHead(Instruction *inst)
             phi = exit = inst;
             inst->bb = this;
             ++numInsns;
+            liveValid = false;
          }
       }
    } else {
@@ -147,6 +149,7 @@ BasicBlock::insertHead(Instruction *inst)
             entry = exit = inst;
             inst->bb = this;
             ++numInsns;
+            liveValid = false;
          }
       }
    }
@@ -169,6 +172,7 @@ BasicBlock::insertTail(Instruction *inst)
          phi = exit = inst;
          inst->bb = this;
          ++numInsns;
+         liveValid = false;
       }
    } else {
       if (exit) {
@@ -178,6 +182,7 @@ BasicBlock::insertTail(Instruction *inst)
          entry = exit = inst;
          inst->bb = this;
          ++numInsns;
+         liveValid = false;
       }
    }
 }
@@ -210,6 +215,7 @@ BasicBlock::insertBefore(Instruction *q, Instruction *p)
 
    p->bb = this;
    ++numInsns;
+   liveValid = false;
 }
 
 void
@@ -233,6 +239,7 @@ BasicBlock::insertAfter(Instruction *p, Instruction *q)
 
    q->bb = this;
    ++numInsns;
+   liveValid = false;
 }
 
 void
@@ -262,6 +269,7 @@ BasicBlock::remove(Instruction *insn)
       phi = (insn->next && insn->next->op == OP_PHI) ? insn->next : 0;
 
    --numInsns;
+   liveValid = false;
    insn->bb = NULL;
    insn->next =
    insn->prev = NULL;
@@ -293,6 +301,8 @@ void BasicBlock::permuteAdjacent(Instruction *a, Instruction *b)
       b->prev->next = b;
    if (a->next)
       a->next->prev = a;
+
+   liveValid = false;
 }
 
 void
@@ -322,6 +332,7 @@ BasicBlock::splitCommon(Instruction *insn, BasicBlock *bb, bool attach)
       insn->bb = bb;
       bb->exit = insn;
    }
+   this->liveValid = false;
    if (attach)
       this->cfg.attach(&bb->cfg, Graph::Edge::TREE);
 }
@@ -429,14 +440,90 @@ Function::orderInstructions(ArrayList &result)
    return result.getSize();
 }
 
+// Collect the values used before being assigned in bb and the values it
+// assigns. The sources of PHIs are live out of the incoming blocks instead.
+void
+Function::buildLiveUses(BasicBlock *bb)
+{
+   const unsigned int size = allLValues.getSize();
+   Instruction *i;
+
+   bb->liveUses.allocate(size, true);
+   bb->liveDefs.allocate(size, true);
+
+   for (i = bb->getExit(); i && i->op != OP_PHI; i = i->prev) {
+      for (int d = 0; i->defExists(d); ++d) {
+         if (!i->getDef(d)->asLValue())
+            continue;
+         bb->liveUses.clr(i->getDef(d)->id);
+         bb->liveDefs.set(i->getDef(d)->id);
+      }
+      for (int s = 0; i->srcExists(s); ++s)
+         if (i->getSrc(s)->asLValue())
+            bb->liveUses.set(i->getSrc(s)->id);
+   }
+   for (; i; i = i->prev) {
+      bb->liveUses.clr(i->getDef(0)->id);
+      bb->liveDefs.set(i->getDef(0)->id);
+   }
+
+   bb->liveValid = true;
+}
+
+// liveIn(bb) = liveUses(bb) U (liveOut(bb) - liveDefs(bb))
+//
+// Iterates over the blocks in post-order until the sets are stable. Only
+// blocks which have been modified since the last call are scanned again.
 void
 Function::buildLiveSets()
 {
-   for (unsigned i = 0; i <= loopNestingBound; ++i)
-      buildLiveSetsPreSSA(BasicBlock::get(cfg.getRoot()), cfg.nextSequence());
+   const unsigned int size = allLValues.getSize();
+   BasicBlock *exitBB = cfgExit ? BasicBlock::get(cfgExit) : NULL;
+   std::vector<BasicBlock *> order;
+   BitSet live(size, true);
+   bool changed;
+
+   order.reserve(cfg.getSize());
+   for (IteratorRef it = cfg.iteratorDFS(false); !it->end(); it->next()) {
+      BasicBlock *bb =
+         BasicBlock::get(reinterpret_cast<Graph::Node *>(it->get()));
 
-   for (ArrayList::Iterator bi = allBBlocks.iterator(); !bi.end(); bi.next())
-      BasicBlock::get(bi)->liveSet.marker = false;
+      if (bb->liveValid) {
+         bb->liveUses.resize(size);
+         bb->liveDefs.resize(size);
+      } else {
+         buildLiveUses(bb);
+      }
+      bb->liveSet.allocate(size, false);
+      bb->liveSet = bb->liveUses;
+      order.push_back(bb);
+   }
+
+   do {
+      changed = false;
+      for (std::vector<BasicBlock *>::iterator it = order.begin();
+           it != order.end(); ++it) {
+         BasicBlock *bb = *it;
+
+         live.fill(0);
+         for (Graph::EdgeIterator ei = bb->cfg.outgoing(); !ei.end(); ei.next())
+            live |= BasicBlock::get(ei.getNode())->liveSet;
+         if (bb == exitBB) {
+            for (std::deque<ValueRef>::iterator o = outs.begin();
+                 o != outs.end(); ++o) {
+               assert(o->get()->asLValue());
+               live.set(o->get()->id);
+            }
+         }
+         live.andNot(bb->liveDefs);
+         live |= bb->liveUses;
+
+         if (live != bb->liveSet) {
+            bb->liveSet = live;
+            changed = true;
+         }
+      }
+   } while (changed);
 }
 
 void
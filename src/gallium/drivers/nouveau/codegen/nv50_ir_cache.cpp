@@ -0,0 +1,288 @@
+/*
+ * Copyright 2016 Nouveau Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "codegen/nv50_ir.h"
+#include "codegen/nv50_ir_target.h"
+#include "codegen/nv50_ir_driver.h"
+
+extern "C" {
+#include "tgsi/tgsi_parse.h"
+#include "util/disk_cache.h"
+#include "util/mesa-sha1.h"
+}
+
+#include "git_sha1.h"
+
+// Storage of the results of nv50_ir_generate_code in the on-disk shader
+// cache. An entry holds the nv50_ir_prog_info as filled in by the code
+// generator, followed by the code, the relocations, the fixups and the
+// symbol table.
+
+namespace nv50_ir {
+
+static const FixupApply fixupApplies[] =
+{
+   nv50_interpApply,
+   nv50_alphatestSet,
+   nvc0_interpApply,
+   nvc0_selpFlip,
+   gk110_interpApply,
+   gk110_selpFlip,
+   gm107_interpApply,
+   gm107_selpFlip,
+};
+
+struct CacheHeader
+{
+   uint32_t codeSize;
+   uint32_t relocCount;
+   uint32_t fixupCount;
+   uint32_t numSyms;
+};
+
+// function pointers can't be stored, fixups are written as (index, value)
+struct CacheFixup
+{
+   uint32_t apply;
+   uint32_t val;
+};
+
+static void
+computeKey(const struct nv50_ir_prog_info *info, cache_key key)
+{
+   static const char buildId[] =
+#ifdef PACKAGE_VERSION
+      PACKAGE_VERSION
+#endif
+#ifdef MESA_GIT_SHA1
+      MESA_GIT_SHA1
+#endif
+      "";
+   const struct tgsi_token *tokens =
+      reinterpret_cast<const struct tgsi_token *>(info->bin.source);
+   struct nv50_ir_prog_info input;
+
+   // The driver only fills in the inputs, so everything but the pointers
+   // identifies the program. The structure was allocated zeroed, copying
+   // it keeps the padding clean.
+   memcpy(&input, info, sizeof(input));
+   input.bin.source = NULL;
+   input.assignSlots = NULL;
+   input.driverPriv = NULL;
+
+   struct mesa_sha1 *sha1 = _mesa_sha1_init();
+   _mesa_sha1_update(sha1, buildId, sizeof(buildId));
+   _mesa_sha1_update(sha1, &input, sizeof(input));
+   _mesa_sha1_update(sha1, tokens,
+                     tgsi_num_tokens(tokens) * sizeof(struct tgsi_token));
+   _mesa_sha1_final(sha1, key);
+}
+
+static void *
+serialize(const struct nv50_ir_prog_info *info, size_t *size)
+{
+   const RelocInfo *reloc =
+      reinterpret_cast<const RelocInfo *>(info->bin.relocData);
+   const FixupInfo *fixup =
+      reinterpret_cast<const FixupInfo *>(info->bin.fixupData);
+   CacheHeader hdr;
+
+   hdr.codeSize = info->bin.codeSize;
+   hdr.relocCount = reloc ? reloc->count : 0;
+   hdr.fixupCount = fixup ? fixup->count : 0;
+   hdr.numSyms = info->bin.syms ? info->bin.numSyms : 0;
+
+   *size = sizeof(hdr) + sizeof(*info) + hdr.codeSize +
+      hdr.fixupCount * sizeof(CacheFixup) +
+      hdr.numSyms * sizeof(struct nv50_ir_prog_symbol);
+   if (reloc)
+      *size += sizeof(RelocInfo) + hdr.relocCount * sizeof(RelocEntry);
+
+   uint8_t *data = reinterpret_cast<uint8_t *>(MALLOC(*size));
+   if (!data)
+      return NULL;
+   uint8_t *pos = data;
+
+   memcpy(pos, &hdr, sizeof(hdr));
+   pos += sizeof(hdr);
+   memcpy(pos, info, sizeof(*info));
+   pos += sizeof(*info);
+   memcpy(pos, info->bin.code, hdr.codeSize);
+   pos += hdr.codeSize;
+   if (reloc) {
+      const size_t relocSize =
+         sizeof(RelocInfo) + hdr.relocCount * sizeof(RelocEntry);
+      memcpy(pos, reloc, relocSize);
+      pos += relocSize;
+   }
+   for (unsigned int i = 0; i < hdr.fixupCount; ++i) {
+      CacheFixup entry;
+      unsigned int k;
+
+      for (k = 0; k < ARRAY_SIZE(fixupApplies); ++k)
+         if (fixupApplies[k] == fixup->entry[i].apply)
+            break;
+      if (k == ARRAY_SIZE(fixupApplies)) {
+         FREE(data);
+         return NULL;
+      }
+      entry.apply = k;
+      entry.val = fixup->entry[i].val;
+      memcpy(pos, &entry, sizeof(entry));
+      pos += sizeof(entry);
+   }
+   memcpy(pos, info->bin.syms, hdr.numSyms * sizeof(*info->bin.syms));
+
+   return data;
+}
+
+static bool
+deserialize(struct nv50_ir_prog_info *info, const uint8_t *data, size_t size)
+{
+   const uint8_t *pos = data;
+   struct nv50_ir_prog_info out;
+   CacheHeader hdr;
+
+   if (size < sizeof(hdr) + sizeof(out))
+      return false;
+   memcpy(&hdr, pos, sizeof(hdr));
+   pos += sizeof(hdr);
+   memcpy(&out, pos, sizeof(out));
+   pos += sizeof(out);
+
+   const size_t relocSize = out.bin.relocData ?
+      sizeof(RelocInfo) + hdr.relocCount * sizeof(RelocEntry) : 0;
+   if (size != sizeof(hdr) + sizeof(out) + hdr.codeSize + relocSize +
+       hdr.fixupCount * sizeof(CacheFixup) +
+       hdr.numSyms * sizeof(struct nv50_ir_prog_symbol))
+      return false;
+
+   uint32_t *code = NULL;
+   RelocInfo *reloc = NULL;
+   FixupInfo *fixup = NULL;
+   struct nv50_ir_prog_symbol *syms = NULL;
+
+   if (hdr.codeSize) {
+      code = reinterpret_cast<uint32_t *>(MALLOC(hdr.codeSize));
+      if (!code)
+         goto fail;
+      memcpy(code, pos, hdr.codeSize);
+      pos += hdr.codeSize;
+   }
+   if (relocSize) {
+      reloc = reinterpret_cast<RelocInfo *>(MALLOC(relocSize));
+      if (!reloc)
+         goto fail;
+      memcpy(reloc, pos, relocSize);
+      pos += relocSize;
+   }
+   if (out.bin.fixupData) {
+      fixup = reinterpret_cast<FixupInfo *>(
+         MALLOC(sizeof(FixupInfo) + hdr.fixupCount * sizeof(FixupEntry)));
+      if (!fixup)
+         goto fail;
+      fixup->count = hdr.fixupCount;
+      for (unsigned int i = 0; i < hdr.fixupCount; ++i) {
+         CacheFixup entry;
+         memcpy(&entry, pos, sizeof(entry));
+         pos += sizeof(entry);
+         if (entry.apply >= ARRAY_SIZE(fixupApplies))
+            goto fail;
+         fixup->entry[i].apply = fixupApplies[entry.apply];
+         fixup->entry[i].val = entry.val;
+      }
+   }
+   if (out.bin.syms) {
+      syms = reinterpret_cast<struct nv50_ir_prog_symbol *>(
+         MALLOC(MAX2(hdr.numSyms, 1) * sizeof(*syms)));
+      if (!syms)
+         goto fail;
+      memcpy(syms, pos, hdr.numSyms * sizeof(*syms));
+   }
+
+   // keep what the driver passed in, the rest is the generator's output
+   out.bin.source = info->bin.source;
+   out.bin.code = code;
+   out.bin.relocData = reloc;
+   out.bin.fixupData = fixup;
+   out.bin.syms = syms;
+   out.immd.buf = NULL;
+   out.immd.data = NULL;
+   out.immd.type = NULL;
+   out.assignSlots = info->assignSlots;
+   out.driverPriv = info->driverPriv;
+   memcpy(info, &out, sizeof(out));
+   return true;
+
+fail:
+   FREE(code);
+   FREE(reloc);
+   FREE(fixup);
+   FREE(syms);
+   return false;
+}
+
+} // namespace nv50_ir
+
+extern "C" {
+
+int
+nv50_ir_generate_code_cached(struct nv50_ir_prog_info *info,
+                             struct disk_cache *cache)
+{
+   cache_key key;
+   size_t size;
+
+   // debug output is expected to show up every time
+   if (!cache || info->dbgFlags ||
+       info->bin.sourceRep != NV50_PROGRAM_IR_TGSI)
+      return nv50_ir_generate_code(info);
+
+   nv50_ir::computeKey(info, key);
+
+   void *data = disk_cache_get(cache, key, &size);
+   if (data) {
+      bool hit = nv50_ir::deserialize(info,
+                                      reinterpret_cast<uint8_t *>(data), size);
+      free(data);
+      if (hit) {
+         // The slots are part of the cached info, but the driver may also
+         // record state of its own while assigning them.
+         if (info->assignSlots && info->assignSlots(info))
+            return -2;
+         return 0;
+      }
+   }
+
+   int ret = nv50_ir_generate_code(info);
+   if (ret)
+      return ret;
+
+   data = nv50_ir::serialize(info, &size);
+   if (data) {
+      disk_cache_put(cache, key, data, size);
+      FREE(data);
+   }
+   return 0;
+}
+
+}
@@ -58,6 +58,7 @@ struct nv50_ir_varying
 #define NV50_PROGRAM_IR_SM4  1
 #define NV50_PROGRAM_IR_GLSL 2
 #define NV50_PROGRAM_IR_LLVM 3
+#define NV50_PROGRAM_IR_NIR  4
 
 #ifdef DEBUG
 # define NV50_IR_DEBUG_BASIC     (1 << 0)
@@ -196,8 +197,14 @@ struct nv50_ir_prog_info
 extern "C" {
 #endif
 
+struct disk_cache;
+
 extern int nv50_ir_generate_code(struct nv50_ir_prog_info *);
 
+/* same as nv50_ir_generate_code, but goes through the on-disk shader cache */
+extern int nv50_ir_generate_code_cached(struct nv50_ir_prog_info *,
+                                        struct disk_cache *);
+
 extern void nv50_ir_relocate_code(void *relocData, uint32_t *code,
                                   uint32_t codePos,
                                   uint32_t libPos,
@@ -212,6 +219,11 @@ nv50_ir_apply_fixups(void *fixupData, uint32_t *code,
 extern void nv50_ir_get_target_library(uint32_t chipset,
                                        const uint32_t **code, uint32_t *size);
 
+/* options the NIR front end expects the state tracker to compile with */
+struct nir_shader_compiler_options;
+extern const struct nir_shader_compiler_options *
+nv50_ir_nir_shader_compiler_options(int chipset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1161,8 +1161,8 @@ CodeEmitterGK110::emitSLCT(const CmpInstruction *i)
    }
 }
 
-static void
-selpFlip(const FixupEntry *entry, uint32_t *code, const FixupData& data)
+void
+gk110_selpFlip(const FixupEntry *entry, uint32_t *code, const FixupData& data)
 {
    int loc = entry->loc;
    if (data.force_persample_interp)
@@ -1179,7 +1179,7 @@ void CodeEmitterGK110::emitSELP(const Instruction *i)
       code[1] |= 1 << 13;
 
    if (i->subOp == 1) {
-      addInterp(0, 0, selpFlip);
+      addInterp(0, 0, gk110_selpFlip);
    }
 }
 
@@ -1927,8 +1927,9 @@ CodeEmitterGK110::emitInterpMode(const Instruction *i)
    code[1] |= (i->ipa & 0xc) << (19 - 2);
 }
 
-static void
-interpApply(const FixupEntry *entry, uint32_t *code, const FixupData& data)
+void
+gk110_interpApply(const FixupEntry *entry, uint32_t *code,
+                  const FixupData& data)
 {
    int ipa = entry->ipa;
    int reg = entry->reg;
@@ -1963,10 +1964,10 @@ CodeEmitterGK110::emitINTERP(const Instruction *i)
 
    if (i->op == OP_PINTERP) {
       srcId(i->src(1), 23);
-      addInterp(i->ipa, SDATA(i->src(1)).id, interpApply);
+      addInterp(i->ipa, SDATA(i->src(1)).id, gk110_interpApply);
    } else {
       code[0] |= 0xff << 23;
-      addInterp(i->ipa, 0xff, interpApply);
+      addInterp(i->ipa, 0xff, gk110_interpApply);
    }
 
    srcId(i->src(0).getIndirect(0), 10);
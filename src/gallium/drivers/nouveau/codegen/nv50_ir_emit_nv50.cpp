@@ -881,8 +881,8 @@ CodeEmitterNV50::emitPFETCH(const Instruction *i)
    emitFlagsRd(i);
 }
 
-static void
-interpApply(const FixupEntry *entry, uint32_t *code, const FixupData& data)
+void
+nv50_interpApply(const FixupEntry *entry, uint32_t *code, const FixupData& data)
 {
    int ipa = entry->ipa;
    int encSize = entry->reg;
@@ -934,7 +934,7 @@ CodeEmitterNV50::emitINTERP(const Instruction *i)
       emitFlagsRd(i);
    }
 
-   addInterp(i->ipa, i->encSize, interpApply);
+   addInterp(i->ipa, i->encSize, nv50_interpApply);
 }
 
 void
@@ -1265,8 +1265,9 @@ CodeEmitterNV50::emitISAD(const Instruction *i)
    }
 }
 
-static void
-alphatestSet(const FixupEntry *entry, uint32_t *code, const FixupData& data)
+void
+nv50_alphatestSet(const FixupEntry *entry, uint32_t *code,
+                  const FixupData& data)
 {
    int loc = entry->loc;
    int enc;
@@ -1318,7 +1319,7 @@ CodeEmitterNV50::emitSET(const Instruction *i)
    emitForm_MAD(i);
 
    if (i->subOp == 1) {
-      addInterp(0, 0, alphatestSet);
+      addInterp(0, 0, nv50_alphatestSet);
    }
 }
 
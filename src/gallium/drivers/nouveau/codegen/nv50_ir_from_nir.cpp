@@ -0,0 +1,1675 @@
+/*
+ * Copyright 2016 Nouveau Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "compiler/nir/nir.h"
+
+#include <vector>
+
+#include "codegen/nv50_ir.h"
+#include "codegen/nv50_ir_build_util.h"
+#include "codegen/nv50_ir_driver.h"
+
+// Translation of NIR vertex and fragment shaders into nv50 IR.
+//
+// NIR is optimized and scalarized first, so that CSE, constant folding and
+// the algebraic rules run on the source program. Its SSA values then map
+// directly onto SSA values of nv50 IR and its phis onto OP_PHI, the only
+// multiply defined values left for convertToSSA are the fragment outputs.
+
+namespace {
+
+using namespace nv50_ir;
+
+static nv50_ir::TexTarget
+translateTexTarget(const nir_tex_instr *tex)
+{
+   switch (tex->sampler_dim) {
+   case GLSL_SAMPLER_DIM_1D:
+      if (tex->is_array)
+         return tex->is_shadow ?
+            TEX_TARGET_1D_ARRAY_SHADOW : TEX_TARGET_1D_ARRAY;
+      return tex->is_shadow ? TEX_TARGET_1D_SHADOW : TEX_TARGET_1D;
+   case GLSL_SAMPLER_DIM_2D:
+   case GLSL_SAMPLER_DIM_EXTERNAL:
+      if (tex->is_array)
+         return tex->is_shadow ?
+            TEX_TARGET_2D_ARRAY_SHADOW : TEX_TARGET_2D_ARRAY;
+      return tex->is_shadow ? TEX_TARGET_2D_SHADOW : TEX_TARGET_2D;
+   case GLSL_SAMPLER_DIM_3D:
+      return TEX_TARGET_3D;
+   case GLSL_SAMPLER_DIM_CUBE:
+      if (tex->is_array)
+         return tex->is_shadow ?
+            TEX_TARGET_CUBE_ARRAY_SHADOW : TEX_TARGET_CUBE_ARRAY;
+      return tex->is_shadow ? TEX_TARGET_CUBE_SHADOW : TEX_TARGET_CUBE;
+   case GLSL_SAMPLER_DIM_RECT:
+      return tex->is_shadow ? TEX_TARGET_RECT_SHADOW : TEX_TARGET_RECT;
+   case GLSL_SAMPLER_DIM_BUF:
+      return TEX_TARGET_BUFFER;
+   case GLSL_SAMPLER_DIM_MS:
+      return tex->is_array ? TEX_TARGET_2D_MS_ARRAY : TEX_TARGET_2D_MS;
+   default:
+      assert(!"invalid sampler dimension");
+      return TEX_TARGET_2D;
+   }
+}
+
+static void
+translateVarying(unsigned int location, unsigned int *sn, unsigned int *si)
+{
+   *si = 0;
+
+   switch (location) {
+   case VARYING_SLOT_POS:
+      *sn = TGSI_SEMANTIC_POSITION;
+      break;
+   case VARYING_SLOT_COL0:
+   case VARYING_SLOT_COL1:
+      *sn = TGSI_SEMANTIC_COLOR;
+      *si = location - VARYING_SLOT_COL0;
+      break;
+   case VARYING_SLOT_BFC0:
+   case VARYING_SLOT_BFC1:
+      *sn = TGSI_SEMANTIC_BCOLOR;
+      *si = location - VARYING_SLOT_BFC0;
+      break;
+   case VARYING_SLOT_FOGC:
+      *sn = TGSI_SEMANTIC_FOG;
+      break;
+   case VARYING_SLOT_PSIZ:
+      *sn = TGSI_SEMANTIC_PSIZE;
+      break;
+   case VARYING_SLOT_EDGE:
+      *sn = TGSI_SEMANTIC_EDGEFLAG;
+      break;
+   case VARYING_SLOT_CLIP_VERTEX:
+      *sn = TGSI_SEMANTIC_CLIPVERTEX;
+      break;
+   case VARYING_SLOT_CLIP_DIST0:
+   case VARYING_SLOT_CLIP_DIST1:
+      *sn = TGSI_SEMANTIC_CLIPDIST;
+      *si = location - VARYING_SLOT_CLIP_DIST0;
+      break;
+   case VARYING_SLOT_PRIMITIVE_ID:
+      *sn = TGSI_SEMANTIC_PRIMID;
+      break;
+   case VARYING_SLOT_LAYER:
+      *sn = TGSI_SEMANTIC_LAYER;
+      break;
+   case VARYING_SLOT_VIEWPORT:
+      *sn = TGSI_SEMANTIC_VIEWPORT_INDEX;
+      break;
+   case VARYING_SLOT_FACE:
+      *sn = TGSI_SEMANTIC_FACE;
+      break;
+   case VARYING_SLOT_PNTC:
+      *sn = TGSI_SEMANTIC_PCOORD;
+      break;
+   default:
+      if (location >= VARYING_SLOT_TEX0 && location <= VARYING_SLOT_TEX7) {
+         *sn = TGSI_SEMANTIC_TEXCOORD;
+         *si = location - VARYING_SLOT_TEX0;
+      } else {
+         assert(location >= VARYING_SLOT_VAR0);
+         *sn = TGSI_SEMANTIC_GENERIC;
+         *si = location - VARYING_SLOT_VAR0;
+      }
+      break;
+   }
+}
+
+static void
+translateFragResult(unsigned int location, unsigned int index,
+                    unsigned int *sn, unsigned int *si)
+{
+   *si = 0;
+
+   switch (location) {
+   case FRAG_RESULT_DEPTH:
+      *sn = TGSI_SEMANTIC_POSITION;
+      break;
+   case FRAG_RESULT_SAMPLE_MASK:
+      *sn = TGSI_SEMANTIC_SAMPLEMASK;
+      break;
+   case FRAG_RESULT_COLOR:
+      *sn = TGSI_SEMANTIC_COLOR;
+      *si = index;
+      break;
+   default:
+      assert(location >= FRAG_RESULT_DATA0);
+      *sn = TGSI_SEMANTIC_COLOR;
+      *si = location - FRAG_RESULT_DATA0 + index;
+      break;
+   }
+}
+
+class Converter : public BuildUtil
+{
+public:
+   Converter(Program *, nir_shader *, struct nv50_ir_prog_info *);
+
+   bool scan();
+   bool run();
+
+private:
+   struct PhiFixup {
+      Instruction *insn;
+      nir_phi_instr *phi;
+      unsigned int c;
+   };
+
+   bool scanVariables(struct exec_list *, bool output);
+   void scanIntrinsic(nir_intrinsic_instr *);
+
+   bool visitCFList(struct exec_list *);
+   bool visitBlock(nir_block *);
+   bool visitIf(nir_if *);
+   bool visitLoop(nir_loop *);
+   bool visitInstr(nir_instr *);
+   bool visitALU(nir_alu_instr *);
+   bool visitIntrinsic(nir_intrinsic_instr *);
+   bool visitTex(nir_tex_instr *);
+   bool visitJump(nir_jump_instr *);
+   void visitPhi(nir_phi_instr *);
+   void resolvePhis();
+
+   Value *getSrc(const nir_src *, unsigned int c);
+   Value *getAluSrc(nir_alu_instr *, unsigned int s, unsigned int c);
+   Value *getIndirect(const nir_src *, int *offset);
+   void setDef(nir_ssa_def *, unsigned int c, Value *);
+
+   Value *interpolate(int idx, unsigned int c, Value *ptr);
+   void storeOutput(int idx, unsigned int c, Value *val, Value *ptr);
+   Value *loadSysVal(nir_intrinsic_instr *, unsigned int c);
+
+   void insertConvergenceOps(BasicBlock *conv, BasicBlock *fork);
+   void exportOutputs();
+   void handleUserClipPlanes();
+
+   Value *buildALU(nir_alu_instr *, Value *src[4]);
+
+private:
+   nir_shader *nir;
+   struct nv50_ir_prog_info *info;
+
+   std::vector<Value *> values;      // nir_ssa_def index * 4 + component
+   std::vector<BasicBlock *> blocks; // nir_block index
+   std::vector<Value *> outputs;     // fragment outputs, index * 4 + c
+   std::vector<PhiFixup> phis;
+
+   std::vector<BasicBlock *> loopBBs;
+   std::vector<BasicBlock *> breakBBs;
+   unsigned int ifDepth;
+
+   int clipVertexOutput;
+   int sysVals[nir_num_intrinsics]; // index into info->sv, or -1
+   Value *fragCoord[4];
+   Value *clipVtx[4];
+   Value *zero;
+};
+
+Converter::Converter(Program *ir, nir_shader *nir,
+                     struct nv50_ir_prog_info *info) : BuildUtil(ir),
+     nir(nir),
+     info(info),
+     ifDepth(0),
+     clipVertexOutput(-1)
+{
+   zero = mkImm((uint32_t)0);
+
+   for (int c = 0; c < 4; ++c)
+      fragCoord[c] = clipVtx[c] = NULL;
+   for (int i = 0; i < nir_num_intrinsics; ++i)
+      sysVals[i] = -1;
+}
+
+bool
+Converter::scanVariables(struct exec_list *vars, bool output)
+{
+   const bool isVP = info->type == PIPE_SHADER_VERTEX;
+   const bool isFP = info->type == PIPE_SHADER_FRAGMENT;
+
+   nir_foreach_variable(var, vars) {
+      const unsigned int slots =
+         glsl_count_attribute_slots(var->type, isVP && !output);
+
+      if (glsl_get_bit_size(glsl_without_array(var->type)) == 64) {
+         ERROR("64-bit varyings are not supported\n");
+         return false;
+      }
+
+      for (unsigned int i = 0; i < slots; ++i) {
+         const unsigned int idx = var->data.driver_location + i;
+         unsigned int sn, si;
+
+         if (idx >= (output ? PIPE_MAX_SHADER_OUTPUTS :
+                              PIPE_MAX_SHADER_INPUTS))
+            return false;
+
+         if (!output) {
+            struct nv50_ir_varying *in = &info->in[idx];
+
+            if (isVP) {
+               sn = TGSI_SEMANTIC_GENERIC;
+               si = idx;
+            } else {
+               translateVarying(var->data.location + i, &sn, &si);
+            }
+            in->id = idx;
+            in->sn = sn;
+            in->si = si;
+            if (isFP) {
+               switch (var->data.interpolation) {
+               case INTERP_MODE_FLAT:
+                  in->flat = 1;
+                  break;
+               case INTERP_MODE_NOPERSPECTIVE:
+                  in->linear = 1;
+                  break;
+               case INTERP_MODE_NONE:
+                  if (sn == TGSI_SEMANTIC_COLOR)
+                     in->sc = 1;
+                  break;
+               default:
+                  break;
+               }
+               if (sn == TGSI_SEMANTIC_POSITION)
+                  in->linear = 1;
+               if (sn == TGSI_SEMANTIC_PRIMID || sn == TGSI_SEMANTIC_FACE)
+                  in->flat = 1;
+               if (var->data.centroid || var->data.sample)
+                  in->centroid = 1;
+               if (var->data.sample)
+                  info->prop.fp.persampleInvocation = true;
+            }
+            info->numInputs = MAX2(info->numInputs, idx + 1);
+            continue;
+         }
+
+         if (isFP)
+            translateFragResult(var->data.location + i, var->data.index,
+                                &sn, &si);
+         else
+            translateVarying(var->data.location + i, &sn, &si);
+
+         switch (sn) {
+         case TGSI_SEMANTIC_POSITION:
+            if (isFP) {
+               info->io.fragDepth = idx;
+               info->prop.fp.writesDepth = true;
+            } else
+            if (clipVertexOutput < 0) {
+               clipVertexOutput = idx;
+            }
+            break;
+         case TGSI_SEMANTIC_COLOR:
+            if (isFP) {
+               info->prop.fp.numColourResults++;
+               if (var->data.location == FRAG_RESULT_COLOR)
+                  info->prop.fp.separateFragData = true;
+            }
+            break;
+         case TGSI_SEMANTIC_EDGEFLAG:
+            info->io.edgeFlagOut = idx;
+            break;
+         case TGSI_SEMANTIC_CLIPVERTEX:
+            clipVertexOutput = idx;
+            break;
+         case TGSI_SEMANTIC_CLIPDIST:
+            info->io.genUserClip = -1;
+            break;
+         case TGSI_SEMANTIC_SAMPLEMASK:
+            info->io.sampleMask = idx;
+            break;
+         case TGSI_SEMANTIC_VIEWPORT_INDEX:
+            info->io.viewportId = idx;
+            break;
+         default:
+            break;
+         }
+         info->out[idx].id = idx;
+         info->out[idx].sn = sn;
+         info->out[idx].si = si;
+         info->numOutputs = MAX2(info->numOutputs, idx + 1);
+      }
+   }
+   return true;
+}
+
+void
+Converter::scanIntrinsic(nir_intrinsic_instr *insn)
+{
+   unsigned int sn = TGSI_SEMANTIC_COUNT;
+
+   switch (insn->intrinsic) {
+   case nir_intrinsic_load_input: {
+      const unsigned int idx = nir_intrinsic_base(insn);
+      const unsigned int mask =
+         ((1 << insn->num_components) - 1) << nir_intrinsic_component(insn);
+      if (nir_src_as_const_value(insn->src[0])) {
+         info->in[idx + nir_src_as_const_value(insn->src[0])->u32[0]].mask |=
+            mask;
+      } else {
+         for (unsigned int i = 0; i < info->numInputs; ++i)
+            info->in[i].mask = 0xf;
+      }
+      return;
+   }
+   case nir_intrinsic_store_output: {
+      unsigned int idx = nir_intrinsic_base(insn);
+      unsigned int wrmask = nir_intrinsic_write_mask(insn) <<
+         nir_intrinsic_component(insn);
+      if (nir_src_as_const_value(insn->src[1])) {
+         idx += nir_src_as_const_value(insn->src[1])->u32[0];
+         if (info->type == PIPE_SHADER_FRAGMENT &&
+             idx == info->io.fragDepth)
+            wrmask = 1 << 2; // depth is the z component of the result
+         info->out[idx].mask |= wrmask;
+      } else {
+         for (unsigned int i = 0; i < info->numOutputs; ++i)
+            info->out[i].mask = 0xf;
+      }
+
+      // a pass-through edge flag is read from an input register
+      if (info->out[idx].sn == TGSI_SEMANTIC_EDGEFLAG &&
+          insn->src[0].is_ssa) {
+         nir_instr *parent = insn->src[0].ssa->parent_instr;
+         if (parent->type == nir_instr_type_intrinsic) {
+            nir_intrinsic_instr *ld = nir_instr_as_intrinsic(parent);
+            if (ld->intrinsic == nir_intrinsic_load_input)
+               info->io.edgeFlagIn = nir_intrinsic_base(ld);
+         }
+      }
+      return;
+   }
+   case nir_intrinsic_discard:
+   case nir_intrinsic_discard_if:
+      info->prop.fp.usesDiscard = true;
+      return;
+   case nir_intrinsic_load_front_face:
+      sn = TGSI_SEMANTIC_FACE;
+      break;
+   case nir_intrinsic_load_vertex_id:
+      sn = TGSI_SEMANTIC_VERTEXID;
+      break;
+   case nir_intrinsic_load_instance_id:
+      sn = TGSI_SEMANTIC_INSTANCEID;
+      break;
+   case nir_intrinsic_load_base_vertex:
+      sn = TGSI_SEMANTIC_BASEVERTEX;
+      break;
+   case nir_intrinsic_load_base_instance:
+      sn = TGSI_SEMANTIC_BASEINSTANCE;
+      break;
+   case nir_intrinsic_load_draw_id:
+      sn = TGSI_SEMANTIC_DRAWID;
+      break;
+   case nir_intrinsic_load_sample_id:
+      sn = TGSI_SEMANTIC_SAMPLEID;
+      break;
+   case nir_intrinsic_load_sample_pos:
+      sn = TGSI_SEMANTIC_SAMPLEPOS;
+      break;
+   case nir_intrinsic_load_sample_mask_in:
+      sn = TGSI_SEMANTIC_SAMPLEMASK;
+      break;
+   case nir_intrinsic_load_primitive_id:
+      sn = TGSI_SEMANTIC_PRIMID;
+      break;
+   default:
+      return;
+   }
+
+   if (sysVals[insn->intrinsic] >= 0)
+      return;
+
+   const unsigned int i = info->numSysVals++;
+   sysVals[insn->intrinsic] = i;
+   info->sv[i].id = i;
+   info->sv[i].sn = sn;
+   info->sv[i].si = 0;
+   info->sv[i].mask = 0xf;
+
+   switch (sn) {
+   case TGSI_SEMANTIC_INSTANCEID:
+      info->io.instanceId = i;
+      info->sv[i].input = 1;
+      break;
+   case TGSI_SEMANTIC_VERTEXID:
+      info->io.vertexId = i;
+      info->sv[i].input = 1;
+      break;
+   case TGSI_SEMANTIC_BASEVERTEX:
+   case TGSI_SEMANTIC_BASEINSTANCE:
+   case TGSI_SEMANTIC_DRAWID:
+      info->prop.vp.usesDrawParameters = true;
+      break;
+   case TGSI_SEMANTIC_SAMPLEID:
+   case TGSI_SEMANTIC_SAMPLEPOS:
+      info->prop.fp.persampleInvocation = true;
+      break;
+   case TGSI_SEMANTIC_SAMPLEMASK:
+      info->prop.fp.usesSampleMaskIn = true;
+      break;
+   default:
+      break;
+   }
+}
+
+bool
+Converter::scan()
+{
+   nir_function_impl *impl = nir_shader_get_entrypoint(nir);
+
+   info->io.viewportId = -1;
+   info->prop.cp.numThreads = 1;
+
+   if (!scanVariables(&nir->inputs, false) ||
+       !scanVariables(&nir->outputs, true))
+      return false;
+
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type == nir_instr_type_intrinsic)
+            scanIntrinsic(nir_instr_as_intrinsic(instr));
+      }
+   }
+
+   for (unsigned int i = 0; i < info->numOutputs; ++i) {
+      switch (info->out[i].sn) {
+      case TGSI_SEMANTIC_PSIZE:
+      case TGSI_SEMANTIC_PRIMID:
+      case TGSI_SEMANTIC_LAYER:
+      case TGSI_SEMANTIC_VIEWPORT_INDEX:
+      case TGSI_SEMANTIC_FOG:
+         info->out[i].mask &= 1;
+         break;
+      default:
+         break;
+      }
+   }
+   for (unsigned int i = 0; i < info->numInputs; ++i) {
+      switch (info->in[i].sn) {
+      case TGSI_SEMANTIC_PSIZE:
+      case TGSI_SEMANTIC_PRIMID:
+      case TGSI_SEMANTIC_FOG:
+         info->in[i].mask &= 1;
+         break;
+      case TGSI_SEMANTIC_PCOORD:
+         info->in[i].mask &= 3;
+         break;
+      default:
+         break;
+      }
+   }
+
+   info->io.clipDistances = nir->info->clip_distance_array_size;
+   info->io.cullDistances = nir->info->cull_distance_array_size;
+
+   if (info->type == PIPE_SHADER_FRAGMENT) {
+      if (info->io.alphaRefBase)
+         info->prop.fp.usesDiscard = true;
+      info->prop.fp.earlyFragTests = nir->info->fs.early_fragment_tests;
+   }
+
+   if (info->io.genUserClip > 0) {
+      info->io.clipDistances = info->io.genUserClip;
+
+      const unsigned int nOut = (info->io.genUserClip + 3) / 4;
+
+      for (unsigned int n = 0; n < nOut; ++n) {
+         unsigned int i = info->numOutputs++;
+         info->out[i].id = i;
+         info->out[i].sn = TGSI_SEMANTIC_CLIPDIST;
+         info->out[i].si = n;
+         info->out[i].mask = ((1 << info->io.clipDistances) - 1) >> (n * 4);
+      }
+   }
+
+   return info->assignSlots(info) == 0;
+}
+
+Value *
+Converter::getSrc(const nir_src *src, unsigned int c)
+{
+   assert(src->is_ssa);
+   return values[src->ssa->index * 4 + c];
+}
+
+void
+Converter::setDef(nir_ssa_def *def, unsigned int c, Value *val)
+{
+   values[def->index * 4 + c] = val;
+}
+
+Value *
+Converter::getAluSrc(nir_alu_instr *insn, unsigned int s, unsigned int c)
+{
+   const nir_alu_src *src = &insn->src[s];
+   Value *val = getSrc(&src->src, src->swizzle[c]);
+   DataType ty;
+
+   if (!src->abs && !src->negate)
+      return val;
+
+   switch (nir_alu_type_get_base_type(nir_op_infos[insn->op].input_types[s])) {
+   case nir_type_float: ty = TYPE_F32; break;
+   case nir_type_int:   ty = TYPE_S32; break;
+   default:             ty = TYPE_U32; break;
+   }
+   if (src->abs)
+      val = mkOp1v(OP_ABS, ty, getSSA(), val);
+   if (src->negate)
+      val = mkOp1v(OP_NEG, ty, getSSA(), val);
+   return val;
+}
+
+// Returns the address register for a non-constant offset in vec4 units,
+// or adds a constant one to *offset.
+Value *
+Converter::getIndirect(const nir_src *src, int *offset)
+{
+   nir_const_value *imm = nir_src_as_const_value(*src);
+
+   if (imm) {
+      *offset += imm->u32[0];
+      return NULL;
+   }
+   return mkOp2v(OP_SHL, TYPE_U32, getSSA(4, FILE_ADDRESS), getSrc(src, 0),
+                 mkImm(4));
+}
+
+Value *
+Converter::interpolate(int idx, unsigned int c, Value *ptr)
+{
+   const struct nv50_ir_varying *in = &info->in[idx];
+   operation op;
+   uint8_t mode;
+
+   if (in->flat)
+      mode = NV50_IR_INTERP_FLAT;
+   else
+   if (in->linear)
+      mode = NV50_IR_INTERP_LINEAR;
+   else
+   if (in->sc)
+      mode = NV50_IR_INTERP_SC;
+   else
+      mode = NV50_IR_INTERP_PERSPECTIVE;
+
+   op = (mode == NV50_IR_INTERP_PERSPECTIVE || mode == NV50_IR_INTERP_SC)
+      ? OP_PINTERP : OP_LINTERP;
+
+   if (in->centroid)
+      mode |= NV50_IR_INTERP_CENTROID;
+
+   Instruction *insn = new_Instruction(func, op, TYPE_F32);
+
+   insn->setDef(0, getSSA());
+   insn->setSrc(0, mkSymbol(FILE_SHADER_INPUT, 0, TYPE_F32,
+                            in->slot[c] * 4));
+   if (op == OP_PINTERP)
+      insn->setSrc(1, fragCoord[3]);
+   if (ptr)
+      insn->setIndirect(0, 0, ptr);
+
+   insn->setInterpolate(mode);
+
+   bb->insertTail(insn);
+   return insn->getDef(0);
+}
+
+void
+Converter::storeOutput(int idx, unsigned int c, Value *val, Value *ptr)
+{
+   if (info->type == PIPE_SHADER_FRAGMENT) {
+      // exported at the end of the program, see exportOutputs
+      if (idx == info->io.fragDepth)
+         c = 2;
+      mkMov(outputs[idx * 4 + c], val);
+      return;
+   }
+
+   if (info->io.genUserClip > 0 && idx == clipVertexOutput) {
+      mkMov(clipVtx[c], val);
+      val = clipVtx[c];
+   }
+   if (!(info->out[idx].mask & (1 << c)))
+      return;
+
+   Symbol *sym = mkSymbol(FILE_SHADER_OUTPUT, 0, TYPE_U32,
+                          info->out[idx].slot[c] * 4);
+   mkStore(OP_EXPORT, TYPE_U32, sym, ptr, val);
+}
+
+Value *
+Converter::loadSysVal(nir_intrinsic_instr *insn, unsigned int c)
+{
+   SVSemantic sv;
+
+   switch (insn->intrinsic) {
+   case nir_intrinsic_load_front_face:    sv = SV_FACE; break;
+   case nir_intrinsic_load_vertex_id:     sv = SV_VERTEX_ID; break;
+   case nir_intrinsic_load_instance_id:   sv = SV_INSTANCE_ID; break;
+   case nir_intrinsic_load_base_vertex:   sv = SV_BASEVERTEX; break;
+   case nir_intrinsic_load_base_instance: sv = SV_BASEINSTANCE; break;
+   case nir_intrinsic_load_draw_id:       sv = SV_DRAWID; break;
+   case nir_intrinsic_load_sample_id:     sv = SV_SAMPLE_INDEX; break;
+   case nir_intrinsic_load_sample_pos:    sv = SV_SAMPLE_POS; break;
+   case nir_intrinsic_load_sample_mask_in: sv = SV_SAMPLE_MASK; break;
+   case nir_intrinsic_load_primitive_id:  sv = SV_PRIMITIVE_ID; break;
+   default:
+      return NULL;
+   }
+   return mkOp1v(OP_RDSV, sv == SV_SAMPLE_POS ? TYPE_F32 : TYPE_U32, getSSA(),
+                 mkSysVal(sv, c));
+}
+
+bool
+Converter::visitIntrinsic(nir_intrinsic_instr *insn)
+{
+   const unsigned int n = insn->num_components;
+   unsigned int c;
+
+   switch (insn->intrinsic) {
+   case nir_intrinsic_load_input: {
+      const unsigned int comp = nir_intrinsic_component(insn);
+      int idx = nir_intrinsic_base(insn);
+      Value *ptr = getIndirect(&insn->src[0], &idx);
+
+      for (c = 0; c < n; ++c) {
+         const unsigned int k = comp + c;
+         Value *val;
+
+         if (info->type == PIPE_SHADER_FRAGMENT) {
+            if (!ptr && !(info->in[idx].mask & (1 << k)))
+               val = loadImm(NULL, k == 3 ? 1.0f : 0.0f);
+            else
+               val = interpolate(ptr ? 0 : idx, k, ptr);
+         } else {
+            Symbol *sym = mkSymbol(FILE_SHADER_INPUT, 0, TYPE_U32,
+                                   info->in[ptr ? 0 : idx].slot[k] * 4);
+            Instruction *ld = mkLoad(TYPE_U32, getSSA(), sym, ptr);
+            ld->perPatch = 0;
+            val = ld->getDef(0);
+         }
+         setDef(&insn->dest.ssa, c, val);
+      }
+      return true;
+   }
+   case nir_intrinsic_store_output: {
+      const unsigned int comp = nir_intrinsic_component(insn);
+      const unsigned int wrmask = nir_intrinsic_write_mask(insn);
+      int idx = nir_intrinsic_base(insn);
+      Value *ptr = getIndirect(&insn->src[1], &idx);
+
+      if (ptr && info->type == PIPE_SHADER_FRAGMENT) {
+         ERROR("indirect fragment shader outputs are not supported\n");
+         return false;
+      }
+      for (c = 0; c < n; ++c) {
+         if (wrmask & (1 << c))
+            storeOutput(idx, comp + c, getSrc(&insn->src[0], c), ptr);
+      }
+      return true;
+   }
+   case nir_intrinsic_load_uniform: {
+      int offset = nir_intrinsic_base(insn);
+      Value *ptr = getIndirect(&insn->src[0], &offset);
+
+      for (c = 0; c < n; ++c) {
+         Symbol *sym = mkSymbol(FILE_MEMORY_CONST, 0, TYPE_U32,
+                                offset * 16 + c * 4);
+         setDef(&insn->dest.ssa, c, mkLoadv(TYPE_U32, sym, ptr));
+      }
+      return true;
+   }
+   case nir_intrinsic_load_ubo: {
+      nir_const_value *index = nir_src_as_const_value(insn->src[0]);
+      nir_const_value *offset = nir_src_as_const_value(insn->src[1]);
+      uint32_t base = 0;
+      Value *ptr = NULL;
+
+      if (!index) {
+         ERROR("indirect uniform buffer access is not supported\n");
+         return false;
+      }
+      if (offset)
+         base = offset->u32[0];
+      else
+         ptr = mkOp1v(OP_MOV, TYPE_U32, getSSA(4, FILE_ADDRESS),
+                      getSrc(&insn->src[1], 0));
+
+      for (c = 0; c < n; ++c) {
+         Symbol *sym = mkSymbol(FILE_MEMORY_CONST, index->u32[0] + 1,
+                                TYPE_U32, base + c * 4);
+         setDef(&insn->dest.ssa, c, mkLoadv(TYPE_U32, sym, ptr));
+      }
+      return true;
+   }
+   case nir_intrinsic_discard:
+      mkOp(OP_DISCARD, TYPE_NONE, NULL);
+      return true;
+   case nir_intrinsic_discard_if: {
+      Value *pred = getSSA(1, FILE_PREDICATE);
+      mkCmp(OP_SET, CC_NE, TYPE_U32, pred, TYPE_U32,
+            getSrc(&insn->src[0], 0), zero);
+      mkOp(OP_DISCARD, TYPE_NONE, NULL)->setPredicate(CC_P, pred);
+      return true;
+   }
+   default:
+      break;
+   }
+
+   if (sysVals[insn->intrinsic] >= 0) {
+      for (c = 0; c < insn->dest.ssa.num_components; ++c)
+         setDef(&insn->dest.ssa, c, loadSysVal(insn, c));
+      return true;
+   }
+
+   ERROR("unknown intrinsic: %s\n", nir_intrinsic_infos[insn->intrinsic].name);
+   return false;
+}
+
+Value *
+Converter::buildALU(nir_alu_instr *insn, Value *src[4])
+{
+   Value *def = getSSA();
+   Instruction *geni;
+
+   switch (insn->op) {
+   case nir_op_fmov:
+   case nir_op_imov:
+      return src[0];
+
+   case nir_op_fadd: mkOp2(OP_ADD, TYPE_F32, def, src[0], src[1]); break;
+   case nir_op_iadd: mkOp2(OP_ADD, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_fsub: mkOp2(OP_SUB, TYPE_F32, def, src[0], src[1]); break;
+   case nir_op_isub: mkOp2(OP_SUB, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_fmul: mkOp2(OP_MUL, TYPE_F32, def, src[0], src[1]); break;
+   case nir_op_imul: mkOp2(OP_MUL, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_fdiv: mkOp2(OP_DIV, TYPE_F32, def, src[0], src[1]); break;
+   case nir_op_idiv: mkOp2(OP_DIV, TYPE_S32, def, src[0], src[1]); break;
+   case nir_op_udiv: mkOp2(OP_DIV, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_imod:
+   case nir_op_irem: mkOp2(OP_MOD, TYPE_S32, def, src[0], src[1]); break;
+   case nir_op_umod: mkOp2(OP_MOD, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_fmin: mkOp2(OP_MIN, TYPE_F32, def, src[0], src[1]); break;
+   case nir_op_imin: mkOp2(OP_MIN, TYPE_S32, def, src[0], src[1]); break;
+   case nir_op_umin: mkOp2(OP_MIN, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_fmax: mkOp2(OP_MAX, TYPE_F32, def, src[0], src[1]); break;
+   case nir_op_imax: mkOp2(OP_MAX, TYPE_S32, def, src[0], src[1]); break;
+   case nir_op_umax: mkOp2(OP_MAX, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_iand: mkOp2(OP_AND, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_ior:  mkOp2(OP_OR,  TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_ixor: mkOp2(OP_XOR, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_ishl: mkOp2(OP_SHL, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_ishr: mkOp2(OP_SHR, TYPE_S32, def, src[0], src[1]); break;
+   case nir_op_ushr: mkOp2(OP_SHR, TYPE_U32, def, src[0], src[1]); break;
+   case nir_op_fpow: mkOp2(OP_POW, TYPE_F32, def, src[0], src[1]); break;
+   case nir_op_ffma: mkOp3(OP_MAD, TYPE_F32, def, src[0], src[1], src[2]); break;
+
+   case nir_op_imul_high:
+   case nir_op_umul_high:
+      geni = mkOp2(OP_MUL, insn->op == nir_op_imul_high ? TYPE_S32 : TYPE_U32,
+                   def, src[0], src[1]);
+      geni->subOp = NV50_IR_SUBOP_MUL_HIGH;
+      break;
+
+   case nir_op_fneg:  mkOp1(OP_NEG, TYPE_F32, def, src[0]); break;
+   case nir_op_ineg:  mkOp1(OP_NEG, TYPE_S32, def, src[0]); break;
+   case nir_op_fabs:  mkOp1(OP_ABS, TYPE_F32, def, src[0]); break;
+   case nir_op_iabs:  mkOp1(OP_ABS, TYPE_S32, def, src[0]); break;
+   case nir_op_inot:  mkOp1(OP_NOT, TYPE_U32, def, src[0]); break;
+   case nir_op_fsat:  mkOp1(OP_SAT, TYPE_F32, def, src[0]); break;
+   case nir_op_frcp:  mkOp1(OP_RCP, TYPE_F32, def, src[0]); break;
+   case nir_op_frsq:  mkOp1(OP_RSQ, TYPE_F32, def, src[0]); break;
+   case nir_op_fsqrt: mkOp1(OP_SQRT, TYPE_F32, def, src[0]); break;
+   case nir_op_fexp2: mkOp1(OP_EX2, TYPE_F32, def, src[0]); break;
+   case nir_op_flog2: mkOp1(OP_LG2, TYPE_F32, def, src[0]); break;
+   case nir_op_ffloor: mkOp1(OP_FLOOR, TYPE_F32, def, src[0]); break;
+   case nir_op_fceil: mkOp1(OP_CEIL, TYPE_F32, def, src[0]); break;
+   case nir_op_ftrunc: mkOp1(OP_TRUNC, TYPE_F32, def, src[0]); break;
+   case nir_op_fddx:
+   case nir_op_fddx_coarse:
+   case nir_op_fddx_fine:
+      mkOp1(OP_DFDX, TYPE_F32, def, src[0]);
+      break;
+   case nir_op_fddy:
+   case nir_op_fddy_coarse:
+   case nir_op_fddy_fine:
+      mkOp1(OP_DFDY, TYPE_F32, def, src[0]);
+      break;
+
+   case nir_op_fsin:
+   case nir_op_fcos:
+      mkOp1(OP_PRESIN, TYPE_F32, def, src[0]);
+      mkOp1(insn->op == nir_op_fsin ? OP_SIN : OP_COS, TYPE_F32, def, def);
+      break;
+
+   case nir_op_ffract:
+      mkOp1(OP_FLOOR, TYPE_F32, def, src[0]);
+      mkOp2(OP_SUB, TYPE_F32, def, src[0], def);
+      break;
+   case nir_op_fround_even:
+      mkCvt(OP_CVT, TYPE_F32, def, TYPE_F32, src[0])->rnd = ROUND_NI;
+      break;
+
+   case nir_op_fsign:
+   case nir_op_isign: {
+      const DataType ty = insn->op == nir_op_fsign ? TYPE_F32 : TYPE_S32;
+      Value *gt = getSSA(), *lt = getSSA();
+      mkCmp(OP_SET, CC_GT, ty, gt, ty, src[0], zero);
+      mkCmp(OP_SET, CC_LT, ty, lt, ty, src[0], zero);
+      if (ty == TYPE_F32)
+         mkOp2(OP_SUB, TYPE_F32, def, gt, lt);
+      else
+         mkOp2(OP_SUB, TYPE_S32, def, lt, gt);
+      break;
+   }
+
+   case nir_op_flt: mkCmp(OP_SET, CC_LT, TYPE_U32, def, TYPE_F32, src[0], src[1]); break;
+   case nir_op_fge: mkCmp(OP_SET, CC_GE, TYPE_U32, def, TYPE_F32, src[0], src[1]); break;
+   case nir_op_feq: mkCmp(OP_SET, CC_EQ, TYPE_U32, def, TYPE_F32, src[0], src[1]); break;
+   case nir_op_fne: mkCmp(OP_SET, CC_NEU, TYPE_U32, def, TYPE_F32, src[0], src[1]); break;
+   case nir_op_ilt: mkCmp(OP_SET, CC_LT, TYPE_U32, def, TYPE_S32, src[0], src[1]); break;
+   case nir_op_ige: mkCmp(OP_SET, CC_GE, TYPE_U32, def, TYPE_S32, src[0], src[1]); break;
+   case nir_op_ieq: mkCmp(OP_SET, CC_EQ, TYPE_U32, def, TYPE_U32, src[0], src[1]); break;
+   case nir_op_ine: mkCmp(OP_SET, CC_NE, TYPE_U32, def, TYPE_U32, src[0], src[1]); break;
+   case nir_op_ult: mkCmp(OP_SET, CC_LT, TYPE_U32, def, TYPE_U32, src[0], src[1]); break;
+   case nir_op_uge: mkCmp(OP_SET, CC_GE, TYPE_U32, def, TYPE_U32, src[0], src[1]); break;
+
+   case nir_op_bcsel:
+      mkCmp(OP_SLCT, CC_NE, TYPE_U32, def, TYPE_U32, src[1], src[2], src[0]);
+      break;
+   case nir_op_fcsel:
+      mkCmp(OP_SLCT, CC_NE, TYPE_F32, def, TYPE_F32, src[1], src[2], src[0]);
+      break;
+
+   case nir_op_b2f:
+      mkOp2(OP_AND, TYPE_U32, def, src[0], mkImm(0x3f800000));
+      break;
+   case nir_op_b2i:
+      mkOp2(OP_AND, TYPE_U32, def, src[0], mkImm(1));
+      break;
+   case nir_op_f2b:
+      mkCmp(OP_SET, CC_NEU, TYPE_U32, def, TYPE_F32, src[0], zero);
+      break;
+   case nir_op_i2b:
+      mkCmp(OP_SET, CC_NE, TYPE_U32, def, TYPE_U32, src[0], zero);
+      break;
+   case nir_op_f2i:
+      mkCvt(OP_CVT, TYPE_S32, def, TYPE_F32, src[0])->rnd = ROUND_Z;
+      break;
+   case nir_op_f2u:
+      mkCvt(OP_CVT, TYPE_U32, def, TYPE_F32, src[0])->rnd = ROUND_Z;
+      break;
+   case nir_op_i2f:
+      mkCvt(OP_CVT, TYPE_F32, def, TYPE_S32, src[0]);
+      break;
+   case nir_op_u2f:
+      mkCvt(OP_CVT, TYPE_F32, def, TYPE_U32, src[0]);
+      break;
+
+   case nir_op_ubfe:
+   case nir_op_ibfe:
+   case nir_op_ubitfield_extract:
+   case nir_op_ibitfield_extract: {
+      const DataType ty =
+         (insn->op == nir_op_ibfe || insn->op == nir_op_ibitfield_extract) ?
+         TYPE_S32 : TYPE_U32;
+      Value *ctl = getSSA();
+      mkOp3(OP_INSBF, TYPE_U32, ctl, src[2], mkImm(0x808), src[1]);
+      mkOp2(OP_EXTBF, ty, def, src[0], ctl);
+      break;
+   }
+   case nir_op_bitfield_insert: {
+      Value *ctl = getSSA();
+      mkOp3(OP_INSBF, TYPE_U32, ctl, src[3], mkImm(0x808), src[2]);
+      mkOp3(OP_INSBF, TYPE_U32, def, src[1], ctl, src[0]);
+      break;
+   }
+   case nir_op_find_lsb: {
+      Value *rev = getSSA();
+      geni = mkOp2(OP_EXTBF, TYPE_U32, rev, src[0], mkImm(0x2000));
+      geni->subOp = NV50_IR_SUBOP_EXTBF_REV;
+      geni = mkOp1(OP_BFIND, TYPE_U32, def, rev);
+      geni->subOp = NV50_IR_SUBOP_BFIND_SAMT;
+      break;
+   }
+   case nir_op_ufind_msb: mkOp1(OP_BFIND, TYPE_U32, def, src[0]); break;
+   case nir_op_ifind_msb: mkOp1(OP_BFIND, TYPE_S32, def, src[0]); break;
+   case nir_op_bitfield_reverse:
+      geni = mkOp2(OP_EXTBF, TYPE_U32, def, src[0], mkImm(0x2000));
+      geni->subOp = NV50_IR_SUBOP_EXTBF_REV;
+      break;
+   case nir_op_bit_count:
+      mkOp2(OP_POPCNT, TYPE_U32, def, src[0], src[0]);
+      break;
+
+   case nir_op_pack_half_2x16_split: {
+      Value *lo = getSSA(), *hi = getSSA();
+      mkCvt(OP_CVT, TYPE_F16, lo, TYPE_F32, src[0]);
+      mkCvt(OP_CVT, TYPE_F16, hi, TYPE_F32, src[1]);
+      mkOp3(OP_INSBF, TYPE_U32, def, hi, mkImm(0x1010), lo);
+      break;
+   }
+   case nir_op_unpack_half_2x16_split_x:
+   case nir_op_unpack_half_2x16_split_y:
+      geni = mkCvt(OP_CVT, TYPE_F32, def, TYPE_F16, src[0]);
+      geni->subOp = insn->op == nir_op_unpack_half_2x16_split_y;
+      break;
+
+   default:
+      ERROR("unknown ALU opcode: %s\n", nir_op_infos[insn->op].name);
+      return NULL;
+   }
+   return def;
+}
+
+bool
+Converter::visitALU(nir_alu_instr *insn)
+{
+   const nir_op_info *op = &nir_op_infos[insn->op];
+   nir_ssa_def *dest = &insn->dest.dest.ssa;
+   Value *src[4];
+
+   switch (insn->op) {
+   case nir_op_vec2:
+   case nir_op_vec3:
+   case nir_op_vec4:
+      for (unsigned int c = 0; c < op->num_inputs; ++c)
+         setDef(dest, c, getAluSrc(insn, c, 0));
+      return true;
+   default:
+      break;
+   }
+
+   for (unsigned int c = 0; c < dest->num_components; ++c) {
+      for (unsigned int s = 0; s < op->num_inputs; ++s)
+         src[s] = getAluSrc(insn, s, op->input_sizes[s] ? 0 : c);
+
+      Value *val = buildALU(insn, src);
+      if (!val)
+         return false;
+      if (insn->dest.saturate)
+         val = mkOp1v(OP_SAT, TYPE_F32, getSSA(), val);
+      setDef(dest, c, val);
+   }
+   return true;
+}
+
+bool
+Converter::visitTex(nir_tex_instr *insn)
+{
+   TexInstruction *tex;
+   TexInstruction::Target tgt = translateTexTarget(insn);
+   Value *coord[4] = { NULL, NULL, NULL, NULL };
+   Value *lod = NULL, *bias = NULL, *ms = NULL, *shd = NULL;
+   Value *rInd = NULL, *sInd = NULL;
+   nir_tex_src *ddx = NULL, *ddy = NULL, *offset = NULL;
+   unsigned int c, d, s;
+
+   for (unsigned int i = 0; i < insn->num_srcs; ++i) {
+      nir_tex_src *src = &insn->src[i];
+
+      switch (src->src_type) {
+      case nir_tex_src_coord:
+         for (c = 0; c < insn->coord_components; ++c)
+            coord[c] = getSrc(&src->src, c);
+         break;
+      case nir_tex_src_comparitor: shd = getSrc(&src->src, 0); break;
+      case nir_tex_src_lod: lod = getSrc(&src->src, 0); break;
+      case nir_tex_src_bias: bias = getSrc(&src->src, 0); break;
+      case nir_tex_src_ms_index: ms = getSrc(&src->src, 0); break;
+      case nir_tex_src_offset: offset = src; break;
+      case nir_tex_src_ddx: ddx = src; break;
+      case nir_tex_src_ddy: ddy = src; break;
+      case nir_tex_src_texture_offset: rInd = getSrc(&src->src, 0); break;
+      case nir_tex_src_sampler_offset: sInd = getSrc(&src->src, 0); break;
+      default:
+         ERROR("unhandled texture source\n");
+         return false;
+      }
+   }
+
+   switch (insn->op) {
+   case nir_texop_tex:   tex = new_TexInstruction(func, OP_TEX); break;
+   case nir_texop_txb:   tex = new_TexInstruction(func, OP_TXB); break;
+   case nir_texop_txl:   tex = new_TexInstruction(func, OP_TXL); break;
+   case nir_texop_txd:   tex = new_TexInstruction(func, OP_TXD); break;
+   case nir_texop_txf:
+   case nir_texop_txf_ms: tex = new_TexInstruction(func, OP_TXF); break;
+   case nir_texop_tg4:   tex = new_TexInstruction(func, OP_TXG); break;
+   case nir_texop_lod:   tex = new_TexInstruction(func, OP_TXLQ); break;
+   case nir_texop_txs:
+   case nir_texop_query_levels:
+   case nir_texop_texture_samples:
+      tex = new_TexInstruction(func, OP_TXQ);
+      break;
+   default:
+      ERROR("unhandled texture opcode\n");
+      return false;
+   }
+
+   tex->setTexture(tgt, insn->texture_index, insn->sampler_index);
+
+   // the queries return their result in a fixed component
+   switch (insn->op) {
+   case nir_texop_query_levels:
+      tex->tex.query = TXQ_DIMS;
+      tex->tex.mask = 1 << 3;
+      tex->setDef(0, getSSA());
+      setDef(&insn->dest.ssa, 0, tex->getDef(0));
+      break;
+   case nir_texop_texture_samples:
+      tex->tex.query = TXQ_TYPE;
+      tex->tex.mask = 1 << 2;
+      tex->setDef(0, getSSA());
+      setDef(&insn->dest.ssa, 0, tex->getDef(0));
+      break;
+   default:
+      if (insn->op == nir_texop_txs)
+         tex->tex.query = TXQ_DIMS;
+      for (c = 0, d = 0; c < nir_tex_instr_dest_size(insn); ++c) {
+         tex->setDef(d++, getSSA());
+         tex->tex.mask |= 1 << c;
+         setDef(&insn->dest.ssa, c, tex->getDef(d - 1));
+      }
+      break;
+   }
+
+   s = 0;
+   switch (insn->op) {
+   case nir_texop_txs:
+      tex->setSrc(s++, lod ? lod : zero);
+      break;
+   case nir_texop_query_levels:
+   case nir_texop_texture_samples:
+      tex->setSrc(s++, zero);
+      break;
+   case nir_texop_txf:
+   case nir_texop_txf_ms:
+      for (c = 0; c < tgt.getArgCount() - tgt.isMS(); ++c)
+         tex->setSrc(s++, coord[c]);
+      if (tgt.isMS())
+         tex->setSrc(s++, ms ? ms : zero);
+      else
+         tex->setSrc(s++, lod ? lod : zero);
+      tex->tex.levelZero = tgt.isMS();
+      break;
+   default:
+      for (c = 0; c < tgt.getArgCount(); ++c)
+         tex->setSrc(s++, coord[c]);
+      if (lod && tex->op == OP_TXL)
+         tex->setSrc(s++, lod);
+      if (bias)
+         tex->setSrc(s++, bias);
+      if (shd)
+         tex->setSrc(s++, shd);
+      break;
+   }
+
+   if (rInd) {
+      tex->tex.rIndirectSrc = s;
+      tex->setSrc(s++, rInd);
+   }
+   if (sInd) {
+      tex->tex.sIndirectSrc = s;
+      tex->setSrc(s++, sInd);
+   }
+
+   if (tex->op == OP_TXD) {
+      for (c = 0; c < tgt.getDim() + tgt.isCube(); ++c) {
+         tex->dPdx[c].set(getSrc(&ddx->src, c));
+         tex->dPdy[c].set(getSrc(&ddy->src, c));
+      }
+   }
+   if (insn->op == nir_texop_tex &&
+       prog->getType() != Program::TYPE_FRAGMENT)
+      tex->tex.levelZero = true;
+   if (tex->op == OP_TXG && !tgt.isShadow())
+      tex->tex.gatherComp = insn->component;
+
+   if (offset) {
+      const unsigned int n = nir_tex_instr_src_size(insn,
+                                                    offset - insn->src);
+      tex->tex.useOffsets = 1;
+      for (c = 0; c < 3; ++c) {
+         tex->offset[0][c].set(c < n ? getSrc(&offset->src, c) : zero);
+         tex->offset[0][c].setInsn(tex);
+      }
+   }
+
+   bb->insertTail(tex);
+   return true;
+}
+
+void
+Converter::insertConvergenceOps(BasicBlock *conv, BasicBlock *fork)
+{
+   FlowInstruction *join = new_FlowInstruction(func, OP_JOIN, NULL);
+   join->fixed = 1;
+   conv->insertHead(join);
+
+   assert(!fork->joinAt);
+   fork->joinAt = new_FlowInstruction(func, OP_JOINAT, conv);
+   fork->insertBefore(fork->getExit(), fork->joinAt);
+}
+
+bool
+Converter::visitJump(nir_jump_instr *insn)
+{
+   switch (insn->type) {
+   case nir_jump_break: {
+      BasicBlock *brkBB = breakBBs.back();
+      mkFlow(OP_BREAK, brkBB, CC_ALWAYS, NULL);
+      bb->cfg.attach(&brkBB->cfg, Graph::Edge::CROSS);
+      return true;
+   }
+   case nir_jump_continue: {
+      BasicBlock *contBB = loopBBs.back();
+      mkFlow(OP_CONT, contBB, CC_ALWAYS, NULL);
+      contBB->explicitCont = true;
+      bb->cfg.attach(&contBB->cfg, Graph::Edge::BACK);
+      return true;
+   }
+   default:
+      ERROR("unhandled jump, returns should have been lowered\n");
+      return false;
+   }
+}
+
+// The sources are filled in once all blocks exist, see resolvePhis.
+void
+Converter::visitPhi(nir_phi_instr *phi)
+{
+   for (unsigned int c = 0; c < phi->dest.ssa.num_components; ++c) {
+      Instruction *insn = new_Instruction(func, OP_PHI, TYPE_U32);
+      insn->setDef(0, getSSA());
+      bb->insertTail(insn);
+      setDef(&phi->dest.ssa, c, insn->getDef(0));
+
+      PhiFixup fixup = { insn, phi, c };
+      phis.push_back(fixup);
+   }
+}
+
+// PHI sources have to be in the order of the incident edges of their block.
+void
+Converter::resolvePhis()
+{
+   for (size_t i = 0; i < phis.size(); ++i) {
+      Instruction *insn = phis[i].insn;
+      int s = 0;
+
+      for (Graph::EdgeIterator ei = insn->bb->cfg.incident(); !ei.end();
+           ei.next(), ++s) {
+         BasicBlock *pred = BasicBlock::get(ei.getNode());
+         Value *val = NULL;
+
+         nir_foreach_phi_src(src, phis[i].phi) {
+            if (blocks[src->pred->index] == pred) {
+               val = getSrc(&src->src, phis[i].c);
+               break;
+            }
+         }
+         insn->setSrc(s, val ? val : new_LValue(func, FILE_GPR));
+      }
+   }
+}
+
+bool
+Converter::visitInstr(nir_instr *instr)
+{
+   switch (instr->type) {
+   case nir_instr_type_alu:
+      return visitALU(nir_instr_as_alu(instr));
+   case nir_instr_type_intrinsic:
+      return visitIntrinsic(nir_instr_as_intrinsic(instr));
+   case nir_instr_type_tex:
+      return visitTex(nir_instr_as_tex(instr));
+   case nir_instr_type_jump:
+      return visitJump(nir_instr_as_jump(instr));
+   case nir_instr_type_phi:
+      visitPhi(nir_instr_as_phi(instr));
+      return true;
+   case nir_instr_type_load_const: {
+      nir_load_const_instr *ld = nir_instr_as_load_const(instr);
+      for (unsigned int c = 0; c < ld->def.num_components; ++c)
+         setDef(&ld->def, c, loadImm(NULL, ld->value.u32[c]));
+      return true;
+   }
+   case nir_instr_type_ssa_undef: {
+      nir_ssa_undef_instr *undef = nir_instr_as_ssa_undef(instr);
+      for (unsigned int c = 0; c < undef->def.num_components; ++c)
+         setDef(&undef->def, c, new_LValue(func, FILE_GPR));
+      return true;
+   }
+   default:
+      ERROR("unhandled NIR instruction type %u\n", instr->type);
+      return false;
+   }
+}
+
+bool
+Converter::visitBlock(nir_block *block)
+{
+   blocks[block->index] = bb;
+
+   nir_foreach_instr(instr, block) {
+      if (!visitInstr(instr))
+         return false;
+   }
+   return true;
+}
+
+bool
+Converter::visitIf(nir_if *nif)
+{
+   BasicBlock *ifBB = new BasicBlock(func);
+   BasicBlock *forkBB = bb;
+   BasicBlock *prevBB;
+   nir_block *elseBlock = nir_if_first_else_block(nif);
+   const bool hasElse = exec_list_length(&nif->else_list) != 1 ||
+      !exec_list_is_empty(&elseBlock->instr_list);
+
+   bb->cfg.attach(&ifBB->cfg, Graph::Edge::TREE);
+   mkFlow(OP_BRA, NULL, CC_NOT_P, getSrc(&nif->condition, 0))
+      ->setType(TYPE_U32);
+
+   ++ifDepth;
+   setPosition(ifBB, true);
+   if (!visitCFList(&nif->then_list))
+      return false;
+
+   if (hasElse) {
+      BasicBlock *elseBB = new BasicBlock(func);
+
+      forkBB->cfg.attach(&elseBB->cfg, Graph::Edge::TREE);
+      forkBB->getExit()->asFlow()->target.bb = elseBB;
+
+      prevBB = bb;
+      if (!bb->isTerminated())
+         mkFlow(OP_BRA, NULL, CC_ALWAYS, NULL);
+
+      setPosition(elseBB, true);
+      if (!visitCFList(&nif->else_list))
+         return false;
+   } else {
+      prevBB = forkBB;
+      blocks[elseBlock->index] = forkBB;
+   }
+   --ifDepth;
+
+   BasicBlock *convBB = new BasicBlock(func);
+
+   if (!bb->isTerminated()) {
+      // we only want join if none of the clauses ended with CONT/BREAK
+      if (prevBB->getExit()->op == OP_BRA && ifDepth < 6)
+         insertConvergenceOps(convBB, forkBB);
+      mkFlow(OP_BRA, convBB, CC_ALWAYS, NULL);
+      bb->cfg.attach(&convBB->cfg, Graph::Edge::FORWARD);
+   }
+
+   if (prevBB->getExit()->op == OP_BRA) {
+      prevBB->cfg.attach(&convBB->cfg, Graph::Edge::FORWARD);
+      prevBB->getExit()->asFlow()->target.bb = convBB;
+   }
+   setPosition(convBB, true);
+   return true;
+}
+
+bool
+Converter::visitLoop(nir_loop *loop)
+{
+   BasicBlock *lbgnBB = new BasicBlock(func);
+   BasicBlock *lbrkBB = new BasicBlock(func);
+
+   loopBBs.push_back(lbgnBB);
+   breakBBs.push_back(lbrkBB);
+   if (loopBBs.size() > func->loopNestingBound)
+      func->loopNestingBound++;
+
+   mkFlow(OP_PREBREAK, lbrkBB, CC_ALWAYS, NULL);
+
+   bb->cfg.attach(&lbgnBB->cfg, Graph::Edge::TREE);
+   setPosition(lbgnBB, true);
+   mkFlow(OP_PRECONT, lbgnBB, CC_ALWAYS, NULL);
+
+   if (!visitCFList(&loop->body))
+      return false;
+
+   if (!bb->isTerminated()) {
+      mkFlow(OP_CONT, lbgnBB, CC_ALWAYS, NULL);
+      bb->cfg.attach(&lbgnBB->cfg, Graph::Edge::BACK);
+   }
+   setPosition(lbrkBB, true);
+
+   // PREBREAK already refers to the break block, keep it in the CFG even
+   // if the loop never breaks
+   if (lbrkBB->cfg.incidentCount() == 0)
+      lbgnBB->cfg.attach(&lbrkBB->cfg, Graph::Edge::TREE);
+
+   loopBBs.pop_back();
+   breakBBs.pop_back();
+   return true;
+}
+
+bool
+Converter::visitCFList(struct exec_list *list)
+{
+   foreach_list_typed(nir_cf_node, node, node, list) {
+      bool ret;
+
+      switch (node->type) {
+      case nir_cf_node_block:
+         ret = visitBlock(nir_cf_node_as_block(node));
+         break;
+      case nir_cf_node_if:
+         ret = visitIf(nir_cf_node_as_if(node));
+         break;
+      case nir_cf_node_loop:
+         ret = visitLoop(nir_cf_node_as_loop(node));
+         break;
+      default:
+         ret = false;
+         break;
+      }
+      if (!ret)
+         return false;
+   }
+   return true;
+}
+
+void
+Converter::handleUserClipPlanes()
+{
+   Value *res[8];
+   int n, i, c;
+
+   for (c = 0; c < 4; ++c) {
+      for (i = 0; i < info->io.genUserClip; ++i) {
+         Symbol *sym = mkSymbol(FILE_MEMORY_CONST, info->io.auxCBSlot,
+                                TYPE_F32, info->io.ucpBase + i * 16 + c * 4);
+         Value *ucp = mkLoadv(TYPE_F32, sym, NULL);
+         if (c == 0)
+            res[i] = mkOp2v(OP_MUL, TYPE_F32, getScratch(), clipVtx[c], ucp);
+         else
+            mkOp3(OP_MAD, TYPE_F32, res[i], clipVtx[c], ucp, res[i]);
+      }
+   }
+
+   const int first = info->numOutputs - (info->io.genUserClip + 3) / 4;
+
+   for (i = 0; i < info->io.genUserClip; ++i) {
+      n = i / 4 + first;
+      c = i % 4;
+      Symbol *sym =
+         mkSymbol(FILE_SHADER_OUTPUT, 0, TYPE_F32, info->out[n].slot[c] * 4);
+      mkStore(OP_EXPORT, TYPE_F32, sym, NULL, res[i]);
+   }
+}
+
+void
+Converter::exportOutputs()
+{
+   if (info->io.alphaRefBase) {
+      for (unsigned int i = 0; i < info->numOutputs; ++i) {
+         if (info->out[i].sn != TGSI_SEMANTIC_COLOR ||
+             info->out[i].si != 0 ||
+             !(info->out[i].mask & (1 << 3)))
+            continue;
+         Value *val = outputs[i * 4 + 3];
+
+         Symbol *ref = mkSymbol(FILE_MEMORY_CONST, info->io.auxCBSlot,
+                                TYPE_U32, info->io.alphaRefBase);
+         Value *pred = new_LValue(func, FILE_PREDICATE);
+         mkCmp(OP_SET, CC_TR, TYPE_U32, pred, TYPE_F32, val,
+               mkLoadv(TYPE_U32, ref, NULL))
+            ->subOp = 1;
+         mkOp(OP_DISCARD, TYPE_NONE, NULL)->setPredicate(CC_NOT_P, pred);
+      }
+   }
+
+   for (unsigned int i = 0; i < info->numOutputs; ++i) {
+      for (unsigned int c = 0; c < 4; ++c) {
+         if (!(info->out[i].mask & (1 << c)))
+            continue;
+         Symbol *sym = mkSymbol(FILE_SHADER_OUTPUT, 0, TYPE_F32,
+                                info->out[i].slot[c] * 4);
+         Value *val = outputs[i * 4 + c];
+         if (info->out[i].sn == TGSI_SEMANTIC_POSITION)
+            mkOp1(OP_SAT, TYPE_F32, val, val);
+         mkStore(OP_EXPORT, TYPE_F32, sym, NULL, val);
+      }
+   }
+}
+
+bool
+Converter::run()
+{
+   nir_function_impl *impl = nir_shader_get_entrypoint(nir);
+   BasicBlock *entry = new BasicBlock(prog->main);
+   BasicBlock *leave = new BasicBlock(prog->main);
+
+   prog->main->setEntry(entry);
+   prog->main->setExit(leave);
+
+   setPosition(entry, true);
+
+   values.resize(impl->ssa_alloc * 4, NULL);
+   blocks.resize(impl->num_blocks, NULL);
+
+   if (info->io.genUserClip > 0) {
+      for (int c = 0; c < 4; ++c)
+         clipVtx[c] = getScratch();
+   }
+
+   if (prog->getType() == Program::TYPE_FRAGMENT) {
+      Symbol *sv = mkSysVal(SV_POSITION, 3);
+      fragCoord[3] = mkOp1v(OP_RDSV, TYPE_F32, getSSA(), sv);
+      mkOp1(OP_RCP, TYPE_F32, fragCoord[3], fragCoord[3]);
+
+      outputs.resize(info->numOutputs * 4);
+      for (size_t i = 0; i < outputs.size(); ++i)
+         outputs[i] = getScratch();
+   }
+
+   if (!visitCFList(&impl->body))
+      return false;
+
+   // attach and generate epilogue code
+   bb->cfg.attach(&leave->cfg, Graph::Edge::TREE);
+   setPosition(leave, true);
+   if (prog->getType() == Program::TYPE_FRAGMENT)
+      exportOutputs();
+   if (info->io.genUserClip > 0)
+      handleUserClipPlanes();
+   mkOp(OP_EXIT, TYPE_NONE, NULL)->terminator = 1;
+
+   resolvePhis();
+   return true;
+}
+
+// Scalarizes the program and runs the NIR optimizations on it.
+static nir_shader *
+optimize(nir_shader *nir)
+{
+   nir_lower_tex_options tex_options;
+   bool progress;
+
+   memset(&tex_options, 0, sizeof(tex_options));
+   tex_options.lower_txp = ~0;
+
+   NIR_PASS_V(nir, nir_lower_global_vars_to_local);
+   NIR_PASS_V(nir, nir_lower_returns);
+   NIR_PASS_V(nir, nir_lower_indirect_derefs, nir_var_local);
+   NIR_PASS_V(nir, nir_lower_vars_to_ssa);
+   NIR_PASS_V(nir, nir_lower_tex, &tex_options);
+   NIR_PASS_V(nir, nir_lower_alu_to_scalar);
+   NIR_PASS_V(nir, nir_lower_phis_to_scalar);
+   NIR_PASS_V(nir, nir_lower_load_const_to_scalar);
+
+   do {
+      progress = false;
+      NIR_PASS(progress, nir, nir_copy_prop);
+      NIR_PASS(progress, nir, nir_opt_remove_phis);
+      NIR_PASS(progress, nir, nir_opt_dce);
+      NIR_PASS(progress, nir, nir_opt_dead_cf);
+      NIR_PASS(progress, nir, nir_opt_cse);
+      NIR_PASS(progress, nir, nir_opt_peephole_select, 8);
+      NIR_PASS(progress, nir, nir_opt_algebraic);
+      NIR_PASS(progress, nir, nir_opt_constant_folding);
+      NIR_PASS(progress, nir, nir_opt_undef);
+      if (progress) {
+         NIR_PASS_V(nir, nir_lower_alu_to_scalar);
+         NIR_PASS_V(nir, nir_lower_phis_to_scalar);
+      }
+   } while (progress);
+
+   NIR_PASS_V(nir, nir_opt_dce);
+
+   nir_function_impl *impl = nir_shader_get_entrypoint(nir);
+   nir_index_blocks(impl);
+   nir_index_ssa_defs(impl);
+   return nir;
+}
+
+// Everything the converter maps has to be scalar 32-bit SSA by now.
+static bool
+checkSSA(nir_shader *nir)
+{
+   nir_function_impl *impl = nir_shader_get_entrypoint(nir);
+
+   if (!exec_list_is_empty(&impl->registers)) {
+      ERROR("NIR program has not been lowered to SSA\n");
+      return false;
+   }
+
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr(instr, block) {
+         nir_ssa_def *def = NULL;
+
+         switch (instr->type) {
+         case nir_instr_type_alu:
+            def = &nir_instr_as_alu(instr)->dest.dest.ssa;
+            break;
+         case nir_instr_type_tex:
+            def = &nir_instr_as_tex(instr)->dest.ssa;
+            break;
+         case nir_instr_type_load_const:
+            def = &nir_instr_as_load_const(instr)->def;
+            break;
+         case nir_instr_type_ssa_undef:
+            def = &nir_instr_as_ssa_undef(instr)->def;
+            break;
+         case nir_instr_type_phi:
+            def = &nir_instr_as_phi(instr)->dest.ssa;
+            break;
+         default:
+            break;
+         }
+         if (def && def->bit_size != 32) {
+            ERROR("only 32-bit NIR values are supported\n");
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+} // unnamed namespace
+
+namespace nv50_ir {
+
+bool
+Program::makeFromNIR(struct nv50_ir_prog_info *info)
+{
+   // keep the driver's copy intact, a program may be translated again
+   nir_shader *nir = nir_shader_clone(NULL,
+      reinterpret_cast<const nir_shader *>(info->bin.source));
+   bool ret = false;
+
+   nir = optimize(nir);
+
+   if (dbgFlags & NV50_IR_DEBUG_BASIC)
+      nir_print_shader(nir, stderr);
+
+   if (checkSSA(nir)) {
+      Converter builder(this, nir, info);
+      ret = builder.scan();
+      tlsSize = 0;
+      if (ret)
+         ret = builder.run();
+   }
+
+   ralloc_free(nir);
+   return ret;
+}
+
+} // namespace nv50_ir
+
+static nir_shader_compiler_options
+nv50_ir_make_nir_options()
+{
+   nir_shader_compiler_options op;
+
+   memset(&op, 0, sizeof(op));
+   op.lower_fdiv = true;
+   op.fuse_ffma = true;
+   op.lower_flrp32 = true;
+   op.lower_flrp64 = true;
+   op.lower_fmod32 = true;
+   op.lower_fmod64 = true;
+   op.lower_uadd_carry = true;
+   op.lower_usub_borrow = true;
+   op.lower_scmp = true;
+   op.lower_ffract = true;
+   op.lower_pack_half_2x16 = true;
+   op.lower_pack_unorm_2x16 = true;
+   op.lower_pack_snorm_2x16 = true;
+   op.lower_pack_unorm_4x8 = true;
+   op.lower_pack_snorm_4x8 = true;
+   op.lower_unpack_half_2x16 = true;
+   op.lower_unpack_unorm_2x16 = true;
+   op.lower_unpack_snorm_2x16 = true;
+   op.lower_unpack_unorm_4x8 = true;
+   op.lower_unpack_snorm_4x8 = true;
+   op.lower_extract_byte = true;
+   op.lower_extract_word = true;
+   op.native_integers = true;
+   return op;
+}
+
+static const nir_shader_compiler_options nv50_ir_nir_options =
+   nv50_ir_make_nir_options();
+
+extern "C" {
+
+const struct nir_shader_compiler_options *
+nv50_ir_nir_shader_compiler_options(int chipset)
+{
+   return &nv50_ir_nir_options;
+}
+
+}
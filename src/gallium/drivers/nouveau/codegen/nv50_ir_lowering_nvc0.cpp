@@ -361,6 +361,31 @@ NVC0LegalizePostRA::insertTextureBarriers(Function *fn)
            ++u) {
          BasicBlock *tb = texes[i]->bb;
          BasicBlock *ub = u->insn->bb;
+         if (tb == ub && texes[i]->serial >= u->insn->serial) {
+            // The use comes before the TEX in the same block, so it can only
+            // be reached around a loop: count the TEXes after this one in the
+            // block, on the lightest path back to the block, and before the
+            // use in the block.
+            int back = -1;
+            for (Graph::EdgeIterator ei = tb->cfg.outgoing(); !ei.end();
+                 ei.next()) {
+               int w = (ei.getNode() == &tb->cfg) ? 0 :
+                  fn->cfg.findLightestPathWeight(ei.getNode(), &tb->cfg,
+                                                 texCounts);
+               if (w >= 0 && (back < 0 || w < back))
+                  back = w;
+            }
+            u->level = 0;
+            if (back >= 0) {
+               u->level = back + texCounts.at(tb->getId()) -
+                  (i - bbFirstTex.at(tb->getId()) + 1);
+               for (size_t j = bbFirstTex.at(tb->getId()); j < texes.size() &&
+                       texes[j]->bb == tb &&
+                       texes[j]->serial < u->insn->serial;
+                    ++j)
+                  u->level++;
+            }
+         } else
          if (tb == ub) {
             u->level = 0;
             for (size_t j = i + 1; j < texes.size() &&
@@ -3519,6 +3519,345 @@ DeadCodeElim::checkSplitLoad(Instruction *ld1)
 
 // =============================================================================
 
+// List scheduling of the instructions of each basic block before RA, so that
+// the latency of memory accesses and texture fetches can be covered by
+// independent work.
+// Ready instructions are picked by the length of the longest latency path from
+// them to the end of the block. While the registers used by the block exceed
+// what still allows for a decent occupancy, the ones freeing registers are
+// preferred instead, so as not to push RA into spilling.
+class PreRAScheduling : public Pass
+{
+private:
+   virtual bool visit(Function *);
+   virtual bool visit(BasicBlock *);
+
+   enum Kind
+   {
+      KIND_PURE,    // free to move
+      KIND_READ,    // reads memory that may be written
+      KIND_WRITE,   // writes memory, ordered with respect to reads and writes
+      KIND_BARRIER  // ordered with respect to everything
+   };
+
+   struct Node
+   {
+      Instruction *insn;
+      std::vector<std::pair<int, int> > succs; // (node, latency)
+      int preds; // not yet scheduled
+      int height;
+      int ready; // cycle in which all operands are available
+      bool scheduled;
+   };
+
+   Kind classify(const Instruction *) const;
+   void addDep(int from, int to, int latency);
+   bool isLiveOut(const Value *, const BasicBlock *);
+   int getPressureDelta(const Node&);
+   void schedule(const Node&);
+
+   const Target *targ;
+   int limit;
+   int pressure;
+
+   std::vector<Node> nodes;
+   std::map<const Value *, int> uses; // GPR uses left in the block
+   std::map<const Value *, bool> liveOut;
+};
+
+bool
+PreRAScheduling::visit(Function *fn)
+{
+   targ = prog->getTarget();
+
+   // Values live through a block aren't accounted for, leave room for them.
+   limit = MIN2(targ->getFileSize(FILE_GPR), 64) * 3 / 4;
+   return true;
+}
+
+PreRAScheduling::Kind
+PreRAScheduling::classify(const Instruction *insn) const
+{
+   if (insn->fixed || insn->join || insn->exit || insn->terminator ||
+       insn->asFlow())
+      return KIND_BARRIER;
+
+   // values with fixed registers aren't SSA
+   for (int d = 0; insn->defExists(d); ++d)
+      if (insn->getDef(d)->reg.data.id >= 0)
+         return KIND_BARRIER;
+   for (int s = 0; insn->srcExists(s); ++s)
+      if (insn->getSrc(s)->asLValue() && insn->getSrc(s)->reg.data.id >= 0)
+         return KIND_BARRIER;
+
+   switch (Target::getOpClass(insn->op)) {
+   case OPCLASS_MOVE:
+   case OPCLASS_ARITH:
+   case OPCLASS_SHIFT:
+   case OPCLASS_SFU:
+   case OPCLASS_LOGIC:
+   case OPCLASS_COMPARE:
+   case OPCLASS_CONVERT:
+   case OPCLASS_BITFIELD:
+   case OPCLASS_VECTOR:
+      return KIND_PURE;
+   case OPCLASS_PSEUDO:
+      return insn->op == OP_PHI ? KIND_BARRIER : KIND_PURE;
+   case OPCLASS_LOAD:
+      if (insn->src(0).getFile() == FILE_MEMORY_CONST ||
+          insn->src(0).getFile() == FILE_SHADER_INPUT)
+         return KIND_PURE;
+      return insn->cache == CACHE_CV ? KIND_WRITE : KIND_READ;
+   case OPCLASS_TEXTURE:
+      return KIND_READ;
+   case OPCLASS_STORE:
+   case OPCLASS_ATOMIC:
+   case OPCLASS_SURFACE:
+      return KIND_WRITE;
+   case OPCLASS_OTHER:
+      if (insn->op == OP_DFDX || insn->op == OP_DFDY)
+         return KIND_PURE;
+      if (insn->op == OP_RDSV &&
+          insn->getSrc(0)->reg.data.sv.sv != SV_CLOCK)
+         return KIND_PURE;
+      return KIND_BARRIER;
+   default:
+      return KIND_BARRIER;
+   }
+}
+
+void
+PreRAScheduling::addDep(int from, int to, int latency)
+{
+   nodes[from].succs.push_back(std::make_pair(to, latency));
+   nodes[to].preds++;
+}
+
+bool
+PreRAScheduling::isLiveOut(const Value *val, const BasicBlock *bb)
+{
+   std::map<const Value *, bool>::iterator it = liveOut.find(val);
+   if (it != liveOut.end())
+      return it->second;
+
+   bool out = false;
+   for (Value::UseCIterator u = val->uses.begin(); u != val->uses.end(); ++u) {
+      const Instruction *insn = (*u)->getInsn();
+      if (insn->bb != bb || insn->op == OP_PHI) {
+         out = true;
+         break;
+      }
+   }
+   liveOut[val] = out;
+   return out;
+}
+
+// change in the number of live GPRs (in 32 bit units) caused by scheduling
+// the node next
+int
+PreRAScheduling::getPressureDelta(const Node& node)
+{
+   const Instruction *insn = node.insn;
+   int delta = 0;
+
+   for (int d = 0; insn->defExists(d); ++d) {
+      Value *def = insn->getDef(d);
+      if (def->reg.file == FILE_GPR && def->refCount())
+         delta += (def->reg.size + 3) / 4;
+   }
+   for (int s = 0; insn->srcExists(s); ++s) {
+      Value *src = insn->getSrc(s);
+      if (src->reg.file != FILE_GPR || !src->asLValue())
+         continue;
+      int n = 0;
+      for (int k = 0; insn->srcExists(k); ++k) {
+         if (insn->getSrc(k) != src)
+            continue;
+         if (k < s)
+            break;
+         ++n;
+      }
+      if (n && uses[src] == n && !isLiveOut(src, insn->bb))
+         delta -= (src->reg.size + 3) / 4;
+   }
+   return delta;
+}
+
+void
+PreRAScheduling::schedule(const Node& node)
+{
+   const Instruction *insn = node.insn;
+
+   pressure += getPressureDelta(node);
+   for (int s = 0; insn->srcExists(s); ++s)
+      if (insn->getSrc(s)->reg.file == FILE_GPR && insn->getSrc(s)->asLValue())
+         uses[insn->getSrc(s)]--;
+}
+
+bool
+PreRAScheduling::visit(BasicBlock *bb)
+{
+   std::map<const Value *, int> lastDef;
+   std::map<const Value *, std::vector<int> > readers;
+   std::vector<int> reads;
+   int lastWrite = -1, lastBarrier = -1;
+
+   nodes.clear();
+   uses.clear();
+   liveOut.clear();
+
+   for (Instruction *i = bb->getEntry(); i; i = i->next) {
+      Node node;
+      node.insn = i;
+      node.preds = 0;
+      node.height = 0;
+      node.ready = 0;
+      node.scheduled = false;
+      nodes.push_back(node);
+   }
+   if (nodes.size() < 3)
+      return true;
+
+   // build the dependency graph
+   for (int n = 0; n < (int)nodes.size(); ++n) {
+      const Instruction *insn = nodes[n].insn;
+      const Kind kind = classify(insn);
+
+      for (int s = 0; insn->srcExists(s); ++s) {
+         Value *src = insn->getSrc(s);
+         if (!src->asLValue())
+            continue;
+         std::map<const Value *, int>::const_iterator it = lastDef.find(src);
+         if (it != lastDef.end())
+            addDep(it->second, n,
+                   targ->getResultLatency(nodes[it->second].insn));
+         readers[src].push_back(n);
+         if (src->reg.file == FILE_GPR)
+            uses[src]++;
+      }
+      for (int d = 0; insn->defExists(d); ++d) {
+         const Value *def = insn->getDef(d);
+         std::map<const Value *, int>::const_iterator it = lastDef.find(def);
+         if (it != lastDef.end())
+            addDep(it->second, n, 1);
+         std::vector<int>& r = readers[def];
+         for (unsigned int k = 0; k < r.size(); ++k)
+            if (r[k] != n)
+               addDep(r[k], n, 0);
+         r.clear();
+         lastDef[def] = n;
+      }
+
+      if (kind == KIND_BARRIER) {
+         for (int p = MAX2(lastBarrier, 0); p < n; ++p)
+            addDep(p, n, 0);
+         lastBarrier = lastWrite = n;
+         reads.clear();
+         continue;
+      }
+      if (lastBarrier >= 0)
+         addDep(lastBarrier, n, 0);
+      if (kind == KIND_READ) {
+         if (lastWrite >= 0)
+            addDep(lastWrite, n, 0);
+         reads.push_back(n);
+      } else
+      if (kind == KIND_WRITE) {
+         if (lastWrite >= 0)
+            addDep(lastWrite, n, 0);
+         for (unsigned int k = 0; k < reads.size(); ++k)
+            addDep(reads[k], n, 0);
+         reads.clear();
+         lastWrite = n;
+      }
+   }
+
+   // the values read in the block but defined before it are live at its start
+   pressure = 0;
+   for (std::map<const Value *, int>::const_iterator it = uses.begin();
+        it != uses.end(); ++it)
+      if (lastDef.find(it->first) == lastDef.end())
+         pressure += (it->first->reg.size + 3) / 4;
+
+   for (int n = nodes.size() - 1; n >= 0; --n) {
+      Node& node = nodes[n];
+      node.height = targ->getResultLatency(node.insn);
+      for (unsigned int k = 0; k < node.succs.size(); ++k) {
+         const int h = node.succs[k].second + nodes[node.succs[k].first].height;
+         node.height = MAX2(node.height, h);
+      }
+   }
+
+   std::vector<Instruction *> order;
+   int cycle = 0;
+
+   while (order.size() < nodes.size()) {
+      const bool high = pressure > limit;
+      int best = -1, bestDelta = 0;
+
+      for (int n = 0; n < (int)nodes.size(); ++n) {
+         const Node& node = nodes[n];
+         if (node.scheduled || node.preds)
+            continue;
+         const int delta = high ? getPressureDelta(node) : 0;
+         if (best < 0) {
+            best = n;
+            bestDelta = delta;
+            continue;
+         }
+         const Node& cur = nodes[best];
+         if (high && delta != bestDelta) {
+            if (delta < bestDelta) {
+               best = n;
+               bestDelta = delta;
+            }
+            continue;
+         }
+         const bool stall = node.ready > cycle, curStall = cur.ready > cycle;
+         if (stall != curStall) {
+            if (!stall) {
+               best = n;
+               bestDelta = delta;
+            }
+            continue;
+         }
+         if (stall && node.ready != cur.ready) {
+            if (node.ready < cur.ready) {
+               best = n;
+               bestDelta = delta;
+            }
+            continue;
+         }
+         if (node.height > cur.height) {
+            best = n;
+            bestDelta = delta;
+         }
+      }
+      assert(best >= 0);
+
+      Node& node = nodes[best];
+      cycle = MAX2(cycle, node.ready);
+      schedule(node);
+      node.scheduled = true;
+      order.push_back(node.insn);
+
+      for (unsigned int k = 0; k < node.succs.size(); ++k) {
+         Node& succ = nodes[node.succs[k].first];
+         succ.preds--;
+         succ.ready = MAX2(succ.ready, cycle + node.succs[k].second);
+      }
+      ++cycle;
+   }
+
+   for (unsigned int k = 0; k < order.size(); ++k) {
+      bb->remove(order[k]);
+      bb->insertTail(order[k]);
+   }
+   return true;
+}
+
+// =============================================================================
+
 #define RUN_PASS(l, n, f)                       \
    if (level >= (l)) {                          \
       if (dbgFlags & NV50_IR_DEBUG_VERBOSE)     \
@@ -3549,6 +3888,18 @@ Program::optimizeSSA(int level)
    return true;
 }
 
+bool
+Program::scheduleInstructions(int level)
+{
+   // only worth it on targets which rely on static scheduling
+   if (!getTarget()->hasSWSched)
+      return true;
+
+   RUN_PASS(2, PreRAScheduling, run);
+
+   return true;
+}
+
 bool
 Program::optimizePostRA(int level)
 {
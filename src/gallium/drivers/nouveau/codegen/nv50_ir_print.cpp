@@ -740,8 +740,9 @@ PrintPass::visit(BasicBlock *bb)
       INFO("idom = BB:%i, ", bb->idom()->getId());
 
    INFO("df = { ");
-   for (DLList::Iterator df = bb->getDF().iterator(); !df.end(); df.next())
-      INFO("BB:%i ", BasicBlock::get(df)->getId());
+   for (unsigned int id = 0; id < bb->getDF().getSize(); ++id)
+      if (bb->getDF().test(id))
+         INFO("BB:%i ", id);
 
    INFO("}\n");
 
@@ -228,7 +228,7 @@ RegisterSet::release(DataFile f, int32_t reg, unsigned int size)
 class RegAlloc
 {
 public:
-   RegAlloc(Program *program) : prog(program), sequence(0) { }
+   RegAlloc(Program *program) : prog(program) { }
 
    bool exec();
    bool execFunc();
@@ -280,16 +280,12 @@ private:
       const Target *targ;
    };
 
-   bool buildLiveSets(BasicBlock *);
-
 private:
    Program *prog;
    Function *func;
 
    // instructions in control flow / chronological order
    ArrayList insns;
-
-   int sequence; // for manual passes through CFG
 };
 
 typedef std::pair<Value *, Value *> ValuePair;
@@ -297,7 +293,8 @@ typedef std::pair<Value *, Value *> ValuePair;
 class SpillCodeInserter
 {
 public:
-   SpillCodeInserter(Function *fn) : func(fn), stackSize(0), stackBase(0) { }
+   SpillCodeInserter(Function *fn) : func(fn), stackSize(0), stackBase(0),
+                                     splitting(false) { }
 
    bool run(const std::list<ValuePair>&);
 
@@ -305,6 +302,10 @@ public:
    Value *offsetSlot(Value *, const LValue *);
    inline int32_t getStackSize() const { return stackSize; }
 
+   // values that can be recomputed at their uses instead of being spilled
+   bool isRematerializable(const LValue *) const;
+   inline void allowSplitting(bool enable) { splitting = enable; }
+
 private:
    Function *func;
 
@@ -320,8 +321,22 @@ private:
    int32_t stackSize;
    int32_t stackBase;
 
+   // a block with a single predecessor that lies on a cycle which doesn't
+   // contain the block itself, i.e. the target of a loop's exit edge
+   struct LoopExit
+   {
+      BasicBlock *bb;
+      std::vector<bool> body; // indexed by BB id
+      unsigned int size;
+   };
+   std::list<LoopExit> loopExits;
+   bool splitting;
+
    LValue *unspill(Instruction *usei, LValue *, Value *slot);
    void spill(Instruction *defi, Value *slot, LValue *);
+   void rematerialize(LValue *);
+   void findLoopExits();
+   bool splitAroundLoop(LValue *, Value *slot);
 };
 
 void
@@ -550,70 +565,6 @@ RegAlloc::ArgumentMovesPass::visit(BasicBlock *bb)
    return true;
 }
 
-// Build the set of live-in variables of bb.
-bool
-RegAlloc::buildLiveSets(BasicBlock *bb)
-{
-   Function *f = bb->getFunction();
-   BasicBlock *bn;
-   Instruction *i;
-   unsigned int s, d;
-
-   INFO_DBG(prog->dbgFlags, REG_ALLOC, "buildLiveSets(BB:%i)\n", bb->getId());
-
-   bb->liveSet.allocate(func->allLValues.getSize(), false);
-
-   int n = 0;
-   for (Graph::EdgeIterator ei = bb->cfg.outgoing(); !ei.end(); ei.next()) {
-      bn = BasicBlock::get(ei.getNode());
-      if (bn == bb)
-         continue;
-      if (bn->cfg.visit(sequence))
-         if (!buildLiveSets(bn))
-            return false;
-      if (n++ || bb->liveSet.marker)
-         bb->liveSet |= bn->liveSet;
-      else
-         bb->liveSet = bn->liveSet;
-   }
-   if (!n && !bb->liveSet.marker)
-      bb->liveSet.fill(0);
-   bb->liveSet.marker = true;
-
-   if (prog->dbgFlags & NV50_IR_DEBUG_REG_ALLOC) {
-      INFO("BB:%i live set of out blocks:\n", bb->getId());
-      bb->liveSet.print();
-   }
-
-   // if (!bb->getEntry())
-   //   return true;
-
-   if (bb == BasicBlock::get(f->cfgExit)) {
-      for (std::deque<ValueRef>::iterator it = f->outs.begin();
-           it != f->outs.end(); ++it) {
-         assert(it->get()->asLValue());
-         bb->liveSet.set(it->get()->id);
-      }
-   }
-
-   for (i = bb->getExit(); i && i != bb->getEntry()->prev; i = i->prev) {
-      for (d = 0; i->defExists(d); ++d)
-         bb->liveSet.clr(i->getDef(d)->id);
-      for (s = 0; i->srcExists(s); ++s)
-         if (i->getSrc(s)->asLValue())
-            bb->liveSet.set(i->getSrc(s)->id);
-   }
-   for (i = bb->getPhi(); i && i->op == OP_PHI; i = i->next)
-      bb->liveSet.clr(i->getDef(0)->id);
-
-   if (prog->dbgFlags & NV50_IR_DEBUG_REG_ALLOC) {
-      INFO("BB:%i live set after propagation:\n", bb->getId());
-      bb->liveSet.print();
-   }
-
-   return true;
-}
-
 void
 RegAlloc::BuildIntervalsPass::collectLiveValues(BasicBlock *bb)
 {
@@ -1253,6 +1204,11 @@ GCRA::calculateSpillWeights()
 
          nodes[i].weight =
             (float)rc * (float)rc / (float)nodes[i].livei.extent();
+
+         // recomputing the value costs about as much as the instruction that
+         // would have loaded it, and doesn't need any local memory
+         if (spill.isRematerializable(val))
+            nodes[i].weight *= 0.25f;
       }
 
       if (nodes[i].degree < nodes[i].degreeLimit) {
@@ -1434,7 +1390,7 @@ GCRA::selectRegisters()
          INFO_DBG(prog->dbgFlags, REG_ALLOC, "must spill: %%%i (size %u)\n",
                   lval->id, lval->reg.size);
          Symbol *slot = NULL;
-         if (lval->reg.file == FILE_GPR)
+         if (lval->reg.file == FILE_GPR && !spill.isRematerializable(lval))
             slot = spill.assignSlot(node->livei, lval->reg.size);
          mustSpill.push_back(ValuePair(lval, slot));
       }
@@ -1465,6 +1421,7 @@ GCRA::allocateRegisters(ArrayList& insns)
    for (unsigned int i = 0; i < nodeCount; ++i) {
       LValue *lval = reinterpret_cast<LValue *>(func->allLValues.get(i));
       if (lval) {
+         nodes[i].livei.setPool(&prog->mem_Range);
          nodes[i].init(regs, lval);
          RIG.insert(&nodes[i]);
 
@@ -1709,6 +1666,226 @@ value_cmp(ValueRef *a, ValueRef *b) {
    return ai->serial < bi->serial;
 }
 
+bool
+SpillCodeInserter::isRematerializable(const LValue *lval) const
+{
+   if (lval->reg.file != FILE_GPR || lval->compound || lval->defs.size() != 1)
+      return false;
+
+   const Instruction *defi = lval->defs.front()->getInsn();
+   if (!defi || defi->defExists(1) || defi->fixed ||
+       defi->predSrc >= 0 || defi->flagsDef >= 0 || defi->flagsSrc >= 0)
+      return false;
+
+   switch (defi->op) {
+   case OP_MOV:
+      if (defi->src(0).getFile() == FILE_IMMEDIATE)
+         break;
+      // fall through
+   case OP_LOAD:
+      if (defi->src(0).getFile() != FILE_MEMORY_CONST ||
+          defi->src(0).isIndirect(0) || defi->src(0).isIndirect(1))
+         return false;
+      break;
+   case OP_RDSV:
+      switch (defi->getSrc(0)->reg.data.sv.sv) {
+      case SV_TID:
+      case SV_CTAID:
+      case SV_NTID:
+      case SV_NCTAID:
+      case SV_LANEID:
+         break;
+      default:
+         return false;
+      }
+      break;
+   default:
+      return false;
+   }
+
+   // pseudo instructions need the value itself
+   for (Value::UseCIterator it = lval->uses.begin(); it != lval->uses.end();
+        ++it)
+      if ((*it)->getInsn()->isPseudo())
+         return false;
+   return true;
+}
+
+// Instead of spilling, re-execute the defining instruction in front of the
+// uses. Like an unspill, this is done only once for a run of adjacent uses.
+void
+SpillCodeInserter::rematerialize(LValue *lval)
+{
+   Instruction *defi = lval->getInsn();
+   Instruction *last = NULL;
+   LValue *tmp = NULL;
+
+   std::vector<ValueRef *> refs(lval->uses.begin(), lval->uses.end());
+   std::sort(refs.begin(), refs.end(), value_cmp);
+
+   for (std::vector<ValueRef *>::const_iterator it = refs.begin();
+        it != refs.end(); ++it) {
+      Instruction *usei = (*it)->getInsn();
+      if (!last || (usei != last->next && usei != last)) {
+         Instruction *insn = cloneShallow(func, defi);
+         tmp = cloneShallow(func, lval);
+         tmp->noSpill = 1;
+         insn->setDef(0, tmp);
+         usei->bb->insertBefore(usei, insn);
+      }
+      last = usei;
+      (*it)->set(tmp);
+   }
+   delete_Instruction(func->getProgram(), defi);
+}
+
+static void
+markReachable(BasicBlock *bb, std::vector<bool>& set, const BasicBlock *stop,
+              bool forward)
+{
+   std::stack<BasicBlock *> stack;
+
+   stack.push(bb);
+   while (!stack.empty()) {
+      BasicBlock *b = stack.top();
+      stack.pop();
+      for (Graph::EdgeIterator ei = forward ? b->cfg.outgoing() :
+              b->cfg.incident(); !ei.end(); ei.next()) {
+         BasicBlock *n = BasicBlock::get(ei.getNode());
+         if (n == stop || set[n->getId()])
+            continue;
+         set[n->getId()] = true;
+         stack.push(n);
+      }
+   }
+}
+
+// Edge types can't be relied upon to find loops here since PhiMovesPass may
+// have split back edges, so look for cycles in the CFG directly.
+void
+SpillCodeInserter::findLoopExits()
+{
+   const unsigned int n = func->allBBlocks.getSize();
+
+   loopExits.clear();
+   for (ArrayList::Iterator bi = func->allBBlocks.iterator();
+        !bi.end(); bi.next()) {
+      BasicBlock *bb = BasicBlock::get(bi);
+      if (bb->cfg.incidentCount() != 1)
+         continue;
+      BasicBlock *pred = BasicBlock::get(bb->cfg.incident().getNode());
+
+      std::vector<bool> fwd(n, false), bwd(n, false);
+      markReachable(pred, fwd, bb, true);
+      if (!fwd[pred->getId()])
+         continue;
+      markReachable(pred, bwd, bb, false);
+
+      LoopExit exit;
+      exit.bb = bb;
+      exit.body.resize(n, false);
+      exit.size = 0;
+      for (unsigned int i = 0; i < n; ++i) {
+         if (fwd[i] && bwd[i]) {
+            exit.body[i] = true;
+            ++exit.size;
+         }
+      }
+      loopExits.push_back(exit);
+   }
+}
+
+// Split the live range of a value that is live across a loop without being
+// used inside it: the uses that can only be reached through the loop's exit
+// share a single reload at the head of the exit block, and the new value may
+// stay in a register for the rest of the program. Only the uses that can be
+// reached from within the loop by other paths are unspilled one by one, and
+// uses before the loop keep the original value.
+bool
+SpillCodeInserter::splitAroundLoop(LValue *lval, Value *slot)
+{
+   if (!splitting || slot->reg.file != FILE_MEMORY_LOCAL)
+      return false;
+   if (lval->compound || lval->defs.size() != 1 || lval->reg.size == 12)
+      return false;
+   Instruction *defi = lval->getInsn();
+   if (!defi || defi->isPseudo())
+      return false;
+   for (Value::UseIterator it = lval->uses.begin(); it != lval->uses.end();
+        ++it)
+      if ((*it)->getInsn()->isPseudo())
+         return false;
+
+   BasicBlock *defBB = defi->bb;
+   const unsigned int n = func->allBBlocks.getSize();
+   const LoopExit *best = NULL;
+   std::vector<bool> fromDef;
+
+   // pick the largest loop that has uses behind its exit
+   for (std::list<LoopExit>::const_iterator it = loopExits.begin();
+        it != loopExits.end(); ++it) {
+      if (it->bb == defBB || it->body[defBB->getId()])
+         continue;
+      if (best && it->size <= best->size)
+         continue;
+
+      // uses that can't be reached from the definition without passing
+      // through the exit are all covered by a reload there
+      std::vector<bool> reach(n, false);
+      markReachable(defBB, reach, it->bb, true);
+      for (Value::UseIterator u = lval->uses.begin(); u != lval->uses.end();
+           ++u) {
+         const BasicBlock *bb = (*u)->getInsn()->bb;
+         if (bb != defBB && !reach[bb->getId()]) {
+            best = &*it;
+            fromDef.swap(reach);
+            break;
+         }
+      }
+   }
+   if (!best)
+      return false;
+
+   BasicBlock *pred = BasicBlock::get(best->bb->cfg.incident().getNode());
+   std::vector<bool> fromLoop(n, false);
+   markReachable(pred, fromLoop, defBB, true);
+
+   const DataType ty = typeOfSize(lval->reg.size);
+   LValue *val = cloneShallow(func, lval);
+   Instruction *ld = new_Instruction(func, OP_LOAD, ty);
+   ld->setDef(0, val);
+   ld->setSrc(0, slot);
+   best->bb->insertHead(ld);
+
+   std::vector<ValueRef *> refs(lval->uses.begin(), lval->uses.end());
+   std::sort(refs.begin(), refs.end(), value_cmp);
+
+   Instruction *last = NULL;
+   LValue *tmp = NULL;
+   bool kept = false;
+   for (std::vector<ValueRef *>::const_iterator it = refs.begin();
+        it != refs.end(); ++it) {
+      Instruction *usei = (*it)->getInsn();
+      const BasicBlock *bb = usei->bb;
+      if (bb != defBB && !fromDef[bb->getId()]) {
+         (*it)->set(val);
+      } else
+      if (fromLoop[bb->getId()]) {
+         if (!last || (usei != last->next && usei != last))
+            tmp = unspill(usei, lval, slot);
+         last = usei;
+         (*it)->set(tmp);
+      } else {
+         kept = true;
+      }
+   }
+
+   spill(defi, slot, lval);
+   if (kept)
+      lval->noSpill = 0;
+   return true;
+}
+
 // For each value that is to be spilled, go through all its definitions.
 // A value can have multiple definitions if it has been coalesced before.
 // For each definition, first go through all its uses and insert an unspill
@@ -1718,14 +1895,27 @@ value_cmp(ValueRef *a, ValueRef *b) {
 // For "Pseudo" instructions (like PHI, SPLIT, MERGE) we can erase the use
 // if we have spilled to a memory location, or simply with the new register.
 // No load or conversion instruction should be needed.
+// Values that are cheap to recompute are rematerialized at their uses
+// instead, and on the first attempt values that are live across a loop have
+// their live ranges split at the loop's exit rather than spilled entirely.
 bool
 SpillCodeInserter::run(const std::list<ValuePair>& lst)
 {
+   if (splitting)
+      findLoopExits();
+
    for (std::list<ValuePair>::const_iterator it = lst.begin(); it != lst.end();
         ++it) {
       LValue *lval = it->first->asLValue();
       Symbol *mem = it->second ? it->second->asSym() : NULL;
 
+      if (!mem && isRematerializable(lval)) {
+         rematerialize(lval);
+         continue;
+      }
+      if (mem && splitAroundLoop(lval, mem))
+         continue;
+
       // Keep track of which instructions to delete later. Deleting them
       // inside the loop is unsafe since a single instruction may have
       // multiple destinations that all need to be spilled (like OP_SPLIT).
@@ -1816,7 +2006,7 @@ RegAlloc::execFunc()
 
    GCRA gcra(func, insertSpills);
 
-   unsigned int i, retries;
+   unsigned int retries;
    bool ret;
 
    if (!func->ins.empty()) {
@@ -1845,20 +2035,24 @@ RegAlloc::execFunc()
       if (prog->dbgFlags & NV50_IR_DEBUG_REG_ALLOC)
          func->print();
 
-      // spilling to registers may add live ranges, need to rebuild everything
-      ret = true;
-      for (sequence = func->cfg.nextSequence(), i = 0;
-           ret && i <= func->loopNestingBound;
-           sequence = func->cfg.nextSequence(), ++i)
-         ret = buildLiveSets(BasicBlock::get(func->cfg.getRoot()));
-      // reset marker
-      for (ArrayList::Iterator bi = func->allBBlocks.iterator();
-           !bi.end(); bi.next())
-         BasicBlock::get(bi)->liveSet.marker = false;
-      if (!ret)
-         break;
+      // spilling to registers may add live ranges, the blocks it modified
+      // are scanned again
+      func->buildLiveSets();
+      if (prog->dbgFlags & NV50_IR_DEBUG_REG_ALLOC) {
+         for (IteratorRef it = func->cfg.iteratorDFS(false);
+              !it->end(); it->next()) {
+            BasicBlock *bb =
+               BasicBlock::get(reinterpret_cast<Graph::Node *>(it->get()));
+            INFO("BB:%i live set:\n", bb->getId());
+            bb->liveSet.print();
+         }
+      }
       func->orderInstructions(this->insns);
 
+      // Splitting adds new live ranges which may have to be spilled in turn,
+      // only do it once so that the retries are left to converge.
+      insertSpills.allowSplitting(retries == 0);
+
       ret = buildIntervals.run(func);
       if (!ret)
          break;
@@ -195,73 +195,32 @@ void DominatorTree::findDominanceFrontiers()
       EdgeIterator succIt, chldIt;
 
       bb = BasicBlock::get(reinterpret_cast<Node *>(dtIt->get()));
-      bb->getDF().clear();
+      Function *fn = bb->getFunction();
+      BitSet &df = bb->getDF();
+
+      df.allocate(fn->allBBlocks.getSize(), true);
 
       for (succIt = bb->cfg.outgoing(); !succIt.end(); succIt.next()) {
          BasicBlock *dfLocal = BasicBlock::get(succIt.getNode());
          if (dfLocal->idom() != bb)
-            bb->getDF().insert(dfLocal);
+            df.set(dfLocal->getId());
       }
 
       for (chldIt = bb->dom.outgoing(); !chldIt.end(); chldIt.next()) {
-         BasicBlock *cb = BasicBlock::get(chldIt.getNode());
+         BitSet &cdf = BasicBlock::get(chldIt.getNode())->getDF();
 
-         DLList::Iterator dfIt = cb->getDF().iterator();
-         for (; !dfIt.end(); dfIt.next()) {
-            BasicBlock *dfUp = BasicBlock::get(dfIt);
+         for (unsigned int id = 0; id < cdf.getSize(); ++id) {
+            if (!cdf.test(id))
+               continue;
+            BasicBlock *dfUp =
+               reinterpret_cast<BasicBlock *>(fn->allBBlocks.get(id));
             if (dfUp->idom() != bb)
-               bb->getDF().insert(dfUp);
+               df.set(id);
          }
       }
    }
 }
 
-// liveIn(bb) = usedBeforeAssigned(bb) U (liveOut(bb) - assigned(bb))
-void
-Function::buildLiveSetsPreSSA(BasicBlock *bb, const int seq)
-{
-   Function *f = bb->getFunction();
-   BitSet usedBeforeAssigned(allLValues.getSize(), true);
-   BitSet assigned(allLValues.getSize(), true);
-
-   bb->liveSet.allocate(allLValues.getSize(), false);
-
-   int n = 0;
-   for (Graph::EdgeIterator ei = bb->cfg.outgoing(); !ei.end(); ei.next()) {
-      BasicBlock *out = BasicBlock::get(ei.getNode());
-      if (out == bb)
-         continue;
-      if (out->cfg.visit(seq))
-         buildLiveSetsPreSSA(out, seq);
-      if (!n++)
-         bb->liveSet = out->liveSet;
-      else
-         bb->liveSet |= out->liveSet;
-   }
-   if (!n && !bb->liveSet.marker)
-      bb->liveSet.fill(0);
-   bb->liveSet.marker = true;
-
-   for (Instruction *i = bb->getEntry(); i; i = i->next) {
-      for (int s = 0; i->srcExists(s); ++s)
-         if (i->getSrc(s)->asLValue() && !assigned.test(i->getSrc(s)->id))
-            usedBeforeAssigned.set(i->getSrc(s)->id);
-      for (int d = 0; i->defExists(d); ++d)
-         assigned.set(i->getDef(d)->id);
-   }
-
-   if (bb == BasicBlock::get(f->cfgExit)) {
-      for (std::deque<ValueRef>::iterator it = f->outs.begin();
-           it != f->outs.end(); ++it) {
-         if (!assigned.test(it->get()->id))
-            usedBeforeAssigned.set(it->get()->id);
-      }
-   }
-
-   bb->liveSet.andNot(assigned);
-   bb->liveSet |= usedBeforeAssigned;
-}
-
 void
 Function::buildDefSetsPreSSA(BasicBlock *bb, const int seq)
 {
@@ -369,10 +328,13 @@ Function::convertToSSA()
       for (DLList::Iterator wI = workList.iterator(); !wI.end(); wI.erase()) {
          bb = BasicBlock::get(wI);
 
-         DLList::Iterator dfIter = bb->getDF().iterator();
-         for (; !dfIter.end(); dfIter.next()) {
+         const BitSet &df = bb->getDF();
+         for (unsigned int id = 0; id < df.getSize(); ++id) {
+            if (!df.test(id))
+               continue;
             Instruction *phi;
-            BasicBlock *dfBB = BasicBlock::get(dfIter);
+            BasicBlock *dfBB =
+               reinterpret_cast<BasicBlock *>(allBBlocks.get(id));
 
             if (hasAlready[dfBB->getId()] >= iterCount)
                continue;
@@ -91,6 +91,16 @@ struct FixupInfo
    FixupEntry entry[0];
 };
 
+// fixup functions of the code emitters, cached code refers to them by index
+void nv50_interpApply(const FixupEntry *, uint32_t *, const FixupData&);
+void nv50_alphatestSet(const FixupEntry *, uint32_t *, const FixupData&);
+void nvc0_interpApply(const FixupEntry *, uint32_t *, const FixupData&);
+void nvc0_selpFlip(const FixupEntry *, uint32_t *, const FixupData&);
+void gk110_interpApply(const FixupEntry *, uint32_t *, const FixupData&);
+void gk110_selpFlip(const FixupEntry *, uint32_t *, const FixupData&);
+void gm107_interpApply(const FixupEntry *, uint32_t *, const FixupData&);
+void gm107_selpFlip(const FixupEntry *, uint32_t *, const FixupData&);
+
 class CodeEmitter
 {
 public:
@@ -228,6 +238,12 @@ public:
                              const Instruction *next) const { return false; }
    virtual int getLatency(const Instruction *) const { return 1; }
    virtual int getThroughput(const Instruction *) const { return 1; }
+   // cycles until the result can be used, including memory round trips;
+   // used to order instructions before RA
+   virtual int getResultLatency(const Instruction *i) const
+   {
+      return getLatency(i);
+   }
 
    virtual unsigned int getFileSize(DataFile) const = 0;
    virtual unsigned int getFileUnit(DataFile) const = 0;
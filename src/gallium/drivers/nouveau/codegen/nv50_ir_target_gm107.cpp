@@ -68,6 +68,40 @@ TargetGM107::isOpSupported(operation op, DataType ty) const
    return true;
 }
 
+// Maxwell has shorter ALU and shared memory latencies than Kepler, but about
+// the same round trip to L2 and the texture units.
+int
+TargetGM107::getResultLatency(const Instruction *i) const
+{
+   if (i->dType == TYPE_F64 || i->sType == TYPE_F64)
+      return 48;
+
+   switch (operationClass[i->op]) {
+   case OPCLASS_TEXTURE:
+      return 200;
+   case OPCLASS_SURFACE:
+   case OPCLASS_ATOMIC:
+      return 250;
+   case OPCLASS_SFU:
+      if (i->op == OP_LINTERP || i->op == OP_PINTERP)
+         return 12;
+      return 15;
+   case OPCLASS_LOAD:
+      switch (i->src(0).getFile()) {
+      case FILE_MEMORY_CONST:
+      case FILE_MEMORY_SHARED:
+         return 24;
+      case FILE_SHADER_INPUT:
+      case FILE_SHADER_OUTPUT:
+         return 30;
+      default:
+         return 200;
+      }
+   default:
+      return 6;
+   }
+}
+
 bool
 TargetGM107::runLegalizePass(Program *prog, CGStage stage) const
 {
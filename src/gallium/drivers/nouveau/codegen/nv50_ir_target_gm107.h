@@ -16,6 +16,7 @@ public:
    virtual uint32_t getBuiltinOffset(int) const;
 
    virtual bool isOpSupported(operation, DataType) const;
+   virtual int getResultLatency(const Instruction *) const;
 };
 
 } // namespace nv50_ir
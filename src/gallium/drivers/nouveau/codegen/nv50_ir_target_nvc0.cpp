@@ -551,6 +551,44 @@ int TargetNVC0::getLatency(const Instruction *i) const
    return 32;
 }
 
+// Unlike getLatency, which is about the distance the scheduling data has to
+// enforce between dependent instructions, this includes the time it takes for
+// loads and texture fetches to come back, which is what the scheduler running
+// before RA tries to cover. Values are for GK110.
+int TargetNVC0::getResultLatency(const Instruction *i) const
+{
+   if (chipset < NVISA_GK104_CHIPSET)
+      return getLatency(i);
+
+   switch (operationClass[i->op]) {
+   case OPCLASS_TEXTURE:
+      return 200;
+   case OPCLASS_SURFACE:
+   case OPCLASS_ATOMIC:
+      return 250;
+   case OPCLASS_SFU:
+      if (i->op == OP_LINTERP || i->op == OP_PINTERP)
+         break;
+      return 20;
+   case OPCLASS_LOAD:
+      switch (i->src(0).getFile()) {
+      case FILE_MEMORY_CONST:
+         break;
+      case FILE_MEMORY_SHARED:
+         return 32;
+      case FILE_SHADER_INPUT:
+      case FILE_SHADER_OUTPUT:
+         return 40;
+      default:
+         return 200;
+      }
+      break;
+   default:
+      break;
+   }
+   return getLatency(i);
+}
+
 // These are "inverse" throughput values, i.e. the number of cycles required
 // to issue a specific instruction for a full warp (32 threads).
 //
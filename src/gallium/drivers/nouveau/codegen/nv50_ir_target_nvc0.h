@@ -60,6 +60,7 @@ public:
    virtual bool canDualIssue(const Instruction *, const Instruction *) const;
    virtual int getLatency(const Instruction *) const;
    virtual int getThroughput(const Instruction *) const;
+   virtual int getResultLatency(const Instruction *) const;
 
    virtual unsigned int getFileSize(DataFile) const;
    virtual unsigned int getFileUnit(DataFile) const;
@@ -88,7 +88,8 @@ Stack::moveTo(Stack& that)
    this->size = 0;
 }
 
-Interval::Interval(const Interval& that) : head(NULL), tail(NULL)
+Interval::Interval(const Interval& that) : head(NULL), tail(NULL),
+                                           pool(that.pool)
 {
    this->insert(that);
 }
@@ -98,12 +99,52 @@ Interval::~Interval()
    clear();
 }
 
+unsigned int
+Interval::getRangeSize()
+{
+   return sizeof(Range);
+}
+
+Interval::Range *
+Interval::newRange(int a, int b)
+{
+   if (!pool)
+      return new Range(a, b);
+   void *mem = pool->allocate();
+   return mem ? new (mem) Range(a, b) : NULL;
+}
+
+void
+Interval::deleteRange(Range *r)
+{
+   if (pool)
+      pool->release(r);
+   else
+      delete r;
+}
+
+void
+Interval::coalesce(Range *r)
+{
+   Range *rnn;
+
+   while (r->next && r->end >= r->next->bgn) {
+      assert(r->bgn <= r->next->bgn);
+      rnn = r->next->next;
+      r->end = MAX2(r->end, r->next->end);
+      deleteRange(r->next);
+      r->next = rnn;
+   }
+   if (!r->next)
+      tail = r;
+}
+
 void
 Interval::clear()
 {
    for (Range *next, *r = head; r; r = next) {
       next = r->next;
-      delete r;
+      deleteRange(r);
    }
    head = tail = NULL;
 }
@@ -132,12 +173,12 @@ Interval::extend(int a, int b)
          r->bgn = a;
          if (b > r->end)
             r->end = b;
-         r->coalesce(&tail);
+         coalesce(r);
          return true;
       }
       if (b > r->end) {
          r->end = b;
-         r->coalesce(&tail);
+         coalesce(r);
          return true;
       }
       assert(a >= r->bgn);
@@ -145,7 +186,11 @@ Interval::extend(int a, int b)
       return true;
    }
 
-   (*nextp) = new Range(a, b);
+   (*nextp) = newRange(a, b);
+   if (!(*nextp)) {
+      (*nextp) = r;
+      return false;
+   }
    (*nextp)->next = r;
 
    for (r = (*nextp); r->next; r = r->next);
@@ -198,9 +243,9 @@ void Interval::unify(Interval &that)
    for (Range *next, *r = that.head; r; r = next) {
       next = r->next;
       this->extend(r->bgn, r->end);
-      delete r;
+      that.deleteRange(r);
    }
-   that.head = NULL;
+   that.head = that.tail = NULL;
 }
 
 int Interval::length() const
@@ -245,8 +290,12 @@ bool BitSet::resize(unsigned int nBits)
       return allocate(nBits, true);
    const unsigned int p = (size + 31) / 32;
    const unsigned int n = (nBits + 31) / 32;
-   if (n == p)
+   if (n == p) {
+      if (nBits < size && (nBits % 32))
+         data[n - 1] &= (1 << (nBits % 32)) - 1;
+      size = nBits;
       return true;
+   }
 
    data = (uint32_t *)REALLOC(data, 4 * p, 4 * n);
    if (!data) {
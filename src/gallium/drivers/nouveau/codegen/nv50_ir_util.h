@@ -419,13 +419,20 @@ private:
    unsigned int size;
 };
 
+class MemoryPool;
+
 class Interval
 {
 public:
-   Interval() : head(0), tail(0) { }
+   Interval() : head(0), tail(0), pool(0) { }
    Interval(const Interval&);
    ~Interval();
 
+   // Ranges are taken from the pool if there is one, it must outlive the
+   // interval and be of at least getRangeSize() bytes per object.
+   inline void setPool(MemoryPool *p) { assert(!head); pool = p; }
+   static unsigned int getRangeSize();
+
    bool extend(int, int);
    void insert(const Interval&);
    void unify(Interval&); // clears source interval
@@ -453,25 +460,15 @@ private:
       Range *next;
       int bgn;
       int end;
-
-      void coalesce(Range **ptail)
-      {
-         Range *rnn;
-
-         while (next && end >= next->bgn) {
-            assert(bgn <= next->bgn);
-            rnn = next->next;
-            end = MAX2(end, next->end);
-            delete next;
-            next = rnn;
-         }
-         if (!next)
-            *ptail = this;
-      }
    };
 
+   Range *newRange(int a, int b);
+   void deleteRange(Range *);
+   void coalesce(Range *);
+
    Range *head;
    Range *tail;
+   MemoryPool *pool;
 };
 
 class BitSet
@@ -552,6 +549,14 @@ public:
       return *this;
    }
 
+   inline bool operator==(const BitSet& set) const
+   {
+      assert(data && set.data);
+      assert(size == set.size);
+      return !memcmp(data, set.data, (size + 31) / 32 * 4);
+   }
+   inline bool operator!=(const BitSet& set) const { return !(*this == set); }
+
    void andNot(const BitSet&);
 
    // bits = (bits | setMask) & ~clrMask
@@ -7,6 +7,7 @@
 #include "util/u_format.h"
 #include "util/u_format_s3tc.h"
 #include "util/u_string.h"
+#include "util/disk_cache.h"
 
 #include "os/os_time.h"
 
@@ -242,6 +243,8 @@ nouveau_screen_init(struct nouveau_screen *screen, struct nouveau_device *dev)
                                        NOUVEAU_BO_GART | NOUVEAU_BO_MAP,
                                        &mm_config);
    screen->mm_VRAM = nouveau_mm_create(dev, NOUVEAU_BO_VRAM, &mm_config);
+
+   screen->disk_cache = disk_cache_create();
    return 0;
 }
 
@@ -253,6 +256,9 @@ nouveau_screen_fini(struct nouveau_screen *screen)
    nouveau_mm_destroy(screen->mm_GART);
    nouveau_mm_destroy(screen->mm_VRAM);
 
+   if (screen->disk_cache)
+      disk_cache_destroy(screen->disk_cache);
+
    nouveau_pushbuf_del(&screen->pushbuf);
 
    nouveau_client_del(&screen->client);
@@ -15,6 +15,7 @@ typedef uint16_t u16;
 extern int nouveau_mesa_debug;
 
 struct nouveau_bo;
+struct disk_cache;
 
 struct nouveau_screen {
    struct pipe_screen base;
@@ -55,6 +56,8 @@ struct nouveau_screen {
 
    bool hint_buf_keep_sysmem_copy;
 
+   struct disk_cache *disk_cache; /* generated shader code, may be NULL */
+
    unsigned vram_domain;
 
    struct {
@@ -319,6 +319,7 @@ nv50_program_create_strmout_state(const struct nv50_ir_prog_info *info,
 
 bool
 nv50_program_translate(struct nv50_program *prog, uint16_t chipset,
+                       struct disk_cache *disk_cache,
                        struct pipe_debug_callback *debug)
 {
    struct nv50_ir_prog_info *info;
@@ -368,7 +369,7 @@ nv50_program_translate(struct nv50_program *prog, uint16_t chipset,
    info->optLevel = 3;
 #endif
 
-   ret = nv50_ir_generate_code(info);
+   ret = nv50_ir_generate_code_cached(info, disk_cache);
    if (ret) {
       NOUVEAU_ERR("shader translation failed: %i\n", ret);
       goto out;
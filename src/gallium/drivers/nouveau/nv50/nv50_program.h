@@ -24,6 +24,7 @@
 #define __NV50_PROG_H__
 
 struct nv50_context;
+struct disk_cache;
 
 #include "pipe/p_state.h"
 #include "pipe/p_shader_tokens.h"
@@ -117,6 +118,7 @@ struct nv50_program {
 };
 
 bool nv50_program_translate(struct nv50_program *, uint16_t chipset,
+                            struct disk_cache *,
                             struct pipe_debug_callback *);
 bool nv50_program_upload_code(struct nv50_context *, struct nv50_program *);
 void nv50_program_destroy(struct nv50_context *, struct nv50_program *);
@@ -551,6 +551,7 @@ nvc0_program_dump(struct nvc0_program *prog)
 
 bool
 nvc0_program_translate(struct nvc0_program *prog, uint16_t chipset,
+                       struct disk_cache *disk_cache,
                        struct pipe_debug_callback *debug)
 {
    struct nv50_ir_prog_info *info;
@@ -562,8 +563,13 @@ nvc0_program_translate(struct nvc0_program *prog, uint16_t chipset,
 
    info->type = prog->type;
    info->target = chipset;
-   info->bin.sourceRep = NV50_PROGRAM_IR_TGSI;
-   info->bin.source = (void *)prog->pipe.tokens;
+   if (prog->pipe.type == PIPE_SHADER_IR_NIR) {
+      info->bin.sourceRep = NV50_PROGRAM_IR_NIR;
+      info->bin.source = prog->pipe.ir.nir;
+   } else {
+      info->bin.sourceRep = NV50_PROGRAM_IR_TGSI;
+      info->bin.source = (void *)prog->pipe.tokens;
+   }
 
 #ifdef DEBUG
    info->target = debug_get_num_option("NV50_PROG_CHIPSET", chipset);
@@ -598,7 +604,7 @@ nvc0_program_translate(struct nvc0_program *prog, uint16_t chipset,
 
    info->assignSlots = nvc0_program_assign_varying_slots;
 
-   ret = nv50_ir_generate_code(info);
+   ret = nv50_ir_generate_code_cached(info, disk_cache);
    if (ret) {
       NOUVEAU_ERR("shader translation failed: %i\n", ret);
       goto out;
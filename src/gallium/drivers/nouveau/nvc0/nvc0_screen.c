@@ -32,6 +32,8 @@
 
 #include "nouveau_vp3_video.h"
 
+#include "codegen/nv50_ir_driver.h"
+
 #include "nvc0/nvc0_context.h"
 #include "nvc0/nvc0_screen.h"
 
@@ -300,6 +302,16 @@ nvc0_screen_get_param(struct pipe_screen *pscreen, enum pipe_cap param)
    return 0;
 }
 
+/* The NIR front end only handles vertex and fragment shaders so far. */
+DEBUG_GET_ONCE_BOOL_OPTION(use_nir, "NV50_PROG_USE_NIR", false)
+
+static bool
+nvc0_screen_shader_uses_nir(unsigned shader)
+{
+   return (shader == PIPE_SHADER_VERTEX || shader == PIPE_SHADER_FRAGMENT) &&
+      debug_get_option_use_nir();
+}
+
 static int
 nvc0_screen_get_shader_param(struct pipe_screen *pscreen, unsigned shader,
                              enum pipe_shader_cap param)
@@ -320,8 +332,11 @@ nvc0_screen_get_shader_param(struct pipe_screen *pscreen, unsigned shader,
 
    switch (param) {
    case PIPE_SHADER_CAP_PREFERRED_IR:
-      return PIPE_SHADER_IR_TGSI;
+      return nvc0_screen_shader_uses_nir(shader) ?
+         PIPE_SHADER_IR_NIR : PIPE_SHADER_IR_TGSI;
    case PIPE_SHADER_CAP_SUPPORTED_IRS:
+      if (nvc0_screen_shader_uses_nir(shader))
+         return (1 << PIPE_SHADER_IR_TGSI) | (1 << PIPE_SHADER_IR_NIR);
       return 1 << PIPE_SHADER_IR_TGSI;
    case PIPE_SHADER_CAP_MAX_INSTRUCTIONS:
    case PIPE_SHADER_CAP_MAX_ALU_INSTRUCTIONS:
@@ -399,6 +414,16 @@ nvc0_screen_get_shader_param(struct pipe_screen *pscreen, unsigned shader,
    }
 }
 
+static const void *
+nvc0_screen_get_compiler_options(struct pipe_screen *pscreen,
+                                 enum pipe_shader_ir ir, unsigned shader)
+{
+   if (ir == PIPE_SHADER_IR_NIR)
+      return nv50_ir_nir_shader_compiler_options(
+         nouveau_screen(pscreen)->device->chipset);
+   return NULL;
+}
+
 static float
 nvc0_screen_get_paramf(struct pipe_screen *pscreen, enum pipe_capf param)
 {
@@ -810,6 +835,7 @@ nvc0_screen_create(struct nouveau_device *dev)
    pscreen->is_format_supported = nvc0_screen_is_format_supported;
    pscreen->get_param = nvc0_screen_get_param;
    pscreen->get_shader_param = nvc0_screen_get_shader_param;
+   pscreen->get_compiler_options = nvc0_screen_get_compiler_options;
    pscreen->get_paramf = nvc0_screen_get_paramf;
    pscreen->get_driver_query_info = nvc0_screen_get_driver_query_info;
    pscreen->get_driver_query_group_info = nvc0_screen_get_driver_query_group_info;
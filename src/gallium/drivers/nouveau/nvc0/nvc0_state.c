@@ -25,6 +25,7 @@
 #include "util/u_helpers.h"
 #include "util/u_inlines.h"
 #include "util/u_transfer.h"
+#include "util/ralloc.h"
 
 #include "tgsi/tgsi_parse.h"
 
@@ -573,7 +574,12 @@ nvc0_sp_state_create(struct pipe_context *pipe,
       return NULL;
 
    prog->type = type;
+   prog->pipe.type = cso->type;
 
+   /* the NIR shader is handed over to us */
+   if (cso->type == PIPE_SHADER_IR_NIR)
+      prog->pipe.ir.nir = cso->ir.nir;
+   else
    if (cso->tokens)
       prog->pipe.tokens = tgsi_dup_tokens(cso->tokens);
 
@@ -582,6 +588,7 @@ nvc0_sp_state_create(struct pipe_context *pipe,
 
    prog->translated = nvc0_program_translate(
       prog, nvc0_context(pipe)->screen->base.device->chipset,
+      nvc0_context(pipe)->screen->base.disk_cache,
       &nouveau_context(pipe)->debug);
 
    return (void *)prog;
@@ -594,7 +601,10 @@ nvc0_sp_state_delete(struct pipe_context *pipe, void *hwcso)
 
    nvc0_program_destroy(nvc0_context(pipe), prog);
 
-   FREE((void *)prog->pipe.tokens);
+   if (prog->pipe.type == PIPE_SHADER_IR_NIR)
+      ralloc_free(prog->pipe.ir.nir);
+   else
+      FREE((void *)prog->pipe.tokens);
    FREE(prog);
 }
 
@@ -697,6 +707,7 @@ nvc0_cp_state_create(struct pipe_context *pipe,
 
    prog->translated = nvc0_program_translate(
       prog, nvc0_context(pipe)->screen->base.device->chipset,
+      nvc0_context(pipe)->screen->base.disk_cache,
       &nouveau_context(pipe)->debug);
 
    return (void *)prog;
@@ -221,9 +221,11 @@ static unsigned r600_create_shader(struct r600_bytecode *bc,
 
 {
 	assert(binary->code_size % 4 == 0);
-	bc->bytecode = CALLOC(1, binary->code_size);
+	/* sb replaces the bytecode with malloc'd memory of its own */
+	bc->bytecode = calloc(1, binary->code_size);
 	memcpy(bc->bytecode, binary->code, binary->code_size);
 	bc->ndw = binary->code_size / 4;
+	bc->type = PIPE_SHADER_COMPUTE;
 
 	r600_shader_binary_read_config(binary, bc, 0, use_kill);
 	return 0;
@@ -233,7 +235,7 @@ static unsigned r600_create_shader(struct r600_bytecode *bc,
 
 static void r600_destroy_shader(struct r600_bytecode *bc)
 {
-	FREE(bc->bytecode);
+	free(bc->bytecode);
 }
 
 static void *evergreen_create_compute_state(struct pipe_context *ctx,
@@ -254,6 +256,11 @@ static void *evergreen_create_compute_state(struct pipe_context *ctx,
 	radeon_elf_read(code, header->num_bytes, &shader->binary);
 	r600_create_shader(&shader->bc, &shader->binary, &use_kill);
 
+	if (!(rctx->screen->b.debug_flags & DBG_NO_SB_CS)) {
+		if (r600_sb_bytecode_process(rctx, &shader->bc, NULL, 0, 1))
+			R600_ERR("r600_sb_bytecode_process failed !\n");
+	}
+
 	/* Upload code + ROdata */
 	shader->code_bo = r600_compute_buffer_alloc_vram(rctx->screen,
 							shader->bc.ndw * 4);
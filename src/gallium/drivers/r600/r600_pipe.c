@@ -30,6 +30,7 @@
 
 #include <errno.h>
 #include "pipe/p_shader_tokens.h"
+#include "util/disk_cache.h"
 #include "util/u_debug.h"
 #include "util/u_memory.h"
 #include "util/u_simple_shaders.h"
@@ -47,7 +48,7 @@ static const struct debug_named_value r600_debug_options[] = {
 
 	/* shader backend */
 	{ "nosb", DBG_NO_SB, "Disable sb backend for graphics shaders" },
-	{ "sbcl", DBG_SB_CS, "Enable sb backend for compute shaders" },
+	{ "nosbcl", DBG_NO_SB_CS, "Disable sb backend for compute shaders" },
 	{ "sbdry", DBG_SB_DRY_RUN, "Don't use optimized bytecode (just print the dumps)" },
 	{ "sbstat", DBG_SB_STAT, "Print optimization statistics for shaders" },
 	{ "sbdump", DBG_SB_DUMP, "Print IR dumps after some optimization passes" },
@@ -589,6 +590,9 @@ static void r600_destroy_screen(struct pipe_screen* pscreen)
 		compute_memory_pool_delete(rscreen->global_pool);
 	}
 
+	if (rscreen->disk_cache)
+		disk_cache_destroy(rscreen->disk_cache);
+
 	r600_destroy_common_screen(&rscreen->b);
 }
 
@@ -694,6 +698,9 @@ struct pipe_screen *r600_screen_create(struct radeon_winsys *ws)
 
 	rscreen->global_pool = compute_memory_pool_new(rscreen);
 
+	if (!(rscreen->b.debug_flags & DBG_NO_SB))
+		rscreen->disk_cache = disk_cache_create();
+
 	/* Create the auxiliary context. This must be done last. */
 	rscreen->b.aux_context = rscreen->b.b.context_create(&rscreen->b.b, NULL, 0);
 
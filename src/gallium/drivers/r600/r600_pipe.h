@@ -232,7 +232,7 @@ struct r600_gs_rings_state {
 #define DBG_NO_CP_DMA		(1 << 30)
 /* shader backend */
 #define DBG_NO_SB		(1 << 21)
-#define DBG_SB_CS		(1 << 22)
+#define DBG_NO_SB_CS		(1 << 22)
 #define DBG_SB_DRY_RUN	(1 << 23)
 #define DBG_SB_STAT		(1 << 24)
 #define DBG_SB_DUMP		(1 << 25)
@@ -250,6 +250,9 @@ struct r600_screen {
 	 * XXX: Not sure if this is the best place for global_pool.  Also,
 	 * it's not thread safe, so it won't work with multiple contexts. */
 	struct compute_memory_pool *global_pool;
+
+	/* optimized sb bytecode, may be NULL */
+	struct disk_cache		*disk_cache;
 };
 
 struct r600_pipe_sampler_view {
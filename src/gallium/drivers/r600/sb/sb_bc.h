@@ -862,6 +862,9 @@ private:
 	int prepare_alu_group(cf_node* cf, alu_group_node *g);
 	int prepare_fetch_clause(cf_node *cf);
 
+	void prepare_lds_access(alu_node *n, unsigned oq_read);
+	void prepare_mem_access(node *n);
+
 	int prepare_loop(cf_node *c);
 	int prepare_if(cf_node *c);
 
@@ -352,7 +352,11 @@ bool bc_finalizer::finalize_alu_src(alu_group_node* g, alu_node* a, alu_group_no
 
 	unsigned si = 0;
 
-	for (vvec::iterator I = sv.begin(), E = sv.end(); I != E; ++I, ++si) {
+	// values appended after the operands only carry dependencies
+	unsigned nsrc = std::min<unsigned>(sv.size(), a->bc.op_ptr->src_count);
+
+	for (vvec::iterator I = sv.begin(), E = sv.begin() + nsrc; I != E;
+			++I, ++si) {
 		value *v = *I;
 		assert(v);
 
@@ -355,6 +355,41 @@ alu_node *bc_parser::get_mova()
 	return mova;
 }
 
+// LDS ops and the reads of the LDS output queues are chained through
+// SV_LDS_RW to keep their order. The values an LDS op pushes to the queues
+// are defined as SV_LDS_OQA/SV_LDS_OQB and used by the ops reading them, the
+// encoded queue selects are kept as the regular operands.
+void bc_parser::prepare_lds_access(alu_node *n, unsigned oq_read) {
+	unsigned op = n->bc.op;
+
+	if (oq_read & 1)
+		n->src.push_back(sh->get_special_value(SV_LDS_OQA));
+	if (oq_read & 2)
+		n->src.push_back(sh->get_special_value(SV_LDS_OQB));
+
+	n->src.push_back(sh->get_special_value(SV_LDS_RW));
+	n->dst.push_back(sh->get_special_value(SV_LDS_RW));
+
+	if (op >= LDS_OP2_LDS_ADD_RET && op <= LDS_OP1_LDS_USHORT_READ_RET)
+		n->dst.push_back(sh->get_special_value(SV_LDS_OQA));
+
+	if (op == LDS_OP3_LDS_XCHG_REL_RET || op == LDS_OP3_LDS_XCHG2_RET ||
+			op == LDS_OP1_LDS_READ_REL_RET || op == LDS_OP2_LDS_READ2_RET)
+		n->dst.push_back(sh->get_special_value(SV_LDS_OQB));
+
+	n->flags |= NF_DONT_KILL | NF_DONT_HOIST | NF_DONT_MOVE;
+}
+
+// Accesses to global memory (RAT writes, vertex fetches and GDS ops in
+// compute shaders) and the instructions waiting for them are chained through
+// SV_MEM, so they are neither reordered nor removed.
+void bc_parser::prepare_mem_access(node *n) {
+	n->src.push_back(sh->get_special_value(SV_MEM));
+	n->dst.push_back(sh->get_special_value(SV_MEM));
+
+	n->flags |= NF_DONT_KILL | NF_DONT_HOIST | NF_DONT_MOVE;
+}
+
 int bc_parser::prepare_alu_group(cf_node* cf, alu_group_node *g) {
 
 	alu_node *n;
@@ -366,6 +401,7 @@ int bc_parser::prepare_alu_group(cf_node* cf, alu_group_node *g) {
 			I != E; ++I) {
 		n = static_cast<alu_node*>(*I);
 		bool ubo_indexing[2] = {};
+		unsigned lds_oq_read = 0;
 
 		if (!sh->assign_slot(n, slots[cgroup])) {
 			assert(!"alu slot assignment failed");
@@ -414,7 +450,8 @@ int bc_parser::prepare_alu_group(cf_node* cf, alu_group_node *g) {
 
 			n->flags |= NF_DONT_HOIST;
 
-		} else if (n->bc.op_ptr->src_count == 3 || n->bc.write_mask) {
+		} else if (!(flags & AF_LDS) &&
+				(n->bc.op_ptr->src_count == 3 || n->bc.write_mask)) {
 			assert(!n->bc.dst_rel || n->bc.index_mode == INDEX_AR_X);
 
 			value *v = sh->get_gpr_value(false, n->bc.dst_gpr, n->bc.dst_chan,
@@ -501,6 +538,16 @@ int bc_parser::prepare_alu_group(cf_node* cf, alu_group_node *g) {
 				case ALU_SRC_M_1_INT:
 					n->src[s] = sh->get_const_value(-1);
 					break;
+				case ALU_SRC_LDS_OQ_A:
+				case ALU_SRC_LDS_OQ_A_POP:
+					lds_oq_read |= 1;
+					n->src[s] = sh->get_special_ro_value(src.sel);
+					break;
+				case ALU_SRC_LDS_OQ_B:
+				case ALU_SRC_LDS_OQ_B_POP:
+					lds_oq_read |= 2;
+					n->src[s] = sh->get_special_ro_value(src.sel);
+					break;
 				default:
 					n->src[s] = sh->get_special_ro_value(src.sel);
 					break;
@@ -508,6 +555,12 @@ int bc_parser::prepare_alu_group(cf_node* cf, alu_group_node *g) {
 			}
 		}
 
+		if ((flags & AF_LDS) || lds_oq_read || n->bc.op == ALU_OP0_GROUP_BARRIER)
+			prepare_lds_access(n, lds_oq_read);
+
+		if (n->bc.op == ALU_OP0_GROUP_BARRIER)
+			prepare_mem_access(n);
+
 		// add UBO index values if any as dependencies
 		if (ubo_indexing[0]) {
 			n->src.push_back(get_cf_index_value(0));
@@ -659,6 +712,10 @@ int bc_parser::prepare_fetch_clause(cf_node *cf) {
 					                              n->bc.src_sel[s], false);
 			}
 
+			// compute shaders may write the memory they read through RATs
+			if (sh->target == TARGET_COMPUTE && (flags & (FF_VTX | FF_GDS)))
+				prepare_mem_access(n);
+
 			// Scheduler will emit the appropriate instructions to set CF_IDX0/1
 			if (n->bc.sampler_index_mode != V_SQ_CF_INDEX_NONE) {
 				n->src.push_back(get_cf_index_value(n->bc.sampler_index_mode == V_SQ_CF_INDEX_1));
@@ -686,6 +743,8 @@ int bc_parser::prepare_ir() {
 			prepare_alu_clause(c);
 		} else if (flags & CF_FETCH) {
 			prepare_fetch_clause(c);
+		} else if (c->bc.op == CF_OP_WAIT_ACK) {
+			prepare_mem_access(c);
 		} else if (c->bc.op == CF_OP_CALL_FS) {
 			sh->init_call_fs(c);
 			c->flags |= NF_SCHEDULE_EARLY | NF_DONT_MOVE;
@@ -788,6 +847,9 @@ int bc_parser::prepare_ir() {
 					c->flags |= NF_DONT_HOIST | NF_DONT_MOVE;
 				}
 
+				if (flags & CF_RAT)
+					prepare_mem_access(c);
+
 				if (flags & CF_EMIT) {
 					// Instruction implicitly depends on prior [EMIT_][CUT]_VERTEX
 					c->src.push_back(sh->get_special_value(SV_GEOMETRY_EMIT));
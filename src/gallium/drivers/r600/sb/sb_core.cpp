@@ -40,6 +40,10 @@
 #include "sb_pass.h"
 #include "sb_sched.h"
 
+#include "util/disk_cache.h"
+#include "util/mesa-sha1.h"
+#include "git_sha1.h"
+
 using namespace r600_sb;
 
 static sb_hw_class translate_chip_class(enum chip_class cc);
@@ -87,6 +91,121 @@ void r600_sb_context_destroy(void * sctx) {
 	}
 }
 
+/* An entry of the on-disk cache holds this header followed by the
+ * optimized bytecode. */
+struct sb_cache_header {
+	uint32_t ndw;
+	uint32_t ngpr;
+	uint32_t nstack;
+};
+
+static void hash_u32(struct mesa_sha1 *sha1, uint32_t v) {
+	_mesa_sha1_update(sha1, &v, sizeof(v));
+}
+
+/* The key covers everything the parser and the passes look at: the input
+ * bytecode, the shader state used to set up the inputs and gpr arrays, and
+ * the target. */
+static void sb_cache_key(struct r600_context *rctx, struct r600_bytecode *bc,
+                         struct r600_shader *pshader, cache_key key) {
+	static const char build_id[] =
+#ifdef PACKAGE_VERSION
+		PACKAGE_VERSION
+#endif
+#ifdef MESA_GIT_SHA1
+		MESA_GIT_SHA1
+#endif
+		"";
+
+	struct mesa_sha1 *sha1 = _mesa_sha1_init();
+
+	_mesa_sha1_update(sha1, build_id, sizeof(build_id));
+	hash_u32(sha1, rctx->b.family);
+	hash_u32(sha1, rctx->b.chip_class);
+	hash_u32(sha1, sb_context::safe_math);
+
+	hash_u32(sha1, bc->type);
+	hash_u32(sha1, bc->ngpr);
+	hash_u32(sha1, bc->nstack);
+
+	hash_u32(sha1, pshader != NULL);
+	if (pshader) {
+		hash_u32(sha1, pshader->vs_as_ls);
+		hash_u32(sha1, pshader->vs_as_es);
+		hash_u32(sha1, pshader->tes_as_es);
+		hash_u32(sha1, pshader->indirect_files);
+		hash_u32(sha1, pshader->bc.ngpr);
+
+		hash_u32(sha1, pshader->num_arrays);
+		for (unsigned i = 0; i < pshader->num_arrays; ++i) {
+			r600_shader_array &a = pshader->arrays[i];
+			hash_u32(sha1, a.gpr_start);
+			hash_u32(sha1, a.gpr_count);
+			hash_u32(sha1, a.comp_mask);
+		}
+
+		hash_u32(sha1, pshader->ninput);
+		for (unsigned i = 0; i < pshader->ninput; ++i) {
+			r600_shader_io &in = pshader->input[i];
+			hash_u32(sha1, in.gpr);
+			hash_u32(sha1, in.spi_sid);
+			hash_u32(sha1, in.interpolate);
+			hash_u32(sha1, in.interpolate_location);
+		}
+	}
+
+	hash_u32(sha1, bc->ndw);
+	_mesa_sha1_update(sha1, bc->bytecode, bc->ndw << 2);
+	_mesa_sha1_final(sha1, key);
+}
+
+static bool sb_cache_load(struct disk_cache *cache, cache_key key,
+                          struct r600_bytecode *bc) {
+	size_t size;
+	uint8_t *data = (uint8_t*)disk_cache_get(cache, key, &size);
+	if (!data)
+		return false;
+
+	sb_cache_header hdr;
+	uint32_t *bytecode = NULL;
+
+	if (size >= sizeof(hdr)) {
+		memcpy(&hdr, data, sizeof(hdr));
+		if (hdr.ndw && size == sizeof(hdr) + (hdr.ndw << 2))
+			bytecode = (uint32_t*)malloc(hdr.ndw << 2);
+	}
+
+	if (bytecode) {
+		memcpy(bytecode, data + sizeof(hdr), hdr.ndw << 2);
+		free(bc->bytecode);
+		bc->bytecode = bytecode;
+		bc->ndw = hdr.ndw;
+		bc->ngpr = hdr.ngpr;
+		bc->nstack = hdr.nstack;
+	}
+
+	free(data);
+	return bytecode != NULL;
+}
+
+static void sb_cache_store(struct disk_cache *cache, cache_key key,
+                           struct r600_bytecode *bc) {
+	sb_cache_header hdr;
+	size_t size = sizeof(hdr) + (bc->ndw << 2);
+	uint8_t *data = (uint8_t*)malloc(size);
+	if (!data)
+		return;
+
+	hdr.ndw = bc->ndw;
+	hdr.ngpr = bc->ngpr;
+	hdr.nstack = bc->nstack;
+	memcpy(data, &hdr, sizeof(hdr));
+	memcpy(data + sizeof(hdr), bc->bytecode, bc->ndw << 2);
+
+	disk_cache_put(cache, key, data, size);
+	free(data);
+}
+
 int r600_sb_bytecode_process(struct r600_context *rctx,
                              struct r600_bytecode *bc,
                              struct r600_shader *pshader,
@@ -107,6 +226,21 @@ int r600_sb_bytecode_process(struct r600_context *rctx,
 
 	SB_DUMP_STAT( sblog << "\nsb: shader " << shader_id << "\n"; );
 
+	/* The debug options are expected to act on every shader, so the cache
+	 * is only used for plain optimization. */
+	struct disk_cache *cache = rctx->screen->disk_cache;
+	cache_key key;
+
+	if (cache && optimize && !dump_bytecode && !sb_context::dump_pass &&
+			!sb_context::dump_stat && !sb_context::dry_run &&
+			!sb_context::dskip_mode) {
+		sb_cache_key(rctx, bc, pshader, key);
+		if (sb_cache_load(cache, key, bc))
+			return 0;
+	} else {
+		cache = NULL;
+	}
+
 	bc_parser parser(*ctx, bc, pshader);
 
 	if ((r = parser.decode())) {
@@ -262,6 +396,9 @@ int r600_sb_bytecode_process(struct r600_context *rctx,
 
 		bc->ngpr = sh->ngpr;
 		bc->nstack = sh->nstack;
+
+		if (cache)
+			sb_cache_store(cache, key, bc);
 	} else {
 		SB_DUMP_STAT( sblog << "sb: dry run: optimized bytecode is not used\n"; );
 	}
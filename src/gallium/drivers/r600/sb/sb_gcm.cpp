@@ -367,13 +367,25 @@ void gcm::bu_sched_bb(bb_node* bb) {
 				continue;
 			}
 
+			if (sq != SQ_ALU && lds_oq_count &&
+					(!bu_ready[SQ_ALU].empty() ||
+					 !bu_ready_next[SQ_ALU].empty())) {
+				GCM_DUMP( sblog << "continuing alu (lds queue)\n"; );
+				sq = SQ_ALU;
+				--sq;
+				continue;
+			}
+
 			if (!bu_ready_next[sq].empty())
 				bu_ready[sq].splice(bu_ready[sq].end(), bu_ready_next[sq]);
 
 			cnt_ready[sq] = bu_ready[sq].size();
 
+			// let the fetches accumulate while there is alu work to do, to
+			// get less but larger fetch clauses
 			if ((sq == SQ_TEX || sq == SQ_VTX) && live_count <= rp_threshold &&
-					cnt_ready[sq] < ctx.max_fetch/2	&&
+					cnt_ready[sq] && last_inst_type != sq &&
+					real_fetch_count(bu_ready[sq]) < ctx.max_fetch/2 &&
 					!bu_ready_next[SQ_ALU].empty()) {
 				sq = SQ_ALU;
 				--sq;
@@ -389,7 +401,7 @@ void gcm::bu_sched_bb(bb_node* bb) {
 				}
 
 				// simple heuristic to limit register pressure,
-				if (sq == SQ_ALU && live_count > rp_threshold &&
+				if (sq == SQ_ALU && live_count > rp_threshold && !lds_oq_count &&
 						(!bu_ready[SQ_TEX].empty() ||
 						 !bu_ready[SQ_VTX].empty() ||
 						 !bu_ready_next[SQ_TEX].empty() ||
@@ -400,27 +412,26 @@ void gcm::bu_sched_bb(bb_node* bb) {
 
 				n = bu_ready[sq].front();
 
-				// real count (e.g. SAMPLE_G will be expanded to 3 instructions,
-				// 2 SET_GRAD_ + 1 SAMPLE_G
-				unsigned ncnt = 1;
-				if (n->is_fetch_inst() && n->src.size() == 12) {
-					ncnt = 3;
-				}
+				unsigned ncnt = fetch_inst_count(n);
 
-				bool sampler_indexing = false;
-				if (n->is_fetch_inst() &&
-					static_cast<fetch_node *>(n)->bc.sampler_index_mode != V_SQ_CF_INDEX_NONE)
-				{
-					sampler_indexing = true; // Give sampler indexed ops get their own clause
-					ncnt = sh.get_ctx().is_cayman() ? 2 : 3; // MOVA + SET_CF_IDX0/1
-				}
+				// Give sampler indexed ops get their own clause
+				bool sampler_indexing = n->is_fetch_inst() &&
+					static_cast<fetch_node *>(n)->bc.sampler_index_mode != V_SQ_CF_INDEX_NONE;
 
 				if ((sq == SQ_TEX || sq == SQ_VTX) &&
-						((last_count >= ctx.max_fetch/2 &&
-						check_alu_ready_count(24)) ||
-								last_count + ncnt > ctx.max_fetch))
+						last_count >= ctx.max_fetch/2 &&
+						check_alu_ready_count(24))
 					break;
-				else if (sq == SQ_CF && last_count > 4 &&
+				else if ((sq == SQ_TEX || sq == SQ_VTX) &&
+						last_count + ncnt > ctx.max_fetch) {
+					// the clause is full, start the next one, and if
+					// there's nothing else to schedule, fill it right away
+					clause = NULL;
+					last_count = 0;
+					if (!bu_ready[SQ_ALU].empty() ||
+							!bu_ready_next[SQ_ALU].empty())
+						break;
+				} else if (sq == SQ_CF && last_count > 4 &&
 						check_alu_ready_count(24))
 					break;
 
@@ -505,6 +516,9 @@ void gcm::bu_schedule(container_node* c, node* n) {
 	bu_release_defs(n->src, true);
 	bu_release_defs(n->dst, false);
 
+	if (n->is_alu_inst())
+		lds_oq_count += n->lds_oq_balance();
+
 	c->push_front(n);
 }
 
@@ -776,6 +790,26 @@ unsigned gcm::real_alu_count(sched_queue& q, unsigned max) {
 	return c;
 }
 
+// real count of the instructions in the fetch clause, e.g. SAMPLE_G will be
+// expanded to 3 instructions, 2 SET_GRAD_ + 1 SAMPLE_G
+unsigned gcm::fetch_inst_count(node *n) {
+	if (!n->is_fetch_inst())
+		return 1;
+
+	if (static_cast<fetch_node *>(n)->bc.sampler_index_mode !=
+			V_SQ_CF_INDEX_NONE)
+		return sh.get_ctx().is_cayman() ? 2 : 3; // MOVA + SET_CF_IDX0/1
+
+	return n->src.size() == 12 ? 3 : 1;
+}
+
+unsigned gcm::real_fetch_count(sched_queue& q) {
+	unsigned c = 0;
+	for (sq_iterator I = q.begin(), E = q.end(); I != E; ++I)
+		c += fetch_inst_count(*I);
+	return c;
+}
+
 bool gcm::check_alu_ready_count(unsigned threshold) {
 	unsigned r = real_alu_count(bu_ready[SQ_ALU], threshold);
 	if (r >= threshold)
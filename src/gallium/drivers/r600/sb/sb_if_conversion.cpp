@@ -135,8 +135,9 @@ bool if_conversion::check_and_convert(region_node *r) {
 		s.dump();
 	);
 
+	// LDS and memory accesses can't be executed speculatively
 	if (s.region_count || s.fetch_count || s.alu_kill_count ||
-			s.if_count != 1 || s.repeat_count)
+			s.side_effect_count || s.if_count != 1 || s.repeat_count)
 		return false;
 
 	unsigned real_alu_count = s.alu_count - s.alu_copy_mov_count;
@@ -454,6 +454,9 @@ void container_node::collect_stats(node_stats& s) {
 			static_cast<container_node*>(n)->collect_stats(s);
 		}
 
+		if (n->flags & NF_DONT_KILL)
+			++s.side_effect_count;
+
 		if (n->is_alu_inst()) {
 			++s.alu_count;
 			alu_node *a = static_cast<alu_node*>(n);
@@ -520,6 +523,7 @@ void node_stats::dump() {
 	sblog << "  depart_count : " << depart_count << "\n";
 	sblog << "  repeat_count : " << repeat_count << "\n";
 	sblog << "  if_count : " << if_count << "\n";
+	sblog << "  side_effect_count : " << side_effect_count << "\n";
 }
 
 unsigned alu_node::interp_param() {
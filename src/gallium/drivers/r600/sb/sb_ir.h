@@ -42,7 +42,11 @@ enum special_regs {
 	SV_EXEC_MASK,
 	SV_AR_INDEX,
 	SV_VALID_MASK,
-	SV_GEOMETRY_EMIT
+	SV_GEOMETRY_EMIT,
+	SV_LDS_RW,
+	SV_LDS_OQA,
+	SV_LDS_OQB,
+	SV_MEM
 };
 
 class node;
@@ -282,9 +286,13 @@ enum value_kind {
 class sb_value_pool : protected sb_pool {
 	unsigned aligned_elt_size;
 
+	// values are looked up by id, keeping the number of elements per block
+	// a power of two avoids the divisions
+	static const unsigned block_elts_log2 = 8;
+
 public:
-	sb_value_pool(unsigned elt_size, unsigned block_elts = 256)
-		: sb_pool(block_elts * (aligned_elt_size = ((elt_size +
+	sb_value_pool(unsigned elt_size)
+		: sb_pool((1u << block_elts_log2) * (aligned_elt_size = ((elt_size +
 				SB_POOL_ALIGN - 1) & ~(SB_POOL_ALIGN - 1)))) {}
 
 	virtual ~sb_value_pool() { delete_all(); }
@@ -292,15 +300,8 @@ public:
 	value* create(value_kind k, sel_chan regid, unsigned ver);
 
 	value* operator[](unsigned id) {
-		unsigned offset = id * aligned_elt_size;
-		unsigned block_id;
-		if (offset < block_size) {
-			block_id = 0;
-		} else {
-			block_id = offset / block_size;
-			offset = offset % block_size;
-		}
-		return (value*)((char*)blocks[block_id] + offset);
+		return (value*)((char*)blocks[id >> block_elts_log2] +
+				(id & ((1u << block_elts_log2) - 1)) * aligned_elt_size);
 	}
 
 	unsigned size() { return total_size / aligned_elt_size; }
@@ -513,6 +514,10 @@ public:
 	bool is_geometry_emit() {
 		return is_special_reg() && select == sel_chan(SV_GEOMETRY_EMIT, 0);
 	}
+	bool is_lds_oq() {
+		return is_special_reg() && (select == sel_chan(SV_LDS_OQA, 0) ||
+				select == sel_chan(SV_LDS_OQB, 0));
+	}
 
 	node* any_def() {
 		assert(!(def && adef));
@@ -627,8 +632,8 @@ public:
 class expr_handler;
 
 class value_table {
-	typedef std::vector<value*> vt_item;
-	typedef std::vector<vt_item> vt_table;
+	typedef std::vector<value*> vt_values;
+	typedef std::vector<unsigned> vt_links;
 
 	expr_handler &ex;
 
@@ -636,15 +641,19 @@ class value_table {
 	unsigned size;
 	unsigned size_mask;
 
-	vt_table hashtable;
-
-	unsigned cnt;
+	// values are stored in the order of addition, the entries of each hash
+	// bucket are chained through the indices in the links vector. Indices
+	// are stored as index + 1, 0 terminates the chain.
+	vt_values values;
+	vt_links links;
+	vt_links heads;
+	vt_links tails;
 
 public:
 
 	value_table(expr_handler &ex, unsigned size_bits = 10)
 		: ex(ex), size_bits(size_bits), size(1u << size_bits),
-		  size_mask(size - 1), hashtable(size), cnt() {}
+		  size_mask(size - 1), values(), links(), heads(size), tails(size) {}
 
 	~value_table() {}
 
@@ -652,7 +661,7 @@ public:
 
 	bool expr_equal(value* l, value* r);
 
-	unsigned count() { return cnt; }
+	unsigned count() { return values.size(); }
 
 	void get_values(vvec & v);
 };
@@ -743,11 +752,12 @@ struct node_stats {
 	unsigned depart_count;
 	unsigned repeat_count;
 	unsigned if_count;
+	unsigned side_effect_count;
 
 	node_stats() : alu_count(), alu_kill_count(), alu_copy_mov_count(),
 			cf_count(), fetch_count(), region_count(),
 			loop_count(), phi_count(), loop_phi_count(), depart_count(),
-			repeat_count(), if_count() {}
+			repeat_count(), if_count(), side_effect_count() {}
 
 	void dump();
 };
@@ -848,6 +858,21 @@ public:
 		return vec_uses_ar(dst) || vec_uses_ar(src);
 	}
 
+	unsigned vec_lds_oq_count(vvec &vv) {
+		unsigned count = 0;
+		for (vvec::iterator I = vv.begin(), E = vv.end(); I != E; ++I) {
+			value *v = *I;
+			if (v && v->is_lds_oq())
+				++count;
+		}
+		return count;
+	}
+
+	// LDS output queue values read by the op minus the ones it pushes
+	int lds_oq_balance() {
+		return (int)vec_lds_oq_count(src) - (int)vec_lds_oq_count(dst);
+	}
+
 
 	region_node* get_parent_region();
 
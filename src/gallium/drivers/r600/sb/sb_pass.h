@@ -255,13 +255,18 @@ class gcm : public pass {
 
 	bool pending_exec_mask_update;
 
+	// LDS output queue values read by the scheduled ops that aren't pushed
+	// yet, the LDS ops pushing them have to end up in the same ALU clause
+	int lds_oq_count;
+
 public:
 
 	gcm(shader &sh) : pass(sh),
 		bu_ready(), bu_ready_next(), bu_ready_early(),
 		ready(), op_map(), uses(), nuc_stk(1), ucs_level(),
 		bu_bb(), pending_defs(), pending_nodes(), cur_sq(),
-		live(), live_count(), pending_exec_mask_update() {}
+		live(), live_count(), pending_exec_mask_update(),
+		lds_oq_count() {}
 
 	virtual int run();
 
@@ -299,6 +304,8 @@ private:
 	void dump_uc_stack();
 
 	unsigned real_alu_count(sched_queue &q, unsigned max);
+	unsigned real_fetch_count(sched_queue &q);
+	unsigned fetch_inst_count(node *n);
 
 	// check if we have not less than threshold ready alu instructions
 	bool check_alu_ready_count(unsigned threshold);
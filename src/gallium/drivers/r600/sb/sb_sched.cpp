@@ -152,6 +152,33 @@ void literal_tracker::unreserve(alu_node* n) {
 	}
 }
 
+unsigned literal_tracker::new_literal_count(alu_node* n) {
+	literal nl[MAX_ALU_LITERALS];
+	unsigned cnt = 0;
+
+	for (vvec::iterator I = n->src.begin(), E = n->src.end(); I != E; ++I) {
+		value *v = *I;
+		if (!v || !v->is_literal())
+			continue;
+
+		literal l = v->literal_value;
+		unsigned i;
+
+		for (i = 0; i < MAX_ALU_LITERALS; ++i)
+			if (uc[i] && lt[i] == l)
+				break;
+		if (i < MAX_ALU_LITERALS)
+			continue;
+
+		for (i = 0; i < cnt; ++i)
+			if (nl[i] == l)
+				break;
+		if (i == cnt && cnt < MAX_ALU_LITERALS)
+			nl[cnt++] = l;
+	}
+	return cnt;
+}
+
 bool literal_tracker::try_reserve(literal l) {
 
 	PSC_DUMP( sblog << "literal reserve " << l.u << "  " << l.f << "\n"; );
@@ -712,6 +739,11 @@ void alu_group_tracker::update_flags(alu_node* n) {
 
 int post_scheduler::run() {
 	run_on(sh.root);
+
+	if (alu.lds_oq_split) {
+		sblog << "post_scheduler: LDS queue reads split from the LDS op\n";
+		return -1;
+	}
 	return 0;
 }
 
@@ -1611,7 +1643,12 @@ bool post_scheduler::check_interferences() {
 
 // add instruction(s) (alu_node or contents of alu_packed_node) to current group
 // returns the number of added instructions on success
-unsigned post_scheduler::try_add_instruction(node *n) {
+// With lookahead set, instructions that would waste the group's resources
+// are deferred so that the rest of the ready list gets a chance to use them
+// first: ops that can also run in a vector slot don't take the trans slot,
+// and ops that need another literal slot wait for the ops that can share the
+// literals already in the group. Deferred ops are retried without lookahead.
+unsigned post_scheduler::try_add_instruction(node *n, bool lookahead) {
 
 	alu_group_tracker &rt = alu.grp();
 
@@ -1687,6 +1724,19 @@ unsigned post_scheduler::try_add_instruction(node *n) {
 		}
 
 		slot = __builtin_ctz(allowed_slots);
+
+		if (lookahead) {
+			if (slot == SLOT_TRANS &&
+					(ctx.alu_slots_mask(a->bc.op_ptr) & 0x0F)) {
+				PSC_DUMP( sblog << "   deferred, keeping trans slot\n"; );
+				return 0;
+			}
+			if (rt.inst_count() && rt.extra_literal_slots(a)) {
+				PSC_DUMP( sblog << "   deferred, new literal slot\n"; );
+				return 0;
+			}
+		}
+
 		a->bc.slot = slot;
 
 		PSC_DUMP( sblog << "slot: " << slot << "\n"; );
@@ -1813,31 +1863,36 @@ bool post_scheduler::prepare_alu_group() {
 
 		++i1;
 
-		for (node_iterator N, I = ready.begin(), E = ready.end(); I != E;
-				I = N) {
-			N = I; ++N;
-			node *n = *I;
+		// the first pass looks ahead over the ready list, the second one
+		// fills the remaining slots with whatever was deferred
+		for (unsigned pass = 0; pass < 2 && rt.inst_count() < ctx.num_slots;
+				++pass) {
+			for (node_iterator N, I = ready.begin(), E = ready.end(); I != E;
+					I = N) {
+				N = I; ++N;
+				node *n = *I;
 
-			PSC_DUMP(
-				sblog << "p_a_g: ";
-				dump::dump_op(n);
-				sblog << "\n";
-			);
+				PSC_DUMP(
+					sblog << "p_a_g: ";
+					dump::dump_op(n);
+					sblog << "\n";
+				);
 
 
-			unsigned cnt = try_add_instruction(n);
+				unsigned cnt = try_add_instruction(n, pass == 0);
 
-			if (!cnt)
-				continue;
+				if (!cnt)
+					continue;
 
-			PSC_DUMP(
-				sblog << "current group:\n";
-				dump_group(rt);
-			);
+				PSC_DUMP(
+					sblog << "current group:\n";
+					dump_group(rt);
+				);
 
-			if (rt.inst_count() == ctx.num_slots) {
-				PSC_DUMP( sblog << " all slots used\n"; );
-				break;
+				if (rt.inst_count() == ctx.num_slots) {
+					PSC_DUMP( sblog << " all slots used\n"; );
+					break;
+				}
 			}
 		}
 
@@ -1952,7 +2007,7 @@ alu_clause_tracker::alu_clause_tracker(shader &sh)
 	: sh(sh), kt(sh.get_ctx().hw_class), slot_count(),
 	  grp0(sh), grp1(sh),
 	  group(), clause(),
-	  push_exec_mask(),
+	  push_exec_mask(), lds_oq_pending(), lds_oq_split(),
 	  current_ar(), current_pr(), current_idx() {}
 
 void alu_clause_tracker::emit_group() {
@@ -1968,6 +2023,9 @@ void alu_clause_tracker::emit_group() {
 
 	assert(g);
 
+	for (node_iterator I = g->begin(), E = g->end(); I != E; ++I)
+		lds_oq_pending += I->lds_oq_balance();
+
 	if (!clause) {
 		clause = sh.create_clause(NST_ALU_CLAUSE);
 	}
@@ -1994,6 +2052,11 @@ void alu_clause_tracker::emit_clause(container_node *c) {
 
 	c->push_front(clause);
 
+	if (lds_oq_pending) {
+		lds_oq_split = true;
+		lds_oq_pending = 0;
+	}
+
 	clause = NULL;
 	push_exec_mask = false;
 	slot_count = 0;
@@ -79,6 +79,7 @@ public:
 	void reset();
 
 	unsigned count() { return !!uc[0] + !!uc[1] + !!uc[2] + !!uc[3]; }
+	unsigned new_literal_count(alu_node *n);
 
 	void init_group_literals(alu_group_node *g);
 
@@ -166,6 +167,12 @@ public:
 	unsigned literal_slot_count() { return (literal_count() + 1) >> 1; };
 	unsigned slot_count() { return inst_count() + literal_slot_count(); }
 
+	// number of additional literal slots required to add n to the group
+	unsigned extra_literal_slots(alu_node *n) {
+		return ((literal_count() + lt.new_literal_count(n) + 1) >> 1) -
+				literal_slot_count();
+	}
+
 	alu_group_node* emit();
 
 	rp_kcache_tracker& kcache() { return kc; }
@@ -212,9 +219,17 @@ class alu_clause_tracker {
 
 	bool push_exec_mask;
 
+	// LDS output queue values read in the clause that aren't pushed yet
+	// (we're scheduling bottom-up)
+	int lds_oq_pending;
+
 public:
 	container_node conflict_nodes;
 
+	// set if a clause had to be emitted between an LDS op and the reads
+	// of the values it pushes to the output queues
+	bool lds_oq_split;
+
 	// current values of AR and PR registers that we have to preload
 	// till the end of clause (in fact, beginning, because we're scheduling
 	// bottom-up)
@@ -291,7 +306,7 @@ public:
 
 	bool check_interferences();
 
-	unsigned try_add_instruction(node *n);
+	unsigned try_add_instruction(node *n, bool lookahead);
 
 	bool check_copy(node *n);
 	void dump_group(alu_group_tracker &rt);
@@ -56,6 +56,10 @@ sb_ostream& operator << (sb_ostream &o, value &v) {
 			case SV_EXEC_MASK: o << "EM"; break;
 			case SV_VALID_MASK: o << "VM"; break;
 			case SV_GEOMETRY_EMIT: o << "GEOMETRY_EMIT"; break;
+			case SV_LDS_RW: o << "LDS_RW"; break;
+			case SV_LDS_OQA: o << "LDS_OQA"; break;
+			case SV_LDS_OQB: o << "LDS_OQB"; break;
+			case SV_MEM: o << "MEM"; break;
 			default: o << "???specialreg"; break;
 		}
 		break;
@@ -139,9 +143,17 @@ void value_table::add_value(value* v) {
 	);
 
 	value_hash hash = v->hash();
-	vt_item & vti = hashtable[hash & size_mask];
-	vti.push_back(v);
-	++cnt;
+	unsigned b = hash & size_mask;
+
+	values.push_back(v);
+	links.push_back(0);
+
+	unsigned id = values.size();
+	if (tails[b])
+		links[tails[b] - 1] = id;
+	else
+		heads[b] = id;
+	tails[b] = id;
 
 	if (v->def && ex.try_fold(v)) {
 		VT_DUMP(
@@ -152,9 +164,8 @@ void value_table::add_value(value* v) {
 		return;
 	}
 
-	int n = 0;
-	for (vt_item::iterator I = vti.begin(), E = vti.end(); I != E; ++I, ++n) {
-		value *c = *I;
+	for (unsigned i = heads[b]; i; i = links[i - 1]) {
+		value *c = values[i - 1];
 
 		if (c == v)
 			break;
@@ -202,13 +213,12 @@ bool value_table::expr_equal(value* l, value* r) {
 }
 
 void value_table::get_values(vvec& v) {
-	v.resize(cnt);
-
-	vvec::iterator T = v.begin();
+	v.clear();
+	v.reserve(values.size());
 
-	for(vt_table::iterator I = hashtable.begin(), E = hashtable.end();
-			I != E; ++I) {
-		T = std::copy(I->begin(), I->end(), T);
+	for (vt_links::iterator I = heads.begin(), E = heads.end(); I != E; ++I) {
+		for (unsigned i = *I; i; i = links[i - 1])
+			v.push_back(values[i - 1]);
 	}
 }
 
@@ -697,6 +697,7 @@ static const struct debug_named_value common_debug_options[] = {
 	{ "noce", DBG_NO_CE, "Disable the constant engine"},
 	{ "unsafemath", DBG_UNSAFE_MATH, "Enable unsafe math shader optimizations" },
 	{ "nodccfb", DBG_NO_DCC_FB, "Disable separate DCC on the main framebuffer" },
+	{ "nospeculation", DBG_NO_SPECULATION, "Don't compile likely shader variants in the background." },
 
 	DEBUG_NAMED_VALUE_END /* must be last */
 };
@@ -103,6 +103,7 @@
 #define DBG_NO_CE		(1llu << 48)
 #define DBG_UNSAFE_MATH		(1llu << 49)
 #define DBG_NO_DCC_FB		(1llu << 50)
+#define DBG_NO_SPECULATION	(1llu << 51)
 
 #define R600_MAP_BUFFER_ALIGNMENT 64
 #define R600_MAX_VIEWPORTS        16
@@ -217,6 +218,12 @@ struct r600_transfer {
 	struct pipe_transfer		transfer;
 	struct r600_resource		*staging;
 	unsigned			offset;
+
+	/* Tiling on the CPU: a linear copy of the box, and the offsets
+	 * of its elements in the mapped texture. */
+	uint8_t				*linear;
+	uint64_t			*tiled_offsets;
+	uint8_t				*tiled_map;
 };
 
 struct r600_fmask_info {
@@ -1089,12 +1089,71 @@ static void r600_query_hw_clear_result(struct r600_query_hw *query,
 	util_query_clear_result(result, query->b.type);
 }
 
+/* Return whether all the results of the query have been written, based on
+ * their fences. This only looks at the results of this query, so unlike
+ * waiting for the query buffers, it doesn't flush the CS or depend on other
+ * queries using the same buffers.
+ */
+static bool r600_query_hw_results_available(struct r600_common_context *rctx,
+					    struct r600_query_hw *query)
+{
+	struct r600_hw_query_params params;
+	struct r600_query_buffer *qbuf;
+
+	switch (query->b.type) {
+	case PIPE_QUERY_OCCLUSION_COUNTER:
+	case PIPE_QUERY_OCCLUSION_PREDICATE:
+	case PIPE_QUERY_TIME_ELAPSED:
+	case PIPE_QUERY_TIMESTAMP:
+	case PIPE_QUERY_PRIMITIVES_EMITTED:
+	case PIPE_QUERY_PRIMITIVES_GENERATED:
+	case PIPE_QUERY_SO_STATISTICS:
+		r600_get_hw_query_params(rctx, query, 0, &params);
+		break;
+	case PIPE_QUERY_PIPELINE_STATISTICS:
+		params.fence_offset = query->result_size - 8;
+		break;
+	default:
+		return false;
+	}
+
+	for (qbuf = &query->buffer; qbuf; qbuf = qbuf->previous) {
+		unsigned results_base;
+		char *map;
+
+		map = rctx->ws->buffer_map(qbuf->buf->buf, NULL,
+					   PIPE_TRANSFER_READ |
+					   PIPE_TRANSFER_UNSYNCHRONIZED);
+		if (!map)
+			return false;
+
+		for (results_base = 0; results_base != qbuf->results_end;
+		     results_base += query->result_size) {
+			uint32_t fence = *(volatile uint32_t *)
+				(map + results_base + params.fence_offset);
+
+			if (!(fence & 0x80000000))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 bool r600_query_hw_get_result(struct r600_common_context *rctx,
 			      struct r600_query *rquery,
 			      bool wait, union pipe_query_result *result)
 {
 	struct r600_query_hw *query = (struct r600_query_hw *)rquery;
 	struct r600_query_buffer *qbuf;
+	unsigned usage = PIPE_TRANSFER_READ;
+
+	/* Polling many queries shouldn't flush the CS each time, nor return
+	 * false while later queries in the same buffers are busy. */
+	if (!wait && r600_query_hw_results_available(rctx, query))
+		usage |= PIPE_TRANSFER_UNSYNCHRONIZED;
+	else if (!wait)
+		usage |= PIPE_TRANSFER_DONTBLOCK;
 
 	query->ops->clear_result(query, result);
 
@@ -1102,9 +1161,7 @@ bool r600_query_hw_get_result(struct r600_common_context *rctx,
 		unsigned results_base = 0;
 		void *map;
 
-		map = r600_buffer_map_sync_with_rings(rctx, qbuf->buf,
-						      PIPE_TRANSFER_READ |
-						      (wait ? 0 : PIPE_TRANSFER_DONTBLOCK));
+		map = r600_buffer_map_sync_with_rings(rctx, qbuf->buf, usage);
 		if (!map)
 			return false;
 
@@ -1423,6 +1423,93 @@ static void r600_texture_invalidate_storage(struct r600_common_context *rctx,
 	rctx->num_alloc_tex_transfer_bytes += rtex->size;
 }
 
+/* Larger boxes are cheaper to (de)tile with a blit. */
+#define R600_CPU_TILING_MAX_SIZE	(16 * 1024)
+
+static bool r600_can_tile_with_cpu(struct r600_common_context *rctx,
+				   struct r600_texture *rtex,
+				   unsigned usage,
+				   const struct pipe_box *box)
+{
+	unsigned size = util_format_get_nblocksx(rtex->resource.b.b.format, box->width) *
+			util_format_get_nblocksy(rtex->resource.b.b.format, box->height) *
+			box->depth * rtex->surface.bpe;
+
+	/* Reading VRAM with the CPU is slow, and the metadata of compressed
+	 * textures can only be resolved by the GPU.
+	 */
+	if (!rctx->ws->surface_get_offsets ||
+	    rctx->screen->info.has_dedicated_vram ||
+	    rtex->resource.b.b.nr_samples > 1 ||
+	    rtex->cmask.size || rtex->fmask.size || rtex->dcc_offset ||
+	    size > R600_CPU_TILING_MAX_SIZE)
+		return false;
+
+	/* Uploads through a staging texture don't wait for the GPU. */
+	if (!(usage & PIPE_TRANSFER_READ) &&
+	    (r600_rings_is_buffer_referenced(rctx, rtex->resource.buf,
+					     RADEON_USAGE_READWRITE) ||
+	     !rctx->ws->buffer_wait(rtex->resource.buf, 0,
+				    RADEON_USAGE_READWRITE)))
+		return false;
+
+	return true;
+}
+
+static bool r600_texture_cpu_tiling_map(struct r600_common_context *rctx,
+					struct r600_texture *rtex,
+					struct r600_transfer *trans,
+					unsigned usage)
+{
+	const struct pipe_box *box = &trans->transfer.box;
+	enum pipe_format format = rtex->resource.b.b.format;
+	unsigned level = trans->transfer.level;
+	unsigned bpe = rtex->surface.bpe;
+	unsigned x = box->x / rtex->surface.blk_w;
+	unsigned y = box->y / rtex->surface.blk_h;
+	unsigned width = util_format_get_nblocksx(format, box->width);
+	unsigned height = util_format_get_nblocksy(format, box->height);
+	unsigned count = width * height * box->depth;
+	unsigned i;
+	int z;
+
+	trans->linear = MALLOC(count * bpe);
+	trans->tiled_offsets = MALLOC(count * sizeof(uint64_t));
+	if (!trans->linear || !trans->tiled_offsets)
+		goto fail;
+
+	for (z = 0; z < box->depth; z++) {
+		if (!rctx->ws->surface_get_offsets(rctx->ws, &rtex->resource.b.b,
+						   &rtex->surface, level, x, y,
+						   box->z + z, width, height,
+						   trans->tiled_offsets +
+						   z * width * height))
+			goto fail;
+	}
+
+	trans->tiled_map = r600_buffer_map_sync_with_rings(rctx, &rtex->resource,
+							   usage);
+	if (!trans->tiled_map)
+		goto fail;
+
+	if (usage & PIPE_TRANSFER_READ) {
+		for (i = 0; i < count; i++)
+			memcpy(trans->linear + i * bpe,
+			       trans->tiled_map + trans->tiled_offsets[i], bpe);
+	}
+
+	trans->transfer.stride = width * bpe;
+	trans->transfer.layer_stride = width * height * bpe;
+	return true;
+
+fail:
+	FREE(trans->linear);
+	FREE(trans->tiled_offsets);
+	trans->linear = NULL;
+	trans->tiled_offsets = NULL;
+	return false;
+}
+
 static void *r600_texture_transfer_map(struct pipe_context *ctx,
 				       struct pipe_resource *texture,
 				       unsigned level,
@@ -1437,6 +1524,7 @@ static void *r600_texture_transfer_map(struct pipe_context *ctx,
 	unsigned offset = 0;
 	char *map;
 	bool use_staging_texture = false;
+	bool use_cpu_tiling = false;
 
 	assert(!(texture->flags & R600_RESOURCE_FLAG_TRANSFER));
 
@@ -1460,6 +1548,8 @@ static void *r600_texture_transfer_map(struct pipe_context *ctx,
 
 		/* Tiled textures need to be converted into a linear texture for CPU
 		 * access. The staging texture is always linear and is placed in GART.
+		 * Small boxes of APU textures are (de)tiled by the CPU instead,
+		 * which saves a GPU round trip.
 		 *
 		 * Reading from VRAM is slow, always use the staging texture in
 		 * this case.
@@ -1467,9 +1557,12 @@ static void *r600_texture_transfer_map(struct pipe_context *ctx,
 		 * Use the staging texture for uploads if the underlying BO
 		 * is busy.
 		 */
-		if (!rtex->surface.is_linear)
-			use_staging_texture = true;
-		else if (usage & PIPE_TRANSFER_READ)
+		if (!rtex->surface.is_linear) {
+			if (r600_can_tile_with_cpu(rctx, rtex, usage, box))
+				use_cpu_tiling = true;
+			else
+				use_staging_texture = true;
+		} else if (usage & PIPE_TRANSFER_READ)
 			use_staging_texture = (rtex->resource.domains &
 					       RADEON_DOMAIN_VRAM) != 0;
 		/* Write & linear only: */
@@ -1494,6 +1587,16 @@ static void *r600_texture_transfer_map(struct pipe_context *ctx,
 	trans->transfer.usage = usage;
 	trans->transfer.box = *box;
 
+	if (use_cpu_tiling) {
+		if (r600_texture_cpu_tiling_map(rctx, rtex, trans, usage)) {
+			*ptransfer = &trans->transfer;
+			return trans->linear;
+		}
+
+		/* Fall back to a staging texture. */
+		use_staging_texture = true;
+	}
+
 	if (rtex->is_depth) {
 		struct r600_texture *staging_depth;
 
@@ -1608,6 +1711,22 @@ static void r600_texture_transfer_unmap(struct pipe_context *ctx,
 	struct pipe_resource *texture = transfer->resource;
 	struct r600_texture *rtex = (struct r600_texture*)texture;
 
+	if (rtransfer->linear) {
+		if (transfer->usage & PIPE_TRANSFER_WRITE) {
+			unsigned bpe = rtex->surface.bpe;
+			unsigned count = transfer->stride / bpe *
+					 (transfer->layer_stride / transfer->stride) *
+					 transfer->box.depth;
+			unsigned i;
+
+			for (i = 0; i < count; i++)
+				memcpy(rtransfer->tiled_map + rtransfer->tiled_offsets[i],
+				       rtransfer->linear + i * bpe, bpe);
+		}
+		FREE(rtransfer->linear);
+		FREE(rtransfer->tiled_offsets);
+	}
+
 	if ((transfer->usage & PIPE_TRANSFER_WRITE) && rtransfer->staging) {
 		if (rtex->is_depth && rtex->resource.b.b.nr_samples <= 1) {
 			ctx->resource_copy_region(ctx, texture, transfer->level,
@@ -744,6 +744,29 @@ struct radeon_winsys {
                         enum radeon_surf_mode mode,
                         struct radeon_surf *surf);
 
+    /**
+     * Compute where the elements of a rectangle of a tiled color surface
+     * are. This is optional.
+     *
+     * \param ws        The winsys this function is called from.
+     * \param tex       Texture description given to surface_init
+     * \param surf      Surface computed by surface_init
+     * \param level     Mipmap level
+     * \param x, y      Top left element, in blocks
+     * \param slice     Slice or layer
+     * \param width     Width of the rectangle, in blocks
+     * \param height    Height of the rectangle, in blocks
+     * \param offsets   Output: width * height byte offsets from the start of
+     *                  the surface, row by row
+     * \return          false on failure
+     */
+    bool (*surface_get_offsets)(struct radeon_winsys *ws,
+                                const struct pipe_resource *tex,
+                                const struct radeon_surf *surf,
+                                unsigned level, unsigned x, unsigned y,
+                                unsigned slice, unsigned width,
+                                unsigned height, uint64_t *offsets);
+
     uint64_t (*query_value)(struct radeon_winsys *ws,
                             enum radeon_value_id value);
 
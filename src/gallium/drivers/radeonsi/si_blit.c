@@ -22,6 +22,7 @@
  */
 
 #include "si_pipe.h"
+#include "tgsi/tgsi_text.h"
 #include "util/u_format.h"
 #include "util/u_surface.h"
 
@@ -830,6 +831,206 @@ struct texture_orig_info {
 	unsigned npix0_y;
 };
 
+static void *si_create_copy_image_cs(struct si_context *sctx)
+{
+	/* CONST[0] = source offset
+	 * CONST[1] = destination offset
+	 * CONST[2] = width, height
+	 */
+	static const char text[] =
+		"COMP\n"
+		"PROPERTY CS_FIXED_BLOCK_WIDTH 8\n"
+		"PROPERTY CS_FIXED_BLOCK_HEIGHT 8\n"
+		"PROPERTY CS_FIXED_BLOCK_DEPTH 1\n"
+		"DCL SV[0], THREAD_ID\n"
+		"DCL SV[1], BLOCK_ID\n"
+		"DCL IMAGE[0], 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_UINT\n"
+		"DCL IMAGE[1], 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_UINT, WR\n"
+		"DCL CONST[0..2]\n"
+		"DCL TEMP[0..3]\n"
+		"IMM[0] UINT32 {8, 8, 1, 0}\n"
+
+		"UMAD TEMP[0].xyz, SV[1].xyzz, IMM[0].xyzz, SV[0].xyzz\n"
+		"USLT TEMP[1].xy, TEMP[0].xyyy, CONST[2].xyyy\n"
+		"AND TEMP[1].x, TEMP[1].xxxx, TEMP[1].yyyy\n"
+		"UIF TEMP[1].xxxx\n"
+			"UADD TEMP[2].xyz, TEMP[0].xyzz, CONST[0].xyzz\n"
+			"LOAD TEMP[3], IMAGE[0], TEMP[2].xyzz, 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_UINT\n"
+			"UADD TEMP[2].xyz, TEMP[0].xyzz, CONST[1].xyzz\n"
+			"STORE IMAGE[1], TEMP[2].xyzz, TEMP[3], 2D_ARRAY, PIPE_FORMAT_R32G32B32A32_UINT\n"
+		"ENDIF\n"
+		"END\n";
+
+	struct tgsi_token tokens[1024];
+	struct pipe_compute_state state = {};
+
+	if (!tgsi_text_translate(text, tokens, ARRAY_SIZE(tokens))) {
+		assert(false);
+		return NULL;
+	}
+
+	state.ir_type = PIPE_SHADER_IR_TGSI;
+	state.prog = tokens;
+
+	return sctx->b.b.create_compute_state(&sctx->b.b, &state);
+}
+
+static enum pipe_format si_copy_image_format(unsigned bpe)
+{
+	switch (bpe) {
+	case 1:
+		return PIPE_FORMAT_R8_UINT;
+	case 2:
+		return PIPE_FORMAT_R16_UINT;
+	case 4:
+		return PIPE_FORMAT_R32_UINT;
+	case 8:
+		return PIPE_FORMAT_R32G32_UINT;
+	case 16:
+		return PIPE_FORMAT_R32G32B32A32_UINT;
+	default:
+		return PIPE_FORMAT_NONE;
+	}
+}
+
+static bool si_is_bound_as_colorbuffer(struct si_context *sctx,
+				       struct pipe_resource *tex)
+{
+	unsigned i;
+
+	for (i = 0; i < sctx->framebuffer.state.nr_cbufs; i++) {
+		if (sctx->framebuffer.state.cbufs[i] &&
+		    sctx->framebuffer.state.cbufs[i]->texture == tex)
+			return true;
+	}
+	return false;
+}
+
+/* Whether a copy can be done by a compute shader, which doesn't need
+ * to save and restore the graphics state like u_blitter.
+ */
+static bool si_can_copy_image_with_cs(struct si_context *sctx,
+				      struct pipe_resource *dst,
+				      struct pipe_resource *src)
+{
+	struct r600_texture *rdst = (struct r600_texture*)dst;
+	struct r600_texture *rsrc = (struct r600_texture*)src;
+
+	if ((dst->target != PIPE_TEXTURE_2D &&
+	     dst->target != PIPE_TEXTURE_2D_ARRAY) ||
+	    (src->target != PIPE_TEXTURE_2D &&
+	     src->target != PIPE_TEXTURE_2D_ARRAY) ||
+	    dst->nr_samples > 1 || src->nr_samples > 1 ||
+	    rdst->is_depth || rsrc->is_depth ||
+	    util_format_is_compressed(dst->format) ||
+	    util_format_is_compressed(src->format) ||
+	    util_format_is_subsampled_422(dst->format) ||
+	    util_format_is_subsampled_422(src->format) ||
+	    rdst->surface.bpe != rsrc->surface.bpe ||
+	    si_copy_image_format(rsrc->surface.bpe) == PIPE_FORMAT_NONE)
+		return false;
+
+	/* Image stores would disable DCC, and they don't update CMASK. */
+	if (rdst->dcc_offset || rdst->cmask.size || rdst->fmask.size)
+		return false;
+
+	/* CB caches are only flushed when the framebuffer changes. */
+	if (si_is_bound_as_colorbuffer(sctx, dst) ||
+	    si_is_bound_as_colorbuffer(sctx, src))
+		return false;
+
+	return true;
+}
+
+static bool si_compute_copy_image(struct si_context *sctx,
+				  struct pipe_resource *dst,
+				  unsigned dst_level,
+				  unsigned dstx, unsigned dsty, unsigned dstz,
+				  struct pipe_resource *src,
+				  unsigned src_level,
+				  const struct pipe_box *src_box)
+{
+	struct pipe_context *ctx = &sctx->b.b;
+	struct r600_texture *rsrc = (struct r600_texture*)src;
+	struct si_images_info *cs_images = &sctx->images[PIPE_SHADER_COMPUTE];
+	struct si_compute *saved_cs = sctx->cs_shader_state.program;
+	struct pipe_image_view saved_images[2] = {};
+	struct pipe_constant_buffer saved_cb = {};
+	struct pipe_image_view images[2] = {};
+	struct pipe_constant_buffer cb = {};
+	struct pipe_grid_info info = {};
+	uint32_t consts[12] = {};
+	unsigned i;
+
+	if (!sctx->cs_copy_image) {
+		sctx->cs_copy_image = si_create_copy_image_cs(sctx);
+		if (!sctx->cs_copy_image)
+			return false;
+	}
+
+	si_get_pipe_constant_buffer(sctx, PIPE_SHADER_COMPUTE, 0, &saved_cb);
+	for (i = 0; i < 2; i++)
+		util_copy_image_view(&saved_images[i], &cs_images->views[i]);
+
+	consts[0] = src_box->x;
+	consts[1] = src_box->y;
+	consts[2] = src_box->z;
+	consts[4] = dstx;
+	consts[5] = dsty;
+	consts[6] = dstz;
+	consts[8] = src_box->width;
+	consts[9] = src_box->height;
+
+	cb.buffer_size = sizeof(consts);
+	cb.user_buffer = consts;
+
+	images[0].resource = src;
+	images[0].format = si_copy_image_format(rsrc->surface.bpe);
+	images[0].access = PIPE_IMAGE_ACCESS_READ;
+	images[0].u.tex.level = src_level;
+	images[0].u.tex.last_layer = util_max_layer(src, src_level);
+
+	images[1].resource = dst;
+	images[1].format = images[0].format;
+	images[1].access = PIPE_IMAGE_ACCESS_WRITE;
+	images[1].u.tex.level = dst_level;
+	images[1].u.tex.last_layer = util_max_layer(dst, dst_level);
+
+	info.block[0] = 8;
+	info.block[1] = 8;
+	info.block[2] = 1;
+	info.grid[0] = DIV_ROUND_UP(src_box->width, 8);
+	info.grid[1] = DIV_ROUND_UP(src_box->height, 8);
+	info.grid[2] = src_box->depth;
+
+	/* Wait for previous reads of the destination and writes of the
+	 * source. Draws and dispatches after the copy also need to wait,
+	 * but back-to-back copies share these flushes.
+	 */
+	sctx->b.flags |= SI_CONTEXT_PS_PARTIAL_FLUSH |
+			 SI_CONTEXT_CS_PARTIAL_FLUSH |
+			 SI_CONTEXT_INV_VMEM_L1;
+
+	ctx->bind_compute_state(ctx, sctx->cs_copy_image);
+	ctx->set_constant_buffer(ctx, PIPE_SHADER_COMPUTE, 0, &cb);
+	ctx->set_shader_images(ctx, PIPE_SHADER_COMPUTE, 0, 2, images);
+
+	sctx->b.render_cond_force_off = true;
+	ctx->launch_grid(ctx, &info);
+	sctx->b.render_cond_force_off = false;
+
+	sctx->b.flags |= SI_CONTEXT_CS_PARTIAL_FLUSH |
+			 SI_CONTEXT_INV_VMEM_L1;
+
+	ctx->bind_compute_state(ctx, saved_cs);
+	ctx->set_shader_images(ctx, PIPE_SHADER_COMPUTE, 0, 2, saved_images);
+	for (i = 0; i < 2; i++)
+		pipe_resource_reference(&saved_images[i].resource, NULL);
+	ctx->set_constant_buffer(ctx, PIPE_SHADER_COMPUTE, 0, &saved_cb);
+	pipe_resource_reference(&saved_cb.buffer, NULL);
+	return true;
+}
+
 void si_resource_copy_region(struct pipe_context *ctx,
 			     struct pipe_resource *dst,
 			     unsigned dst_level,
@@ -859,6 +1060,11 @@ void si_resource_copy_region(struct pipe_context *ctx,
 	si_decompress_subresource(ctx, src, PIPE_MASK_RGBAZS, src_level,
 				  src_box->z, src_box->z + src_box->depth - 1);
 
+	if (si_can_copy_image_with_cs(sctx, dst, src) &&
+	    si_compute_copy_image(sctx, dst, dst_level, dstx, dsty, dstz,
+				  src, src_level, src_box))
+		return;
+
 	dst_width = u_minify(dst->width0, dst_level);
 	dst_height = u_minify(dst->height0, dst_level);
 	src_width0 = src->width0;
@@ -129,6 +129,10 @@ static void si_init_descriptors(struct si_descriptors *desc,
 
 static void si_release_descriptors(struct si_descriptors *desc)
 {
+	int i;
+
+	for (i = 0; i < SI_NUM_DESCRIPTOR_VERSIONS; i++)
+		r600_resource_reference(&desc->versions[i], NULL);
 	r600_resource_reference(&desc->buffer, NULL);
 	FREE(desc->list);
 }
@@ -199,6 +203,70 @@ void si_ce_enable_loads(struct radeon_winsys_cs *ib)
 	radeon_emit(ib, CONTEXT_CONTROL_SHADOW_ENABLE(1));
 }
 
+/**
+ * Upload the descriptors by updating a version of the list that is idle,
+ * which only requires writing the elements that changed since that version
+ * was used.
+ *
+ * Returns false if all versions are busy.
+ */
+static bool si_update_descriptor_version(struct si_context *sctx,
+					 struct si_descriptors *desc,
+					 unsigned list_size)
+{
+	struct radeon_winsys *ws = sctx->b.ws;
+	int i;
+
+	/* Every version misses the elements changed since the last upload. */
+	for (i = 0; i < SI_NUM_DESCRIPTOR_VERSIONS; i++)
+		desc->stale_mask[i] |= desc->dirty_mask;
+
+	for (i = 0; i < SI_NUM_DESCRIPTOR_VERSIONS; i++) {
+		struct r600_resource *buf = desc->versions[i];
+		uint32_t *ptr;
+
+		if (!buf) {
+			buf = (struct r600_resource*)
+			      pipe_buffer_create(sctx->b.b.screen, 0,
+						 PIPE_USAGE_STREAM, list_size);
+			if (!buf)
+				return false;
+
+			desc->versions[i] = buf;
+			desc->stale_mask[i] = desc->num_elements == 32 ?
+				~0u : (1u << desc->num_elements) - 1;
+		} else if (ws->cs_is_buffer_referenced(sctx->b.gfx.cs, buf->buf,
+						       RADEON_USAGE_READWRITE) ||
+			   !ws->buffer_wait(buf->buf, 0, RADEON_USAGE_READWRITE)) {
+			continue;
+		}
+
+		ptr = ws->buffer_map(buf->buf, NULL,
+				     PIPE_TRANSFER_WRITE |
+				     PIPE_TRANSFER_UNSYNCHRONIZED);
+		if (!ptr)
+			return false;
+
+		while (desc->stale_mask[i]) {
+			int begin, count;
+			u_bit_scan_consecutive_range(&desc->stale_mask[i],
+						     &begin, &count);
+
+			begin *= desc->element_dw_size;
+			count *= desc->element_dw_size;
+
+			util_memcpy_cpu_to_le32(ptr + begin, desc->list + begin,
+						count * 4);
+		}
+
+		r600_resource_reference(&desc->buffer, buf);
+		desc->buffer_offset = 0;
+		return true;
+	}
+
+	return false;
+}
+
 static bool si_upload_descriptors(struct si_context *sctx,
 				  struct si_descriptors *desc,
 				  struct r600_atom * atom)
@@ -232,15 +300,17 @@ static bool si_upload_descriptors(struct si_context *sctx,
 		                           &desc->buffer_offset, &desc->buffer))
 			return false;
 	} else {
-		void *ptr;
+		if (!si_update_descriptor_version(sctx, desc, list_size)) {
+			void *ptr;
 
-		u_upload_alloc(sctx->b.uploader, 0, list_size, 256,
-			&desc->buffer_offset,
-			(struct pipe_resource**)&desc->buffer, &ptr);
-		if (!desc->buffer)
-			return false; /* skip the draw call */
+			u_upload_alloc(sctx->b.uploader, 0, list_size, 256,
+				&desc->buffer_offset,
+				(struct pipe_resource**)&desc->buffer, &ptr);
+			if (!desc->buffer)
+				return false; /* skip the draw call */
 
-		util_memcpy_cpu_to_le32(ptr, desc->list, list_size);
+			util_memcpy_cpu_to_le32(ptr, desc->list, list_size);
+		}
 
 		radeon_add_to_buffer_list(&sctx->b, &sctx->b.gfx, desc->buffer,
 	                            RADEON_USAGE_READ, RADEON_PRIO_DESCRIPTORS);
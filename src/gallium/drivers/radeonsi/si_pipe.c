@@ -74,6 +74,8 @@ static void si_destroy_context(struct pipe_context *context)
 		sctx->b.b.delete_tcs_state(&sctx->b.b, sctx->fixed_func_tcs_shader.cso);
 	if (sctx->custom_dsa_flush)
 		sctx->b.b.delete_depth_stencil_alpha_state(&sctx->b.b, sctx->custom_dsa_flush);
+	if (sctx->cs_copy_image)
+		sctx->b.b.delete_compute_state(&sctx->b.b, sctx->cs_copy_image);
 	if (sctx->custom_blend_resolve)
 		sctx->b.b.delete_blend_state(&sctx->b.b, sctx->custom_blend_resolve);
 	if (sctx->custom_blend_decompress)
@@ -103,8 +103,10 @@ struct si_screen {
 	/* Shader cache in memory.
 	 *
 	 * Design & limitations:
-	 * - The shader cache is per screen (= per process), never saved to
-	 *   disk, and skips redundant shader compilations from TGSI to bytecode.
+	 * - The shader cache is per screen (= per process), and skips
+	 *   redundant shader compilations from TGSI to bytecode. It is
+	 *   backed by disk_shader_cache, so that it persists across
+	 *   processes.
 	 * - It can only be used with one-variant-per-shader support, in which
 	 *   case only the main (typically middle) part of shaders is cached.
 	 * - Only VS, TCS, TES, PS are cached, out of which only the hw VS
@@ -114,6 +116,7 @@ struct si_screen {
 	 */
 	pipe_mutex			shader_cache_mutex;
 	struct hash_table		*shader_cache;
+	struct disk_cache		*disk_shader_cache; /* may be NULL */
 
 	/* Shader compiler queue for multithreaded compilation. */
 	struct util_queue		shader_compiler_queue;
@@ -210,6 +213,7 @@ struct si_context {
 	void				*custom_blend_decompress;
 	void				*custom_blend_fastclear;
 	void				*custom_blend_dcc_decompress;
+	void				*cs_copy_image;
 	struct si_screen		*screen;
 
 	struct radeon_winsys_cs		*ce_ib;
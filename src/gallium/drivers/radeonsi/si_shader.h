@@ -71,6 +71,7 @@
 #include <llvm-c/Core.h> /* LLVMModuleRef */
 #include <llvm-c/TargetMachine.h>
 #include "tgsi/tgsi_scan.h"
+#include "os/os_thread.h"
 #include "util/u_queue.h"
 #include "si_state.h"
 
@@ -249,6 +250,8 @@ struct si_shader;
 struct si_shader_selector {
 	struct si_screen	*screen;
 	struct util_queue_fence ready;
+	/* Signalled when the speculative variants have been compiled. */
+	struct util_queue_fence speculation_ready;
 
 	/* Should only be used by si_init_shader_selector_async
 	 * if thread_index == -1 (non-threaded). */
@@ -268,6 +271,8 @@ struct si_shader_selector {
 	struct si_shader	*gs_copy_shader;
 
 	struct tgsi_token       *tokens;
+	/* decoded once for all the variants, may be NULL */
+	struct tgsi_parsed_shader *parsed;
 	struct pipe_stream_output_info  so;
 	struct tgsi_shader_info		info;
 
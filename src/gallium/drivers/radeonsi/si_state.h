@@ -204,6 +204,9 @@ enum {
 #define SI_SHADER_DESCS_IMAGES         3
 #define SI_NUM_SHADER_DESCS            4
 
+/* Number of buffers per descriptor list that are updated in place. */
+#define SI_NUM_DESCRIPTOR_VERSIONS     4
+
 #define SI_DESCS_RW_BUFFERS            0
 #define SI_DESCS_FIRST_SHADER          1
 #define SI_DESCS_FIRST_COMPUTE         (SI_DESCS_FIRST_SHADER + \
@@ -226,6 +229,13 @@ struct si_descriptors {
 	struct r600_resource *buffer;
 	unsigned buffer_offset;
 
+	/* Without CE: buffers holding earlier versions of the list, which
+	 * are updated in place with the elements that changed since, once
+	 * the GPU is done with them. stale_mask[i] are the elements of
+	 * versions[i] that are out of date. */
+	struct r600_resource *versions[SI_NUM_DESCRIPTOR_VERSIONS];
+	unsigned stale_mask[SI_NUM_DESCRIPTOR_VERSIONS];
+
 	/* Offset in CE RAM */
 	unsigned ce_offset;
 
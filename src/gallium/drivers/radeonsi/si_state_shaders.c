@@ -28,11 +28,14 @@
 #include "si_pipe.h"
 #include "sid.h"
 #include "radeon/r600_cs.h"
+#include "git_sha1.h"
 
 #include "tgsi/tgsi_parse.h"
 #include "tgsi/tgsi_ureg.h"
+#include "util/disk_cache.h"
 #include "util/hash_table.h"
 #include "util/crc32.h"
+#include "util/mesa-sha1.h"
 #include "util/u_memory.h"
 #include "util/u_prim.h"
 
@@ -174,9 +177,43 @@ static bool si_load_shader_binary(struct si_shader *shader, void *binary)
 	return true;
 }
 
+/**
+ * Compute the key of a shader in the disk cache. Besides the TGSI binary,
+ * the shader bytecode depends on the Mesa build, the LLVM version, the
+ * chip and the debug flags.
+ */
+static bool si_get_disk_cache_key(struct si_screen *sscreen,
+				  void *tgsi_binary, cache_key key)
+{
+	static const char build_id[] =
+#ifdef PACKAGE_VERSION
+		PACKAGE_VERSION
+#endif
+#ifdef MESA_GIT_SHA1
+		MESA_GIT_SHA1
+#endif
+		"";
+	const unsigned llvm_version = HAVE_LLVM;
+	struct mesa_sha1 *sha1 = _mesa_sha1_init();
+
+	if (!sha1)
+		return false;
+
+	_mesa_sha1_update(sha1, build_id, sizeof(build_id));
+	_mesa_sha1_update(sha1, &llvm_version, sizeof(llvm_version));
+	_mesa_sha1_update(sha1, &sscreen->b.family, sizeof(sscreen->b.family));
+	_mesa_sha1_update(sha1, &sscreen->b.debug_flags,
+			  sizeof(sscreen->b.debug_flags));
+	/* The first dword is the binary size. */
+	_mesa_sha1_update(sha1, tgsi_binary, *(uint32_t*)tgsi_binary);
+	_mesa_sha1_final(sha1, key);
+	return true;
+}
+
 /**
  * Insert a shader into the cache. It's assumed the shader is not in the cache.
- * Use si_shader_cache_load_shader before calling this.
+ * Use si_shader_cache_load_shader before calling this. The shader is also
+ * written to the disk cache, which happens on a separate thread.
  *
  * Returns false on failure, in which case the tgsi_binary should be freed.
  */
@@ -201,21 +238,72 @@ static bool si_shader_cache_insert_shader(struct si_screen *sscreen,
 		return false;
 	}
 
+	if (sscreen->disk_shader_cache) {
+		cache_key key;
+
+		if (si_get_disk_cache_key(sscreen, tgsi_binary, key))
+			disk_cache_put(sscreen->disk_shader_cache, key,
+				       hw_binary, *(uint32_t*)hw_binary);
+	}
+
 	return true;
 }
 
+/**
+ * Load a shader from the cache, looking it up in the disk cache if it isn't
+ * in memory.
+ *
+ * On success, the tgsi_binary has been freed or taken over by the cache.
+ */
 static bool si_shader_cache_load_shader(struct si_screen *sscreen,
 					void *tgsi_binary,
 				        struct si_shader *shader)
 {
 	struct hash_entry *entry =
 		_mesa_hash_table_search(sscreen->shader_cache, tgsi_binary);
-	if (!entry)
+	cache_key key;
+	void *hw_binary, *copy;
+	size_t size;
+
+	if (entry) {
+		if (!si_load_shader_binary(shader, entry->data))
+			return false;
+
+		FREE(tgsi_binary);
+		p_atomic_inc(&sscreen->b.num_shader_cache_hits);
+		return true;
+	}
+
+	if (!sscreen->disk_shader_cache ||
+	    !si_get_disk_cache_key(sscreen, tgsi_binary, key))
 		return false;
 
-	if (!si_load_shader_binary(shader, entry->data))
+	hw_binary = disk_cache_get(sscreen->disk_shader_cache, key, &size);
+	if (!hw_binary)
 		return false;
 
+	if (size < 8 || *(uint32_t*)hw_binary != size ||
+	    !si_load_shader_binary(shader, hw_binary)) {
+		free(hw_binary);
+		return false;
+	}
+
+	/* Keep it in memory too. The entries are freed with FREE, which
+	 * may differ from free, so make a copy.
+	 */
+	entry = NULL;
+	copy = MALLOC(size);
+	if (copy) {
+		memcpy(copy, hw_binary, size);
+		entry = _mesa_hash_table_insert(sscreen->shader_cache,
+						tgsi_binary, copy);
+		if (!entry)
+			FREE(copy);
+	}
+	if (!entry)
+		FREE(tgsi_binary);
+	free(hw_binary);
+
 	p_atomic_inc(&sscreen->b.num_shader_cache_hits);
 	return true;
 }
@@ -251,11 +339,17 @@ bool si_init_shader_cache(struct si_screen *sscreen)
 		_mesa_hash_table_create(NULL,
 					si_shader_cache_key_hash,
 					si_shader_cache_key_equals);
-	return sscreen->shader_cache != NULL;
+	if (!sscreen->shader_cache)
+		return false;
+
+	sscreen->disk_shader_cache = disk_cache_create();
+	return true;
 }
 
 void si_destroy_shader_cache(struct si_screen *sscreen)
 {
+	if (sscreen->disk_shader_cache)
+		disk_cache_destroy(sscreen->disk_shader_cache);
 	if (sscreen->shader_cache)
 		_mesa_hash_table_destroy(sscreen->shader_cache,
 					 si_destroy_shader_cache_entry);
@@ -1274,6 +1368,99 @@ static void si_parse_next_shader_property(const struct tgsi_shader_info *info,
 	}
 }
 
+/**
+ * Set reasonable defaults, so that the shader key doesn't cause any code
+ * to be eliminated.
+ */
+static void si_get_default_shader_key(struct si_shader_selector *sel,
+				      struct si_shader_key *key)
+{
+	unsigned i;
+
+	memset(key, 0, sizeof(*key));
+	si_parse_next_shader_property(&sel->info, key);
+
+	switch (sel->type) {
+	case PIPE_SHADER_TESS_CTRL:
+		key->part.tcs.epilog.prim_mode = PIPE_PRIM_TRIANGLES;
+		break;
+	case PIPE_SHADER_FRAGMENT:
+		key->part.ps.prolog.bc_optimize_for_persp =
+			sel->info.uses_persp_center &&
+			sel->info.uses_persp_centroid;
+		key->part.ps.prolog.bc_optimize_for_linear =
+			sel->info.uses_linear_center &&
+			sel->info.uses_linear_centroid;
+		key->part.ps.epilog.alpha_func = PIPE_FUNC_ALWAYS;
+		for (i = 0; i < 8; i++)
+			if (sel->info.colors_written & (1 << i))
+				key->part.ps.epilog.spi_shader_col_format |=
+					V_028710_SPI_SHADER_FP16_ABGR << (i * 4);
+		break;
+	}
+}
+
+/**
+ * Compile the variants that the first draws are likely to need, so that
+ * they don't have to be compiled at draw time. This only links the main
+ * part with prologs and epilogs, which are shared by all shaders once
+ * compiled.
+ *
+ * The variants are: the default vertex fetch and exports for VS and TES,
+ * and for PS, 8-bit/16-bit and 32-bit float color buffers, as well as
+ * depth-only rendering with and without alpha-to-coverage.
+ */
+static void si_compile_speculative_variants(void *job, int thread_index)
+{
+	struct si_shader_selector *sel = (struct si_shader_selector *)job;
+	struct si_shader_ctx_state state = {sel};
+	struct si_shader_key key;
+	unsigned i;
+
+	/* The main part is compiled by a job with a higher priority, so
+	 * it has already been started. */
+	util_queue_job_wait(&sel->ready);
+
+	if (!sel->main_shader_part)
+		return;
+
+	switch (sel->type) {
+	case PIPE_SHADER_VERTEX:
+	case PIPE_SHADER_TESS_EVAL:
+		si_get_default_shader_key(sel, &key);
+		si_shader_select_with_key(sel->screen, &state, &key,
+					  thread_index);
+		break;
+
+	case PIPE_SHADER_FRAGMENT:
+		si_get_default_shader_key(sel, &key);
+		si_shader_select_with_key(sel->screen, &state, &key,
+					  thread_index);
+
+		si_get_default_shader_key(sel, &key);
+		key.part.ps.epilog.spi_shader_col_format = 0;
+		for (i = 0; i < 8; i++)
+			if (sel->info.colors_written & (1 << i))
+				key.part.ps.epilog.spi_shader_col_format |=
+					V_028710_SPI_SHADER_32_ABGR << (i * 4);
+		si_shader_select_with_key(sel->screen, &state, &key,
+					  thread_index);
+
+		if (sel->info.colors_written & 0x1) {
+			si_get_default_shader_key(sel, &key);
+			key.part.ps.epilog.spi_shader_col_format = 0;
+			si_shader_select_with_key(sel->screen, &state, &key,
+						  thread_index);
+
+			key.part.ps.epilog.spi_shader_col_format =
+				V_028710_SPI_SHADER_32_AR;
+			si_shader_select_with_key(sel->screen, &state, &key,
+						  thread_index);
+		}
+		break;
+	}
+}
+
 /**
  * Compile the main shader part or the monolithic shader as part of
  * si_shader_selector initialization. Since it can be done asynchronously,
@@ -1285,7 +1472,6 @@ void si_init_shader_selector_async(void *job, int thread_index)
 	struct si_screen *sscreen = sel->screen;
 	LLVMTargetMachineRef tm;
 	struct pipe_debug_callback *debug = &sel->debug;
-	unsigned i;
 
 	if (thread_index >= 0) {
 		assert(thread_index < ARRAY_SIZE(sscreen->tm));
@@ -1319,7 +1505,6 @@ void si_init_shader_selector_async(void *job, int thread_index)
 
 		if (tgsi_binary &&
 		    si_shader_cache_load_shader(sscreen, tgsi_binary, shader)) {
-			FREE(tgsi_binary);
 			pipe_mutex_unlock(sscreen->shader_cache_mutex);
 		} else {
 			pipe_mutex_unlock(sscreen->shader_cache_mutex);
@@ -1394,30 +1579,7 @@ void si_init_shader_selector_async(void *job, int thread_index)
 		struct si_shader_ctx_state state = {sel};
 		struct si_shader_key key;
 
-		memset(&key, 0, sizeof(key));
-		si_parse_next_shader_property(&sel->info, &key);
-
-		/* Set reasonable defaults, so that the shader key doesn't
-		 * cause any code to be eliminated.
-		 */
-		switch (sel->type) {
-		case PIPE_SHADER_TESS_CTRL:
-			key.part.tcs.epilog.prim_mode = PIPE_PRIM_TRIANGLES;
-			break;
-		case PIPE_SHADER_FRAGMENT:
-			key.part.ps.prolog.bc_optimize_for_persp =
-				sel->info.uses_persp_center &&
-				sel->info.uses_persp_centroid;
-			key.part.ps.prolog.bc_optimize_for_linear =
-				sel->info.uses_linear_center &&
-				sel->info.uses_linear_centroid;
-			key.part.ps.epilog.alpha_func = PIPE_FUNC_ALWAYS;
-			for (i = 0; i < 8; i++)
-				if (sel->info.colors_written & (1 << i))
-					key.part.ps.epilog.spi_shader_col_format |=
-						V_028710_SPI_SHADER_FP16_ABGR << (i * 4);
-			break;
-		}
+		si_get_default_shader_key(sel, &key);
 
 		if (si_shader_select_with_key(sscreen, &state, &key, thread_index))
 			fprintf(stderr, "radeonsi: can't create a monolithic shader\n");
@@ -1455,6 +1617,7 @@ static void *si_create_shader_selector(struct pipe_context *ctx,
 		FREE(sel);
 		return NULL;
 	}
+	sel->parsed = tgsi_parse_shader(sel->tokens);
 
 	sel->so = state->stream_output;
 	tgsi_scan_shader(state->tokens, &sel->info);
@@ -1623,6 +1786,7 @@ static void *si_create_shader_selector(struct pipe_context *ctx,
 
 	pipe_mutex_init(sel->mutex);
 	util_queue_fence_init(&sel->ready);
+	util_queue_fence_init(&sel->speculation_ready);
 
 	if ((sctx->b.debug.debug_message && !sctx->b.debug.async) ||
 	    sctx->is_debug ||
@@ -1630,9 +1794,25 @@ static void *si_create_shader_selector(struct pipe_context *ctx,
 	    !util_queue_is_initialized(&sscreen->shader_compiler_queue))
 		si_init_shader_selector_async(sel, -1);
 	else
-		util_queue_add_job(&sscreen->shader_compiler_queue, sel,
-                                   &sel->ready, si_init_shader_selector_async,
-                                   NULL);
+		/* The first draw using the shader waits for this, so don't
+		 * put it behind the optimized variants compiled in the
+		 * background. */
+		util_queue_add_job_with_priority(&sscreen->shader_compiler_queue,
+						 sel, &sel->ready,
+						 si_init_shader_selector_async,
+						 NULL, UTIL_QUEUE_PRIORITY_HIGH);
+
+	/* Compile likely variants in the background once the main part is
+	 * ready. Monolithic shaders are too expensive for this. */
+	if (util_queue_is_initialized(&sscreen->shader_compiler_queue) &&
+	    !sscreen->use_monolithic_shaders &&
+	    !(sscreen->b.debug_flags & (DBG_NO_SPECULATION | DBG_PRECOMPILE)) &&
+	    (sel->type == PIPE_SHADER_VERTEX ||
+	     sel->type == PIPE_SHADER_TESS_EVAL ||
+	     sel->type == PIPE_SHADER_FRAGMENT))
+		util_queue_add_job(&sscreen->shader_compiler_queue,
+				   sel, &sel->speculation_ready,
+				   si_compile_speculative_variants, NULL);
 
 	return sel;
 }
@@ -1782,6 +1962,7 @@ static void si_delete_shader_selector(struct pipe_context *ctx, void *state)
 	};
 
 	util_queue_job_wait(&sel->ready);
+	util_queue_job_wait(&sel->speculation_ready);
 
 	if (current_shader[sel->type]->cso == sel) {
 		current_shader[sel->type]->cso = NULL;
@@ -1800,7 +1981,9 @@ static void si_delete_shader_selector(struct pipe_context *ctx, void *state)
 		si_delete_shader(sctx, sel->gs_copy_shader);
 
 	util_queue_fence_destroy(&sel->ready);
+	util_queue_fence_destroy(&sel->speculation_ready);
 	pipe_mutex_destroy(sel->mutex);
+	tgsi_free_parsed_shader(sel->parsed);
 	free(sel->tokens);
 	free(sel);
 }
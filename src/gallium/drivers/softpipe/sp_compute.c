@@ -24,6 +24,8 @@
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_pstipple.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
 #include "pipe/p_shader_tokens.h"
 #include "draw/draw_context.h"
 #include "draw/draw_vertex.h"
@@ -164,28 +166,30 @@ fill_grid_size(struct pipe_context *context,
    pipe_buffer_unmap(context, transfer);
 }
 
-void
-softpipe_launch_grid(struct pipe_context *context,
-                     const struct pipe_grid_info *info)
+/**
+ * Run the workgroups with linear indices [first, last) of the grid.
+ *
+ * Each call has its own interpreter machines and its own local memory, so
+ * several ranges of the same grid may run concurrently.
+ */
+static void
+run_workgroups(struct softpipe_context *softpipe,
+               const struct sp_compute_shader *cs,
+               const uint32_t grid_size[3],
+               unsigned first, unsigned last)
 {
-   struct softpipe_context *softpipe = softpipe_context(context);
-   struct sp_compute_shader *cs = softpipe->cs;
    int num_threads_in_group;
    struct tgsi_exec_machine **machines;
    int bwidth, bheight, bdepth;
    int w, h, d, i;
-   int g_w, g_h, g_d;
-   uint32_t grid_size[3];
+   unsigned g;
    void *local_mem = NULL;
 
-   softpipe_update_compute_samplers(softpipe);
    bwidth = cs->info.properties[TGSI_PROPERTY_CS_FIXED_BLOCK_WIDTH];
    bheight = cs->info.properties[TGSI_PROPERTY_CS_FIXED_BLOCK_HEIGHT];
    bdepth = cs->info.properties[TGSI_PROPERTY_CS_FIXED_BLOCK_DEPTH];
    num_threads_in_group = bwidth * bheight * bdepth;
 
-   fill_grid_size(context, info, grid_size);
-
    if (cs->shader.req_local_mem) {
       local_mem = CALLOC(1, cs->shader.req_local_mem);
    }
@@ -219,12 +223,12 @@ softpipe_launch_grid(struct pipe_context *context,
       }
    }
 
-   for (g_d = 0; g_d < grid_size[2]; g_d++) {
-      for (g_h = 0; g_h < grid_size[1]; g_h++) {
-         for (g_w = 0; g_w < grid_size[0]; g_w++) {
-            run_workgroup(cs, g_w, g_h, g_d, num_threads_in_group, machines);
-         }
-      }
+   for (g = first; g < last; g++) {
+      int g_w = g % grid_size[0];
+      int g_h = (g / grid_size[0]) % grid_size[1];
+      int g_d = g / (grid_size[0] * grid_size[1]);
+
+      run_workgroup(cs, g_w, g_h, g_d, num_threads_in_group, machines);
    }
 
    for (i = 0; i < num_threads_in_group; i++) {
@@ -235,3 +239,105 @@ softpipe_launch_grid(struct pipe_context *context,
    FREE(local_mem);
    FREE(machines);
 }
+
+struct sp_cs_job {
+   struct softpipe_context *softpipe;
+   const struct sp_compute_shader *cs;
+   const uint32_t *grid_size;
+   unsigned first, last;
+   struct util_queue_fence fence;
+};
+
+static void
+cs_job_execute(void *data, int thread_index)
+{
+   struct sp_cs_job *job = data;
+
+   run_workgroups(job->softpipe, job->cs, job->grid_size,
+                  job->first, job->last);
+}
+
+/**
+ * Whether the workgroups of \p cs can run concurrently.
+ *
+ * The texture tile caches are filled on demand and the interpreter's
+ * atomics are plain read-modify-write sequences, so shaders using either
+ * run on the calling thread only.
+ */
+static bool
+cs_is_parallel_safe(const struct sp_compute_shader *cs)
+{
+   unsigned op;
+
+   if (cs->max_sampler != -1 ||
+       cs->info.file_count[TGSI_FILE_SAMPLER_VIEW])
+      return false;
+
+   for (op = TGSI_OPCODE_ATOMUADD; op <= TGSI_OPCODE_ATOMIMAX; op++) {
+      if (cs->info.opcode_count[op])
+         return false;
+   }
+
+   return true;
+}
+
+static unsigned
+cs_num_jobs(struct softpipe_context *softpipe,
+            const struct sp_compute_shader *cs,
+            unsigned num_groups)
+{
+   unsigned num_threads = MIN2(util_cpu_caps.nr_cpus, SP_MAX_CS_THREADS);
+
+   if (num_threads < 2 || num_groups < 2 || !cs_is_parallel_safe(cs))
+      return 1;
+
+   if (!util_queue_is_initialized(&softpipe->cs_queue) &&
+       !util_queue_init(&softpipe->cs_queue, "softpipe_cs",
+                        SP_MAX_CS_THREADS, num_threads))
+      return 1;
+
+   return MIN2(num_groups, softpipe->cs_queue.num_threads);
+}
+
+void
+softpipe_launch_grid(struct pipe_context *context,
+                     const struct pipe_grid_info *info)
+{
+   struct softpipe_context *softpipe = softpipe_context(context);
+   struct sp_compute_shader *cs = softpipe->cs;
+   struct sp_cs_job jobs[SP_MAX_CS_THREADS];
+   uint32_t grid_size[3];
+   unsigned num_groups, num_jobs, i;
+
+   softpipe_update_compute_samplers(softpipe);
+
+   fill_grid_size(context, info, grid_size);
+   num_groups = grid_size[0] * grid_size[1] * grid_size[2];
+   if (!num_groups)
+      return;
+
+   num_jobs = cs_num_jobs(softpipe, cs, num_groups);
+   if (num_jobs == 1) {
+      run_workgroups(softpipe, cs, grid_size, 0, num_groups);
+      return;
+   }
+
+   /* Hand out contiguous ranges of workgroups, one per worker thread. */
+   for (i = 0; i < num_jobs; i++) {
+      struct sp_cs_job *job = &jobs[i];
+
+      job->softpipe = softpipe;
+      job->cs = cs;
+      job->grid_size = grid_size;
+      job->first = (uint64_t)num_groups * i / num_jobs;
+      job->last = (uint64_t)num_groups * (i + 1) / num_jobs;
+      util_queue_fence_init(&job->fence);
+      util_queue_add_job(&softpipe->cs_queue, job, &job->fence,
+                         cs_job_execute, NULL);
+   }
+
+   for (i = 0; i < num_jobs; i++) {
+      util_queue_job_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+}
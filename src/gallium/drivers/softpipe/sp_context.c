@@ -74,6 +74,9 @@ softpipe_destroy( struct pipe_context *pipe )
    if (softpipe->draw)
       draw_destroy( softpipe->draw );
 
+   if (util_queue_is_initialized(&softpipe->cs_queue))
+      util_queue_destroy(&softpipe->cs_queue);
+
    if (softpipe->quad.shade)
       softpipe->quad.shade->destroy( softpipe->quad.shade );
 
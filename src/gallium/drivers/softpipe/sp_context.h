@@ -33,6 +33,7 @@
 
 #include "pipe/p_context.h"
 #include "util/u_blitter.h"
+#include "util/u_queue.h"
 
 #include "draw/draw_vertex.h"
 
@@ -46,6 +47,9 @@
 /** Do polygon stipple with the util module? */
 #define DO_PSTIPPLE_IN_HELPER_MODULE 1
 
+/** Max number of threads running compute workgroups */
+#define SP_MAX_CS_THREADS 16
+
 
 struct softpipe_vbuf_render;
 struct draw_context;
@@ -180,6 +184,9 @@ struct softpipe_context {
    } tgsi;
 
    struct tgsi_exec_machine *fs_machine;
+
+   /** Worker threads for compute grids, created on first use */
+   struct util_queue cs_queue;
    /** whether early depth testing is enabled */
    bool early_depth;
 
@@ -522,6 +522,43 @@ svga_buffer_upload_flush(struct svga_context *svga,
 }
 
 
+/**
+ * Merge into range i all the other ranges it now overlaps or touches.
+ *
+ * This can only be done while no DMA upload command is pending, since
+ * that command has one box per range.
+ */
+static void
+svga_buffer_merge_ranges(struct svga_buffer *sbuf, unsigned i)
+{
+   struct svga_buffer_range *ranges = sbuf->map.ranges;
+   unsigned j = 0;
+
+   assert(!sbuf->dma.pending);
+
+   while (j < sbuf->map.num_ranges) {
+      if (j != i &&
+          ranges[j].start <= ranges[i].end &&
+          ranges[i].start <= ranges[j].end) {
+         ranges[i].start = MIN2(ranges[i].start, ranges[j].start);
+         ranges[i].end   = MAX2(ranges[i].end,   ranges[j].end);
+
+         /* Replace range j with the last one, and start over since range
+          * i has grown.
+          */
+         --sbuf->map.num_ranges;
+         ranges[j] = ranges[sbuf->map.num_ranges];
+         if (i == sbuf->map.num_ranges)
+            i = j;
+         j = 0;
+      }
+      else {
+         ++j;
+      }
+   }
+}
+
+
 /**
  * Note a dirty range.
  *
@@ -568,6 +605,14 @@ svga_buffer_add_range(struct svga_buffer *sbuf, unsigned start, unsigned end)
           */
          sbuf->map.ranges[i].start = MIN2(sbuf->map.ranges[i].start, start);
          sbuf->map.ranges[i].end   = MAX2(sbuf->map.ranges[i].end,   end);
+
+         /*
+          * The grown range may now reach other ranges too.  Merge them,
+          * unless a DMA command was already emitted for the current
+          * ranges, to upload fewer and larger boxes.
+          */
+         if (!sbuf->dma.pending)
+            svga_buffer_merge_ranges(sbuf, i);
          return;
       }
       else {
@@ -614,6 +659,7 @@ svga_buffer_add_range(struct svga_buffer *sbuf, unsigned start, unsigned end)
          MIN2(sbuf->map.ranges[nearest_range].start, start);
       sbuf->map.ranges[nearest_range].end =
          MAX2(sbuf->map.ranges[nearest_range].end, end);
+      svga_buffer_merge_ranges(sbuf, nearest_range);
    }
 }
 
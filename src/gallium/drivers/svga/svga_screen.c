@@ -917,6 +917,9 @@ svga_destroy_screen( struct pipe_screen *screen )
    
    svga_screen_cache_cleanup(svgascreen);
 
+   if (svgascreen->disk_cache)
+      disk_cache_destroy(svgascreen->disk_cache);
+
    pipe_mutex_destroy(svgascreen->swc_mutex);
    pipe_mutex_destroy(svgascreen->tex_mutex);
 
@@ -1107,6 +1110,9 @@ svga_screen_create(struct svga_winsys_screen *sws)
 
    svga_screen_cache_init(svgascreen);
 
+   if (sws->have_vgpu10)
+      svgascreen->disk_cache = disk_cache_create();
+
    return screen;
 error2:
    FREE(svgascreen);
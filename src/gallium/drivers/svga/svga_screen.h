@@ -29,6 +29,7 @@
 
 #include "pipe/p_screen.h"
 #include "os/os_thread.h"
+#include "util/disk_cache.h"
 
 #include "svga_screen_cache.h"
 
@@ -81,6 +82,9 @@ struct svga_screen
 
    struct svga_host_surface_cache cache;
 
+   /** On-disk cache of VGPU10 shader translations */
+   struct disk_cache *disk_cache;
+
    /** HUD counters */
    struct {
       /** Memory used by all resources (buffers and surfaces) */
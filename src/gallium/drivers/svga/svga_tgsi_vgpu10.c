@@ -48,14 +48,17 @@
 #include "util/u_bitmask.h"
 #include "util/u_debug.h"
 #include "util/u_pstipple.h"
+#include "util/mesa-sha1.h"
 
 #include "svga_context.h"
 #include "svga_debug.h"
 #include "svga_link.h"
+#include "svga_screen.h"
 #include "svga_shader.h"
 #include "svga_tgsi.h"
 
 #include "VGPU10ShaderTokens.h"
+#include "git_sha1.h"
 
 
 #define INVALID_INDEX 99999
@@ -6693,6 +6696,142 @@ transform_fs_aapoint(const struct tgsi_token *tokens,
    return tokens;
 }
 
+/**
+ * Header of the translations stored in the disk cache, followed by the
+ * VGPU10 tokens.
+ */
+struct svga_vgpu10_cache_header
+{
+   unsigned nr_tokens;
+   unsigned extra_const_start;
+   unsigned pstipple_sampler_unit;
+   boolean constant_color_output;
+   boolean uses_flat_interp;
+};
+
+
+/**
+ * Compute the disk cache key of a translation.  Once the emitter is set
+ * up, the emitted code only depends on the (transformed) TGSI tokens, the
+ * compile key, the linkage with the previous stage and whether there is
+ * stream output.
+ */
+static boolean
+compute_cache_key(const struct svga_shader_emitter_v10 *emit,
+                  const struct svga_shader *shader,
+                  const struct tgsi_token *tokens,
+                  cache_key key)
+{
+   static const char build_id[] =
+#ifdef PACKAGE_VERSION
+      PACKAGE_VERSION
+#endif
+#ifdef MESA_GIT_SHA1
+      MESA_GIT_SHA1
+#endif
+      "";
+   const boolean has_so = shader->stream_output != NULL;
+   struct mesa_sha1 *sha1;
+
+   sha1 = _mesa_sha1_init();
+   if (!sha1)
+      return FALSE;
+
+   _mesa_sha1_update(sha1, build_id, sizeof(build_id));
+   _mesa_sha1_update(sha1, &emit->unit, sizeof(emit->unit));
+   _mesa_sha1_update(sha1, &emit->key, sizeof(emit->key));
+   _mesa_sha1_update(sha1, &emit->linkage, sizeof(emit->linkage));
+   _mesa_sha1_update(sha1, &has_so, sizeof(has_so));
+   _mesa_sha1_update(sha1, tokens,
+                     tgsi_num_tokens(tokens) * sizeof(struct tgsi_token));
+   _mesa_sha1_final(sha1, key);
+   return TRUE;
+}
+
+
+/**
+ * Create a variant from a translation found in the disk cache.
+ */
+static struct svga_shader_variant *
+load_cached_variant(struct svga_context *svga,
+                    const struct svga_shader *shader,
+                    const struct svga_compile_key *key,
+                    cache_key hash)
+{
+   struct disk_cache *cache = svga_screen(svga->pipe.screen)->disk_cache;
+   struct svga_vgpu10_cache_header hdr;
+   struct svga_shader_variant *variant = NULL;
+   unsigned *tokens = NULL;
+   uint8_t *data;
+   size_t size;
+
+   data = disk_cache_get(cache, hash, &size);
+   if (!data)
+      return NULL;
+
+   if (size >= sizeof(hdr)) {
+      memcpy(&hdr, data, sizeof(hdr));
+      if (hdr.nr_tokens &&
+          size == sizeof(hdr) + hdr.nr_tokens * sizeof(unsigned))
+         tokens = MALLOC(hdr.nr_tokens * sizeof(unsigned));
+   }
+
+   if (tokens)
+      variant = svga_new_shader_variant(svga);
+
+   if (variant) {
+      memcpy(tokens, data + sizeof(hdr), hdr.nr_tokens * sizeof(unsigned));
+      variant->shader = shader;
+      variant->nr_tokens = hdr.nr_tokens;
+      variant->tokens = tokens;
+      memcpy(&variant->key, key, sizeof(*key));
+      variant->id = UTIL_BITMASK_INVALID_INDEX;
+      variant->extra_const_start = hdr.extra_const_start;
+      variant->pstipple_sampler_unit = hdr.pstipple_sampler_unit;
+      variant->constant_color_output = hdr.constant_color_output;
+      variant->uses_flat_interp = hdr.uses_flat_interp;
+   }
+   else {
+      FREE(tokens);
+   }
+
+   free(data);
+   return variant;
+}
+
+
+/**
+ * Store a new translation in the disk cache.
+ */
+static void
+store_variant(struct svga_context *svga,
+              const struct svga_shader_variant *variant,
+              cache_key hash)
+{
+   struct disk_cache *cache = svga_screen(svga->pipe.screen)->disk_cache;
+   struct svga_vgpu10_cache_header hdr;
+   size_t size = sizeof(hdr) + variant->nr_tokens * sizeof(unsigned);
+   uint8_t *data;
+
+   data = MALLOC(size);
+   if (!data)
+      return;
+
+   memset(&hdr, 0, sizeof(hdr));
+   hdr.nr_tokens = variant->nr_tokens;
+   hdr.extra_const_start = variant->extra_const_start;
+   hdr.pstipple_sampler_unit = variant->pstipple_sampler_unit;
+   hdr.constant_color_output = variant->constant_color_output;
+   hdr.uses_flat_interp = variant->uses_flat_interp;
+   memcpy(data, &hdr, sizeof(hdr));
+   memcpy(data + sizeof(hdr), variant->tokens,
+          variant->nr_tokens * sizeof(unsigned));
+
+   disk_cache_put(cache, hash, data, size);
+   FREE(data);
+}
+
+
 /**
  * This is the main entrypoint for the TGSI -> VPGU10 translator.
  */
@@ -6707,6 +6846,10 @@ svga_tgsi_vgpu10_translate(struct svga_context *svga,
    const struct tgsi_token *tokens = shader->tokens;
    struct svga_vertex_shader *vs = svga->curr.vs;
    struct svga_geometry_shader *gs = svga->curr.gs;
+   /* Debug output is only produced when translating */
+   boolean use_cache =
+      svga_screen(svga->pipe.screen)->disk_cache && !SVGA_DEBUG;
+   cache_key hash;
 
    assert(unit == PIPE_SHADER_VERTEX ||
           unit == PIPE_SHADER_GEOMETRY ||
@@ -6815,6 +6958,14 @@ svga_tgsi_vgpu10_translate(struct svga_context *svga,
       }
    }
 
+   if (use_cache)
+      use_cache = compute_cache_key(emit, shader, tokens, hash);
+   if (use_cache) {
+      variant = load_cached_variant(svga, shader, key, hash);
+      if (variant)
+         goto free_tokens;
+   }
+
    /*
     * Do actual shader translation.
     */
@@ -6879,6 +7030,10 @@ svga_tgsi_vgpu10_translate(struct svga_context *svga,
     */
    variant->uses_flat_interp = emit->uses_flat_interp;
 
+   if (use_cache)
+      store_variant(svga, variant, hash);
+
+free_tokens:
    if (tokens != shader->tokens) {
       tgsi_free_tokens(tokens);
    }
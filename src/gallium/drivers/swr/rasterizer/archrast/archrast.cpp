@@ -26,6 +26,10 @@
 *
 ******************************************************************************/
 #include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <sstream>
 
 #include "common/os.h"
 #include "archrast/archrast.h"
@@ -320,6 +324,113 @@ namespace ArchRast
         }
     };
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Event handler that writes Start/End spans in the Chrome trace
+    ///        event (JSON array) format, which chrome://tracing and Perfetto
+    ///        load directly. All thread contexts of the process append to the
+    ///        same file so FE/BE work on every worker shows up on one timeline.
+    class EventHandlerTraceFile : public EventHandler
+    {
+    public:
+        EventHandlerTraceFile(uint32_t id) : mId(id) {}
+
+        virtual ~EventHandlerTraceFile()
+        {
+            FlushBuffer();
+        }
+
+        virtual void Handle(ThreadStartApiEvent event)
+        {
+            WriteThreadName("API");
+        }
+
+        virtual void Handle(ThreadStartWorkerEvent event)
+        {
+            WriteThreadName("Worker");
+        }
+
+        virtual void Handle(Start event)
+        {
+            mBuffer << "{\"name\":\"" << ToString(event.data.type) << "\",\"ph\":\"B\",\"ts\":" << Timestamp()
+                    << ",\"pid\":" << GetCurrentProcessId() << ",\"tid\":" << mId
+                    << ",\"args\":{\"id\":" << event.data.id << "}},\n";
+            CheckFlush();
+        }
+
+        virtual void Handle(End event)
+        {
+            mBuffer << "{\"name\":\"" << ToString(event.data.type) << "\",\"ph\":\"E\",\"ts\":" << Timestamp()
+                    << ",\"pid\":" << GetCurrentProcessId() << ",\"tid\":" << mId
+                    << ",\"args\":{\"count\":" << event.data.count << "}},\n";
+            CheckFlush();
+        }
+
+    private:
+        void WriteThreadName(const char* pType)
+        {
+            mBuffer << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << GetCurrentProcessId()
+                    << ",\"tid\":" << mId << ",\"args\":{\"name\":\"" << pType << " " << mId << "\"}},\n";
+        }
+
+        // Microseconds since the first trace event of the process.
+        static double Timestamp()
+        {
+            static const auto sEpoch = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sEpoch).count();
+        }
+
+        void CheckFlush()
+        {
+            if (mBuffer.tellp() > (std::streamoff)mFlushSize)
+            {
+                FlushBuffer();
+            }
+        }
+
+        void FlushBuffer()
+        {
+            static std::mutex sFileLock;
+            static std::ofstream sFile;
+
+            std::string events = mBuffer.str();
+            if (events.empty())
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(sFileLock);
+            if (!sFile.is_open())
+            {
+                char buf[255];
+#if defined(_WIN32)
+                CreateDirectory(KNOB_DEBUG_OUTPUT_DIR.c_str(), NULL);
+                sprintf(buf, "%s\\ar_trace%d.json", KNOB_DEBUG_OUTPUT_DIR.c_str(), GetCurrentProcessId());
+#else
+                sprintf(buf, "%s/ar_trace%d.json", "/tmp", GetCurrentProcessId());
+#endif
+                sFile.open(buf, std::ios::out | std::ios::trunc);
+                if (!sFile.is_open())
+                {
+                    SWR_ASSERT(0, "ArchRast: Could not open trace file!");
+                    return;
+                }
+
+                // The closing bracket is optional in the trace event format, which lets
+                // every thread context append independently until the process exits.
+                sFile << "[\n";
+            }
+
+            sFile << events;
+            sFile.flush();
+            mBuffer.str(std::string());
+        }
+
+        static const uint32_t mFlushSize = 64 * 1024;
+
+        uint32_t mId;
+        std::stringstream mBuffer;
+    };
+
     static EventManager* FromHandle(HANDLE hThreadContext)
     {
         return reinterpret_cast<EventManager*>(hThreadContext);
@@ -339,6 +450,21 @@ namespace ArchRast
         {
             pManager->Attach(pHandler);
 
+            if (KNOB_AR_TRACE)
+            {
+                EventHandler* pTraceHandler = new EventHandlerTraceFile(id);
+                pManager->Attach(pTraceHandler);
+
+                if (type == AR_THREAD::API)
+                {
+                    pTraceHandler->Handle(ThreadStartApiEvent());
+                }
+                else
+                {
+                    pTraceHandler->Handle(ThreadStartWorkerEvent());
+                }
+            }
+
             if (type == AR_THREAD::API)
             {
                 pHandler->Handle(ThreadStartApiEvent());
@@ -57,6 +57,12 @@ static INLINE SWR_CONTEXT* GetContext(HANDLE hContext)
 
 void WakeAllThreads(SWR_CONTEXT *pContext)
 {
+    if (pContext->pSharedPool)
+    {
+        pContext->pSharedPool->workAvailable.notify_all();
+        return;
+    }
+
     pContext->FifosNotEmpty.notify_all();
 }
 
@@ -95,6 +101,8 @@ HANDLE SwrCreateContext(
     pContext->threadInfo.MAX_CORES_PER_NUMA_NODE   = KNOB_MAX_CORES_PER_NUMA_NODE;
     pContext->threadInfo.MAX_THREADS_PER_CORE      = KNOB_MAX_THREADS_PER_CORE;
     pContext->threadInfo.SINGLE_THREADED           = KNOB_SINGLE_THREADED;
+    pContext->threadInfo.SHARED_THREAD_POOL        = KNOB_SHARED_THREAD_POOL;
+    pContext->threadInfo.SCHEDULING_WEIGHT         = KNOB_CONTEXT_SCHEDULING_WEIGHT;
 
     if (pCreateInfo->pThreadInfo)
     {
@@ -196,9 +204,19 @@ void QueueWork(SWR_CONTEXT *pContext)
         InterlockedIncrement((volatile LONG*)&pContext->drawsOutstandingFE);
     }
 
+    // Track the submit cadence for the worker wait policy.
+    uint64_t submitTsc = __rdtsc();
+    if (pContext->lastSubmitTsc != 0)
+    {
+        uint64_t interval = submitTsc - pContext->lastSubmitTsc;
+        pContext->submitIntervalTsc = pContext->submitIntervalTsc - (pContext->submitIntervalTsc >> 3) + (interval >> 3);
+    }
+    pContext->lastSubmitTsc = submitTsc;
+
     _ReadWriteBarrier();
     {
-        std::unique_lock<std::mutex> lock(pContext->WaitLock);
+        // Shared pool workers check for work under the pool lock before sleeping.
+        std::unique_lock<std::mutex> lock(pContext->pSharedPool ? pContext->pSharedPool->lock : pContext->WaitLock);
         pContext->dcRing.Enqueue();
     }
 
@@ -932,6 +950,19 @@ void SetupPipeline(DRAW_CONTEXT *pDC)
                                           (pState->state.depthStencilState.stencilTestEnable  ||
                                            pState->state.depthStencilState.stencilWriteEnable)) ? true : false;
 
+    // per raster tile depth culling is only safe when failing the depth test has no
+    // side effects: no stencil updates, no shader computed depth and no UAV writes
+    // from a pixel shader that runs ahead of a late depth test
+    pState->state.hiZCullEnable = (KNOB_HIZ_CULL &&
+                                   pState->state.depthHottileEnable &&
+                                   pState->state.depthStencilState.depthTestEnable &&
+                                   (pState->state.depthStencilState.depthTestFunc == ZFUNC_LT ||
+                                    pState->state.depthStencilState.depthTestFunc == ZFUNC_LE) &&
+                                   !pState->state.stencilHottileEnable &&
+                                   !pState->state.rastState.conservativeRast &&
+                                   !pState->state.psState.writesODepth &&
+                                   (!pState->state.psState.usesUAV || pState->state.psState.forceEarlyZ)) ? true : false;
+
     uint32_t numRTs = pState->state.psState.numRenderTargets;
     pState->state.colorHottileEnable = 0;
     if (psState.pfnPixelShader != nullptr)
@@ -983,6 +1014,67 @@ void InitDraw(
 
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Stream output of list topologies without GS or tessellation writes
+///        a fixed number of prims per vertex, so draws can be split and each
+///        part can stream out in parallel to offsets computed up front.
+/// @param topology - Topology used for draw
+static bool CanSplitStreamOut(
+    const API_STATE& state,
+    PRIMITIVE_TOPOLOGY topology)
+{
+    if (state.gsState.gsEnable || state.tsState.tsEnable ||
+        state.frontendState.bEnableCutIndex)
+    {
+        return false;
+    }
+
+    switch (topology)
+    {
+    case TOP_POINT_LIST:
+    case TOP_LINE_LIST:
+    case TOP_TRIANGLE_LIST:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Allocates the state shared by the parts of a draw whose stream
+///        output is split, or returns nullptr if the draw isn't split.
+/// @param numVerts - Vertices (or indices) per instance
+/// @param maxVertsPerDraw - Vertices (or indices) per split draw
+/// @param numInstances - Total instances for draw
+/// @param maxInstancesPerDraw - Instances per split draw
+static SO_SPLIT_STATE* CreateSoSplitState(
+    DRAW_CONTEXT* pDC,
+    uint32_t numVerts,
+    uint32_t maxVertsPerDraw,
+    uint32_t numInstances,
+    uint32_t maxInstancesPerDraw)
+{
+    const API_STATE& state = pDC->pState->state;
+
+    if (!state.soState.soEnable ||
+        (numVerts <= maxVertsPerDraw && numInstances <= maxInstancesPerDraw))
+    {
+        return nullptr;
+    }
+
+    uint32_t numDraws = ((numVerts + maxVertsPerDraw - 1) / maxVertsPerDraw) *
+                        ((numInstances + maxInstancesPerDraw - 1) / maxInstancesPerDraw);
+
+    SO_SPLIT_STATE* pSoSplit = (SO_SPLIT_STATE*)pDC->pState->pArena->AllocAligned(sizeof(SO_SPLIT_STATE), 64);
+    for (uint32_t i = 0; i < MAX_SO_BUFFERS; ++i)
+    {
+        pSoSplit->streamOffset[i] = state.soBuffer[i].streamOffset;
+    }
+    pSoSplit->numDrawsLeft = numDraws;
+
+    return pSoSplit;
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief We can split the draw for certain topologies for better performance.
 /// @param totalVerts - Total vertices for draw
@@ -996,7 +1088,7 @@ uint32_t MaxVertsPerDraw(
 
     uint32_t vertsPerDraw = totalVerts;
 
-    if (state.soState.soEnable)
+    if (state.soState.soEnable && !CanSplitStreamOut(state, topology))
     {
         return totalVerts;
     }
@@ -1060,6 +1152,31 @@ uint32_t MaxVertsPerDraw(
     return vertsPerDraw;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Instanced draws are split into ranges of instances so that the
+///        frontend of a draw with many small instances isn't serialized
+///        on one worker. The backend still processes the draws in order.
+/// @param vertsPerInstance - Vertices (or indices) per instance
+/// @param numInstances - Total instances for draw
+uint32_t MaxInstancesPerDraw(
+    DRAW_CONTEXT* pDC,
+    uint32_t vertsPerInstance,
+    uint32_t numInstances,
+    PRIMITIVE_TOPOLOGY topology)
+{
+    API_STATE& state = pDC->pState->state;
+
+    // Streamout has to be written in instance order.
+    if (!KNOB_SPLIT_INSTANCED_DRAWS || vertsPerInstance == 0 ||
+        (state.soState.soEnable && !CanSplitStreamOut(state, topology)))
+    {
+        return numInstances;
+    }
+
+    uint32_t instancesPerDraw = std::max(KNOB_MAX_PRIMS_PER_DRAW / vertsPerInstance, 1u);
+    return std::min(instancesPerDraw, numInstances);
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 /// @brief DrawInstanced
@@ -1090,7 +1207,10 @@ void DrawInstanced(
 
     uint32_t maxVertsPerDraw = MaxVertsPerDraw(pDC, numVertices, topology);
     uint32_t primsPerDraw = GetNumPrims(topology, maxVertsPerDraw);
-    uint32_t remainingVerts = numVertices;
+    uint32_t maxInstancesPerDraw = MaxInstancesPerDraw(pDC, numVertices, numInstances, topology);
+    uint32_t primsPerInstance = GetNumPrims(topology, numVertices);
+    SO_SPLIT_STATE* pSoSplit = CreateSoSplitState(pDC, numVertices, maxVertsPerDraw,
+                                                  numInstances, maxInstancesPerDraw);
 
     API_STATE    *pState = &pDC->pState->state;
     pState->topology = topology;
@@ -1110,37 +1230,48 @@ void DrawInstanced(
 
 
     int draw = 0;
-    while (remainingVerts)
+    for (uint32_t instance = 0; instance < numInstances; instance += maxInstancesPerDraw)
     {
-        uint32_t numVertsForDraw = (remainingVerts < maxVertsPerDraw) ?
-        remainingVerts : maxVertsPerDraw;
-
-        bool isSplitDraw = (draw > 0) ? true : false;
-        DRAW_CONTEXT* pDC = GetDrawContext(pContext, isSplitDraw);
-        InitDraw(pDC, isSplitDraw);
-
-        pDC->FeWork.type = DRAW;
-        pDC->FeWork.pfnWork = GetProcessDrawFunc(
-            false,  // IsIndexed
-            false, // bEnableCutIndex
-            pState->tsState.tsEnable,
-            pState->gsState.gsEnable,
-            pState->soState.soEnable,
-            pDC->pState->pfnProcessPrims != nullptr);
-        pDC->FeWork.desc.draw.numVerts = numVertsForDraw;
-        pDC->FeWork.desc.draw.startVertex = startVertex;
-        pDC->FeWork.desc.draw.numInstances = numInstances;
-        pDC->FeWork.desc.draw.startInstance = startInstance;
-        pDC->FeWork.desc.draw.startPrimID = draw * primsPerDraw;
-        pDC->FeWork.desc.draw.startVertexID = draw * maxVertsPerDraw;
-
-        pDC->cleanupState = (remainingVerts == numVertsForDraw);
-
-        //enqueue DC
-        QueueDraw(pContext);
-
-        remainingVerts -= numVertsForDraw;
-        draw++;
+        uint32_t numInstancesForDraw = std::min(numInstances - instance, maxInstancesPerDraw);
+        uint32_t split = 0;
+        uint32_t remainingVerts = numVertices;
+        while (remainingVerts)
+        {
+            uint32_t numVertsForDraw = (remainingVerts < maxVertsPerDraw) ?
+            remainingVerts : maxVertsPerDraw;
+
+            bool isSplitDraw = (draw > 0) ? true : false;
+            DRAW_CONTEXT* pDC = GetDrawContext(pContext, isSplitDraw);
+            InitDraw(pDC, isSplitDraw);
+
+            pDC->FeWork.type = DRAW;
+            pDC->FeWork.pfnWork = GetProcessDrawFunc(
+                false,  // IsIndexed
+                false, // bEnableCutIndex
+                pState->tsState.tsEnable,
+                pState->gsState.gsEnable,
+                pState->soState.soEnable,
+                pDC->pState->pfnProcessPrims != nullptr);
+            pDC->FeWork.desc.draw.numVerts = numVertsForDraw;
+            pDC->FeWork.desc.draw.startVertex = startVertex;
+            pDC->FeWork.desc.draw.numInstances = numInstancesForDraw;
+            pDC->FeWork.desc.draw.startInstance = startInstance;
+            pDC->FeWork.desc.draw.startInstanceID = instance;
+            pDC->FeWork.desc.draw.startPrimID = split * primsPerDraw;
+            pDC->FeWork.desc.draw.startVertexID = split * maxVertsPerDraw;
+            pDC->FeWork.desc.draw.pSoSplit = pSoSplit;
+            pDC->FeWork.desc.draw.soStartPrim = instance * primsPerInstance + split * primsPerDraw;
+
+            pDC->cleanupState = (remainingVerts == numVertsForDraw) &&
+                                (instance + numInstancesForDraw == numInstances);
+
+            //enqueue DC
+            QueueDraw(pContext);
+
+            remainingVerts -= numVertsForDraw;
+            split++;
+            draw++;
+        }
     }
 
     // restore culling state
@@ -1218,7 +1349,10 @@ void DrawIndexedInstance(
 
     uint32_t maxIndicesPerDraw = MaxVertsPerDraw(pDC, numIndices, topology);
     uint32_t primsPerDraw = GetNumPrims(topology, maxIndicesPerDraw);
-    uint32_t remainingIndices = numIndices;
+    uint32_t maxInstancesPerDraw = MaxInstancesPerDraw(pDC, numIndices, numInstances, topology);
+    uint32_t primsPerInstance = GetNumPrims(topology, numIndices);
+    SO_SPLIT_STATE* pSoSplit = CreateSoSplitState(pDC, numIndices, maxIndicesPerDraw,
+                                                  numInstances, maxInstancesPerDraw);
 
     uint32_t indexSize = 0;
     switch (pState->indexBuffer.format)
@@ -1231,8 +1365,8 @@ void DrawIndexedInstance(
     }
 
     int draw = 0;
-    uint8_t *pIB = (uint8_t*)pState->indexBuffer.pIndices;
-    pIB += (uint64_t)indexOffset * (uint64_t)indexSize;
+    uint8_t *pFirstIndex = (uint8_t*)pState->indexBuffer.pIndices;
+    pFirstIndex += (uint64_t)indexOffset * (uint64_t)indexSize;
 
     pState->topology = topology;
     pState->forceFront = false;
@@ -1250,43 +1384,55 @@ void DrawIndexedInstance(
     }
 
 
-    while (remainingIndices)
+    for (uint32_t instance = 0; instance < numInstances; instance += maxInstancesPerDraw)
     {
-        uint32_t numIndicesForDraw = (remainingIndices < maxIndicesPerDraw) ?
-        remainingIndices : maxIndicesPerDraw;
-
-        // When breaking up draw, we need to obtain new draw context for each iteration.
-        bool isSplitDraw = (draw > 0) ? true : false;
-
-        pDC = GetDrawContext(pContext, isSplitDraw);
-        InitDraw(pDC, isSplitDraw);
-
-        pDC->FeWork.type = DRAW;
-        pDC->FeWork.pfnWork = GetProcessDrawFunc(
-            true,   // IsIndexed
-            pState->frontendState.bEnableCutIndex,
-            pState->tsState.tsEnable,
-            pState->gsState.gsEnable,
-            pState->soState.soEnable,
-            pDC->pState->pfnProcessPrims != nullptr);
-        pDC->FeWork.desc.draw.pDC = pDC;
-        pDC->FeWork.desc.draw.numIndices = numIndicesForDraw;
-        pDC->FeWork.desc.draw.pIB = (int*)pIB;
-        pDC->FeWork.desc.draw.type = pDC->pState->state.indexBuffer.format;
-
-        pDC->FeWork.desc.draw.numInstances = numInstances;
-        pDC->FeWork.desc.draw.startInstance = startInstance;
-        pDC->FeWork.desc.draw.baseVertex = baseVertex;
-        pDC->FeWork.desc.draw.startPrimID = draw * primsPerDraw;
-
-        pDC->cleanupState = (remainingIndices == numIndicesForDraw);
-
-        //enqueue DC
-        QueueDraw(pContext);
-
-        pIB += maxIndicesPerDraw * indexSize;
-        remainingIndices -= numIndicesForDraw;
-        draw++;
+        uint32_t numInstancesForDraw = std::min(numInstances - instance, maxInstancesPerDraw);
+        uint32_t split = 0;
+        uint32_t remainingIndices = numIndices;
+        uint8_t *pIB = pFirstIndex;
+        while (remainingIndices)
+        {
+            uint32_t numIndicesForDraw = (remainingIndices < maxIndicesPerDraw) ?
+            remainingIndices : maxIndicesPerDraw;
+
+            // When breaking up draw, we need to obtain new draw context for each iteration.
+            bool isSplitDraw = (draw > 0) ? true : false;
+
+            pDC = GetDrawContext(pContext, isSplitDraw);
+            InitDraw(pDC, isSplitDraw);
+
+            pDC->FeWork.type = DRAW;
+            pDC->FeWork.pfnWork = GetProcessDrawFunc(
+                true,   // IsIndexed
+                pState->frontendState.bEnableCutIndex,
+                pState->tsState.tsEnable,
+                pState->gsState.gsEnable,
+                pState->soState.soEnable,
+                pDC->pState->pfnProcessPrims != nullptr);
+            pDC->FeWork.desc.draw.pDC = pDC;
+            pDC->FeWork.desc.draw.numIndices = numIndicesForDraw;
+            pDC->FeWork.desc.draw.pIB = (int*)pIB;
+            pDC->FeWork.desc.draw.type = pDC->pState->state.indexBuffer.format;
+
+            pDC->FeWork.desc.draw.numInstances = numInstancesForDraw;
+            pDC->FeWork.desc.draw.startInstance = startInstance;
+            pDC->FeWork.desc.draw.startInstanceID = instance;
+            pDC->FeWork.desc.draw.baseVertex = baseVertex;
+            pDC->FeWork.desc.draw.startPrimID = split * primsPerDraw;
+            pDC->FeWork.desc.draw.pSoSplit = pSoSplit;
+            pDC->FeWork.desc.draw.soStartPrim = instance * primsPerInstance + split * primsPerDraw;
+
+            pDC->cleanupState = (remainingIndices == numIndicesForDraw) &&
+                                (instance + numInstancesForDraw == numInstances);
+
+            //enqueue DC
+            QueueDraw(pContext);
+
+            pIB += maxIndicesPerDraw * indexSize;
+            remainingIndices -= numIndicesForDraw;
+            split++;
+            draw++;
+        }
     }
 
     // Restore culling state
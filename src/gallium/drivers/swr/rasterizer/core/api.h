@@ -139,7 +139,9 @@ typedef void(SWR_API *PFN_STORE_TILE)(HANDLE hPrivateContext, SWR_FORMAT srcForm
 /// @param y - destination y coordinate
 /// @param renderTargetArrayIndex - render target array offset from arrayIndex
 /// @param pClearColor - pointer to the hot tile's clear value
-typedef void(SWR_API *PFN_CLEAR_TILE)(HANDLE hPrivateContext,
+/// @return true if the clear was written to the surface, false if the surface
+///         isn't supported and the hot tile has to be cleared and stored instead.
+typedef bool(SWR_API *PFN_CLEAR_TILE)(HANDLE hPrivateContext,
     SWR_RENDERTARGET_ATTACHMENT rtIndex,
     uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex, const float* pClearColor);
 
@@ -181,11 +183,13 @@ class BucketManager;
 /////////////////////////////////////////////////////////////////////////
 struct SWR_THREADING_INFO
 {
-    uint32_t    MAX_WORKER_THREADS;
+    uint32_t    MAX_WORKER_THREADS;     // With SHARED_THREAD_POOL: max pool workers used by this context
     uint32_t    MAX_NUMA_NODES;
     uint32_t    MAX_CORES_PER_NUMA_NODE;
     uint32_t    MAX_THREADS_PER_CORE;
     bool        SINGLE_THREADED;
+    bool        SHARED_THREAD_POOL;     // Run on the process-wide worker pool instead of private threads
+    uint32_t    SCHEDULING_WEIGHT;      // Shared pool work rounds per scheduling pass for this context
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -43,6 +43,7 @@ struct ArenaBlock
 {
     size_t      blockSize = 0;
     ArenaBlock* pNext = nullptr;
+    uint32_t    numaNode = 0;       // NUMA node of the cache that owns this block
 };
 static_assert(sizeof(ArenaBlock) <= ARENA_BLOCK_ALIGN,
     "Increase BLOCK_ALIGN size");
@@ -362,7 +363,55 @@ private:
     size_t                  m_cachedSize = 0;
     size_t                  m_oldCachedSize = 0;
 };
+
+// NUMA node of the calling thread. Worker threads set this once they are bound
+// to a HW thread. All other threads (i.e. API thread) use node 0.
+extern THREAD uint32_t tlsArenaNumaNode;
+
+// Caching Allocator for Arena with a separate block cache per NUMA node.
+// Blocks are handed out from the cache of the NUMA node of the calling thread
+// and are always returned to the cache they came from, even when another
+// thread frees them. Since the thread that allocates a block is the first to
+// write to it, the OS first-touch policy places fresh blocks on that node and
+// the per-node caches keep recycled blocks from migrating between nodes.
+template<uint32_t MaxNumaNodesT = 8, typename CachingAllocT = CachingAllocatorT<>>
+struct NumaCachingAllocatorT
+{
+    ArenaBlock* AllocateAligned(size_t size, size_t align)
+    {
+        uint32_t numaNode = std::min<uint32_t>(tlsArenaNumaNode, MaxNumaNodesT - 1);
+
+        ArenaBlock* pBlock = m_allocators[numaNode].AllocateAligned(size, align);
+        if (pBlock)
+        {
+            pBlock->numaNode = numaNode;
+        }
+
+        return pBlock;
+    }
+
+    void Free(ArenaBlock* pMem)
+    {
+        if (pMem)
+        {
+            SWR_ASSUME_ASSERT(pMem->numaNode < MaxNumaNodesT);
+            m_allocators[pMem->numaNode].Free(pMem);
+        }
+    }
+
+    void FreeOldBlocks()
+    {
+        for (uint32_t i = 0; i < MaxNumaNodesT; ++i)
+        {
+            m_allocators[i].FreeOldBlocks();
+        }
+    }
+
+private:
+    CachingAllocT           m_allocators[MaxNumaNodesT];
+};
 typedef CachingAllocatorT<> CachingAllocator;
+typedef NumaCachingAllocatorT<> NumaCachingAllocator;
 
 template<typename T = DefaultAllocator, size_t BlockSizeT = 128 * sizeof(KILOBYTE)>
 class TArena
@@ -489,4 +538,4 @@ private:
 };
 
 using StdArena      = TArena<DefaultAllocator>;
-using CachingArena  = TArena<CachingAllocator>;
+using CachingArena  = TArena<NumaCachingAllocator>;
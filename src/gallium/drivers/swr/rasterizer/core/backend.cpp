@@ -227,11 +227,27 @@ INLINE void ClearMacroTile(DRAW_CONTEXT *pDC, SWR_RENDERTARGET_ATTACHMENT rt, ui
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns true if the rect covers the whole macro tile.
+static INLINE bool RectCoversMacroTile(const SWR_RECT& rect, uint32_t macroTile)
+{
+    uint32_t x, y;
+    MacroTileMgr::getTileIndices(macroTile, x, y);
+
+    int32_t xmin = x * KNOB_MACROTILE_X_DIM;
+    int32_t ymin = y * KNOB_MACROTILE_Y_DIM;
+
+    return rect.xmin <= xmin && rect.xmax >= xmin + KNOB_MACROTILE_X_DIM &&
+           rect.ymin <= ymin && rect.ymax >= ymin + KNOB_MACROTILE_Y_DIM;
+}
+
 void ProcessClearBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, void *pUserData)
 {
     SWR_CONTEXT *pContext = pDC->pContext;
 
-    if (KNOB_FAST_CLEAR)
+    // Deferring the clear writes the clear value to the whole hot tile, so tiles
+    // the clear rect only partially covers have to be cleared right away.
+    if (KNOB_FAST_CLEAR && RectCoversMacroTile(((CLEAR_DESC*)pUserData)->rect, macroTile))
     {
         CLEAR_DESC *pClear = (CLEAR_DESC*)pUserData;
         SWR_MULTISAMPLE_COUNT sampleCount = pDC->pState->state.rastState.sampleCount;
@@ -312,6 +328,13 @@ void ProcessClearBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile, vo
             SWR_ASSERT(pfnClearTiles != nullptr);
 
             pfnClearTiles(pDC, SWR_ATTACHMENT_DEPTH, macroTile, pClear->renderTargetArrayIndex, clearData, pClear->rect);
+
+            // the clear rect may only cover part of the tile
+            HOTTILE *pHotTile = pContext->pHotTileMgr->GetHotTileNoLoad(pContext, pDC, macroTile, SWR_ATTACHMENT_DEPTH, false);
+            if (pHotTile)
+            {
+                HotTileMgr::UpdateDepthHotTileMaxZ(pHotTile);
+            }
         }
 
         if (pClear->attachmentMask & SWR_ATTACHMENT_STENCIL_BIT)
@@ -357,6 +380,32 @@ void ProcessStoreTileBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile
     HOTTILE *pHotTile = pContext->pHotTileMgr->GetHotTileNoLoad(pContext, pDC, macroTile, attachment, false);
     if (pHotTile)
     {
+        // A pending clear that was never rendered to is written straight to the surface
+        // in its format. The hot tile stays in the clear state, so it is still only
+        // materialized if a later draw touches it.
+        if (pHotTile->state == HOTTILE_CLEAR && pContext->pfnClearTile && pHotTile->numSamples == 1)
+        {
+            int32_t destX = KNOB_MACROTILE_X_DIM * x;
+            int32_t destY = KNOB_MACROTILE_Y_DIM * y;
+
+            if (pContext->pfnClearTile(GetPrivateState(pDC), attachment, destX, destY,
+                pHotTile->renderTargetArrayIndex, (const float*)pHotTile->clearData))
+            {
+                if (pDesc->postStoreTileState == SWR_TILE_INVALID)
+                {
+                    pHotTile->state = HOTTILE_INVALID;
+                }
+
+                if (KNOB_HOT_TILE_RELEASE_ON_STORE)
+                {
+                    pContext->pHotTileMgr->ReleaseHotTile(pHotTile);
+                }
+
+                AR_END(BEStoreTiles, 1);
+                return;
+            }
+        }
+
         // clear if clear is pending (i.e., not rendered to), then mark as dirty for store.
         if (pHotTile->state == HOTTILE_CLEAR)
         {
@@ -380,6 +429,13 @@ void ProcessStoreTileBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTile
         {
             pHotTile->state = (HOTTILE_STATE)pDesc->postStoreTileState;
         }
+
+        // The surface now holds the tile contents; drop the hot tile memory unless
+        // the caller keeps rendering to it.
+        if (KNOB_HOT_TILE_RELEASE_ON_STORE && pHotTile->state != HOTTILE_DIRTY)
+        {
+            pContext->pHotTileMgr->ReleaseHotTile(pHotTile);
+        }
     }
     AR_END(BEStoreTiles, 1);
 }
@@ -413,6 +469,12 @@ void ProcessDiscardInvalidateTilesBE(DRAW_CONTEXT *pDC, uint32_t workerId, uint3
             if (pHotTile)
             {
                 pHotTile->state = (HOTTILE_STATE)pDesc->newTileState;
+
+                // contents are undefined now, keep the HiZ data consistent with them
+                if (i == SWR_ATTACHMENT_DEPTH && pHotTile->state == HOTTILE_DIRTY)
+                {
+                    HotTileMgr::UpdateDepthHotTileMaxZ(pHotTile);
+                }
             }
         }
     }
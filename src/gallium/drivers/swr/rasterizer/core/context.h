@@ -167,6 +167,13 @@ OSALIGNSIMD(struct) BE_WORK
     } desc;
 };
 
+// Stream output state shared by the draw contexts a draw is split into.
+struct SO_SPLIT_STATE
+{
+    volatile uint32_t streamOffset[MAX_SO_BUFFERS];    // Furthest end of the prims written so far, in dwords
+    volatile uint32_t numDrawsLeft;                     // Draw contexts that haven't finished stream output
+};
+
 struct DRAW_WORK
 {
     DRAW_CONTEXT*   pDC;
@@ -183,9 +190,12 @@ struct DRAW_WORK
     int32_t    baseVertex;
     uint32_t   numInstances;        // Number of instances
     uint32_t   startInstance;       // Instance offset
+    uint32_t   startInstanceID;     // first InstanceID of this draw batch (instanced draw splits)
     uint32_t   startPrimID;         // starting primitiveID for this draw batch
     uint32_t   startVertexID;       // starting VertexID for this draw batch (only needed for non-indexed draws)
     SWR_FORMAT type;                // index buffer type
+    SO_SPLIT_STATE* pSoSplit;       // non-null if stream output of the draw is split across draw contexts
+    uint32_t   soStartPrim;         // index of the first prim this draw batch streams out (split stream output)
 };
 
 typedef void(*PFN_FE_WORK_FUNC)(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t workerId, void* pDesc);
@@ -296,6 +306,7 @@ OSALIGNLINE(struct) API_STATE
         uint32_t colorHottileEnable : 8;        // Bitmask of enabled color hottiles
         uint32_t depthHottileEnable: 1;         // Enable depth buffer hottile
         uint32_t stencilHottileEnable : 1;      // Enable stencil buffer hottile
+        uint32_t hiZCullEnable : 1;             // Enable per raster tile depth culling in the rasterizer
     };
 
     PFN_QUANTIZE_DEPTH      pfnQuantizeDepth;
@@ -374,6 +385,10 @@ struct DRAW_DYNAMIC_STATE
     uint32_t SoWriteOffset[4];
     bool     SoWriteOffsetDirty[4];
 
+    // Stream output buffers of this draw context when the draw's stream
+    // output is split, starting at the offsets of its first prim.
+    SWR_STREAMOUT_BUFFER SoBuffer[MAX_SO_BUFFERS];
+
     SWR_STATS_FE statsFE;   // Only one FE thread per DC.
     SWR_STATS*   pStats;
 };
@@ -471,11 +486,27 @@ struct SWR_CONTEXT
     uint32_t NumBEThreads;
 
     THREAD_POOL threadPool; // Thread pool associated with this context
+
+    // Shared thread pool (threadInfo.SHARED_THREAD_POOL). The workers of this context are
+    // pool workers [sharedPoolBaseWorker, sharedPoolBaseWorker + NumWorkerThreads), modulo
+    // the pool size. workerId used throughout the core is the index within that range.
+    SHARED_THREAD_POOL* pSharedPool;
+    SHARED_WORKER_STATE* pSharedWorkerState;
+    uint32_t sharedPoolBaseWorker;
+    volatile LONG sharedPoolRefs;   // pool workers currently looking at this context
     SWR_THREADING_INFO threadInfo;
 
     std::condition_variable FifosNotEmpty;
     std::mutex WaitLock;
 
+    // Adaptive worker wait policy. The API thread tracks the submit cadence, idle
+    // workers use it to decide how long to spin before sleeping.
+    volatile uint64_t lastSubmitTsc;        // rdtsc of the last queued work item
+    volatile uint64_t submitIntervalTsc;    // running average of ticks between submits
+    volatile uint32_t workerSpinLimit;      // current spin budget, adapted by workers
+    volatile LONG numSpinningWorkers;       // idle workers currently spinning
+    uint32_t maxSpinningWorkers;
+
     uint32_t privateStateSize;
 
     HotTileMgr *pHotTileMgr;
@@ -497,7 +528,7 @@ struct SWR_CONTEXT
 
     volatile int32_t  drawsOutstandingFE;
 
-    CachingAllocator cachingArenaAllocator;
+    NumaCachingAllocator cachingArenaAllocator;
     uint32_t frameCount;
 
     uint32_t lastFrameChecked;
@@ -495,7 +495,8 @@ static void StreamOut(
     PA_STATE& pa,
     uint32_t workerId,
     uint32_t* pPrimData,
-    uint32_t streamIndex)
+    uint32_t streamIndex,
+    SO_SPLIT_STATE* pSoSplit = nullptr)
 {
     SWR_CONTEXT *pContext = pDC->pContext;
 
@@ -511,10 +512,12 @@ static void StreamOut(
 
     SWR_STREAMOUT_CONTEXT soContext = { 0 };
 
-    // Setup buffer state pointers.
+    // Setup buffer state pointers. A split draw streams out to its own copy
+    // of the buffers, and FinishSplitStreamOut updates the write offsets.
+    SWR_STREAMOUT_BUFFER* pSoBuffers = pSoSplit ? pDC->dynState.SoBuffer : state.soBuffer;
     for (uint32_t i = 0; i < 4; ++i)
     {
-        soContext.pBuffer[i] = &state.soBuffer[i];
+        soContext.pBuffer[i] = &pSoBuffers[i];
     }
 
     uint32_t numPrims = pa.NumPrims();
@@ -555,7 +558,7 @@ static void StreamOut(
     }
 
     // Update SO write offset. The driver provides memory for the update.
-    for (uint32_t i = 0; i < 4; ++i)
+    for (uint32_t i = 0; !pSoSplit && i < 4; ++i)
     {
         if (state.soBuffer[i].pWriteOffset)
         {
@@ -575,6 +578,89 @@ static void StreamOut(
     AR_END(FEStreamout, 1);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Sets up the streamout buffers of a part of a split draw, so that
+///        it writes its prims after the prims of the parts before it.
+/// @param pDC - pointer to draw context.
+/// @param work - draw work of this part of the draw.
+static void BeginSplitStreamOut(
+    DRAW_CONTEXT* pDC,
+    const DRAW_WORK& work)
+{
+    // The API state keeps the offsets the draw starts at until all of its
+    // parts are done.
+    const API_STATE& state = GetApiState(pDC);
+    uint32_t soVertsPerPrim = NumVertsPerPrim(state.topology, false);
+
+    for (uint32_t i = 0; i < MAX_SO_BUFFERS; ++i)
+    {
+        pDC->dynState.SoBuffer[i] = state.soBuffer[i];
+        pDC->dynState.SoBuffer[i].streamOffset = state.soBuffer[i].streamOffset +
+            work.soStartPrim * soVertsPerPrim * state.soBuffer[i].pitch;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Merges the write offsets of a part of a split draw. The part that
+///        finishes last reports the write offsets of the whole draw, which
+///        are the furthest offsets written by any part, since the parts
+///        write in draw order.
+/// @param pDC - pointer to draw context.
+/// @param work - draw work of this part of the draw.
+static void FinishSplitStreamOut(
+    DRAW_CONTEXT* pDC,
+    const DRAW_WORK& work)
+{
+    const API_STATE& state = GetApiState(pDC);
+    SO_SPLIT_STATE* pSoSplit = work.pSoSplit;
+    uint32_t soVertsPerPrim = NumVertsPerPrim(state.topology, false);
+
+    for (uint32_t i = 0; i < MAX_SO_BUFFERS; ++i)
+    {
+        // Buffers that weren't written to keep their start offset.
+        uint32_t startOffset = state.soBuffer[i].streamOffset +
+            work.soStartPrim * soVertsPerPrim * state.soBuffer[i].pitch;
+        uint32_t endOffset = pDC->dynState.SoBuffer[i].streamOffset;
+        if (endOffset == startOffset)
+        {
+            continue;
+        }
+
+        uint32_t offset = pSoSplit->streamOffset[i];
+        while (offset < endOffset)
+        {
+            uint32_t prev = InterlockedCompareExchange(&pSoSplit->streamOffset[i], endOffset, offset);
+            if (prev == offset)
+            {
+                break;
+            }
+            offset = prev;
+        }
+    }
+
+    if (InterlockedDecrement((volatile LONG*)&pSoSplit->numDrawsLeft) != 0)
+    {
+        return;
+    }
+
+    // Last part of the draw to finish.
+    for (uint32_t i = 0; i < MAX_SO_BUFFERS; ++i)
+    {
+        state.soBuffer[i].streamOffset = pSoSplit->streamOffset[i];
+
+        if (state.soBuffer[i].pWriteOffset)
+        {
+            *state.soBuffer[i].pWriteOffset = pSoSplit->streamOffset[i] * sizeof(uint32_t);
+        }
+
+        if (state.soBuffer[i].soWriteEnable)
+        {
+            pDC->dynState.SoWriteOffset[i] = pSoSplit->streamOffset[i] * sizeof(uint32_t);
+            pDC->dynState.SoWriteOffsetDirty[i] = true;
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Computes number of invocations. The current index represents
 ///        the start of the SIMD. The max index represents how much work
@@ -636,6 +722,127 @@ void ProcessStreamIdBuffer(uint32_t stream, uint8_t* pStreamIdBase, uint32_t num
 
 THREAD SWR_GS_CONTEXT tlsGsContext;
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Checks the cut buffer of a GS invocation for cuts.
+/// @param pCutBuffer - cut buffer, 1 bit per emitted vertex
+/// @param numEmittedVerts - Number of total verts emitted by the GS
+static INLINE bool HasCutVerts(const uint8_t* pCutBuffer, uint32_t numEmittedVerts)
+{
+    uint32_t numFullBytes = numEmittedVerts / 8;
+    for (uint32_t b = 0; b < numFullBytes; ++b)
+    {
+        if (pCutBuffer[b])
+        {
+            return true;
+        }
+    }
+
+    uint32_t numTailVerts = numEmittedVerts % 8;
+    return numTailVerts && (pCutBuffer[numFullBytes] & ((1 << numTailVerts) - 1));
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief GS output topologies the optimized PA can assemble straight from
+///        the GS output buffer.
+static INLINE bool IsOptPaTopology(PRIMITIVE_TOPOLOGY topology)
+{
+    switch (topology)
+    {
+    case TOP_TRIANGLE_STRIP:
+    case TOP_LINE_STRIP:
+    case TOP_POINT_LIST:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Assembles, streams out and bins the prims of one GS invocation.
+/// @param pDC - pointer to draw context.
+/// @param workerId - thread's worker id. Even thread has a unique id.
+/// @param gsPa - PA set up on the GS output of the invocation.
+/// @param stream - stream being processed.
+/// @param primID - primitive ID of the GS input prim.
+/// @param pfnClipFunc - clipper for the GS output topology.
+/// @return Number of prims assembled.
+template <
+    typename HasStreamOutT,
+    typename HasRastT,
+    typename PaT>
+static uint32_t BinGsOutput(
+    DRAW_CONTEXT *pDC,
+    uint32_t workerId,
+    PaT& gsPa,
+    uint32_t* pSoPrimData,
+    uint32_t stream,
+    uint32_t primID,
+    PFN_PROCESS_PRIMS pfnClipFunc)
+{
+    const API_STATE& state = GetApiState(pDC);
+
+    simdvector attrib[MAX_NUM_VERTS_PER_PRIM];
+    uint32_t numPrimsGenerated = 0;
+
+    while (gsPa.GetNextStreamOutput())
+    {
+        do
+        {
+            bool assemble = gsPa.Assemble(VERTEX_POSITION_SLOT, attrib);
+
+            if (assemble)
+            {
+                numPrimsGenerated += gsPa.NumPrims();
+
+                if (HasStreamOutT::value)
+                {
+                    StreamOut(pDC, gsPa, workerId, pSoPrimData, stream);
+                }
+
+                if (HasRastT::value && state.soState.streamToRasterizer == stream)
+                {
+                    simdscalari vPrimId;
+                    // pull primitiveID from the GS output if available
+                    if (state.gsState.emitsPrimitiveID)
+                    {
+                        simdvector primIdAttrib[3];
+                        gsPa.Assemble(VERTEX_PRIMID_SLOT, primIdAttrib);
+                        vPrimId = _simd_castps_si(primIdAttrib[0].x);
+                    }
+                    else
+                    {
+                        vPrimId = _simd_set1_epi32(primID);
+                    }
+
+                    // use viewport array index if GS declares it as an output attribute. Otherwise use index 0.
+                    simdscalari vViewPortIdx;
+                    if (state.gsState.emitsViewportArrayIndex)
+                    {
+                        simdvector vpiAttrib[3];
+                        gsPa.Assemble(VERTEX_VIEWPORT_ARRAY_INDEX_SLOT, vpiAttrib);
+
+                        // OOB indices => forced to zero.
+                        simdscalari vNumViewports = _simd_set1_epi32(KNOB_NUM_VIEWPORTS_SCISSORS);
+                        simdscalari vClearMask = _simd_cmplt_epi32(_simd_castps_si(vpiAttrib[0].x), vNumViewports);
+                        vpiAttrib[0].x = _simd_and_ps(_simd_castsi_ps(vClearMask), vpiAttrib[0].x);
+
+                        vViewPortIdx = _simd_castps_si(vpiAttrib[0].x);
+                    }
+                    else
+                    {
+                        vViewPortIdx = _simd_set1_epi32(0);
+                    }
+
+                    pfnClipFunc(pDC, gsPa, workerId, attrib, GenMask(gsPa.NumPrims()), vPrimId, vViewPortIdx);
+                }
+            }
+        } while (gsPa.NextPrim());
+    }
+
+
+    return numPrimsGenerated;
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Implements GS stage.
 /// @param pDC - pointer to draw context.
@@ -790,61 +997,20 @@ static void GeometryShaderStage(
                     processCutVerts = false;
                 }
 
-                PA_STATE_CUT gsPa(pDC, pBase, numEmittedVerts, pCutBuffer, numEmittedVerts, numAttribs, pState->outputTopology, processCutVerts);
-
-                while (gsPa.GetNextStreamOutput())
+                // Cut free output is a plain list/strip in the SIMD vertex layout the GS
+                // wrote, so the optimized PA can assemble it with SIMD shuffles.
+                if (!HasCutVerts(pCutBuffer, numEmittedVerts) && IsOptPaTopology(pState->outputTopology))
                 {
-                    do
-                    {
-                        bool assemble = gsPa.Assemble(VERTEX_POSITION_SLOT, attrib);
-
-                        if (assemble)
-                        {
-                            totalPrimsGenerated += gsPa.NumPrims();
-
-                            if (HasStreamOutT::value)
-                            {
-                                StreamOut(pDC, gsPa, workerId, pSoPrimData, stream);
-                            }
-
-                            if (HasRastT::value && state.soState.streamToRasterizer == stream)
-                            {
-                                simdscalari vPrimId;
-                                // pull primitiveID from the GS output if available
-                                if (state.gsState.emitsPrimitiveID)
-                                {
-                                    simdvector primIdAttrib[3];
-                                    gsPa.Assemble(VERTEX_PRIMID_SLOT, primIdAttrib);
-                                    vPrimId = _simd_castps_si(primIdAttrib[0].x);
-                                }
-                                else
-                                {
-                                    vPrimId = _simd_set1_epi32(pPrimitiveId[inputPrim]);
-                                }
-
-                                // use viewport array index if GS declares it as an output attribute. Otherwise use index 0.
-                                simdscalari vViewPortIdx;
-                                if (state.gsState.emitsViewportArrayIndex)
-                                {
-                                    simdvector vpiAttrib[3];
-                                    gsPa.Assemble(VERTEX_VIEWPORT_ARRAY_INDEX_SLOT, vpiAttrib);
-
-                                    // OOB indices => forced to zero.
-                                    simdscalari vNumViewports = _simd_set1_epi32(KNOB_NUM_VIEWPORTS_SCISSORS);
-                                    simdscalari vClearMask = _simd_cmplt_epi32(_simd_castps_si(vpiAttrib[0].x), vNumViewports);
-                                    vpiAttrib[0].x = _simd_and_ps(_simd_castsi_ps(vClearMask), vpiAttrib[0].x);
-
-                                    vViewPortIdx = _simd_castps_si(vpiAttrib[0].x);
-                                }
-                                else
-                                {
-                                    vViewPortIdx = _simd_set1_epi32(0);
-                                }
-
-                                pfnClipFunc(pDC, gsPa, workerId, attrib, GenMask(gsPa.NumPrims()), vPrimId, vViewPortIdx);
-                            }
-                        }
-                    } while (gsPa.NextPrim());
+                    PA_STATE_OPT gsPa(pDC, GetNumPrims(pState->outputTopology, numEmittedVerts), pBase,
+                        numSimdBatches * KNOB_SIMD_WIDTH, true, pState->outputTopology);
+                    totalPrimsGenerated += BinGsOutput<HasStreamOutT, HasRastT>(
+                        pDC, workerId, gsPa, pSoPrimData, stream, pPrimitiveId[inputPrim], pfnClipFunc);
+                }
+                else
+                {
+                    PA_STATE_CUT gsPa(pDC, pBase, numEmittedVerts, pCutBuffer, numEmittedVerts, numAttribs, pState->outputTopology, processCutVerts);
+                    totalPrimsGenerated += BinGsOutput<HasStreamOutT, HasRastT>(
+                        pDC, workerId, gsPa, pSoPrimData, stream, pPrimitiveId[inputPrim], pfnClipFunc);
                 }
             }
         }
@@ -874,7 +1040,8 @@ static INLINE void AllocateGsBuffers(DRAW_CONTEXT* pDC, const API_STATE& state,
     // @todo support multiple streams
     const uint32_t vertexStride = sizeof(simdvertex);
     const uint32_t numSimdBatches = (state.gsState.maxNumVerts + KNOB_SIMD_WIDTH - 1) / KNOB_SIMD_WIDTH;
-    uint32_t size = state.gsState.instanceCount * numSimdBatches * vertexStride * KNOB_SIMD_WIDTH;
+    // one extra vertex batch, the optimized PA reads a full batch past the end of short strips
+    uint32_t size = (state.gsState.instanceCount * numSimdBatches * KNOB_SIMD_WIDTH + 1) * vertexStride;
     *ppGsOut = pArena->AllocAligned(size, KNOB_SIMD_WIDTH * sizeof(float));
 
     const uint32_t cutPrimStride = (state.gsState.maxNumVerts + 7) / 8;
@@ -1021,13 +1188,17 @@ static void TessellationStages(
 
     const uint32_t* pPrimId = (const uint32_t*)&primID;
 
+    AR_EVENT(TessPrimCount(numPrims));
+
+    // The DS is run per patch; only the per-patch inputs change in the loop below.
+    SWR_DS_CONTEXT dsContext;
+
     for (uint32_t p = 0; p < numPrims; ++p)
     {
         // Run Tessellator
         SWR_TS_TESSELLATED_DATA tsData = { 0 };
         AR_BEGIN(FETessellation, pDC->drawId);
         TSTessellate(tsCtx, hsContext.pCPout[p].tessFactors, tsData);
-		AR_EVENT(TessPrimCount(1));
         AR_END(FETessellation, 0);
 
         if (tsData.NumPrimitives == 0)
@@ -1054,7 +1225,6 @@ static void TessellationStages(
 #endif
 
         // Run Domain Shader
-        SWR_DS_CONTEXT dsContext;
         dsContext.PrimitiveID = pPrimId[p];
         dsContext.pCpIn = &hsContext.pCPout[p];
         dsContext.pDomainU = (simdscalar*)tsData.pDomainPointsU;
@@ -1125,6 +1295,184 @@ static void TessellationStages(
     TSDestroyCtx(tsCtx);
 }
 
+// Post-transform vertex cache batching.
+static const uint32_t VCACHE_BATCH_PRIMS = 64;         // triangles de-duplicated and shaded together
+static const uint32_t VCACHE_HASH_BITS = 9;            // lookup table of 512 entries
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Reads an index of an index buffer.
+/// @param pIndices - pointer to the indices.
+/// @param i - index to read.
+/// @param indexSize - size of an index in bytes.
+static INLINE uint32_t ReadIndex(const uint8_t* pIndices, uint32_t i, uint32_t indexSize)
+{
+    switch (indexSize)
+    {
+    case sizeof(uint32_t): return ((const uint32_t*)pIndices)[i];
+    case sizeof(uint16_t): return ((const uint16_t*)pIndices)[i];
+    default: return pIndices[i];
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Writes an index to an index buffer.
+static INLINE void WriteIndex(uint8_t* pIndices, uint32_t i, uint32_t index, uint32_t indexSize)
+{
+    switch (indexSize)
+    {
+    case sizeof(uint32_t): ((uint32_t*)pIndices)[i] = index; break;
+    case sizeof(uint16_t): ((uint16_t*)pIndices)[i] = (uint16_t)index; break;
+    default: pIndices[i] = (uint8_t)index; break;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Indexed triangle list frontend with a post-transform vertex cache.
+///        The indices of VCACHE_BATCH_PRIMS triangles are de-duplicated, the
+///        unique vertices are fetched and shaded once into a vertex store and
+///        the triangles are then assembled from the store by slot.
+/// @param pDC - pointer to draw context.
+/// @param workerId - thread's worker id.
+/// @param work - indexed draw work.
+/// @param fetchInfo - fetch state set up for the draw.
+/// @param indexSize - size of an index in bytes.
+template <typename HasRastT>
+static void ProcessDrawVertexCache(
+    DRAW_CONTEXT *pDC,
+    uint32_t workerId,
+    DRAW_WORK& work,
+    SWR_FETCH_CONTEXT& fetchInfo,
+    uint32_t indexSize)
+{
+    SWR_CONTEXT *pContext = pDC->pContext;
+    const API_STATE& state = GetApiState(pDC);
+
+    uint32_t numTris = work.numIndices / 3;
+    if (numTris == 0)
+    {
+        return;
+    }
+
+    // Indices past the end of the index buffer are fetched as 0.
+    const uint8_t* pIB = (const uint8_t*)work.pIB;
+    ptrdiff_t validBytes = (const uint8_t*)fetchInfo.pLastIndex - pIB;
+    uint32_t numValidIndices = (validBytes > 0) ? (uint32_t)(validBytes / indexSize) : 0;
+
+    uint32_t maxBatchVerts = AlignUp(std::min(numTris, VCACHE_BATCH_PRIMS) * 3, KNOB_SIMD_WIDTH);
+    simdvertex* pVertexStore = (simdvertex*)pDC->pArena->AllocAligned(
+        (maxBatchVerts / KNOB_SIMD_WIDTH) * sizeof(simdvertex), KNOB_SIMD_WIDTH * 4);
+    uint8_t* pUniqueIndices = (uint8_t*)pDC->pArena->AllocAligned(maxBatchVerts * sizeof(uint32_t), KNOB_SIMD_WIDTH * 4);
+
+    PA_STATE_VCACHE pa(pDC, (uint8_t*)pVertexStore, maxBatchVerts);
+
+    struct VCACHE_ENTRY
+    {
+        uint32_t index;
+        uint32_t batch;
+        uint32_t slot;
+    };
+    VCACHE_ENTRY cache[1 << VCACHE_HASH_BITS];
+    memset(cache, 0xff, sizeof(cache));
+    uint32_t batchId = 0;
+
+    uint32_t triSlots[VCACHE_BATCH_PRIMS][3];
+
+    SWR_VS_CONTEXT vsContext;
+    simdvertex vin;
+    vsContext.pVin = &vin;
+
+    for (uint32_t instanceNum = work.startInstanceID; instanceNum < work.startInstanceID + work.numInstances; instanceNum++)
+    {
+        fetchInfo.CurInstance = instanceNum;
+        vsContext.InstanceID = instanceNum;
+
+        for (uint32_t firstTri = 0; firstTri < numTris; firstTri += VCACHE_BATCH_PRIMS, ++batchId)
+        {
+            uint32_t batchPrims = std::min(numTris - firstTri, VCACHE_BATCH_PRIMS);
+
+            // 1. De-duplicate the batch indices. A collision in the table only costs a
+            //    redundant shade of the evicted index.
+            uint32_t numUnique = 0;
+            for (uint32_t t = 0; t < batchPrims; ++t)
+            {
+                for (uint32_t v = 0; v < 3; ++v)
+                {
+                    uint32_t i = (firstTri + t) * 3 + v;
+                    uint32_t index = (i < numValidIndices) ? ReadIndex(pIB, i, indexSize) : 0;
+
+                    VCACHE_ENTRY& entry = cache[(index * 2654435761u) >> (32 - VCACHE_HASH_BITS)];
+                    if (entry.batch != batchId || entry.index != index)
+                    {
+                        entry.index = index;
+                        entry.batch = batchId;
+                        entry.slot = numUnique;
+                        WriteIndex(pUniqueIndices, numUnique, index, indexSize);
+                        ++numUnique;
+                    }
+                    triSlots[t][v] = entry.slot;
+                }
+            }
+
+            UPDATE_STAT_FE(IaVertices, batchPrims * 3);
+
+            // 2. Fetch and shade the unique vertices.
+            fetchInfo.pLastIndex = (const int32_t*)(pUniqueIndices + numUnique * indexSize);
+            for (uint32_t v = 0; v < numUnique; v += KNOB_SIMD_WIDTH)
+            {
+                fetchInfo.pIndices = (const int32_t*)(pUniqueIndices + v * indexSize);
+                vsContext.pVout = &pVertexStore[v / KNOB_SIMD_WIDTH];
+
+                AR_BEGIN(FEFetchShader, pDC->drawId);
+                state.pfnFetchFunc(fetchInfo, vin);
+                AR_END(FEFetchShader, 0);
+
+                // forward fetch generated vertex IDs to the vertex shader
+                vsContext.VertexID = fetchInfo.VertexID;
+                vsContext.mask = GenerateMask(numUnique - v);
+
+#if KNOB_ENABLE_TOSS_POINTS
+                if (!KNOB_TOSS_FETCH)
+#endif
+                {
+                    AR_BEGIN(FEVertexShader, pDC->drawId);
+                    state.pfnVertexFunc(GetPrivateState(pDC), &vsContext);
+                    AR_END(FEVertexShader, 0);
+
+                    UPDATE_STAT_FE(VsInvocations, GetNumInvocations(v, numUnique));
+                }
+            }
+
+            // 3. Assemble and bin the triangles a SIMD at a time.
+            for (uint32_t t = 0; t < batchPrims; t += KNOB_SIMD_WIDTH)
+            {
+                uint32_t numPrims = std::min<uint32_t>(batchPrims - t, KNOB_SIMD_WIDTH);
+                pa.SetPrims(&triSlots[t], numPrims, firstTri + t);
+
+                simdvector prim[MAX_NUM_VERTS_PER_PRIM];
+                AR_BEGIN(FEPAAssemble, pDC->drawId);
+                pa.Assemble(VERTEX_POSITION_SLOT, prim);
+                AR_END(FEPAAssemble, 1);
+
+#if KNOB_ENABLE_TOSS_POINTS
+                if (!KNOB_TOSS_FETCH && !KNOB_TOSS_VS)
+#endif
+                {
+                    UPDATE_STAT_FE(IaPrimitives, numPrims);
+
+                    if (HasRastT::value)
+                    {
+                        SWR_ASSERT(pDC->pState->pfnProcessPrims);
+                        pDC->pState->pfnProcessPrims(pDC, pa, workerId, prim,
+                            GenMask(numPrims), pa.GetPrimID(work.startPrimID), _simd_set1_epi32(0));
+                    }
+                }
+
+                pa.NextPrim();
+            }
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief FE handler for SwrDraw.
 /// @tparam IsIndexedT - Is indexed drawing enabled
@@ -1225,6 +1573,17 @@ void ProcessDraw(
     uint32_t numPrims = GetNumPrims(state.topology, work.numVerts);
 #endif
 
+    // Plain indexed triangle lists go through the post-transform vertex cache.
+    if (IsIndexedT::value && !IsCutIndexEnabledT::value && !HasTessellationT::value &&
+        !HasGeometryShaderT::value && !HasStreamOutT::value &&
+        KNOB_VERTEX_CACHE && state.topology == TOP_TRIANGLE_LIST)
+    {
+        ProcessDrawVertexCache<HasRastT>(pDC, workerId, work, fetchInfo, indexSize);
+
+        AR_END(FEProcessDraw, numPrims * work.numInstances);
+        return;
+    }
+
     void* pGsOut = nullptr;
     void* pCutBuffer = nullptr;
     void* pStreamCutBuffer = nullptr;
@@ -1253,6 +1612,11 @@ void ProcessDraw(
     if (HasStreamOutT::value)
     {
         pSoPrimData = (uint32_t*)pDC->pArena->AllocAligned(4096, 16);
+
+        if (work.pSoSplit)
+        {
+            BeginSplitStreamOut(pDC, work);
+        }
     }
 
     // choose primitive assembler
@@ -1260,7 +1624,7 @@ void ProcessDraw(
     PA_STATE& pa = paFactory.GetPA();
 
     /// @todo: temporarily move instance loop in the FE to ensure SO ordering
-    for (uint32_t instanceNum = 0; instanceNum < work.numInstances; instanceNum++)
+    for (uint32_t instanceNum = work.startInstanceID; instanceNum < work.startInstanceID + work.numInstances; instanceNum++)
     {
         simdscalari vIndex;
         uint32_t  i = 0;
@@ -1361,7 +1725,7 @@ void ProcessDraw(
                                 // If streamout is enabled then stream vertices out to memory.
                                 if (HasStreamOutT::value)
                                 {
-                                    StreamOut(pDC, pa, workerId, pSoPrimData, 0);
+                                    StreamOut(pDC, pa, workerId, pSoPrimData, 0, work.pSoSplit);
                                 }
 
                                 if (HasRastT::value)
@@ -1389,6 +1753,10 @@ void ProcessDraw(
         pa.Reset();
     }
 
+    if (HasStreamOutT::value && work.pSoSplit)
+    {
+        FinishSplitStreamOut(pDC, work);
+    }
 
     AR_END(FEProcessDraw, numPrims * work.numInstances);
 }
@@ -38,7 +38,9 @@
 // AVX512 Support
 ///////////////////////////////////////////////////////////////////////////////
 
+#if !defined(ENABLE_AVX512_SIMD16)
 #define ENABLE_AVX512_SIMD16    0
+#endif
 #define USE_8x2_TILE_BACKEND    0
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -116,12 +118,45 @@
 #define KNOB_TILE_Y_DIM                      8
 #define KNOB_TILE_Y_DIM_SHIFT                3
 
-// fixed macrotile pixel dimension for now, eventually will be 
-// dynamically set based on tile format and pixel size
+// macrotile pixel dimensions. Defaults to 32x32 and can be overridden at
+// build time, e.g. -DKNOB_MACROTILE_X_DIM=64 -DKNOB_MACROTILE_Y_DIM=64.
+// Larger tiles cut binning overhead for large render targets with few
+// draws; smaller tiles balance better for thin geometry but limit the
+// maximum render target size (see KNOB_NUM_HOT_TILES_X/Y).
+#if !defined(KNOB_MACROTILE_X_DIM)
 #define KNOB_MACROTILE_X_DIM                32
+#endif
+#if !defined(KNOB_MACROTILE_Y_DIM)
 #define KNOB_MACROTILE_Y_DIM                32
-#define KNOB_MACROTILE_X_DIM_FIXED_SHIFT    13
-#define KNOB_MACROTILE_Y_DIM_FIXED_SHIFT    13
+#endif
+
+#if KNOB_MACROTILE_X_DIM == 16
+#define KNOB_MACROTILE_X_DIM_SHIFT          4
+#elif KNOB_MACROTILE_X_DIM == 32
+#define KNOB_MACROTILE_X_DIM_SHIFT          5
+#elif KNOB_MACROTILE_X_DIM == 64
+#define KNOB_MACROTILE_X_DIM_SHIFT          6
+#elif KNOB_MACROTILE_X_DIM == 128
+#define KNOB_MACROTILE_X_DIM_SHIFT          7
+#else
+#error "Unsupported macrotile X dimension"
+#endif
+
+#if KNOB_MACROTILE_Y_DIM == 16
+#define KNOB_MACROTILE_Y_DIM_SHIFT          4
+#elif KNOB_MACROTILE_Y_DIM == 32
+#define KNOB_MACROTILE_Y_DIM_SHIFT          5
+#elif KNOB_MACROTILE_Y_DIM == 64
+#define KNOB_MACROTILE_Y_DIM_SHIFT          6
+#elif KNOB_MACROTILE_Y_DIM == 128
+#define KNOB_MACROTILE_Y_DIM_SHIFT          7
+#else
+#error "Unsupported macrotile Y dimension"
+#endif
+
+// macrotile dimensions in 16.8 fixed point
+#define KNOB_MACROTILE_X_DIM_FIXED_SHIFT    (KNOB_MACROTILE_X_DIM_SHIFT + 8)
+#define KNOB_MACROTILE_Y_DIM_FIXED_SHIFT    (KNOB_MACROTILE_Y_DIM_SHIFT + 8)
 #define KNOB_MACROTILE_X_DIM_FIXED          (KNOB_MACROTILE_X_DIM << 8)
 #define KNOB_MACROTILE_Y_DIM_FIXED          (KNOB_MACROTILE_Y_DIM << 8)
 #define KNOB_MACROTILE_X_DIM_IN_TILES       (KNOB_MACROTILE_X_DIM >> KNOB_TILE_X_DIM_SHIFT)
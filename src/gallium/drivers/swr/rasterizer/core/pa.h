@@ -960,6 +960,150 @@ struct PA_STATE_CUT : public PA_STATE
     }
 };
 
+// Primitive assembler for triangle lists shaded through the post-transform vertex cache.
+// The frontend shades each unique index of a batch once into a vertex store and hands the
+// PA the store slot of every triangle vertex, SIMD triangles at a time.
+struct PA_STATE_VCACHE : public PA_STATE
+{
+    OSALIGNSIMD(uint32_t) indices[3][KNOB_SIMD_WIDTH];  // vertex store slots of the current triangles
+    simdscalari vOffsets[3];                            // byte offsets of the slots in the vertex store
+    uint32_t numPrims{ 0 };                             // number of triangles currently set
+    simdscalari vPrimId;
+    simdvertex tmpVertex;                               // temporary simdvertex for unimplemented API
+    simdmask tmpMask;
+
+    PA_STATE_VCACHE() {}
+    PA_STATE_VCACHE(DRAW_CONTEXT* pDC, uint8_t* in_pStream, uint32_t in_streamSizeInVerts)
+        : PA_STATE(pDC, in_pStream, in_streamSizeInVerts)
+    {
+        binTopology = TOP_TRIANGLE_LIST;
+        memset(indices, 0, sizeof(indices));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Sets the triangles to assemble.
+    /// @param pSlots - 3 vertex store slots per triangle.
+    /// @param in_numPrims - number of triangles, up to SIMD width.
+    /// @param primIndex - index of the first triangle in the draw.
+    void SetPrims(const uint32_t (*pSlots)[3], uint32_t in_numPrims, uint32_t primIndex)
+    {
+        SWR_ASSERT(in_numPrims <= KNOB_SIMD_WIDTH);
+        numPrims = in_numPrims;
+
+        for (uint32_t p = 0; p < KNOB_SIMD_WIDTH; ++p)
+        {
+            // unused lanes point at slot 0, which always holds a shaded vertex
+            for (uint32_t v = 0; v < 3; ++v)
+            {
+                indices[v][p] = (p < in_numPrims) ? pSlots[p][v] : 0;
+            }
+        }
+
+        for (uint32_t v = 0; v < 3; ++v)
+        {
+            simdscalari vSlots = *(simdscalari*)&indices[v][0];
+
+            // step to simdvertex batch, then to the lane within it
+            simdscalari vVertexBatch = _simd_srai_epi32(vSlots, 3);
+            vOffsets[v] = _simd_mullo_epi32(vVertexBatch, _simd_set1_epi32(sizeof(simdvertex)));
+
+            simdscalari vVertexIndex = _simd_and_si(vSlots, _simd_set1_epi32(KNOB_SIMD_WIDTH - 1));
+            vOffsets[v] = _simd_add_epi32(vOffsets[v], _simd_mullo_epi32(vVertexIndex, _simd_set1_epi32(sizeof(float))));
+        }
+
+        vPrimId = _simd_add_epi32(_simd_set1_epi32(primIndex), _simd_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    bool HasWork()
+    {
+        return numPrims > 0;
+    }
+
+    simdvector& GetSimdVector(uint32_t index, uint32_t slot)
+    {
+        // unused
+        SWR_ASSERT(0 && "Not implemented");
+        return tmpVertex.attrib[0];
+    }
+
+    bool Assemble(uint32_t slot, simdvector result[])
+    {
+        for (uint32_t v = 0; v < 3; ++v)
+        {
+            // step to attribute
+            simdscalari offsets = _simd_add_epi32(vOffsets[v], _simd_set1_epi32(slot * sizeof(simdvector)));
+
+            float* pBase = (float*)pStreamBase;
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                result[v].v[c] = _simd_i32gather_ps(pBase, offsets, 1);
+
+                // move base to next component
+                pBase += KNOB_SIMD_WIDTH;
+            }
+        }
+
+        return true;
+    }
+
+    void AssembleSingle(uint32_t slot, uint32_t triIndex, __m128 tri[3])
+    {
+        for (uint32_t v = 0; v < 3; ++v)
+        {
+            uint32_t offset = ((uint32_t*)&vOffsets[v])[triIndex];
+            offset += sizeof(simdvector) * slot;
+            float* pVert = (float*)&tri[v];
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                pVert[c] = *(float*)(pStreamBase + offset);
+                offset += KNOB_SIMD_WIDTH * sizeof(float);
+            }
+        }
+    }
+
+    bool NextPrim()
+    {
+        numPrims = 0;
+        return false;
+    }
+
+    simdvertex& GetNextVsOutput()
+    {
+        // unused, the frontend shades straight into the vertex store
+        SWR_ASSERT(0 && "Not implemented");
+        return tmpVertex;
+    }
+
+    bool GetNextStreamOutput()
+    {
+        // unused
+        SWR_ASSERT(0 && "Not implemented");
+        return false;
+    }
+
+    simdmask& GetNextVsIndices()
+    {
+        // unused
+        SWR_ASSERT(0 && "Not implemented");
+        return tmpMask;
+    }
+
+    uint32_t NumPrims()
+    {
+        return numPrims;
+    }
+
+    void Reset()
+    {
+        numPrims = 0;
+    }
+
+    simdscalari GetPrimID(uint32_t startID)
+    {
+        return _simd_add_epi32(_simd_set1_epi32(startID), vPrimId);
+    }
+};
+
 // Primitive Assembly for data output from the DomainShader.
 struct PA_TESS : PA_STATE
 {
@@ -1148,6 +1148,34 @@ void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile,
     GetRenderHotTiles<RT::MT::numSamples>(pDC, macroTile, minTileX, minTileY, renderBuffers, triDesc.triFlags.renderTargetArrayIndex);
     currentRenderBufferRow = renderBuffers;
 
+    // HiZ: the depth hot tile tracks the max depth of each raster tile; a raster tile whose
+    // max depth is in front of the nearest depth the triangle can produce fails the depth test
+    float *pTileMaxZ = nullptr;
+    float triMinZ = 0.0f;
+    const bool updateMaxZ = state.depthHottileEnable && state.depthStencilState.depthWriteEnable;
+    if (state.hiZCullEnable || updateMaxZ)
+    {
+        HOTTILE *pDepthHotTile = pContext->pHotTileMgr->GetHotTile(pContext, pDC, macroTile, SWR_ATTACHMENT_DEPTH, true,
+            RT::MT::numSamples, triDesc.triFlags.renderTargetArrayIndex);
+        pTileMaxZ = pDepthHotTile->pMaxZ;
+    }
+
+    if (pTileMaxZ && state.hiZCullEnable)
+    {
+        // back off by a few ulps to cover rounding in the backend's z interpolation
+        float minVertZ = std::min(std::min(a[0], a[1]), a[2]);
+        float maxAbsVertZ = std::max(std::max(fabsf(a[0]), fabsf(a[1])), fabsf(a[2]));
+        minVertZ += triDesc.Z[2] - a[2];
+        minVertZ -= maxAbsVertZ * (1.0f / (1 << 20));
+
+        // apply the same quantize and viewport clamp as the depth test; both are monotonic
+        const SWR_VIEWPORT &vp = state.vp[triDesc.triFlags.viewportIndex];
+        triMinZ = _mm_cvtss_f32(_mm256_castps256_ps128(state.pfnQuantizeDepth(_simd_set1_ps(minVertZ))));
+        triMinZ = std::min(vp.maxZ, std::max(vp.minZ, triMinZ));
+    }
+    const uint32_t macroTileX = macroX * KNOB_MACROTILE_X_DIM_IN_TILES;
+    const uint32_t macroTileY = macroY * KNOB_MACROTILE_Y_DIM_IN_TILES;
+
     // rasterize and generate coverage masks per sample
     for (uint32_t tileY = tY; tileY <= maxY; ++tileY)
     {
@@ -1161,6 +1189,9 @@ void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile,
         {
             triDesc.anyCoveredSamples = 0;
 
+            const uint32_t rasterTileIndex = (tileY - macroTileY) * KNOB_MACROTILE_X_DIM_IN_TILES + (tileX - macroTileX);
+            const bool hiZReject = state.hiZCullEnable && pTileMaxZ && (triMinZ > pTileMaxZ[rasterTileIndex]);
+
             // is the corner of the edge outside of the raster tile? (vEdge < 0)
             int mask0, mask1, mask2;
             UpdateEdgeMasks<NumRasterSamplesT>(vEdgeTileBbox, vEdgeFix16, mask0, mask1, mask2);
@@ -1168,7 +1199,8 @@ void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile,
             for (uint32_t sampleNum = 0; sampleNum < NumRasterSamplesT::value; sampleNum++)
             {
                 // trivial reject, at least one edge has all 4 corners of raster tile outside
-                bool trivialReject = TrivialRejectTest<typename RT::ValidEdgeMaskT>(mask0, mask1, mask2);
+                // or the whole raster tile is occluded
+                bool trivialReject = hiZReject || TrivialRejectTest<typename RT::ValidEdgeMaskT>(mask0, mask1, mask2);
 
                 if (!trivialReject)
                 {
@@ -1270,6 +1302,11 @@ void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile,
                 AR_BEGIN(BEPixelBackend, pDC->drawId);
                 backendFuncs.pfnBackend(pDC, workerId, tileX << KNOB_TILE_X_DIM_SHIFT, tileY << KNOB_TILE_Y_DIM_SHIFT, triDesc, renderBuffers);
                 AR_END(BEPixelBackend, 0);
+
+                if (updateMaxZ && pTileMaxZ)
+                {
+                    pTileMaxZ[rasterTileIndex] = ComputeRasterTileMaxZ(renderBuffers.pDepth, RT::MT::numSamples);
+                }
             }
 
             // step to the next tile in X
@@ -1483,6 +1520,22 @@ void RasterizeSimplePoint(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTi
     AR_BEGIN(BEPixelBackend, pDC->drawId);
     backendFuncs.pfnBackend(pDC, workerId, tileAlignedX, tileAlignedY, triDesc, renderBuffers);
     AR_END(BEPixelBackend, 0);
+
+    const API_STATE &state = GetApiState(pDC);
+    if (state.depthHottileEnable && state.depthStencilState.depthWriteEnable)
+    {
+        HOTTILE *pDepthHotTile = pContext->pHotTileMgr->GetHotTile(pContext, pDC, macroTile, SWR_ATTACHMENT_DEPTH, true,
+            1, triDesc.triFlags.renderTargetArrayIndex);
+
+        if (pDepthHotTile->pMaxZ)
+        {
+            uint32_t macroX, macroY;
+            MacroTileMgr::getTileIndices(macroTile, macroX, macroY);
+            uint32_t tileX = (tileAlignedX >> KNOB_TILE_X_DIM_SHIFT) - macroX * KNOB_MACROTILE_X_DIM_IN_TILES;
+            uint32_t tileY = (tileAlignedY >> KNOB_TILE_Y_DIM_SHIFT) - macroY * KNOB_MACROTILE_Y_DIM_IN_TILES;
+            pDepthHotTile->pMaxZ[tileY * KNOB_MACROTILE_X_DIM_IN_TILES + tileX] = ComputeRasterTileMaxZ(renderBuffers.pDepth, 1);
+        }
+    }
 }
 
 // Get pointers to hot tile memory for color RT, depth, stencil
@@ -60,6 +60,7 @@ BUCKET_DESC gCoreBuckets[] = {
     { "FEProcessInvalidateTiles", "", true, 0xffffffff },
     { "WorkerWorkOnFifoBE", "", false, 0xff40261c },
     { "WorkerFoundWork", "", false, 0xff573326 },
+    { "WorkerStealWork", "", false, 0xff8c5a3c },
     { "BELoadTiles", "", true, 0xffb0e2ff },
     { "BEDispatch", "", true, 0xff00a2ff },
     { "BEClear", "", true, 0xff00ccbb },
@@ -85,6 +86,7 @@ BUCKET_DESC gCoreBuckets[] = {
     { "BEOutputMerger", "", false, 0xffffffff },
     { "BEStoreTiles", "", true, 0xff00cccc },
     { "BEEndTile", "", false, 0xffffffff },
+    { "WorkerWaitForThreadEvent", "", false, 0xffffffff },
 };
 
 /// @todo bucketmanager and mapping should probably be a part of the SWR context
@@ -65,6 +65,7 @@ enum CORE_BUCKETS
     FEProcessInvalidateTiles,
     WorkerWorkOnFifoBE,
     WorkerFoundWork,
+    WorkerStealWork,
     BELoadTiles,
     BEDispatch,
     BEClear,
@@ -90,6 +91,7 @@ enum CORE_BUCKETS
     BEOutputMerger,
     BEStoreTiles,
     BEEndTile,
+    WorkerWaitForThreadEvent,
 
     NumBuckets
 };
@@ -571,6 +571,8 @@ OSALIGNLINE(struct) SWR_STATS
     uint64_t PsInvocations;  // Number of Pixel Shader invocations
     uint64_t CsInvocations;  // Number of Compute Shader invocations
 
+    // Cycle Accounting
+    uint64_t BeCycles;       // rdtsc ticks spent in backend and compute work
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -593,6 +595,9 @@ OSALIGNLINE(struct) SWR_STATS_FE
     // Streamout Stats
     uint64_t SoPrimStorageNeeded[4];
     uint64_t SoNumPrimsWritten[4];
+
+    // Cycle Accounting
+    uint64_t FeCycles;      // rdtsc ticks spent in frontend work
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -236,10 +236,13 @@ void CalculateProcessorTopology(CPUNumaNodes& out_nodes, uint32_t& out_numThread
 }
 
 
-void bindThread(SWR_CONTEXT* pContext, uint32_t threadId, uint32_t procGroupId = 0, bool bindProcGroup=false)
+// NUMA node used by this thread for arena block allocations.
+THREAD uint32_t tlsArenaNumaNode = 0;
+
+void bindThread(const SWR_THREADING_INFO& threadInfo, uint32_t threadId, uint32_t procGroupId = 0, bool bindProcGroup=false)
 {
     // Only bind threads when MAX_WORKER_THREADS isn't set.
-    if (pContext->threadInfo.MAX_WORKER_THREADS && bindProcGroup == false)
+    if (threadInfo.MAX_WORKER_THREADS && bindProcGroup == false)
     {
         return;
     }
@@ -266,7 +269,7 @@ void bindThread(SWR_CONTEXT* pContext, uint32_t threadId, uint32_t procGroupId =
     {
         // If MAX_WORKER_THREADS is set, only bind to the proc group,
         // Not the individual HW thread.
-        if (!pContext->threadInfo.MAX_WORKER_THREADS)
+        if (!threadInfo.MAX_WORKER_THREADS)
         {
             affinity.Mask = KAFFINITY(1) << threadId;
         }
@@ -337,6 +340,8 @@ INLINE void UpdateClientStats(SWR_CONTEXT* pContext, uint32_t workerId, DRAW_CON
 
         stats.PsInvocations  += dynState.pStats[i].PsInvocations;
         stats.CsInvocations  += dynState.pStats[i].CsInvocations;
+
+        stats.BeCycles       += dynState.pStats[i].BeCycles;
     }
 
 
@@ -421,36 +426,32 @@ INLINE bool FindFirstIncompleteDraw(SWR_CONTEXT* pContext, uint32_t workerId, ui
 }
 
 //////////////////////////////////////////////////////////////////////////
-/// @brief If there is any BE work then go work on it.
+/// @brief Work on any available macrotiles that belong to a numa node.
 /// @param pContext - pointer to SWR context.
 /// @param workerId - The unique worker ID that is assigned to this thread.
-/// @param curDrawBE - This tracks the draw contexts that this thread has processed. Each worker thread
-///                    has its own curDrawBE counter and this ensures that each worker processes all the
-///                    draws in order.
-/// @param lockedTiles - This is the set of tiles locked by other threads. Each thread maintains its
-///                      own set and each time it fails to lock a macrotile, because its already locked,
-///                      then it will add that tile to the lockedTiles set. As a worker begins to work
-///                      on future draws the lockedTiles ensure that it doesn't work on tiles that may
-///                      still have work pending in a previous draw. Additionally, the lockedTiles is
-///                      hueristic that can steer a worker back to the same macrotile that it had been
-///                      working on in a previous draw.
-/// @returns        true if worker thread should shutdown
-bool WorkOnFifoBE(
+/// @param curDrawBE - Oldest draw this thread has not yet retired. See WorkOnFifoBE.
+/// @param lockedTiles - Set of tiles locked by other threads. See WorkOnFifoBE.
+/// @param numaNode - Only work on macrotiles that are assigned to this numa node.
+/// @param numaMask - Mask used to map a macrotile to its numa node.
+/// @param bShutdown - Set to true if a shutdown work item was processed.
+/// @returns        number of macrotiles this thread worked on
+INLINE uint32_t WorkOnTilesBE(
     SWR_CONTEXT *pContext,
     uint32_t workerId,
     uint32_t &curDrawBE,
     TileSet& lockedTiles,
     uint32_t numaNode,
-    uint32_t numaMask)
+    uint32_t numaMask,
+    bool& bShutdown)
 {
-    bool bShutdown = false;
+    uint32_t numTilesWorked = 0;
 
     // Find the first incomplete draw that has pending work. If no such draw is found then
     // return. FindFirstIncompleteDraw is responsible for incrementing the curDrawBE.
     uint32_t drawEnqueued = 0;
     if (FindFirstIncompleteDraw(pContext, workerId, curDrawBE, drawEnqueued) == false)
     {
-        return false;
+        return numTilesWorked;
     }
 
     uint32_t lastRetiredDraw = pContext->dcRing[curDrawBE % KNOB_MAX_DRAWS_IN_FLIGHT].drawId - 1;
@@ -467,24 +468,30 @@ bool WorkOnFifoBE(
     {
         DRAW_CONTEXT *pDC = &pContext->dcRing[i % KNOB_MAX_DRAWS_IN_FLIGHT];
 
-        if (pDC->isCompute) return false; // We don't look at compute work.
+        if (pDC->isCompute) return numTilesWorked; // We don't look at compute work.
 
         // First wait for FE to be finished with this draw. This keeps threading model simple
         // but if there are lots of bubbles between draws then serializing FE and BE may
         // need to be revisited.
-        if (!pDC->doneFE) return false;
+        if (!pDC->doneFE) return numTilesWorked;
         
         // If this draw is dependent on a previous draw then we need to bail.
         if (CheckDependency(pContext, pDC, lastRetiredDraw))
         {
-            return false;
+            return numTilesWorked;
         }
 
         // Grab the list of all dirty macrotiles. A tile is dirty if it has work queued to it.
         auto &macroTiles = pDC->pTileMgr->getDirtyTiles();
 
-        for (auto tile : macroTiles)
+        // Start each worker at a different point in the dirty list so that workers
+        // don't all race for the locks on the same first few macrotiles.
+        uint32_t numDirtyTiles = (uint32_t)macroTiles.size();
+        uint32_t firstTile = numDirtyTiles ? (workerId % numDirtyTiles) : 0;
+
+        for (uint32_t t = 0; t < numDirtyTiles; ++t)
         {
+            MacroTileQueue* tile = macroTiles[(firstTile + t) % numDirtyTiles];
             uint32_t tileID = tile->mId;
 
             // Only work on tiles for this numa node
@@ -515,6 +522,10 @@ bool WorkOnFifoBE(
                 uint32_t numWorkItems = tile->getNumQueued();
                 SWR_ASSERT(numWorkItems);
 
+                // Cycle accounting is only gathered while the client has stats enabled.
+                const bool bCountCycles = GetApiState(pDC).enableStatsBE;
+                uint64_t startCycles = bCountCycles ? __rdtsc() : 0;
+
                 pWork = tile->peek();
                 SWR_ASSERT(pWork);
                 if (pWork->type == DRAW)
@@ -531,11 +542,17 @@ bool WorkOnFifoBE(
                     pWork->pfnWork(pDC, workerId, tileID, &pWork->desc);
                     tile->dequeue();
                 }
+
+                if (bCountCycles)
+                {
+                    pDC->dynState.pStats[workerId].BeCycles += __rdtsc() - startCycles;
+                }
                 AR_END(WorkerFoundWork, numWorkItems);
 
                 _ReadWriteBarrier();
 
                 pDC->pTileMgr->markTileComplete(tileID);
+                numTilesWorked++;
 
                 // Optimization: If the draw is complete and we're the last one to have worked on it then
                 // we can reset the locked list as we know that all previous draws before the next are guaranteed to be complete.
@@ -564,6 +581,58 @@ bool WorkOnFifoBE(
         }
     }
 
+    return numTilesWorked;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief If there is any BE work then go work on it.
+/// @param pContext - pointer to SWR context.
+/// @param workerId - The unique worker ID that is assigned to this thread.
+/// @param curDrawBE - This tracks the draw contexts that this thread has processed. Each worker thread
+///                    has its own curDrawBE counter and this ensures that each worker processes all the
+///                    draws in order.
+/// @param lockedTiles - This is the set of tiles locked by other threads. Each thread maintains its
+///                      own set and each time it fails to lock a macrotile, because its already locked,
+///                      then it will add that tile to the lockedTiles set. As a worker begins to work
+///                      on future draws the lockedTiles ensure that it doesn't work on tiles that may
+///                      still have work pending in a previous draw. Additionally, the lockedTiles is
+///                      hueristic that can steer a worker back to the same macrotile that it had been
+///                      working on in a previous draw.
+/// @param numaNode - Numa node this worker is bound to. Macrotiles are statically assigned to
+///                   numa nodes so that hot tile memory stays local to the workers using it.
+/// @param numaMask - Mask used to map a macrotile to its numa node.
+/// @returns        true if worker thread should shutdown
+bool WorkOnFifoBE(
+    SWR_CONTEXT *pContext,
+    uint32_t workerId,
+    uint32_t &curDrawBE,
+    TileSet& lockedTiles,
+    uint32_t numaNode,
+    uint32_t numaMask)
+{
+    bool bShutdown = false;
+
+    uint32_t numTilesWorked = WorkOnTilesBE(pContext, workerId, curDrawBE, lockedTiles, numaNode, numaMask, bShutdown);
+
+    // Nothing left for our own numa node. Rather than sitting idle until the other nodes
+    // drain their macrotiles, steal from them. Each steal pass covers every in-flight draw for
+    // the victim node's tiles so ordering is maintained the same way as for our own tiles.
+    // Victim nodes are visited in order of increasing node id distance (numaNode ^ n).
+    if (KNOB_WORKER_STEAL_REMOTE_TILES && (numTilesWorked == 0) && !bShutdown)
+    {
+        for (uint32_t n = 1; n <= numaMask; ++n)
+        {
+            AR_BEGIN(WorkerStealWork, 0);
+            uint32_t numTilesStolen = WorkOnTilesBE(pContext, workerId, curDrawBE, lockedTiles, numaNode ^ n, numaMask, bShutdown);
+            AR_END(WorkerStealWork, numTilesStolen);
+
+            if (numTilesStolen || bShutdown)
+            {
+                break;
+            }
+        }
+    }
+
     return bShutdown;
 }
 
@@ -642,7 +711,16 @@ void WorkOnFifoFE(SWR_CONTEXT *pContext, uint32_t workerId, uint32_t &curDrawFE)
             if (initial == 0)
             {
                 // successfully grabbed the DC, now run the FE
-                pDC->FeWork.pfnWork(pContext, pDC, workerId, &pDC->FeWork.desc);
+                if (GetApiState(pDC).enableStatsFE)
+                {
+                    uint64_t startCycles = __rdtsc();
+                    pDC->FeWork.pfnWork(pContext, pDC, workerId, &pDC->FeWork.desc);
+                    pDC->dynState.statsFE.FeCycles += __rdtsc() - startCycles;
+                }
+                else
+                {
+                    pDC->FeWork.pfnWork(pContext, pDC, workerId, &pDC->FeWork.desc);
+                }
 
                 CompleteDrawFE(pContext, workerId, pDC);
             }
@@ -690,18 +768,73 @@ void WorkOnCompute(
         {
             void* pSpillFillBuffer = nullptr;
             uint32_t threadGroupId = 0;
+            const bool bCountCycles = GetApiState(pDC).enableStatsBE;
+            uint64_t startCycles = bCountCycles ? __rdtsc() : 0;
             while (queue.getWork(threadGroupId))
             {
                 queue.dispatch(pDC, workerId, threadGroupId, pSpillFillBuffer);
                 queue.finishedWork();
             }
 
+            if (bCountCycles)
+            {
+                pDC->dynState.pStats[workerId].BeCycles += __rdtsc() - startCycles;
+            }
+
             // Ensure all streaming writes are globally visible before moving onto the next draw
             _mm_mfence();
         }
     }
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns the number of spin-loop iterations an idle worker should
+///        perform before going to sleep.
+/// @param pContext - pointer to SWR context.
+INLINE uint32_t GetWorkerSpinBudget(SWR_CONTEXT* pContext)
+{
+    if (!KNOB_WORKER_ADAPTIVE_SPIN)
+    {
+        return KNOB_WORKER_SPIN_LOOP_COUNT;
+    }
+
+    // If the API thread has been quiet for longer than twice its recent submit
+    // interval new work is unlikely to show up soon, so go to sleep right away.
+    uint64_t idleTsc = __rdtsc() - pContext->lastSubmitTsc;
+    if (idleTsc > 2 * pContext->submitIntervalTsc)
+    {
+        return 0;
+    }
+
+    return pContext->workerSpinLimit;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Grows the shared spin budget when spinning found work and shrinks
+///        it when a worker spun its full budget and still had to sleep.
+/// @param pContext - pointer to SWR context.
+/// @param bFoundWork - true if work arrived while spinning.
+INLINE void AdaptWorkerSpinLimit(SWR_CONTEXT* pContext, bool bFoundWork)
+{
+    if (!KNOB_WORKER_ADAPTIVE_SPIN)
+    {
+        return;
+    }
+
+    // Races between workers only perturb the heuristic, no need to synchronize.
+    const uint32_t minSpinLimit = std::min<uint32_t>(64, KNOB_WORKER_SPIN_LOOP_COUNT);
+    uint32_t limit = pContext->workerSpinLimit;
+    if (bFoundWork)
+    {
+        limit = std::min<uint32_t>(limit + (limit >> 2) + 1, KNOB_WORKER_SPIN_LOOP_COUNT);
+    }
+    else
+    {
+        limit = std::max<uint32_t>(limit >> 1, minSpinLimit);
+    }
+    pContext->workerSpinLimit = limit;
+}
+
 template<bool IsFEThread, bool IsBEThread>
 DWORD workerThreadMain(LPVOID pData)
 {
@@ -710,13 +843,16 @@ DWORD workerThreadMain(LPVOID pData)
     uint32_t threadId = pThreadData->threadId;
     uint32_t workerId = pThreadData->workerId;
 
-    bindThread(pContext, threadId, pThreadData->procGroupId, pThreadData->forceBindProcGroup); 
+    bindThread(pContext->threadInfo, threadId, pThreadData->procGroupId, pThreadData->forceBindProcGroup);
 
     RDTSC_INIT(threadId);
 
     uint32_t numaNode = pThreadData->numaId;
     uint32_t numaMask = pContext->threadPool.numaMask;
 
+    // Arena blocks filled by this thread (bins, GS/SO data, etc.) should come from our numa node.
+    tlsArenaNumaNode = numaNode;
+
     // flush denormals to 0
     _mm_setcsr(_mm_getcsr() | _MM_FLUSH_ZERO_ON | _MM_DENORMALS_ZERO_ON);
 
@@ -748,6 +884,12 @@ DWORD workerThreadMain(LPVOID pData)
     uint32_t curDrawBE = 0;
     uint32_t curDrawFE = 0;
 
+    // Wait statistics since the last time this worker went to sleep.
+    uint32_t spinWakeups = 0;
+    uint32_t sleepWakeups = 0;
+    uint32_t parkedWaits = 0;
+    uint64_t spinLoops = 0;
+
     bool bShutdown = false;
 
     while (true)
@@ -757,25 +899,69 @@ DWORD workerThreadMain(LPVOID pData)
             break;
         }
 
-        uint32_t loop = 0;
-        while (loop++ < KNOB_WORKER_SPIN_LOOP_COUNT && !threadHasWork(curDrawBE))
-        {
-            _mm_pause();
-        }
-
         if (!threadHasWork(curDrawBE))
         {
-            lock.lock();
+            // Only a limited number of idle workers spin, the rest are parked on the
+            // condition variable right away and woken up when work is queued.
+            uint32_t spinBudget = 0;
+            bool bSpinner = (uint32_t)InterlockedIncrement(&pContext->numSpinningWorkers) <= pContext->maxSpinningWorkers;
+            if (bSpinner)
+            {
+                spinBudget = GetWorkerSpinBudget(pContext);
+            }
+
+            uint32_t loop = 0;
+            while (loop < spinBudget && !threadHasWork(curDrawBE))
+            {
+                _mm_pause();
+                ++loop;
+            }
+            InterlockedDecrement(&pContext->numSpinningWorkers);
+            spinLoops += loop;
 
-            // check for thread idle condition again under lock
             if (threadHasWork(curDrawBE))
             {
-                lock.unlock();
-                continue;
+                if (loop > 0)
+                {
+                    // Spinning paid off, allow a little more of it next time.
+                    ++spinWakeups;
+                    AdaptWorkerSpinLimit(pContext, true);
+                }
             }
+            else
+            {
+                if (spinBudget > 0)
+                {
+                    AdaptWorkerSpinLimit(pContext, false);
+                }
+
+                lock.lock();
+
+                // check for thread idle condition again under lock
+                if (threadHasWork(curDrawBE))
+                {
+                    lock.unlock();
+                    continue;
+                }
+
+                AR_BEGIN(WorkerWaitForThreadEvent, 0);
+                pContext->FifosNotEmpty.wait(lock);
+                AR_END(WorkerWaitForThreadEvent, 0);
+                lock.unlock();
+
+                if (bSpinner)
+                {
+                    ++sleepWakeups;
+                }
+                else
+                {
+                    ++parkedWaits;
+                }
 
-            pContext->FifosNotEmpty.wait(lock);
-            lock.unlock();
+                AR_EVENT(WorkerWaitInfo(spinWakeups, sleepWakeups, parkedWaits, spinLoops));
+                spinWakeups = sleepWakeups = parkedWaits = 0;
+                spinLoops = 0;
+            }
         }
 
         if (IsBEThread)
@@ -824,12 +1010,163 @@ DWORD workerThreadInit(LPVOID pData)
 template<> DWORD workerThreadInit<false, false>(LPVOID pData) = delete;
 
 //////////////////////////////////////////////////////////////////////////
-/// @brief Creates thread pool info but doesn't launch threads.
-/// @param pContext - pointer to context
+/// @brief Main loop of a shared thread pool worker. Each pass visits every
+///        attached context this worker serves, starting with a different
+///        context each time, and gives each up to SCHEDULING_WEIGHT rounds
+///        of FE/BE work.
+DWORD sharedWorkerThreadMain(LPVOID pData)
+{
+    THREAD_DATA *pThreadData = (THREAD_DATA*)pData;
+    SHARED_THREAD_POOL *pPool = pThreadData->pSharedPool;
+    uint32_t poolWorkerId = pThreadData->workerId;
+    uint32_t poolSize = pPool->threadPool.numThreads;
+
+    bindThread(pPool->threadInfo, pThreadData->threadId, pThreadData->procGroupId, pThreadData->forceBindProcGroup);
+
+    RDTSC_INIT(pThreadData->threadId);
+
+    uint32_t numaNode = pThreadData->numaId;
+    uint32_t numaMask = pPool->threadPool.numaMask;
+
+    // Arena blocks filled by this thread (bins, GS/SO data, etc.) should come from our numa node.
+    tlsArenaNumaNode = numaNode;
+
+    // flush denormals to 0
+    _mm_setcsr(_mm_getcsr() | _MM_FLUSH_ZERO_ON | _MM_DENORMALS_ZERO_ON);
+
+    std::vector<SWR_CONTEXT*> contexts;
+    uint32_t firstContext = 0;
+
+    // Index of this worker within the workers of a context, >= NumWorkerThreads if it doesn't serve it.
+    auto getWorkerId = [&](SWR_CONTEXT* pContext)
+    {
+        return (poolWorkerId + poolSize - pContext->sharedPoolBaseWorker) % poolSize;
+    };
+
+    auto contextHasWork = [&](SWR_CONTEXT* pContext)
+    {
+        uint32_t workerId = getWorkerId(pContext);
+        return workerId < pContext->NumWorkerThreads &&
+            pContext->pSharedWorkerState[workerId].curDrawBE != pContext->dcRing.GetHead();
+    };
+
+    auto anyContextHasWork = [&]()
+    {
+        for (SWR_CONTEXT* pContext : contexts)
+        {
+            if (contextHasWork(pContext))
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    while (true)
+    {
+        // Take a reference on the attached contexts so none of them goes away
+        // while this pass is looking at it.
+        {
+            std::lock_guard<std::mutex> guard(pPool->lock);
+            contexts = pPool->contexts;
+            for (SWR_CONTEXT* pContext : contexts)
+            {
+                InterlockedIncrement(&pContext->sharedPoolRefs);
+            }
+        }
+
+        bool bFoundWork = false;
+        uint32_t numContexts = (uint32_t)contexts.size();
+        for (uint32_t i = 0; i < numContexts; ++i)
+        {
+            SWR_CONTEXT* pContext = contexts[(firstContext + i) % numContexts];
+            uint32_t workerId = getWorkerId(pContext);
+            if (workerId >= pContext->NumWorkerThreads)
+            {
+                continue;
+            }
+
+            SHARED_WORKER_STATE& state = pContext->pSharedWorkerState[workerId];
+            for (uint32_t round = 0; round < pContext->threadInfo.SCHEDULING_WEIGHT; ++round)
+            {
+                if (state.curDrawBE == pContext->dcRing.GetHead())
+                {
+                    break;
+                }
+
+                bFoundWork = true;
+
+                AR_BEGIN(WorkerWorkOnFifoBE, 0);
+                WorkOnFifoBE(pContext, workerId, state.curDrawBE, state.lockedTiles, numaNode, numaMask);
+                AR_END(WorkerWorkOnFifoBE, 0);
+
+                WorkOnCompute(pContext, workerId, state.curDrawBE);
+
+                WorkOnFifoFE(pContext, workerId, state.curDrawFE);
+            }
+        }
+        ++firstContext;
+
+        if (!bFoundWork)
+        {
+            uint32_t loop = 0;
+            while (loop++ < KNOB_WORKER_SPIN_LOOP_COUNT && !anyContextHasWork())
+            {
+                _mm_pause();
+            }
+        }
+
+        for (SWR_CONTEXT* pContext : contexts)
+        {
+            InterlockedDecrement(&pContext->sharedPoolRefs);
+        }
+
+        if (!bFoundWork)
+        {
+            std::unique_lock<std::mutex> lock(pPool->lock);
+
+            // Attached contexts can't be destroyed while we hold the pool lock, so
+            // check for work again under lock before going to sleep.
+            contexts = pPool->contexts;
+            if (!anyContextHasWork())
+            {
+                pPool->workAvailable.wait(lock);
+            }
+        }
+    }
+
+    return 0;
+}
+
+DWORD sharedWorkerThreadInit(LPVOID pData)
+{
+#if defined(_WIN32)
+    __try
+#endif // _WIN32
+    {
+        return sharedWorkerThreadMain(pData);
+    }
+
+#if defined(_WIN32)
+    __except(EXCEPTION_CONTINUE_SEARCH)
+    {
+    }
+
+#endif // _WIN32
+
+    return 1;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Sizes a thread pool from the processor topology and fills in its
+///        per-thread binding data. Doesn't launch threads.
+/// @param threadInfo - topology limits, SINGLE_THREADED may be set on return.
 /// @param pPool - pointer to thread pool object.
-void CreateThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
+/// @param pContext - context the workers are bound to, nullptr for the shared pool.
+/// @return number of worker threads.
+static uint32_t InitThreadPoolData(SWR_THREADING_INFO& threadInfo, THREAD_POOL* pPool, SWR_CONTEXT* pContext)
 {
-    bindThread(pContext, 0);
+    bindThread(threadInfo, 0);
 
     CPUNumaNodes nodes;
     uint32_t numThreadsPerProcGroup = 0;
@@ -854,23 +1191,23 @@ void CreateThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
     uint32_t numCoresPerNode    = numHWCoresPerNode;
     uint32_t numHyperThreads    = numHWHyperThreads;
 
-    if (pContext->threadInfo.MAX_NUMA_NODES)
+    if (threadInfo.MAX_NUMA_NODES)
     {
-        numNodes = std::min(numNodes, pContext->threadInfo.MAX_NUMA_NODES);
+        numNodes = std::min(numNodes, threadInfo.MAX_NUMA_NODES);
     }
 
-    if (pContext->threadInfo.MAX_CORES_PER_NUMA_NODE)
+    if (threadInfo.MAX_CORES_PER_NUMA_NODE)
     {
-        numCoresPerNode = std::min(numCoresPerNode, pContext->threadInfo.MAX_CORES_PER_NUMA_NODE);
+        numCoresPerNode = std::min(numCoresPerNode, threadInfo.MAX_CORES_PER_NUMA_NODE);
     }
 
-    if (pContext->threadInfo.MAX_THREADS_PER_CORE)
+    if (threadInfo.MAX_THREADS_PER_CORE)
     {
-        numHyperThreads = std::min(numHyperThreads, pContext->threadInfo.MAX_THREADS_PER_CORE);
+        numHyperThreads = std::min(numHyperThreads, threadInfo.MAX_THREADS_PER_CORE);
     }
 
 #if defined(_WIN32) && !defined(_WIN64)
-    if (!pContext->threadInfo.MAX_WORKER_THREADS)
+    if (!threadInfo.MAX_WORKER_THREADS)
     {
         // Limit 32-bit windows to bindable HW threads only
         if ((numCoresPerNode * numHWHyperThreads) > 32)
@@ -884,10 +1221,10 @@ void CreateThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
     uint32_t numThreads = numNodes * numCoresPerNode * numHyperThreads;
     numThreads = std::min(numThreads, numHWThreads);
 
-    if (pContext->threadInfo.MAX_WORKER_THREADS)
+    if (threadInfo.MAX_WORKER_THREADS)
     {
         uint32_t maxHWThreads = numHWNodes * numHWCoresPerNode * numHWHyperThreads;
-        numThreads = std::min(pContext->threadInfo.MAX_WORKER_THREADS, maxHWThreads);
+        numThreads = std::min(threadInfo.MAX_WORKER_THREADS, maxHWThreads);
     }
 
     uint32_t numAPIReservedThreads = 1;
@@ -911,7 +1248,7 @@ void CreateThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
         }
         else
         {
-            pContext->threadInfo.SINGLE_THREADED = true;
+            threadInfo.SINGLE_THREADED = true;
         }
     }
     else
@@ -927,37 +1264,21 @@ void CreateThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
         }
     }
 
-    if (pContext->threadInfo.SINGLE_THREADED)
-    {
-        numThreads = 1;
-    }
-
-    // Initialize DRAW_CONTEXT's per-thread stats
-    for (uint32_t dc = 0; dc < KNOB_MAX_DRAWS_IN_FLIGHT; ++dc)
+    if (threadInfo.SINGLE_THREADED)
     {
-        pContext->dcRing[dc].dynState.pStats = new SWR_STATS[numThreads];
-        memset(pContext->dcRing[dc].dynState.pStats, 0, sizeof(SWR_STATS) * numThreads);
-    }
-
-    if (pContext->threadInfo.SINGLE_THREADED)
-    {
-        pContext->NumWorkerThreads = 1;
-        pContext->NumFEThreads = 1;
-        pContext->NumBEThreads = 1;
         pPool->numThreads = 0;
 
-        return;
+        return 1;
     }
 
     pPool->numThreads = numThreads;
-    pContext->NumWorkerThreads = pPool->numThreads;
 
     pPool->pThreadData = (THREAD_DATA *)malloc(pPool->numThreads * sizeof(THREAD_DATA));
     pPool->numaMask = 0;
 
     pPool->pThreads = new THREAD_PTR[pPool->numThreads];
 
-    if (pContext->threadInfo.MAX_WORKER_THREADS)
+    if (threadInfo.MAX_WORKER_THREADS)
     {
         bool bForceBindProcGroup = (numThreads > numThreadsPerProcGroup);
         uint32_t numProcGroups = (numThreads + numThreadsPerProcGroup - 1) / numThreadsPerProcGroup;
@@ -972,10 +1293,8 @@ void CreateThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
             pPool->pThreadData[workerId].coreId = 0;
             pPool->pThreadData[workerId].htId = 0;
             pPool->pThreadData[workerId].pContext = pContext;
+            pPool->pThreadData[workerId].pSharedPool = nullptr;
             pPool->pThreadData[workerId].forceBindProcGroup = bForceBindProcGroup;
-
-            pContext->NumBEThreads++;
-            pContext->NumFEThreads++;
         }
     }
     else
@@ -1017,16 +1336,158 @@ void CreateThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
                     pPool->pThreadData[workerId].coreId = c;
                     pPool->pThreadData[workerId].htId = t;
                     pPool->pThreadData[workerId].pContext = pContext;
-
-                    pContext->NumBEThreads++;
-                    pContext->NumFEThreads++;
+                    pPool->pThreadData[workerId].pSharedPool = nullptr;
+                    pPool->pThreadData[workerId].forceBindProcGroup = false;
 
                     ++workerId;
                 }
             }
         }
-        SWR_ASSERT(workerId == pContext->NumWorkerThreads);
+        SWR_ASSERT(workerId == numThreads);
+    }
+
+    return numThreads;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Attaches a context to the process-wide thread pool, creating the
+///        pool on first use. The pool lives until the process exits.
+/// @param pContext - pointer to context
+/// @return number of pool workers serving the context, 0 if the machine is
+///         too small for a worker pool.
+static uint32_t AttachSharedThreadPool(SWR_CONTEXT* pContext)
+{
+    static std::mutex sPoolCreateLock;
+    static SHARED_THREAD_POOL* spSharedPool = nullptr;
+
+    {
+        std::lock_guard<std::mutex> guard(sPoolCreateLock);
+        if (spSharedPool == nullptr)
+        {
+            SHARED_THREAD_POOL* pPool = new SHARED_THREAD_POOL();
+
+            // The pool is sized for the whole machine, MAX_WORKER_THREADS only caps
+            // the number of pool workers a single context uses.
+            pPool->threadInfo = pContext->threadInfo;
+            pPool->threadInfo.MAX_WORKER_THREADS = 0;
+            InitThreadPoolData(pPool->threadInfo, &pPool->threadPool, nullptr);
+
+            uint32_t numThreads = pPool->threadPool.numThreads;
+            pPool->threadPool.pThreads = numThreads ? new THREAD_PTR[numThreads] : nullptr;
+            for (uint32_t workerId = 0; workerId < numThreads; ++workerId)
+            {
+                pPool->threadPool.pThreadData[workerId].pSharedPool = pPool;
+                pPool->threadPool.pThreads[workerId] = new std::thread(sharedWorkerThreadInit, &pPool->threadPool.pThreadData[workerId]);
+            }
+
+            spSharedPool = pPool;
+        }
+    }
+
+    SHARED_THREAD_POOL* pPool = spSharedPool;
+    uint32_t poolSize = pPool->threadPool.numThreads;
+    if (poolSize == 0)
+    {
+        return 0;
+    }
+
+    uint32_t numThreads = poolSize;
+    if (pContext->threadInfo.MAX_WORKER_THREADS)
+    {
+        numThreads = std::min(pContext->threadInfo.MAX_WORKER_THREADS, poolSize);
+    }
+
+    if (pContext->threadInfo.SCHEDULING_WEIGHT == 0)
+    {
+        pContext->threadInfo.SCHEDULING_WEIGHT = 1;
+    }
+
+    pContext->pSharedWorkerState = new SHARED_WORKER_STATE[numThreads];
+    pContext->threadPool.numaMask = pPool->threadPool.numaMask;
+
+    std::lock_guard<std::mutex> guard(pPool->lock);
+
+    // Hand out consecutive worker windows so capped contexts spread over the pool.
+    pContext->sharedPoolBaseWorker = pPool->nextBaseWorker;
+    pPool->nextBaseWorker = (pPool->nextBaseWorker + numThreads) % poolSize;
+
+    pContext->NumWorkerThreads = numThreads;
+    pContext->pSharedPool = pPool;
+    pPool->contexts.push_back(pContext);
+
+    return numThreads;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Detaches an idle context from the shared thread pool.
+/// @param pContext - pointer to context
+static void DetachSharedThreadPool(SWR_CONTEXT* pContext)
+{
+    SHARED_THREAD_POOL* pPool = pContext->pSharedPool;
+
+    {
+        std::lock_guard<std::mutex> guard(pPool->lock);
+        auto it = std::find(pPool->contexts.begin(), pPool->contexts.end(), pContext);
+        SWR_ASSERT(it != pPool->contexts.end());
+        pPool->contexts.erase(it);
+    }
+
+    // Wait for workers that picked the context up before it was detached.
+    while (pContext->sharedPoolRefs)
+    {
+        _mm_pause();
+    }
+
+    delete[] pContext->pSharedWorkerState;
+    pContext->pSharedWorkerState = nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Creates thread pool info but doesn't launch threads.
+/// @param pContext - pointer to context
+/// @param pPool - pointer to thread pool object.
+void CreateThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
+{
+    uint32_t numThreads = 0;
+
+    if (pContext->threadInfo.SHARED_THREAD_POOL && !pContext->threadInfo.SINGLE_THREADED)
+    {
+        pPool->numThreads = 0;
+        numThreads = AttachSharedThreadPool(pContext);
+        if (numThreads == 0)
+        {
+            pContext->threadInfo.SINGLE_THREADED = true;
+            numThreads = 1;
+        }
+    }
+    else
+    {
+        numThreads = InitThreadPoolData(pContext->threadInfo, pPool, pContext);
     }
+
+    // Initialize DRAW_CONTEXT's per-thread stats
+    for (uint32_t dc = 0; dc < KNOB_MAX_DRAWS_IN_FLIGHT; ++dc)
+    {
+        pContext->dcRing[dc].dynState.pStats = new SWR_STATS[numThreads];
+        memset(pContext->dcRing[dc].dynState.pStats, 0, sizeof(SWR_STATS) * numThreads);
+    }
+
+    if (pContext->threadInfo.SINGLE_THREADED)
+    {
+        pContext->NumWorkerThreads = 1;
+        pContext->NumFEThreads = 1;
+        pContext->NumBEThreads = 1;
+
+        return;
+    }
+
+    pContext->NumWorkerThreads = numThreads;
+    pContext->NumFEThreads = numThreads;
+    pContext->NumBEThreads = numThreads;
+
+    pContext->workerSpinLimit = KNOB_WORKER_SPIN_LOOP_COUNT;
+    pContext->maxSpinningWorkers = KNOB_WORKER_MAX_SPINNING_THREADS ?
+        KNOB_WORKER_MAX_SPINNING_THREADS : std::max<uint32_t>(numThreads / 4, 1);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -1035,7 +1496,7 @@ void CreateThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
 /// @param pPool - pointer to thread pool object.
 void StartThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool)
 {
-    if (pContext->threadInfo.SINGLE_THREADED)
+    if (pContext->threadInfo.SINGLE_THREADED || pContext->pSharedPool)
     {
         return;
     }
@@ -1057,6 +1518,12 @@ void DestroyThreadPool(SWR_CONTEXT *pContext, THREAD_POOL *pPool)
         // Wait for all threads to finish
         SwrWaitForIdle(pContext);
 
+        if (pContext->pSharedPool)
+        {
+            DetachSharedThreadPool(pContext);
+            return;
+        }
+
         // Wait for threads to finish and destroy them
         for (uint32_t t = 0; t < pPool->numThreads; ++t)
         {
@@ -28,13 +28,18 @@
 #pragma once
 
 #include "knobs.h"
+#include "core/api.h"
 
 #include <unordered_set>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 typedef std::thread* THREAD_PTR;
 
 struct SWR_CONTEXT;
 struct DRAW_CONTEXT;
+struct SHARED_THREAD_POOL;
 
 struct THREAD_DATA
 {
@@ -45,6 +50,7 @@ struct THREAD_DATA
     uint32_t htId;          // Hyperthread id
     uint32_t workerId;
     SWR_CONTEXT *pContext;
+    SHARED_THREAD_POOL *pSharedPool; // Set for workers of the shared thread pool
     bool forceBindProcGroup; // Only useful when MAX_WORKER_THREADS is set.
 };
 
@@ -59,6 +65,29 @@ struct THREAD_POOL
 
 typedef std::unordered_set<uint32_t> TileSet;
 
+//////////////////////////////////////////////////////////////////////////
+/// SHARED_WORKER_STATE - progress of one shared pool worker through the
+/// draw ring of one context. Only touched by that worker.
+struct SHARED_WORKER_STATE
+{
+    uint32_t curDrawFE = 0;
+    uint32_t curDrawBE = 0;
+    TileSet lockedTiles;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// SHARED_THREAD_POOL - process-wide worker threads that service every
+/// context created with SHARED_THREAD_POOL.
+struct SHARED_THREAD_POOL
+{
+    THREAD_POOL threadPool;
+    SWR_THREADING_INFO threadInfo;          // Topology limits the pool was created with
+    std::mutex lock;                        // Guards contexts and sleeping workers
+    std::condition_variable workAvailable;
+    std::vector<SWR_CONTEXT*> contexts;
+    uint32_t nextBaseWorker = 0;            // First pool worker of the next attached context
+};
+
 void CreateThreadPool(SWR_CONTEXT *pContext, THREAD_POOL *pPool);
 void StartThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool);
 void DestroyThreadPool(SWR_CONTEXT *pContext, THREAD_POOL *pPool);
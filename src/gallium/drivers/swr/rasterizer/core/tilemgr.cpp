@@ -104,6 +104,7 @@ HOTTILE* HotTileMgr::GetHotTile(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32
             hotTile.state = HOTTILE_INVALID;
             hotTile.numSamples = numSamples;
             hotTile.renderTargetArrayIndex = renderTargetArrayIndex;
+            AllocMaxZ(hotTile, attachment);
         }
         else
         {
@@ -170,6 +171,11 @@ HOTTILE* HotTileMgr::GetHotTile(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32
             pContext->pfnLoadTile(GetPrivateState(pDC), format, attachment,
                 x * KNOB_MACROTILE_X_DIM, y * KNOB_MACROTILE_Y_DIM, renderTargetArrayIndex, hotTile.pBuffer);
 
+            if (attachment == SWR_ATTACHMENT_DEPTH)
+            {
+                UpdateDepthHotTileMaxZ(&hotTile);
+            }
+
             hotTile.renderTargetArrayIndex = renderTargetArrayIndex;
             hotTile.state = HOTTILE_DIRTY;
         }
@@ -198,6 +204,7 @@ HOTTILE* HotTileMgr::GetHotTileNoLoad(
             hotTile.state = HOTTILE_INVALID;
             hotTile.numSamples = numSamples;
             hotTile.renderTargetArrayIndex = 0;
+            AllocMaxZ(hotTile, attachment);
         }
         else
         {
@@ -263,6 +270,14 @@ void HotTileMgr::ClearDepthHotTile(const HOTTILE* pHotTile)  // clear a macro ti
             }
         }
     }
+
+    if (pHotTile->pMaxZ)
+    {
+        for (uint32_t i = 0; i < KNOB_MACROTILE_X_DIM_IN_TILES * KNOB_MACROTILE_Y_DIM_IN_TILES; ++i)
+        {
+            pHotTile->pMaxZ[i] = pClearData[0];
+        }
+    }
 }
 
 void HotTileMgr::ClearStencilHotTile(const HOTTILE* pHotTile)
@@ -341,6 +356,14 @@ void HotTileMgr::ClearDepthHotTile(const HOTTILE* pHotTile)  // clear a macro ti
             }
         }
     }
+
+    if (pHotTile->pMaxZ)
+    {
+        for (uint32_t i = 0; i < KNOB_MACROTILE_X_DIM_IN_TILES * KNOB_MACROTILE_Y_DIM_IN_TILES; ++i)
+        {
+            pHotTile->pMaxZ[i] = pClearData[0];
+        }
+    }
 }
 
 void HotTileMgr::ClearStencilHotTile(const HOTTILE* pHotTile)
@@ -368,6 +391,26 @@ void HotTileMgr::ClearStencilHotTile(const HOTTILE* pHotTile)
 }
 
 #endif
+//////////////////////////////////////////////////////////////////////////
+/// @brief Recomputes the per raster tile max depth of a depth hot tile
+/// after its contents were replaced by something other than a full clear.
+void HotTileMgr::UpdateDepthHotTileMaxZ(const HOTTILE* pHotTile)
+{
+    if (pHotTile->pMaxZ == nullptr)
+    {
+        return;
+    }
+
+    const uint32_t rasterTileBytes = KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * pHotTile->numSamples * FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp / 8;
+    const uint8_t *pBuf = pHotTile->pBuffer;
+
+    for (uint32_t i = 0; i < KNOB_MACROTILE_X_DIM_IN_TILES * KNOB_MACROTILE_Y_DIM_IN_TILES; ++i)
+    {
+        pHotTile->pMaxZ[i] = ComputeRasterTileMaxZ(pBuf, pHotTile->numSamples);
+        pBuf += rasterTileBytes;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief InitializeHotTiles
 /// for draw calls, we initialize the active hot tiles and perform deferred
@@ -422,6 +465,7 @@ void HotTileMgr::InitializeHotTiles(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, ui
             AR_BEGIN(BELoadTiles, pDC->drawId);
             // invalid hottile before draw requires a load from surface before we can draw to it
             pContext->pfnLoadTile(GetPrivateState(pDC), KNOB_DEPTH_HOT_TILE_FORMAT, SWR_ATTACHMENT_DEPTH, x, y, pHotTile->renderTargetArrayIndex, pHotTile->pBuffer);
+            UpdateDepthHotTileMaxZ(pHotTile);
             pHotTile->state = HOTTILE_DIRTY;
             AR_END(BELoadTiles, 0);
         }
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <set>
+#include <limits>
 #include <unordered_map>
 #include "common/formats.h"
 #include "fifo.hpp"
@@ -260,6 +261,7 @@ struct HOTTILE
     DWORD clearData[4];                 // May need to change based on pfnClearTile implementation.  Reorder for alignment?
     uint32_t numSamples;
     uint32_t renderTargetArrayIndex;    // current render target array index loaded
+    float *pMaxZ;                       // depth only: max depth of each raster tile, used for HiZ culling
 };
 
 union HotTileSet
@@ -298,6 +300,10 @@ public:
                 for (int a = 0; a < SWR_NUM_ATTACHMENTS; ++a)
                 {
                     FreeHotTileMem(mHotTiles[x][y].Attachment[a].pBuffer);
+                    if (mHotTiles[x][y].Attachment[a].pMaxZ)
+                    {
+                        AlignedFree(mHotTiles[x][y].Attachment[a].pMaxZ);
+                    }
                 }
             }
         }
@@ -313,11 +319,34 @@ public:
     static void ClearColorHotTile(const HOTTILE* pHotTile);
     static void ClearDepthHotTile(const HOTTILE* pHotTile);
     static void ClearStencilHotTile(const HOTTILE* pHotTile);
+    static void UpdateDepthHotTileMaxZ(const HOTTILE* pHotTile);
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Frees the memory of a hottile that is in sync with its surface.
+    ///        The next GetHotTile allocates it again and reloads the surface.
+    void ReleaseHotTile(HOTTILE* pHotTile)
+    {
+        FreeHotTileMem(pHotTile->pBuffer);
+        pHotTile->pBuffer = nullptr;
+        pHotTile->state = HOTTILE_INVALID;
+    }
 
 private:
     HotTileSet mHotTiles[KNOB_NUM_HOT_TILES_X][KNOB_NUM_HOT_TILES_Y];
     uint32_t mHotTileSize[SWR_NUM_ATTACHMENTS];
 
+    void AllocMaxZ(HOTTILE& hotTile, SWR_RENDERTARGET_ATTACHMENT attachment)
+    {
+        if (attachment == SWR_ATTACHMENT_DEPTH && hotTile.pMaxZ == nullptr)
+        {
+            hotTile.pMaxZ = (float*)AlignedMalloc(KNOB_MACROTILE_X_DIM_IN_TILES * KNOB_MACROTILE_Y_DIM_IN_TILES * sizeof(float), 64);
+            for (uint32_t i = 0; i < KNOB_MACROTILE_X_DIM_IN_TILES * KNOB_MACROTILE_Y_DIM_IN_TILES; ++i)
+            {
+                hotTile.pMaxZ[i] = std::numeric_limits<float>::infinity();
+            }
+        }
+    }
+
     void* AllocHotTileMem(size_t size, uint32_t align, uint32_t numaNode)
     {
         void* p = nullptr;
@@ -344,3 +373,29 @@ private:
     }
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns the max depth of a depth hot tile raster tile.
+/// @param pDepth - pointer to the raster tile in the depth hot tile
+/// @param numSamples - number of samples per pixel
+INLINE float ComputeRasterTileMaxZ(const uint8_t* pDepth, uint32_t numSamples)
+{
+    static_assert(KNOB_DEPTH_HOT_TILE_FORMAT == R32_FLOAT, "Unsupported depth hot tile format");
+
+    const float* pZ = (const float*)pDepth;
+    simdscalar vMaxZ = _simd_load_ps(pZ);
+    for (uint32_t i = KNOB_SIMD_WIDTH; i < KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * numSamples; i += KNOB_SIMD_WIDTH)
+    {
+        vMaxZ = _simd_max_ps(vMaxZ, _simd_load_ps(pZ + i));
+    }
+
+    OSALIGNSIMD(float) maxZ[KNOB_SIMD_WIDTH];
+    _simd_store_ps(maxZ, vMaxZ);
+
+    float result = maxZ[0];
+    for (uint32_t i = 1; i < KNOB_SIMD_WIDTH; ++i)
+    {
+        result = std::max(result, maxZ[i]);
+    }
+    return result;
+}
+
@@ -44,6 +44,8 @@
 #include "llvm/IR/Function.h"
 
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
 
 #include "llvm/Analysis/CFGPrinter.h"
@@ -61,6 +63,8 @@
 
 #include "state_llvm.h"
 
+#include <cctype>
+#include <mutex>
 #include <sstream>
 #if defined(_WIN32)
 #include <psapi.h>
@@ -123,6 +127,7 @@ JitManager::JitManager(uint32_t simdWidth, const char *arch, const char* core)
 #endif // _WIN32
 
     mpExec = EB.create();
+    mpExec->setObjectCache(&mCache);
 
 #if LLVM_USE_INTEL_JITEVENTS
     JITEventListener *vTune = JITEventListener::createIntelJITEventListener();
@@ -190,6 +195,73 @@ void JitManager::SetupNewModule()
     mIsModuleFinalized = false;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief JITs the function of the current module and finalizes the module.
+///        The function is renamed after the hash of the module IR, so code
+///        generated earlier by this manager for the same IR is returned
+///        without compiling again, and MCJIT can find the object of an
+///        identical module in the JitCache.
+/// @param pFunction - function of the current module
+/// @return address of the function code
+void* JitManager::FinalizeFunction(Function* pFunction)
+{
+    SWR_ASSERT(pFunction->getParent() == mpCurrentModule);
+
+    // The generated names carry a per process counter; strip it from the hashed IR.
+    std::string baseName = pFunction->getName().str();
+    while (!baseName.empty() && isdigit(baseName.back()))
+    {
+        baseName.pop_back();
+    }
+
+    pFunction->setName(baseName);
+    mpCurrentModule->setModuleIdentifier(baseName);
+#if HAVE_LLVM >= 0x309
+    mpCurrentModule->setSourceFileName(baseName);
+#endif
+
+    std::string ir;
+    raw_string_ostream irStream(ir);
+    irStream << LLVM_VERSION_MAJOR << "." << LLVM_VERSION_MINOR << ";"
+             << mpExec->getTargetMachine()->getTargetCPU() << ";"
+             << mpExec->getTargetMachine()->getTargetFeatureString() << "\n";
+    mpCurrentModule->print(irStream, nullptr);
+    irStream.flush();
+
+    MD5 hash;
+    hash.update(ir);
+    MD5::MD5Result result;
+    hash.final(result);
+    SmallString<32> hashStr;
+    MD5::stringifyResult(result, hashStr);
+
+    std::string name = baseName + "_" + hashStr.str().str();
+    pFunction->setName(name);
+    mpCurrentModule->setModuleIdentifier(name);
+
+    void* pCode;
+    auto it = mJitFunctions.find(name);
+    if (it != mJitFunctions.end())
+    {
+        // Identical code already JIT'ed, drop the module.
+        pCode = it->second;
+        Module* pModule = mpCurrentModule;
+        mpExec->removeModule(pModule);
+        delete pModule;
+        mpCurrentModule = nullptr;
+    }
+    else
+    {
+        pCode = (void*)mpExec->getFunctionAddress(name);
+        mJitFunctions[name] = pCode;
+    }
+
+    // MCJIT finalizes modules the first time you JIT code from them. After finalized, you cannot add new IR to the module
+    mIsModuleFinalized = true;
+
+    return pCode;
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Create new LLVM module from IR.
 bool JitManager::SetupModuleFromIR(const uint8_t *pIR)
@@ -317,6 +389,128 @@ void JitManager::DumpToFile(Function *f, const char *fileName)
     }
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// JitCache
+//////////////////////////////////////////////////////////////////////////
+
+// Process wide store of the objects compiled by all JitManagers.
+static std::mutex gJitCacheMutex;
+static std::unordered_map<std::string, std::unique_ptr<MemoryBuffer>> gJitCacheObjects;
+static size_t gJitCacheSize = 0;
+static const size_t JIT_CACHE_MAX_SIZE = 32 * 1024 * 1024;
+
+// Header of the objects in the disk mirror, guards against truncated files.
+struct JitCacheFileHeader
+{
+    char magic[8];
+    uint64_t objSize;
+};
+static const char JIT_CACHE_MAGIC[8] = { 'S', 'W', 'R', 'J', 'I', 'T', '0', '1' };
+
+JitCache::JitCache() : mCacheDir(KNOB_JIT_CACHE_DIR)
+{
+    if (!mCacheDir.empty())
+    {
+        sys::fs::create_directories(mCacheDir);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Called by MCJIT after compiling a module.
+void JitCache::notifyObjectCompiled(const Module* M, MemoryBufferRef Obj)
+{
+    const std::string& key = M->getModuleIdentifier();
+
+    {
+        std::lock_guard<std::mutex> lock(gJitCacheMutex);
+        if (gJitCacheSize + Obj.getBufferSize() <= JIT_CACHE_MAX_SIZE &&
+            gJitCacheObjects.find(key) == gJitCacheObjects.end())
+        {
+            gJitCacheObjects[key] = MemoryBuffer::getMemBufferCopy(Obj.getBuffer(), key);
+            gJitCacheSize += Obj.getBufferSize();
+        }
+    }
+
+    if (mCacheDir.empty())
+    {
+        return;
+    }
+
+    // Write to a unique file and rename it, so concurrent writers and readers
+    // never see a partial object.
+    SmallString<256> filePath(mCacheDir);
+    sys::path::append(filePath, key + ".o");
+    SmallString<256> tmpModel(filePath);
+    tmpModel += ".%%%%%%%%";
+
+    int fd;
+    SmallString<256> tmpPath;
+    if (sys::fs::createUniqueFile(tmpModel, fd, tmpPath))
+    {
+        return;
+    }
+
+    {
+        raw_fd_ostream fileStream(fd, true);
+        JitCacheFileHeader header;
+        memcpy(header.magic, JIT_CACHE_MAGIC, sizeof(header.magic));
+        header.objSize = Obj.getBufferSize();
+        fileStream.write((const char*)&header, sizeof(header));
+        fileStream << Obj.getBuffer();
+    }
+
+    if (sys::fs::rename(tmpPath, filePath))
+    {
+        sys::fs::remove(tmpPath);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Called by MCJIT before compiling a module.
+/// @return object compiled earlier from identical IR, or null to compile the module.
+std::unique_ptr<MemoryBuffer> JitCache::getObject(const Module* M)
+{
+    const std::string& key = M->getModuleIdentifier();
+
+    {
+        std::lock_guard<std::mutex> lock(gJitCacheMutex);
+        auto it = gJitCacheObjects.find(key);
+        if (it != gJitCacheObjects.end())
+        {
+            return MemoryBuffer::getMemBufferCopy(it->second->getBuffer(), key);
+        }
+    }
+
+    if (mCacheDir.empty())
+    {
+        return nullptr;
+    }
+
+    SmallString<256> filePath(mCacheDir);
+    sys::path::append(filePath, key + ".o");
+
+    auto file = MemoryBuffer::getFile(filePath);
+    if (!file)
+    {
+        return nullptr;
+    }
+
+    StringRef contents = file.get()->getBuffer();
+    JitCacheFileHeader header;
+    if (contents.size() < sizeof(header))
+    {
+        return nullptr;
+    }
+    memcpy(&header, contents.data(), sizeof(header));
+    if (memcmp(header.magic, JIT_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.objSize != contents.size() - sizeof(header))
+    {
+        return nullptr;
+    }
+
+    return MemoryBuffer::getMemBufferCopy(contents.substr(sizeof(header)), key);
+}
+
 extern "C"
 {
     bool g_DllActive = true;
@@ -59,6 +59,7 @@
 
 #include "llvm/IR/Verifier.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/Support/FileSystem.h"
 #define LLVM_F_NONE sys::fs::F_None
 
@@ -86,6 +87,9 @@ using PassManager = llvm::legacy::PassManager;
 
 #pragma pop_macro("DEBUG")
 
+#include <string>
+#include <unordered_map>
+
 //////////////////////////////////////////////////////////////////////////
 /// JitInstructionSet
 /// @brief Subclass of InstructionSet that allows users to override
@@ -139,6 +143,25 @@ struct JitLLVMContext : llvm::LLVMContext
 {
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// JitCache
+/// @brief MCJIT object cache for the fetch, blend and streamout shaders.
+/// Modules are keyed on their identifier, which JitManager sets to the
+/// hash of the module IR. Objects are kept in a process wide in memory
+/// store shared by all JitManagers and mirrored to KNOB_JIT_CACHE_DIR.
+//////////////////////////////////////////////////////////////////////////
+class JitCache : public llvm::ObjectCache
+{
+public:
+    JitCache();
+
+    void notifyObjectCompiled(const llvm::Module *M, llvm::MemoryBufferRef Obj) override;
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* M) override;
+
+private:
+    std::string mCacheDir;
+};
+
 
 //////////////////////////////////////////////////////////////////////////
 /// JitManager
@@ -179,9 +202,16 @@ struct JitManager
     JitInstructionSet mArch;
     std::string mCore;
 
+    JitCache mCache;
+
+    // Code of the functions JIT'ed by this manager, keyed on function name
+    std::unordered_map<std::string, void*> mJitFunctions;
+
     void SetupNewModule();
     bool SetupModuleFromIR(const uint8_t *pIR);
 
+    void* FinalizeFunction(llvm::Function* pFunction);
+
     void DumpAsm(llvm::Function* pFunction, const char* fileName);
     static void DumpToFile(llvm::Function *f, const char *fileName);
 };
@@ -817,12 +817,10 @@ struct BlendJit : public Builder
 /// @return PFN_FETCH_FUNC - pointer to fetch code
 PFN_BLEND_JIT_FUNC JitBlendFunc(HANDLE hJitMgr, const HANDLE hFunc)
 {
-    const llvm::Function *func = (const llvm::Function*)hFunc;
+    llvm::Function *func = (llvm::Function*)hFunc;
     JitManager* pJitMgr = reinterpret_cast<JitManager*>(hJitMgr);
     PFN_BLEND_JIT_FUNC pfnBlend;
-    pfnBlend = (PFN_BLEND_JIT_FUNC)(pJitMgr->mpExec->getFunctionAddress(func->getName().str()));
-    // MCJIT finalizes modules the first time you JIT code from them. After finalized, you cannot add new IR to the module
-    pJitMgr->mIsModuleFinalized = true;
+    pfnBlend = (PFN_BLEND_JIT_FUNC)pJitMgr->FinalizeFunction(func);
 
     return pfnBlend;
 }
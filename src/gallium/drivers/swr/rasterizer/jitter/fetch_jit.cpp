@@ -1701,18 +1701,20 @@ bool isComponentEnabled(ComponentEnable enableMask, uint8_t component)
 /// @return PFN_FETCH_FUNC - pointer to fetch code
 PFN_FETCH_FUNC JitFetchFunc(HANDLE hJitMgr, const HANDLE hFunc)
 {
-    const llvm::Function* func = (const llvm::Function*)hFunc;
+    llvm::Function* func = (llvm::Function*)hFunc;
     JitManager* pJitMgr = reinterpret_cast<JitManager*>(hJitMgr);
     PFN_FETCH_FUNC pfnFetch;
 
-    pfnFetch = (PFN_FETCH_FUNC)(pJitMgr->mpExec->getFunctionAddress(func->getName().str()));
-    // MCJIT finalizes modules the first time you JIT code from them. After finalized, you cannot add new IR to the module
-    pJitMgr->mIsModuleFinalized = true;
+#if defined(KNOB_SWRC_TRACING)
+    // the function may be dropped when finalizing it
+    std::string funcName = func->getName().str();
+#endif
+
+    pfnFetch = (PFN_FETCH_FUNC)pJitMgr->FinalizeFunction(func);
 
 #if defined(KNOB_SWRC_TRACING)
     char fName[1024];
-    const char *funcName = func->getName().data();
-    sprintf(fName, "%s.bin", funcName);
+    sprintf(fName, "%s.bin", funcName.c_str());
     FILE *fd = fopen(fName, "wb");
     fwrite((void *)pfnFetch, 1, 2048, fd);
     fclose(fd);
@@ -109,6 +109,56 @@ struct StoreRasterTileClear
 template<SWR_FORMAT SrcFormat, SWR_FORMAT DstFormat>
 struct StoreMacroTileClear
 {
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Fills a macro tile of a linear surface row by row with 16 byte
+    ///        stores of the replicated clear pixel.
+    /// @param dstFormattedColor - clear pixel in the destination format.
+    /// @param dstBytesPerPixel - size of the pixel, power of 2 up to 16.
+    /// @param pDstSurface - Destination surface state
+    /// @param x, y - Coordinates to macro tile
+    INLINE static void StoreClearLinear(
+        const uint8_t* dstFormattedColor,
+        UINT dstBytesPerPixel,
+        SWR_SURFACE_STATE* pDstSurface,
+        UINT x, UINT y, uint32_t renderTargetArrayIndex)
+    {
+        uint32_t lodWidth = std::max<uint32_t>(pDstSurface->width >> pDstSurface->lod, 1U);
+        uint32_t lodHeight = std::max<uint32_t>(pDstSurface->height >> pDstSurface->lod, 1U);
+        if (x >= lodWidth || y >= lodHeight)
+            return;
+
+        OSALIGNSIMD(uint8_t) pattern[16];
+        for (UINT i = 0; i < sizeof(pattern); i += dstBytesPerPixel)
+        {
+            memcpy(&pattern[i], dstFormattedColor, dstBytesPerPixel);
+        }
+        __m128i vPattern = _mm_load_si128((const __m128i*)pattern);
+
+        UINT rowBytes = std::min<uint32_t>(KNOB_MACROTILE_X_DIM, lodWidth - x) * dstBytesPerPixel;
+        UINT numRows = std::min<uint32_t>(KNOB_MACROTILE_Y_DIM, lodHeight - y);
+
+        uint8_t* pRow = (uint8_t*)ComputeSurfaceAddress<false, false>(
+                x, y, pDstSurface->arrayIndex + renderTargetArrayIndex,
+                pDstSurface->arrayIndex + renderTargetArrayIndex,
+                0, // sampleNum
+                pDstSurface->lod,
+                pDstSurface);
+
+        for (UINT row = 0; row < numRows; ++row)
+        {
+            UINT offset = 0;
+            for (; offset + sizeof(pattern) <= rowBytes; offset += sizeof(pattern))
+            {
+                _mm_storeu_si128((__m128i*)(pRow + offset), vPattern);
+            }
+
+            // Row starts on a pixel boundary, so the pattern is still in phase for the tail.
+            memcpy(pRow + offset, pattern, rowBytes - offset);
+
+            pRow += pDstSurface->pitch;
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     /// @brief Stores a macrotile to the destination surface.
     /// @param pColor - Pointer to color to write to pixels.
@@ -133,6 +183,13 @@ struct StoreMacroTileClear
         // using this helper function, but the Tiling Traits is unused inside it so just using a dummy value
         ConvertPixelFromFloat<DstFormat>(dstFormattedColor, srcColor);
 
+        // Linear surfaces with power of 2 pixel sizes are filled a whole macro tile row at a time.
+        if (pDstSurface->tileMode == SWR_TILE_NONE && IsPow2(dstBytesPerPixel) && dstBytesPerPixel <= 16)
+        {
+            StoreClearLinear(dstFormattedColor, dstBytesPerPixel, pDstSurface, x, y, renderTargetArrayIndex);
+            return;
+        }
+
         // Store each raster tile from the hot tile to the destination surface.
         // TODO:  Put in check for partial coverage on x/y -- SWR_ASSERT if it happens.
         //        Intent is for this function to only handle full tiles.
@@ -152,7 +209,9 @@ struct StoreMacroTileClear
 /// @param renderTargetIndex - Index to destination render target
 /// @param x, y - Coordinates to raster tile.
 /// @param pClearColor - Pointer to clear color
-void StoreHotTileClear(
+/// @return false if the surface can't be cleared directly, in which case the
+///         caller has to clear the hot tile and store it instead.
+bool StoreHotTileClear(
     SWR_SURFACE_STATE *pDstSurface,
     SWR_RENDERTARGET_ATTACHMENT renderTargetIndex,
     UINT x,
@@ -162,6 +221,12 @@ void StoreHotTileClear(
 {
     PFN_STORE_TILES_CLEAR pfnStoreTilesClear = NULL;
 
+    // Only sample 0 is written.
+    if (pDstSurface->numSamples > 1)
+    {
+        return false;
+    }
+
     if (renderTargetIndex == SWR_ATTACHMENT_STENCIL)
     {
         SWR_ASSERT(pDstSurface->format == R8_UINT);
@@ -176,14 +241,16 @@ void StoreHotTileClear(
         pfnStoreTilesClear = sStoreTilesClearColorTable[pDstSurface->format];
     }
 
-    SWR_ASSERT(pfnStoreTilesClear != NULL);
-
-    // Store a macro tile.
-    /// @todo Once all formats are supported then if check can go away. This is to help us near term to make progress.
-    if (pfnStoreTilesClear != NULL)
+    // Not all formats have a clear function (e.g. depth/stencil combinations).
+    if (pfnStoreTilesClear == NULL)
     {
-        pfnStoreTilesClear(pClearColor, pDstSurface, x, y, renderTargetArrayIndex);
+        return false;
     }
+
+    // Store a macro tile.
+    pfnStoreTilesClear(pClearColor, pDstSurface, x, y, renderTargetArrayIndex);
+
+    return true;
 }
 
 //////////////////////////////////////////////////////////////////////////
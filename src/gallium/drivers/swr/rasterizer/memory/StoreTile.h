@@ -1351,6 +1351,20 @@ struct OptStoreRasterTile< TilingTraits<SWR_TILE_NONE, 32>, SrcFormat, DstFormat
 
         uint8_t *pDst = (uint8_t*)ComputeSurfaceAddress<false, false>(x, y, pDstSurface->arrayIndex + renderTargetArrayIndex,
             pDstSurface->arrayIndex + renderTargetArrayIndex, sampleNum, pDstSurface->lod, pDstSurface);
+
+        StoreFullTile(pSrc, pDstSurface, pDst);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Stores a complete 8x8 raster tile without bounds checking.
+    /// @param pSrc - Pointer to raster tile.
+    /// @param pDstSurface - Destination surface state
+    /// @param pDst - Destination address of the raster tile's first pixel.
+    INLINE static void StoreFullTile(
+        uint8_t *pSrc,
+        SWR_SURFACE_STATE* pDstSurface,
+        uint8_t *pDst)
+    {
 #if USE_8x2_TILE_BACKEND
 
         const uint32_t dx = SIMD16_TILE_X_DIM * DST_BYTES_PER_PIXEL;
@@ -1984,9 +1998,6 @@ struct OptStoreRasterTile< TilingTraits<SWR_TILE_MODE_YMAJOR, 32>, SrcFormat, Ds
         SWR_SURFACE_STATE* pDstSurface,
         uint32_t x, uint32_t y, uint32_t sampleNum, uint32_t renderTargetArrayIndex)
     {
-        static const uint32_t DestRowWidthBytes = 16;                    // 16B rows
-        static const uint32_t DestColumnBytes = DestRowWidthBytes * 32;  // 16B x 32 rows.
-
         // Punt non-full tiles to generic store
         uint32_t lodWidth = std::max(pDstSurface->width >> pDstSurface->lod, 1U);
         uint32_t lodHeight = std::max(pDstSurface->height >> pDstSurface->lod, 1U);
@@ -1996,13 +2007,29 @@ struct OptStoreRasterTile< TilingTraits<SWR_TILE_MODE_YMAJOR, 32>, SrcFormat, Ds
             return GenericStoreTile::Store(pSrc, pDstSurface, x, y, sampleNum, renderTargetArrayIndex);
         }
 
+        uint8_t *pDst = (uint8_t*)ComputeSurfaceAddress<false, false>(x, y, pDstSurface->arrayIndex + renderTargetArrayIndex,
+            pDstSurface->arrayIndex + renderTargetArrayIndex, sampleNum, pDstSurface->lod, pDstSurface);
+
+        StoreFullTile(pSrc, pDstSurface, pDst);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Stores a complete 8x8 raster tile without bounds checking.
+    /// @param pSrc - Pointer to raster tile.
+    /// @param pDstSurface - Destination surface state
+    /// @param pDst - Destination address of the raster tile's first pixel.
+    INLINE static void StoreFullTile(
+        uint8_t *pSrc,
+        SWR_SURFACE_STATE* pDstSurface,
+        uint8_t *pDst)
+    {
+        static const uint32_t DestRowWidthBytes = 16;                    // 16B rows
+        static const uint32_t DestColumnBytes = DestRowWidthBytes * 32;  // 16B x 32 rows.
+
         // TileY is a column-major tiling mode where each 4KB tile consist of 8 columns of 32 x 16B rows.
         // We can compute the offsets to each column within the raster tile once and increment from these.
         // There will be 2 x 4-wide columns in an 8x8 raster tile.
 #if USE_8x2_TILE_BACKEND
-        uint8_t *pDst = (uint8_t*)ComputeSurfaceAddress<false, false>(x, y, pDstSurface->arrayIndex + renderTargetArrayIndex,
-            pDstSurface->arrayIndex + renderTargetArrayIndex, sampleNum, pDstSurface->lod, pDstSurface);
-
         const uint32_t dy = SIMD16_TILE_Y_DIM * DestRowWidthBytes;
 
         uint8_t *ppDsts[] = 
@@ -2026,8 +2053,7 @@ struct OptStoreRasterTile< TilingTraits<SWR_TILE_MODE_YMAJOR, 32>, SrcFormat, Ds
             ppDsts[3] += dy;
         }
 #else
-        uint8_t* pCol0 = (uint8_t*)ComputeSurfaceAddress<false, false>(x, y, pDstSurface->arrayIndex + renderTargetArrayIndex,
-            pDstSurface->arrayIndex + renderTargetArrayIndex, sampleNum, pDstSurface->lod, pDstSurface);
+        uint8_t* pCol0 = pDst;
 
         // Increment by a whole SIMD. 4x2 for AVX. 2x2 for SSE.
         uint32_t pSrcInc = (FormatTraits<SrcFormat>::bpp * KNOB_SIMD_WIDTH) / 8;
@@ -2422,6 +2448,85 @@ struct StoreMacroTile
     }
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// StoreMacroTileFull - Stores fully covered single-sampled 2D macrotiles
+/// by walking the raster tiles directly from the lod base address instead
+/// of going through a function pointer and ComputeSurfaceAddress per
+/// raster tile.  Anything else falls back to StoreMacroTile.
+/// @note TTraits must have an OptStoreRasterTile::StoreFullTile.
+//////////////////////////////////////////////////////////////////////////
+template <typename TTraits, SWR_FORMAT SrcFormat, SWR_FORMAT DstFormat>
+struct StoreMacroTileFull
+{
+    static const size_t SRC_BYTES_PER_PIXEL = FormatTraits<SrcFormat>::bpp / 8;
+    static const size_t DST_BYTES_PER_PIXEL = FormatTraits<DstFormat>::bpp / 8;
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Stores a macrotile to the destination surface.
+    /// @param pSrc - Pointer to macro tile.
+    /// @param pDstSurface - Destination surface state
+    /// @param x, y - Coordinates to macro tile
+    static void Store(
+        uint8_t *pSrcHotTile,
+        SWR_SURFACE_STATE* pDstSurface,
+        uint32_t x, uint32_t y, uint32_t renderTargetArrayIndex)
+    {
+        uint32_t lodWidth = std::max(pDstSurface->width >> pDstSurface->lod, 1U);
+        uint32_t lodHeight = std::max(pDstSurface->height >> pDstSurface->lod, 1U);
+
+        if (KNOB_USE_GENERIC_STORETILE ||
+            pDstSurface->type != SURFACE_2D ||
+            pDstSurface->numSamples > 1 ||
+            pDstSurface->bInterleavedSamples ||
+            x + KNOB_MACROTILE_X_DIM > lodWidth ||
+            y + KNOB_MACROTILE_Y_DIM > lodHeight)
+        {
+            return StoreMacroTile<TTraits, SrcFormat, DstFormat>::Store(pSrcHotTile, pDstSurface, x, y, renderTargetArrayIndex);
+        }
+
+        uint8_t *pLodBase = (uint8_t*)ComputeSurfaceAddress<false, false>(
+            0,
+            0,
+            pDstSurface->arrayIndex + renderTargetArrayIndex, // z for 3D surfaces
+            pDstSurface->arrayIndex + renderTargetArrayIndex, // array index for 2D arrays
+            0,
+            pDstSurface->lod,
+            pDstSurface);
+
+        // Offsets only swizzle independently of the lod offset when the lod starts on a tile boundary.
+        if ((pDstSurface->tileMode != SWR_TILE_NONE) && (0 != ((size_t)pLodBase & 0xfff)))
+        {
+            return StoreMacroTile<TTraits, SrcFormat, DstFormat>::Store(pSrcHotTile, pDstSurface, x, y, renderTargetArrayIndex);
+        }
+
+        for (uint32_t row = 0; row < KNOB_MACROTILE_Y_DIM; row += KNOB_TILE_Y_DIM)
+        {
+            for (uint32_t col = 0; col < KNOB_MACROTILE_X_DIM; col += KNOB_TILE_X_DIM)
+            {
+                uint8_t *pDst = pLodBase + ComputeOffset2D<TTraits>(pDstSurface->pitch, (x + col) * DST_BYTES_PER_PIXEL, y + row);
+
+                OptStoreRasterTile<TTraits, SrcFormat, DstFormat>::StoreFullTile(pSrcHotTile, pDstSurface, pDst);
+                pSrcHotTile += KNOB_TILE_X_DIM * KNOB_TILE_Y_DIM * SRC_BYTES_PER_PIXEL;
+            }
+        }
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// OptStoreMacroTile - Fast path for the 8bpc formats we resolve every
+/// frame.  Tile modes without a StoreFullTile use StoreMacroTile.
+//////////////////////////////////////////////////////////////////////////
+template <typename TTraits, SWR_FORMAT SrcFormat, SWR_FORMAT DstFormat>
+struct OptStoreMacroTile : StoreMacroTile<TTraits, SrcFormat, DstFormat> {};
+
+template <SWR_FORMAT SrcFormat, SWR_FORMAT DstFormat>
+struct OptStoreMacroTile<TilingTraits<SWR_TILE_NONE, 32>, SrcFormat, DstFormat>
+    : StoreMacroTileFull<TilingTraits<SWR_TILE_NONE, 32>, SrcFormat, DstFormat> {};
+
+template <SWR_FORMAT SrcFormat, SWR_FORMAT DstFormat>
+struct OptStoreMacroTile<TilingTraits<SWR_TILE_MODE_YMAJOR, 32>, SrcFormat, DstFormat>
+    : StoreMacroTileFull<TilingTraits<SWR_TILE_MODE_YMAJOR, 32>, SrcFormat, DstFormat> {};
+
 //////////////////////////////////////////////////////////////////////////
 /// InitStoreTilesTable - Helper for setting up the tables.
 template <SWR_TILE_MODE TTileMode, size_t NumTileModesT, size_t ArraySizeT>
@@ -2455,13 +2560,13 @@ void InitStoreTilesTableColor_Half1(
     table[TTileMode][R16G16B16A16_USCALED]          = StoreMacroTile<TilingTraits<TTileMode, 64>, R32G32B32A32_FLOAT, R16G16B16A16_USCALED>::Store;
     table[TTileMode][R32G32_SSCALED]                = StoreMacroTile<TilingTraits<TTileMode, 64>, R32G32B32A32_FLOAT, R32G32_SSCALED>::Store;
     table[TTileMode][R32G32_USCALED]                = StoreMacroTile<TilingTraits<TTileMode, 64>, R32G32B32A32_FLOAT, R32G32_USCALED>::Store;
-    table[TTileMode][B8G8R8A8_UNORM]                = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, B8G8R8A8_UNORM>::Store;
-    table[TTileMode][B8G8R8A8_UNORM_SRGB]           = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, B8G8R8A8_UNORM_SRGB>::Store;
+    table[TTileMode][B8G8R8A8_UNORM]                = OptStoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, B8G8R8A8_UNORM>::Store;
+    table[TTileMode][B8G8R8A8_UNORM_SRGB]           = OptStoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, B8G8R8A8_UNORM_SRGB>::Store;
     table[TTileMode][R10G10B10A2_UNORM]             = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R10G10B10A2_UNORM>::StoreGeneric;
     table[TTileMode][R10G10B10A2_UNORM_SRGB]        = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R10G10B10A2_UNORM_SRGB>::StoreGeneric;
     table[TTileMode][R10G10B10A2_UINT]              = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R10G10B10A2_UINT>::StoreGeneric;
-    table[TTileMode][R8G8B8A8_UNORM]                = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8A8_UNORM>::Store;
-    table[TTileMode][R8G8B8A8_UNORM_SRGB]           = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8A8_UNORM_SRGB>::Store;
+    table[TTileMode][R8G8B8A8_UNORM]                = OptStoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8A8_UNORM>::Store;
+    table[TTileMode][R8G8B8A8_UNORM_SRGB]           = OptStoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8A8_UNORM_SRGB>::Store;
     table[TTileMode][R8G8B8A8_SNORM]                = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8A8_SNORM>::Store;
     table[TTileMode][R8G8B8A8_SINT]                 = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8A8_SINT>::Store;
     table[TTileMode][R8G8B8A8_UINT]                 = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8A8_UINT>::Store;
@@ -2480,10 +2585,10 @@ void InitStoreTilesTableColor_Half1(
     table[TTileMode][R24_UNORM_X8_TYPELESS]         = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R24_UNORM_X8_TYPELESS>::StoreGeneric;
     table[TTileMode][X24_TYPELESS_G8_UINT]          = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, X24_TYPELESS_G8_UINT>::StoreGeneric;
     table[TTileMode][A32_FLOAT]                     = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, A32_FLOAT>::Store;
-    table[TTileMode][B8G8R8X8_UNORM]                = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, B8G8R8X8_UNORM>::Store;
-    table[TTileMode][B8G8R8X8_UNORM_SRGB]           = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, B8G8R8X8_UNORM_SRGB>::Store;
-    table[TTileMode][R8G8B8X8_UNORM]                = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8X8_UNORM>::Store;
-    table[TTileMode][R8G8B8X8_UNORM_SRGB]           = StoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8X8_UNORM_SRGB>::Store;
+    table[TTileMode][B8G8R8X8_UNORM]                = OptStoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, B8G8R8X8_UNORM>::Store;
+    table[TTileMode][B8G8R8X8_UNORM_SRGB]           = OptStoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, B8G8R8X8_UNORM_SRGB>::Store;
+    table[TTileMode][R8G8B8X8_UNORM]                = OptStoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8X8_UNORM>::Store;
+    table[TTileMode][R8G8B8X8_UNORM_SRGB]           = OptStoreMacroTile<TilingTraits<TTileMode, 32>, R32G32B32A32_FLOAT, R8G8B8X8_UNORM_SRGB>::Store;
 }
 
 template <SWR_TILE_MODE TTileMode, size_t NumTileModesT, size_t ArraySizeT>
@@ -61,6 +61,32 @@ KNOBS = [
         'category'  : 'perf',
     }],
 
+    ['HOT_TILE_RELEASE_ON_STORE', {
+        'type'      : 'bool',
+        'default'   : 'false',
+        'desc'      : ['Free the memory of a hottile once SwrStoreTiles has resolved it to',
+                       'its surface. Bounds resident memory with MSAA and many render',
+                       'targets, at the cost of reloading the tile if it is drawn again.'],
+        'category'  : 'perf',
+    }],
+
+    ['VERTEX_CACHE', {
+        'type'      : 'bool',
+        'default'   : 'true',
+        'desc'      : ['Shade every unique index of an indexed triangle list batch only once',
+                       'instead of once per index.'],
+        'category'  : 'perf',
+    }],
+
+    ['HIZ_CULL', {
+        'type'      : 'bool',
+        'default'   : 'true',
+        'desc'      : ['Track the max depth of each raster tile in the depth hottile and',
+                       'reject raster tiles a triangle can not pass the depth test in',
+                       'before running the backend'],
+        'category'  : 'perf',
+    }],
+
     ['MAX_NUMA_NODES', {
         'type'      : 'uint32_t',
         'default'   : '0',
@@ -123,7 +149,60 @@ KNOBS = [
         'type'      : 'uint32_t',
         'default'   : '5000',
         'desc'      : ['Number of spin-loop iterations worker threads will perform',
-                       'before going to sleep when waiting for work'],
+                       'before going to sleep when waiting for work',
+                       '',
+                       'When WORKER_ADAPTIVE_SPIN is enabled this is the upper bound',
+                       'of the adaptive spin budget.'],
+        'category'  : 'perf',
+    }],
+
+    ['SHARED_THREAD_POOL', {
+        'type'      : 'bool',
+        'default'   : 'false',
+        'desc'      : ['Schedule the work of all contexts of the process on one shared',
+                       'pool of worker threads instead of creating a pool per context.',
+                       '',
+                       'In this mode MAX_WORKER_THREADS limits how many pool workers a',
+                       'single context may use.'],
+        'category'  : 'perf',
+    }],
+
+    ['CONTEXT_SCHEDULING_WEIGHT', {
+        'type'      : 'uint32_t',
+        'default'   : '1',
+        'desc'      : ['Relative share of the shared thread pool given to a context.',
+                       'Each scheduling pass a pool worker runs up to this many rounds',
+                       'of work for the context before moving on to the next one.'],
+        'category'  : 'perf',
+    }],
+
+    ['WORKER_ADAPTIVE_SPIN', {
+        'type'      : 'bool',
+        'default'   : 'true',
+        'desc'      : ['Adapt the worker spin budget to the submit rate of the context.',
+                       'Workers stop spinning once the API thread has been quiet for',
+                       'longer than twice its recent submit interval, and the budget',
+                       'grows when spinning finds work and shrinks when it does not.'],
+        'category'  : 'perf',
+    }],
+
+    ['WORKER_MAX_SPINNING_THREADS', {
+        'type'      : 'uint32_t',
+        'default'   : '0',
+        'desc'      : ['Maximum number of idle worker threads of a context that spin',
+                       'waiting for work. Surplus idle workers go straight to sleep',
+                       'and are woken when a draw is queued.',
+                       '',
+                       '0 = one quarter of the worker threads (at least 1)'],
+        'category'  : 'perf',
+    }],
+
+    ['WORKER_STEAL_REMOTE_TILES', {
+        'type'      : 'bool',
+        'default'   : 'true',
+        'desc'      : ['Allow backend worker threads that have run out of macrotiles',
+                       'on their own NUMA-node to work on macrotiles assigned to',
+                       'other NUMA-nodes.'],
         'category'  : 'perf',
     }],
 
@@ -144,6 +223,15 @@ KNOBS = [
         'category'  : 'perf',
     }],
 
+    ['SPLIT_INSTANCED_DRAWS', {
+        'type'      : 'bool',
+        'default'   : 'true',
+        'desc'      : ['Split instanced draws into ranges of instances so that multiple',
+                       'frontend threads can work on them. Each range holds about',
+                       'MAX_PRIMS_PER_DRAW vertices.'],
+        'category'  : 'perf',
+    }],
+
     ['MAX_TESS_PRIMS_PER_DRAW', {
         'type'      : 'uint32_t',
         'default'   : '16',
@@ -161,6 +249,25 @@ KNOBS = [
         'category'  : 'debug',
     }],
 
+    ['JIT_CACHE_DIR', {
+        'type'      : 'std::string',
+        'default'   : '',
+        'desc'      : ['Directory to mirror the fetch/blend/streamout JIT object cache to,',
+                       'so that other processes can reuse the code. Empty disables the',
+                       'disk mirror; the in memory cache is always used.'],
+        'category'  : 'perf',
+    }],
+
+    ['AR_TRACE', {
+        'type'      : 'bool',
+        'default'   : 'false',
+        'desc'      : ['Also write ArchRast begin/end events of all threads as a',
+                       'Chrome trace (JSON) file that chrome://tracing or Perfetto can load.',
+                       '',
+                       'NOTE: Requires KNOB_ENABLE_AR to be enabled.'],
+        'category'  : 'perf',
+    }],
+
     ['TOSS_DRAW', {
         'type'      : 'bool',
         'default'   : 'false',
@@ -40,6 +40,8 @@ swr_clear(struct pipe_context *pipe,
    if (!swr_check_render_cond(pipe))
       return;
 
+   swr_submit_pending_draw(ctx);
+
    swr_update_derived(pipe);
 
    if (buffers & PIPE_CLEAR_COLOR && fb->nr_cbufs) {
@@ -113,6 +113,9 @@ swr_transfer_map(struct pipe_context *pipe,
    swr_store_dirty_resource(pipe, resource, SWR_TILE_INVALID);
 
    if (!(usage & PIPE_TRANSFER_UNSYNCHRONIZED)) {
+      /* A held back draw may still read from the resource */
+      swr_submit_pending_draw(swr_context(pipe));
+
       /* If resource is in use, finish fence before mapping.
        * Unless requested not to block, then if not done return NULL map */
       if (usage & PIPE_TRANSFER_DONTBLOCK) {
@@ -250,6 +253,8 @@ swr_resource_copy(struct pipe_context *pipe,
 {
    struct swr_screen *screen = swr_screen(pipe->screen);
 
+   swr_submit_pending_draw(swr_context(pipe));
+
    /* If either the src or dst is a renderTarget, store tiles before copy */
    swr_store_dirty_resource(pipe, src, SWR_TILE_RESOLVED);
    swr_store_dirty_resource(pipe, dst, SWR_TILE_RESOLVED);
@@ -301,6 +306,8 @@ swr_blit(struct pipe_context *pipe, const struct pipe_blit_info *blit_info)
       return;
    }
 
+   swr_submit_pending_draw(ctx);
+
    if (ctx->active_queries) {
       SwrEnableStatsFE(ctx->swrContext, FALSE);
       SwrEnableStatsBE(ctx->swrContext, FALSE);
@@ -356,6 +363,7 @@ swr_destroy(struct pipe_context *pipe)
       util_blitter_destroy(ctx->blitter);
 
    /* Idle core before deleting context */
+   swr_submit_pending_draw(ctx);
    SwrWaitForIdle(ctx->swrContext);
 
    for (unsigned i = 0; i < PIPE_MAX_COLOR_BUFS; i++) {
@@ -416,6 +424,7 @@ swr_UpdateStats(HANDLE hPrivateContext, const SWR_STATS *pStats)
    pSwrStats->DepthPassCount += pStats->DepthPassCount;
    pSwrStats->PsInvocations += pStats->PsInvocations;
    pSwrStats->CsInvocations += pStats->CsInvocations;
+   pSwrStats->BeCycles += pStats->BeCycles;
 }
 
 static void
@@ -438,6 +447,7 @@ swr_UpdateStatsFE(HANDLE hPrivateContext, const SWR_STATS_FE *pStats)
    p_atomic_add(&pSwrStats->CInvocations, pStats->CInvocations);
    p_atomic_add(&pSwrStats->CPrimitives, pStats->CPrimitives);
    p_atomic_add(&pSwrStats->GsPrimitives, pStats->GsPrimitives);
+   p_atomic_add(&pSwrStats->FeCycles, pStats->FeCycles);
 
    for (unsigned i = 0; i < 4; i++) {
       p_atomic_add(&pSwrStats->SoPrimStorageNeeded[i],
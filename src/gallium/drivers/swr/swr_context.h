@@ -162,6 +162,10 @@ struct swr_context {
    struct swr_draw_context swrDC;
 
    unsigned dirty; /**< Mask of SWR_NEW_x flags */
+
+   /* Draw held back by swr_draw_vbo for merging with following draws */
+   struct pipe_draw_info pending_draw;
+   bool has_pending_draw;
 };
 
 static INLINE struct swr_context *
@@ -189,5 +193,7 @@ void swr_clear_init(struct pipe_context *pipe);
 
 void swr_draw_init(struct pipe_context *pipe);
 
+void swr_submit_pending_draw(struct swr_context *ctx);
+
 void swr_finish(struct pipe_context *pipe);
 #endif
@@ -73,6 +73,92 @@ swr_convert_prim_topology(const unsigned mode)
 };
 
 
+/*
+ * Submit the draw held back by swr_draw_vbo, if any.  Anything that calls
+ * into the SWR core directly, or touches memory a draw may be using, must
+ * call this first so the held draw executes in order.
+ */
+void
+swr_submit_pending_draw(struct swr_context *ctx)
+{
+   if (!ctx->has_pending_draw)
+      return;
+
+   const struct pipe_draw_info *info = &ctx->pending_draw;
+   ctx->has_pending_draw = false;
+
+   if (info->indexed)
+      SwrDrawIndexedInstanced(ctx->swrContext,
+                              swr_convert_prim_topology(info->mode),
+                              info->count,
+                              info->instance_count,
+                              info->start,
+                              info->index_bias,
+                              info->start_instance);
+   else
+      SwrDrawInstanced(ctx->swrContext,
+                       swr_convert_prim_topology(info->mode),
+                       info->count,
+                       info->instance_count,
+                       info->start,
+                       info->start_instance);
+}
+
+
+/*
+ * Check whether a draw can be appended to the pending draw.  That requires
+ * that no state changed in between, and that the new draw continues the
+ * vertex (or index) range of the pending one with a topology whose
+ * primitives are independent of each other.
+ */
+static bool
+swr_can_merge_draw(struct swr_context *ctx, const struct pipe_draw_info *info)
+{
+   const struct pipe_draw_info *prev = &ctx->pending_draw;
+
+   if (!ctx->has_pending_draw || ctx->dirty)
+      return false;
+
+   switch (info->mode) {
+   case PIPE_PRIM_POINTS:
+   case PIPE_PRIM_LINES:
+   case PIPE_PRIM_TRIANGLES:
+      break;
+   default:
+      return false;
+   }
+
+   if (info->mode != prev->mode ||
+       info->indexed != prev->indexed ||
+       info->primitive_restart || prev->primitive_restart ||
+       info->count_from_stream_output ||
+       info->drawid != prev->drawid)
+      return false;
+
+   if (info->instance_count != 1 || prev->instance_count != 1 ||
+       info->start_instance != prev->start_instance)
+      return false;
+
+   if (info->indexed && info->index_bias != prev->index_bias)
+      return false;
+
+   if (info->start != prev->start + prev->count)
+      return false;
+
+   /* A partial primitive at the end of the pending draw would otherwise be
+    * completed with vertices of the new draw. */
+   if (prev->count % u_vertices_per_prim(prev->mode))
+      return false;
+
+   /* Streamout offsets and primitive ids are tracked per draw. */
+   if (ctx->vs->pipe.stream_output.num_outputs ||
+       ctx->fs->info.base.uses_primid)
+      return false;
+
+   return true;
+}
+
+
 /*
  * Draw vertex arrays, with optional indexing, optional instancing.
  */
@@ -85,10 +171,23 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
       return;
 
    if (info->indirect) {
+      swr_submit_pending_draw(ctx);
       util_draw_indirect(pipe, info);
       return;
    }
 
+   /* Back-to-back draws with identical state are merged into one SWR draw,
+    * saving a draw context and a trip through the frontend per draw. */
+   if (swr_can_merge_draw(ctx, info)) {
+      struct pipe_draw_info *pending = &ctx->pending_draw;
+      pending->count += info->count;
+      pending->min_index = MIN2(pending->min_index, info->min_index);
+      pending->max_index = MAX2(pending->max_index, info->max_index);
+      return;
+   }
+
+   swr_submit_pending_draw(ctx);
+
    /* Update derived state, pass draw info to update function */
    swr_update_derived(pipe, info);
 
@@ -194,21 +293,9 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
    feState.bEnableCutIndex = info->primitive_restart;
    SwrSetFrontendState(ctx->swrContext, &feState);
 
-   if (info->indexed)
-      SwrDrawIndexedInstanced(ctx->swrContext,
-                              swr_convert_prim_topology(info->mode),
-                              info->count,
-                              info->instance_count,
-                              info->start,
-                              info->index_bias,
-                              info->start_instance);
-   else
-      SwrDrawInstanced(ctx->swrContext,
-                       swr_convert_prim_topology(info->mode),
-                       info->count,
-                       info->instance_count,
-                       info->start,
-                       info->start_instance);
+   /* Hold the draw back so following compatible draws can be merged in. */
+   ctx->pending_draw = *info;
+   ctx->has_pending_draw = true;
 }
 
 
@@ -221,6 +308,8 @@ swr_flush(struct pipe_context *pipe,
    struct swr_screen *screen = swr_screen(pipe->screen);
    struct pipe_surface *cb = ctx->framebuffer.cbufs[0];
 
+   swr_submit_pending_draw(ctx);
+
    /* If the current renderTarget is the display surface, store tiles back to
     * the surface, in preparation for present (swr_flush_frontbuffer).
     * Other renderTargets get stored back when attachment changes or
@@ -257,6 +346,7 @@ swr_store_render_target(struct pipe_context *pipe,
 
    /* Only proceed if there's a valid surface to store to */
    if (renderTarget->pBaseAddress) {
+      swr_submit_pending_draw(ctx);
       swr_update_draw_context(ctx);
       SWR_RECT full_rect =
          {0, 0,
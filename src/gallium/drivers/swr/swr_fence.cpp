@@ -54,6 +54,8 @@ swr_fence_submit(struct swr_context *ctx, struct pipe_fence_handle *fh)
 {
    struct swr_fence *fence = swr_fence(fh);
 
+   swr_submit_pending_draw(ctx);
+
    fence->write++;
    fence->pending = TRUE;
    SwrSync(ctx->swrContext, swr_sync_cb, (uint64_t)fence, fence->write, 0);
@@ -40,17 +40,29 @@ swr_create_screen(struct sw_winsys *winsys)
    util_dl_library *pLibrary = nullptr;
 
    util_cpu_detect();
-   if (util_cpu_caps.has_avx2) {
-      fprintf(stderr, "AVX2\n");
-      sprintf(filename, "%s%s%s", UTIL_DL_PREFIX, "swrAVX2", UTIL_DL_EXT);
-   } else if (util_cpu_caps.has_avx) {
-      fprintf(stderr, "AVX\n");
-      sprintf(filename, "%s%s%s", UTIL_DL_PREFIX, "swrAVX", UTIL_DL_EXT);
-   } else {
-      fprintf(stderr, "no AVX/AVX2 support.  Aborting!\n");
-      exit(-1);
+
+   /* The AVX512 core is optional, fall back to AVX2 if it wasn't built */
+   if (util_cpu_caps.has_avx512f && util_cpu_caps.has_avx512bw &&
+       util_cpu_caps.has_avx512dq && util_cpu_caps.has_avx512vl) {
+      sprintf(filename, "%s%s%s", UTIL_DL_PREFIX, "swrAVX512", UTIL_DL_EXT);
+      pLibrary = util_dl_open(filename);
+      if (pLibrary)
+         fprintf(stderr, "AVX512\n");
+   }
+
+   if (!pLibrary) {
+      if (util_cpu_caps.has_avx2) {
+         fprintf(stderr, "AVX2\n");
+         sprintf(filename, "%s%s%s", UTIL_DL_PREFIX, "swrAVX2", UTIL_DL_EXT);
+      } else if (util_cpu_caps.has_avx) {
+         fprintf(stderr, "AVX\n");
+         sprintf(filename, "%s%s%s", UTIL_DL_PREFIX, "swrAVX", UTIL_DL_EXT);
+      } else {
+         fprintf(stderr, "no AVX/AVX2 support.  Aborting!\n");
+         exit(-1);
+      }
+      pLibrary = util_dl_open(filename);
    }
-   pLibrary = util_dl_open(filename);
 
    if (!pLibrary) {
       fprintf(stderr, "SWR library load failure: %s\n", util_dl_error());
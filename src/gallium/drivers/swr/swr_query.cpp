@@ -42,7 +42,9 @@ swr_create_query(struct pipe_context *pipe, unsigned type, unsigned index)
 {
    struct swr_query *pq;
 
-   assert(type < PIPE_QUERY_TYPES);
+   assert(type < PIPE_QUERY_TYPES
+          || type == SWR_QUERY_FE_CYCLES
+          || type == SWR_QUERY_BE_CYCLES);
    assert(index < MAX_SO_STREAMS);
 
    pq = CALLOC_STRUCT(swr_query);
@@ -148,6 +150,12 @@ swr_get_query_result(struct pipe_context *pipe,
       result->b = num_primitives_written > primitives_storage_needed;
    }
       break;
+   case SWR_QUERY_FE_CYCLES:
+      result->u64 = pq->result.coreFE.FeCycles;
+      break;
+   case SWR_QUERY_BE_CYCLES:
+      result->u64 = pq->result.core.BeCycles;
+      break;
    default:
       assert(0 && "Unsupported query");
       break;
@@ -162,6 +170,9 @@ swr_begin_query(struct pipe_context *pipe, struct pipe_query *q)
    struct swr_context *ctx = swr_context(pipe);
    struct swr_query *pq = swr_query(q);
 
+   /* Draws already issued don't count towards this query */
+   swr_submit_pending_draw(ctx);
+
    /* Initialize Results */
    memset(&pq->result, 0, sizeof(pq->result));
    switch (pq->type) {
@@ -196,6 +207,8 @@ swr_end_query(struct pipe_context *pipe, struct pipe_query *q)
    struct swr_context *ctx = swr_context(pipe);
    struct swr_query *pq = swr_query(q);
 
+   swr_submit_pending_draw(ctx);
+
    switch (pq->type) {
    case PIPE_QUERY_GPU_FINISHED:
       /* nothing to do, but don't want the default */
@@ -249,6 +262,26 @@ swr_check_render_cond(struct pipe_context *pipe)
 }
 
 
+static const struct pipe_driver_query_info swr_driver_query_list[] = {
+   {"fe-cycles", SWR_QUERY_FE_CYCLES, {0}},
+   {"be-cycles", SWR_QUERY_BE_CYCLES, {0}},
+};
+
+int
+swr_get_driver_query_info(struct pipe_screen *screen,
+                          unsigned index,
+                          struct pipe_driver_query_info *info)
+{
+   if (!info)
+      return ARRAY_SIZE(swr_driver_query_list);
+
+   if (index >= ARRAY_SIZE(swr_driver_query_list))
+      return 0;
+
+   *info = swr_driver_query_list[index];
+   return 1;
+}
+
 static void
 swr_set_active_query_state(struct pipe_context *pipe, boolean enable)
 {
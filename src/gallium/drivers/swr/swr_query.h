@@ -27,6 +27,10 @@
 
 #include <limits.h>
 
+/* Driver specific queries, reported in rdtsc ticks */
+#define SWR_QUERY_FE_CYCLES (PIPE_QUERY_DRIVER_SPECIFIC + 0)
+#define SWR_QUERY_BE_CYCLES (PIPE_QUERY_DRIVER_SPECIFIC + 1)
+
 struct swr_query_result {
    SWR_STATS core;
    SWR_STATS_FE coreFE;
@@ -44,5 +48,9 @@ struct swr_query {
 
 extern void swr_query_init(struct pipe_context *pipe);
 
+extern int swr_get_driver_query_info(struct pipe_screen *screen,
+                                     unsigned index,
+                                     struct pipe_driver_query_info *info);
+
 extern boolean swr_check_render_cond(struct pipe_context *pipe);
 #endif
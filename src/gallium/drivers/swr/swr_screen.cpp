@@ -26,6 +26,7 @@
 #include "swr_screen.h"
 #include "swr_resource.h"
 #include "swr_fence.h"
+#include "swr_query.h"
 #include "gen_knobs.h"
 
 #include "pipe/p_screen.h"
@@ -35,6 +36,7 @@
 #include "util/u_inlines.h"
 #include "util/u_cpu_detect.h"
 #include "util/u_format_s3tc.h"
+#include "util/disk_cache.h"
 
 #include "state_tracker/sw_winsys.h"
 
@@ -856,6 +858,9 @@ swr_resource_destroy(struct pipe_screen *p_screen, struct pipe_resource *pt)
 
    /* Only wait on fence if the resource is being used */
    if (pipe && spr->status) {
+      /* A held back draw may still reference this resource */
+      swr_submit_pending_draw(swr_context(pipe));
+
       /* But, if there's no fence pending, submit one.
        * XXX: Remove once draw timestamps are implmented. */
       if (!swr_is_fence_pending(screen->flush_fence))
@@ -896,6 +901,7 @@ swr_flush_frontbuffer(struct pipe_screen *p_screen,
    struct pipe_context *pipe = screen->pipe;
 
    if (pipe) {
+      swr_submit_pending_draw(swr_context(pipe));
       swr_fence_finish(p_screen, NULL, screen->flush_fence, 0);
       swr_resource_unused(resource);
       SwrEndFrame(swr_context(pipe)->swrContext);
@@ -919,7 +925,13 @@ swr_destroy_screen(struct pipe_screen *p_screen)
    swr_fence_finish(p_screen, NULL, screen->flush_fence, 0);
    swr_fence_reference(p_screen, &screen->flush_fence, NULL);
 
+   if (util_queue_is_initialized(&screen->jit_queue))
+      util_queue_destroy(&screen->jit_queue);
+   if (screen->hJitMgrAsync)
+      JitDestroyContext(screen->hJitMgrAsync);
    JitDestroyContext(screen->hJitMgr);
+   if (screen->disk_cache)
+      disk_cache_destroy(screen->disk_cache);
 
    if (winsys->destroy)
       winsys->destroy(winsys);
@@ -951,6 +963,7 @@ swr_create_screen_internal(struct sw_winsys *winsys)
    screen->base.get_param = swr_get_param;
    screen->base.get_shader_param = swr_get_shader_param;
    screen->base.get_paramf = swr_get_paramf;
+   screen->base.get_driver_query_info = swr_get_driver_query_info;
 
    screen->base.resource_create = swr_resource_create;
    screen->base.resource_destroy = swr_resource_destroy;
@@ -958,6 +971,10 @@ swr_create_screen_internal(struct sw_winsys *winsys)
    screen->base.flush_frontbuffer = swr_flush_frontbuffer;
 
    screen->hJitMgr = JitCreateContext(KNOB_SIMD_WIDTH, KNOB_ARCH_STR, "swr");
+   if (util_queue_init(&screen->jit_queue, "swr_jit", 8, 1))
+      screen->hJitMgrAsync =
+         JitCreateContext(KNOB_SIMD_WIDTH, KNOB_ARCH_STR, "swr");
+   screen->disk_cache = disk_cache_create();
 
    swr_fence_init(&screen->base);
 
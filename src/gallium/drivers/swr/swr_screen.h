@@ -26,9 +26,11 @@
 
 #include "pipe/p_screen.h"
 #include "pipe/p_defines.h"
+#include "util/u_queue.h"
 #include "api.h"
 
 struct sw_winsys;
+struct disk_cache;
 
 struct swr_screen {
    struct pipe_screen base;
@@ -39,6 +41,12 @@ struct swr_screen {
    struct sw_winsys *winsys;
 
    HANDLE hJitMgr;
+
+   /* Background shader compiles, with their own LLVM context */
+   struct util_queue jit_queue;
+   HANDLE hJitMgrAsync;
+
+   struct disk_cache *disk_cache;   /**< JIT'ed shader objects, may be NULL */
 };
 
 static INLINE struct swr_screen *
@@ -33,7 +33,10 @@
 #include "state_llvm.h"
 #include "builder.h"
 
+#include "tgsi/tgsi_parse.h"
 #include "tgsi/tgsi_strings.h"
+#include "util/disk_cache.h"
+#include "util/mesa-sha1.h"
 #include "util/u_format.h"
 #include "gallivm/lp_bld_init.h"
 #include "gallivm/lp_bld_flow.h"
@@ -46,6 +49,8 @@
 #include "swr_state.h"
 #include "swr_screen.h"
 
+#include "git_sha1.h"
+
 using namespace SwrJit;
 
 static unsigned
@@ -157,6 +162,74 @@ swr_generate_vs_key(struct swr_jit_vs_key &key,
    swr_generate_sampler_key(swr_vs->info, ctx, PIPE_SHADER_VERTEX, key);
 }
 
+/*
+ * Look up the object code of a shader variant in the on-disk cache.  The
+ * cache key covers everything the generated code depends on: the build,
+ * the host CPU LLVM generates code for, the variant key and the TGSI.
+ * On a hit, cached->data holds the object and code generation is skipped.
+ */
+static void
+swr_shader_cache_get(struct swr_screen *screen,
+                     const char *stage,
+                     const void *key,
+                     size_t key_size,
+                     const struct tgsi_token *tokens,
+                     cache_key hash,
+                     struct lp_cached_code *cached)
+{
+   static const char build_id[] =
+#ifdef PACKAGE_VERSION
+      PACKAGE_VERSION
+#endif
+#ifdef MESA_GIT_SHA1
+      MESA_GIT_SHA1
+#endif
+      "";
+   const unsigned llvm_version = HAVE_LLVM;
+
+   memset(cached, 0, sizeof(*cached));
+
+   if (!screen->disk_cache)
+      return;
+
+   std::string cpu = llvm::sys::getHostCPUName().str();
+
+   struct mesa_sha1 *sha1 = _mesa_sha1_init();
+   if (!sha1)
+      return;
+   _mesa_sha1_update(sha1, build_id, sizeof(build_id));
+   _mesa_sha1_update(sha1, &llvm_version, sizeof(llvm_version));
+   _mesa_sha1_update(sha1, cpu.c_str(), cpu.size() + 1);
+   _mesa_sha1_update(sha1, stage, strlen(stage) + 1);
+   _mesa_sha1_update(sha1, key, key_size);
+   _mesa_sha1_update(sha1, tokens,
+                     tgsi_num_tokens(tokens) * sizeof(struct tgsi_token));
+   _mesa_sha1_final(sha1, hash);
+
+   cached->data = disk_cache_get(screen->disk_cache, hash, &cached->data_size);
+   if (!cached->data)
+      cached->data_size = 0;
+}
+
+/*
+ * Store freshly generated object code in the on-disk cache and release
+ * the object buffer.  Code referencing addresses of this process is not
+ * stored, as it can't be reused by another one.
+ */
+static void
+swr_shader_cache_put(struct swr_screen *screen,
+                     cache_key hash,
+                     struct lp_cached_code *cached,
+                     bool hit)
+{
+   if (!hit && cached->data && !cached->dont_cache)
+      disk_cache_put(screen->disk_cache, hash, cached->data, cached->data_size);
+
+   free(cached->data);
+   cached->data = NULL;
+   cached->data_size = 0;
+}
+
 struct BuilderSWR : public Builder {
    BuilderSWR(JitManager *pJitMgr, const char *pName)
       : Builder(pJitMgr)
@@ -241,6 +314,7 @@ BuilderSWR::CompileVS(struct swr_context *ctx, swr_jit_vs_key &key)
 
    lp_build_tgsi_soa(gallivm,
                      swr_vs->pipe.tokens,
+                     NULL,
                      lp_type_float_vec(32, 32 * 8),
                      NULL, // mask
                      wrap(consts_ptr),
@@ -354,11 +428,22 @@ BuilderSWR::CompileVS(struct swr_context *ctx, swr_jit_vs_key &key)
 PFN_VERTEX_FUNC
 swr_compile_vs(struct swr_context *ctx, swr_jit_vs_key &key)
 {
-   BuilderSWR builder(
-      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
-      "VS");
+   struct swr_screen *screen = swr_screen(ctx->pipe.screen);
+   struct lp_cached_code cached;
+   cache_key hash;
+
+   swr_shader_cache_get(screen, "VS", &key, sizeof(key),
+                        ctx->vs->pipe.tokens, hash, &cached);
+   bool hit = cached.data_size != 0;
+
+   /* Declared after cached, so the engine referencing it goes first */
+   BuilderSWR builder(reinterpret_cast<JitManager *>(screen->hJitMgr), "VS");
+   if (screen->disk_cache)
+      builder.gallivm->cache = &cached;
    PFN_VERTEX_FUNC func = builder.CompileVS(ctx, key);
 
+   swr_shader_cache_put(screen, hash, &cached, hit);
+
    ctx->vs->map.insert(std::make_pair(key, make_unique<VariantVS>(builder.gallivm, func)));
    return func;
 }
@@ -621,6 +706,7 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_fs_key &key)
 
    lp_build_tgsi_soa(gallivm,
                      swr_fs->pipe.tokens,
+                     NULL,
                      lp_type_float_vec(32, 32 * 8),
                      swr_fs->info.base.uses_kill ? &mask : NULL, // mask
                      wrap(consts_ptr),
@@ -713,14 +799,105 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_fs_key &key)
    return kernel;
 }
 
+static PFN_PIXEL_KERNEL
+swr_jit_fs(JitManager *pJitMgr,
+           struct swr_context *ctx,
+           swr_jit_fs_key &key,
+           struct gallivm_state **gallivm)
+{
+   struct swr_screen *screen = swr_screen(ctx->pipe.screen);
+   struct lp_cached_code cached;
+   cache_key hash;
+
+   swr_shader_cache_get(screen, "FS", &key, sizeof(key),
+                        ctx->fs->pipe.tokens, hash, &cached);
+   bool hit = cached.data_size != 0;
+
+   /* Declared after cached, so the engine referencing it goes first */
+   BuilderSWR builder(pJitMgr, "FS");
+   if (screen->disk_cache)
+      builder.gallivm->cache = &cached;
+   PFN_PIXEL_KERNEL func = builder.CompileFS(ctx, key);
+
+   swr_shader_cache_put(screen, hash, &cached, hit);
+
+   *gallivm = builder.gallivm;
+   return func;
+}
+
 PFN_PIXEL_KERNEL
 swr_compile_fs(struct swr_context *ctx, swr_jit_fs_key &key)
 {
-   BuilderSWR builder(
+   struct gallivm_state *gallivm;
+   PFN_PIXEL_KERNEL func = swr_jit_fs(
       reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
-      "FS");
-   PFN_PIXEL_KERNEL func = builder.CompileFS(ctx, key);
+      ctx, key, &gallivm);
+
+   ctx->fs->map.insert(std::make_pair(key, make_unique<VariantFS>(gallivm, func)));
+   return func;
+}
+
+struct swr_fs_job {
+   struct util_queue_fence fence;
+   struct swr_context *ctx;
+   swr_jit_fs_key key;
+   struct gallivm_state *gallivm;
+   PFN_PIXEL_KERNEL func;
+};
+
+static void
+swr_fs_job_execute(void *data, int thread_index)
+{
+   struct swr_fs_job *job = (struct swr_fs_job *)data;
+
+   job->func = swr_jit_fs(
+      reinterpret_cast<JitManager *>(swr_screen(job->ctx->pipe.screen)->hJitMgrAsync),
+      job->ctx, job->key, &job->gallivm);
+}
+
+/*
+ * Start compiling a fragment shader variant on the screen's JIT thread.
+ * The job only reads shader and context state that must stay unchanged
+ * until swr_compile_fs_finish() is called.  Returns NULL if there is no
+ * JIT thread, in which case swr_compile_fs() has to be used instead.
+ */
+struct swr_fs_job *
+swr_compile_fs_async(struct swr_context *ctx, swr_jit_fs_key &key)
+{
+   struct swr_screen *screen = swr_screen(ctx->pipe.screen);
+
+   if (!screen->hJitMgrAsync)
+      return NULL;
+
+   /* gallivm's one-time setup must not race with this thread */
+   if (!lp_build_init())
+      return NULL;
+
+   struct swr_fs_job *job = new swr_fs_job;
+   util_queue_fence_init(&job->fence);
+   job->ctx = ctx;
+   job->key = key;
+   job->gallivm = NULL;
+   job->func = NULL;
+
+   util_queue_add_job(&screen->jit_queue, job, &job->fence,
+                      swr_fs_job_execute, NULL);
+   return job;
+}
+
+/*
+ * Wait for a fragment shader compile started by swr_compile_fs_async() and
+ * add the resulting variant to the shader.
+ */
+PFN_PIXEL_KERNEL
+swr_compile_fs_finish(struct swr_context *ctx, struct swr_fs_job *job)
+{
+   util_queue_job_wait(&job->fence);
+   util_queue_fence_destroy(&job->fence);
+
+   PFN_PIXEL_KERNEL func = job->func;
+   ctx->fs->map.insert(std::make_pair(job->key, make_unique<VariantFS>(job->gallivm, func)));
 
-   ctx->fs->map.insert(std::make_pair(key, make_unique<VariantFS>(builder.gallivm, func)));
+   delete job;
    return func;
 }
@@ -27,6 +27,7 @@ struct swr_vertex_shader;
 struct swr_fragment_shader;
 struct swr_jit_fs_key;
 struct swr_jit_vs_key;
+struct swr_fs_job;
 
 PFN_VERTEX_FUNC
 swr_compile_vs(struct swr_context *ctx, swr_jit_vs_key &key);
@@ -34,6 +35,12 @@ swr_compile_vs(struct swr_context *ctx, swr_jit_vs_key &key);
 PFN_PIXEL_KERNEL
 swr_compile_fs(struct swr_context *ctx, swr_jit_fs_key &key);
 
+struct swr_fs_job *
+swr_compile_fs_async(struct swr_context *ctx, swr_jit_fs_key &key);
+
+PFN_PIXEL_KERNEL
+swr_compile_fs_finish(struct swr_context *ctx, struct swr_fs_job *job);
+
 void swr_generate_fs_key(struct swr_jit_fs_key &key,
                          struct swr_context *ctx,
                          swr_fragment_shader *swr_fs);
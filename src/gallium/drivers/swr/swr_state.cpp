@@ -372,6 +372,7 @@ swr_delete_vs_state(struct pipe_context *pipe, void *vs)
    struct swr_vertex_shader *swr_vs = (swr_vertex_shader *)vs;
    FREE((void *)swr_vs->pipe.tokens);
    struct swr_screen *screen = swr_screen(pipe->screen);
+   swr_submit_pending_draw(swr_context(pipe));
    if (!swr_is_fence_pending(screen->flush_fence))
       swr_fence_submit(swr_context(pipe), screen->flush_fence);
    swr_fence_finish(pipe->screen, NULL, screen->flush_fence, 0);
@@ -412,6 +413,7 @@ swr_delete_fs_state(struct pipe_context *pipe, void *fs)
    struct swr_fragment_shader *swr_fs = (swr_fragment_shader *)fs;
    FREE((void *)swr_fs->pipe.tokens);
    struct swr_screen *screen = swr_screen(pipe->screen);
+   swr_submit_pending_draw(swr_context(pipe));
    if (!swr_is_fence_pending(screen->flush_fence))
       swr_fence_submit(swr_context(pipe), screen->flush_fence);
    swr_fence_finish(pipe->screen, NULL, screen->flush_fence, 0);
@@ -922,6 +924,20 @@ swr_update_derived(struct pipe_context *pipe,
    /* For example, user_buffer vertex and index buffers. */
    unsigned post_update_dirty_flags = 0;
 
+   /* Kick off a missing fragment shader variant on the JIT thread first, so
+    * its compile overlaps with the rest of the state setup below.
+    */
+   bool fs_dirty = ctx->dirty & (SWR_NEW_FS | SWR_NEW_SAMPLER |
+                                 SWR_NEW_SAMPLER_VIEW | SWR_NEW_RASTERIZER |
+                                 SWR_NEW_FRAMEBUFFER);
+   swr_jit_fs_key fs_key;
+   struct swr_fs_job *fs_job = NULL;
+   if (fs_dirty) {
+      swr_generate_fs_key(fs_key, ctx, ctx->fs);
+      if (ctx->fs->map.find(fs_key) == ctx->fs->map.end())
+         fs_job = swr_compile_fs_async(ctx, fs_key);
+   }
+
    /* Render Targets */
    if (ctx->dirty & SWR_NEW_FRAMEBUFFER) {
       struct pipe_framebuffer_state *fb = &ctx->framebuffer;
@@ -1232,16 +1248,18 @@ swr_update_derived(struct pipe_context *pipe,
    }
 
    /* FragmentShader */
-   if (ctx->dirty & (SWR_NEW_FS | SWR_NEW_SAMPLER | SWR_NEW_SAMPLER_VIEW
-                     | SWR_NEW_RASTERIZER | SWR_NEW_FRAMEBUFFER)) {
-      swr_jit_fs_key key;
-      swr_generate_fs_key(key, ctx, ctx->fs);
-      auto search = ctx->fs->map.find(key);
+   if (fs_dirty) {
+      swr_jit_fs_key &key = fs_key;
       PFN_PIXEL_KERNEL func;
-      if (search != ctx->fs->map.end()) {
-         func = search->second->shader;
+      if (fs_job) {
+         func = swr_compile_fs_finish(ctx, fs_job);
       } else {
-         func = swr_compile_fs(ctx, key);
+         auto search = ctx->fs->map.find(key);
+         if (search != ctx->fs->map.end()) {
+            func = search->second->shader;
+         } else {
+            func = swr_compile_fs(ctx, key);
+         }
       }
       SWR_PS_STATE psState = {0};
       psState.pfnPixelShader = func;
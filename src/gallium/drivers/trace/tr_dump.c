@@ -51,6 +51,7 @@
 #include "util/u_string.h"
 #include "util/u_math.h"
 #include "util/u_format.h"
+#include "util/hash_table.h"
 
 #include "tr_dump.h"
 #include "tr_screen.h"
@@ -63,6 +64,39 @@ pipe_static_mutex(call_mutex);
 static long unsigned call_no = 0;
 static boolean dumping = FALSE;
 
+/*
+ * Timing mode (GALLIUM_TRACE_TIMING): instead of the XML dump, only a
+ * compact binary record with the start time and duration of every call is
+ * written, which keeps the overhead low enough for profiling.  See
+ * src/gallium/tools/trace/timing.py for reading these traces.
+ *
+ * The file starts with TRACE_TIMING_MAGIC and a 32-bit version, followed by
+ * records starting with a one byte type:
+ *  - TRACE_TIMING_METHOD: uint16 id, uint16 length, "class::method" name,
+ *    written before the first call of a method;
+ *  - TRACE_TIMING_CALL: uint16 method id, uint64 start and uint64
+ *    duration, in nanoseconds.
+ *
+ * All values are in host byte order.
+ */
+#define TRACE_TIMING_MAGIC "GTRCTIME"
+#define TRACE_TIMING_VERSION 1
+#define TRACE_TIMING_METHOD 1
+#define TRACE_TIMING_CALL 2
+
+struct trace_timing_method
+{
+   const char *klass;
+   const char *method;
+   uint16_t id;
+};
+
+static boolean timing = FALSE;
+static boolean timing_active = FALSE;
+static struct hash_table *timing_methods = NULL;
+static uint16_t timing_call_method;
+static int64_t timing_call_start;
+
 
 static inline void
 trace_dump_write(const char *buf, size_t size)
@@ -223,10 +257,77 @@ trace_dump_trace_flush(void)
    }
 }
 
+static uint32_t
+trace_timing_method_hash(const void *key)
+{
+   const struct trace_timing_method *m = key;
+   return _mesa_hash_pointer(m->klass) ^ _mesa_hash_pointer(m->method);
+}
+
+static bool
+trace_timing_method_equal(const void *a, const void *b)
+{
+   const struct trace_timing_method *ma = a, *mb = b;
+   return ma->klass == mb->klass && ma->method == mb->method;
+}
+
+static void
+trace_timing_method_free(struct hash_entry *entry)
+{
+   FREE((void *)entry->key);
+}
+
+/**
+ * Return the id of a method, writing its name out the first time.
+ */
+static uint16_t
+trace_timing_method_id(const char *klass, const char *method)
+{
+   struct trace_timing_method key, *m;
+   struct hash_entry *entry;
+   uint8_t type = TRACE_TIMING_METHOD;
+   uint16_t len;
+
+   key.klass = klass;
+   key.method = method;
+   entry = _mesa_hash_table_search(timing_methods, &key);
+   if (entry)
+      return ((const struct trace_timing_method *)entry->key)->id;
+
+   m = MALLOC_STRUCT(trace_timing_method);
+   if (!m)
+      return 0;
+
+   *m = key;
+   m->id = timing_methods->entries + 1;
+   _mesa_hash_table_insert(timing_methods, m, m);
+
+   len = strlen(klass) + 2 + strlen(method);
+   trace_dump_write((const char *)&type, sizeof(type));
+   trace_dump_write((const char *)&m->id, sizeof(m->id));
+   trace_dump_write((const char *)&len, sizeof(len));
+   trace_dump_writes(klass);
+   trace_dump_writes("::");
+   trace_dump_writes(method);
+
+   return m->id;
+}
+
 static void
 trace_dump_trace_close(void)
 {
-   if (stream) {
+   if (stream && timing) {
+      if (close_stream) {
+         fclose(stream);
+         close_stream = FALSE;
+         stream = NULL;
+      } else {
+         fflush(stream);
+      }
+      _mesa_hash_table_destroy(timing_methods, trace_timing_method_free);
+      timing_methods = NULL;
+   }
+   else if (stream) {
       trace_dump_writes("</trace>\n");
       if (close_stream) {
          fclose(stream);
@@ -261,6 +362,7 @@ trace_dump_trace_begin(void)
       return FALSE;
 
    if (!stream) {
+      timing = debug_get_bool_option("GALLIUM_TRACE_TIMING", FALSE);
 
       if (strcmp(filename, "stderr") == 0) {
          close_stream = FALSE;
@@ -272,14 +374,34 @@ trace_dump_trace_begin(void)
       }
       else {
          close_stream = TRUE;
-         stream = fopen(filename, "wt");
+         stream = fopen(filename, timing ? "wb" : "wt");
          if (!stream)
             return FALSE;
       }
 
-      trace_dump_writes("<?xml version='1.0' encoding='UTF-8'?>\n");
-      trace_dump_writes("<?xml-stylesheet type='text/xsl' href='trace.xsl'?>\n");
-      trace_dump_writes("<trace version='0.1'>\n");
+      if (timing) {
+         const uint32_t version = TRACE_TIMING_VERSION;
+
+         timing_methods = _mesa_hash_table_create(NULL,
+                                                  trace_timing_method_hash,
+                                                  trace_timing_method_equal);
+         if (!timing_methods) {
+            if (close_stream)
+               fclose(stream);
+            stream = NULL;
+            return FALSE;
+         }
+
+         /* Records are small, so don't hit the file for each of them. */
+         setvbuf(stream, NULL, _IOFBF, 1 << 20);
+
+         trace_dump_writes(TRACE_TIMING_MAGIC);
+         trace_dump_write((const char *)&version, sizeof(version));
+      } else {
+         trace_dump_writes("<?xml version='1.0' encoding='UTF-8'?>\n");
+         trace_dump_writes("<?xml-stylesheet type='text/xsl' href='trace.xsl'?>\n");
+         trace_dump_writes("<trace version='0.1'>\n");
+      }
 
       /* Many applications don't exit cleanly, others may create and destroy a
        * screen multiple times, so we only write </trace> tag and close at exit
@@ -316,12 +438,17 @@ void trace_dump_call_unlock(void)
 
 void trace_dumping_start_locked(void)
 {
-   dumping = TRUE;
+   /* In timing mode, the arguments and states are never dumped. */
+   if (timing)
+      timing_active = TRUE;
+   else
+      dumping = TRUE;
 }
 
 void trace_dumping_stop_locked(void)
 {
    dumping = FALSE;
+   timing_active = FALSE;
 }
 
 boolean trace_dumping_enabled_locked(void)
@@ -360,6 +487,12 @@ static int64_t call_start_time = 0;
 
 void trace_dump_call_begin_locked(const char *klass, const char *method)
 {
+   if (timing_active) {
+      timing_call_method = trace_timing_method_id(klass, method);
+      timing_call_start = os_time_get_nano();
+      return;
+   }
+
    if (!dumping)
       return;
 
@@ -381,6 +514,19 @@ void trace_dump_call_end_locked(void)
 {
    int64_t call_end_time;
 
+   if (timing_active) {
+      uint8_t record[1 + 2 + 8 + 8];
+      uint64_t start = timing_call_start;
+      uint64_t duration = os_time_get_nano() - timing_call_start;
+
+      record[0] = TRACE_TIMING_CALL;
+      memcpy(record + 1, &timing_call_method, 2);
+      memcpy(record + 3, &start, 8);
+      memcpy(record + 11, &duration, 8);
+      trace_dump_write((const char *)record, sizeof(record));
+      return;
+   }
+
    if (!dumping)
       return;
 
@@ -104,6 +104,40 @@ vc4_flush_jobs_writing_resource(struct vc4_context *vc4,
         }
 }
 
+/**
+ * Returns whether the job references the BO, either through its BO list or
+ * through the color/Z buffers that it loads at the start of the frame.
+ */
+static bool
+vc4_job_reads_bo(struct vc4_job *job, struct vc4_bo *bo)
+{
+        struct vc4_bo **referenced_bos = job->bo_pointers.base;
+        for (int i = 0; i < cl_offset(&job->bo_handles) / 4; i++) {
+                if (referenced_bos[i] == bo)
+                        return true;
+        }
+
+        /* Also check for the Z/color buffers, since the references to
+         * those are only added immediately before submit.
+         */
+        if (job->color_read && !(job->cleared & PIPE_CLEAR_COLOR)) {
+                struct vc4_resource *ctex =
+                        vc4_resource(job->color_read->texture);
+                if (ctex->bo == bo)
+                        return true;
+        }
+
+        if (job->zs_read && !(job->cleared &
+                              (PIPE_CLEAR_DEPTH | PIPE_CLEAR_STENCIL))) {
+                struct vc4_resource *ztex =
+                        vc4_resource(job->zs_read->texture);
+                if (ztex->bo == bo)
+                        return true;
+        }
+
+        return false;
+}
+
 void
 vc4_flush_jobs_reading_resource(struct vc4_context *vc4,
                                 struct pipe_resource *prsc)
@@ -116,35 +150,8 @@ vc4_flush_jobs_reading_resource(struct vc4_context *vc4,
         hash_table_foreach(vc4->jobs, entry) {
                 struct vc4_job *job = entry->data;
 
-                struct vc4_bo **referenced_bos = job->bo_pointers.base;
-                for (int i = 0; i < cl_offset(&job->bo_handles) / 4; i++) {
-                        if (referenced_bos[i] == rsc->bo) {
-                                vc4_job_submit(vc4, job);
-                                continue;
-                        }
-                }
-
-                /* Also check for the Z/color buffers, since the references to
-                 * those are only added immediately before submit.
-                 */
-                if (job->color_read && !(job->cleared & PIPE_CLEAR_COLOR)) {
-                        struct vc4_resource *ctex =
-                                vc4_resource(job->color_read->texture);
-                        if (ctex->bo == rsc->bo) {
-                                vc4_job_submit(vc4, job);
-                                continue;
-                        }
-                }
-
-                if (job->zs_read && !(job->cleared &
-                                      (PIPE_CLEAR_DEPTH | PIPE_CLEAR_STENCIL))) {
-                        struct vc4_resource *ztex =
-                                vc4_resource(job->zs_read->texture);
-                        if (ztex->bo == rsc->bo) {
-                                vc4_job_submit(vc4, job);
-                                continue;
-                        }
-                }
+                if (vc4_job_reads_bo(job, rsc->bo))
+                        vc4_job_submit(vc4, job);
         }
 }
 
@@ -570,7 +570,8 @@ get_instruction_priority(uint64_t inst)
 static struct schedule_node *
 choose_instruction_to_schedule(struct choose_scoreboard *scoreboard,
                                struct list_head *schedule_list,
-                               struct schedule_node *prev_inst)
+                               struct schedule_node *prev_inst,
+                               uint32_t time)
 {
         struct schedule_node *chosen = NULL;
         int chosen_prio = 0;
@@ -641,6 +642,22 @@ choose_instruction_to_schedule(struct choose_scoreboard *scoreboard,
                         continue;
                 }
 
+                /* If we would stall on the latency of the previously chosen
+                 * node (a texture or SFU result, usually), but less on this
+                 * one, then prefer it.  When pairing, this keeps a stalled
+                 * instruction from holding back the one it would be merged
+                 * into.
+                 */
+                if (chosen->unblocked_time > time &&
+                    n->unblocked_time < chosen->unblocked_time) {
+                        chosen = n;
+                        chosen_prio = prio;
+                        continue;
+                } else if (n->unblocked_time > time &&
+                           n->unblocked_time > chosen->unblocked_time) {
+                        continue;
+                }
+
                 if (n->delay > chosen->delay) {
                         chosen = n;
                         chosen_prio = prio;
@@ -847,7 +864,7 @@ schedule_instructions(struct vc4_compile *c,
                 struct schedule_node *chosen =
                         choose_instruction_to_schedule(scoreboard,
                                                        schedule_list,
-                                                       NULL);
+                                                       NULL, time);
                 struct schedule_node *merge = NULL;
 
                 /* If there are no valid instructions to schedule, drop a NOP
@@ -882,7 +899,7 @@ schedule_instructions(struct vc4_compile *c,
 
                         merge = choose_instruction_to_schedule(scoreboard,
                                                                schedule_list,
-                                                               chosen);
+                                                               chosen, time);
                         if (merge) {
                                 time = MAX2(merge->unblocked_time, time);
                                 list_del(&merge->link);
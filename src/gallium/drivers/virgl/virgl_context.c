@@ -490,11 +490,11 @@ static void *virgl_shader_encoder(struct pipe_context *ctx,
    ret = virgl_encode_shader_state(vctx, handle, type,
                                    &shader->stream_output,
                                    new_tokens);
+   FREE(new_tokens);
    if (ret) {
       return NULL;
    }
 
-   FREE(new_tokens);
    return (void *)(unsigned long)handle;
 
 }
@@ -25,6 +25,7 @@
 #include "util/u_format.h"
 #include "util/u_memory.h"
 #include "util/u_math.h"
+#include "util/hash_table.h"
 #include "pipe/p_state.h"
 #include "tgsi/tgsi_dump.h"
 #include "tgsi/tgsi_parse.h"
@@ -234,23 +235,15 @@ static void virgl_emit_shader_streamout(struct virgl_context *ctx,
    }
 }
 
-int virgl_encode_shader_state(struct virgl_context *ctx,
-                              uint32_t handle,
-                              uint32_t type,
-                              const struct pipe_stream_output_info *so_info,
-                              const struct tgsi_token *tokens)
+static char *virgl_dump_shader(const struct tgsi_token *tokens)
 {
-   char *str, *sptr;
-   uint32_t shader_len, len;
+   char *str, *text;
    bool bret;
-   int num_tokens = tgsi_num_tokens(tokens);
    int str_total_size = 65536;
    int retry_size = 1;
-   uint32_t left_bytes, base_hdr_size, strm_hdr_size, thispass;
-   bool first_pass;
    str = CALLOC(1, str_total_size);
    if (!str)
-      return -1;
+      return NULL;
 
    do {
       int old_size;
@@ -262,11 +255,83 @@ int virgl_encode_shader_state(struct virgl_context *ctx,
          str_total_size = 65536 * ++retry_size;
          str = REALLOC(str, old_size, str_total_size);
          if (!str)
-            return -1;
+            return NULL;
       }
    } while (bret == false && retry_size < 10);
 
-   if (bret == false)
+   if (bret == false) {
+      FREE(str);
+      return NULL;
+   }
+
+   /* don't keep the whole dump buffer around in the cache: */
+   text = MALLOC(strlen(str) + 1);
+   if (text)
+      strcpy(text, str);
+   FREE(str);
+   return text;
+}
+
+/* Maximum number of shaders whose text is kept in the screen cache. */
+#define VIRGL_SHADER_TEXT_CACHE_SIZE 1024
+
+/* Returns the TGSI text of the shader.  Every context creates its own host
+ * objects, but the text of a shader that was already created by another
+ * context (or recreated after being deleted) is only dumped once.
+ *
+ * The text is owned by the screen cache if *cached is set, and has to be
+ * freed by the caller otherwise.
+ */
+static char *virgl_get_shader_text(struct virgl_screen *vs,
+                                   const struct tgsi_token *tokens,
+                                   bool *cached)
+{
+   struct hash_entry *entry;
+   struct tgsi_token *key;
+   char *text;
+   unsigned size;
+
+   pipe_mutex_lock(vs->shader_text_mutex);
+
+   entry = _mesa_hash_table_search(vs->shader_text_cache, tokens);
+   if (entry) {
+      pipe_mutex_unlock(vs->shader_text_mutex);
+      *cached = true;
+      return entry->data;
+   }
+
+   *cached = false;
+   text = virgl_dump_shader(tokens);
+   if (text &&
+       vs->shader_text_cache->entries < VIRGL_SHADER_TEXT_CACHE_SIZE) {
+      size = tgsi_num_tokens(tokens) * sizeof(struct tgsi_token);
+      key = MALLOC(size);
+      if (key) {
+         memcpy(key, tokens, size);
+         _mesa_hash_table_insert(vs->shader_text_cache, key, text);
+         *cached = true;
+      }
+   }
+
+   pipe_mutex_unlock(vs->shader_text_mutex);
+   return text;
+}
+
+int virgl_encode_shader_state(struct virgl_context *ctx,
+                              uint32_t handle,
+                              uint32_t type,
+                              const struct pipe_stream_output_info *so_info,
+                              const struct tgsi_token *tokens)
+{
+   struct virgl_screen *vs = virgl_screen(ctx->base.screen);
+   char *str, *sptr;
+   uint32_t shader_len, len;
+   int num_tokens = tgsi_num_tokens(tokens);
+   uint32_t left_bytes, base_hdr_size, strm_hdr_size, thispass;
+   bool first_pass, cached;
+
+   str = virgl_get_shader_text(vs, tokens, &cached);
+   if (!str)
       return -1;
 
    shader_len = strlen(str) + 1;
@@ -304,7 +369,8 @@ int virgl_encode_shader_state(struct virgl_context *ctx,
       left_bytes -= length;
    }
 
-   FREE(str);
+   if (!cached)
+      FREE(str);
    return 0;
 }
 
@@ -20,6 +20,7 @@
  * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
  * USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "util/u_format.h"
 #include "util/u_inlines.h"
 #include "virgl_context.h"
 #include "virgl_resource.h"
@@ -98,11 +99,51 @@ static void virgl_buffer_subdata(struct pipe_context *pipe,
    virgl_transfer_inline_write(pipe, resource, 0, usage, &box, data, 0, 0);
 }
 
+/* Small texture uploads are written inline into the command buffer, so
+ * that they go to the host with the next submit instead of each needing a
+ * transfer of their own.
+ */
+#define VIRGL_MAX_INLINE_TEXTURE_UPLOAD VIRGL_MAX_CMDBUF_DWORDS
+
+static void virgl_texture_subdata(struct pipe_context *pipe,
+                                  struct pipe_resource *resource,
+                                  unsigned level,
+                                  unsigned usage,
+                                  const struct pipe_box *box,
+                                  const void *data,
+                                  unsigned stride,
+                                  unsigned layer_stride)
+{
+   struct virgl_context *vctx = virgl_context(pipe);
+   enum pipe_format format = resource->format;
+   unsigned size = stride * box->height;
+   unsigned length = 11 + (size + 3) / 4;
+
+   /* The inline write command reads stride * height bytes, and only buffer
+    * uploads can be split across command buffers.
+    */
+   if (box->depth != 1 ||
+       util_format_get_blockheight(format) != 1 ||
+       stride != util_format_get_stride(format, box->width) ||
+       size > VIRGL_MAX_INLINE_TEXTURE_UPLOAD) {
+      u_default_texture_subdata(pipe, resource, level, usage, box,
+                                data, stride, layer_stride);
+      return;
+   }
+
+   if (vctx->cbuf->cdw + length + 1 > VIRGL_MAX_CMDBUF_DWORDS)
+      pipe->flush(pipe, NULL, 0);
+
+   virgl_transfer_inline_write(pipe, resource, level,
+                               usage | PIPE_TRANSFER_WRITE, box,
+                               data, stride, layer_stride);
+}
+
 void virgl_init_context_resource_functions(struct pipe_context *ctx)
 {
     ctx->transfer_map = u_transfer_map_vtbl;
     ctx->transfer_flush_region = u_transfer_flush_region_vtbl;
     ctx->transfer_unmap = u_transfer_unmap_vtbl;
     ctx->buffer_subdata = virgl_buffer_subdata;
-    ctx->texture_subdata = u_default_texture_subdata;
+    ctx->texture_subdata = virgl_texture_subdata;
 }
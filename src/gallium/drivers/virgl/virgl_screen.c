@@ -22,6 +22,7 @@
  */
 #include "util/u_memory.h"
 #include "util/u_format.h"
+#include "util/hash_table.h"
 #include "util/u_format_s3tc.h"
 #include "util/u_video.h"
 #include "os/os_time.h"
@@ -30,6 +31,7 @@
 #include "draw/draw_context.h"
 
 #include "tgsi/tgsi_exec.h"
+#include "tgsi/tgsi_parse.h"
 
 #include "virgl_screen.h"
 #include "virgl_resource.h"
@@ -547,6 +549,30 @@ virgl_get_timestamp(struct pipe_screen *_screen)
    return os_time_get_nano();
 }
 
+static uint32_t
+virgl_shader_text_hash(const void *key)
+{
+   const struct tgsi_token *tokens = key;
+   return _mesa_hash_data(tokens,
+                          tgsi_num_tokens(tokens) * sizeof(struct tgsi_token));
+}
+
+static bool
+virgl_shader_text_equal(const void *a, const void *b)
+{
+   unsigned num_tokens = tgsi_num_tokens(a);
+
+   return num_tokens == tgsi_num_tokens(b) &&
+          memcmp(a, b, num_tokens * sizeof(struct tgsi_token)) == 0;
+}
+
+static void
+virgl_shader_text_free(struct hash_entry *entry)
+{
+   FREE((void *)entry->key);
+   FREE(entry->data);
+}
+
 static void
 virgl_destroy_screen(struct pipe_screen *screen)
 {
@@ -555,6 +581,10 @@ virgl_destroy_screen(struct pipe_screen *screen)
 
    slab_destroy_parent(&vscreen->texture_transfer_pool);
 
+   _mesa_hash_table_destroy(vscreen->shader_text_cache,
+                            virgl_shader_text_free);
+   pipe_mutex_destroy(vscreen->shader_text_mutex);
+
    if (vws)
       vws->destroy(vws);
    FREE(vscreen);
@@ -591,6 +621,11 @@ virgl_create_screen(struct virgl_winsys *vws)
 
    slab_create_parent(&screen->texture_transfer_pool, sizeof(struct virgl_transfer), 16);
 
+   pipe_mutex_init(screen->shader_text_mutex);
+   screen->shader_text_cache =
+      _mesa_hash_table_create(NULL, virgl_shader_text_hash,
+                              virgl_shader_text_equal);
+
    util_format_s3tc_init();
    return &screen->base;
 }
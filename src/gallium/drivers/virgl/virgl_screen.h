@@ -24,6 +24,7 @@
 #define VIRGL_H
 
 #include "pipe/p_screen.h"
+#include "os/os_thread.h"
 #include "util/slab.h"
 #include "virgl_winsys.h"
 
@@ -41,6 +42,10 @@ struct virgl_screen {
 
    struct slab_parent_pool texture_transfer_pool;
 
+   /* TGSI text of the shaders created so far, shared by all contexts: */
+   pipe_mutex shader_text_mutex;
+   struct hash_table *shader_text_cache;
+
    uint32_t sub_ctx_id;
 };
 
@@ -90,6 +90,7 @@ enum st_api_feature
 #define ST_CONTEXT_FLAG_FORWARD_COMPATIBLE  (1 << 1)
 #define ST_CONTEXT_FLAG_ROBUST_ACCESS       (1 << 2)
 #define ST_CONTEXT_FLAG_RESET_NOTIFICATION_ENABLED (1 << 3)
+#define ST_CONTEXT_FLAG_NO_ERROR            (1 << 4)
 
 /**
  * Reasons that context creation might fail.
@@ -178,6 +179,7 @@ enum st_manager_param {
 struct pipe_context;
 struct pipe_resource;
 struct pipe_fence_handle;
+struct hud_context;
 
 /**
  * Used in st_context_iface->get_resource_for_egl_image.
@@ -374,6 +376,12 @@ struct st_context_iface
     */
    struct pipe_context *pipe;
 
+   /**
+    * The HUD drawn over this context, if any, which the state tracker
+    * reports the CPU time of each phase of a frame to.
+    */
+   struct hud_context *hud;
+
    /**
     * Destroy the context.
     */
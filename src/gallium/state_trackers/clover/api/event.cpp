@@ -130,11 +130,19 @@ clSetEventCallback(cl_event d_ev, cl_int type,
       throw error(CL_INVALID_VALUE);
 
    // Create a temporary soft event that depends on ev, with
-   // pfn_notify as completion action.
+   // pfn_notify as completion action.  ev may still be running on the
+   // device when it's triggered, so its completion is waited for in
+   // the context's worker rather than in whatever API call happened to
+   // trigger it.
    create<soft_event>(ev.context(), ref_vector<event> { ev }, true,
                       [=, &ev](event &) {
-                         ev.wait();
-                         pfn_notify(desc(ev), ev.status(), user_data);
+                         intrusive_ref<event> ref { ev };
+
+                         ev.context().defer([=]() {
+                               ref().wait_completion();
+                               pfn_notify(desc(ref()), ref().status(),
+                                          user_data);
+                            });
                       });
 
    return CL_SUCCESS;
@@ -203,9 +211,11 @@ clEnqueueMarkerWithWaitList(cl_command_queue d_q, cl_uint num_deps,
 
 CLOVER_API cl_int
 clEnqueueBarrier(cl_command_queue d_q) try {
-   obj(d_q);
+   auto &q = obj(d_q);
 
-   // No need to do anything, q preserves data ordering strictly.
+   // No need to do anything if q preserves data ordering strictly.
+   if (q.out_of_order())
+      create<hard_event>(q, CL_COMMAND_BARRIER, ref_vector<event> {});
 
    return CL_SUCCESS;
 
@@ -226,7 +236,8 @@ clEnqueueBarrierWithWaitList(cl_command_queue d_q, cl_uint num_deps,
 
    // Create a hard event that depends on the events in the wait list:
    // subsequent commands in the same queue will be implicitly
-   // serialized with respect to it -- hard events always are.
+   // serialized with respect to it -- hard events always are, and so
+   // are barriers in out-of-order queues.
    auto hev = create<hard_event>(q, CL_COMMAND_BARRIER, deps);
 
    ret_object(rd_ev, hev);
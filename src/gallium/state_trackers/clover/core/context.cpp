@@ -27,7 +27,18 @@ using namespace clover;
 context::context(const property_list &props,
                  const ref_vector<device> &devs,
                  const notify_action &notify) :
-   notify(notify), props(props), devs(devs) {
+   notify(notify), props(props), devs(devs), deferred_running(false) {
+}
+
+context::~context() {
+   if (deferred_thread.joinable()) {
+      // The last reference may be dropped by a task of the worker
+      // itself.
+      if (deferred_thread.get_id() == std::this_thread::get_id())
+         deferred_thread.detach();
+      else
+         deferred_thread.join();
+   }
 }
 
 bool
@@ -49,3 +60,41 @@ context::device_range
 context::devices() const {
    return map(evals(), devs);
 }
+
+void
+context::defer(const task &t) {
+   std::lock_guard<std::mutex> lock(deferred_mutex);
+
+   deferred.push_back(t);
+
+   if (!deferred_running) {
+      if (deferred_thread.joinable())
+         deferred_thread.join();
+
+      deferred_thread = std::thread(&context::run_deferred, this);
+      deferred_running = true;
+   }
+}
+
+void
+context::run_deferred() {
+   std::unique_lock<std::mutex> lock(deferred_mutex);
+
+   while (true) {
+      task t = std::move(deferred.front());
+      deferred.pop_front();
+
+      lock.unlock();
+      t();
+      lock.lock();
+
+      if (deferred.empty()) {
+         // The worker exits once it runs out of tasks.  The last task
+         // may hold the last reference to the context, so it's released
+         // on the way out without touching the context anymore.
+         deferred_running = false;
+         lock.unlock();
+         return;
+      }
+   }
+}
@@ -23,6 +23,10 @@
 #ifndef CLOVER_CORE_CONTEXT_HPP
 #define CLOVER_CORE_CONTEXT_HPP
 
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "core/object.hpp"
 #include "core/device.hpp"
 #include "core/property.hpp"
@@ -38,8 +42,11 @@ namespace clover {
    public:
       typedef std::function<void (const char *)> notify_action;
 
+      typedef std::function<void ()> task;
+
       context(const property_list &props, const ref_vector<device> &devs,
               const notify_action &notify);
+      ~context();
 
       context(const context &ctx) = delete;
       context &
@@ -56,11 +63,26 @@ namespace clover {
       device_range
       devices() const;
 
+      ///
+      /// Run \a t asynchronously in a worker thread of the context.
+      /// Tasks are run in the order they were deferred, and may block
+      /// waiting for the device without stalling the application.
+      ///
+      void
+      defer(const task &t);
+
       const notify_action notify;
 
    private:
+      void run_deferred();
+
       property_list props;
       const std::vector<intrusive_ref<device>> devs;
+
+      std::deque<task> deferred;
+      std::mutex deferred_mutex;
+      std::thread deferred_thread;
+      bool deferred_running;
    };
 }
 
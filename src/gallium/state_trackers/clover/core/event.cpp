@@ -115,9 +115,24 @@ event::wait() const {
    cv.wait(lock, [=]{ return !wait_count; });
 }
 
+void
+event::wait_completion() const {
+   for (event &ev : deps)
+      ev.wait_completion();
+
+   std::unique_lock<std::mutex> lock(mutex);
+   cv.wait(lock, [=]{ return !wait_count; });
+}
+
 hard_event::hard_event(command_queue &q, cl_command_type command,
                        const ref_vector<event> &deps, action action) :
-   event(q.context(), deps, profile(q, action), [](event &ev){}),
+   event(q.context(), deps, profile(q, action),
+         [](event &ev) {
+            // Wake up anybody waiting for a fence that will never come.
+            auto &hev = static_cast<hard_event &>(ev);
+            std::lock_guard<std::mutex> lock(hev.fence_mutex);
+            hev.fence_cv.notify_all();
+         }),
    _queue(q), _command(command), _fence(NULL) {
    if (q.profiling_enabled())
       _time_queued = timestamp::current(q);
@@ -172,6 +187,26 @@ hard_event::wait() const {
       throw error(CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST);
 }
 
+void
+hard_event::wait_completion() const {
+   pipe_screen *screen = queue()->device().pipe;
+   pipe_fence_handle *fence = NULL;
+
+   event::wait_completion();
+
+   {
+      std::unique_lock<std::mutex> lock(fence_mutex);
+      fence_cv.wait(lock, [=]{ return _fence || event::status() < 0; });
+      screen->fence_reference(screen, &fence, _fence);
+   }
+
+   if (!fence)
+      return;
+
+   screen->fence_finish(screen, NULL, fence, PIPE_TIMEOUT_INFINITE);
+   screen->fence_reference(screen, &fence, NULL);
+}
+
 const lazy<cl_ulong> &
 hard_event::time_queued() const {
    return _time_queued;
@@ -195,7 +230,10 @@ hard_event::time_end() const {
 void
 hard_event::fence(pipe_fence_handle *fence) {
    pipe_screen *screen = queue()->device().pipe;
+   std::lock_guard<std::mutex> lock(fence_mutex);
+
    screen->fence_reference(screen, &_fence, fence);
+   fence_cv.notify_all();
 }
 
 event::action
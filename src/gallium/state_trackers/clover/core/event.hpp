@@ -71,6 +71,14 @@ namespace clover {
       virtual cl_command_type command() const = 0;
       virtual void wait() const;
 
+      ///
+      /// Wait for the completion of the event like wait(), but without
+      /// flushing any command queue, so it can be called from threads
+      /// other than the application's.  Work that hasn't been flushed
+      /// yet is waited for until somebody else flushes it.
+      ///
+      virtual void wait_completion() const;
+
       virtual struct pipe_fence_handle *fence() const {
          return NULL;
       }
@@ -118,6 +126,7 @@ namespace clover {
       virtual command_queue *queue() const;
       virtual cl_command_type command() const;
       virtual void wait() const;
+      virtual void wait_completion() const;
 
       const lazy<cl_ulong> &time_queued() const;
       const lazy<cl_ulong> &time_submit() const;
@@ -137,6 +146,8 @@ namespace clover {
       const intrusive_ref<command_queue> _queue;
       cl_command_type _command;
       pipe_fence_handle *_fence;
+      mutable std::condition_variable fence_cv;
+      mutable std::mutex fence_mutex;
       lazy<cl_ulong> _time_queued, _time_submit, _time_start, _time_end;
    };
 
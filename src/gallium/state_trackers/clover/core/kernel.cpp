@@ -150,6 +150,11 @@ kernel::exec_context::exec_context(kernel &kern) :
 }
 
 kernel::exec_context::~exec_context() {
+   if (q) {
+      for (auto &arg : kern.args())
+         arg.unbind(*this);
+   }
+
    if (st)
       q->pipe->delete_compute_state(q->pipe, st);
 }
@@ -157,6 +162,13 @@ kernel::exec_context::~exec_context() {
 void *
 kernel::exec_context::bind(intrusive_ptr<command_queue> _q,
                            const std::vector<size_t> &grid_offset) {
+   // The state kept by the arguments between launches belongs to the
+   // pipe context of the previous queue.
+   if (q && q != _q) {
+      for (auto &arg : kern.args())
+         arg.unbind(*this);
+   }
+
    std::swap(q, _q);
 
    // Bind kernel arguments.
@@ -238,9 +250,6 @@ kernel::exec_context::bind(intrusive_ptr<command_queue> _q,
 
 void
 kernel::exec_context::unbind() {
-   for (auto &arg : kern.args())
-      arg.unbind(*this);
-
    input.clear();
    samplers.clear();
    sviews.clear();
@@ -356,7 +365,7 @@ kernel::argument::create(const module::argument &marg) {
    throw error(CL_INVALID_KERNEL_DEFINITION);
 }
 
-kernel::argument::argument() : _set(false) {
+kernel::argument::argument() : _set(false), _dirty(true) {
 }
 
 bool
@@ -382,21 +391,26 @@ kernel::scalar_argument::set(size_t size, const void *value) {
 
    v = { (uint8_t *)value, (uint8_t *)value + size };
    _set = true;
+   _dirty = true;
 }
 
 void
 kernel::scalar_argument::bind(exec_context &ctx,
                               const module::argument &marg) {
-   auto w = v;
+   if (_dirty) {
+      w = v;
+      extend(w, marg.ext_type, marg.target_size);
+      byteswap(w, ctx.q->device().endianness());
+      _dirty = false;
+   }
 
-   extend(w, marg.ext_type, marg.target_size);
-   byteswap(w, ctx.q->device().endianness());
    align(ctx.input, marg.target_align);
    insert(ctx.input, w);
 }
 
 void
 kernel::scalar_argument::unbind(exec_context &ctx) {
+   _dirty = true;
 }
 
 void
@@ -406,6 +420,7 @@ kernel::global_argument::set(size_t size, const void *value) {
 
    buf = pobj<buffer>(value ? *(cl_mem *)value : NULL);
    _set = true;
+   _dirty = true;
 }
 
 void
@@ -450,6 +465,7 @@ kernel::local_argument::set(size_t size, const void *value) {
 
    _storage = size;
    _set = true;
+   _dirty = true;
 }
 
 void
@@ -476,6 +492,7 @@ kernel::constant_argument::set(size_t size, const void *value) {
 
    buf = pobj<buffer>(value ? *(cl_mem *)value : NULL);
    _set = true;
+   _dirty = true;
 }
 
 void
@@ -491,7 +508,11 @@ kernel::constant_argument::bind(exec_context &ctx,
       byteswap(v, ctx.q->device().endianness());
       insert(ctx.input, v);
 
-      st = r.bind_surface(*ctx.q, false);
+      if (_dirty) {
+         unbind(ctx);
+         st = r.bind_surface(*ctx.q, false);
+         _dirty = false;
+      }
       ctx.resources.push_back(st);
    } else {
       // Null pointer.
@@ -501,8 +522,12 @@ kernel::constant_argument::bind(exec_context &ctx,
 
 void
 kernel::constant_argument::unbind(exec_context &ctx) {
-   if (buf)
-      buf->resource(*ctx.q).unbind_surface(*ctx.q, st);
+   // The buffer may be gone already, release the surface directly.
+   if (st)
+      ctx.q->pipe->surface_destroy(ctx.q->pipe, st);
+
+   st = NULL;
+   _dirty = true;
 }
 
 void
@@ -515,6 +540,7 @@ kernel::image_rd_argument::set(size_t size, const void *value) {
 
    img = &obj<image>(*(cl_mem *)value);
    _set = true;
+   _dirty = true;
 }
 
 void
@@ -527,13 +553,22 @@ kernel::image_rd_argument::bind(exec_context &ctx,
    align(ctx.input, marg.target_align);
    insert(ctx.input, v);
 
-   st = img->resource(*ctx.q).bind_sampler_view(*ctx.q);
+   if (_dirty) {
+      unbind(ctx);
+      st = img->resource(*ctx.q).bind_sampler_view(*ctx.q);
+      _dirty = false;
+   }
    ctx.sviews.push_back(st);
 }
 
 void
 kernel::image_rd_argument::unbind(exec_context &ctx) {
-   img->resource(*ctx.q).unbind_sampler_view(*ctx.q, st);
+   // The image may be gone already, release the view directly.
+   if (st)
+      ctx.q->pipe->sampler_view_destroy(ctx.q->pipe, st);
+
+   st = NULL;
+   _dirty = true;
 }
 
 void
@@ -546,6 +581,7 @@ kernel::image_wr_argument::set(size_t size, const void *value) {
 
    img = &obj<image>(*(cl_mem *)value);
    _set = true;
+   _dirty = true;
 }
 
 void
@@ -558,13 +594,22 @@ kernel::image_wr_argument::bind(exec_context &ctx,
    align(ctx.input, marg.target_align);
    insert(ctx.input, v);
 
-   st = img->resource(*ctx.q).bind_surface(*ctx.q, true);
+   if (_dirty) {
+      unbind(ctx);
+      st = img->resource(*ctx.q).bind_surface(*ctx.q, true);
+      _dirty = false;
+   }
    ctx.resources.push_back(st);
 }
 
 void
 kernel::image_wr_argument::unbind(exec_context &ctx) {
-   img->resource(*ctx.q).unbind_surface(*ctx.q, st);
+   // The image may be gone already, release the surface directly.
+   if (st)
+      ctx.q->pipe->surface_destroy(ctx.q->pipe, st);
+
+   st = NULL;
+   _dirty = true;
 }
 
 void
@@ -577,16 +622,26 @@ kernel::sampler_argument::set(size_t size, const void *value) {
 
    s = &obj(*(cl_sampler *)value);
    _set = true;
+   _dirty = true;
 }
 
 void
 kernel::sampler_argument::bind(exec_context &ctx,
                                const module::argument &marg) {
-   st = s->bind(*ctx.q);
+   if (_dirty) {
+      unbind(ctx);
+      st = s->bind(*ctx.q);
+      _dirty = false;
+   }
    ctx.samplers.push_back(st);
 }
 
 void
 kernel::sampler_argument::unbind(exec_context &ctx) {
-   s->unbind(*ctx.q, st);
+   // The sampler may be gone already, release the state directly.
+   if (st)
+      ctx.q->pipe->delete_sampler_state(ctx.q->pipe, st);
+
+   st = NULL;
+   _dirty = true;
 }
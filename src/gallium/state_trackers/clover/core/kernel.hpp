@@ -87,6 +87,8 @@ namespace clover {
 
          /// Allocate the necessary resources to bind the specified
          /// object to this argument, and update \a ctx accordingly.
+         /// Resources allocated by a previous bind() are reused unless
+         /// the argument has been set again since.
          virtual void bind(exec_context &ctx,
                            const module::argument &marg) = 0;
 
@@ -97,6 +99,9 @@ namespace clover {
          argument();
 
          bool _set;
+
+         /// \a true if the argument has been set since the last bind().
+         bool _dirty;
       };
 
    private:
@@ -152,6 +157,7 @@ namespace clover {
       private:
          size_t size;
          std::vector<uint8_t> v;
+         std::vector<uint8_t> w;
       };
 
       class global_argument : public argument {
@@ -187,7 +193,7 @@ namespace clover {
 
       private:
          buffer *buf;
-         pipe_surface *st;
+         pipe_surface *st = NULL;
       };
 
       class image_argument : public argument {
@@ -207,7 +213,7 @@ namespace clover {
          virtual void unbind(exec_context &ctx);
 
       private:
-         pipe_sampler_view *st;
+         pipe_sampler_view *st = NULL;
       };
 
       class image_wr_argument : public image_argument {
@@ -218,7 +224,7 @@ namespace clover {
          virtual void unbind(exec_context &ctx);
 
       private:
-         pipe_surface *st;
+         pipe_surface *st = NULL;
       };
 
       class sampler_argument : public argument {
@@ -230,7 +236,7 @@ namespace clover {
 
       private:
          sampler *s;
-         void *st;
+         void *st = NULL;
       };
 
       std::vector<std::unique_ptr<argument>> _args;
@@ -72,14 +72,24 @@ command_queue::flush() {
    if (!queued_events.empty()) {
       pipe->flush(pipe, &fence, 0);
 
-      while (!queued_events.empty() &&
-             queued_events.front()().signalled()) {
-         queued_events.front()().fence(fence);
-         queued_events.pop_front();
+      // Every command that has been executed so far is covered by the
+      // fence.  In an in-order queue that's always a prefix of the list,
+      // in an out-of-order queue later commands may have overtaken
+      // earlier ones still waiting for their dependencies.
+      for (auto it = queued_events.begin(); it != queued_events.end();) {
+         if ((*it)().signalled()) {
+            (*it)().fence(fence);
+            it = queued_events.erase(it);
+         } else {
+            ++it;
+         }
       }
 
       screen->fence_reference(screen, &fence, NULL);
    }
+
+   if (barrier && barrier->signalled())
+      barrier = NULL;
 }
 
 cl_command_queue_properties
@@ -92,11 +102,39 @@ command_queue::profiling_enabled() const {
    return props & CL_QUEUE_PROFILING_ENABLE;
 }
 
+bool
+command_queue::out_of_order() const {
+   return props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+}
+
 void
 command_queue::sequence(hard_event &ev) {
    std::lock_guard<std::mutex> lock(queued_events_mutex);
-   if (!queued_events.empty())
-      queued_events.back()().chain(ev);
+
+   if (!out_of_order()) {
+      if (!queued_events.empty())
+         queued_events.back()().chain(ev);
+
+   } else {
+      // Barriers, and markers without a wait list, depend on every
+      // command enqueued before them.  Anything else only waits for its
+      // own wait list and the last barrier, so that independent commands
+      // get executed as soon as they're ready.
+      const bool sync_point = ev.deps.empty() &&
+         (ev.command() == CL_COMMAND_BARRIER ||
+          ev.command() == CL_COMMAND_MARKER || !ev.command());
+
+      if (barrier)
+         barrier->chain(ev);
+
+      if (sync_point) {
+         for (hard_event &qev : queued_events)
+            qev.chain(ev);
+      }
+
+      if (ev.command() == CL_COMMAND_BARRIER)
+         barrier = &ev;
+   }
 
    queued_events.push_back(ev);
 }
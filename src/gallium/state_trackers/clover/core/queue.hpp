@@ -50,6 +50,7 @@ namespace clover {
 
       cl_command_queue_properties properties() const;
       bool profiling_enabled() const;
+      bool out_of_order() const;
 
       const intrusive_ref<clover::context> context;
       const intrusive_ref<clover::device> device;
@@ -65,13 +66,17 @@ namespace clover {
 
    private:
       /// Serialize a hardware event with respect to the previous ones,
-      /// and push it to the pending list.
+      /// and push it to the pending list.  In an out-of-order queue
+      /// only barriers and markers are serialized.
       void sequence(hard_event &ev);
 
       cl_command_queue_properties props;
       pipe_context *pipe;
       std::mutex queued_events_mutex;
       std::deque<intrusive_ref<hard_event>> queued_events;
+
+      /// Last barrier of an out-of-order queue that may still be pending.
+      intrusive_ptr<hard_event> barrier;
    };
 }
 
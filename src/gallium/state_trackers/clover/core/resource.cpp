@@ -148,6 +148,14 @@ root_resource::root_resource(clover::device &dev, memory_obj &obj,
 
    if (obj.flags() & (CL_MEM_ALLOC_HOST_PTR | CL_MEM_USE_HOST_PTR)) {
       info.usage = PIPE_USAGE_STAGING;
+
+      // Host accessible buffers get mapped directly, without going
+      // through a staging copy on every map and unmap.
+      if (info.target == PIPE_BUFFER &&
+          dev.pipe->get_param(dev.pipe,
+                              PIPE_CAP_BUFFER_MAP_PERSISTENT_COHERENT))
+         info.flags = (PIPE_RESOURCE_FLAG_MAP_PERSISTENT |
+                       PIPE_RESOURCE_FLAG_MAP_COHERENT);
    }
 
    pipe = dev.pipe->resource_create(dev.pipe, &info);
@@ -194,7 +202,9 @@ mapping::mapping(command_queue &q, resource &r,
                      (flags & CL_MAP_READ ? PIPE_TRANSFER_READ : 0 ) |
                      (flags & CL_MAP_WRITE_INVALIDATE_REGION ?
                       PIPE_TRANSFER_DISCARD_RANGE : 0) |
-                     (!blocking ? PIPE_TRANSFER_UNSYNCHRONIZED : 0));
+                     (!blocking ? PIPE_TRANSFER_UNSYNCHRONIZED : 0) |
+                     (r.pipe->flags & PIPE_RESOURCE_FLAG_MAP_PERSISTENT ?
+                      PIPE_TRANSFER_PERSISTENT | PIPE_TRANSFER_COHERENT : 0));
 
    p = pctx->transfer_map(pctx, r.pipe, 0, usage,
                           box(origin + r.offset, region), &pxfer);
@@ -52,7 +52,11 @@
 #include "llvm/metadata.hpp"
 #include "llvm/util.hpp"
 #include "util/algorithm.hpp"
+#include "util/disk_cache.h"
+#include "util/mesa-sha1.h"
+#include "git_sha1.h"
 
+#include <sstream>
 
 using namespace clover;
 using namespace clover::llvm;
@@ -191,6 +195,121 @@ namespace {
 
       return act.takeModule();
    }
+
+   struct disk_cache *
+   get_disk_cache() {
+      static struct disk_cache *cache = disk_cache_create();
+      return cache;
+   }
+
+   ///
+   /// Build a cache key from the build stage, the version of Mesa and
+   /// LLVM, and every input of the stage.
+   ///
+   class cache_key_builder {
+   public:
+      cache_key_builder(const std::string &stage) {
+         add(""
+#ifdef PACKAGE_VERSION
+             PACKAGE_VERSION
+#endif
+#ifdef MESA_GIT_SHA1
+             MESA_GIT_SHA1
+#endif
+             );
+         add(std::to_string(HAVE_LLVM) + "." +
+             std::to_string(MESA_LLVM_VERSION_PATCH));
+         add(stage);
+      }
+
+      cache_key_builder &
+      add(const std::string &s) {
+         const uint32_t n = s.size();
+         blob.append(reinterpret_cast<const char *>(&n), sizeof(n));
+         blob.append(s);
+         return *this;
+      }
+
+      cache_key_builder &
+      add(const module &m) {
+         std::ostringstream os;
+         m.serialize(os);
+         return add(os.str());
+      }
+
+      void
+      compute(cache_key key) const {
+         _mesa_sha1_compute(blob.data(), blob.size(), key);
+      }
+
+   private:
+      std::string blob;
+   };
+
+   bool
+   get_cached_module(cache_key key, module &m, std::string &r_log) {
+      size_t size;
+      void *data = disk_cache_get(get_disk_cache(), key, &size);
+      if (!data)
+         return false;
+
+      std::istringstream is(std::string(static_cast<char *>(data), size));
+      free(data);
+
+      try {
+         uint32_t n = 0;
+         std::string log;
+
+         is.read(reinterpret_cast<char *>(&n), sizeof(n));
+         if (!is)
+            return false;
+
+         log.resize(n);
+         is.read(&log[0], n);
+         m = module::deserialize(is);
+         if (!is)
+            return false;
+
+         r_log += log;
+         return true;
+
+      } catch (std::exception &) {
+         return false;
+      }
+   }
+
+   void
+   put_cached_module(cache_key key, const module &m,
+                     const std::string &log) {
+      std::ostringstream os;
+      const uint32_t n = log.size();
+
+      os.write(reinterpret_cast<const char *>(&n), sizeof(n));
+      os.write(log.data(), n);
+      m.serialize(os);
+
+      const std::string data = os.str();
+      disk_cache_put(get_disk_cache(), key, data.data(), data.size());
+   }
+
+   module
+   do_compile_program(const std::string &source, const header_map &headers,
+                      const std::string &target, const std::string &opts,
+                      std::string &r_log) {
+      if (has_flag(debug::clc))
+         debug::log(".cl", "// Options: " + opts + '\n' + source);
+
+      auto ctx = create_context(r_log);
+      auto c = create_compiler_instance(target, tokenize(opts + " input.cl"),
+                                        r_log);
+      auto mod = compile(*ctx, *c, "input.cl", source, headers, target, opts,
+                         r_log);
+
+      if (has_flag(debug::llvm))
+         debug::log(".ll", print_module_bitcode(*mod));
+
+      return build_module_library(*mod, module::section::text_intermediate);
+   }
 }
 
 module
@@ -199,19 +318,26 @@ clover::llvm::compile_program(const std::string &source,
                               const std::string &target,
                               const std::string &opts,
                               std::string &r_log) {
-   if (has_flag(debug::clc))
-      debug::log(".cl", "// Options: " + opts + '\n' + source);
-
-   auto ctx = create_context(r_log);
-   auto c = create_compiler_instance(target, tokenize(opts + " input.cl"),
-                                     r_log);
-   auto mod = compile(*ctx, *c, "input.cl", source, headers, target, opts,
-                      r_log);
-
-   if (has_flag(debug::llvm))
-      debug::log(".ll", print_module_bitcode(*mod));
-
-   return build_module_library(*mod, module::section::text_intermediate);
+   // The debug output is expected to show up on every build.
+   if (!get_disk_cache() || has_flag(debug::clc) || has_flag(debug::llvm))
+      return do_compile_program(source, headers, target, opts, r_log);
+
+   cache_key_builder kb("compile");
+   kb.add(target).add(opts).add(source);
+   for (auto &h : headers)
+      kb.add(h.first).add(h.second);
+
+   cache_key key;
+   kb.compute(key);
+
+   module m;
+   if (get_cached_module(key, m, r_log))
+      return m;
+
+   const size_t log_start = r_log.size();
+   m = do_compile_program(source, headers, target, opts, r_log);
+   put_cached_module(key, m, r_log.substr(log_start));
+   return m;
 }
 
 namespace {
@@ -260,38 +386,63 @@ namespace {
 
       return std::move(mod);
    }
-}
 
-module
-clover::llvm::link_program(const std::vector<module> &modules,
-                           enum pipe_shader_ir ir, const std::string &target,
-                           const std::string &opts, std::string &r_log) {
-   std::vector<std::string> options = tokenize(opts + " input.cl");
-   const bool create_library = count("-create-library", options);
-   erase_if(equals("-create-library"), options);
+   module
+   do_link_program(const std::vector<module> &modules,
+                   enum pipe_shader_ir ir, const std::string &target,
+                   const std::string &opts, std::string &r_log) {
+      std::vector<std::string> options = tokenize(opts + " input.cl");
+      const bool create_library = count("-create-library", options);
+      erase_if(equals("-create-library"), options);
 
-   auto ctx = create_context(r_log);
-   auto c = create_compiler_instance(target, options, r_log);
-   auto mod = link(*ctx, *c, modules, r_log);
+      auto ctx = create_context(r_log);
+      auto c = create_compiler_instance(target, options, r_log);
+      auto mod = link(*ctx, *c, modules, r_log);
 
-   optimize(*mod, c->getCodeGenOpts().OptimizationLevel, !create_library);
+      optimize(*mod, c->getCodeGenOpts().OptimizationLevel, !create_library);
 
-   if (has_flag(debug::llvm))
-      debug::log(".ll", print_module_bitcode(*mod));
+      if (has_flag(debug::llvm))
+         debug::log(".ll", print_module_bitcode(*mod));
 
-   if (create_library) {
-      return build_module_library(*mod, module::section::text_library);
+      if (create_library) {
+         return build_module_library(*mod, module::section::text_library);
 
-   } else if (ir == PIPE_SHADER_IR_LLVM) {
-      return build_module_bitcode(*mod, *c);
+      } else if (ir == PIPE_SHADER_IR_LLVM) {
+         return build_module_bitcode(*mod, *c);
 
-   } else if (ir == PIPE_SHADER_IR_NATIVE) {
-      if (has_flag(debug::native))
-         debug::log(".asm", print_module_native(*mod, target));
+      } else if (ir == PIPE_SHADER_IR_NATIVE) {
+         if (has_flag(debug::native))
+            debug::log(".asm", print_module_native(*mod, target));
 
-      return build_module_native(*mod, target, *c, r_log);
+         return build_module_native(*mod, target, *c, r_log);
 
-   } else {
-      unreachable("Unsupported IR.");
+      } else {
+         unreachable("Unsupported IR.");
+      }
    }
 }
+
+module
+clover::llvm::link_program(const std::vector<module> &modules,
+                           enum pipe_shader_ir ir, const std::string &target,
+                           const std::string &opts, std::string &r_log) {
+   if (!get_disk_cache() || has_flag(debug::llvm) || has_flag(debug::native))
+      return do_link_program(modules, ir, target, opts, r_log);
+
+   cache_key_builder kb("link");
+   kb.add(std::to_string(ir)).add(target).add(opts);
+   for (auto &m : modules)
+      kb.add(m);
+
+   cache_key key;
+   kb.compute(key);
+
+   module m;
+   if (get_cached_module(key, m, r_log))
+      return m;
+
+   const size_t log_start = r_log.size();
+   m = do_link_program(modules, ir, target, opts, r_log);
+   put_cached_module(key, m, r_log.substr(log_start));
+   return m;
+}
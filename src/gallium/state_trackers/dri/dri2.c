@@ -1617,6 +1617,10 @@ static const __DRIrobustnessExtension dri2Robustness = {
    .base = { __DRI2_ROBUSTNESS, 1 }
 };
 
+static const __DRInoErrorExtension dri2NoError = {
+   .base = { __DRI2_NO_ERROR, 1 }
+};
+
 static int
 dri2_interop_query_device_info(__DRIcontext *_ctx,
                                struct mesa_glinterop_device_info *out)
@@ -1889,6 +1893,7 @@ static const __DRIextension *dri_screen_extensions[] = {
    &dri2ThrottleExtension.base,
    &dri2FenceExtension.base,
    &dri2InteropExtension.base,
+   &dri2NoError.base,
    NULL
 };
 
@@ -1902,6 +1907,7 @@ static const __DRIextension *dri_robust_screen_extensions[] = {
    &dri2FenceExtension.base,
    &dri2InteropExtension.base,
    &dri2Robustness.base,
+   &dri2NoError.base,
    NULL
 };
 
@@ -34,6 +34,7 @@
 #include "dri_drawable.h"
 
 #include "pipe/p_screen.h"
+#include "os/os_time.h"
 #include "util/u_format.h"
 #include "util/u_memory.h"
 #include "util/u_inlines.h"
@@ -523,8 +524,14 @@ dri_flush(__DRIcontext *cPriv,
 
       fence = swap_fences_pop_front(drawable);
       if (fence) {
+         int64_t start = ctx->hud ? os_time_get_nano() : 0;
+
          (void) screen->fence_finish(screen, NULL, fence, PIPE_TIMEOUT_INFINITE);
          screen->fence_reference(screen, &fence, NULL);
+
+         if (ctx->hud)
+            hud_add_frame_phase_time(ctx->hud, HUD_FRAME_PHASE_FENCE_WAIT,
+                                     os_time_get_nano() - start);
       }
 
       ctx->st->flush(ctx->st, flush_flags, &fence);
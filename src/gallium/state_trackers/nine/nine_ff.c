@@ -23,12 +23,32 @@
 #include "util/u_box.h"
 #include "util/u_hash_table.h"
 #include "util/u_upload_mgr.h"
+#include "util/hash_table.h"
 
 #define DBG_CHANNEL DBG_FF
 
 #define NINE_FF_NUM_VS_CONST 196
 #define NINE_FF_NUM_PS_CONST 24
 
+/* State groups that the keys built by nine_ff_get_vs and nine_ff_get_ps
+ * depend on. Switching to the fixed function pipeline sets NINE_STATE_VS or
+ * NINE_STATE_PS, so changes made while a shader was bound are seen too. */
+#define NINE_FF_VS_KEY_GROUPS \
+   (NINE_STATE_VS |           \
+    NINE_STATE_VDECL |        \
+    NINE_STATE_RASTERIZER |   \
+    NINE_STATE_FF_LIGHTING |  \
+    NINE_STATE_FF_PSSTAGES |  \
+    NINE_STATE_FF_OTHER)
+
+#define NINE_FF_PS_KEY_GROUPS \
+   (NINE_STATE_PS |           \
+    NINE_STATE_VDECL |        \
+    NINE_STATE_TEXTURE |      \
+    NINE_STATE_FF_LIGHTING |  \
+    NINE_STATE_FF_PSSTAGES |  \
+    NINE_STATE_FF_OTHER)
+
 struct fvec4
 {
     float x, y, z, w;
@@ -123,14 +143,12 @@ struct nine_ff_ps_key
     };
 };
 
+/* XOR-ing the words together made e.g. keys that only differ by swapped
+ * texture stages collide, so hash all the bytes instead. */
 static unsigned nine_ff_vs_key_hash(void *key)
 {
     struct nine_ff_vs_key *vs = key;
-    unsigned i;
-    uint32_t hash = vs->value32[0];
-    for (i = 1; i < ARRAY_SIZE(vs->value32); ++i)
-        hash ^= vs->value32[i];
-    return hash;
+    return _mesa_hash_data(vs->value32, sizeof(vs->value32));
 }
 static int nine_ff_vs_key_comp(void *key1, void *key2)
 {
@@ -142,11 +160,7 @@ static int nine_ff_vs_key_comp(void *key1, void *key2)
 static unsigned nine_ff_ps_key_hash(void *key)
 {
     struct nine_ff_ps_key *ps = key;
-    unsigned i;
-    uint32_t hash = ps->value32[0];
-    for (i = 1; i < ARRAY_SIZE(ps->value32); ++i)
-        hash ^= ps->value32[i];
-    return hash;
+    return _mesa_hash_data(ps->value32, sizeof(ps->value32));
 }
 static int nine_ff_ps_key_comp(void *key1, void *key2)
 {
@@ -2016,13 +2030,21 @@ nine_ff_update(struct NineDevice9 *device)
     DBG("vs=%p ps=%p\n", device->state.vs, device->state.ps);
 
     /* NOTE: the only reference belongs to the hash table */
-    if (!state->programmable_vs) {
-        device->ff.vs = nine_ff_get_vs(device);
-        device->state.changed.group |= NINE_STATE_VS;
+    if (!state->programmable_vs &&
+        (!device->ff.vs || (state->changed.group & NINE_FF_VS_KEY_GROUPS))) {
+        struct NineVertexShader9 *vs = nine_ff_get_vs(device);
+        if (vs != device->ff.vs) {
+            device->ff.vs = vs;
+            device->state.changed.group |= NINE_STATE_VS;
+        }
     }
-    if (!device->state.ps) {
-        device->ff.ps = nine_ff_get_ps(device);
-        device->state.changed.group |= NINE_STATE_PS;
+    if (!device->state.ps &&
+        (!device->ff.ps || (state->changed.group & NINE_FF_PS_KEY_GROUPS))) {
+        struct NinePixelShader9 *ps = nine_ff_get_ps(device);
+        if (ps != device->ff.ps) {
+            device->ff.ps = ps;
+            device->state.changed.group |= NINE_STATE_PS;
+        }
     }
 
     if (!state->programmable_vs) {
@@ -665,39 +665,48 @@ update_vertex_elements(struct NineDevice9 *device)
     state->changed.stream_freq = 0;
 }
 
+/* Binds all the dirty streams with a single set_vertex_buffers call, as
+ * draws typically change several of them at once. The clean streams in
+ * between are rebound with their current buffer, which is harmless. */
 static void
 update_vertex_buffers(struct NineDevice9 *device)
 {
     struct pipe_context *pipe = device->pipe;
     struct nine_state *state = &device->state;
-    struct pipe_vertex_buffer dummy_vtxbuf;
+    struct pipe_vertex_buffer vtxbuf[PIPE_MAX_ATTRIBS];
     uint32_t mask = state->changed.vtxbuf;
-    unsigned i;
+    unsigned i, start, count;
 
     DBG("mask=%x\n", mask);
 
     if (state->dummy_vbo_bound_at >= 0) {
-        if (!state->vbo_bound_done) {
-            dummy_vtxbuf.buffer = device->dummy_vbo;
-            dummy_vtxbuf.stride = 0;
-            dummy_vtxbuf.user_buffer = NULL;
-            dummy_vtxbuf.buffer_offset = 0;
-            pipe->set_vertex_buffers(pipe, state->dummy_vbo_bound_at,
-                                     1, &dummy_vtxbuf);
-            state->vbo_bound_done = TRUE;
-        }
-        mask &= ~(1 << state->dummy_vbo_bound_at);
-    }
-
-    for (i = 0; mask; mask >>= 1, ++i) {
-        if (mask & 1) {
-            if (state->vtxbuf[i].buffer)
-                pipe->set_vertex_buffers(pipe, i, 1, &state->vtxbuf[i]);
-            else
-                pipe->set_vertex_buffers(pipe, i, 1, NULL);
+        if (!state->vbo_bound_done)
+            mask |= 1 << state->dummy_vbo_bound_at;
+        else
+            mask &= ~(1 << state->dummy_vbo_bound_at);
+    }
+
+    if (mask) {
+        start = ffs(mask) - 1;
+        count = util_last_bit(mask) - start;
+
+        for (i = start; i < start + count; ++i) {
+            if ((int)i == state->dummy_vbo_bound_at) {
+                vtxbuf[i].buffer = device->dummy_vbo;
+                vtxbuf[i].stride = 0;
+                vtxbuf[i].user_buffer = NULL;
+                vtxbuf[i].buffer_offset = 0;
+            } else if (state->vtxbuf[i].buffer) {
+                vtxbuf[i] = state->vtxbuf[i];
+            } else {
+                memset(&vtxbuf[i], 0, sizeof(vtxbuf[i]));
+            }
         }
+        pipe->set_vertex_buffers(pipe, start, count, &vtxbuf[start]);
     }
 
+    if (state->dummy_vbo_bound_at >= 0)
+        state->vbo_bound_done = TRUE;
     state->changed.vtxbuf = 0;
 }
 
@@ -35,12 +35,15 @@
  * display target resource.  However, softpipe doesn't support "upside-down"
  * rendering which would be needed for the OSMESA_Y_UP=TRUE case.
  *
- * With llvmpipe we could only render directly into the user's buffer when its
- * width and height is a multiple of the tile size (64 pixels).
+ * With llvmpipe we can only render directly into the user's buffer when its
+ * rows are laid out the way llvmpipe would lay them out itself, and when
+ * OSMESA_Y_UP is FALSE.
  *
- * Because of these constraints we always render into ordinary resources then
- * copy the results to the user's buffer in the flush_front() function which
- * is called when the app calls glFlush/Finish.
+ * So when the driver can wrap the user's buffer in a resource (see
+ * resource_from_user_memory) we render straight into it.  Otherwise we
+ * render into ordinary resources then copy the results to the user's buffer
+ * in the flush_front() function which is called when the app calls
+ * glFlush/Finish.
  *
  * In general, the OSMesa interface is pretty ugly and not a good match
  * for Gallium.  But we're interested in doing the best we can to preserve
@@ -87,6 +90,12 @@ struct osmesa_buffer
 
    void *map;
 
+   /** Whether the color buffer should wrap the user's buffer */
+   boolean render_to_map;
+
+   /** Whether the color buffer currently wraps the user's buffer */
+   boolean user_memory;
+
    struct osmesa_buffer *next;  /**< next in linked list */
 };
 
@@ -346,6 +355,12 @@ osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
    map = pipe->transfer_map(pipe, res, 0, PIPE_TRANSFER_READ, &box,
                             &transfer);
 
+   if (osbuffer->user_memory) {
+      /* Rendered in place; mapping was only needed to wait for rendering. */
+      pipe->transfer_unmap(pipe, transfer);
+      return TRUE;
+   }
+
    /*
     * Copy the color buffer from the resource to the user's buffer.
     */
@@ -416,6 +431,19 @@ osmesa_st_framebuffer_validate(struct st_context_iface *stctx,
       if (statts[i] == ST_ATTACHMENT_FRONT_LEFT) {
          format = osbuffer->visual.color_format;
          bind = PIPE_BIND_RENDER_TARGET;
+
+         osbuffer->user_memory = FALSE;
+         if (osbuffer->render_to_map) {
+            templat.format = format;
+            templat.bind = bind;
+            out[i] = screen->resource_from_user_memory(screen, &templat,
+                                                       osbuffer->map);
+            if (out[i]) {
+               osbuffer->textures[statts[i]] = out[i];
+               osbuffer->user_memory = TRUE;
+               continue;
+            }
+         }
       }
       else if (statts[i] == ST_ATTACHMENT_DEPTH_STENCIL) {
          format = osbuffer->visual.depth_stencil_format;
@@ -505,6 +533,31 @@ osmesa_find_buffer(enum pipe_format color_format,
 }
 
 
+/**
+ * Set the user's buffer, and whether to try rendering straight into it,
+ * which is only possible if its rows are stored top to bottom without any
+ * padding.  The framebuffer is revalidated if that changes its color buffer.
+ */
+static void
+osmesa_set_buffer_map(OSMesaContext osmesa, struct osmesa_buffer *osbuffer,
+                      void *map)
+{
+   struct pipe_screen *screen = get_st_manager()->screen;
+   boolean render_to_map =
+      screen->resource_from_user_memory &&
+      !osmesa->y_up &&
+      (!osmesa->user_row_length ||
+       osmesa->user_row_length == (GLint) osbuffer->width);
+
+   if ((render_to_map || osbuffer->render_to_map) &&
+       (map != osbuffer->map || render_to_map != osbuffer->render_to_map))
+      p_atomic_inc(&osbuffer->stfb->stamp);
+
+   osbuffer->map = map;
+   osbuffer->render_to_map = render_to_map;
+}
+
+
 static void
 osmesa_destroy_buffer(struct osmesa_buffer *osbuffer)
 {
@@ -776,7 +829,7 @@ OSMesaMakeCurrent(OSMesaContext osmesa, void *buffer, GLenum type,
 
    osbuffer->width = width;
    osbuffer->height = height;
-   osbuffer->map = buffer;
+   osmesa_set_buffer_map(osmesa, osbuffer, buffer);
 
    /* XXX unused for now */
    (void) osmesa_destroy_buffer;
@@ -840,6 +893,10 @@ OSMesaPixelStore(GLint pname, GLint value)
       fprintf(stderr, "Invalid pname in OSMesaPixelStore()\n");
       return;
    }
+
+   if (osmesa->current_buffer)
+      osmesa_set_buffer_map(osmesa, osmesa->current_buffer,
+                            osmesa->current_buffer->map);
 }
 
 
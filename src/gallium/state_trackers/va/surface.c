@@ -490,10 +490,12 @@ suface_from_external_memory(VADriverContextP ctx, vlVaSurface *surface,
 {
    vlVaDriver *drv;
    struct pipe_screen *pscreen;
-   struct pipe_resource *resource;
    struct pipe_resource res_templ;
    struct winsys_handle whandle;
    struct pipe_resource *resources[VL_NUM_COMPONENTS];
+   const enum pipe_format *resource_formats = NULL;
+   unsigned num_planes = 1;
+   unsigned i;
 
    if (!ctx)
       return VA_STATUS_ERROR_INVALID_PARAMETER;
@@ -502,7 +504,7 @@ suface_from_external_memory(VADriverContextP ctx, vlVaSurface *surface,
    drv = VL_VA_DRIVER(ctx);
 
    if (!memory_attibute || !memory_attibute->buffers ||
-       index > memory_attibute->num_buffers)
+       index >= memory_attibute->num_buffers)
       return VA_STATUS_ERROR_INVALID_PARAMETER;
 
    if (surface->templat.width != memory_attibute->width ||
@@ -518,38 +520,60 @@ suface_from_external_memory(VADriverContextP ctx, vlVaSurface *surface,
       if (memory_attibute->num_planes != 1)
          return VA_STATUS_ERROR_INVALID_PARAMETER;
       break;
+   case VA_FOURCC_NV12:
+   case VA_FOURCC_YV12:
+      /* The planes are imported as they are laid out in the buffer, which
+       * is the order of vl_video_buffer's resources for both formats, so
+       * decoders and encoders can use the surface without a copy.
+       */
+      if (VaFourccToPipeFormat(memory_attibute->pixel_format) !=
+          surface->templat.buffer_format || templat->interlaced)
+         return VA_STATUS_ERROR_INVALID_PARAMETER;
+      resource_formats = vl_video_buffer_formats(pscreen, templat->buffer_format);
+      if (!resource_formats)
+         return VA_STATUS_ERROR_INVALID_PARAMETER;
+      num_planes = memory_attibute->pixel_format == VA_FOURCC_NV12 ? 2 : 3;
+      if (memory_attibute->num_planes != num_planes)
+         return VA_STATUS_ERROR_INVALID_PARAMETER;
+      break;
    default:
       return VA_STATUS_ERROR_INVALID_PARAMETER;
    }
 
-   memset(&res_templ, 0, sizeof(res_templ));
-   res_templ.target = PIPE_TEXTURE_2D;
-   res_templ.last_level = 0;
-   res_templ.depth0 = 1;
-   res_templ.array_size = 1;
-   res_templ.width0 = memory_attibute->width;
-   res_templ.height0 = memory_attibute->height;
-   res_templ.format = surface->templat.buffer_format;
-   res_templ.bind = PIPE_BIND_SAMPLER_VIEW;
-   res_templ.usage = PIPE_USAGE_DEFAULT;
-
-   memset(&whandle, 0, sizeof(struct winsys_handle));
-   whandle.type = DRM_API_HANDLE_TYPE_FD;
-   whandle.handle = memory_attibute->buffers[index];
-   whandle.stride = memory_attibute->pitches[index];
-
-   resource = pscreen->resource_from_handle(pscreen, &res_templ, &whandle,
-                                            PIPE_HANDLE_USAGE_READ_WRITE);
-
-   if (!resource)
-      return VA_STATUS_ERROR_ALLOCATION_FAILED;
-
    memset(resources, 0, sizeof resources);
-   resources[0] = resource;
+
+   for (i = 0; i < num_planes; ++i) {
+      if (resource_formats) {
+         vl_video_buffer_template(&res_templ, templat, resource_formats[i],
+                                  1, 1, PIPE_USAGE_DEFAULT, i);
+      } else {
+         memset(&res_templ, 0, sizeof(res_templ));
+         res_templ.target = PIPE_TEXTURE_2D;
+         res_templ.last_level = 0;
+         res_templ.depth0 = 1;
+         res_templ.array_size = 1;
+         res_templ.width0 = memory_attibute->width;
+         res_templ.height0 = memory_attibute->height;
+         res_templ.format = surface->templat.buffer_format;
+         res_templ.bind = PIPE_BIND_SAMPLER_VIEW;
+         res_templ.usage = PIPE_USAGE_DEFAULT;
+      }
+
+      memset(&whandle, 0, sizeof(struct winsys_handle));
+      whandle.type = DRM_API_HANDLE_TYPE_FD;
+      whandle.handle = memory_attibute->buffers[index];
+      whandle.stride = memory_attibute->pitches[i];
+      whandle.offset = memory_attibute->offsets[i];
+
+      resources[i] = pscreen->resource_from_handle(pscreen, &res_templ, &whandle,
+                                                   PIPE_HANDLE_USAGE_READ_WRITE);
+      if (!resources[i])
+         goto error;
+   }
 
    surface->buffer = vl_video_buffer_create_ex2(drv->pipe, templat, resources);
    if (!surface->buffer)
-      return VA_STATUS_ERROR_ALLOCATION_FAILED;
+      goto error;
 
    util_dynarray_init(&surface->subpics);
    surfaces[index] = handle_table_add(drv->htab, surface);
@@ -560,6 +584,12 @@ suface_from_external_memory(VADriverContextP ctx, vlVaSurface *surface,
    }
 
    return VA_STATUS_SUCCESS;
+
+error:
+   for (i = 0; i < VL_NUM_COMPONENTS; ++i)
+      pipe_resource_reference(&resources[i], NULL);
+
+   return VA_STATUS_ERROR_ALLOCATION_FAILED;
 }
 
 VAStatus
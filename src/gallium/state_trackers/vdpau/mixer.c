@@ -244,6 +244,7 @@ VdpStatus vlVdpVideoMixerRender(VdpVideoMixer mixer,
    struct pipe_surface *surface, surf_templ;
    struct pipe_context *pipe;
    struct pipe_resource res_tmpl, *res;
+   struct vl_bicubic_filter *bicubic;
 
    vlVdpVideoMixer *vmixer;
    vlVdpSurface *surf;
@@ -337,7 +338,14 @@ VdpStatus vlVdpVideoMixerRender(VdpVideoMixer mixer,
    }
    vl_compositor_set_buffer_layer(&vmixer->cstate, compositor, layer, video_buffer, prect, NULL, deinterlace);
 
-   if (vmixer->bicubic.filter || vmixer->sharpness.filter || vmixer->noise_reduction.filter) {
+   /* Without other filters, the scaling is done in the same pass as the
+    * color space conversion, which saves an intermediate surface. */
+   bicubic = vmixer->bicubic.filter;
+   if (bicubic && !vmixer->sharpness.filter && !vmixer->noise_reduction.filter &&
+       vl_compositor_set_layer_bicubic(&vmixer->cstate, compositor, layer))
+      bicubic = NULL;
+
+   if (bicubic || vmixer->sharpness.filter || vmixer->noise_reduction.filter) {
       pipe = vmixer->device->context;
       memset(&res_tmpl, 0, sizeof(res_tmpl));
 
@@ -348,7 +356,7 @@ VdpStatus vlVdpVideoMixerRender(VdpVideoMixer mixer,
       res_tmpl.bind = PIPE_BIND_SAMPLER_VIEW | PIPE_BIND_RENDER_TARGET;
       res_tmpl.usage = PIPE_USAGE_DEFAULT;
 
-      if (!vmixer->bicubic.filter) {
+      if (!bicubic) {
          res_tmpl.width0 = dst->surface->width;
          res_tmpl.height0 = dst->surface->height;
       } else {
@@ -373,7 +381,7 @@ VdpStatus vlVdpVideoMixerRender(VdpVideoMixer mixer,
       dirty_area = dst->dirty_area;
    }
 
-   if (!vmixer->bicubic.filter) {
+   if (!bicubic) {
       vl_compositor_set_layer_dst_area(&vmixer->cstate, layer++, RectToPipe(destination_video_rect, &rect));
       vl_compositor_set_dst_clip(&vmixer->cstate, RectToPipe(destination_rect, &clip));
    }
@@ -394,13 +402,13 @@ VdpStatus vlVdpVideoMixerRender(VdpVideoMixer mixer,
       ++layers;
    }
 
-   if (!vmixer->noise_reduction.filter && !vmixer->sharpness.filter && !vmixer->bicubic.filter)
+   if (!vmixer->noise_reduction.filter && !vmixer->sharpness.filter && !bicubic)
       vlVdpSave4DelayedRendering(vmixer->device, destination_surface, &vmixer->cstate);
    else {
       vl_compositor_render(&vmixer->cstate, compositor, surface, &dirty_area, true);
 
       if (vmixer->noise_reduction.filter) {
-         if (!vmixer->sharpness.filter && !vmixer->bicubic.filter) {
+         if (!vmixer->sharpness.filter && !bicubic) {
             vl_median_filter_render(vmixer->noise_reduction.filter,
                                     sampler_view, dst->surface);
          } else {
@@ -421,7 +429,7 @@ VdpStatus vlVdpVideoMixerRender(VdpVideoMixer mixer,
       }
 
       if (vmixer->sharpness.filter) {
-         if (!vmixer->bicubic.filter) {
+         if (!bicubic) {
             vl_matrix_filter_render(vmixer->sharpness.filter,
                                     sampler_view, dst->surface);
          } else {
@@ -441,8 +449,8 @@ VdpStatus vlVdpVideoMixerRender(VdpVideoMixer mixer,
          }
       }
 
-      if (vmixer->bicubic.filter)
-         vl_bicubic_filter_render(vmixer->bicubic.filter,
+      if (bicubic)
+         vl_bicubic_filter_render(bicubic,
                                  sampler_view, dst->surface,
                                  RectToPipe(destination_video_rect, &rect),
                                  RectToPipe(destination_rect, &clip));
@@ -469,6 +469,111 @@ bind_samplers(struct xa_context *ctx,
 				   ctx->bound_sampler_views);
 }
 
+/*
+ * Compare a saved picture with a new one. The saved picture's surface may
+ * have been destroyed and its address reused since, so the texture it had
+ * is compared as well. That texture is still referenced by the bound state.
+ */
+static int
+xa_picture_equal(const struct xa_picture *a, const struct pipe_resource *tex,
+		 const struct xa_picture *b)
+{
+    if (!a || !b)
+	return a == b;
+
+    if (a->pict_format != b->pict_format ||
+	a->srf != b->srf ||
+	(b->srf && b->srf->tex != tex) ||
+	a->alpha_map != b->alpha_map ||
+	a->has_transform != b->has_transform ||
+	a->component_alpha != b->component_alpha ||
+	a->wrap != b->wrap ||
+	a->filter != b->filter)
+	return FALSE;
+
+    if (a->has_transform &&
+	memcmp(a->transform, b->transform, sizeof(a->transform)) != 0)
+	return FALSE;
+
+    if (!a->src_pict || !b->src_pict)
+	return a->src_pict == b->src_pict;
+
+    return a->src_pict->type == b->src_pict->type &&
+	a->src_pict->solid_fill.color == b->src_pict->solid_fill.color;
+}
+
+static int
+xa_batch_matches(const struct xa_context *ctx, const struct xa_composite *comp)
+{
+    const struct xa_composite *saved = &ctx->batch_comp;
+
+    return saved->op == comp->op &&
+	saved->no_solid == comp->no_solid &&
+	xa_picture_equal(saved->src, ctx->batch_texs[0], comp->src) &&
+	xa_picture_equal(saved->mask, ctx->batch_texs[1], comp->mask) &&
+	xa_picture_equal(saved->dst, ctx->batch_texs[2], comp->dst);
+}
+
+static struct xa_picture *
+xa_batch_save_picture(struct xa_picture *copy, union xa_source_pict *src_pict,
+		      struct pipe_resource **tex, const struct xa_picture *pic)
+{
+    if (!pic)
+	return NULL;
+
+    *copy = *pic;
+    *tex = pic->srf ? pic->srf->tex : NULL;
+    if (pic->src_pict) {
+	*src_pict = *pic->src_pict;
+	copy->src_pict = src_pict;
+    }
+    return copy;
+}
+
+/*
+ * Remember the state of the composite operation, so that the next one can
+ * be batched with it if it uses the same state. Operations reading from
+ * their destination are never batched, since their rects may depend on
+ * each other.
+ */
+static void
+xa_batch_save(struct xa_context *ctx, const struct xa_composite *comp)
+{
+    struct xa_surface *dst_srf = comp->dst->srf;
+
+    ctx->batch_possible =
+	(!comp->src || comp->src->srf != dst_srf) &&
+	(!comp->mask || comp->mask->srf != dst_srf);
+    if (!ctx->batch_possible)
+	return;
+
+    ctx->batch_comp = *comp;
+    ctx->batch_comp.src = xa_batch_save_picture(&ctx->batch_pics[0],
+						&ctx->batch_src_picts[0],
+						&ctx->batch_texs[0], comp->src);
+    ctx->batch_comp.mask = xa_batch_save_picture(&ctx->batch_pics[1],
+						 &ctx->batch_src_picts[1],
+						 &ctx->batch_texs[1], comp->mask);
+    ctx->batch_comp.dst = xa_batch_save_picture(&ctx->batch_pics[2], NULL,
+						&ctx->batch_texs[2], comp->dst);
+}
+
+/*
+ * Draw the vertices left queued by xa_composite_done(), and release the
+ * state of that composite operation.
+ */
+void
+xa_ctx_composite_flush(struct xa_context *ctx)
+{
+    if (!ctx->batch_pending)
+	return;
+
+    ctx->batch_pending = FALSE;
+    renderer_draw_flush(ctx);
+    ctx->has_solid_color = FALSE;
+    xa_ctx_sampler_views_destroy(ctx);
+}
+
 XA_EXPORT int
 xa_composite_prepare(struct xa_context *ctx,
 		     const struct xa_composite *comp)
@@ -479,6 +584,19 @@ xa_composite_prepare(struct xa_context *ctx,
     if (comp->mask && !comp->mask->srf)
 	return -XA_ERR_INVAL;
 
+    if (ctx->batch_pending) {
+	if (xa_batch_matches(ctx, comp)) {
+	    /* Same state; keep appending to the queued vertices. */
+	    ctx->batch_pending = FALSE;
+	    ctx->dst = dst_srf;
+	    if (ctx->num_bound_samplers != 0)
+		ctx->comp = comp;
+	    return XA_ERR_NONE;
+	}
+	xa_ctx_composite_flush(ctx);
+    }
+    ctx->batch_possible = FALSE;
+
     ret = xa_ctx_srf_create(ctx, dst_srf);
     if (ret != XA_ERR_NONE)
 	return ret;
@@ -501,6 +619,7 @@ xa_composite_prepare(struct xa_context *ctx,
 	ctx->comp = comp;
     }
 
+    xa_batch_save(ctx, comp);
     xa_ctx_srf_destroy(ctx);
     return XA_ERR_NONE;
 }
@@ -534,9 +653,19 @@ xa_composite_rect(struct xa_context *ctx,
 XA_EXPORT void
 xa_composite_done(struct xa_context *ctx)
 {
+    ctx->comp = NULL;
+
+    /*
+     * Leave the vertices queued until the next operation, in case it is a
+     * composite operation with the same state.
+     */
+    if (ctx->batch_possible) {
+	ctx->batch_pending = TRUE;
+	return;
+    }
+
     renderer_draw_flush(ctx);
 
-    ctx->comp = NULL;
     ctx->has_solid_color = FALSE;
     xa_ctx_sampler_views_destroy(ctx);
 }
@@ -37,6 +37,8 @@
 XA_EXPORT void
 xa_context_flush(struct xa_context *ctx)
 {
+    xa_ctx_composite_flush(ctx);
+
     if (ctx->last_fence) {
         struct pipe_screen *screen = ctx->xa->screen;
         screen->fence_reference(screen, &ctx->last_fence, NULL);
@@ -70,6 +72,8 @@ xa_context_destroy(struct xa_context *r)
     struct pipe_resource **vsbuf = &r->vs_const_buffer;
     struct pipe_resource **fsbuf = &r->fs_const_buffer;
 
+    xa_ctx_composite_flush(r);
+
     if (*vsbuf)
 	pipe_resource_reference(vsbuf, NULL);
 
@@ -106,6 +110,8 @@ xa_surface_dma(struct xa_context *ctx,
     enum pipe_transfer_usage transfer_direction;
     struct pipe_context *pipe = ctx->pipe;
 
+    xa_ctx_composite_flush(ctx);
+
     transfer_direction = (to_surface ? PIPE_TRANSFER_WRITE :
 			  PIPE_TRANSFER_READ);
 
@@ -162,6 +168,8 @@ xa_surface_map(struct xa_context *ctx,
     if (!(gallium_usage & (PIPE_TRANSFER_READ_WRITE)))
 	return NULL;
 
+    xa_ctx_composite_flush(ctx);
+
     map = pipe_transfer_map(pipe, srf->tex, 0, 0,
                             gallium_usage, 0, 0,
                             srf->tex->width0, srf->tex->height0,
@@ -229,6 +237,8 @@ xa_copy_prepare(struct xa_context *ctx,
     if (src == dst)
 	return -XA_ERR_INVAL;
 
+    xa_ctx_composite_flush(ctx);
+
     if (src->tex->format != dst->tex->format) {
 	int ret = xa_ctx_srf_create(ctx, dst);
 	if (ret != XA_ERR_NONE)
@@ -300,6 +310,8 @@ xa_solid_prepare(struct xa_context *ctx, struct xa_surface *dst,
     struct xa_shader shader;
     int ret;
 
+    xa_ctx_composite_flush(ctx);
+
     ret = xa_ctx_srf_create(ctx, dst);
     if (ret != XA_ERR_NONE)
 	return ret;
@@ -121,6 +121,19 @@ struct xa_context {
     unsigned int num_bound_samplers;
     struct pipe_sampler_view *bound_sampler_views[XA_MAX_SAMPLERS];
     const struct xa_composite *comp;
+
+    /*
+     * State of the last composite operation. While batch_pending is set,
+     * xa_composite_done() has left its state bound and its vertices queued,
+     * so that a following composite operation with the same state can
+     * append to them.
+     */
+    int batch_possible;
+    int batch_pending;
+    struct xa_composite batch_comp;
+    struct xa_picture batch_pics[3];
+    union xa_source_pict batch_src_picts[2];
+    struct pipe_resource *batch_texs[3];
 };
 
 static inline void
@@ -248,6 +261,12 @@ xa_ctx_srf_destroy(struct xa_context *ctx);
 extern void
 xa_ctx_sampler_views_destroy(struct xa_context *ctx);
 
+/*
+ * xa_composite.c
+ */
+extern void
+xa_ctx_composite_flush(struct xa_context *ctx);
+
 /*
  * xa_renderer.c
  */
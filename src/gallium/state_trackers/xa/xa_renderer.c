@@ -82,8 +82,8 @@ renderer_draw(struct xa_context *r)
     if (!r->scissor_valid) {
 	r->scissor.minx = 0;
 	r->scissor.miny = 0;
-	r->scissor.maxx = r->dst->tex->width0;
-	r->scissor.maxy = r->dst->tex->height0;
+	r->scissor.maxx = r->fb_width;
+	r->scissor.maxy = r->fb_height;
     }
 
     r->pipe->set_scissor_states(r->pipe, 0, 1, &r->scissor);
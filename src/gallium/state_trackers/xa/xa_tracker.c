@@ -456,6 +456,9 @@ xa_surface_redefine(struct xa_surface *srf,
 	xa_flags_compat(srf->flags, new_flags))
 	return XA_ERR_NONE;
 
+    /* Queued composite rects may still sample the old texture. */
+    xa_ctx_composite_flush(xa->default_ctx);
+
     template->bind = stype_bind[xa_format_type(fdesc.xa_format)];
     if (new_flags & XA_FLAG_SHARED)
 	template->bind |= PIPE_BIND_SHARED;
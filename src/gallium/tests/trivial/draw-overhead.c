@@ -0,0 +1,464 @@
+/**************************************************************************
+ *
+ * Copyright © 2017
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/*
+ * Measures the CPU cost of draw calls going through cso_context and the
+ * driver, for a few patterns of state changes between the draws.
+ *
+ * Usage: draw-overhead [number of draws] [benchmark name]
+ *
+ * The driver is picked like for the other trivial tests, so for instance
+ * GALLIUM_DRIVER=llvmpipe selects llvmpipe when no hardware device is
+ * found.  The time reported covers the draws and the final flush, but not
+ * the wait for the GPU to finish.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* pipe_*_state structs */
+#include "pipe/p_state.h"
+/* pipe_context */
+#include "pipe/p_context.h"
+/* pipe_screen */
+#include "pipe/p_screen.h"
+/* PIPE_* */
+#include "pipe/p_defines.h"
+/* TGSI_SEMANTIC_{POSITION|GENERIC} */
+#include "pipe/p_shader_tokens.h"
+/* pipe_buffer_* helpers */
+#include "util/u_inlines.h"
+
+/* constant state object helper */
+#include "cso_cache/cso_context.h"
+
+/* os_time_get_nano */
+#include "os/os_time.h"
+/* util_draw_arrays helper */
+#include "util/u_draw.h"
+/* FREE & CALLOC_STRUCT */
+#include "util/u_memory.h"
+/* u_sampler_view_default_template */
+#include "util/u_sampler.h"
+/* util_make_[fragment|vertex]_passthrough_shader */
+#include "util/u_simple_shaders.h"
+/* to get a hardware pipe driver */
+#include "pipe-loader/pipe_loader.h"
+
+#define WIDTH 64
+#define HEIGHT 64
+#define DEFAULT_DRAWS 100000
+#define WARMUP_DRAWS 100
+
+struct program
+{
+	struct pipe_loader_device *dev;
+	struct pipe_screen *screen;
+	struct pipe_context *pipe;
+	struct cso_context *cso;
+
+	struct pipe_blend_state blend[2];
+	struct pipe_depth_stencil_alpha_state depthstencil;
+	struct pipe_rasterizer_state rasterizer;
+	struct pipe_sampler_state sampler;
+	struct pipe_viewport_state viewport;
+	struct pipe_framebuffer_state framebuffer;
+	struct pipe_vertex_element velem[2];
+	struct pipe_vertex_buffer vbuf;
+
+	void *vs;
+	void *fs;
+
+	struct pipe_resource *target;
+	struct pipe_resource *tex[2];
+	struct pipe_sampler_view *view[2];
+	struct pipe_resource *cbuf;
+	boolean user_cbufs;
+	struct pipe_query *query;
+};
+
+static struct pipe_resource *create_texture(struct program *p, uint32_t color)
+{
+	struct pipe_resource tmplt;
+	struct pipe_resource *tex;
+	struct pipe_box box;
+	uint32_t texels[4] = { color, color, color, color };
+
+	memset(&tmplt, 0, sizeof(tmplt));
+	tmplt.target = PIPE_TEXTURE_2D;
+	tmplt.format = PIPE_FORMAT_B8G8R8A8_UNORM; /* All drivers support this */
+	tmplt.width0 = 2;
+	tmplt.height0 = 2;
+	tmplt.depth0 = 1;
+	tmplt.array_size = 1;
+	tmplt.last_level = 0;
+	tmplt.bind = PIPE_BIND_SAMPLER_VIEW;
+
+	tex = p->screen->resource_create(p->screen, &tmplt);
+
+	u_box_2d(0, 0, 2, 2, &box);
+	p->pipe->texture_subdata(p->pipe, tex, 0, PIPE_TRANSFER_WRITE, &box,
+				 texels, 2 * sizeof(uint32_t), 0);
+	return tex;
+}
+
+static void init_prog(struct program *p)
+{
+	struct pipe_surface surf_tmpl;
+	struct pipe_sampler_view v_tmplt;
+	int ret, i;
+
+	/* find a hardware device */
+	ret = pipe_loader_probe(&p->dev, 1);
+	assert(ret);
+
+	/* init a pipe screen */
+	p->screen = pipe_loader_create_screen(p->dev);
+	assert(p->screen);
+
+	/* create the pipe driver context and cso context */
+	p->pipe = p->screen->context_create(p->screen, NULL, 0);
+	p->cso = cso_create_context(p->pipe);
+
+	/* vertex buffer: a small triangle, with texture coordinates */
+	{
+		float vertices[3][2][4] = {
+			{
+				{ 0.0f, -0.1f, 0.0f, 1.0f },
+				{ 0.5f, 0.0f, 0.0f, 1.0f }
+			},
+			{
+				{ -0.1f, 0.1f, 0.0f, 1.0f },
+				{ 0.0f, 1.0f, 0.0f, 1.0f }
+			},
+			{
+				{ 0.1f, 0.1f, 0.0f, 1.0f },
+				{ 1.0f, 1.0f, 0.0f, 1.0f }
+			}
+		};
+
+		memset(&p->vbuf, 0, sizeof(p->vbuf));
+		p->vbuf.stride = sizeof(vertices[0]);
+		p->vbuf.buffer = pipe_buffer_create(p->screen,
+						    PIPE_BIND_VERTEX_BUFFER,
+						    PIPE_USAGE_DEFAULT,
+						    sizeof(vertices));
+		pipe_buffer_write(p->pipe, p->vbuf.buffer, 0, sizeof(vertices),
+				  vertices);
+	}
+
+	/* render target texture */
+	{
+		struct pipe_resource tmplt;
+		memset(&tmplt, 0, sizeof(tmplt));
+		tmplt.target = PIPE_TEXTURE_2D;
+		tmplt.format = PIPE_FORMAT_B8G8R8A8_UNORM; /* All drivers support this */
+		tmplt.width0 = WIDTH;
+		tmplt.height0 = HEIGHT;
+		tmplt.depth0 = 1;
+		tmplt.array_size = 1;
+		tmplt.last_level = 0;
+		tmplt.bind = PIPE_BIND_RENDER_TARGET;
+
+		p->target = p->screen->resource_create(p->screen, &tmplt);
+	}
+
+	/* two textures to switch between */
+	p->tex[0] = create_texture(p, 0xffff0000);
+	p->tex[1] = create_texture(p, 0xff00ff00);
+	for (i = 0; i < 2; i++) {
+		u_sampler_view_default_template(&v_tmplt, p->tex[i],
+						p->tex[i]->format);
+		p->view[i] = p->pipe->create_sampler_view(p->pipe, p->tex[i],
+							  &v_tmplt);
+	}
+
+	/* constant buffer, when user constant buffers aren't supported */
+	p->user_cbufs = p->screen->get_param(p->screen,
+					     PIPE_CAP_USER_CONSTANT_BUFFERS);
+	if (!p->user_cbufs)
+		p->cbuf = pipe_buffer_create(p->screen,
+					     PIPE_BIND_CONSTANT_BUFFER,
+					     PIPE_USAGE_STREAM, 4 * sizeof(float));
+
+	p->query = p->pipe->create_query(p->pipe, PIPE_QUERY_OCCLUSION_COUNTER,
+					 0);
+
+	/* disabled blending/masking, and additive blending to switch to */
+	memset(p->blend, 0, sizeof(p->blend));
+	p->blend[0].rt[0].colormask = PIPE_MASK_RGBA;
+	p->blend[1].rt[0].colormask = PIPE_MASK_RGBA;
+	p->blend[1].rt[0].blend_enable = 1;
+	p->blend[1].rt[0].rgb_func = PIPE_BLEND_ADD;
+	p->blend[1].rt[0].rgb_src_factor = PIPE_BLENDFACTOR_ONE;
+	p->blend[1].rt[0].rgb_dst_factor = PIPE_BLENDFACTOR_ONE;
+	p->blend[1].rt[0].alpha_func = PIPE_BLEND_ADD;
+	p->blend[1].rt[0].alpha_src_factor = PIPE_BLENDFACTOR_ONE;
+	p->blend[1].rt[0].alpha_dst_factor = PIPE_BLENDFACTOR_ONE;
+
+	/* no-op depth/stencil/alpha */
+	memset(&p->depthstencil, 0, sizeof(p->depthstencil));
+
+	/* rasterizer */
+	memset(&p->rasterizer, 0, sizeof(p->rasterizer));
+	p->rasterizer.cull_face = PIPE_FACE_NONE;
+	p->rasterizer.half_pixel_center = 1;
+	p->rasterizer.bottom_edge_rule = 1;
+	p->rasterizer.depth_clip = 1;
+
+	/* sampler */
+	memset(&p->sampler, 0, sizeof(p->sampler));
+	p->sampler.wrap_s = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+	p->sampler.wrap_t = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+	p->sampler.wrap_r = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
+	p->sampler.min_mip_filter = PIPE_TEX_MIPFILTER_NONE;
+	p->sampler.min_img_filter = PIPE_TEX_FILTER_NEAREST;
+	p->sampler.mag_img_filter = PIPE_TEX_FILTER_NEAREST;
+	p->sampler.normalized_coords = 1;
+
+	surf_tmpl.format = PIPE_FORMAT_B8G8R8A8_UNORM;
+	surf_tmpl.u.tex.level = 0;
+	surf_tmpl.u.tex.first_layer = 0;
+	surf_tmpl.u.tex.last_layer = 0;
+	/* drawing destination */
+	memset(&p->framebuffer, 0, sizeof(p->framebuffer));
+	p->framebuffer.width = WIDTH;
+	p->framebuffer.height = HEIGHT;
+	p->framebuffer.nr_cbufs = 1;
+	p->framebuffer.cbufs[0] = p->pipe->create_surface(p->pipe, p->target, &surf_tmpl);
+
+	/* viewport */
+	memset(&p->viewport, 0, sizeof(p->viewport));
+	p->viewport.scale[0] = WIDTH / 2.0f;
+	p->viewport.scale[1] = HEIGHT / 2.0f;
+	p->viewport.scale[2] = 1.0f;
+	p->viewport.translate[0] = WIDTH / 2.0f;
+	p->viewport.translate[1] = HEIGHT / 2.0f;
+	p->viewport.translate[2] = 0.0f;
+
+	/* vertex elements state */
+	memset(p->velem, 0, sizeof(p->velem));
+	p->velem[0].src_offset = 0 * 4 * sizeof(float); /* offset 0, first element */
+	p->velem[0].instance_divisor = 0;
+	p->velem[0].vertex_buffer_index = 0;
+	p->velem[0].src_format = PIPE_FORMAT_R32G32B32A32_FLOAT;
+
+	p->velem[1].src_offset = 1 * 4 * sizeof(float); /* offset 16, second element */
+	p->velem[1].instance_divisor = 0;
+	p->velem[1].vertex_buffer_index = 0;
+	p->velem[1].src_format = PIPE_FORMAT_R32G32B32A32_FLOAT;
+
+	/* vertex shader */
+	{
+			const uint semantic_names[] = { TGSI_SEMANTIC_POSITION,
+							TGSI_SEMANTIC_GENERIC };
+			const uint semantic_indexes[] = { 0, 0 };
+			p->vs = util_make_vertex_passthrough_shader(p->pipe, 2, semantic_names, semantic_indexes, FALSE);
+	}
+
+	/* fragment shader */
+	p->fs = util_make_fragment_tex_shader(p->pipe, TGSI_TEXTURE_2D,
+	                                      TGSI_INTERPOLATE_LINEAR,
+	                                      TGSI_RETURN_TYPE_FLOAT,
+	                                      TGSI_RETURN_TYPE_FLOAT);
+}
+
+static void close_prog(struct program *p)
+{
+	int i;
+
+	cso_destroy_context(p->cso);
+
+	p->pipe->delete_vs_state(p->pipe, p->vs);
+	p->pipe->delete_fs_state(p->pipe, p->fs);
+
+	if (p->query)
+		p->pipe->destroy_query(p->pipe, p->query);
+
+	for (i = 0; i < 2; i++) {
+		pipe_sampler_view_reference(&p->view[i], NULL);
+		pipe_resource_reference(&p->tex[i], NULL);
+	}
+
+	pipe_surface_reference(&p->framebuffer.cbufs[0], NULL);
+	pipe_resource_reference(&p->target, NULL);
+	pipe_resource_reference(&p->vbuf.buffer, NULL);
+	pipe_resource_reference(&p->cbuf, NULL);
+
+	p->pipe->destroy(p->pipe);
+	p->screen->destroy(p->screen);
+	pipe_loader_release(&p->dev, 1);
+
+	FREE(p);
+}
+
+/* Sets the state shared by all the benchmarks. */
+static void set_state(struct program *p)
+{
+	const struct pipe_sampler_state *samplers[] = {&p->sampler};
+
+	cso_set_framebuffer(p->cso, &p->framebuffer);
+	cso_set_blend(p->cso, &p->blend[0]);
+	cso_set_depth_stencil_alpha(p->cso, &p->depthstencil);
+	cso_set_rasterizer(p->cso, &p->rasterizer);
+	cso_set_viewport(p->cso, &p->viewport);
+	cso_set_samplers(p->cso, PIPE_SHADER_FRAGMENT, 1, samplers);
+	cso_set_sampler_views(p->cso, PIPE_SHADER_FRAGMENT, 1, &p->view[0]);
+	cso_set_fragment_shader_handle(p->cso, p->fs);
+	cso_set_vertex_shader_handle(p->cso, p->vs);
+	cso_set_vertex_elements(p->cso, 2, p->velem);
+	cso_set_vertex_buffers(p->cso, 0, 1, &p->vbuf);
+}
+
+static void draw(struct program *p)
+{
+	util_draw_arrays(p->pipe, PIPE_PRIM_TRIANGLES, 0, 3);
+}
+
+/* Draws without any state change. */
+static void bench_draw(struct program *p, unsigned i)
+{
+	draw(p);
+}
+
+/* Switches between two blend states. */
+static void bench_blend(struct program *p, unsigned i)
+{
+	cso_set_blend(p->cso, &p->blend[i & 1]);
+	draw(p);
+}
+
+/* Switches between two textures. */
+static void bench_texture(struct program *p, unsigned i)
+{
+	cso_set_sampler_views(p->cso, PIPE_SHADER_FRAGMENT, 1, &p->view[i & 1]);
+	draw(p);
+}
+
+/* Uploads new vertex shader constants. */
+static void bench_constants(struct program *p, unsigned i)
+{
+	float constants[4] = { (float)i, 0.0f, 0.0f, 1.0f };
+	struct pipe_constant_buffer cb;
+
+	memset(&cb, 0, sizeof(cb));
+	cb.buffer_size = sizeof(constants);
+	if (p->user_cbufs) {
+		cb.user_buffer = constants;
+	} else {
+		pipe_buffer_write(p->pipe, p->cbuf, 0, sizeof(constants),
+				  constants);
+		cb.buffer = p->cbuf;
+	}
+	cso_set_constant_buffer(p->cso, PIPE_SHADER_VERTEX, 0, &cb);
+	draw(p);
+}
+
+/* Counts the samples of every draw with an occlusion query. */
+static void bench_query(struct program *p, unsigned i)
+{
+	p->pipe->begin_query(p->pipe, p->query);
+	draw(p);
+	p->pipe->end_query(p->pipe, p->query);
+}
+
+static const struct {
+	const char *name;
+	void (*draw)(struct program *p, unsigned i);
+} benchmarks[] = {
+	{ "draw", bench_draw },
+	{ "blend", bench_blend },
+	{ "texture", bench_texture },
+	{ "constants", bench_constants },
+	{ "query", bench_query },
+};
+
+static void wait_idle(struct program *p)
+{
+	struct pipe_fence_handle *fence = NULL;
+
+	p->pipe->flush(p->pipe, &fence, 0);
+	if (fence) {
+		p->screen->fence_finish(p->screen, NULL, fence,
+					PIPE_TIMEOUT_INFINITE);
+		p->screen->fence_reference(p->screen, &fence, NULL);
+	}
+}
+
+static void run(struct program *p, unsigned b, unsigned num_draws)
+{
+	int64_t start, end;
+	unsigned i;
+
+	set_state(p);
+	p->pipe->clear(p->pipe, PIPE_CLEAR_COLOR,
+		       &(union pipe_color_union){{0}}, 0, 0);
+
+	for (i = 0; i < WARMUP_DRAWS; i++)
+		benchmarks[b].draw(p, i);
+	wait_idle(p);
+
+	start = os_time_get_nano();
+	for (i = 0; i < num_draws; i++)
+		benchmarks[b].draw(p, i);
+	p->pipe->flush(p->pipe, NULL, 0);
+	end = os_time_get_nano();
+
+	wait_idle(p);
+
+	printf("%-12s %10.1f ns/draw\n", benchmarks[b].name,
+	       (double)(end - start) / num_draws);
+}
+
+int main(int argc, char** argv)
+{
+	struct program *p;
+	unsigned num_draws = DEFAULT_DRAWS;
+	const char *name = NULL;
+	unsigned b;
+
+	if (argc > 1)
+		num_draws = MAX2(atoi(argv[1]), 1);
+	if (argc > 2)
+		name = argv[2];
+
+	p = CALLOC_STRUCT(program);
+	init_prog(p);
+
+	printf("%s, %u draws\n", p->screen->get_name(p->screen), num_draws);
+
+	for (b = 0; b < ARRAY_SIZE(benchmarks); b++) {
+		if (name && strcmp(name, benchmarks[b].name) != 0)
+			continue;
+		if (benchmarks[b].draw == bench_query && !p->query)
+			continue;
+		run(p, b, num_draws);
+	}
+
+	close_prog(p);
+
+	return 0;
+}
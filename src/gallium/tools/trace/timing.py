@@ -0,0 +1,147 @@
+#!/usr/bin/env python
+##########################################################################
+#
+# Copyright 2017
+# All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the
+# "Software"), to deal in the Software without restriction, including
+# without limitation the rights to use, copy, modify, merge, publish,
+# distribute, sub license, and/or sell copies of the Software, and to
+# permit persons to whom the Software is furnished to do so, subject to
+# the following conditions:
+#
+# The above copyright notice and this permission notice (including the
+# next paragraph) shall be included in all copies or substantial portions
+# of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+# MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+# IN NO EVENT SHALL THE AUTHORS AND/OR THEIR SUPPLIERS BE LIABLE FOR
+# ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+# TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+# SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+##########################################################################
+
+"""Convert the binary traces written with GALLIUM_TRACE_TIMING=1.
+
+The default output is a per-method summary.  --chrome writes a timeline
+that can be loaded in chrome://tracing, and --folded writes folded stacks
+for flamegraph.pl.
+"""
+
+
+import json
+import optparse
+import struct
+import sys
+
+
+MAGIC = b'GTRCTIME'
+VERSION = 1
+
+RECORD_METHOD = 1
+RECORD_CALL = 2
+
+
+def read_calls(stream):
+    """Yield (method name, start, duration) for every call, in ns."""
+
+    header = stream.read(len(MAGIC) + 4)
+    if len(header) < len(MAGIC) + 4 or header[:len(MAGIC)] != MAGIC:
+        raise ValueError('not a timing trace')
+    version, = struct.unpack('=I', header[len(MAGIC):])
+    if version != VERSION:
+        raise ValueError('unsupported timing trace version %u' % version)
+
+    methods = {}
+    while True:
+        record_type = stream.read(1)
+        if not record_type:
+            break
+        record_type = ord(record_type)
+        if record_type == RECORD_METHOD:
+            method_id, length = struct.unpack('=HH', stream.read(4))
+            methods[method_id] = stream.read(length).decode('ascii')
+        elif record_type == RECORD_CALL:
+            data = stream.read(18)
+            if len(data) < 18:
+                # truncated trace, e.g. the application didn't exit cleanly
+                break
+            method_id, start, duration = struct.unpack('=HQQ', data)
+            yield methods.get(method_id, '?'), start, duration
+        else:
+            raise ValueError('invalid record type %u' % record_type)
+
+
+def write_summary(calls, output):
+    stats = {}
+    total = 0
+    for name, start, duration in calls:
+        count, time = stats.get(name, (0, 0))
+        stats[name] = (count + 1, time + duration)
+        total += duration
+
+    output.write('%-48s %10s %12s %10s %6s\n' %
+                 ('method', 'calls', 'total (us)', 'avg (us)', '%'))
+    for name, (count, time) in sorted(stats.items(),
+                                       key=lambda item: -item[1][1]):
+        output.write('%-48s %10u %12.1f %10.2f %6.2f\n' %
+                     (name, count, time / 1000.0, time / 1000.0 / count,
+                      100.0 * time / total if total else 0.0))
+
+
+def write_chrome(calls, output):
+    events = []
+    for name, start, duration in calls:
+        events.append({
+            'name': name.split('::')[-1],
+            'cat': name.split('::')[0],
+            'ph': 'X',
+            'pid': 0,
+            'tid': 0,
+            'ts': start / 1000.0,
+            'dur': duration / 1000.0,
+        })
+    json.dump({'traceEvents': events}, output)
+
+
+def write_folded(calls, output):
+    stats = {}
+    for name, start, duration in calls:
+        stack = name.replace('::', ';')
+        stats[stack] = stats.get(stack, 0) + duration
+    for stack, time in sorted(stats.items()):
+        # flamegraph.pl expects integer sample counts; use microseconds
+        output.write('%s %u\n' % (stack, max(time // 1000, 1)))
+
+
+def main():
+    optparser = optparse.OptionParser(
+        usage='\n\t%prog [options] TRACE',
+        description=__doc__.split('\n')[0])
+    optparser.add_option('--chrome', action='store_const', const='chrome',
+                         dest='format', default='summary',
+                         help='write a chrome://tracing JSON timeline')
+    optparser.add_option('--folded', action='store_const', const='folded',
+                         dest='format',
+                         help='write folded stacks for flamegraph.pl')
+    (options, args) = optparser.parse_args(sys.argv[1:])
+    if len(args) != 1:
+        optparser.error('incorrect number of arguments')
+
+    writers = {
+        'summary': write_summary,
+        'chrome': write_chrome,
+        'folded': write_folded,
+    }
+
+    with open(args[0], 'rb') as stream:
+        writers[options.format](read_calls(stream), sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -489,8 +489,10 @@ struct pb_slab *amdgpu_bo_slab_alloc(void *priv, unsigned heap,
       flags |= RADEON_FLAG_GTT_WC;
    if (heap & 2)
       flags |= RADEON_FLAG_CPU_ACCESS;
+   if (heap & 4)
+      flags |= RADEON_FLAG_NO_CPU_ACCESS;
 
-   switch (heap >> 2) {
+   switch (heap >> 3) {
    case 0:
       domains = RADEON_DOMAIN_VRAM;
       break;
@@ -683,18 +685,21 @@ amdgpu_bo_create(struct radeon_winsys *rws,
          heap |= 1;
       if (flags & RADEON_FLAG_CPU_ACCESS)
          heap |= 2;
-      if (flags & ~(RADEON_FLAG_GTT_WC | RADEON_FLAG_CPU_ACCESS))
+      if (flags & RADEON_FLAG_NO_CPU_ACCESS)
+         heap |= 4;
+      if (flags & ~(RADEON_FLAG_GTT_WC | RADEON_FLAG_CPU_ACCESS |
+                    RADEON_FLAG_NO_CPU_ACCESS))
          goto no_slab;
 
       switch (domain) {
       case RADEON_DOMAIN_VRAM:
-         heap |= 0 * 4;
+         heap |= 0 * 8;
          break;
       case RADEON_DOMAIN_VRAM_GTT:
-         heap |= 1 * 4;
+         heap |= 1 * 8;
          break;
       case RADEON_DOMAIN_GTT:
-         heap |= 2 * 4;
+         heap |= 2 * 8;
          break;
       default:
          goto no_slab;
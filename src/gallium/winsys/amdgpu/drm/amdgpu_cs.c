@@ -268,42 +268,79 @@ static unsigned amdgpu_cs_epilog_dws(enum ring_type ring_type)
    return 0;
 }
 
+#define AMDGPU_CS_MIN_INDEX_SIZE 256
+
+/* Return the slot of "bo" in the index, or the empty slot where it would
+ * be inserted. Unique IDs are allocated sequentially, so they are used as
+ * the hash directly. */
+static unsigned
+amdgpu_buffer_index_find_slot(const struct amdgpu_cs_buffer_index *index,
+                              const struct amdgpu_cs_buffer *buffers,
+                              const struct amdgpu_winsys_bo *bo)
+{
+   unsigned mask = index->size - 1;
+   unsigned slot = bo->unique_id & mask;
+
+   while (index->slots[slot] >= 0 &&
+          buffers[index->slots[slot]].bo != bo)
+      slot = (slot + 1) & mask;
+
+   return slot;
+}
+
+/* Make room for one more buffer, keeping the load factor at most 1/2. */
+static bool
+amdgpu_buffer_index_reserve(struct amdgpu_cs_buffer_index *index,
+                            const struct amdgpu_cs_buffer *buffers,
+                            unsigned num_buffers)
+{
+   struct amdgpu_cs_buffer_index new_index;
+   unsigned i;
+
+   if ((num_buffers + 1) * 2 <= index->size)
+      return true;
+
+   new_index.size = MAX2(index->size * 2, AMDGPU_CS_MIN_INDEX_SIZE);
+   new_index.slots = MALLOC(new_index.size * sizeof(*new_index.slots));
+   if (!new_index.slots)
+      return num_buffers + 1 < index->size;
+
+   memset(new_index.slots, -1, new_index.size * sizeof(*new_index.slots));
+   for (i = 0; i < num_buffers; i++) {
+      unsigned slot =
+         amdgpu_buffer_index_find_slot(&new_index, buffers, buffers[i].bo);
+      new_index.slots[slot] = i;
+   }
+
+   FREE(index->slots);
+   *index = new_index;
+   return true;
+}
+
+static void
+amdgpu_buffer_index_clear(struct amdgpu_cs_buffer_index *index)
+{
+   if (index->size)
+      memset(index->slots, -1, index->size * sizeof(*index->slots));
+}
+
 int amdgpu_lookup_buffer(struct amdgpu_cs_context *cs, struct amdgpu_winsys_bo *bo)
 {
-   unsigned hash = bo->unique_id & (ARRAY_SIZE(cs->buffer_indices_hashlist)-1);
-   int i = cs->buffer_indices_hashlist[hash];
+   struct amdgpu_cs_buffer_index *index;
    struct amdgpu_cs_buffer *buffers;
-   int num_buffers;
 
    if (bo->bo) {
+      index = &cs->real_index;
       buffers = cs->real_buffers;
-      num_buffers = cs->num_real_buffers;
    } else {
+      index = &cs->slab_index;
       buffers = cs->slab_buffers;
-      num_buffers = cs->num_slab_buffers;
    }
 
-   /* not found or found */
-   if (i < 0 || (i < num_buffers && buffers[i].bo == bo))
-      return i;
-
-   /* Hash collision, look for the BO in the list of buffers linearly. */
-   for (i = num_buffers - 1; i >= 0; i--) {
-      if (buffers[i].bo == bo) {
-         /* Put this buffer in the hash list.
-          * This will prevent additional hash collisions if there are
-          * several consecutive lookup_buffer calls for the same buffer.
-          *
-          * Example: Assuming buffers A,B,C collide in the hash list,
-          * the following sequence of buffers:
-          *         AAAAAAAAAAABBBBBBBBBBBBBBCCCCCCCC
-          * will collide here: ^ and here:   ^,
-          * meaning that we should get very few collisions in the end. */
-         cs->buffer_indices_hashlist[hash] = i;
-         return i;
-      }
-   }
-   return -1;
+   if (!index->size)
+      return -1;
+
+   return index->slots[amdgpu_buffer_index_find_slot(index, buffers, bo)];
 }
 
 static int
@@ -311,12 +348,18 @@ amdgpu_lookup_or_add_real_buffer(struct amdgpu_cs *acs, struct amdgpu_winsys_bo
 {
    struct amdgpu_cs_context *cs = acs->csc;
    struct amdgpu_cs_buffer *buffer;
-   unsigned hash;
+   unsigned slot;
    int idx = amdgpu_lookup_buffer(cs, bo);
 
    if (idx >= 0)
       return idx;
 
+   if (!amdgpu_buffer_index_reserve(&cs->real_index, cs->real_buffers,
+                                    cs->num_real_buffers)) {
+      fprintf(stderr, "amdgpu_lookup_or_add_buffer: allocation failed\n");
+      return -1;
+   }
+
    /* New buffer, check if the backing array is large enough. */
    if (cs->num_real_buffers >= cs->max_real_buffers) {
       unsigned new_max =
@@ -361,8 +404,8 @@ amdgpu_lookup_or_add_real_buffer(struct amdgpu_cs *acs, struct amdgpu_winsys_bo
    p_atomic_inc(&bo->num_cs_references);
    cs->num_real_buffers++;
 
-   hash = bo->unique_id & (ARRAY_SIZE(cs->buffer_indices_hashlist)-1);
-   cs->buffer_indices_hashlist[hash] = idx;
+   slot = amdgpu_buffer_index_find_slot(&cs->real_index, cs->real_buffers, bo);
+   cs->real_index.slots[slot] = idx;
 
    if (bo->initial_domain & RADEON_DOMAIN_VRAM)
       acs->main.base.used_vram += bo->base.size;
@@ -377,7 +420,7 @@ static int amdgpu_lookup_or_add_slab_buffer(struct amdgpu_cs *acs,
 {
    struct amdgpu_cs_context *cs = acs->csc;
    struct amdgpu_cs_buffer *buffer;
-   unsigned hash;
+   unsigned slot;
    int idx = amdgpu_lookup_buffer(cs, bo);
    int real_idx;
 
@@ -388,6 +431,12 @@ static int amdgpu_lookup_or_add_slab_buffer(struct amdgpu_cs *acs,
    if (real_idx < 0)
       return -1;
 
+   if (!amdgpu_buffer_index_reserve(&cs->slab_index, cs->slab_buffers,
+                                    cs->num_slab_buffers)) {
+      fprintf(stderr, "amdgpu_lookup_or_add_slab_buffer: allocation failed\n");
+      return -1;
+   }
+
    /* New buffer, check if the backing array is large enough. */
    if (cs->num_slab_buffers >= cs->max_slab_buffers) {
       unsigned new_max =
@@ -415,8 +464,8 @@ static int amdgpu_lookup_or_add_slab_buffer(struct amdgpu_cs *acs,
    p_atomic_inc(&bo->num_cs_references);
    cs->num_slab_buffers++;
 
-   hash = bo->unique_id & (ARRAY_SIZE(cs->buffer_indices_hashlist)-1);
-   cs->buffer_indices_hashlist[hash] = idx;
+   slot = amdgpu_buffer_index_find_slot(&cs->slab_index, cs->slab_buffers, bo);
+   cs->slab_index.slots[slot] = idx;
 
    return idx;
 }
@@ -609,8 +658,6 @@ static void amdgpu_ib_finalize(struct amdgpu_ib *ib)
 static bool amdgpu_init_cs_context(struct amdgpu_cs_context *cs,
                                    enum ring_type ring_type)
 {
-   int i;
-
    switch (ring_type) {
    case RING_DMA:
       cs->request.ip_type = AMDGPU_HW_IP_DMA;
@@ -634,10 +681,6 @@ static bool amdgpu_init_cs_context(struct amdgpu_cs_context *cs,
       break;
    }
 
-   for (i = 0; i < ARRAY_SIZE(cs->buffer_indices_hashlist); i++) {
-      cs->buffer_indices_hashlist[i] = -1;
-   }
-
    cs->request.number_of_ibs = 1;
    cs->request.ibs = &cs->ib[IB_MAIN];
 
@@ -665,9 +708,8 @@ static void amdgpu_cs_context_cleanup(struct amdgpu_cs_context *cs)
    cs->num_slab_buffers = 0;
    amdgpu_fence_reference(&cs->fence, NULL);
 
-   for (i = 0; i < ARRAY_SIZE(cs->buffer_indices_hashlist); i++) {
-      cs->buffer_indices_hashlist[i] = -1;
-   }
+   amdgpu_buffer_index_clear(&cs->real_index);
+   amdgpu_buffer_index_clear(&cs->slab_index);
 }
 
 static void amdgpu_destroy_cs_context(struct amdgpu_cs_context *cs)
@@ -677,6 +719,8 @@ static void amdgpu_destroy_cs_context(struct amdgpu_cs_context *cs)
    FREE(cs->real_buffers);
    FREE(cs->handles);
    FREE(cs->slab_buffers);
+   FREE(cs->real_index.slots);
+   FREE(cs->slab_index.slots);
    FREE(cs->request.dependencies);
 }
 
@@ -56,6 +56,13 @@ struct amdgpu_cs_buffer {
    enum radeon_bo_usage usage;
 };
 
+/* Open-addressed hash table from buffers to their index in a buffer list,
+ * with linear probing. */
+struct amdgpu_cs_buffer_index {
+   int *slots; /* buffer indices, -1 for empty slots */
+   unsigned size; /* a power of two, or 0 */
+};
+
 enum ib_type {
    IB_CONST_PREAMBLE = 0,
    IB_CONST = 1, /* the const IB must be first */
@@ -90,7 +97,8 @@ struct amdgpu_cs_context {
    unsigned                    max_slab_buffers;
    struct amdgpu_cs_buffer     *slab_buffers;
 
-   int                         buffer_indices_hashlist[4096];
+   struct amdgpu_cs_buffer_index real_index;
+   struct amdgpu_cs_buffer_index slab_index;
 
    unsigned                    max_dependencies;
 
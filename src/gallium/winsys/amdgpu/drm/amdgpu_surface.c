@@ -573,7 +573,55 @@ static int amdgpu_surface_init(struct radeon_winsys *rws,
    return 0;
 }
 
+static bool amdgpu_surface_get_offsets(struct radeon_winsys *rws,
+                                       const struct pipe_resource *tex,
+                                       const struct radeon_surf *surf,
+                                       unsigned level, unsigned x, unsigned y,
+                                       unsigned slice, unsigned width,
+                                       unsigned height, uint64_t *offsets)
+{
+   struct amdgpu_winsys *ws = (struct amdgpu_winsys*)rws;
+   ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_INPUT AddrIn = {0};
+   ADDR_COMPUTE_SURFACE_ADDRSFROMCOORDS_OUTPUT AddrOut = {0};
+   unsigned i;
+
+   /* Depth, stencil and FMASK use a different sample order. */
+   if (surf->flags & (RADEON_SURF_Z_OR_SBUFFER | RADEON_SURF_FMASK) ||
+       tex->nr_samples > 1)
+      return false;
+
+   AddrIn.size = sizeof(AddrIn);
+   AddrOut.size = sizeof(AddrOut);
+   AddrIn.surf.size = sizeof(AddrIn.surf);
+
+   /* The tile index gives addrlib the tile mode, type and tile info. */
+   AddrIn.surf.x = x;
+   AddrIn.surf.y = y;
+   AddrIn.surf.slice = slice;
+   AddrIn.surf.bpp = surf->bpe * 8;
+   AddrIn.surf.pitch = surf->level[level].nblk_x;
+   AddrIn.surf.height = surf->level[level].nblk_y;
+   AddrIn.surf.numSlices = tex->target == PIPE_TEXTURE_3D ?
+                              u_minify(tex->depth0, level) :
+                           tex->target == PIPE_TEXTURE_CUBE ? 6 :
+                                                              tex->array_size;
+   AddrIn.surf.numSamples = 1;
+   AddrIn.surf.tileIndex = surf->tiling_index[level];
+   AddrIn.width = width;
+   AddrIn.height = height;
+   AddrOut.pAddr = offsets;
+
+   if (AddrComputeSurfaceAddrsFromCoords(ws->addrlib, &AddrIn,
+                                         &AddrOut) != ADDR_OK)
+      return false;
+
+   for (i = 0; i < width * height; i++)
+      offsets[i] += surf->level[level].offset;
+   return true;
+}
+
 void amdgpu_surface_init_functions(struct amdgpu_winsys *ws)
 {
    ws->base.surface_init = amdgpu_surface_init;
+   ws->base.surface_get_offsets = amdgpu_surface_get_offsets;
 }
@@ -501,6 +501,7 @@ amdgpu_winsys_create(int fd, radeon_screen_create_t screen_create)
    drmVersionPtr version = drmGetVersion(fd);
    amdgpu_device_handle dev;
    uint32_t drm_major, drm_minor, r;
+   long num_cpus;
 
    /* The DRM driver version of amdgpu is 3.x.x. */
    if (version->version_major != 3) {
@@ -550,7 +551,7 @@ amdgpu_winsys_create(int fd, radeon_screen_create_t screen_create)
 
    if (!pb_slabs_init(&ws->bo_slabs,
                       AMDGPU_SLAB_MIN_SIZE_LOG2, AMDGPU_SLAB_MAX_SIZE_LOG2,
-                      12, /* number of heaps (domain/flags combinations) */
+                      24, /* number of heaps (domain/flags combinations) */
                       ws,
                       amdgpu_bo_can_reclaim_slab,
                       amdgpu_bo_slab_alloc,
@@ -578,8 +579,14 @@ amdgpu_winsys_create(int fd, radeon_screen_create_t screen_create)
    pipe_mutex_init(ws->global_bo_list_lock);
    pipe_mutex_init(ws->bo_fence_lock);
 
-   if (sysconf(_SC_NPROCESSORS_ONLN) > 1 && debug_get_option_thread())
-      util_queue_init(&ws->cs_queue, "amdgpu_cs", 8, 1);
+   /* A CS has at most one submission in flight, so several threads keep
+    * the submissions of each CS in order, while the CS of different
+    * contexts don't wait for each other.
+    */
+   num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   if (num_cpus > 1 && debug_get_option_thread())
+      util_queue_init(&ws->cs_queue, "amdgpu_cs", 8,
+                      MIN2(num_cpus, AMDGPU_CS_MAX_THREADS));
 
    /* Create the screen at the end. The winsys must be initialized
     * completely.
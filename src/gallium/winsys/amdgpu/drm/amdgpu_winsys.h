@@ -44,6 +44,9 @@ struct amdgpu_cs;
 #define AMDGPU_SLAB_MIN_SIZE_LOG2 9
 #define AMDGPU_SLAB_MAX_SIZE_LOG2 14
 
+/* Maximum number of threads submitting command streams. */
+#define AMDGPU_CS_MAX_THREADS 4
+
 struct amdgpu_winsys {
    struct radeon_winsys base;
    struct pipe_reference reference;
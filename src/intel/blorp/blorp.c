@@ -51,6 +51,7 @@ blorp_batch_init(struct blorp_context *blorp,
    batch->blorp = blorp;
    batch->driver_batch = driver_batch;
    batch->flags = flags;
+   batch->has_pipeline_key = false;
 }
 
 void
@@ -76,12 +76,45 @@ enum blorp_batch_flags {
     * hardware.
     */
    BLORP_BATCH_NO_EMIT_DEPTH_STENCIL = (1 << 0),
+
+   /**
+    * This flag indicates that the driver emits no 3D state between the
+    * operations of the batch.  Blorp then only emits the pipeline state of
+    * an operation when it differs from the one of the previous operation,
+    * which makes runs of small copies a lot cheaper.
+    */
+   BLORP_BATCH_REUSE_PIPELINE_STATE = (1 << 1),
+};
+
+/**
+ * Everything the non-surface state emitted by blorp_exec depends on.
+ */
+struct blorp_pipeline_key {
+   uint32_t vs_prog_kernel;
+   const void *vs_prog_data;
+   uint32_t wm_prog_kernel;
+   const void *wm_prog_data;
+   uint32_t num_samples;
+   uint32_t num_draw_buffers;
+   uint32_t depth_format;
+   uint32_t hiz_op;
+   uint32_t fast_clear_op;
+   uint8_t stencil_mask;
+   uint8_t stencil_ref;
+   bool color_write_disable[4];
+   bool src_enabled;
+   bool depth_enabled;
+   bool stencil_enabled;
 };
 
 struct blorp_batch {
    struct blorp_context *blorp;
    void *driver_batch;
    enum blorp_batch_flags flags;
+
+   /** Pipeline state emitted last, for BLORP_BATCH_REUSE_PIPELINE_STATE */
+   bool has_pipeline_key;
+   struct blorp_pipeline_key pipeline_key;
 };
 
 void blorp_batch_init(struct blorp_context *blorp, struct blorp_batch *batch,
@@ -1268,22 +1268,58 @@ blorp_emit_viewport_state(struct blorp_batch *batch,
 
 
 /**
- * \brief Execute a blit or render pass operation.
- *
- * To execute the operation, this function manually constructs and emits a
- * batch to draw a rectangle primitive. The batchbuffer is flushed before
- * constructing and after emitting the batch.
- *
- * This function alters no GL state.
+ * Returns whether the pipeline state of \p params has to be emitted, and
+ * records it as the current one of the batch.
+ */
+static bool
+blorp_pipeline_state_changed(struct blorp_batch *batch,
+                             const struct blorp_params *params)
+{
+   struct blorp_pipeline_key key;
+
+   if (!(batch->flags & BLORP_BATCH_REUSE_PIPELINE_STATE))
+      return true;
+
+   /* The key is compared with memcmp, so clear the padding as well. */
+   memset(&key, 0, sizeof(key));
+   key.vs_prog_kernel = params->vs_prog_kernel;
+   key.vs_prog_data = params->vs_prog_data;
+   key.wm_prog_kernel = params->wm_prog_kernel;
+   key.wm_prog_data = params->wm_prog_data;
+   key.num_samples = params->num_samples;
+   key.num_draw_buffers = params->num_draw_buffers;
+   key.depth_format = params->depth_format;
+   key.hiz_op = params->hiz_op;
+   key.fast_clear_op = params->fast_clear_op;
+   key.stencil_mask = params->stencil_mask;
+   key.stencil_ref = params->stencil_ref;
+   memcpy(key.color_write_disable, params->color_write_disable,
+          sizeof(key.color_write_disable));
+   key.src_enabled = params->src.enabled;
+   key.depth_enabled = params->depth.enabled;
+   key.stencil_enabled = params->stencil.enabled;
+
+   if (batch->has_pipeline_key &&
+       memcmp(&batch->pipeline_key, &key, sizeof(key)) == 0)
+      return false;
+
+   batch->pipeline_key = key;
+   batch->has_pipeline_key = true;
+   return true;
+}
+
+/**
+ * Emits all the state of the operation that doesn't depend on its surfaces
+ * and rectangle.
  */
 static void
-blorp_exec(struct blorp_batch *batch, const struct blorp_params *params)
+blorp_emit_pipeline_state(struct blorp_batch *batch,
+                          const struct blorp_params *params)
 {
    uint32_t blend_state_offset = 0;
    uint32_t color_calc_state_offset = 0;
    uint32_t depth_stencil_state_offset;
 
-   blorp_emit_vertex_buffers(batch, params);
    blorp_emit_vertex_elements(batch, params);
 
    emit_urb_config(batch, params);
@@ -1328,8 +1364,6 @@ blorp_exec(struct blorp_batch *batch, const struct blorp_params *params)
    blorp_emit(batch, GENX(3DSTATE_CONSTANT_GS), gs);
    blorp_emit(batch, GENX(3DSTATE_CONSTANT_PS), ps);
 
-   blorp_emit_surface_states(batch, params);
-
    if (params->src.enabled)
       blorp_emit_sampler_state(batch, params);
 
@@ -1366,6 +1400,29 @@ blorp_exec(struct blorp_batch *batch, const struct blorp_params *params)
    blorp_emit_ps_config(batch, params);
 
    blorp_emit_viewport_state(batch, params);
+}
+
+/**
+ * \brief Execute a blit or render pass operation.
+ *
+ * To execute the operation, this function manually constructs and emits a
+ * batch to draw a rectangle primitive. The batchbuffer is flushed before
+ * constructing and after emitting the batch.
+ *
+ * With BLORP_BATCH_REUSE_PIPELINE_STATE, consecutive operations of the batch
+ * that only differ in their surfaces and rectangles (such as the regions of
+ * a copy) only emit their vertices, surface states and the draw.
+ *
+ * This function alters no GL state.
+ */
+static void
+blorp_exec(struct blorp_batch *batch, const struct blorp_params *params)
+{
+   if (blorp_pipeline_state_changed(batch, params))
+      blorp_emit_pipeline_state(batch, params);
+
+   blorp_emit_vertex_buffers(batch, params);
+   blorp_emit_surface_states(batch, params);
 
    if (!(batch->flags & BLORP_BATCH_NO_EMIT_DEPTH_STENCIL))
       blorp_emit_depth_stencil_config(batch, params);
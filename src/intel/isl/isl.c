@@ -24,6 +24,9 @@
 #include <assert.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
+
+#include "c11/threads.h"
 
 #include "isl.h"
 #include "isl_gen4.h"
@@ -1175,10 +1178,10 @@ isl_apply_surface_padding(const struct isl_device *dev,
    }
 }
 
-bool
-isl_surf_init_s(const struct isl_device *dev,
-                struct isl_surf *surf,
-                const struct isl_surf_init_info *restrict info)
+static bool
+isl_surf_calc_layout(const struct isl_device *dev,
+                     struct isl_surf *surf,
+                     const struct isl_surf_init_info *restrict info)
 {
    const struct isl_format_layout *fmtl = isl_format_get_layout(info->format);
 
@@ -1314,6 +1317,107 @@ isl_surf_init_s(const struct isl_device *dev,
    return true;
 }
 
+/**
+ * Layouts computed by isl_surf_init_s(), so that creating many identical
+ * surfaces doesn't compute the same layout over and over.
+ *
+ * The cache is direct-mapped and shared by every device in the process, so
+ * the key holds a copy of the device info rather than a pointer to it.
+ */
+#define ISL_SURF_CACHE_SIZE 128
+
+struct isl_surf_cache_key {
+   struct gen_device_info devinfo;
+   bool use_separate_stencil;
+   bool has_bit6_swizzling;
+   struct isl_surf_init_info info;
+};
+
+static struct {
+   bool valid;
+   struct isl_surf_cache_key key;
+   struct isl_surf surf;
+} isl_surf_cache[ISL_SURF_CACHE_SIZE];
+
+static mtx_t isl_surf_cache_mutex = _MTX_INITIALIZER_NP;
+
+static void
+isl_surf_cache_key_init(struct isl_surf_cache_key *key,
+                        const struct isl_device *dev,
+                        const struct isl_surf_init_info *info)
+{
+   /* The key is compared and hashed as raw bytes, so copy the init info
+    * field by field to leave any padding zeroed.
+    */
+   memset(key, 0, sizeof(*key));
+   memcpy(&key->devinfo, dev->info, sizeof(key->devinfo));
+   key->use_separate_stencil = dev->use_separate_stencil;
+   key->has_bit6_swizzling = dev->has_bit6_swizzling;
+   key->info.dim = info->dim;
+   key->info.format = info->format;
+   key->info.width = info->width;
+   key->info.height = info->height;
+   key->info.depth = info->depth;
+   key->info.levels = info->levels;
+   key->info.array_len = info->array_len;
+   key->info.samples = info->samples;
+   key->info.min_alignment = info->min_alignment;
+   key->info.min_pitch = info->min_pitch;
+   key->info.usage = info->usage;
+   key->info.tiling_flags = info->tiling_flags;
+}
+
+static uint32_t
+isl_surf_cache_key_hash(const struct isl_surf_cache_key *key)
+{
+   /* FNV-1a */
+   const uint8_t *bytes = (const uint8_t *) key;
+   uint32_t hash = 2166136261u;
+
+   for (size_t i = 0; i < sizeof(*key); i++) {
+      hash ^= bytes[i];
+      hash *= 16777619u;
+   }
+
+   return hash;
+}
+
+bool
+isl_surf_init_s(const struct isl_device *dev,
+                struct isl_surf *surf,
+                const struct isl_surf_init_info *restrict info)
+{
+   struct isl_surf_cache_key key;
+   isl_surf_cache_key_init(&key, dev, info);
+
+   const unsigned slot = isl_surf_cache_key_hash(&key) % ISL_SURF_CACHE_SIZE;
+   bool hit;
+
+   mtx_lock(&isl_surf_cache_mutex);
+   hit = isl_surf_cache[slot].valid &&
+         memcmp(&isl_surf_cache[slot].key, &key, sizeof(key)) == 0;
+   if (hit)
+      *surf = isl_surf_cache[slot].surf;
+   mtx_unlock(&isl_surf_cache_mutex);
+
+   if (hit)
+      return true;
+
+   /* Compute the layout outside the lock.  If another thread fills the same
+    * slot meanwhile, the last one to finish wins.
+    */
+   if (!isl_surf_calc_layout(dev, surf, info))
+      return false;
+
+   mtx_lock(&isl_surf_cache_mutex);
+   isl_surf_cache[slot].valid = true;
+   isl_surf_cache[slot].key = key;
+   isl_surf_cache[slot].surf = *surf;
+   mtx_unlock(&isl_surf_cache_mutex);
+
+   return true;
+}
+
 void
 isl_surf_get_tile_info(const struct isl_device *dev,
                        const struct isl_surf *surf,
@@ -273,6 +273,57 @@ test_bdw_3d_r8g8b8a8_unorm_256x256x256_levels09_tiley0(void)
    t_assert_gen4_3d_layer(&surf, 8,   4,   4,   1, 256,   1, &base_y);
 }
 
+static void
+t_assert_surf_equal(const struct isl_surf *a, const struct isl_surf *b)
+{
+   t_assert(a->tiling == b->tiling);
+   t_assert(a->dim_layout == b->dim_layout);
+   t_assert(a->msaa_layout == b->msaa_layout);
+   t_assert(a->size == b->size);
+   t_assert(a->alignment == b->alignment);
+   t_assert(a->row_pitch == b->row_pitch);
+   t_assert(a->array_pitch_el_rows == b->array_pitch_el_rows);
+   t_assert_extent4d(&a->phys_level0_sa, b->phys_level0_sa.w,
+                     b->phys_level0_sa.h, b->phys_level0_sa.d,
+                     b->phys_level0_sa.a);
+}
+
+static void
+test_bdw_2d_surf_init_cached(void)
+{
+   struct gen_device_info devinfo;
+   t_assert(gen_get_device_info(BDW_GT2_DEVID, &devinfo));
+
+   struct isl_device dev;
+   isl_device_init(&dev, &devinfo, /*bit6_swizzle*/ false);
+
+   /* The second init of the same surface comes from the layout cache, and
+    * must match the first.  A surface differing only in its minimum pitch
+    * must not.
+    */
+   struct isl_surf surf[3];
+   for (unsigned i = 0; i < 3; i++) {
+      bool ok = isl_surf_init(&dev, &surf[i],
+                              .dim = ISL_SURF_DIM_2D,
+                              .format = ISL_FORMAT_R8G8B8A8_UNORM,
+                              .width = 300,
+                              .height = 200,
+                              .depth = 1,
+                              .levels = 1,
+                              .array_len = 1,
+                              .samples = 1,
+                              .min_pitch = i == 2 ? 4096 : 0,
+                              .usage = ISL_SURF_USAGE_TEXTURE_BIT |
+                                       ISL_SURF_USAGE_DISABLE_AUX_BIT,
+                              .tiling_flags = ISL_TILING_LINEAR_BIT);
+      t_assert(ok);
+   }
+
+   t_assert_surf_equal(&surf[0], &surf[1]);
+   t_assert(surf[0].row_pitch < 4096);
+   t_assert(surf[2].row_pitch == 4096);
+}
+
 int main(void)
 {
    /* FINISHME: Add tests for npot sizes */
@@ -281,4 +332,5 @@ int main(void)
    test_bdw_2d_r8g8b8a8_unorm_512x512_array01_samples01_noaux_tiley0();
    test_bdw_2d_r8g8b8a8_unorm_1024x1024_array06_samples01_noaux_tiley0();
    test_bdw_3d_r8g8b8a8_unorm_256x256x256_levels09_tiley0();
+   test_bdw_2d_surf_init_cached();
 }
@@ -706,6 +706,29 @@ struct anv_state_stream_block {
 #endif
 };
 
+void
+anv_block_cache_init(struct anv_block_cache *cache,
+                     struct anv_block_pool *block_pool)
+{
+   cache->block_pool = block_pool;
+   cache->blocks = NULL;
+   cache->num_blocks = 0;
+}
+
+void
+anv_block_cache_finish(struct anv_block_cache *cache)
+{
+   struct anv_state_stream_block *next = cache->blocks;
+   while (next != NULL) {
+      struct anv_state_stream_block sb = *next;
+      anv_block_pool_free(cache->block_pool, sb.offset);
+      next = sb.next;
+   }
+
+   cache->blocks = NULL;
+   cache->num_blocks = 0;
+}
+
 /* The state stream allocator is a one-shot, single threaded allocator for
  * variable sized blocks.  We use it for allocating dynamic state.
  */
@@ -714,6 +737,7 @@ anv_state_stream_init(struct anv_state_stream *stream,
                       struct anv_block_pool *block_pool)
 {
    stream->block_pool = block_pool;
+   stream->cache = NULL;
    stream->block = NULL;
 
    /* Ensure that next + whatever > end.  This way the first call to
@@ -725,10 +749,22 @@ anv_state_stream_init(struct anv_state_stream *stream,
    VG(VALGRIND_CREATE_MEMPOOL(stream, 0, false));
 }
 
+/* Same as anv_state_stream_init(), but the stream gets its blocks from and
+ * returns them to the cache first.
+ */
+void
+anv_state_stream_init_cached(struct anv_state_stream *stream,
+                             struct anv_block_cache *cache)
+{
+   anv_state_stream_init(stream, cache->block_pool);
+   stream->cache = cache;
+}
+
 void
 anv_state_stream_finish(struct anv_state_stream *stream)
 {
    VG(const uint32_t block_size = stream->block_pool->block_size);
+   struct anv_block_cache *cache = stream->cache;
 
    struct anv_state_stream_block *next = stream->block;
    while (next != NULL) {
@@ -736,7 +772,14 @@ anv_state_stream_finish(struct anv_state_stream *stream)
       struct anv_state_stream_block sb = VG_NOACCESS_READ(next);
       VG(VALGRIND_MEMPOOL_FREE(stream, sb._vg_ptr));
       VG(VALGRIND_MAKE_MEM_UNDEFINED(next, block_size));
-      anv_block_pool_free(stream->block_pool, sb.offset);
+      if (cache && cache->num_blocks < ANV_BLOCK_CACHE_MAX_BLOCKS) {
+         next->next = cache->blocks;
+         next->offset = sb.offset;
+         cache->blocks = next;
+         cache->num_blocks++;
+      } else {
+         anv_block_pool_free(stream->block_pool, sb.offset);
+      }
       next = sb.next;
    }
 
@@ -753,7 +796,16 @@ anv_state_stream_alloc(struct anv_state_stream *stream,
 
    state.offset = align_u32(stream->next, alignment);
    if (state.offset + size > stream->end) {
-      uint32_t block = anv_block_pool_alloc(stream->block_pool);
+      struct anv_block_cache *cache = stream->cache;
+      uint32_t block;
+
+      if (cache && cache->blocks) {
+         block = cache->blocks->offset;
+         cache->blocks = cache->blocks->next;
+         cache->num_blocks--;
+      } else {
+         block = anv_block_pool_alloc(stream->block_pool);
+      }
       sb = stream->block_pool->map + block;
 
       VG(VALGRIND_MAKE_MEM_UNDEFINED(sb, sizeof(*sb)));
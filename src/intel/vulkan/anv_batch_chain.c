@@ -766,6 +766,14 @@ anv_cmd_buffer_reset_batch_bo_chain(struct anv_cmd_buffer *cmd_buffer)
       anv_cmd_buffer_current_batch_bo(cmd_buffer);
 }
 
+/* Secondaries at most this big, in bytes, and without any relocation are
+ * copied into the primary rather than chained to.  Anything bigger is
+ * jumped into, so that executing it again only costs patching its return
+ * MI_BATCH_BUFFER_START, and its relocations are used as they are instead
+ * of being copied into the primary's list.
+ */
+#define ANV_SECONDARY_EMIT_MAX_SIZE 256
+
 void
 anv_cmd_buffer_end_batch_buffer(struct anv_cmd_buffer *cmd_buffer)
 {
@@ -801,10 +809,10 @@ anv_cmd_buffer_end_batch_buffer(struct anv_cmd_buffer *cmd_buffer)
       if (!cmd_buffer->device->can_chain_batches) {
          cmd_buffer->exec_mode = ANV_CMD_BUFFER_EXEC_MODE_GROW_AND_EMIT;
       } else if ((cmd_buffer->batch_bos.next == cmd_buffer->batch_bos.prev) &&
-          (batch_bo->length < ANV_CMD_BUFFER_BATCH_SIZE / 2)) {
-         /* If the secondary has exactly one batch buffer in its list *and*
-          * that batch buffer is less than half of the maximum size, we're
-          * probably better of simply copying it into our batch.
+                 batch_bo->length <= ANV_SECONDARY_EMIT_MAX_SIZE &&
+                 batch_bo->relocs.num_relocs == 0) {
+         /* If the secondary is a handful of commands in a single batch
+          * buffer, copying them is cheaper than the jump and return.
           */
          cmd_buffer->exec_mode = ANV_CMD_BUFFER_EXEC_MODE_EMIT;
       } else if (!(cmd_buffer->usage_flags &
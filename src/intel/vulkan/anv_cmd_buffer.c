@@ -190,10 +190,17 @@ static VkResult anv_create_cmd_buffer(
    if (result != VK_SUCCESS)
       goto fail;
 
-   anv_state_stream_init(&cmd_buffer->surface_state_stream,
-                         &device->surface_state_block_pool);
-   anv_state_stream_init(&cmd_buffer->dynamic_state_stream,
-                         &device->dynamic_state_block_pool);
+   if (pool) {
+      anv_state_stream_init_cached(&cmd_buffer->surface_state_stream,
+                                   &pool->surface_state_cache);
+      anv_state_stream_init_cached(&cmd_buffer->dynamic_state_stream,
+                                   &pool->dynamic_state_cache);
+   } else {
+      anv_state_stream_init(&cmd_buffer->surface_state_stream,
+                            &device->surface_state_block_pool);
+      anv_state_stream_init(&cmd_buffer->dynamic_state_stream,
+                            &device->dynamic_state_block_pool);
+   }
 
    if (pool) {
       list_addtail(&cmd_buffer->pool_link, &pool->cmd_buffers);
@@ -277,13 +284,23 @@ anv_cmd_buffer_reset(struct anv_cmd_buffer *cmd_buffer)
    anv_cmd_buffer_reset_batch_bo_chain(cmd_buffer);
    anv_cmd_state_reset(cmd_buffer);
 
+   /* The streams keep their caches, so the blocks they had are reused
+    * right away.
+    */
+   struct anv_block_cache *surface_cache =
+      cmd_buffer->surface_state_stream.cache;
+   struct anv_block_cache *dynamic_cache =
+      cmd_buffer->dynamic_state_stream.cache;
+
    anv_state_stream_finish(&cmd_buffer->surface_state_stream);
    anv_state_stream_init(&cmd_buffer->surface_state_stream,
                          &cmd_buffer->device->surface_state_block_pool);
+   cmd_buffer->surface_state_stream.cache = surface_cache;
 
    anv_state_stream_finish(&cmd_buffer->dynamic_state_stream);
    anv_state_stream_init(&cmd_buffer->dynamic_state_stream,
                          &cmd_buffer->device->dynamic_state_block_pool);
+   cmd_buffer->dynamic_state_stream.cache = dynamic_cache;
    return VK_SUCCESS;
 }
 
@@ -748,6 +765,11 @@ VkResult anv_CreateCommandPool(
 
    list_inithead(&pool->cmd_buffers);
 
+   anv_block_cache_init(&pool->surface_state_cache,
+                        &device->surface_state_block_pool);
+   anv_block_cache_init(&pool->dynamic_state_cache,
+                        &device->dynamic_state_block_pool);
+
    *pCmdPool = anv_cmd_pool_to_handle(pool);
 
    return VK_SUCCESS;
@@ -769,6 +791,9 @@ void anv_DestroyCommandPool(
       anv_cmd_buffer_destroy(cmd_buffer);
    }
 
+   anv_block_cache_finish(&pool->surface_state_cache);
+   anv_block_cache_finish(&pool->dynamic_state_cache);
+
    vk_free2(&device->alloc, pAllocator, pool);
 }
 
@@ -784,6 +809,11 @@ VkResult anv_ResetCommandPool(
       anv_cmd_buffer_reset(cmd_buffer);
    }
 
+   if (flags & VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT) {
+      anv_block_cache_finish(&pool->surface_state_cache);
+      anv_block_cache_finish(&pool->dynamic_state_cache);
+   }
+
    return VK_SUCCESS;
 }
 
@@ -655,10 +655,10 @@ void anv_UpdateDescriptorSets(
                &set->buffer_views[bind_layout->buffer_index];
             view += write->dstArrayElement + j;
 
-            view->format =
+            enum isl_format format =
                anv_isl_format_for_descriptor_type(write->descriptorType);
-            view->bo = buffer->bo;
-            view->offset = buffer->offset + write->pBufferInfo[j].offset;
+            uint32_t offset = buffer->offset + write->pBufferInfo[j].offset;
+            uint64_t range;
 
             /* For buffers with dynamic offsets, we use the full possible
              * range in the surface state and do the actual range-checking
@@ -666,9 +666,26 @@ void anv_UpdateDescriptorSets(
              */
             if (bind_layout->dynamic_offset_index >= 0 ||
                 write->pBufferInfo[j].range == VK_WHOLE_SIZE)
-               view->range = buffer->size - write->pBufferInfo[j].offset;
+               range = buffer->size - write->pBufferInfo[j].offset;
             else
-               view->range = write->pBufferInfo[j].range;
+               range = write->pBufferInfo[j].range;
+
+            /* Applications tend to rewrite the same buffers every frame.
+             * If this descriptor already points at this exact range, its
+             * surface state is still good and packing it again (and
+             * flushing it on !llc) is wasted work.
+             */
+            if (desc[j].buffer_view == view && view->bo == buffer->bo &&
+                view->format == format && view->offset == offset &&
+                view->range == range) {
+               desc[j].type = write->descriptorType;
+               continue;
+            }
+
+            view->format = format;
+            view->bo = buffer->bo;
+            view->offset = offset;
+            view->range = range;
 
             anv_fill_buffer_surface_state(device, view->surface_state,
                                           view->format,
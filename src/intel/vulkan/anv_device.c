@@ -31,6 +31,7 @@
 #include <fcntl.h>
 
 #include "anv_private.h"
+#include "util/disk_cache.h"
 #include "util/strtod.h"
 #include "util/debug.h"
 
@@ -215,6 +216,8 @@ anv_physical_device_init(struct anv_physical_device *device,
 
    isl_device_init(&device->isl_dev, &device->info, swizzled);
 
+   device->disk_cache = disk_cache_create();
+
    close(fd);
    return VK_SUCCESS;
 
@@ -226,6 +229,8 @@ fail:
 static void
 anv_physical_device_finish(struct anv_physical_device *device)
 {
+   if (device->disk_cache)
+      disk_cache_destroy(device->disk_cache);
    anv_finish_wsi(device);
    ralloc_free(device->compiler);
 }
@@ -975,6 +980,9 @@ VkResult anv_CreateDevice(
    if (result != VK_SUCCESS)
       goto fail_fd;
 
+   anv_pipeline_cache_init(&device->default_pipeline_cache, device,
+                           anv_pipeline_cache_enabled());
+
    anv_device_init_blorp(device);
 
    anv_device_init_border_colors(device);
@@ -999,6 +1007,8 @@ void anv_DestroyDevice(
 
    anv_device_finish_blorp(device);
 
+   anv_pipeline_cache_finish(&device->default_pipeline_cache);
+
    anv_queue_finish(&device->queue);
 
 #ifdef HAVE_VALGRIND
@@ -88,6 +88,7 @@ void anv_DestroyShaderModule(
  */
 static nir_shader *
 anv_shader_compile_to_nir(struct anv_device *device,
+                          struct anv_pipeline_cache *cache,
                           struct anv_shader_module *module,
                           const char *entrypoint_name,
                           gl_shader_stage stage,
@@ -102,6 +103,20 @@ anv_shader_compile_to_nir(struct anv_device *device,
    const nir_shader_compiler_options *nir_options =
       compiler->glsl_compiler_options[stage].NirOptions;
 
+   /* The NIR doesn't depend on the pipeline layout or the program key, so
+    * only the stage goes in front of the module and specialization data.
+    */
+   unsigned char sha1[20];
+   if (cache) {
+      anv_hash_shader(sha1, &stage, sizeof(stage), module, entrypoint_name,
+                      NULL, spec_info);
+
+      nir_shader *nir = anv_pipeline_cache_search_nir(cache, sha1,
+                                                      nir_options);
+      if (nir)
+         return nir;
+   }
+
    uint32_t *spirv = (uint32_t *) module->data;
    assert(spirv[0] == SPIR_V_MAGIC_NUMBER);
    assert(module->size % 4 == 0);
@@ -187,6 +202,9 @@ anv_shader_compile_to_nir(struct anv_device *device,
 
    nir_lower_indirect_derefs(nir, indirect_mask);
 
+   if (cache)
+      anv_pipeline_cache_upload_nir(cache, sha1, nir);
+
    return nir;
 }
 
@@ -309,6 +327,7 @@ populate_cs_prog_key(const struct gen_device_info *devinfo,
 
 static nir_shader *
 anv_pipeline_compile(struct anv_pipeline *pipeline,
+                     struct anv_pipeline_cache *cache,
                      struct anv_shader_module *module,
                      const char *entrypoint,
                      gl_shader_stage stage,
@@ -316,7 +335,7 @@ anv_pipeline_compile(struct anv_pipeline *pipeline,
                      struct brw_stage_prog_data *prog_data,
                      struct anv_pipeline_bind_map *map)
 {
-   nir_shader *nir = anv_shader_compile_to_nir(pipeline->device,
+   nir_shader *nir = anv_shader_compile_to_nir(pipeline->device, cache,
                                                module, entrypoint, stage,
                                                spec_info);
    if (nir == NULL)
@@ -460,7 +479,8 @@ anv_pipeline_compile_vs(struct anv_pipeline *pipeline,
          .sampler_to_descriptor = sampler_to_descriptor
       };
 
-      nir_shader *nir = anv_pipeline_compile(pipeline, module, entrypoint,
+      nir_shader *nir = anv_pipeline_compile(pipeline, cache,
+                                             module, entrypoint,
                                              MESA_SHADER_VERTEX, spec_info,
                                              &prog_data.base.base, &map);
       if (nir == NULL)
@@ -538,7 +558,8 @@ anv_pipeline_compile_gs(struct anv_pipeline *pipeline,
          .sampler_to_descriptor = sampler_to_descriptor
       };
 
-      nir_shader *nir = anv_pipeline_compile(pipeline, module, entrypoint,
+      nir_shader *nir = anv_pipeline_compile(pipeline, cache,
+                                             module, entrypoint,
                                              MESA_SHADER_GEOMETRY, spec_info,
                                              &prog_data.base.base, &map);
       if (nir == NULL)
@@ -615,7 +636,8 @@ anv_pipeline_compile_fs(struct anv_pipeline *pipeline,
          .sampler_to_descriptor = sampler_to_descriptor
       };
 
-      nir_shader *nir = anv_pipeline_compile(pipeline, module, entrypoint,
+      nir_shader *nir = anv_pipeline_compile(pipeline, cache,
+                                             module, entrypoint,
                                              MESA_SHADER_FRAGMENT, spec_info,
                                              &prog_data.base, &map);
       if (nir == NULL)
@@ -737,7 +759,8 @@ anv_pipeline_compile_cs(struct anv_pipeline *pipeline,
          .sampler_to_descriptor = sampler_to_descriptor
       };
 
-      nir_shader *nir = anv_pipeline_compile(pipeline, module, entrypoint,
+      nir_shader *nir = anv_pipeline_compile(pipeline, cache,
+                                             module, entrypoint,
                                              MESA_SHADER_COMPUTE, spec_info,
                                              &prog_data.base, &map);
       if (nir == NULL)
@@ -24,7 +24,9 @@
 #include "util/mesa-sha1.h"
 #include "util/hash_table.h"
 #include "util/debug.h"
+#include "util/disk_cache.h"
 #include "anv_private.h"
+#include "nir/nir_serialize.h"
 
 static size_t
 anv_shader_bin_size(uint32_t prog_data_size, uint32_t nr_params,
@@ -164,6 +166,18 @@ shader_bin_key_compare_func(const void *void_a, const void *void_b)
    return memcmp(a->data, b->data, a->size) == 0;
 }
 
+static uint32_t
+sha1_hash_func(const void *sha1)
+{
+   return _mesa_hash_data(sha1, 20);
+}
+
+static bool
+sha1_compare_func(const void *sha1_a, const void *sha1_b)
+{
+   return memcmp(sha1_a, sha1_b, 20) == 0;
+}
+
 void
 anv_pipeline_cache_init(struct anv_pipeline_cache *cache,
                         struct anv_device *device,
@@ -175,8 +189,11 @@ anv_pipeline_cache_init(struct anv_pipeline_cache *cache,
    if (cache_enabled) {
       cache->cache = _mesa_hash_table_create(NULL, shader_bin_key_hash_func,
                                              shader_bin_key_compare_func);
+      cache->nir_cache = _mesa_hash_table_create(NULL, sha1_hash_func,
+                                                 sha1_compare_func);
    } else {
       cache->cache = NULL;
+      cache->nir_cache = NULL;
    }
 }
 
@@ -196,6 +213,10 @@ anv_pipeline_cache_finish(struct anv_pipeline_cache *cache)
 
       _mesa_hash_table_destroy(cache->cache, NULL);
    }
+
+   /* The keys and blobs in the NIR cache are allocated out of the table. */
+   if (cache->nir_cache)
+      _mesa_hash_table_destroy(cache->nir_cache, NULL);
 }
 
 void
@@ -240,6 +261,10 @@ anv_pipeline_cache_search_locked(struct anv_pipeline_cache *cache,
       return NULL;
 }
 
+static struct anv_shader_bin *
+anv_pipeline_cache_load_from_disk(struct anv_pipeline_cache *cache,
+                                  const void *key_data, uint32_t key_size);
+
 struct anv_shader_bin *
 anv_pipeline_cache_search(struct anv_pipeline_cache *cache,
                           const void *key_data, uint32_t key_size)
@@ -254,6 +279,9 @@ anv_pipeline_cache_search(struct anv_pipeline_cache *cache,
 
    pthread_mutex_unlock(&cache->mutex);
 
+   if (!shader)
+      shader = anv_pipeline_cache_load_from_disk(cache, key_data, key_size);
+
    /* We increment refcount before handing it to the caller */
    if (shader)
       anv_shader_bin_ref(shader);
@@ -288,6 +316,135 @@ anv_pipeline_cache_add_shader(struct anv_pipeline_cache *cache,
    return bin;
 }
 
+/* Adds a shader written by anv_shader_bin_write_data() to the cache.
+ * Returns a pointer past the shader's data, or NULL if the data is
+ * truncated.
+ */
+static const void *
+anv_pipeline_cache_add_shader_data(struct anv_pipeline_cache *cache,
+                                   const void *p, const void *end,
+                                   struct anv_shader_bin **shader_out)
+{
+   struct anv_shader_bin bin;
+   if (p + sizeof(bin) > end)
+      return NULL;
+   memcpy(&bin, p, sizeof(bin));
+   p += align_u32(sizeof(struct anv_shader_bin), 8);
+
+   const struct brw_stage_prog_data *prog_data = p;
+   p += align_u32(bin.prog_data_size, 8);
+   if (p > end)
+      return NULL;
+
+   uint32_t param_size = prog_data->nr_params * sizeof(void *);
+   const void *prog_data_param = p;
+   p += align_u32(param_size, 8);
+
+   struct anv_shader_bin_key key;
+   if (p + sizeof(key) > end)
+      return NULL;
+   memcpy(&key, p, sizeof(key));
+   const void *key_data = p + sizeof(key);
+   p += align_u32(sizeof(key) + key.size, 8);
+
+   /* We're going to memcpy this so getting rid of const is fine */
+   struct anv_pipeline_binding *bindings = (void *)p;
+   p += align_u32((bin.bind_map.surface_count + bin.bind_map.sampler_count) *
+                  sizeof(struct anv_pipeline_binding), 8);
+   bin.bind_map.surface_to_descriptor = bindings;
+   bin.bind_map.sampler_to_descriptor = bindings + bin.bind_map.surface_count;
+
+   const void *kernel_data = p;
+   p += align_u32(bin.kernel_size, 8);
+
+   if (p > end)
+      return NULL;
+
+   struct anv_shader_bin *shader =
+      anv_pipeline_cache_add_shader(cache, key_data, key.size,
+                                    kernel_data, bin.kernel_size,
+                                    prog_data, bin.prog_data_size,
+                                    prog_data_param, &bin.bind_map);
+   if (shader_out)
+      *shader_out = shader;
+
+   return p;
+}
+
+/* The on-disk cache is shared with other drivers and builds, so the key
+ * also covers the device and the build through the cache UUID.
+ */
+static void
+anv_disk_cache_key(struct anv_device *device,
+                   const void *key_data, uint32_t key_size,
+                   cache_key key)
+{
+   struct anv_physical_device *pdevice = &device->instance->physicalDevice;
+   struct mesa_sha1 *ctx;
+
+   ctx = _mesa_sha1_init();
+   _mesa_sha1_update(ctx, pdevice->uuid, VK_UUID_SIZE);
+   _mesa_sha1_update(ctx, &pdevice->chipset_id, sizeof(pdevice->chipset_id));
+   _mesa_sha1_update(ctx, key_data, key_size);
+   _mesa_sha1_final(ctx, key);
+}
+
+static struct anv_shader_bin *
+anv_pipeline_cache_load_from_disk(struct anv_pipeline_cache *cache,
+                                  const void *key_data, uint32_t key_size)
+{
+   struct disk_cache *disk_cache =
+      cache->device->instance->physicalDevice.disk_cache;
+   struct anv_shader_bin *shader = NULL;
+   cache_key key;
+   size_t size;
+
+   if (!disk_cache)
+      return NULL;
+
+   anv_disk_cache_key(cache->device, key_data, key_size, key);
+   void *data = disk_cache_get(disk_cache, key, &size);
+   if (!data)
+      return NULL;
+
+   pthread_mutex_lock(&cache->mutex);
+   anv_pipeline_cache_add_shader_data(cache, data, data + size, &shader);
+   pthread_mutex_unlock(&cache->mutex);
+
+   free(data);
+
+   /* Ignore entries that aren't the shader we asked for. */
+   if (shader && (shader->key->size != key_size ||
+                  memcmp(shader->key->data, key_data, key_size) != 0))
+      return NULL;
+
+   return shader;
+}
+
+static void
+anv_pipeline_cache_store_to_disk(struct anv_pipeline_cache *cache,
+                                 const struct anv_shader_bin *shader)
+{
+   struct disk_cache *disk_cache =
+      cache->device->instance->physicalDevice.disk_cache;
+   cache_key key;
+
+   if (!disk_cache)
+      return;
+
+   const size_t size = anv_shader_bin_data_size(shader);
+   void *data = malloc(size);
+   if (!data)
+      return;
+
+   anv_shader_bin_write_data(shader, data);
+
+   anv_disk_cache_key(cache->device, shader->key->data, shader->key->size,
+                      key);
+   disk_cache_put(disk_cache, key, data, size);
+   free(data);
+}
+
 struct anv_shader_bin *
 anv_pipeline_cache_upload_kernel(struct anv_pipeline_cache *cache,
                                  const void *key_data, uint32_t key_size,
@@ -300,10 +457,15 @@ anv_pipeline_cache_upload_kernel(struct anv_pipeline_cache *cache,
       pthread_mutex_lock(&cache->mutex);
 
       struct anv_shader_bin *bin =
-         anv_pipeline_cache_add_shader(cache, key_data, key_size,
-                                       kernel_data, kernel_size,
-                                       prog_data, prog_data_size,
-                                       prog_data->param, bind_map);
+         anv_pipeline_cache_search_locked(cache, key_data, key_size);
+      if (!bin) {
+         bin = anv_pipeline_cache_add_shader(cache, key_data, key_size,
+                                             kernel_data, kernel_size,
+                                             prog_data, prog_data_size,
+                                             prog_data->param, bind_map);
+         if (bin)
+            anv_pipeline_cache_store_to_disk(cache, bin);
+      }
 
       pthread_mutex_unlock(&cache->mutex);
 
@@ -320,6 +482,54 @@ anv_pipeline_cache_upload_kernel(struct anv_pipeline_cache *cache,
    }
 }
 
+struct nir_shader *
+anv_pipeline_cache_search_nir(struct anv_pipeline_cache *cache,
+                              const unsigned char *sha1,
+                              const struct nir_shader_compiler_options *options)
+{
+   if (!cache->nir_cache)
+      return NULL;
+
+   nir_shader *nir = NULL;
+
+   pthread_mutex_lock(&cache->mutex);
+
+   struct hash_entry *entry = _mesa_hash_table_search(cache->nir_cache, sha1);
+   if (entry) {
+      const struct blob *blob = entry->data;
+      struct blob_reader reader;
+      blob_reader_init(&reader, blob->data, blob->size);
+      nir = nir_deserialize(NULL, options, &reader);
+   }
+
+   pthread_mutex_unlock(&cache->mutex);
+
+   return nir;
+}
+
+void
+anv_pipeline_cache_upload_nir(struct anv_pipeline_cache *cache,
+                              const unsigned char *sha1,
+                              const struct nir_shader *nir)
+{
+   if (!cache->nir_cache)
+      return;
+
+   pthread_mutex_lock(&cache->mutex);
+
+   if (_mesa_hash_table_search(cache->nir_cache, sha1) == NULL) {
+      struct blob *blob = blob_create(cache->nir_cache);
+      if (blob) {
+         nir_serialize(blob, nir);
+         void *key = ralloc_size(cache->nir_cache, 20);
+         memcpy(key, sha1, 20);
+         _mesa_hash_table_insert(cache->nir_cache, key, blob);
+      }
+   }
+
+   pthread_mutex_unlock(&cache->mutex);
+}
+
 struct cache_header {
    uint32_t header_size;
    uint32_t header_version;
@@ -364,50 +574,14 @@ anv_pipeline_cache_load(struct anv_pipeline_cache *cache,
    p += align_u32(sizeof(count), 8);
 
    for (uint32_t i = 0; i < count; i++) {
-      struct anv_shader_bin bin;
-      if (p + sizeof(bin) > end)
-         break;
-      memcpy(&bin, p, sizeof(bin));
-      p += align_u32(sizeof(struct anv_shader_bin), 8);
-
-      const struct brw_stage_prog_data *prog_data = p;
-      p += align_u32(bin.prog_data_size, 8);
-      if (p > end)
+      p = anv_pipeline_cache_add_shader_data(cache, p, end, NULL);
+      if (!p)
          break;
-
-      uint32_t param_size = prog_data->nr_params * sizeof(void *);
-      const void *prog_data_param = p;
-      p += align_u32(param_size, 8);
-
-      struct anv_shader_bin_key key;
-      if (p + sizeof(key) > end)
-         break;
-      memcpy(&key, p, sizeof(key));
-      const void *key_data = p + sizeof(key);
-      p += align_u32(sizeof(key) + key.size, 8);
-
-      /* We're going to memcpy this so getting rid of const is fine */
-      struct anv_pipeline_binding *bindings = (void *)p;
-      p += align_u32((bin.bind_map.surface_count + bin.bind_map.sampler_count) *
-                     sizeof(struct anv_pipeline_binding), 8);
-      bin.bind_map.surface_to_descriptor = bindings;
-      bin.bind_map.sampler_to_descriptor = bindings + bin.bind_map.surface_count;
-
-      const void *kernel_data = p;
-      p += align_u32(bin.kernel_size, 8);
-
-      if (p > end)
-         break;
-
-      anv_pipeline_cache_add_shader(cache, key_data, key.size,
-                                    kernel_data, bin.kernel_size,
-                                    prog_data, bin.prog_data_size,
-                                    prog_data_param, &bin.bind_map);
    }
 }
 
-static bool
-pipeline_cache_enabled()
+bool
+anv_pipeline_cache_enabled(void)
 {
    static int enabled = -1;
    if (enabled < 0)
@@ -433,7 +607,7 @@ VkResult anv_CreatePipelineCache(
    if (cache == NULL)
       return vk_error(VK_ERROR_OUT_OF_HOST_MEMORY);
 
-   anv_pipeline_cache_init(cache, device, pipeline_cache_enabled());
+   anv_pipeline_cache_init(cache, device, anv_pipeline_cache_enabled());
 
    if (pCreateInfo->initialDataSize > 0)
       anv_pipeline_cache_load(cache,
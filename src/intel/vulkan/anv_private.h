@@ -397,9 +397,25 @@ struct anv_state_pool {
 
 struct anv_state_stream_block;
 
+/* Keeps the blocks freed by state streams for reuse by other streams,
+ * without going through the block pool's atomics.  This isn't thread safe,
+ * so it is owned by something externally synchronized, like a command pool.
+ */
+struct anv_block_cache {
+   struct anv_block_pool *block_pool;
+
+   struct anv_state_stream_block *blocks;
+   uint32_t num_blocks;
+};
+
+#define ANV_BLOCK_CACHE_MAX_BLOCKS 32
+
 struct anv_state_stream {
    struct anv_block_pool *block_pool;
 
+   /* Where blocks come from and go back to first, if not NULL */
+   struct anv_block_cache *cache;
+
    /* The current working block */
    struct anv_state_stream_block *block;
 
@@ -445,8 +461,13 @@ void anv_state_pool_finish(struct anv_state_pool *pool);
 struct anv_state anv_state_pool_alloc(struct anv_state_pool *pool,
                                       size_t state_size, size_t alignment);
 void anv_state_pool_free(struct anv_state_pool *pool, struct anv_state state);
+void anv_block_cache_init(struct anv_block_cache *cache,
+                          struct anv_block_pool *block_pool);
+void anv_block_cache_finish(struct anv_block_cache *cache);
 void anv_state_stream_init(struct anv_state_stream *stream,
                            struct anv_block_pool *block_pool);
+void anv_state_stream_init_cached(struct anv_state_stream *stream,
+                                  struct anv_block_cache *cache);
 void anv_state_stream_finish(struct anv_state_stream *stream);
 struct anv_state anv_state_stream_alloc(struct anv_state_stream *stream,
                                         uint32_t size, uint32_t alignment);
@@ -508,6 +529,9 @@ struct anv_physical_device {
 
     uint8_t                                     uuid[VK_UUID_SIZE];
 
+    /* Backs the pipeline caches across runs; NULL if disabled. */
+    struct disk_cache *                         disk_cache;
+
     struct wsi_device                       wsi_device;
 };
 
@@ -537,6 +561,13 @@ struct anv_pipeline_cache {
    pthread_mutex_t                              mutex;
 
    struct hash_table *                          cache;
+
+   /* Serialized NIR, keyed by the hash of the module, entrypoint, stage
+    * and specialization constants, so that pipelines using the same shader
+    * with a different program key skip spirv_to_nir and the NIR
+    * optimization loop.
+    */
+   struct hash_table *                          nir_cache;
 };
 
 struct anv_pipeline_bind_map;
@@ -545,6 +576,7 @@ void anv_pipeline_cache_init(struct anv_pipeline_cache *cache,
                              struct anv_device *device,
                              bool cache_enabled);
 void anv_pipeline_cache_finish(struct anv_pipeline_cache *cache);
+bool anv_pipeline_cache_enabled(void);
 
 struct anv_shader_bin *
 anv_pipeline_cache_search(struct anv_pipeline_cache *cache,
@@ -557,6 +589,15 @@ anv_pipeline_cache_upload_kernel(struct anv_pipeline_cache *cache,
                                  uint32_t prog_data_size,
                                  const struct anv_pipeline_bind_map *bind_map);
 
+struct nir_shader *
+anv_pipeline_cache_search_nir(struct anv_pipeline_cache *cache,
+                              const unsigned char *sha1,
+                              const struct nir_shader_compiler_options *options);
+void
+anv_pipeline_cache_upload_nir(struct anv_pipeline_cache *cache,
+                              const unsigned char *sha1,
+                              const struct nir_shader *nir);
+
 struct anv_device {
     VK_LOADER_DATA                              _loader_data;
 
@@ -584,6 +625,11 @@ struct anv_device {
 
     struct anv_bo                               workaround_bo;
 
+    /* Used for pipelines created without a VkPipelineCache, so that they
+     * still go through the on-disk cache.
+     */
+    struct anv_pipeline_cache                   default_pipeline_cache;
+
     struct anv_pipeline_cache                   blorp_shader_cache;
     struct blorp_context                        blorp;
 
@@ -1170,6 +1216,10 @@ struct anv_cmd_state {
 struct anv_cmd_pool {
    VkAllocationCallbacks                        alloc;
    struct list_head                             cmd_buffers;
+
+   /* State stream blocks freed by reset or destroyed command buffers */
+   struct anv_block_cache                       surface_state_cache;
+   struct anv_block_cache                       dynamic_state_cache;
 };
 
 #define ANV_CMD_BUFFER_BATCH_SIZE 8192
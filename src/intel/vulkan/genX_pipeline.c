@@ -1465,10 +1465,14 @@ VkResult genX(CreateGraphicsPipelines)(
     const VkAllocationCallbacks*                pAllocator,
     VkPipeline*                                 pPipelines)
 {
+   ANV_FROM_HANDLE(anv_device, device, _device);
    ANV_FROM_HANDLE(anv_pipeline_cache, pipeline_cache, pipelineCache);
 
    VkResult result = VK_SUCCESS;
 
+   if (!pipeline_cache)
+      pipeline_cache = &device->default_pipeline_cache;
+
    unsigned i = 0;
    for (; i < count; i++) {
       result = genX(graphics_pipeline_create)(_device,
@@ -1495,10 +1499,14 @@ VkResult genX(CreateComputePipelines)(
     const VkAllocationCallbacks*                pAllocator,
     VkPipeline*                                 pPipelines)
 {
+   ANV_FROM_HANDLE(anv_device, device, _device);
    ANV_FROM_HANDLE(anv_pipeline_cache, pipeline_cache, pipelineCache);
 
    VkResult result = VK_SUCCESS;
 
+   if (!pipeline_cache)
+      pipeline_cache = &device->default_pipeline_cache;
+
    unsigned i = 0;
    for (; i < count; i++) {
       result = compute_pipeline_create(_device, pipeline_cache,
@@ -33,6 +33,7 @@
 #include <X11/Xlib-xcb.h>
 
 #include "loader_dri3_helper.h"
+#include "util/macros.h"
 
 /* From xmlpool/options.h, user exposed so should be stable */
 #define DRI_CONF_VBLANK_NEVER 0
@@ -68,7 +69,13 @@ dri3_fence_await(xcb_connection_t *c, struct loader_dri3_buffer *buffer)
 static void
 dri3_update_num_back(struct loader_dri3_drawable *draw)
 {
-   if (draw->flipping)
+   if (draw->forced_num_back)
+      draw->num_back = draw->forced_num_back;
+   else if (draw->flipping || draw->is_different_gpu)
+      /* Flipped buffers stay busy until the next flip, and with PRIME the
+       * server still has to copy from the linear buffer after our blit, so
+       * with two buffers we'd mostly end up waiting in dri3_find_back.
+       */
       draw->num_back = 3;
    else
       draw->num_back = 2;
@@ -138,6 +145,7 @@ loader_dri3_drawable_init(xcb_connection_t *conn,
    xcb_generic_error_t *error;
    GLint vblank_mode = DRI_CONF_VBLANK_DEF_INTERVAL_1;
    int swap_interval;
+   const char *env;
 
    draw->conn = conn;
    draw->ext = ext;
@@ -150,6 +158,11 @@ loader_dri3_drawable_init(xcb_connection_t *conn,
    draw->have_fake_front = 0;
    draw->first_init = true;
 
+   draw->forced_num_back = 0;
+   env = getenv("LIBGL_DRI3_NUM_BACK");
+   if (env)
+      draw->forced_num_back = CLAMP(atoi(env), 2, LOADER_DRI3_MAX_BACK);
+
    if (draw->ext->config)
       draw->ext->config->configQueryi(draw->dri_screen,
                                       "vblank_mode", &vblank_mode);
@@ -149,6 +149,8 @@ struct loader_dri3_drawable {
    struct loader_dri3_buffer *buffers[LOADER_DRI3_NUM_BUFFERS];
    int cur_back;
    int num_back;
+   /* From LIBGL_DRI3_NUM_BACK, 0 to pick num_back automatically */
+   int forced_num_back;
 
    uint32_t *stamp;
 
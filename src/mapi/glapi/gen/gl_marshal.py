@@ -0,0 +1,259 @@
+#!/usr/bin/env python2
+
+# Copyright (C) 2016 Intel Corporation
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+# This script generates the marshalling code used by glthread
+# (src/mesa/main/glthread.c): one _mesa_marshal_* function per GL entry
+# point, which either records the call into the current batch, or waits for
+# the glthread worker to go idle and then makes the call directly.
+
+import argparse
+import re
+
+import gl_XML
+import license
+
+
+header = """
+#include "main/context.h"
+#include "main/dispatch.h"
+#include "main/glthread.h"
+#include "main/mtypes.h"
+"""
+
+
+# Functions that have no outputs, but which must not return before the
+# call has been executed.
+sync_functions = set([
+    'Finish',
+    ])
+
+# Functions whose batch must be sent to the worker right away.
+flush_functions = set([
+    'Flush',
+    ])
+
+
+def uses_client_arrays(func):
+    """Whether func may read vertex data from client memory."""
+    return (re.match('(Multi)?Draw(Arrays|Elements|RangeElements|'
+                     'TransformFeedback)', func.name) or
+            func.name == 'ArrayElement')
+
+
+def sets_array_pointer(func):
+    """Whether func can point a vertex array at client memory."""
+    return ((re.search('Pointer', func.name) and
+             not func.name.startswith('Get')) or
+            func.name == 'InterleavedArrays')
+
+
+def fixed_size_input(p):
+    """Whether p points to a fixed number of elements read by the call."""
+    return (p.is_pointer() and p.count and not p.is_variable_length() and
+            not p.is_output and not p.is_image() and
+            p.type_string().startswith('const') and
+            p.get_base_type_string() not in ('void', 'GLvoid'))
+
+
+def can_marshal_async(func):
+    if func.return_type != 'void' or func.name in sync_functions:
+        return False
+    for p in func.parameterIterator():
+        if p.is_padding:
+            continue
+        if p.is_pointer() and not fixed_size_input(p):
+            return False
+    return True
+
+
+def params(func):
+    return [p for p in func.parameterIterator() if not p.is_padding]
+
+
+class PrintCode(gl_XML.gl_print_base):
+    def __init__(self):
+        gl_XML.gl_print_base.__init__(self)
+
+        self.name = 'gl_marshal.py'
+        self.license = license.bsd_license_template % (
+            'Copyright (C) 2016 Intel Corporation', 'INTEL CORPORATION')
+
+    def printRealHeader(self):
+        print header
+
+    def print_enum(self, async_funcs):
+        print 'enum marshal_dispatch_cmd_id'
+        print '{'
+        for func in async_funcs:
+            print '   DISPATCH_CMD_{0},'.format(func.name)
+        print '};'
+        print ''
+
+    def print_async(self, func):
+        ps = params(func)
+
+        print 'struct marshal_cmd_{0}'.format(func.name)
+        print '{'
+        print '   struct marshal_cmd_base cmd_base;'
+        for p in ps:
+            if p.is_pointer():
+                print '   {0} {1}[{2}];'.format(p.get_base_type_string(),
+                                                p.name, p.count)
+            else:
+                print '   {0} {1};'.format(p.type_string(), p.name)
+        print '};'
+        print ''
+
+        print 'static inline void'
+        print '_mesa_unmarshal_{0}(struct gl_context *ctx, ' \
+              'const struct marshal_cmd_{0} *cmd)'.format(func.name)
+        print '{'
+        print '   CALL_{0}(ctx->CurrentDispatch, ({1}));'.format(
+            func.name, ', '.join('cmd->' + p.name for p in ps))
+        print '}'
+        print ''
+
+        print 'static void GLAPIENTRY'
+        print '_mesa_marshal_{0}({1})'.format(func.name,
+                                              func.get_parameter_string())
+        print '{'
+        print '   GET_CURRENT_CONTEXT(ctx);'
+        print '   struct marshal_cmd_{0} *cmd;'.format(func.name)
+        print ''
+        if uses_client_arrays(func):
+            print '   if (ctx->GLThread->client_arrays) {'
+            print '      _mesa_glthread_begin_sync(ctx);'
+            print '      CALL_{0}(ctx->CurrentDispatch, ({1}));'.format(
+                func.name, func.get_called_parameter_string())
+            print '      _mesa_glthread_end_sync(ctx);'
+            print '      return;'
+            print '   }'
+            print ''
+        print '   cmd = _mesa_glthread_allocate_command(ctx, ' \
+              'DISPATCH_CMD_{0},'.format(func.name)
+        print '                                         sizeof(*cmd));'
+        for p in ps:
+            if p.is_pointer():
+                print '   memcpy(cmd->{0}, {0}, sizeof(cmd->{0}));'.format(
+                    p.name)
+            else:
+                print '   cmd->{0} = {0};'.format(p.name)
+        if func.name in flush_functions:
+            print '   _mesa_glthread_flush_batch(ctx);'
+        print '}'
+        print ''
+
+    def print_sync(self, func):
+        print 'static {0} GLAPIENTRY'.format(func.return_type)
+        print '_mesa_marshal_{0}({1})'.format(func.name,
+                                              func.get_parameter_string())
+        print '{'
+        print '   GET_CURRENT_CONTEXT(ctx);'
+        if func.return_type != 'void':
+            print '   {0} result;'.format(func.return_type)
+        print ''
+        print '   _mesa_glthread_begin_sync(ctx);'
+        call = 'CALL_{0}(ctx->CurrentDispatch, ({1}));'.format(
+            func.name, func.get_called_parameter_string())
+        if func.return_type != 'void':
+            print '   result = ' + call
+        else:
+            print '   ' + call
+        if sets_array_pointer(func):
+            print '   _mesa_glthread_check_client_arrays(ctx);'
+        print '   _mesa_glthread_end_sync(ctx);'
+        if func.return_type != 'void':
+            print '   return result;'
+        print '}'
+        print ''
+
+    def print_unmarshal_dispatch(self, async_funcs):
+        print 'size_t'
+        print '_mesa_unmarshal_dispatch_cmd(struct gl_context *ctx, ' \
+              'const void *cmd)'
+        print '{'
+        print '   const struct marshal_cmd_base *cmd_base = cmd;'
+        print ''
+        print '   switch (cmd_base->cmd_id) {'
+        for func in async_funcs:
+            print '   case DISPATCH_CMD_{0}:'.format(func.name)
+            print '      _mesa_unmarshal_{0}(ctx, cmd);'.format(func.name)
+            print '      break;'
+        print '   default:'
+        print '      unreachable("invalid glthread command");'
+        print '   }'
+        print ''
+        print '   return cmd_base->cmd_size;'
+        print '}'
+        print ''
+
+    def print_create_marshal_table(self, funcs):
+        print 'struct _glapi_table *'
+        print '_mesa_create_marshal_table(const struct gl_context *ctx)'
+        print '{'
+        print '   struct _glapi_table *table;'
+        print ''
+        print '   table = _mesa_alloc_dispatch_table();'
+        print '   if (table == NULL)'
+        print '      return NULL;'
+        print ''
+        for func in funcs:
+            print '   SET_{0}(table, _mesa_marshal_{0});'.format(func.name)
+        print ''
+        print '   return table;'
+        print '}'
+
+    def printBody(self, api):
+        funcs = [func for func in api.functionIterateByOffset()]
+        async_funcs = [func for func in funcs if can_marshal_async(func)]
+
+        self.print_enum(async_funcs)
+        for func in funcs:
+            if func in async_funcs:
+                self.print_async(func)
+            else:
+                self.print_sync(func)
+        self.print_unmarshal_dispatch(async_funcs)
+        self.print_create_marshal_table(funcs)
+
+
+def _parser():
+    """Parse arguments and return namespace."""
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-f',
+                        dest='filename',
+                        default='gl_and_es_API.xml',
+                        help='an xml file describing an API')
+    return parser.parse_args()
+
+
+def main():
+    """Main function."""
+    args = _parser()
+    printer = PrintCode()
+    api = gl_XML.parse_GL_API(args.filename)
+    printer.Print(api)
+
+
+if __name__ == '__main__':
+    main()
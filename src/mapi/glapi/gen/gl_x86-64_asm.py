@@ -232,6 +232,16 @@ class PrintGenericStubs(gl_XML.gl_print_base):
         print '\tjmp\t*%r11'
         print '#elif defined(HAVE_PTHREAD)'
 
+        # _glapi_Dispatch caches the table until a second thread makes a
+        # context current, so only look up the TSD after that.
+        print '\tmovq\t_glapi_Dispatch@GOTPCREL(%rip), %rax'
+        print '\tmovq\t(%rax), %rax'
+        print '\ttestq\t%rax, %rax'
+        print '\tje\t1f'
+        print '\tmovq\t%u(%%rax), %%r11' % (f.offset * 8)
+        print '\tjmp\t*%r11'
+        print '1:'
+
         save_all_regs(registers)
         print '\tcall\t_x86_64_get_dispatch@PLT'
         restore_all_regs(registers)
@@ -55,6 +55,7 @@
 #include "brw_blorp.h"
 #include "brw_compiler.h"
 #include "brw_draw.h"
+#include "brw_program.h"
 #include "brw_state.h"
 
 #include "intel_batchbuffer.h"
@@ -1039,6 +1040,8 @@ brwCreateContext(gl_api api,
 
    brw_process_driconf_options(brw);
 
+   brw_disk_cache_init(brw);
+
    if (INTEL_DEBUG & DEBUG_PERF)
       brw->perf_debug = true;
 
@@ -1152,6 +1155,8 @@ intelDestroyContext(__DRIcontext * driContextPriv)
       aub_dump_bmp(&brw->ctx);
    }
 
+   brw_disk_cache_finish(brw);
+
    _mesa_meta_free(&brw->ctx);
 
    if (INTEL_DEBUG & DEBUG_SHADER_TIME) {
@@ -41,6 +41,8 @@
 #include "intel_aub.h"
 
 #include "isl/isl.h"
+#include "util/bitset.h"
+#include "util/u_queue.h"
 #include "blorp/blorp.h"
 
 #ifdef __cplusplus
@@ -511,6 +513,25 @@ struct brw_tracked_state {
    void (*emit)( struct brw_context *brw );
 };
 
+/** Size of the largest list of state atoms, which is gen8's render list. */
+#define BRW_MAX_ATOMS 76
+
+/**
+ * For each dirty bit, the set of atoms of a pipeline which it triggers,
+ * indexed by their position in the pipeline's atom list.
+ */
+struct brw_atom_lists {
+   BITSET_WORD mesa[32][BITSET_WORDS(BRW_MAX_ATOMS)];
+   BITSET_WORD brw[BRW_NUM_STATE_BITS][BITSET_WORDS(BRW_MAX_ATOMS)];
+};
+
+/** Per-atom counters, gathered with INTEL_DEBUG=atoms. */
+struct brw_atom_stats {
+   uint64_t calls;
+   double time;
+   uint64_t bytes;
+};
+
 enum shader_time_shader_type {
    ST_NONE,
    ST_VS,
@@ -579,6 +600,20 @@ struct intel_batchbuffer {
    bool needs_sol_reset;
    bool state_base_address_emitted;
 
+   /**
+    * Buffers only read by the batch, which are passed to the kernel as
+    * softpin targets instead of relocations.  Only used on screens with
+    * softpin.
+    */
+   struct set *softpin_targets;
+
+   /**
+    * Whether every buffer referenced by the batch was at its fixed address
+    * when the reference was written, so that the kernel can skip the
+    * relocations.
+    */
+   bool all_pinned;
+
    struct {
       uint32_t *map_next;
       int reloc_count;
@@ -859,6 +894,9 @@ struct brw_context
 
    struct brw_cache cache;
 
+   /** Thread writing compiled programs out to the on-disk shader cache. */
+   struct util_queue disk_cache_queue;
+
    /** IDs for meta stencil blit shader programs. */
    struct gl_shader_program *meta_stencil_blit_programs[2];
 
@@ -1210,8 +1248,10 @@ struct brw_context
    } perfmon;
 
    int num_atoms[BRW_NUM_PIPELINES];
-   const struct brw_tracked_state render_atoms[76];
+   const struct brw_tracked_state render_atoms[BRW_MAX_ATOMS];
    const struct brw_tracked_state compute_atoms[11];
+   struct brw_atom_lists atom_lists[BRW_NUM_PIPELINES];
+   struct brw_atom_stats atom_stats[BRW_NUM_PIPELINES][BRW_MAX_ATOMS];
 
    /* If (INTEL_DEBUG & DEBUG_BATCH) */
    struct {
@@ -70,6 +70,26 @@ brw_codegen_cs_prog(struct brw_context *brw,
       (struct brw_shader *) prog->_LinkedShaders[MESA_SHADER_COMPUTE];
    assert (cs);
 
+   const unsigned subslices = MAX2(brw->screen->subslice_total, 1);
+
+   /* WaCSScratchSize:hsw
+    *
+    * Haswell's scratch space address calculation appears to be sparse
+    * rather than tightly packed.  The Thread ID has bits indicating
+    * which subslice, EU within a subslice, and thread within an EU
+    * it is.  There's a maximum of two slices and two subslices, so these
+    * can be stored with a single bit.  Even though there are only 10 EUs
+    * per subslice, this is stored in 4 bits, so there's an effective
+    * maximum value of 16 EUs.  Similarly, although there are only 7
+    * threads per EU, this is stored in a 3 bit number, giving an effective
+    * maximum value of 8 threads per EU.
+    *
+    * This means that we need to use 16 * 8 instead of 10 * 7 for the
+    * number of threads per subslice.
+    */
+   const unsigned scratch_ids_per_subslice =
+      brw->is_haswell ? 16 * 8 : devinfo->max_cs_threads;
+
    memset(&prog_data, 0, sizeof(prog_data));
 
    if (prog->Comp.SharedSize > 64 * 1024) {
@@ -85,6 +105,20 @@ brw_codegen_cs_prog(struct brw_context *brw,
       prog_data.base.total_shared = prog->Comp.SharedSize;
    }
 
+   cache_key disk_key;
+   const bool use_disk_cache =
+      brw_disk_cache_key(brw, prog, MESA_SHADER_COMPUTE, key, sizeof(*key),
+                         offsetof(struct brw_cs_prog_key, program_string_id),
+                         disk_key);
+   if (use_disk_cache) {
+      program = brw_disk_cache_read_program(brw, disk_key, prog, &cp->program,
+                                            &prog_data.base, sizeof(prog_data),
+                                            mem_ctx, &program_size);
+      if (program)
+         goto upload;
+      prog_data.base.total_shared = prog->Comp.SharedSize;
+   }
+
    assign_cs_binding_table_offsets(devinfo, prog, &cp->program, &prog_data);
 
    /* Allocate the references to the uniforms that will end up in the
@@ -134,6 +168,12 @@ brw_codegen_cs_prog(struct brw_context *brw,
       return false;
    }
 
+   if (use_disk_cache) {
+      brw_disk_cache_write_program(brw, disk_key, prog, &cp->program,
+                                   program, program_size,
+                                   &prog_data.base, sizeof(prog_data));
+   }
+
    if (unlikely(brw->perf_debug) && cs) {
       if (cs->compiled_once) {
          _mesa_problem(&brw->ctx, "CS programs shouldn't need recompiles");
@@ -146,26 +186,7 @@ brw_codegen_cs_prog(struct brw_context *brw,
       }
    }
 
-   const unsigned subslices = MAX2(brw->screen->subslice_total, 1);
-
-   /* WaCSScratchSize:hsw
-    *
-    * Haswell's scratch space address calculation appears to be sparse
-    * rather than tightly packed.  The Thread ID has bits indicating
-    * which subslice, EU within a subslice, and thread within an EU
-    * it is.  There's a maximum of two slices and two subslices, so these
-    * can be stored with a single bit.  Even though there are only 10 EUs
-    * per subslice, this is stored in 4 bits, so there's an effective
-    * maximum value of 16 EUs.  Similarly, although there are only 7
-    * threads per EU, this is stored in a 3 bit number, giving an effective
-    * maximum value of 8 threads per EU.
-    *
-    * This means that we need to use 16 * 8 instead of 10 * 7 for the
-    * number of threads per subslice.
-    */
-   const unsigned scratch_ids_per_subslice =
-      brw->is_haswell ? 16 * 8 : devinfo->max_cs_threads;
-
+upload:
    brw_alloc_stage_scratch(brw, &brw->cs.base,
                            prog_data.base.total_scratch,
                            scratch_ids_per_subslice * subslices);
@@ -0,0 +1,393 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/** @file brw_disk_cache.c
+ *
+ * Keeps the compiled kernels of GLSL programs, together with their
+ * brw_stage_prog_data, in the on-disk shader cache so that other processes
+ * running the same program can skip the backend compile entirely.
+ *
+ * The prog_data is stored as-is, except for the param and pull_param arrays:
+ * those point at uniform storage owned by the GL objects, so each pointer is
+ * written as an index into one of the few places it can point to, and is
+ * turned back into a pointer against the current objects when loading.
+ * Programs with a param pointing anywhere else are simply not stored.
+ */
+
+#include "main/imports.h"
+#include "compiler/glsl/blob.h"
+#include "program/prog_parameter.h"
+#include "util/mesa-sha1.h"
+#include "util/ralloc.h"
+
+#include "brw_context.h"
+#include "brw_nir.h"
+#include "brw_program.h"
+
+/* Compiling with any of these set is expected to print something. */
+#define DEBUG_DISK_CACHE_BYPASS (DEBUG_VS | DEBUG_TCS | DEBUG_TES | DEBUG_GS | \
+                                 DEBUG_WM | DEBUG_CS | DEBUG_OPTIMIZER | \
+                                 DEBUG_SHADER_TIME)
+
+enum brw_param_region {
+   BRW_PARAM_REGION_ZERO = 1,
+   BRW_PARAM_REGION_UNIFORM,
+   BRW_PARAM_REGION_STATE,
+   BRW_PARAM_REGION_IMAGE,
+   BRW_PARAM_REGION_CLIP_PLANE,
+   BRW_PARAM_NUM_REGIONS,
+};
+
+#define BRW_PARAM_REGION_SHIFT 24
+#define BRW_PARAM_INDEX_MASK ((1u << BRW_PARAM_REGION_SHIFT) - 1)
+#define BRW_PARAM_INVALID ~0u
+
+struct param_region {
+   const union gl_constant_value *base;
+   unsigned size;
+};
+
+static void
+setup_param_regions(struct brw_context *brw,
+                    const struct gl_shader_program *shader_prog,
+                    const struct gl_program *prog,
+                    const struct brw_image_param *image_param,
+                    unsigned nr_image_params,
+                    struct param_region *regions)
+{
+   memset(regions, 0, BRW_PARAM_NUM_REGIONS * sizeof(*regions));
+
+   regions[BRW_PARAM_REGION_ZERO].base = &brw_zero_param;
+   regions[BRW_PARAM_REGION_ZERO].size = 1;
+
+   regions[BRW_PARAM_REGION_UNIFORM].base = shader_prog->data->UniformDataSlots;
+   regions[BRW_PARAM_REGION_UNIFORM].size =
+      shader_prog->data->NumUniformDataSlots;
+
+   if (prog->Parameters) {
+      regions[BRW_PARAM_REGION_STATE].base =
+         &prog->Parameters->ParameterValues[0][0];
+      regions[BRW_PARAM_REGION_STATE].size =
+         4 * prog->Parameters->NumParameters;
+   }
+
+   regions[BRW_PARAM_REGION_IMAGE].base =
+      (const union gl_constant_value *) image_param;
+   regions[BRW_PARAM_REGION_IMAGE].size =
+      nr_image_params * sizeof(*image_param) / sizeof(union gl_constant_value);
+
+   regions[BRW_PARAM_REGION_CLIP_PLANE].base =
+      (const union gl_constant_value *) brw_select_clip_planes(&brw->ctx);
+   regions[BRW_PARAM_REGION_CLIP_PLANE].size = MAX_CLIP_PLANES * 4;
+}
+
+static uint32_t
+encode_param(const struct param_region *regions,
+             const union gl_constant_value *param)
+{
+   if (param == NULL)
+      return 0;
+
+   for (unsigned r = BRW_PARAM_REGION_ZERO; r < BRW_PARAM_NUM_REGIONS; r++) {
+      if (regions[r].base == NULL ||
+          param < regions[r].base ||
+          param >= regions[r].base + regions[r].size)
+         continue;
+
+      uint32_t index = param - regions[r].base;
+      if (index > BRW_PARAM_INDEX_MASK)
+         return BRW_PARAM_INVALID;
+
+      return r << BRW_PARAM_REGION_SHIFT | index;
+   }
+
+   return BRW_PARAM_INVALID;
+}
+
+static bool
+decode_param(const struct param_region *regions, uint32_t value,
+             const union gl_constant_value **param)
+{
+   const unsigned r = value >> BRW_PARAM_REGION_SHIFT;
+   const unsigned index = value & BRW_PARAM_INDEX_MASK;
+
+   if (value == 0) {
+      *param = NULL;
+      return true;
+   }
+
+   if (r < BRW_PARAM_REGION_ZERO || r >= BRW_PARAM_NUM_REGIONS ||
+       regions[r].base == NULL || index >= regions[r].size)
+      return false;
+
+   *param = regions[r].base + index;
+   return true;
+}
+
+/**
+ * Computes the disk cache key of a program compiled with the given stage
+ * key, or returns false if the program can't go through the disk cache.
+ *
+ * The program_string_id field of the stage key is only meaningful within
+ * this process, so it is left out of the key.
+ */
+bool
+brw_disk_cache_key(struct brw_context *brw,
+                   const struct gl_shader_program *shader_prog,
+                   gl_shader_stage stage,
+                   const void *key, unsigned key_size,
+                   unsigned program_string_id_offset,
+                   cache_key out_key)
+{
+   static const char tag[] = "i965 program";
+
+   if (brw->ctx.Cache == NULL || shader_prog == NULL ||
+       (INTEL_DEBUG & DEBUG_DISK_CACHE_BYPASS))
+      return false;
+
+   uint8_t *stage_key = malloc(key_size);
+   if (stage_key == NULL)
+      return false;
+
+   memcpy(stage_key, key, key_size);
+   memset(stage_key + program_string_id_offset, 0, sizeof(unsigned));
+
+   struct mesa_sha1 *sha1_ctx = _mesa_sha1_init();
+   _mesa_sha1_update(sha1_ctx, tag, sizeof(tag));
+   _mesa_sha1_update(sha1_ctx, shader_prog->sha1, sizeof(shader_prog->sha1));
+   _mesa_sha1_update(sha1_ctx, &stage, sizeof(stage));
+   _mesa_sha1_update(sha1_ctx, &brw->screen->devinfo,
+                     sizeof(brw->screen->devinfo));
+   _mesa_sha1_update(sha1_ctx, &INTEL_DEBUG, sizeof(INTEL_DEBUG));
+   _mesa_sha1_update(sha1_ctx, stage_key, key_size);
+   _mesa_sha1_final(sha1_ctx, out_key);
+
+   free(stage_key);
+
+   return true;
+}
+
+/**
+ * Looks up the program stored under \p key.
+ *
+ * On success, \p prog_data is filled in with freshly allocated param arrays
+ * and the program is returned, allocated out of \p mem_ctx.  On failure,
+ * NULL is returned and \p prog_data is left cleared.
+ */
+const unsigned *
+brw_disk_cache_read_program(struct brw_context *brw, cache_key key,
+                            const struct gl_shader_program *shader_prog,
+                            const struct gl_program *prog,
+                            struct brw_stage_prog_data *prog_data,
+                            unsigned prog_data_size,
+                            void *mem_ctx, unsigned *program_size)
+{
+   const union gl_constant_value **param = NULL;
+   const union gl_constant_value **pull_param = NULL;
+   struct brw_image_param *image_param = NULL;
+   unsigned *program = NULL;
+
+   size_t size;
+   uint8_t *buffer = disk_cache_get(brw->ctx.Cache, key, &size);
+   if (buffer == NULL)
+      return NULL;
+
+   struct blob_reader blob;
+   blob_reader_init(&blob, buffer, size);
+
+   if (blob_read_uint32(&blob) != prog_data_size)
+      goto fail;
+   blob_copy_bytes(&blob, (uint8_t *) prog_data, prog_data_size);
+
+   *program_size = blob_read_uint32(&blob);
+   const void *data = blob_read_bytes(&blob, *program_size);
+   if (blob.overrun ||
+       (uint64_t) (prog_data->nr_params + prog_data->nr_pull_params) *
+       sizeof(uint32_t) > (uint64_t) (blob.end - blob.current))
+      goto fail;
+
+   param = rzalloc_array(NULL, const union gl_constant_value *,
+                         prog_data->nr_params);
+   pull_param = rzalloc_array(NULL, const union gl_constant_value *,
+                              prog_data->nr_pull_params);
+   image_param = rzalloc_array(NULL, struct brw_image_param,
+                               prog_data->nr_image_params);
+   if (!param || !pull_param || !image_param)
+      goto fail;
+
+   struct param_region regions[BRW_PARAM_NUM_REGIONS];
+   setup_param_regions(brw, shader_prog, prog, image_param,
+                       prog_data->nr_image_params, regions);
+
+   for (unsigned i = 0; i < prog_data->nr_params; i++) {
+      if (!decode_param(regions, blob_read_uint32(&blob), &param[i]))
+         goto fail;
+   }
+
+   for (unsigned i = 0; i < prog_data->nr_pull_params; i++) {
+      if (!decode_param(regions, blob_read_uint32(&blob), &pull_param[i]))
+         goto fail;
+   }
+
+   if (blob.overrun || blob.current != blob.end)
+      goto fail;
+
+   program = ralloc_size(mem_ctx, *program_size);
+   if (program == NULL)
+      goto fail;
+   memcpy(program, data, *program_size);
+
+   prog_data->param = param;
+   prog_data->pull_param = pull_param;
+   prog_data->image_param = image_param;
+
+   free(buffer);
+   return program;
+
+fail:
+   ralloc_free(param);
+   ralloc_free(pull_param);
+   ralloc_free(image_param);
+   memset(prog_data, 0, prog_data_size);
+   free(buffer);
+   return NULL;
+}
+
+struct brw_disk_cache_job {
+   struct util_queue_fence fence;
+   struct disk_cache *cache;
+   cache_key key;
+   struct blob *blob;
+};
+
+static void
+write_job(void *data, int thread_index)
+{
+   struct brw_disk_cache_job *job = data;
+
+   disk_cache_put(job->cache, job->key, job->blob->data, job->blob->size);
+}
+
+static void
+free_job(void *data, int thread_index)
+{
+   struct brw_disk_cache_job *job = data;
+
+   util_queue_fence_destroy(&job->fence);
+   ralloc_free(job);
+}
+
+static void
+flush_job(void *data, int thread_index)
+{
+}
+
+/**
+ * Stores a freshly compiled program under \p key.
+ *
+ * The data is serialized right away, since the param arrays are about to be
+ * handed to the program cache, but the disk write itself is left to the
+ * context's disk cache thread when there is one.
+ */
+void
+brw_disk_cache_write_program(struct brw_context *brw, cache_key key,
+                             const struct gl_shader_program *shader_prog,
+                             const struct gl_program *prog,
+                             const unsigned *program, unsigned program_size,
+                             const struct brw_stage_prog_data *prog_data,
+                             unsigned prog_data_size)
+{
+   struct brw_disk_cache_job *job = rzalloc(NULL, struct brw_disk_cache_job);
+   if (job == NULL)
+      return;
+
+   job->cache = brw->ctx.Cache;
+   memcpy(job->key, key, sizeof(cache_key));
+   job->blob = blob_create(job);
+   if (job->blob == NULL)
+      goto fail;
+
+   blob_write_uint32(job->blob, prog_data_size);
+   blob_write_bytes(job->blob, prog_data, prog_data_size);
+   blob_write_uint32(job->blob, program_size);
+   blob_write_bytes(job->blob, program, program_size);
+
+   struct param_region regions[BRW_PARAM_NUM_REGIONS];
+   setup_param_regions(brw, shader_prog, prog, prog_data->image_param,
+                       prog_data->nr_image_params, regions);
+
+   for (unsigned i = 0; i < prog_data->nr_params; i++) {
+      uint32_t value = encode_param(regions, prog_data->param[i]);
+      if (value == BRW_PARAM_INVALID)
+         goto fail;
+      blob_write_uint32(job->blob, value);
+   }
+
+   for (unsigned i = 0; i < prog_data->nr_pull_params; i++) {
+      uint32_t value = encode_param(regions, prog_data->pull_param[i]);
+      if (value == BRW_PARAM_INVALID)
+         goto fail;
+      blob_write_uint32(job->blob, value);
+   }
+
+   if (!util_queue_is_initialized(&brw->disk_cache_queue)) {
+      write_job(job, 0);
+      goto fail;
+   }
+
+   util_queue_fence_init(&job->fence);
+   util_queue_add_job(&brw->disk_cache_queue, job, &job->fence,
+                      write_job, free_job);
+   return;
+
+fail:
+   ralloc_free(job);
+}
+
+void
+brw_disk_cache_init(struct brw_context *brw)
+{
+   if (brw->ctx.Cache == NULL)
+      return;
+
+   /* Without a thread, writes just happen synchronously. */
+   util_queue_init(&brw->disk_cache_queue, "i965_disk_cache", 32, 1);
+}
+
+void
+brw_disk_cache_finish(struct brw_context *brw)
+{
+   if (!util_queue_is_initialized(&brw->disk_cache_queue))
+      return;
+
+   /* There is a single thread, so once this job has run, every write queued
+    * before it has completed too.
+    */
+   struct util_queue_fence fence;
+   util_queue_fence_init(&fence);
+   util_queue_add_job(&brw->disk_cache_queue, brw, &fence, flush_job, NULL);
+   util_queue_job_wait(&fence);
+   util_queue_fence_destroy(&fence);
+
+   util_queue_destroy(&brw->disk_cache_queue);
+}
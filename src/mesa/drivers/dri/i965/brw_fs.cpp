@@ -41,6 +41,7 @@
 #include "compiler/glsl_types.h"
 #include "compiler/nir/nir_builder.h"
 #include "program/prog_parameter.h"
+#include "c11/threads.h"
 
 using namespace brw;
 
@@ -5645,6 +5646,9 @@ fs_visitor::optimize()
    assign_constant_locations();
    lower_constant_loads();
 
+   if (constants_assigned_cb)
+      constants_assigned_cb(this, constants_assigned_data);
+
    validate();
 
    split_virtual_grfs();
@@ -5797,7 +5801,7 @@ fs_visitor::allocate_registers(bool allow_spilling)
    bool allocated_without_spills;
 
    static const enum instruction_scheduler_mode pre_modes[] = {
-      SCHEDULE_PRE,
+      SCHEDULE_PRE_ADAPTIVE,
       SCHEDULE_PRE_NON_LIFO,
       SCHEDULE_PRE_LIFO,
    };
@@ -6411,6 +6415,102 @@ demote_sample_qualifiers(nir_shader *nir)
    }
 }
 
+/**
+ * State of the SIMD16 compile of a fragment shader.
+ *
+ * It only depends on the SIMD8 compile for the uniform layout, so it is
+ * started as soon as that is known and, when possible, runs on a helper
+ * thread while the SIMD8 compile goes on with optimization and register
+ * allocation.  To keep the two from racing, the SIMD16 visitor gets its own
+ * ralloc context and its own copy of the prog_data.  Both compiles derive
+ * identical prog_data contents from the same shader and key, except for
+ * scratch space which SIMD16 never uses as it doesn't spill, so that copy
+ * is simply dropped at the end.
+ */
+struct fs_simd16_compile {
+   const struct brw_compiler *compiler;
+   void *log_data;
+   const struct brw_wm_prog_key *key;
+   struct gl_program *prog;
+   const nir_shader *shader;
+   int shader_time_index;
+   bool allow_spilling;
+   bool use_rep_send;
+
+   fs_visitor *v8;
+   void *mem_ctx;
+   struct brw_wm_prog_data prog_data;
+
+   bool started;
+   bool threaded;
+   thrd_t thread;
+
+   /* Results */
+   cfg_t *cfg;
+   uint8_t grf_start;
+   unsigned grf_used;
+   char *fail_msg;
+};
+
+static int
+run_simd16_compile(void *data)
+{
+   struct fs_simd16_compile *c = (struct fs_simd16_compile *) data;
+
+   fs_visitor v16(c->compiler, c->log_data, c->mem_ctx, c->key,
+                  &c->prog_data.base, c->prog, c->shader, 16,
+                  c->shader_time_index);
+   v16.import_uniforms(c->v8);
+   if (!v16.run_fs(c->allow_spilling, c->use_rep_send)) {
+      c->fail_msg = v16.fail_msg;
+   } else {
+      c->cfg = v16.cfg;
+      c->grf_start = v16.payload.num_regs;
+      c->grf_used = v16.grf_used;
+   }
+
+   return 0;
+}
+
+static void
+start_simd16_compile(fs_visitor *v8, void *data)
+{
+   struct fs_simd16_compile *c = (struct fs_simd16_compile *) data;
+
+   if (v8->max_dispatch_width < 16 ||
+       unlikely((INTEL_DEBUG & DEBUG_NO16) && !c->use_rep_send))
+      return;
+
+   c->v8 = v8;
+   c->prog_data = *brw_wm_prog_data(v8->prog_data);
+   c->mem_ctx = ralloc_context(NULL);
+   c->started = true;
+
+   /* Keep the debug output of the two compiles apart. */
+   if (likely(!(INTEL_DEBUG & (DEBUG_WM | DEBUG_OPTIMIZER)))) {
+      c->threaded = thrd_create(&c->thread, run_simd16_compile, c) ==
+                    thrd_success;
+   }
+}
+
+/**
+ * Waits for the SIMD16 compile started by start_simd16_compile(), or runs
+ * it now if it couldn't be moved to another thread.
+ */
+static void
+finish_simd16_compile(struct fs_simd16_compile *c, void *mem_ctx)
+{
+   if (!c->started)
+      return;
+
+   if (c->threaded)
+      thrd_join(c->thread, NULL);
+   else
+      run_simd16_compile(c);
+
+   ralloc_steal(mem_ctx, c->mem_ctx);
+}
+
 const unsigned *
 brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
                void *mem_ctx,
@@ -6462,10 +6562,26 @@ brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
    uint8_t simd8_grf_start = 0, simd16_grf_start = 0;
    unsigned simd8_grf_used = 0, simd16_grf_used = 0;
 
+   /* The SIMD16 compile gets started from within the SIMD8 one. */
+   struct fs_simd16_compile simd16 = {};
+   simd16.compiler = compiler;
+   simd16.log_data = log_data;
+   simd16.key = key;
+   simd16.prog = prog;
+   simd16.shader = shader;
+   simd16.shader_time_index = shader_time_index16;
+   simd16.allow_spilling = allow_spilling;
+   simd16.use_rep_send = use_rep_send;
+
    fs_visitor v8(compiler, log_data, mem_ctx, key,
                  &prog_data->base, prog, shader, 8,
                  shader_time_index8);
-   if (!v8.run_fs(allow_spilling, false /* do_rep_send */)) {
+   v8.constants_assigned_cb = start_simd16_compile;
+   v8.constants_assigned_data = &simd16;
+   bool simd8_success = v8.run_fs(allow_spilling, false /* do_rep_send */);
+   finish_simd16_compile(&simd16, mem_ctx);
+
+   if (!simd8_success) {
       if (error_str)
          *error_str = ralloc_strdup(mem_ctx, v8.fail_msg);
 
@@ -6476,22 +6592,14 @@ brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
       simd8_grf_used = v8.grf_used;
    }
 
-   if (v8.max_dispatch_width >= 16 &&
-       likely(!(INTEL_DEBUG & DEBUG_NO16) || use_rep_send)) {
-      /* Try a SIMD16 compile */
-      fs_visitor v16(compiler, log_data, mem_ctx, key,
-                     &prog_data->base, prog, shader, 16,
-                     shader_time_index16);
-      v16.import_uniforms(&v8);
-      if (!v16.run_fs(allow_spilling, use_rep_send)) {
-         compiler->shader_perf_log(log_data,
-                                   "SIMD16 shader failed to compile: %s",
-                                   v16.fail_msg);
-      } else {
-         simd16_cfg = v16.cfg;
-         simd16_grf_start = v16.payload.num_regs;
-         simd16_grf_used = v16.grf_used;
-      }
+   if (simd16.fail_msg) {
+      compiler->shader_perf_log(log_data,
+                                "SIMD16 shader failed to compile: %s",
+                                simd16.fail_msg);
+   } else if (simd16.cfg) {
+      simd16_cfg = simd16.cfg;
+      simd16_grf_start = simd16.grf_start;
+      simd16_grf_used = simd16.grf_used;
    }
 
    /* When the caller requests a repclear shader, they want SIMD16-only */
@@ -133,6 +133,7 @@ public:
    bool opt_redundant_discard_jumps();
    bool opt_cse();
    bool opt_cse_local(bblock_t *block);
+   bool opt_cse_global();
    bool opt_copy_propagate();
    bool try_copy_propagate(fs_inst *inst, int arg, acp_entry *entry);
    bool try_constant_propagate(fs_inst *inst, acp_entry *entry);
@@ -311,6 +312,15 @@ public:
     */
    int *push_constant_loc;
 
+   /**
+    * Optional hook called by optimize() as soon as the push and pull
+    * constant layout above is final.  That layout is all a wider compile of
+    * the same shader imports from this one, so the wider compile can start
+    * from there.
+    */
+   void (*constants_assigned_cb)(fs_visitor *v, void *data);
+   void *constants_assigned_data;
+
    fs_reg frag_depth;
    fs_reg frag_stencil;
    fs_reg sample_mask;
@@ -26,7 +26,8 @@
 
 /** @file brw_fs_cse.cpp
  *
- * Support for local common subexpression elimination.
+ * Support for common subexpression elimination, within basic blocks and
+ * across them.
  *
  * See Muchnick's Advanced Compiler Design and Implementation, section
  * 13.1 (p378).
@@ -39,6 +40,9 @@ struct aeb_entry : public exec_node {
    /** The instruction that generates the expression value. */
    fs_inst *generator;
 
+   /** The block containing the generator, for global CSE. */
+   bblock_t *block;
+
    /** The temporary where the value is stored. */
    fs_reg tmp;
 };
@@ -362,6 +366,130 @@ fs_visitor::opt_cse_local(bblock_t *block)
    return progress;
 }
 
+/**
+ * Whether \p inst computes a value that can be reused by any instruction in
+ * a block it dominates: its destination is a VGRF written nowhere else, and
+ * so are its sources, unless they're immediates or uniforms.
+ */
+static bool
+is_global_cse_candidate(const fs_visitor *v, const fs_inst *inst,
+                        const unsigned *defs)
+{
+   if (!is_expression(v, inst) || inst->is_partial_write() ||
+       inst->predicate || inst->conditional_mod || inst->mlen ||
+       inst->flags_written() || inst->flags_read(v->devinfo) ||
+       inst->writes_accumulator_implicitly(v->devinfo) ||
+       inst->reads_accumulator_implicitly() ||
+       inst->opcode == SHADER_OPCODE_FIND_LIVE_CHANNEL)
+      return false;
+
+   if (inst->opcode == BRW_OPCODE_MOV &&
+       !(inst->src[0].file == IMM &&
+         inst->src[0].type == BRW_REGISTER_TYPE_VF))
+      return false;
+
+   if (inst->dst.file != VGRF || inst->dst.offset != 0 ||
+       defs[inst->dst.nr] != 1)
+      return false;
+
+   for (int i = 0; i < inst->sources; i++) {
+      switch (inst->src[i].file) {
+      case IMM:
+      case UNIFORM:
+         break;
+      case VGRF:
+         if (defs[inst->src[i].nr] != 1)
+            return false;
+         break;
+      default:
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static bool
+block_dominates(bblock_t *a, bblock_t *b)
+{
+   while (b != a) {
+      if (b->idom == NULL || b->idom == b)
+         return false;
+      b = b->idom;
+   }
+   return true;
+}
+
+/**
+ * Eliminates expressions already computed in a dominating block.
+ *
+ * This is deliberately conservative: only instructions outside of loops are
+ * considered, and all the registers involved must be written exactly once,
+ * so that the value of the earlier expression can't have changed by the
+ * time the later one runs.  Channels enabled for the later instruction are
+ * then a subset of the ones that were enabled for the earlier one.
+ */
+bool
+fs_visitor::opt_cse_global()
+{
+   bool progress = false;
+   exec_list aeb;
+   void *cse_ctx = ralloc_context(NULL);
+   unsigned *defs = rzalloc_array(cse_ctx, unsigned, alloc.count);
+   int loop_depth = 0;
+
+   foreach_block_and_inst(block, fs_inst, inst, cfg) {
+      if (inst->dst.file == VGRF)
+         defs[inst->dst.nr]++;
+   }
+
+   if (cfg->idom_dirty)
+      cfg->calculate_idom();
+
+   foreach_block_and_inst_safe(block, fs_inst, inst, cfg) {
+      if (inst->opcode == BRW_OPCODE_DO) {
+         loop_depth++;
+         continue;
+      } else if (inst->opcode == BRW_OPCODE_WHILE) {
+         loop_depth--;
+         continue;
+      }
+
+      if (loop_depth > 0 || !is_global_cse_candidate(this, inst, defs))
+         continue;
+
+      aeb_entry *found = NULL;
+      bool negate = false;
+
+      foreach_in_list(aeb_entry, entry, &aeb) {
+         if (instructions_match(inst, entry->generator, &negate) &&
+             block_dominates(entry->block, block)) {
+            found = entry;
+            break;
+         }
+      }
+
+      if (found) {
+         assert(inst->size_written == found->generator->size_written);
+         const fs_builder ibld(this, block, inst);
+
+         create_copy_instr(ibld, inst, found->generator->dst, negate);
+         inst->remove(block);
+         progress = true;
+      } else {
+         aeb_entry *entry = ralloc(cse_ctx, aeb_entry);
+         entry->generator = inst;
+         entry->block = block;
+         entry->tmp = reg_undef;
+         aeb.push_tail(entry);
+      }
+   }
+
+   ralloc_free(cse_ctx);
+
+   return progress;
+}
+
 bool
 fs_visitor::opt_cse()
 {
@@ -373,6 +501,8 @@ fs_visitor::opt_cse()
       progress = opt_cse_local(block) || progress;
    }
 
+   progress = opt_cse_global() || progress;
+
    if (progress)
       invalidate_live_intervals();
 
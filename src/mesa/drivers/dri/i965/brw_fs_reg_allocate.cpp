@@ -493,6 +493,80 @@ get_used_mrfs(fs_visitor *v, bool *mrf_used)
    }
 }
 
+struct vgrf_interval {
+   int start;
+   int end;
+   unsigned nr;
+};
+
+static int
+compare_vgrf_interval_start(const void *a, const void *b)
+{
+   return ((const struct vgrf_interval *) a)->start -
+          ((const struct vgrf_interval *) b)->start;
+}
+
+/**
+ * Sets up interference between virtual GRFs whose live intervals overlap.
+ *
+ * Rather than testing every pair, sweep over the intervals in order of
+ * their start.  Only intervals which haven't ended by the time the current
+ * one starts can overlap it, and those are typically few compared to the
+ * number of virtual GRFs.
+ */
+static void
+setup_vgrf_interference(fs_visitor *v, struct ra_graph *g)
+{
+   struct vgrf_interval *intervals =
+      ralloc_array(NULL, struct vgrf_interval, v->alloc.count);
+   unsigned num_intervals = 0;
+
+   for (unsigned i = 0; i < v->alloc.count; i++) {
+      /* Registers which are never live don't interfere with anything. */
+      if (v->virtual_grf_end[i] < v->virtual_grf_start[i])
+         continue;
+
+      intervals[num_intervals].start = v->virtual_grf_start[i];
+      intervals[num_intervals].end = v->virtual_grf_end[i];
+      intervals[num_intervals].nr = i;
+      num_intervals++;
+   }
+
+   qsort(intervals, num_intervals, sizeof(*intervals),
+         compare_vgrf_interval_start);
+
+   unsigned *active = ralloc_array(intervals, unsigned, num_intervals);
+   unsigned num_active = 0;
+
+   for (unsigned i = 0; i < num_intervals; i++) {
+      const struct vgrf_interval *cur = &intervals[i];
+      unsigned num_still_active = 0;
+
+      for (unsigned j = 0; j < num_active; j++) {
+         const struct vgrf_interval *other = &intervals[active[j]];
+
+         /* The remaining intervals start no earlier than this one, so they
+          * can't overlap other either.
+          */
+         if (other->end <= cur->start)
+            continue;
+
+         active[num_still_active++] = active[j];
+
+         /* Intervals starting at the same instruction may still not
+          * overlap, so check the same way the pairwise test did.
+          */
+         if (v->virtual_grf_interferes(cur->nr, other->nr))
+            ra_add_node_interference(g, cur->nr, other->nr);
+      }
+
+      active[num_still_active++] = i;
+      num_active = num_still_active;
+   }
+
+   ralloc_free(intervals);
+}
+
 /**
  * Sets interference between virtual GRFs and usage of the high GRFs for SEND
  * messages (treated as MRFs in code generation).
@@ -575,14 +649,10 @@ fs_visitor::assign_regs(bool allow_spilling, bool spill_all)
       }
 
       ra_set_node_class(g, i, c);
-
-      for (unsigned j = 0; j < i; j++) {
-	 if (virtual_grf_interferes(i, j)) {
-	    ra_add_node_interference(g, i, j);
-	 }
-      }
    }
 
+   setup_vgrf_interference(this, g);
+
    /* Certain instructions can't safely use the same register for their
     * sources and destination.  Add interference.
     */
@@ -933,6 +933,8 @@ fs_visitor::init()
    this->last_scratch = 0;
    this->pull_constant_loc = NULL;
    this->push_constant_loc = NULL;
+   this->constants_assigned_cb = NULL;
+   this->constants_assigned_data = NULL;
 
    this->promoted_constants = 0,
 
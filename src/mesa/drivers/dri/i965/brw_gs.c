@@ -101,11 +101,28 @@ brw_codegen_gs_prog(struct brw_context *brw,
    const struct gen_device_info *devinfo = &brw->screen->devinfo;
    struct brw_stage_state *stage_state = &brw->gs.base;
    struct brw_gs_prog_data prog_data;
+   void *mem_ctx = ralloc_context(NULL);
+   const unsigned *program;
+   unsigned program_size;
    bool start_busy = false;
    double start_time = 0;
 
    memset(&prog_data, 0, sizeof(prog_data));
 
+   cache_key disk_key;
+   const bool use_disk_cache =
+      brw_disk_cache_key(brw, prog, MESA_SHADER_GEOMETRY, key, sizeof(*key),
+                         offsetof(struct brw_gs_prog_key, program_string_id),
+                         disk_key);
+   if (use_disk_cache) {
+      program = brw_disk_cache_read_program(brw, disk_key, prog, &gp->program,
+                                            &prog_data.base.base,
+                                            sizeof(prog_data),
+                                            mem_ctx, &program_size);
+      if (program)
+         goto upload;
+   }
+
    assign_gs_binding_table_offsets(devinfo, prog, &gp->program, &prog_data);
 
    /* Allocate the references to the uniforms that will end up in the
@@ -149,13 +166,10 @@ brw_codegen_gs_prog(struct brw_context *brw,
       start_time = get_time();
    }
 
-   void *mem_ctx = ralloc_context(NULL);
-   unsigned program_size;
    char *error_str;
-   const unsigned *program =
-      brw_compile_gs(brw->screen->compiler, brw, mem_ctx, key,
-                     &prog_data, gs->Program->nir, prog,
-                     st_index, &program_size, &error_str);
+   program = brw_compile_gs(brw->screen->compiler, brw, mem_ctx, key,
+                            &prog_data, gs->Program->nir, prog,
+                            st_index, &program_size, &error_str);
    if (program == NULL) {
       ralloc_strcat(&prog->data->InfoLog, error_str);
       _mesa_problem(NULL, "Failed to compile geometry shader: %s\n", error_str);
@@ -164,6 +178,12 @@ brw_codegen_gs_prog(struct brw_context *brw,
       return false;
    }
 
+   if (use_disk_cache) {
+      brw_disk_cache_write_program(brw, disk_key, prog, &gp->program,
+                                   program, program_size,
+                                   &prog_data.base.base, sizeof(prog_data));
+   }
+
    if (unlikely(brw->perf_debug)) {
       if (bgs->compiled_once) {
          brw_gs_debug_recompile(brw, prog, key);
@@ -175,6 +195,7 @@ brw_codegen_gs_prog(struct brw_context *brw,
       bgs->compiled_once = true;
    }
 
+upload:
    /* Scratch space is used for register spilling */
    brw_alloc_stage_scratch(brw, stage_state,
                            prog_data.base.base.total_scratch,
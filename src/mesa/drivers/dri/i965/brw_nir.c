@@ -415,11 +415,21 @@ nir_optimize(nir_shader *nir, bool is_scalar)
 
       OPT(nir_copy_prop);
       OPT(nir_opt_dce);
+      OPT(nir_opt_licm);
       OPT(nir_opt_cse);
+
+      /* The vec4 backend expects UBO loads not to straddle a vec4 slot,
+       * and GLSL already hands it vector accesses.
+       */
+      if (is_scalar) {
+         OPT(nir_opt_vectorize_io);
+      }
+
       OPT(nir_opt_peephole_select, 0);
       OPT(nir_opt_algebraic);
       OPT(nir_opt_constant_folding);
       OPT(nir_opt_dead_cf);
+      OPT(nir_opt_loop_unroll);
       OPT(nir_opt_remove_phis);
       OPT(nir_opt_undef);
       OPT_V(nir_lower_doubles, nir_lower_drcp |
@@ -25,6 +25,12 @@
 #include "brw_nir.h"
 #include "compiler/glsl/ir_uniform.h"
 
+/**
+ * Shared by every param that only pads a vector out, so that the program
+ * binary cache can recognize such params.
+ */
+const gl_constant_value brw_zero_param = { 0.0 };
+
 static void
 brw_nir_setup_glsl_builtin_uniform(nir_variable *var,
                                    const struct gl_program *prog,
@@ -119,10 +125,8 @@ brw_nir_setup_glsl_uniform(gl_shader_stage stage, nir_variable *var,
 
             if (!is_scalar) {
                /* Pad out with zeros if needed (only needed for vec4) */
-               for (; i < max_vector_size; i++) {
-                  static const gl_constant_value zero = { 0.0 };
-                  stage_prog_data->param[uniform_index++] = &zero;
-               }
+               for (; i < max_vector_size; i++)
+                  stage_prog_data->param[uniform_index++] = &brw_zero_param;
             }
          }
       }
@@ -175,9 +179,7 @@ brw_nir_setup_arb_uniforms(nir_shader *shader, struct gl_program *prog,
       for (i = 0; i < plist->Parameters[p].Size; i++) {
          stage_prog_data->param[4 * p + i] = &plist->ParameterValues[p][i];
       }
-      for (; i < 4; i++) {
-         static const gl_constant_value zero = { 0.0 };
-         stage_prog_data->param[4 * p + i] = &zero;
-      }
+      for (; i < 4; i++)
+         stage_prog_data->param[4 * p + i] = &brw_zero_param;
    }
 }
@@ -37,9 +37,12 @@
 #include "program/program.h"
 #include "program/programopt.h"
 #include "tnl/tnl.h"
+#include "util/disk_cache.h"
+#include "util/mesa-sha1.h"
 #include "util/ralloc.h"
 #include "compiler/glsl/ir.h"
 #include "compiler/glsl/glsl_to_nir.h"
+#include "compiler/nir/nir_serialize.h"
 
 #include "brw_program.h"
 #include "brw_context.h"
@@ -61,6 +64,68 @@ brw_nir_lower_uniforms(nir_shader *nir, bool is_scalar)
    }
 }
 
+/**
+ * The NIR made by brw_create_nir() for a linked program only depends on the
+ * program's shader cache key and on how this driver lowers it.
+ */
+static void
+brw_nir_cache_key(struct brw_context *brw,
+                  const struct gl_shader_program *shader_prog,
+                  gl_shader_stage stage, bool is_scalar, cache_key key)
+{
+   struct mesa_sha1 *sha1_ctx = _mesa_sha1_init();
+   uint32_t gen = brw->gen;
+   uint32_t scalar = is_scalar;
+
+   _mesa_sha1_update(sha1_ctx, shader_prog->sha1, sizeof(shader_prog->sha1));
+   _mesa_sha1_update(sha1_ctx, &stage, sizeof(stage));
+   _mesa_sha1_update(sha1_ctx, &gen, sizeof(gen));
+   _mesa_sha1_update(sha1_ctx, &scalar, sizeof(scalar));
+   _mesa_sha1_final(sha1_ctx, key);
+}
+
+static nir_shader *
+brw_nir_cache_read(struct gl_context *ctx,
+                   const struct gl_shader_program *shader_prog,
+                   gl_shader_stage stage,
+                   const nir_shader_compiler_options *options,
+                   cache_key key)
+{
+   size_t size;
+   uint8_t *buffer = disk_cache_get(ctx->Cache, key, &size);
+   if (buffer == NULL)
+      return NULL;
+
+   struct blob_reader blob;
+   blob_reader_init(&blob, buffer, size);
+   nir_shader *nir = nir_deserialize(NULL, options, &blob);
+   free(buffer);
+
+   if (nir == NULL)
+      return NULL;
+
+   /* Like glsl_to_nir(), keep the shader_info in the gl_program. */
+   struct shader_info *info = &shader_prog->_LinkedShaders[stage]->Program->info;
+   *info = *nir->info;
+   ralloc_free(nir->info);
+   nir->info = info;
+
+   return nir;
+}
+
+static void
+brw_nir_cache_write(struct gl_context *ctx, const nir_shader *nir,
+                    cache_key key)
+{
+   struct blob *blob = blob_create(NULL);
+   if (blob == NULL)
+      return;
+
+   nir_serialize(blob, nir);
+   disk_cache_put(ctx->Cache, key, blob->data, blob->size);
+   ralloc_free(blob);
+}
+
 nir_shader *
 brw_create_nir(struct brw_context *brw,
                const struct gl_shader_program *shader_prog,
@@ -71,9 +136,29 @@ brw_create_nir(struct brw_context *brw,
    struct gl_context *ctx = &brw->ctx;
    const nir_shader_compiler_options *options =
       ctx->Const.ShaderCompilerOptions[stage].NirOptions;
+   static const struct nir_lower_wpos_ytransform_options wpos_options = {
+      .state_tokens = {STATE_INTERNAL, STATE_FB_WPOS_Y_TRANSFORM, 0, 0, 0},
+      .fs_coord_pixel_center_integer = 1,
+      .fs_coord_origin_upper_left = 1,
+   };
+   const bool use_cache = shader_prog && ctx->Cache;
+   cache_key nir_key;
    bool progress;
    nir_shader *nir;
 
+   if (use_cache) {
+      brw_nir_cache_key(brw, shader_prog, stage, is_scalar, nir_key);
+      nir = brw_nir_cache_read(ctx, shader_prog, stage, options, nir_key);
+      if (nir) {
+         /* The only side effect of the passes below on the program. */
+         if (stage == MESA_SHADER_FRAGMENT) {
+            _mesa_add_state_reference(prog->Parameters,
+                                      (gl_state_index *) wpos_options.state_tokens);
+         }
+         return nir;
+      }
+   }
+
    /* First, lower the GLSL IR or Mesa IR to NIR */
    if (shader_prog) {
       nir = glsl_to_nir(shader_prog, stage, options);
@@ -91,11 +176,6 @@ brw_create_nir(struct brw_context *brw,
    nir = brw_preprocess_nir(brw->screen->compiler, nir);
 
    if (stage == MESA_SHADER_FRAGMENT) {
-      static const struct nir_lower_wpos_ytransform_options wpos_options = {
-         .state_tokens = {STATE_INTERNAL, STATE_FB_WPOS_Y_TRANSFORM, 0, 0, 0},
-         .fs_coord_pixel_center_integer = 1,
-         .fs_coord_origin_upper_left = 1,
-      };
       _mesa_add_state_reference(prog->Parameters,
                                 (gl_state_index *) wpos_options.state_tokens);
 
@@ -112,6 +192,9 @@ brw_create_nir(struct brw_context *brw,
       NIR_PASS_V(nir, nir_lower_atomics, shader_prog);
    }
 
+   if (use_cache)
+      brw_nir_cache_write(ctx, nir, nir_key);
+
    return nir;
 }
 
@@ -25,6 +25,7 @@
 #define BRW_PROGRAM_H
 
 #include "brw_compiler.h"
+#include "util/disk_cache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,6 +61,29 @@ brw_stage_prog_data_free(const void *prog_data);
 void
 brw_dump_arb_asm(const char *stage, struct gl_program *prog);
 
+bool brw_disk_cache_key(struct brw_context *brw,
+                        const struct gl_shader_program *shader_prog,
+                        gl_shader_stage stage,
+                        const void *key, unsigned key_size,
+                        unsigned program_string_id_offset,
+                        cache_key out_key);
+const unsigned *
+brw_disk_cache_read_program(struct brw_context *brw, cache_key key,
+                            const struct gl_shader_program *shader_prog,
+                            const struct gl_program *prog,
+                            struct brw_stage_prog_data *prog_data,
+                            unsigned prog_data_size,
+                            void *mem_ctx, unsigned *program_size);
+void
+brw_disk_cache_write_program(struct brw_context *brw, cache_key key,
+                             const struct gl_shader_program *shader_prog,
+                             const struct gl_program *prog,
+                             const unsigned *program, unsigned program_size,
+                             const struct brw_stage_prog_data *prog_data,
+                             unsigned prog_data_size);
+void brw_disk_cache_init(struct brw_context *brw);
+void brw_disk_cache_finish(struct brw_context *brw);
+
 void brw_upload_tcs_prog(struct brw_context *brw);
 void brw_tcs_populate_key(struct brw_context *brw,
                           struct brw_tcs_prog_key *key);
@@ -442,6 +442,9 @@ public:
       this->instructions_to_schedule = 0;
       this->post_reg_alloc = (mode == SCHEDULE_POST);
       this->mode = mode;
+      this->reducing_pressure = false;
+      this->pressure_high = INT_MAX;
+      this->pressure_low = INT_MAX;
       if (!post_reg_alloc) {
          this->reg_pressure_in = rzalloc_array(mem_ctx, int, block_count);
 
@@ -515,6 +518,15 @@ public:
    int hw_reg_count;
    int reg_pressure;
    int block_idx;
+
+   /*
+    * Whether SCHEDULE_PRE_ADAPTIVE has switched to reducing register
+    * pressure in the current block, and the pressures at which it starts
+    * and stops doing so.
+    */
+   bool reducing_pressure;
+   int pressure_high;
+   int pressure_low;
    exec_list instructions;
    backend_shader *bs;
 
@@ -588,6 +600,13 @@ fs_instruction_scheduler::fs_instruction_scheduler(fs_visitor *v,
    : instruction_scheduler(v, grf_count, hw_reg_count, block_count, mode),
      v(v)
 {
+   /* Leave some room for fragmentation in the register file, which large
+    * (e.g. SIMD16 texturing) results make worse.  Then, with some
+    * hysteresis so that we don't keep flipping between heuristics, get
+    * back to scheduling for latency.
+    */
+   pressure_high = v->max_grf * 3 / 4;
+   pressure_low = v->max_grf * 5 / 8;
 }
 
 static bool
@@ -1415,7 +1434,15 @@ fs_instruction_scheduler::choose_instruction_to_schedule()
 {
    schedule_node *chosen = NULL;
 
-   if (mode == SCHEDULE_PRE || mode == SCHEDULE_POST) {
+   if (mode == SCHEDULE_PRE_ADAPTIVE) {
+      if (reg_pressure > pressure_high)
+         reducing_pressure = true;
+      else if (reg_pressure < pressure_low)
+         reducing_pressure = false;
+   }
+
+   if (mode == SCHEDULE_PRE || mode == SCHEDULE_POST ||
+       (mode == SCHEDULE_PRE_ADAPTIVE && !reducing_pressure)) {
       int chosen_time = 0;
 
       /* Of the instructions ready to execute or the closest to being ready,
@@ -1463,7 +1490,7 @@ fs_instruction_scheduler::choose_instruction_to_schedule()
             continue;
          }
 
-         if (mode == SCHEDULE_PRE_LIFO) {
+         if (mode == SCHEDULE_PRE_LIFO || mode == SCHEDULE_PRE_ADAPTIVE) {
             /* Prefer instructions that recently became available for
              * scheduling.  These are the things that are most likely to
              * (eventually) make a variable dead and reduce register pressure.
@@ -1576,6 +1603,7 @@ instruction_scheduler::schedule_instructions(bblock_t *block)
    if (!post_reg_alloc)
       reg_pressure = reg_pressure_in[block->num];
    block_idx = block->num;
+   reducing_pressure = false;
 
    /* Remove non-DAG heads from the list. */
    foreach_in_list_safe(schedule_node, n, &instructions) {
@@ -163,6 +163,12 @@ struct backend_instruction {
 
 enum instruction_scheduler_mode {
    SCHEDULE_PRE,
+   /**
+    * Like SCHEDULE_PRE, but switches to the SCHEDULE_PRE_LIFO heuristics
+    * while the estimated register pressure is close to the register file
+    * size.
+    */
+   SCHEDULE_PRE_ADAPTIVE,
    SCHEDULE_PRE_NON_LIFO,
    SCHEDULE_PRE_LIFO,
    SCHEDULE_POST,
@@ -453,11 +453,26 @@ brw_copy_pipeline_atoms(struct brw_context *brw,
     */
    struct brw_tracked_state *context_atoms =
       (struct brw_tracked_state *) brw_get_pipeline_atoms(brw, pipeline);
+   struct brw_atom_lists *lists = &brw->atom_lists[pipeline];
+
+   memset(lists, 0, sizeof(*lists));
 
    for (int i = 0; i < num_atoms; i++) {
       context_atoms[i] = *atoms[i];
       assert(context_atoms[i].dirty.mesa | context_atoms[i].dirty.brw);
       assert(context_atoms[i].emit);
+
+      /* Bucket the atom under each of the dirty bits it listens to, so that
+       * uploads only have to visit the atoms their dirty bits trigger.
+       */
+      GLbitfield mesa = context_atoms[i].dirty.mesa;
+      while (mesa)
+         BITSET_SET(lists->mesa[u_bit_scan(&mesa)], i);
+
+      uint64_t bits = context_atoms[i].dirty.brw;
+      assert(bits >> BRW_NUM_STATE_BITS == 0);
+      while (bits)
+         BITSET_SET(lists->brw[u_bit_scan64(&bits)], i);
    }
 
    brw->num_atoms[pipeline] = num_atoms;
@@ -760,17 +775,141 @@ merge_ctx_state(struct brw_context *brw,
    state->brw |= brw->ctx.NewDriverState;
 }
 
+/**
+ * Emits atom \p i of \p pipeline, counting the time it took and the batch
+ * and state space it used if INTEL_DEBUG=atoms is set.
+ */
+static inline void
+emit_atom(struct brw_context *brw,
+          enum brw_pipeline pipeline,
+          int i,
+          const struct brw_tracked_state *atom)
+{
+   if (unlikely(INTEL_DEBUG & DEBUG_ATOMS)) {
+      struct brw_atom_stats *stats = &brw->atom_stats[pipeline][i];
+      const drm_intel_bo *bo = brw->batch.bo;
+      const uint32_t used = USED_BATCH(brw->batch);
+      const uint32_t state_offset = brw->batch.state_batch_offset;
+      const double start = get_time();
+
+      atom->emit(brw);
+
+      stats->time += get_time() - start;
+      stats->calls++;
+      /* Nothing sensible can be counted if the atom flushed the batch. */
+      if (brw->batch.bo == bo) {
+         stats->bytes += (USED_BATCH(brw->batch) - used) * 4 +
+                         (state_offset - brw->batch.state_batch_offset);
+      }
+   } else {
+      atom->emit(brw);
+   }
+}
+
 static inline void
 check_and_emit_atom(struct brw_context *brw,
+                    enum brw_pipeline pipeline,
                     struct brw_state_flags *state,
+                    int i,
                     const struct brw_tracked_state *atom)
 {
    if (check_state(state, &atom->dirty)) {
-      atom->emit(brw);
+      emit_atom(brw, pipeline, i, atom);
       merge_ctx_state(brw, state);
    }
 }
 
+/**
+ * Adds the atoms triggered by \p bits to \p pending, leaving out those
+ * before atom \p first, which have already been walked past.
+ */
+static inline void
+add_triggered_atoms(const struct brw_atom_lists *lists,
+                    BITSET_WORD *pending,
+                    const struct brw_state_flags *bits,
+                    int first, int num_atoms)
+{
+   const int first_word = BITSET_BITWORD(first);
+   const int num_words = BITSET_WORDS(num_atoms);
+   const BITSET_WORD first_mask = ~0u << (first % BITSET_WORDBITS);
+
+   GLbitfield mesa = bits->mesa;
+   while (mesa) {
+      const BITSET_WORD *atoms = lists->mesa[u_bit_scan(&mesa)];
+
+      pending[first_word] |= atoms[first_word] & first_mask;
+      for (int w = first_word + 1; w < num_words; w++)
+         pending[w] |= atoms[w];
+   }
+
+   uint64_t brw = bits->brw;
+   while (brw) {
+      const BITSET_WORD *atoms = lists->brw[u_bit_scan64(&brw)];
+
+      pending[first_word] |= atoms[first_word] & first_mask;
+      for (int w = first_word + 1; w < num_words; w++)
+         pending[w] |= atoms[w];
+   }
+}
+
+/**
+ * Emits the atoms of \p pipeline which \p state triggers, in list order.
+ *
+ * This is equivalent to testing every atom in turn, but only visits the
+ * atoms listening to one of the dirty bits.  Bits flagged by an atom while
+ * it is emitted trigger the atoms after it, as they would with a full walk.
+ */
+static void
+emit_triggered_atoms(struct brw_context *brw,
+                     enum brw_pipeline pipeline,
+                     struct brw_state_flags *state)
+{
+   const struct brw_tracked_state *atoms =
+      brw_get_pipeline_atoms(brw, pipeline);
+   const struct brw_atom_lists *lists = &brw->atom_lists[pipeline];
+   const int num_atoms = brw->num_atoms[pipeline];
+   struct brw_state_flags seen = *state;
+   BITSET_DECLARE(pending, BRW_MAX_ATOMS);
+
+   BITSET_ZERO(pending);
+   add_triggered_atoms(lists, pending, state, 0, num_atoms);
+
+   for (int w = 0; w < BITSET_WORDS(num_atoms); w++) {
+      while (pending[w]) {
+         const int i = w * BITSET_WORDBITS + u_bit_scan(&pending[w]);
+         struct brw_state_flags added;
+
+         emit_atom(brw, pipeline, i, &atoms[i]);
+         merge_ctx_state(brw, state);
+
+         added.mesa = state->mesa & ~seen.mesa;
+         added.brw = state->brw & ~seen.brw;
+         if (added.mesa | added.brw) {
+            add_triggered_atoms(lists, pending, &added, i + 1, num_atoms);
+            seen = *state;
+         }
+      }
+   }
+}
+
+static void
+brw_print_atom_stats(struct brw_context *brw, enum brw_pipeline pipeline)
+{
+   const struct brw_tracked_state *atoms =
+      brw_get_pipeline_atoms(brw, pipeline);
+
+   for (int i = 0; i < brw->num_atoms[pipeline]; i++) {
+      const struct brw_atom_stats *stats = &brw->atom_stats[pipeline][i];
+
+      if (stats->calls == 0)
+         continue;
+
+      fprintf(stderr, "atom %2d (%p): %10"PRIu64" calls, %10.3f ms, "
+              "%12"PRIu64" bytes\n", i, atoms[i].emit, stats->calls,
+              stats->time * 1000.0, stats->bytes);
+   }
+}
+
 static inline void
 brw_upload_pipeline_state(struct brw_context *brw,
                           enum brw_pipeline pipeline)
@@ -778,6 +917,7 @@ brw_upload_pipeline_state(struct brw_context *brw,
    struct gl_context *ctx = &brw->ctx;
    int i;
    static int dirty_count = 0;
+   static int atom_stats_count = 0;
    struct brw_state_flags state = brw->state.pipelines[pipeline];
    unsigned int fb_samples = _mesa_geometric_samples(ctx->DrawBuffer);
 
@@ -862,7 +1002,7 @@ brw_upload_pipeline_state(struct brw_context *brw,
 	 const struct brw_tracked_state *atom = &atoms[i];
 	 struct brw_state_flags generated;
 
-         check_and_emit_atom(brw, &state, atom);
+         check_and_emit_atom(brw, pipeline, &state, i, atom);
 
 	 accumulate_state(&examined, &atom->dirty);
 
@@ -876,11 +1016,7 @@ brw_upload_pipeline_state(struct brw_context *brw,
       }
    }
    else {
-      for (i = 0; i < num_atoms; i++) {
-	 const struct brw_tracked_state *atom = &atoms[i];
-
-         check_and_emit_atom(brw, &state, atom);
-      }
+      emit_triggered_atoms(brw, pipeline, &state);
    }
 
    if (unlikely(INTEL_DEBUG & DEBUG_STATE)) {
@@ -894,6 +1030,13 @@ brw_upload_pipeline_state(struct brw_context *brw,
 	 fprintf(stderr, "\n");
       }
    }
+
+   if (unlikely(INTEL_DEBUG & DEBUG_ATOMS)) {
+      if (++atom_stats_count % 1000 == 0) {
+         brw_print_atom_stats(brw, pipeline);
+         fprintf(stderr, "\n");
+      }
+   }
 }
 
 /***********************************************************************
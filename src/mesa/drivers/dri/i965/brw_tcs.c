@@ -179,6 +179,28 @@ brw_codegen_tcs_prog(struct brw_context *brw,
    double start_time = 0;
 
    void *mem_ctx = ralloc_context(NULL);
+   const unsigned *program;
+   unsigned program_size;
+
+   memset(&prog_data, 0, sizeof(prog_data));
+
+   /* The passthrough TCS isn't worth caching. */
+   cache_key disk_key;
+   const bool use_disk_cache = tcp &&
+      brw_disk_cache_key(brw, shader_prog, MESA_SHADER_TESS_CTRL,
+                         key, sizeof(*key),
+                         offsetof(struct brw_tcs_prog_key, program_string_id),
+                         disk_key);
+   if (use_disk_cache) {
+      program = brw_disk_cache_read_program(brw, disk_key, shader_prog,
+                                            &tcp->program,
+                                            &prog_data.base.base,
+                                            sizeof(prog_data),
+                                            mem_ctx, &program_size);
+      if (program)
+         goto upload;
+   }
+
    if (tcp) {
       nir = tcp->program.nir;
    } else {
@@ -191,8 +213,6 @@ brw_codegen_tcs_prog(struct brw_context *brw,
       nir = create_passthrough_tcs(mem_ctx, compiler, options, key);
    }
 
-   memset(&prog_data, 0, sizeof(prog_data));
-
    /* Allocate the references to the uniforms that will end up in the
     * prog_data associated with the compiled program, and which will be freed
     * by the state cache.
@@ -258,11 +278,9 @@ brw_codegen_tcs_prog(struct brw_context *brw,
       start_time = get_time();
    }
 
-   unsigned program_size;
    char *error_str;
-   const unsigned *program =
-      brw_compile_tcs(compiler, brw, mem_ctx, key, &prog_data, nir, st_index,
-                      &program_size, &error_str);
+   program = brw_compile_tcs(compiler, brw, mem_ctx, key, &prog_data, nir,
+                             st_index, &program_size, &error_str);
    if (program == NULL) {
       if (shader_prog) {
          shader_prog->data->LinkStatus = false;
@@ -276,6 +294,12 @@ brw_codegen_tcs_prog(struct brw_context *brw,
       return false;
    }
 
+   if (use_disk_cache) {
+      brw_disk_cache_write_program(brw, disk_key, shader_prog, &tcp->program,
+                                   program, program_size,
+                                   &prog_data.base.base, sizeof(prog_data));
+   }
+
    if (unlikely(brw->perf_debug)) {
       struct gl_linked_shader *tcs = shader_prog ?
          shader_prog->_LinkedShaders[MESA_SHADER_TESS_CTRL] : NULL;
@@ -292,6 +316,7 @@ brw_codegen_tcs_prog(struct brw_context *brw,
       }
    }
 
+upload:
    /* Scratch space is used for register spilling */
    brw_alloc_stage_scratch(brw, stage_state,
                            prog_data.base.base.total_scratch,
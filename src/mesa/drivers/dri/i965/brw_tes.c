@@ -87,11 +87,30 @@ brw_codegen_tes_prog(struct brw_context *brw,
    struct brw_stage_state *stage_state = &brw->tes.base;
    nir_shader *nir = tep->program.nir;
    struct brw_tes_prog_data prog_data;
+   void *mem_ctx = ralloc_context(NULL);
+   const unsigned *program;
+   unsigned program_size;
    bool start_busy = false;
    double start_time = 0;
 
    memset(&prog_data, 0, sizeof(prog_data));
 
+   cache_key disk_key;
+   const bool use_disk_cache =
+      brw_disk_cache_key(brw, shader_prog, MESA_SHADER_TESS_EVAL,
+                         key, sizeof(*key),
+                         offsetof(struct brw_tes_prog_key, program_string_id),
+                         disk_key);
+   if (use_disk_cache) {
+      program = brw_disk_cache_read_program(brw, disk_key, shader_prog,
+                                            &tep->program,
+                                            &prog_data.base.base,
+                                            sizeof(prog_data),
+                                            mem_ctx, &program_size);
+      if (program)
+         goto upload;
+   }
+
    brw_assign_common_binding_table_offsets(MESA_SHADER_TESS_EVAL, devinfo,
                                            shader_prog, &tep->program,
                                            &prog_data.base.base, 0);
@@ -175,12 +194,9 @@ brw_codegen_tes_prog(struct brw_context *brw,
       start_time = get_time();
    }
 
-   void *mem_ctx = ralloc_context(NULL);
-   unsigned program_size;
    char *error_str;
-   const unsigned *program =
-      brw_compile_tes(compiler, brw, mem_ctx, key, &prog_data, nir,
-                      shader_prog, st_index, &program_size, &error_str);
+   program = brw_compile_tes(compiler, brw, mem_ctx, key, &prog_data, nir,
+                             shader_prog, st_index, &program_size, &error_str);
    if (program == NULL) {
       if (shader_prog) {
          shader_prog->data->LinkStatus = false;
@@ -194,6 +210,12 @@ brw_codegen_tes_prog(struct brw_context *brw,
       return false;
    }
 
+   if (use_disk_cache) {
+      brw_disk_cache_write_program(brw, disk_key, shader_prog, &tep->program,
+                                   program, program_size,
+                                   &prog_data.base.base, sizeof(prog_data));
+   }
+
    if (unlikely(brw->perf_debug)) {
       struct gl_linked_shader *tes =
          shader_prog->_LinkedShaders[MESA_SHADER_TESS_EVAL];
@@ -208,6 +230,7 @@ brw_codegen_tes_prog(struct brw_context *brw,
       btes->compiled_once = true;
    }
 
+upload:
    /* Scratch space is used for register spilling */
    brw_alloc_stage_scratch(brw, stage_state,
                            prog_data.base.base.total_scratch,
@@ -106,12 +106,25 @@ brw_codegen_vs_prog(struct brw_context *brw,
 
    memset(&prog_data, 0, sizeof(prog_data));
 
+   mem_ctx = ralloc_context(NULL);
+
+   cache_key disk_key;
+   const bool use_disk_cache =
+      brw_disk_cache_key(brw, prog, MESA_SHADER_VERTEX, key, sizeof(*key),
+                         offsetof(struct brw_vs_prog_key, program_string_id),
+                         disk_key);
+   if (use_disk_cache) {
+      program = brw_disk_cache_read_program(brw, disk_key, prog, &vp->program,
+                                            stage_prog_data, sizeof(prog_data),
+                                            mem_ctx, &program_size);
+      if (program)
+         goto upload;
+   }
+
    /* Use ALT floating point mode for ARB programs so that 0^0 == 1. */
    if (!prog)
       stage_prog_data->use_alt_mode = true;
 
-   mem_ctx = ralloc_context(NULL);
-
    brw_assign_common_binding_table_offsets(MESA_SHADER_VERTEX, devinfo, prog,
                                            &vp->program, &prog_data.base.base,
                                            0);
@@ -204,6 +217,12 @@ brw_codegen_vs_prog(struct brw_context *brw,
       return false;
    }
 
+   if (use_disk_cache) {
+      brw_disk_cache_write_program(brw, disk_key, prog, &vp->program,
+                                   program, program_size,
+                                   stage_prog_data, sizeof(prog_data));
+   }
+
    if (unlikely(brw->perf_debug) && vs) {
       if (vs->compiled_once) {
          brw_vs_debug_recompile(brw, prog, key);
@@ -215,6 +234,7 @@ brw_codegen_vs_prog(struct brw_context *brw,
       vs->compiled_once = true;
    }
 
+upload:
    /* Scratch space is used for register spilling */
    brw_alloc_stage_scratch(brw, &brw->vs.base,
                            prog_data.base.base.total_scratch,
@@ -95,6 +95,19 @@ brw_codegen_wm_prog(struct brw_context *brw,
 
    memset(&prog_data, 0, sizeof(prog_data));
 
+   cache_key disk_key;
+   const bool use_disk_cache =
+      brw_disk_cache_key(brw, prog, MESA_SHADER_FRAGMENT, key, sizeof(*key),
+                         offsetof(struct brw_wm_prog_key, program_string_id),
+                         disk_key);
+   if (use_disk_cache) {
+      program = brw_disk_cache_read_program(brw, disk_key, prog, &fp->program,
+                                            &prog_data.base, sizeof(prog_data),
+                                            mem_ctx, &program_size);
+      if (program)
+         goto upload;
+   }
+
    /* Use ALT floating point mode for ARB programs so that 0^0 == 1. */
    if (!prog)
       prog_data.base.use_alt_mode = true;
@@ -161,6 +174,12 @@ brw_codegen_wm_prog(struct brw_context *brw,
       return false;
    }
 
+   if (use_disk_cache) {
+      brw_disk_cache_write_program(brw, disk_key, prog, &fp->program,
+                                   program, program_size,
+                                   &prog_data.base, sizeof(prog_data));
+   }
+
    if (unlikely(brw->perf_debug) && fs) {
       if (fs->compiled_once)
          brw_wm_debug_recompile(brw, prog, key);
@@ -172,6 +191,7 @@ brw_codegen_wm_prog(struct brw_context *brw,
       }
    }
 
+upload:
    brw_alloc_stage_scratch(brw, &brw->wm.base,
                            prog_data.base.total_scratch,
                            devinfo->max_wm_threads);
@@ -145,9 +145,11 @@ brw_emit_surface_state(struct brw_context *brw,
       if (mt->mcs_buf) {
          assert(mt->mcs_buf->offset == 0);
          aux_bo = mt->mcs_buf->bo;
+         intel_batchbuffer_pin_bo(brw, aux_bo);
          aux_offset = mt->mcs_buf->bo->offset64 + mt->mcs_buf->offset;
       } else {
          aux_bo = mt->hiz_buf->aux_base.bo;
+         intel_batchbuffer_pin_bo(brw, aux_bo);
          aux_offset = mt->hiz_buf->aux_base.bo->offset64;
       }
 
@@ -162,6 +164,7 @@ brw_emit_surface_state(struct brw_context *brw,
                                    brw->isl_dev.ss.align,
                                    surf_index, surf_offset);
 
+   intel_batchbuffer_pin_bo(brw, mt->bo);
    isl_surf_fill_state(&brw->isl_dev, state, .surf = &surf, .view = &view,
                        .address = mt->bo->offset64 + offset,
                        .aux_surf = aux_surf, .aux_usage = aux_usage,
@@ -169,10 +172,9 @@ brw_emit_surface_state(struct brw_context *brw,
                        .mocs = mocs, .clear_color = clear_color,
                        .x_offset_sa = tile_x, .y_offset_sa = tile_y);
 
-   drm_intel_bo_emit_reloc(brw->batch.bo,
+   intel_batchbuffer_reloc(brw, mt->bo,
                            *surf_offset + brw->isl_dev.ss.addr_offset,
-                           mt->bo, offset,
-                           read_domains, write_domains);
+                           read_domains, write_domains, offset);
 
    if (aux_surf) {
       /* On gen7 and prior, the upper 20 bits of surface state DWORD 6 are the
@@ -183,10 +185,9 @@ brw_emit_surface_state(struct brw_context *brw,
        */
       assert((aux_offset & 0xfff) == 0);
       uint32_t *aux_addr = state + brw->isl_dev.ss.aux_addr_offset;
-      drm_intel_bo_emit_reloc(brw->batch.bo,
+      intel_batchbuffer_reloc(brw, aux_bo,
                               *surf_offset + brw->isl_dev.ss.aux_addr_offset,
-                              aux_bo, *aux_addr & 0xfff,
-                              read_domains, write_domains);
+                              read_domains, write_domains, *aux_addr & 0xfff);
    }
 }
 
@@ -659,6 +660,9 @@ brw_emit_buffer_surface_state(struct brw_context *brw,
                                   brw->isl_dev.ss.align,
                                   out_offset);
 
+   if (bo)
+      intel_batchbuffer_pin_bo(brw, bo);
+
    isl_buffer_fill_state(&brw->isl_dev, dw,
                          .address = (bo ? bo->offset64 : 0) + buffer_offset,
                          .size = buffer_size,
@@ -667,11 +671,11 @@ brw_emit_buffer_surface_state(struct brw_context *brw,
                          .mocs = tex_mocs[brw->gen]);
 
    if (bo) {
-      drm_intel_bo_emit_reloc(brw->batch.bo,
+      intel_batchbuffer_reloc(brw, bo,
                               *out_offset + brw->isl_dev.ss.addr_offset,
-                              bo, buffer_offset,
                               I915_GEM_DOMAIN_SAMPLER,
-                              (rw ? I915_GEM_DOMAIN_SAMPLER : 0));
+                              (rw ? I915_GEM_DOMAIN_SAMPLER : 0),
+                              buffer_offset);
    }
 }
 
@@ -73,13 +73,11 @@ blorp_surface_reloc(struct blorp_batch *batch, uint32_t ss_offset,
 {
    assert(batch->blorp->driver_ctx == batch->driver_batch);
    struct brw_context *brw = batch->driver_batch;
-   drm_intel_bo *bo = address.buffer;
 
-   drm_intel_bo_emit_reloc(brw->batch.bo, ss_offset,
-                           bo, address.offset + delta,
-                           address.read_domains, address.write_domain);
-
-   uint64_t reloc_val = bo->offset64 + address.offset + delta;
+   uint64_t reloc_val =
+      intel_batchbuffer_reloc64(brw, address.buffer, ss_offset,
+                                address.read_domains, address.write_domain,
+                                address.offset + delta);
    void *reloc_ptr = (void *)brw->batch.map + ss_offset;
 #if GEN_GEN >= 8
    *(uint64_t *)reloc_ptr = reloc_val;
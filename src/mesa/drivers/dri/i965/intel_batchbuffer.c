@@ -31,6 +31,8 @@
 #include "brw_context.h"
 #include "brw_defines.h"
 #include "brw_state.h"
+#include "util/hash_table.h"
+#include "util/set.h"
 
 #include <xf86drm.h>
 #include <i915_drm.h>
@@ -41,6 +43,11 @@ intel_batchbuffer_reset(struct brw_context *brw);
 void
 intel_batchbuffer_init(struct brw_context *brw)
 {
+   if (brw->screen->has_softpin) {
+      brw->batch.softpin_targets = _mesa_set_create(brw, _mesa_hash_pointer,
+                                                    _mesa_key_pointer_equal);
+   }
+
    intel_batchbuffer_reset(brw);
 
    if (!brw->has_llc) {
@@ -63,6 +70,18 @@ intel_batchbuffer_reset(struct brw_context *brw)
 
    brw->batch.bo = drm_intel_bo_alloc(brw->bufmgr, "batchbuffer",
 					BATCH_SZ, 4096);
+
+   if (brw->batch.softpin_targets) {
+      struct set_entry *entry;
+
+      set_foreach(brw->batch.softpin_targets, entry) {
+         _mesa_set_remove(brw->batch.softpin_targets, entry);
+      }
+
+      brw->batch.all_pinned = intel_vma_pin_bo(&brw->screen->vma,
+                                               brw->batch.bo);
+   }
+
    if (brw->has_llc) {
       drm_intel_bo_map(brw->batch.bo, true);
       brw->batch.map = brw->batch.bo->virtual;
@@ -93,6 +112,19 @@ intel_batchbuffer_reset_to_saved(struct brw_context *brw)
 {
    drm_intel_gem_bo_clear_relocs(brw->batch.bo, brw->batch.saved.reloc_count);
 
+   /* Clearing the relocations drops all of the softpin targets too, along
+    * with those added before the state was saved.  Put them back; the ones
+    * added since are merely unused.
+    */
+   if (brw->batch.softpin_targets) {
+      struct set_entry *entry;
+
+      set_foreach(brw->batch.softpin_targets, entry) {
+         drm_intel_bo_add_softpin_target(brw->batch.bo,
+                                         (drm_intel_bo *) entry->key);
+      }
+   }
+
    brw->batch.map_next = brw->batch.saved.map_next;
    if (USED_BATCH(brw->batch) == 0)
       brw->batch.ring = UNKNOWN_RING;
@@ -316,6 +348,10 @@ throttle(struct brw_context *brw)
 #define I915_EXEC_RESOURCE_STREAMER (1<<15)
 #endif
 
+#ifndef I915_EXEC_NO_RELOC
+#define I915_EXEC_NO_RELOC (1<<11)
+#endif
+
 /* TODO: Push this whole function into bufmgr.
  */
 static int
@@ -347,6 +383,8 @@ do_flush_locked(struct brw_context *brw)
       }
       if (batch->needs_sol_reset)
 	 flags |= I915_EXEC_GEN7_SOL_RESET;
+      if (batch->softpin_targets && batch->all_pinned)
+         flags |= I915_EXEC_NO_RELOC;
 
       if (ret == 0) {
          if (unlikely(INTEL_DEBUG & DEBUG_AUB))
@@ -436,21 +474,64 @@ _intel_batchbuffer_flush(struct brw_context *brw,
 }
 
 
+/**
+ * Gives \p bo its fixed address when running with softpin, so that the
+ * caller can write bo->offset64 into state before adding the reference with
+ * intel_batchbuffer_reloc().
+ */
+void
+intel_batchbuffer_pin_bo(struct brw_context *brw, drm_intel_bo *bo)
+{
+   if (brw->batch.softpin_targets &&
+       !intel_vma_pin_bo(&brw->screen->vma, bo))
+      brw->batch.all_pinned = false;
+}
+
 /*  This is the only way buffers get added to the validate list.
  */
-uint32_t
-intel_batchbuffer_reloc(struct brw_context *brw,
-                        drm_intel_bo *buffer, uint32_t offset,
-                        uint32_t read_domains, uint32_t write_domain,
-                        uint32_t delta)
+static void
+emit_reloc(struct brw_context *brw,
+           drm_intel_bo *buffer, uint32_t offset,
+           uint32_t read_domains, uint32_t write_domain,
+           uint32_t delta)
 {
+   struct intel_batchbuffer *batch = &brw->batch;
    int ret;
 
-   ret = drm_intel_bo_emit_reloc(brw->batch.bo, offset,
+   if (batch->softpin_targets &&
+       intel_vma_pin_bo(&brw->screen->vma, buffer)) {
+      /* The address is final, so a buffer which is only read just needs to
+       * be on the validate list.  Writes still go through a relocation, as
+       * that is how the kernel learns about them for implicit fencing, and
+       * the batch can't list itself as a target.
+       */
+      if (write_domain == 0 && buffer != batch->bo) {
+         if (!_mesa_set_search(batch->softpin_targets, buffer)) {
+            _mesa_set_add(batch->softpin_targets, buffer);
+            ret = drm_intel_bo_add_softpin_target(batch->bo, buffer);
+            assert(ret == 0);
+            (void)ret;
+         }
+         return;
+      }
+   } else {
+      batch->all_pinned = false;
+   }
+
+   ret = drm_intel_bo_emit_reloc(batch->bo, offset,
 				 buffer, delta,
 				 read_domains, write_domain);
    assert(ret == 0);
    (void)ret;
+}
+
+uint32_t
+intel_batchbuffer_reloc(struct brw_context *brw,
+                        drm_intel_bo *buffer, uint32_t offset,
+                        uint32_t read_domains, uint32_t write_domain,
+                        uint32_t delta)
+{
+   emit_reloc(brw, buffer, offset, read_domains, write_domain, delta);
 
    /* Using the old buffer offset, write in what the right data would be, in
     * case the buffer doesn't move and we can short-circuit the relocation
@@ -465,11 +546,7 @@ intel_batchbuffer_reloc64(struct brw_context *brw,
                           uint32_t read_domains, uint32_t write_domain,
                           uint32_t delta)
 {
-   int ret = drm_intel_bo_emit_reloc(brw->batch.bo, offset,
-                                     buffer, delta,
-                                     read_domains, write_domain);
-   assert(ret == 0);
-   (void) ret;
+   emit_reloc(brw, buffer, offset, read_domains, write_domain, delta);
 
    /* Using the old buffer offset, write in what the right data would be, in
     * case the buffer doesn't move and we can short-circuit the relocation
@@ -62,6 +62,7 @@ void intel_batchbuffer_data(struct brw_context *brw,
                             const void *data, GLuint bytes,
                             enum brw_gpu_ring ring);
 
+void intel_batchbuffer_pin_bo(struct brw_context *brw, drm_intel_bo *bo);
 uint32_t intel_batchbuffer_reloc(struct brw_context *brw,
                                  drm_intel_bo *buffer,
                                  uint32_t offset,
@@ -81,6 +81,7 @@ static const struct debug_control debug_control[] = {
    { "l3",          DEBUG_L3 },
    { "do32",        DEBUG_DO32 },
    { "norbc",       DEBUG_NO_RBC },
+   { "atoms",       DEBUG_ATOMS },
    { NULL,    0 }
 };
 
@@ -73,6 +73,7 @@ extern uint64_t INTEL_DEBUG;
 #define DEBUG_L3                  (1ull << 37)
 #define DEBUG_DO32                (1ull << 38)
 #define DEBUG_NO_RBC              (1ull << 39)
+#define DEBUG_ATOMS               (1ull << 40)
 
 #ifdef HAVE_ANDROID_PLATFORM
 #define LOG_TAG "INTEL-MESA"
@@ -192,7 +192,8 @@ intel_readpixels_tiled_memcpy(struct gl_context * ctx,
       dst_pitch, irb->mt->pitch,
       brw->has_swizzling,
       irb->mt->tiling,
-      mem_copy
+      mem_copy,
+      &brw->screen->tiled_memcpy_queue
    );
 
    drm_intel_bo_unmap(bo);
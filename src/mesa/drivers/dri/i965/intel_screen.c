@@ -102,6 +102,7 @@ DRI_CONF_END
 #include "intel_mipmap_tree.h"
 #include "intel_screen.h"
 #include "intel_tex.h"
+#include "intel_tiled_memcpy.h"
 #include "intel_image.h"
 
 #include "brw_context.h"
@@ -1021,7 +1022,12 @@ intelDestroyScreen(__DRIscreen * sPriv)
 {
    struct intel_screen *screen = sPriv->driverPrivate;
 
+   if (util_queue_is_initialized(&screen->tiled_memcpy_queue))
+      util_queue_destroy(&screen->tiled_memcpy_queue);
+
    dri_bufmgr_destroy(screen->bufmgr);
+   if (screen->has_softpin)
+      intel_vma_finish(&screen->vma);
    driDestroyOptionInfo(&screen->optionCache);
 
    ralloc_free(screen);
@@ -1698,6 +1704,35 @@ __DRIconfig **intelInitScreen2(__DRIscreen *dri_screen)
         intel_get_boolean(screen, I915_PARAM_HAS_RESOURCE_STREAMER);
    }
 
+#ifndef I915_PARAM_HAS_EXEC_SOFTPIN
+#define I915_PARAM_HAS_EXEC_SOFTPIN 37
+#endif
+   /* The kernel only reports softpin when every context gets its own full
+    * PPGTT.  The AUB dumper lays out the GTT itself, so leave placement to
+    * it there.
+    */
+   if (screen->devinfo.gen >= 8 && !screen->no_hw &&
+       !(INTEL_DEBUG & DEBUG_AUB) &&
+       intel_get_boolean(screen, I915_PARAM_HAS_EXEC_SOFTPIN)) {
+      screen->has_softpin = true;
+
+      /* Buffers aren't flagged as supporting 48-bit addresses, so stay below
+       * 4GB.  Skip the first page to keep 0 an invalid address.
+       */
+      intel_vma_init(&screen->vma, 4096, (1ull << 32) - 4096);
+   }
+
+   /* The tiled memcpy paths are only used to map buffers through the CPU
+    * caches, which needs LLC.
+    */
+   const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   if (screen->devinfo.has_llc && num_cpus > 1) {
+      const unsigned num_threads =
+         MIN2(num_cpus, INTEL_TILED_MEMCPY_MAX_THREADS) - 1;
+      util_queue_init(&screen->tiled_memcpy_queue, "i965_tiled_memcpy",
+                      2 * num_threads, num_threads);
+   }
+
    return (const __DRIconfig**) intel_screen_make_configs(dri_screen);
 }
 
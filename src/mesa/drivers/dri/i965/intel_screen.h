@@ -35,6 +35,8 @@
 #include "intel_bufmgr.h"
 #include "common/gen_device_info.h"
 #include "i915_drm.h"
+#include "intel_vma.h"
+#include "util/u_queue.h"
 #include "xmlconfig.h"
 
 struct intel_screen
@@ -70,6 +72,14 @@ struct intel_screen
 
    dri_bufmgr *bufmgr;
 
+   /**
+    * Does the kernel support softpinning buffers at addresses we choose?  If
+    * so, buffers get their GPU address from \c vma and batches are
+    * submitted without relocation processing.
+    */
+   bool has_softpin;
+   struct intel_vma vma;
+
    /**
     * A unique ID for shader programs.
     */
@@ -99,6 +109,13 @@ struct intel_screen
     * Number of EUs reported by the I915_PARAM_EU_TOTAL parameter
     */
    int eu_total;
+
+   /**
+    * Threads that large linear <-> tiled copies are split across, shared by
+    * all contexts.  Only initialized if there is more than one CPU to run
+    * them on.
+    */
+   struct util_queue tiled_memcpy_queue;
 };
 
 extern void intelDestroyContext(__DRIcontext * driContextPriv);
@@ -564,7 +564,8 @@ intel_gettexsubimage_tiled_memcpy(struct gl_context *ctx,
       dst_pitch, image->mt->pitch,
       brw->has_swizzling,
       image->mt->tiling,
-      mem_copy
+      mem_copy,
+      &brw->screen->tiled_memcpy_queue
    );
 
    drm_intel_bo_unmap(bo);
@@ -34,8 +34,10 @@
 #include "main/enums.h"
 #include "drivers/common/meta.h"
 
+#include "brw_blorp.h"
 #include "brw_context.h"
 #include "intel_batchbuffer.h"
+#include "intel_buffer_objects.h"
 #include "intel_tex.h"
 #include "intel_mipmap_tree.h"
 #include "intel_blit.h"
@@ -182,13 +184,100 @@ intel_texsubimage_tiled_memcpy(struct gl_context * ctx,
       image->mt->pitch, src_pitch,
       brw->has_swizzling,
       image->mt->tiling,
-      mem_copy
+      mem_copy,
+      &brw->screen->tiled_memcpy_queue
    );
 
    drm_intel_bo_unmap(bo);
    return true;
 }
 
+/**
+ * \brief Upload path for textures which the GPU is still using.
+ *
+ * Mapping such a texture would wait for the GPU to finish with it.  Instead,
+ * copy the data into the upload buffer, which stays mapped, and have BLORP
+ * copy it into the miptree.  The copy is queued in the batch behind the
+ * rendering that uses the old contents, so the caller doesn't wait on
+ * anything.
+ */
+static bool
+intel_texsubimage_blorp(struct gl_context *ctx,
+                        GLuint dims,
+                        struct gl_texture_image *texImage,
+                        GLint xoffset, GLint yoffset, GLint zoffset,
+                        GLsizei width, GLsizei height, GLsizei depth,
+                        GLenum format, GLenum type,
+                        const GLvoid *pixels,
+                        const struct gl_pixelstore_attrib *packing)
+{
+   struct brw_context *brw = brw_context(ctx);
+   struct intel_texture_image *image = intel_texture_image(texImage);
+   struct intel_mipmap_tree *mt = image->mt;
+   const mesa_format tex_format = texImage->TexFormat;
+
+   if (brw->gen < 6 ||
+       pixels == NULL ||
+       _mesa_is_bufferobj(packing->BufferObj) ||
+       texImage->TexObject->Target == GL_TEXTURE_1D_ARRAY)
+      return false;
+
+   /* Only a simple blit, no scale, bias or other mapping. */
+   if (ctx->_ImageTransferState)
+      return false;
+
+   /* BLORP copies the bits as they are, so the client data has to be laid
+    * out exactly like the texture.
+    */
+   if (mt->format != tex_format ||
+       !_mesa_is_format_color_format(tex_format) ||
+       _mesa_is_format_compressed(tex_format) ||
+       !_mesa_format_matches_format_and_type(tex_format, format, type,
+                                             packing->SwapBytes, NULL))
+      return false;
+
+   const unsigned cpp = _mesa_get_format_bytes(tex_format);
+   const unsigned row_bytes = width * cpp;
+   const unsigned pitch = ALIGN(row_bytes, 64);
+
+   DBG("%s: level=%d offset=(%d,%d,%d) (w,h,d)=(%d,%d,%d) format=%s\n",
+       __func__, texImage->Level, xoffset, yoffset, zoffset,
+       width, height, depth, _mesa_get_format_name(tex_format));
+
+   const unsigned level = texImage->Level + texImage->TexObject->MinLevel;
+   const unsigned layer = texImage->Face + texImage->TexObject->MinLayer;
+
+   for (int z = 0; z < depth; z++) {
+      drm_intel_bo *bo = NULL;
+      uint32_t offset;
+      char *map = intel_upload_space(brw, pitch * height, 64, &bo, &offset);
+
+      for (int y = 0; y < height; y++) {
+         const void *src =
+            _mesa_image_address(dims, packing, pixels, width, height,
+                                format, type, z, y, 0);
+         memcpy(map + y * pitch, src, row_bytes);
+      }
+
+      struct intel_mipmap_tree *src_mt =
+         intel_miptree_create_for_bo(brw, bo, tex_format, offset,
+                                     width, height, 1, pitch, 0);
+      drm_intel_bo_unreference(bo);
+      if (!src_mt) {
+         /* The next path simply writes any slices copied so far again. */
+         return false;
+      }
+
+      brw_blorp_copy_miptrees(brw, src_mt, 0, 0,
+                              mt, level, layer + zoffset + z,
+                              0, 0, xoffset, yoffset, width, height);
+
+      intel_miptree_release(&src_mt);
+   }
+
+   return true;
+}
+
 static void
 intelTexSubImage(struct gl_context * ctx,
                  GLuint dims,
@@ -213,6 +302,15 @@ intelTexSubImage(struct gl_context * ctx,
        _mesa_enum_to_string(format), _mesa_enum_to_string(type),
        texImage->Level, texImage->Width, texImage->Height, texImage->Depth);
 
+   if (tex_busy) {
+      ok = intel_texsubimage_blorp(ctx, dims, texImage,
+                                   xoffset, yoffset, zoffset,
+                                   width, height, depth,
+                                   format, type, pixels, packing);
+      if (ok)
+         return;
+   }
+
    ok = _mesa_meta_pbo_TexSubImage(ctx, dims, texImage,
                                    xoffset, yoffset, zoffset,
                                    width, height, depth, format, type,
@@ -35,6 +35,11 @@
 
 #include "brw_context.h"
 #include "intel_tiled_memcpy.h"
+#include "intel_tiled_memcpy_impl.h"
+
+#ifdef USE_AVX2
+#include "x86/common_x86_asm.h"
+#endif
 
 #if defined(__SSSE3__)
 #include <tmmintrin.h>
@@ -47,109 +52,49 @@
 #define ALIGN_DOWN(a, b) ROUND_DOWN_TO(a, b)
 #define ALIGN_UP(a, b) ALIGN(a, b)
 
-/* Tile dimensions.  Width and span are in bytes, height is in pixels (i.e.
- * unitless).  A "span" is the most number of bytes we can copy from linear
- * to tiled without needing to calculate a new destination address.
- */
-static const uint32_t xtile_width = 512;
-static const uint32_t xtile_height = 8;
-static const uint32_t xtile_span = 64;
-static const uint32_t ytile_width = 128;
-static const uint32_t ytile_height = 32;
-static const uint32_t ytile_span = 16;
-
-static inline uint32_t
-ror(uint32_t n, uint32_t d)
-{
-   return (n >> d) | (n << (32 - d));
-}
-
-static inline uint32_t
-bswap32(uint32_t n)
-{
-#if defined(HAVE___BUILTIN_BSWAP32)
-   return __builtin_bswap32(n);
-#else
-   return (n >> 24) |
-          ((n >> 8) & 0x0000ff00) |
-          ((n << 8) & 0x00ff0000) |
-          (n << 24);
-#endif
-}
-
-/**
- * Copy RGBA to BGRA - swap R and B.
- */
-static inline void *
-rgba8_copy(void *dst, const void *src, size_t bytes)
-{
-   uint32_t *d = dst;
-   uint32_t const *s = src;
-
-   assert(bytes % 4 == 0);
-
-   while (bytes >= 4) {
-      *d = ror(bswap32(*s), 8);
-      d += 1;
-      s += 1;
-      bytes -= 4;
-   }
-   return dst;
-}
-
 #ifdef __SSSE3__
 static const uint8_t rgba8_permutation[16] =
    { 2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15 };
 
-static inline void
-rgba8_copy_16_aligned_dst(void *dst, const void *src)
+static inline __m128i
+rgba8_swizzle_16(__m128i srcreg)
 {
-   _mm_store_si128(dst,
-                   _mm_shuffle_epi8(_mm_loadu_si128(src),
-                                    *(__m128i *)rgba8_permutation));
-}
-
-static inline void
-rgba8_copy_16_aligned_src(void *dst, const void *src)
-{
-   _mm_storeu_si128(dst,
-                    _mm_shuffle_epi8(_mm_load_si128(src),
-                                     *(__m128i *)rgba8_permutation));
+   return _mm_shuffle_epi8(srcreg, *(__m128i *)rgba8_permutation);
 }
 
 #elif defined(__SSE2__)
-static inline void
-rgba8_copy_16_aligned_dst(void *dst, const void *src)
+static inline __m128i
+rgba8_swizzle_16(__m128i srcreg)
 {
-   __m128i srcreg, dstreg, agmask, ag, rb, br;
+   __m128i agmask, ag, rb, br;
 
    agmask = _mm_set1_epi32(0xFF00FF00);
-   srcreg = _mm_loadu_si128((__m128i *)src);
 
    rb = _mm_andnot_si128(agmask, srcreg);
    ag = _mm_and_si128(agmask, srcreg);
    br = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1)),
                             _MM_SHUFFLE(2, 3, 0, 1));
-   dstreg = _mm_or_si128(ag, br);
+   return _mm_or_si128(ag, br);
+}
+#endif
 
-   _mm_store_si128((__m128i *)dst, dstreg);
+#if defined(__SSSE3__) || defined(__SSE2__)
+static inline void
+rgba8_copy_16_aligned_dst(void *dst, const void *src)
+{
+   _mm_store_si128(dst, rgba8_swizzle_16(_mm_loadu_si128(src)));
 }
 
 static inline void
 rgba8_copy_16_aligned_src(void *dst, const void *src)
 {
-   __m128i srcreg, dstreg, agmask, ag, rb, br;
-
-   agmask = _mm_set1_epi32(0xFF00FF00);
-   srcreg = _mm_load_si128((__m128i *)src);
-
-   rb = _mm_andnot_si128(agmask, srcreg);
-   ag = _mm_and_si128(agmask, srcreg);
-   br = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1)),
-                            _MM_SHUFFLE(2, 3, 0, 1));
-   dstreg = _mm_or_si128(ag, br);
+   _mm_storeu_si128(dst, rgba8_swizzle_16(_mm_load_si128(src)));
+}
 
-   _mm_storeu_si128((__m128i *)dst, dstreg);
+static inline void
+rgba8_copy_16_stream_dst(void *dst, const void *src)
+{
+   _mm_stream_si128(dst, rgba8_swizzle_16(_mm_loadu_si128(src)));
 }
 #endif
 
@@ -213,239 +158,57 @@ rgba8_copy_aligned_src(void *dst, const void *src, size_t bytes)
    return dst;
 }
 
-/**
- * Each row from y0 to y1 is copied in three parts: [x0,x1), [x1,x2), [x2,x3).
- * These ranges are in bytes, i.e. pixels * bytes-per-pixel.
- * The first and last ranges must be shorter than a "span" (the longest linear
- * stretch within a tile) and the middle must equal a whole number of spans.
- * Ranges may be empty.  The region copied must land entirely within one tile.
- * 'dst' is the start of the tile and 'src' is the corresponding
- * address to copy from, though copying begins at (x0, y0).
- * To enable swizzling 'swizzle_bit' must be 1<<6, otherwise zero.
- * Swizzling flips bit 6 in the copy destination offset, when certain other
- * bits are set in it.
- */
-typedef void (*tile_copy_fn)(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
-                             uint32_t y0, uint32_t y1,
-                             char *dst, const char *src,
-                             int32_t linear_pitch,
-                             uint32_t swizzle_bit,
-                             mem_copy_fn mem_copy);
 
+#if defined(__SSSE3__) || defined(__SSE2__)
 /**
- * Copy texture data from linear to X tile layout.
- *
- * \copydoc tile_copy_fn
- *
- * The mem_copy parameters allow the user to specify an alternative mem_copy
- * function that, for instance, may do RGBA -> BGRA swizzling.  The first
- * function must handle any memory alignment while the second function must
- * only handle 16-byte alignment in whichever side (source or destination) is
- * tiled.
+ * Copy RGBA to BGRA - swap R and B, with non-temporal stores to the 16-byte
+ * aligned destination.
  */
-static inline void
-linear_to_xtiled(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
-                 uint32_t y0, uint32_t y1,
-                 char *dst, const char *src,
-                 int32_t src_pitch,
-                 uint32_t swizzle_bit,
-                 mem_copy_fn mem_copy,
-                 mem_copy_fn mem_copy_align16)
+static inline void *
+rgba8_copy_stream_dst(void *dst, const void *src, size_t bytes)
 {
-   /* The copy destination offset for each range copied is the sum of
-    * an X offset 'x0' or 'xo' and a Y offset 'yo.'
-    */
-   uint32_t xo, yo;
-
-   src += (ptrdiff_t)y0 * src_pitch;
-
-   for (yo = y0 * xtile_width; yo < y1 * xtile_width; yo += xtile_width) {
-      /* Bits 9 and 10 of the copy destination offset control swizzling.
-       * Only 'yo' contributes to those bits in the total offset,
-       * so calculate 'swizzle' just once per row.
-       * Move bits 9 and 10 three and four places respectively down
-       * to bit 6 and xor them.
-       */
-      uint32_t swizzle = ((yo >> 3) ^ (yo >> 4)) & swizzle_bit;
-
-      mem_copy(dst + ((x0 + yo) ^ swizzle), src + x0, x1 - x0);
-
-      for (xo = x1; xo < x2; xo += xtile_span) {
-         mem_copy_align16(dst + ((xo + yo) ^ swizzle), src + xo, xtile_span);
-      }
-
-      mem_copy_align16(dst + ((xo + yo) ^ swizzle), src + x2, x3 - x2);
+   assert(bytes == 0 || !(((uintptr_t)dst) & 0xf));
 
-      src += src_pitch;
+   if (bytes == 64) {
+      rgba8_copy_16_stream_dst(dst +  0, src +  0);
+      rgba8_copy_16_stream_dst(dst + 16, src + 16);
+      rgba8_copy_16_stream_dst(dst + 32, src + 32);
+      rgba8_copy_16_stream_dst(dst + 48, src + 48);
+      return dst;
    }
-}
-
-/**
- * Copy texture data from linear to Y tile layout.
- *
- * \copydoc tile_copy_fn
- */
-static inline void
-linear_to_ytiled(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
-                 uint32_t y0, uint32_t y1,
-                 char *dst, const char *src,
-                 int32_t src_pitch,
-                 uint32_t swizzle_bit,
-                 mem_copy_fn mem_copy,
-                 mem_copy_fn mem_copy_align16)
-{
-   /* Y tiles consist of columns that are 'ytile_span' wide (and the same height
-    * as the tile).  Thus the destination offset for (x,y) is the sum of:
-    *   (x % column_width)                    // position within column
-    *   (x / column_width) * bytes_per_column // column number * bytes per column
-    *   y * column_width
-    *
-    * The copy destination offset for each range copied is the sum of
-    * an X offset 'xo0' or 'xo' and a Y offset 'yo.'
-    */
-   const uint32_t column_width = ytile_span;
-   const uint32_t bytes_per_column = column_width * ytile_height;
-
-   uint32_t xo0 = (x0 % ytile_span) + (x0 / ytile_span) * bytes_per_column;
-   uint32_t xo1 = (x1 % ytile_span) + (x1 / ytile_span) * bytes_per_column;
 
-   /* Bit 9 of the destination offset control swizzling.
-    * Only the X offset contributes to bit 9 of the total offset,
-    * so swizzle can be calculated in advance for these X positions.
-    * Move bit 9 three places down to bit 6.
-    */
-   uint32_t swizzle0 = (xo0 >> 3) & swizzle_bit;
-   uint32_t swizzle1 = (xo1 >> 3) & swizzle_bit;
-
-   uint32_t x, yo;
-
-   src += (ptrdiff_t)y0 * src_pitch;
-
-   for (yo = y0 * column_width; yo < y1 * column_width; yo += column_width) {
-      uint32_t xo = xo1;
-      uint32_t swizzle = swizzle1;
-
-      mem_copy(dst + ((xo0 + yo) ^ swizzle0), src + x0, x1 - x0);
-
-      /* Step by spans/columns.  As it happens, the swizzle bit flips
-       * at each step so we don't need to calculate it explicitly.
-       */
-      for (x = x1; x < x2; x += ytile_span) {
-         mem_copy_align16(dst + ((xo + yo) ^ swizzle), src + x, ytile_span);
-         xo += bytes_per_column;
-         swizzle ^= swizzle_bit;
-      }
+   while (bytes >= 16) {
+      rgba8_copy_16_stream_dst(dst, src);
+      src += 16;
+      dst += 16;
+      bytes -= 16;
+   }
 
-      mem_copy_align16(dst + ((xo + yo) ^ swizzle), src + x2, x3 - x2);
+   rgba8_copy(dst, src, bytes);
 
-      src += src_pitch;
-   }
+   return dst;
 }
 
 /**
- * Copy texture data from X tile layout to linear.
- *
- * \copydoc tile_copy_fn
+ * Plain copy, with non-temporal stores to the 16-byte aligned destination.
  */
-static inline void
-xtiled_to_linear(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
-                 uint32_t y0, uint32_t y1,
-                 char *dst, const char *src,
-                 int32_t dst_pitch,
-                 uint32_t swizzle_bit,
-                 mem_copy_fn mem_copy,
-                 mem_copy_fn mem_copy_align16)
+static inline void *
+memcpy_stream_dst(void *dst, const void *src, size_t bytes)
 {
-   /* The copy destination offset for each range copied is the sum of
-    * an X offset 'x0' or 'xo' and a Y offset 'yo.'
-    */
-   uint32_t xo, yo;
-
-   dst += (ptrdiff_t)y0 * dst_pitch;
-
-   for (yo = y0 * xtile_width; yo < y1 * xtile_width; yo += xtile_width) {
-      /* Bits 9 and 10 of the copy destination offset control swizzling.
-       * Only 'yo' contributes to those bits in the total offset,
-       * so calculate 'swizzle' just once per row.
-       * Move bits 9 and 10 three and four places respectively down
-       * to bit 6 and xor them.
-       */
-      uint32_t swizzle = ((yo >> 3) ^ (yo >> 4)) & swizzle_bit;
-
-      mem_copy(dst + x0, src + ((x0 + yo) ^ swizzle), x1 - x0);
-
-      for (xo = x1; xo < x2; xo += xtile_span) {
-         mem_copy_align16(dst + xo, src + ((xo + yo) ^ swizzle), xtile_span);
-      }
-
-      mem_copy_align16(dst + x2, src + ((xo + yo) ^ swizzle), x3 - x2);
+   assert(bytes == 0 || !(((uintptr_t)dst) & 0xf));
 
-      dst += dst_pitch;
+   while (bytes >= 16) {
+      _mm_stream_si128(dst, _mm_loadu_si128(src));
+      src += 16;
+      dst += 16;
+      bytes -= 16;
    }
-}
-
- /**
- * Copy texture data from Y tile layout to linear.
- *
- * \copydoc tile_copy_fn
- */
-static inline void
-ytiled_to_linear(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
-                 uint32_t y0, uint32_t y1,
-                 char *dst, const char *src,
-                 int32_t dst_pitch,
-                 uint32_t swizzle_bit,
-                 mem_copy_fn mem_copy,
-                 mem_copy_fn mem_copy_align16)
-{
-   /* Y tiles consist of columns that are 'ytile_span' wide (and the same height
-    * as the tile).  Thus the destination offset for (x,y) is the sum of:
-    *   (x % column_width)                    // position within column
-    *   (x / column_width) * bytes_per_column // column number * bytes per column
-    *   y * column_width
-    *
-    * The copy destination offset for each range copied is the sum of
-    * an X offset 'xo0' or 'xo' and a Y offset 'yo.'
-    */
-   const uint32_t column_width = ytile_span;
-   const uint32_t bytes_per_column = column_width * ytile_height;
-
-   uint32_t xo0 = (x0 % ytile_span) + (x0 / ytile_span) * bytes_per_column;
-   uint32_t xo1 = (x1 % ytile_span) + (x1 / ytile_span) * bytes_per_column;
-
-   /* Bit 9 of the destination offset control swizzling.
-    * Only the X offset contributes to bit 9 of the total offset,
-    * so swizzle can be calculated in advance for these X positions.
-    * Move bit 9 three places down to bit 6.
-    */
-   uint32_t swizzle0 = (xo0 >> 3) & swizzle_bit;
-   uint32_t swizzle1 = (xo1 >> 3) & swizzle_bit;
-
-   uint32_t x, yo;
-
-   dst += (ptrdiff_t)y0 * dst_pitch;
-
-   for (yo = y0 * column_width; yo < y1 * column_width; yo += column_width) {
-      uint32_t xo = xo1;
-      uint32_t swizzle = swizzle1;
 
-      mem_copy(dst + x0, src + ((xo0 + yo) ^ swizzle0), x1 - x0);
+   memcpy(dst, src, bytes);
 
-      /* Step by spans/columns.  As it happens, the swizzle bit flips
-       * at each step so we don't need to calculate it explicitly.
-       */
-      for (x = x1; x < x2; x += ytile_span) {
-         mem_copy_align16(dst + x, src + ((xo + yo) ^ swizzle), ytile_span);
-         xo += bytes_per_column;
-         swizzle ^= swizzle_bit;
-      }
-
-      mem_copy_align16(dst + x2, src + ((xo + yo) ^ swizzle), x3 - x2);
-
-      dst += dst_pitch;
-   }
+   return dst;
 }
-
+#endif
 
 /**
  * Copy texture data from linear to X tile layout, faster.
@@ -532,6 +295,91 @@ linear_to_ytiled_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
                     dst, src, src_pitch, swizzle_bit, mem_copy, mem_copy);
 }
 
+#if defined(__SSSE3__) || defined(__SSE2__)
+/**
+ * Copy texture data from linear to X tile layout, bypassing the caches.
+ *
+ * Same as \ref linear_to_xtiled_faster, but the aligned part of each row is
+ * written with non-temporal stores, so that large uploads don't evict
+ * everything else from the caches.
+ *
+ * \copydoc tile_copy_fn
+ */
+static FLATTEN void
+linear_to_xtiled_stream(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
+                        uint32_t y0, uint32_t y1,
+                        char *dst, const char *src,
+                        int32_t src_pitch,
+                        uint32_t swizzle_bit,
+                        mem_copy_fn mem_copy)
+{
+   if (x0 == 0 && x3 == xtile_width && y0 == 0 && y1 == xtile_height) {
+      if (mem_copy == memcpy)
+         return linear_to_xtiled(0, 0, xtile_width, xtile_width, 0, xtile_height,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 memcpy, memcpy_stream_dst);
+      else if (mem_copy == rgba8_copy)
+         return linear_to_xtiled(0, 0, xtile_width, xtile_width, 0, xtile_height,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 rgba8_copy, rgba8_copy_stream_dst);
+      else
+         unreachable("not reached");
+   } else {
+      if (mem_copy == memcpy)
+         return linear_to_xtiled(x0, x1, x2, x3, y0, y1,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 memcpy, memcpy_stream_dst);
+      else if (mem_copy == rgba8_copy)
+         return linear_to_xtiled(x0, x1, x2, x3, y0, y1,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 rgba8_copy, rgba8_copy_stream_dst);
+      else
+         unreachable("not reached");
+   }
+}
+
+/**
+ * Copy texture data from linear to Y tile layout, bypassing the caches.
+ *
+ * Same as \ref linear_to_ytiled_faster, but the aligned part of each row is
+ * written with non-temporal stores.
+ *
+ * \copydoc tile_copy_fn
+ */
+static FLATTEN void
+linear_to_ytiled_stream(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
+                        uint32_t y0, uint32_t y1,
+                        char *dst, const char *src,
+                        int32_t src_pitch,
+                        uint32_t swizzle_bit,
+                        mem_copy_fn mem_copy)
+{
+   if (x0 == 0 && x3 == ytile_width && y0 == 0 && y1 == ytile_height) {
+      if (mem_copy == memcpy)
+         return linear_to_ytiled(0, 0, ytile_width, ytile_width, 0, ytile_height,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 memcpy, memcpy_stream_dst);
+      else if (mem_copy == rgba8_copy)
+         return linear_to_ytiled(0, 0, ytile_width, ytile_width, 0, ytile_height,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 rgba8_copy, rgba8_copy_stream_dst);
+      else
+         unreachable("not reached");
+   } else {
+      if (mem_copy == memcpy)
+         return linear_to_ytiled(x0, x1, x2, x3, y0, y1,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 memcpy, memcpy_stream_dst);
+      else if (mem_copy == rgba8_copy)
+         return linear_to_ytiled(x0, x1, x2, x3, y0, y1,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 rgba8_copy, rgba8_copy_stream_dst);
+      else
+         unreachable("not reached");
+   }
+}
+#endif
+
 /**
  * Copy texture data from X tile layout to linear, faster.
  *
@@ -616,8 +464,58 @@ ytiled_to_linear_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
                     dst, src, dst_pitch, swizzle_bit, mem_copy, mem_copy);
 }
 
+/* Uploads of at least this many bytes are written with non-temporal stores.
+ * The data is unlikely to still be in the caches when the GPU samples from
+ * it, and would evict everything else along the way.
+ */
+static const uint64_t stream_threshold = 4 * 1024 * 1024;
+
+/* Copies of at least this many bytes are split into bands of tile rows that
+ * are copied in parallel.
+ */
+static const uint64_t threaded_threshold = 1024 * 1024;
+
+static tile_copy_fn
+choose_linear_to_tiled_copy(uint32_t tiling, bool stream)
+{
+#ifdef USE_AVX2
+   if (cpu_has_avx2) {
+      if (tiling == I915_TILING_X)
+         return stream ? intel_linear_to_xtiled_stream_avx2 :
+                         intel_linear_to_xtiled_avx2;
+      else
+         return stream ? intel_linear_to_ytiled_stream_avx2 :
+                         intel_linear_to_ytiled_avx2;
+   }
+#endif
+
+#if defined(__SSSE3__) || defined(__SSE2__)
+   if (stream) {
+      return tiling == I915_TILING_X ? linear_to_xtiled_stream :
+                                       linear_to_ytiled_stream;
+   }
+#endif
+
+   return tiling == I915_TILING_X ? linear_to_xtiled_faster :
+                                    linear_to_ytiled_faster;
+}
+
+static tile_copy_fn
+choose_tiled_to_linear_copy(uint32_t tiling)
+{
+#ifdef USE_AVX2
+   if (cpu_has_avx2) {
+      return tiling == I915_TILING_X ? intel_xtiled_to_linear_avx2 :
+                                       intel_ytiled_to_linear_avx2;
+   }
+#endif
+
+   return tiling == I915_TILING_X ? xtiled_to_linear_faster :
+                                    ytiled_to_linear_faster;
+}
+
 /**
- * Copy from linear to tiled texture.
+ * Copy from linear to tiled texture, on the calling thread.
  *
  * Divide the region given by X range [xt1, xt2) and Y range [yt1, yt2) into
  * pieces that do not cross tile boundaries and copy each piece with a tile
@@ -627,14 +525,15 @@ ytiled_to_linear_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
  * 'dst' is the start of the texture and 'src' is the corresponding
  * address to copy from, though copying begins at (xt1, yt1).
  */
-void
-linear_to_tiled(uint32_t xt1, uint32_t xt2,
-                uint32_t yt1, uint32_t yt2,
-                char *dst, const char *src,
-                uint32_t dst_pitch, int32_t src_pitch,
-                bool has_swizzling,
-                uint32_t tiling,
-                mem_copy_fn mem_copy)
+static void
+linear_to_tiled_rows(uint32_t xt1, uint32_t xt2,
+                     uint32_t yt1, uint32_t yt2,
+                     char *dst, const char *src,
+                     uint32_t dst_pitch, int32_t src_pitch,
+                     bool has_swizzling,
+                     uint32_t tiling,
+                     mem_copy_fn mem_copy,
+                     bool stream)
 {
    tile_copy_fn tile_copy;
    uint32_t xt0, xt3;
@@ -647,16 +546,16 @@ linear_to_tiled(uint32_t xt1, uint32_t xt2,
       tw = xtile_width;
       th = xtile_height;
       span = xtile_span;
-      tile_copy = linear_to_xtiled_faster;
    } else if (tiling == I915_TILING_Y) {
       tw = ytile_width;
       th = ytile_height;
       span = ytile_span;
-      tile_copy = linear_to_ytiled_faster;
    } else {
       unreachable("unsupported tiling");
    }
 
+   tile_copy = choose_linear_to_tiled_copy(tiling, stream);
+
    /* Round out to tile boundaries. */
    xt0 = ALIGN_DOWN(xt1, tw);
    xt3 = ALIGN_UP  (xt2, tw);
@@ -705,10 +604,15 @@ linear_to_tiled(uint32_t xt1, uint32_t xt2,
                    mem_copy);
       }
    }
+#if defined(__SSSE3__) || defined(__SSE2__)
+   /* Non-temporal stores aren't ordered with anything that follows. */
+   if (stream)
+      _mm_sfence();
+#endif
 }
 
 /**
- * Copy from tiled to linear texture.
+ * Copy from tiled to linear texture, on the calling thread.
  *
  * Divide the region given by X range [xt1, xt2) and Y range [yt1, yt2) into
  * pieces that do not cross tile boundaries and copy each piece with a tile
@@ -718,14 +622,14 @@ linear_to_tiled(uint32_t xt1, uint32_t xt2,
  * 'dst' is the start of the texture and 'src' is the corresponding
  * address to copy from, though copying begins at (xt1, yt1).
  */
-void
-tiled_to_linear(uint32_t xt1, uint32_t xt2,
-                uint32_t yt1, uint32_t yt2,
-                char *dst, const char *src,
-                int32_t dst_pitch, uint32_t src_pitch,
-                bool has_swizzling,
-                uint32_t tiling,
-                mem_copy_fn mem_copy)
+static void
+tiled_to_linear_rows(uint32_t xt1, uint32_t xt2,
+                     uint32_t yt1, uint32_t yt2,
+                     char *dst, const char *src,
+                     int32_t dst_pitch, uint32_t src_pitch,
+                     bool has_swizzling,
+                     uint32_t tiling,
+                     mem_copy_fn mem_copy)
 {
    tile_copy_fn tile_copy;
    uint32_t xt0, xt3;
@@ -738,16 +642,16 @@ tiled_to_linear(uint32_t xt1, uint32_t xt2,
       tw = xtile_width;
       th = xtile_height;
       span = xtile_span;
-      tile_copy = xtiled_to_linear_faster;
    } else if (tiling == I915_TILING_Y) {
       tw = ytile_width;
       th = ytile_height;
       span = ytile_span;
-      tile_copy = ytiled_to_linear_faster;
    } else {
       unreachable("unsupported tiling");
    }
 
+   tile_copy = choose_tiled_to_linear_copy(tiling);
+
    /* Round out to tile boundaries. */
    xt0 = ALIGN_DOWN(xt1, tw);
    xt3 = ALIGN_UP  (xt2, tw);
@@ -799,6 +703,160 @@ tiled_to_linear(uint32_t xt1, uint32_t xt2,
 }
 
 
+/**
+ * A linear <-> tiled copy of the rows [yt1, yt2), as handed to the copy
+ * threads.
+ */
+struct tiled_copy {
+   struct util_queue_fence fence;
+   bool to_tiled;
+   uint32_t xt1, xt2;
+   uint32_t yt1, yt2;
+   char *dst;
+   const char *src;
+   int32_t dst_pitch, src_pitch;
+   bool has_swizzling;
+   uint32_t tiling;
+   mem_copy_fn mem_copy;
+   bool stream;
+};
+
+static void
+run_tiled_copy(const struct tiled_copy *copy)
+{
+   if (copy->to_tiled) {
+      linear_to_tiled_rows(copy->xt1, copy->xt2, copy->yt1, copy->yt2,
+                           copy->dst, copy->src,
+                           copy->dst_pitch, copy->src_pitch,
+                           copy->has_swizzling, copy->tiling,
+                           copy->mem_copy, copy->stream);
+   } else {
+      tiled_to_linear_rows(copy->xt1, copy->xt2, copy->yt1, copy->yt2,
+                           copy->dst, copy->src,
+                           copy->dst_pitch, copy->src_pitch,
+                           copy->has_swizzling, copy->tiling,
+                           copy->mem_copy);
+   }
+}
+
+static void
+tiled_copy_job(void *job, int thread_index)
+{
+   run_tiled_copy(job);
+}
+
+/**
+ * Runs a copy, splitting it across the threads of \p queue if it is large
+ * enough.  Each band covers whole rows of tiles so no tile is written by two
+ * threads, and the calling thread copies the first band itself.
+ */
+static void
+split_tiled_copy(struct util_queue *queue, const struct tiled_copy *copy)
+{
+   const uint32_t th =
+      copy->tiling == I915_TILING_X ? xtile_height : ytile_height;
+   const uint32_t yt0 = ALIGN_DOWN(copy->yt1, th);
+   const uint32_t tile_rows = (ALIGN_UP(copy->yt2, th) - yt0) / th;
+   const uint64_t bytes = (uint64_t) (copy->xt2 - copy->xt1) *
+                          (copy->yt2 - copy->yt1);
+   struct tiled_copy bands[INTEL_TILED_MEMCPY_MAX_THREADS];
+   unsigned num_bands = 1;
+
+   if (queue && util_queue_is_initialized(queue) &&
+       bytes >= threaded_threshold) {
+      num_bands = MIN3(queue->num_threads + 1, tile_rows,
+                       INTEL_TILED_MEMCPY_MAX_THREADS);
+   }
+
+   if (num_bands <= 1) {
+      run_tiled_copy(copy);
+      return;
+   }
+
+   for (unsigned i = 0; i < num_bands; i++) {
+      bands[i] = *copy;
+      bands[i].yt1 = MAX2(copy->yt1, yt0 + tile_rows * i / num_bands * th);
+      bands[i].yt2 = MIN2(copy->yt2,
+                          yt0 + tile_rows * (i + 1) / num_bands * th);
+   }
+
+   for (unsigned i = 1; i < num_bands; i++) {
+      util_queue_fence_init(&bands[i].fence);
+      util_queue_add_job(queue, &bands[i], &bands[i].fence,
+                         tiled_copy_job, NULL);
+   }
+
+   run_tiled_copy(&bands[0]);
+
+   for (unsigned i = 1; i < num_bands; i++) {
+      util_queue_job_wait(&bands[i].fence);
+      util_queue_fence_destroy(&bands[i].fence);
+   }
+}
+
+/**
+ * Copy from linear to tiled texture.
+ *
+ * \see linear_to_tiled_rows
+ *
+ * Large copies are spread over the threads of \p queue, which may be NULL.
+ */
+void
+linear_to_tiled(uint32_t xt1, uint32_t xt2,
+                uint32_t yt1, uint32_t yt2,
+                char *dst, const char *src,
+                uint32_t dst_pitch, int32_t src_pitch,
+                bool has_swizzling,
+                uint32_t tiling,
+                mem_copy_fn mem_copy,
+                struct util_queue *queue)
+{
+   const struct tiled_copy copy = {
+      .to_tiled = true,
+      .xt1 = xt1, .xt2 = xt2,
+      .yt1 = yt1, .yt2 = yt2,
+      .dst = dst, .src = src,
+      .dst_pitch = dst_pitch, .src_pitch = src_pitch,
+      .has_swizzling = has_swizzling,
+      .tiling = tiling,
+      .mem_copy = mem_copy,
+      .stream = (uint64_t) (xt2 - xt1) * (yt2 - yt1) >= stream_threshold,
+   };
+
+   split_tiled_copy(queue, &copy);
+}
+
+/**
+ * Copy from tiled to linear texture.
+ *
+ * \see tiled_to_linear_rows
+ *
+ * Large copies are spread over the threads of \p queue, which may be NULL.
+ */
+void
+tiled_to_linear(uint32_t xt1, uint32_t xt2,
+                uint32_t yt1, uint32_t yt2,
+                char *dst, const char *src,
+                int32_t dst_pitch, uint32_t src_pitch,
+                bool has_swizzling,
+                uint32_t tiling,
+                mem_copy_fn mem_copy,
+                struct util_queue *queue)
+{
+   const struct tiled_copy copy = {
+      .to_tiled = false,
+      .xt1 = xt1, .xt2 = xt2,
+      .yt1 = yt1, .yt2 = yt2,
+      .dst = dst, .src = src,
+      .dst_pitch = dst_pitch, .src_pitch = src_pitch,
+      .has_swizzling = has_swizzling,
+      .tiling = tiling,
+      .mem_copy = mem_copy,
+   };
+
+   split_tiled_copy(queue, &copy);
+}
+
 /**
  * Determine which copy function to use for the given format combination
  *
@@ -34,6 +34,10 @@
 
 #include <stdint.h>
 #include "main/mtypes.h"
+#include "util/u_queue.h"
+
+/** Most threads, including the caller's, a single copy is split across. */
+#define INTEL_TILED_MEMCPY_MAX_THREADS 4
 
 typedef void *(*mem_copy_fn)(void *dest, const void *src, size_t n);
 
@@ -44,7 +48,8 @@ linear_to_tiled(uint32_t xt1, uint32_t xt2,
                 uint32_t dst_pitch, int32_t src_pitch,
                 bool has_swizzling,
                 uint32_t tiling,
-                mem_copy_fn mem_copy);
+                mem_copy_fn mem_copy,
+                struct util_queue *queue);
 
 void
 tiled_to_linear(uint32_t xt1, uint32_t xt2,
@@ -53,7 +58,8 @@ tiled_to_linear(uint32_t xt1, uint32_t xt2,
                 int32_t dst_pitch, uint32_t src_pitch,
                 bool has_swizzling,
                 uint32_t tiling,
-                mem_copy_fn mem_copy);
+                mem_copy_fn mem_copy,
+                struct util_queue *queue);
 
 bool intel_get_memcpy(mesa_format tiledFormat, GLenum format,
                       GLenum type, mem_copy_fn *mem_copy, uint32_t *cpp);
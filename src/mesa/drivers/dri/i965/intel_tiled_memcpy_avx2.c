@@ -0,0 +1,233 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file intel_tiled_memcpy_avx2.c
+ *
+ * The tile copy functions of intel_tiled_memcpy.c, built with AVX2 enabled.
+ * This file is only compiled with AVX2_CFLAGS, and its entrypoints are only
+ * called after checking for AVX2 at runtime.
+ *
+ * Each translation unit has its own copy of rgba8_copy, so the callers'
+ * mem_copy can't be compared against it here: anything that isn't memcpy is
+ * taken to be the RGBA <-> BGRA swizzle.
+ */
+
+#include <string.h>
+#include <immintrin.h>
+
+#include "util/macros.h"
+
+#include "intel_tiled_memcpy_impl.h"
+
+static const uint8_t rgba8_permutation[32] =
+   { 2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15,
+     2,1,0,3, 6,5,4,7, 10,9,8,11, 14,13,12,15 };
+
+static inline __m256i
+rgba8_swizzle_32(__m256i reg)
+{
+   return _mm256_shuffle_epi8(reg,
+                              _mm256_loadu_si256((void *)rgba8_permutation));
+}
+
+static inline __m128i
+rgba8_swizzle_16(__m128i reg)
+{
+   return _mm_shuffle_epi8(reg, _mm_loadu_si128((void *)rgba8_permutation));
+}
+
+/**
+ * Copy with unaligned loads and 16-byte aligned stores, or non-temporal
+ * stores if \p stream is set.  Whenever the destination is 32-byte aligned,
+ * whole 32-byte chunks are moved at once.
+ */
+static inline void *
+copy_aligned_dst(void *dst, const void *src, size_t bytes,
+                 bool swizzle, bool stream)
+{
+   char *d = dst;
+   const char *s = src;
+
+   assert(bytes == 0 || !(((uintptr_t)dst) & 0xf));
+
+   if (!(((uintptr_t)d) & 0x1f)) {
+      while (bytes >= 32) {
+         __m256i reg = _mm256_loadu_si256((const __m256i *)s);
+         if (swizzle)
+            reg = rgba8_swizzle_32(reg);
+         if (stream)
+            _mm256_stream_si256((__m256i *)d, reg);
+         else
+            _mm256_store_si256((__m256i *)d, reg);
+         s += 32;
+         d += 32;
+         bytes -= 32;
+      }
+   }
+
+   while (bytes >= 16) {
+      __m128i reg = _mm_loadu_si128((const __m128i *)s);
+      if (swizzle)
+         reg = rgba8_swizzle_16(reg);
+      if (stream)
+         _mm_stream_si128((__m128i *)d, reg);
+      else
+         _mm_store_si128((__m128i *)d, reg);
+      s += 16;
+      d += 16;
+      bytes -= 16;
+   }
+
+   if (swizzle)
+      rgba8_copy(d, s, bytes);
+   else
+      memcpy(d, s, bytes);
+
+   return dst;
+}
+
+/**
+ * Copy with 16-byte aligned loads and unaligned stores.
+ */
+static inline void *
+copy_aligned_src(void *dst, const void *src, size_t bytes, bool swizzle)
+{
+   char *d = dst;
+   const char *s = src;
+
+   assert(bytes == 0 || !(((uintptr_t)src) & 0xf));
+
+   if (!(((uintptr_t)s) & 0x1f)) {
+      while (bytes >= 32) {
+         __m256i reg = _mm256_load_si256((const __m256i *)s);
+         if (swizzle)
+            reg = rgba8_swizzle_32(reg);
+         _mm256_storeu_si256((__m256i *)d, reg);
+         s += 32;
+         d += 32;
+         bytes -= 32;
+      }
+   }
+
+   while (bytes >= 16) {
+      __m128i reg = _mm_load_si128((const __m128i *)s);
+      if (swizzle)
+         reg = rgba8_swizzle_16(reg);
+      _mm_storeu_si128((__m128i *)d, reg);
+      s += 16;
+      d += 16;
+      bytes -= 16;
+   }
+
+   if (swizzle)
+      rgba8_copy(d, s, bytes);
+   else
+      memcpy(d, s, bytes);
+
+   return dst;
+}
+
+static void *
+memcpy_aligned_dst_avx2(void *dst, const void *src, size_t bytes)
+{
+   return copy_aligned_dst(dst, src, bytes, false, false);
+}
+
+static void *
+rgba8_copy_aligned_dst_avx2(void *dst, const void *src, size_t bytes)
+{
+   return copy_aligned_dst(dst, src, bytes, true, false);
+}
+
+static void *
+memcpy_stream_dst_avx2(void *dst, const void *src, size_t bytes)
+{
+   return copy_aligned_dst(dst, src, bytes, false, true);
+}
+
+static void *
+rgba8_copy_stream_dst_avx2(void *dst, const void *src, size_t bytes)
+{
+   return copy_aligned_dst(dst, src, bytes, true, true);
+}
+
+static void *
+memcpy_aligned_src_avx2(void *dst, const void *src, size_t bytes)
+{
+   return copy_aligned_src(dst, src, bytes, false);
+}
+
+static void *
+rgba8_copy_aligned_src_avx2(void *dst, const void *src, size_t bytes)
+{
+   return copy_aligned_src(dst, src, bytes, true);
+}
+
+/* The wrappers below mirror the *_faster ones of intel_tiled_memcpy.c: the
+ * full tile case passes constant bounds, letting the compiler specialize the
+ * inlined loops for it.
+ */
+#define TILE_COPY(name, tile, walk, copy_align16_memcpy,                    \
+                        copy_align16_rgba8)                                 \
+void FLATTEN                                                                \
+name(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,                    \
+     uint32_t y0, uint32_t y1,                                              \
+     char *dst, const char *src,                                            \
+     int32_t linear_pitch,                                                  \
+     uint32_t swizzle_bit,                                                  \
+     mem_copy_fn mem_copy)                                                  \
+{                                                                           \
+   if (x0 == 0 && x3 == tile##_width && y0 == 0 && y1 == tile##_height) {   \
+      if (mem_copy == memcpy)                                               \
+         walk(0, 0, tile##_width, tile##_width, 0, tile##_height,           \
+              dst, src, linear_pitch, swizzle_bit,                          \
+              memcpy, copy_align16_memcpy);                                 \
+      else                                                                  \
+         walk(0, 0, tile##_width, tile##_width, 0, tile##_height,           \
+              dst, src, linear_pitch, swizzle_bit,                          \
+              rgba8_copy, copy_align16_rgba8);                              \
+   } else {                                                                 \
+      if (mem_copy == memcpy)                                               \
+         walk(x0, x1, x2, x3, y0, y1,                                       \
+              dst, src, linear_pitch, swizzle_bit,                          \
+              memcpy, copy_align16_memcpy);                                 \
+      else                                                                  \
+         walk(x0, x1, x2, x3, y0, y1,                                       \
+              dst, src, linear_pitch, swizzle_bit,                          \
+              rgba8_copy, copy_align16_rgba8);                              \
+   }                                                                        \
+}
+
+TILE_COPY(intel_linear_to_xtiled_avx2, xtile, linear_to_xtiled,
+                memcpy_aligned_dst_avx2, rgba8_copy_aligned_dst_avx2)
+TILE_COPY(intel_linear_to_ytiled_avx2, ytile, linear_to_ytiled,
+                memcpy_aligned_dst_avx2, rgba8_copy_aligned_dst_avx2)
+TILE_COPY(intel_linear_to_xtiled_stream_avx2, xtile, linear_to_xtiled,
+                memcpy_stream_dst_avx2, rgba8_copy_stream_dst_avx2)
+TILE_COPY(intel_linear_to_ytiled_stream_avx2, ytile, linear_to_ytiled,
+                memcpy_stream_dst_avx2, rgba8_copy_stream_dst_avx2)
+TILE_COPY(intel_xtiled_to_linear_avx2, xtile, xtiled_to_linear,
+                memcpy_aligned_src_avx2, rgba8_copy_aligned_src_avx2)
+TILE_COPY(intel_ytiled_to_linear_avx2, ytile, ytiled_to_linear,
+                memcpy_aligned_src_avx2, rgba8_copy_aligned_src_avx2)
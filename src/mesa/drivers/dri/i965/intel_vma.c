@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * @file intel_vma.c
+ *
+ * First-fit allocation of GPU virtual addresses for softpinned buffers.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "main/macros.h"
+#include "intel_vma.h"
+
+#define VMA_ALIGNMENT 4096
+
+struct intel_vma_hole {
+   struct list_head link;
+   uint64_t offset;
+   uint64_t size;
+};
+
+void
+intel_vma_init(struct intel_vma *vma, uint64_t start, uint64_t size)
+{
+   mtx_init(&vma->mutex, mtx_plain);
+   list_inithead(&vma->holes);
+   vma->slots = NULL;
+   vma->num_slots = 0;
+
+   struct intel_vma_hole *hole = malloc(sizeof(*hole));
+   if (hole) {
+      hole->offset = start;
+      hole->size = size;
+      list_addtail(&hole->link, &vma->holes);
+   }
+}
+
+void
+intel_vma_finish(struct intel_vma *vma)
+{
+   list_for_each_entry_safe(struct intel_vma_hole, hole, &vma->holes, link)
+      free(hole);
+
+   free(vma->slots);
+   mtx_destroy(&vma->mutex);
+}
+
+static uint64_t
+vma_alloc(struct intel_vma *vma, uint64_t size)
+{
+   list_for_each_entry(struct intel_vma_hole, hole, &vma->holes, link) {
+      if (hole->size < size)
+         continue;
+
+      const uint64_t offset = hole->offset;
+      hole->offset += size;
+      hole->size -= size;
+      if (hole->size == 0) {
+         list_del(&hole->link);
+         free(hole);
+      }
+      return offset;
+   }
+
+   return 0;
+}
+
+static void
+vma_free(struct intel_vma *vma, uint64_t offset, uint64_t size)
+{
+   struct intel_vma_hole *prev = NULL, *next = NULL;
+
+   list_for_each_entry(struct intel_vma_hole, hole, &vma->holes, link) {
+      if (hole->offset > offset) {
+         next = hole;
+         break;
+      }
+      prev = hole;
+   }
+
+   /* Merge with the neighbouring holes where the range touches them. */
+   if (prev && prev->offset + prev->size == offset) {
+      prev->size += size;
+      if (next && offset + size == next->offset) {
+         prev->size += next->size;
+         list_del(&next->link);
+         free(next);
+      }
+      return;
+   }
+
+   if (next && offset + size == next->offset) {
+      next->offset = offset;
+      next->size += size;
+      return;
+   }
+
+   struct intel_vma_hole *hole = malloc(sizeof(*hole));
+   if (!hole)
+      return; /* Leak the range rather than fail. */
+
+   hole->offset = offset;
+   hole->size = size;
+   if (prev)
+      list_add(&hole->link, &prev->link);
+   else
+      list_add(&hole->link, &vma->holes);
+}
+
+/**
+ * Gives \p bo a fixed address in the GPU address space, unless it already
+ * has one.
+ *
+ * Returns false if the address space is exhausted, in which case the buffer
+ * keeps being placed by the kernel.
+ */
+bool
+intel_vma_pin_bo(struct intel_vma *vma, drm_intel_bo *bo)
+{
+   const uint64_t size = align64(bo->size, VMA_ALIGNMENT);
+   bool ret = false;
+
+   mtx_lock(&vma->mutex);
+
+   if (bo->handle >= vma->num_slots) {
+      const unsigned num_slots = MAX2(2 * vma->num_slots, bo->handle + 1);
+      struct intel_vma_slot *slots =
+         realloc(vma->slots, num_slots * sizeof(*slots));
+      if (!slots)
+         goto out;
+
+      memset(slots + vma->num_slots, 0,
+             (num_slots - vma->num_slots) * sizeof(*slots));
+      vma->slots = slots;
+      vma->num_slots = num_slots;
+   }
+
+   struct intel_vma_slot *slot = &vma->slots[bo->handle];
+
+   if (slot->bo == bo && slot->size != 0 && bo->offset64 == slot->offset) {
+      ret = true;
+      goto out;
+   }
+
+   /* Any range still recorded for this handle belonged to a buffer which
+    * has since been closed.  Reuse it if it's large enough.
+    */
+   if (slot->size < size) {
+      if (slot->size != 0)
+         vma_free(vma, slot->offset, slot->size);
+
+      slot->offset = vma_alloc(vma, size);
+      slot->size = slot->offset ? size : 0;
+   }
+
+   slot->bo = bo;
+   if (slot->size == 0)
+      goto out;
+
+   if (drm_intel_bo_set_softpin_offset(bo, slot->offset) != 0) {
+      vma_free(vma, slot->offset, slot->size);
+      slot->bo = NULL;
+      slot->size = 0;
+      goto out;
+   }
+
+   ret = true;
+
+out:
+   mtx_unlock(&vma->mutex);
+   return ret;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef INTEL_VMA_H
+#define INTEL_VMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "c11/threads.h"
+#include "util/list.h"
+#include "intel_bufmgr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Userspace allocator for the GPU virtual addresses of softpinned buffers.
+ *
+ * Every context of the screen gets its own PPGTT, so a single allocator per
+ * screen keeps the addresses of shared buffers valid in all of them.
+ *
+ * libdrm doesn't tell us when it closes a buffer, so ranges are tracked by
+ * GEM handle instead: the kernel only reuses the handle of a closed buffer,
+ * and when it does, the range recorded for that handle is recycled.
+ */
+struct intel_vma {
+   mtx_t mutex;
+
+   /** Free ranges of the address space, sorted by address. */
+   struct list_head holes;
+
+   /** Range owned by each GEM handle, indexed by handle. */
+   struct intel_vma_slot {
+      drm_intel_bo *bo;
+      uint64_t offset;
+      uint64_t size;
+   } *slots;
+   unsigned num_slots;
+};
+
+void intel_vma_init(struct intel_vma *vma, uint64_t start, uint64_t size);
+void intel_vma_finish(struct intel_vma *vma);
+
+bool intel_vma_pin_bo(struct intel_vma *vma, drm_intel_bo *bo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -579,6 +579,35 @@ valid_elements_type(struct gl_context *ctx, GLenum type, const char *name)
    }
 }
 
+/**
+ * With KHR_no_error, the application guarantees that its draw calls are
+ * valid, so the checks are skipped and only the derived state that they
+ * would have brought up to date is updated.
+ * \return true if there is anything to draw
+ */
+static bool
+no_error_draw(struct gl_context *ctx, GLsizei count, GLsizei numInstances)
+{
+   FLUSH_CURRENT(ctx, 0);
+
+   if (ctx->NewState)
+      _mesa_update_state(ctx);
+
+   return count > 0 && numInstances > 0;
+}
+
+static bool
+no_error_draw_elements(struct gl_context *ctx, GLsizei count,
+                       const GLvoid *indices, GLsizei numInstances)
+{
+   /* Not using a VBO for indices, so avoid NULL pointer derefs later.
+    */
+   if (!_mesa_is_bufferobj(ctx->Array.VAO->IndexBufferObj) && indices == NULL)
+      return false;
+
+   return no_error_draw(ctx, count, numInstances);
+}
+
 static bool
 validate_DrawElements_common(struct gl_context *ctx,
                              GLenum mode, GLsizei count, GLenum type,
@@ -653,6 +682,9 @@ _mesa_validate_DrawElements(struct gl_context *ctx,
                             GLenum mode, GLsizei count, GLenum type,
                             const GLvoid *indices)
 {
+   if (_mesa_is_no_error_enabled(ctx))
+      return no_error_draw_elements(ctx, count, indices, 1);
+
    FLUSH_CURRENT(ctx, 0);
 
    return validate_DrawElements_common(ctx, mode, count, type, indices,
@@ -717,6 +749,9 @@ _mesa_validate_DrawRangeElements(struct gl_context *ctx, GLenum mode,
                                  GLsizei count, GLenum type,
                                  const GLvoid *indices)
 {
+   if (_mesa_is_no_error_enabled(ctx))
+      return no_error_draw_elements(ctx, count, indices, 1);
+
    FLUSH_CURRENT(ctx, 0);
 
    if (end < start) {
@@ -800,6 +835,9 @@ validate_draw_arrays(struct gl_context *ctx, const char *func,
 GLboolean
 _mesa_validate_DrawArrays(struct gl_context *ctx, GLenum mode, GLsizei count)
 {
+   if (_mesa_is_no_error_enabled(ctx))
+      return no_error_draw(ctx, count, 1);
+
    return validate_draw_arrays(ctx, "glDrawArrays", mode, count, 1);
 }
 
@@ -808,6 +846,9 @@ GLboolean
 _mesa_validate_DrawArraysInstanced(struct gl_context *ctx, GLenum mode, GLint first,
                                    GLsizei count, GLsizei numInstances)
 {
+   if (_mesa_is_no_error_enabled(ctx))
+      return no_error_draw(ctx, count, numInstances);
+
    if (first < 0) {
       _mesa_error(ctx, GL_INVALID_VALUE,
                   "glDrawArraysInstanced(start=%d)", first);
@@ -830,6 +871,9 @@ _mesa_validate_DrawElementsInstanced(struct gl_context *ctx,
                                      GLenum mode, GLsizei count, GLenum type,
                                      const GLvoid *indices, GLsizei numInstances)
 {
+   if (_mesa_is_no_error_enabled(ctx))
+      return no_error_draw_elements(ctx, count, indices, numInstances);
+
    FLUSH_CURRENT(ctx, 0);
 
    if (numInstances < 0) {
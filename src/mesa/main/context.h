@@ -149,6 +149,9 @@ _mesa_notifySwapBuffers(struct gl_context *gc);
 extern struct _glapi_table *
 _mesa_get_dispatch(struct gl_context *ctx);
 
+extern struct _glapi_table *
+_mesa_alloc_dispatch_table(void);
+
 extern void
 _mesa_set_context_lost_dispatch(struct gl_context *ctx);
 
@@ -324,6 +327,18 @@ _mesa_is_gles32(const struct gl_context *ctx)
 }
 
 
+/**
+ * Checks if the context was created with KHR_no_error, in which case the
+ * application promises that it won't generate GL errors, and API
+ * validation can be skipped.
+ */
+static inline bool
+_mesa_is_no_error_enabled(const struct gl_context *ctx)
+{
+   return ctx->Const.ContextFlags & GL_CONTEXT_FLAG_NO_ERROR_BIT_KHR;
+}
+
+
 /**
  * Checks if the context supports geometry shaders.
  */
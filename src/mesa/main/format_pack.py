@@ -53,6 +53,11 @@ string = """/*
 #define UNPACK(SRC, OFFSET, BITS) (((SRC) >> (OFFSET)) & MAX_UINT(BITS))
 #define PACK(SRC, OFFSET, BITS) (((SRC) & MAX_UINT(BITS)) << (OFFSET))
 
+/* Number of pixels whose sRGB channels are converted at once by
+ * _mesa_pack_float_rgba_row.
+ */
+#define SRGB_ROW_CHUNK 64
+
 <%
 import format_parser as parser
 
@@ -66,6 +71,19 @@ for f in formats:
       continue
 
    rgb_formats.append(f)
+
+def is_half_rgba(f):
+   """Returns whether a row of the format has the same layout as an array
+   of RGBA half floats, so that it can be converted all at once."""
+   return (f.layout == parser.ARRAY and len(f.channels) == 4 and
+           all(c.type == parser.FLOAT and c.size == 16 for c in f.channels) and
+           str(f.swizzle) == 'xyzw')
+
+def has_srgb_rgb(f):
+   """Returns whether the format has sRGB encoded color channels, which are
+   converted from float separately from the other channels."""
+   return (f.colorspace == 'srgb' and
+           any(c.type != 'x' and c.name in 'rgb' for c in f.channels))
 %>
 
 /* ubyte packing functions */
@@ -224,8 +242,15 @@ pack_uint_${f.short_name()}(const GLuint src[4], void *dst)
       <% continue %>
    %endif
 
+%if has_srgb_rgb(f):
+/* srgb holds the color channels of src, already converted to sRGB. */
+static inline void
+pack_srgb8_${f.short_name()}(const GLfloat src[4], const GLubyte srgb[3],
+${' ' * (len(f.short_name()) + 12)}void *dst)
+%else:
 static inline void
 pack_float_${f.short_name()}(const GLfloat src[4], void *dst)
+%endif
 {
    %for (i, c) in enumerate(f.channels):
       <% i = f.swizzle.inverse()[i] %>
@@ -237,7 +262,7 @@ pack_float_${f.short_name()}(const GLfloat src[4], void *dst)
       %if c.type == parser.UNSIGNED:
          %if f.colorspace == 'srgb' and c.name in 'rgb':
             <% assert c.size == 8 %>
-            util_format_linear_float_to_srgb_8unorm(src[${i}]);
+            srgb[${i}];
          %else:
             _mesa_float_to_unorm(src[${i}], ${c.size});
          %endif
@@ -277,6 +302,20 @@ pack_float_${f.short_name()}(const GLfloat src[4], void *dst)
       <% assert False %>
    %endif
 }
+
+%if has_srgb_rgb(f):
+static inline void
+pack_float_${f.short_name()}(const GLfloat src[4], void *dst)
+{
+   const GLubyte srgb[3] = {
+      util_format_linear_float_to_srgb_8unorm(src[0]),
+      util_format_linear_float_to_srgb_8unorm(src[1]),
+      util_format_linear_float_to_srgb_8unorm(src[2]),
+   };
+
+   pack_srgb8_${f.short_name()}(src, srgb, dst);
+}
+%endif
 %endfor
 
 static inline void
@@ -404,6 +443,7 @@ _mesa_pack_float_rgba_row(mesa_format format, GLuint n,
 {
    GLuint i;
    GLubyte *d = dst;
+   GLubyte srgb[SRGB_ROW_CHUNK][4];
 
    switch (format) {
 %for f in rgb_formats:
@@ -414,10 +454,26 @@ _mesa_pack_float_rgba_row(mesa_format format, GLuint n,
    %endif
 
    case ${f.name}:
+   %if is_half_rgba(f):
+      _mesa_float_to_half_array((uint16_t *) d, &src[0][0], n * 4);
+   %elif has_srgb_rgb(f):
+      for (i = 0; i < n; i += SRGB_ROW_CHUNK) {
+         const GLuint count = MIN2(n - i, SRGB_ROW_CHUNK);
+         GLuint j;
+
+         util_format_linear_float_to_srgb_8unorm_array(&srgb[0][0],
+                                                       &src[i][0], count * 4);
+         for (j = 0; j < count; j++) {
+            pack_srgb8_${f.short_name()}(src[i + j], srgb[j], d);
+            d += ${f.block_size() / 8};
+         }
+      }
+   %else:
       for (i = 0; i < n; ++i) {
          pack_float_${f.short_name()}(src[i], d);
          d += ${f.block_size() / 8};
       }
+   %endif
       break;
 %endfor
    default:
@@ -65,6 +65,13 @@ for f in formats:
       continue
 
    rgb_formats.append(f)
+
+def is_half_rgba(f):
+   """Returns whether a row of the format has the same layout as an array
+   of RGBA half floats, so that it can be converted all at once."""
+   return (f.layout == parser.ARRAY and len(f.channels) == 4 and
+           all(c.type == parser.FLOAT and c.size == 16 for c in f.channels) and
+           str(f.swizzle) == 'xyzw')
 %>
 
 /* float unpacking functions */
@@ -319,10 +326,14 @@ _mesa_unpack_rgba_row(mesa_format format, GLuint n,
       <% continue %>
    %endif
    case ${f.name}:
+   %if is_half_rgba(f):
+      _mesa_half_to_float_array(&dst[0][0], (const uint16_t *) s, n * 4);
+   %else:
       for (i = 0; i < n; ++i) {
          unpack_float_${f.short_name()}(s, dst[i]);
          s += ${f.block_size() / 8};
       }
+   %endif
       break;
 %endfor
    case MESA_FORMAT_YCBCR:
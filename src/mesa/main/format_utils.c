@@ -26,6 +26,8 @@
 #include "glformats.h"
 #include "format_pack.h"
 #include "format_unpack.h"
+#include "sse_format.h"
+#include "x86/common_x86_asm.h"
 
 const mesa_array_format RGBA32_FLOAT =
    MESA_ARRAY_FORMAT(4, 1, 1, 1, 4, 0, 1, 2, 3);
@@ -191,6 +193,29 @@ convert_ubyte_rgba_to_bgra(size_t width, size_t height,
 {
    int row;
 
+#if defined(USE_SSE41)
+   if (cpu_has_sse4_1) {
+      static const uint8_t rgba2bgra[4] = { 2, 1, 0, 3 };
+
+      for (row = 0; row < height; row++) {
+         const GLuint *s = (const GLuint *) src;
+         GLuint *d = (GLuint *) dst;
+         int i;
+
+         i = _mesa_ubyte_swizzle_to_rgba_sse41(dst, src, 4, rgba2bgra, 0xff,
+                                               width);
+         for (; i < width; i++) {
+            d[i] = ( (s[i] & 0xff00ff00) |
+                    ((s[i] &       0xff) << 16) |
+                    ((s[i] &   0xff0000) >> 16));
+         }
+         src += src_stride;
+         dst += dst_stride;
+      }
+      return;
+   }
+#endif
+
    if (sizeof(void *) == 8 &&
        src_stride % 8 == 0 &&
        dst_stride % 8 == 0 &&
@@ -1496,6 +1521,25 @@ _mesa_swizzle_and_convert(void *void_dst, enum mesa_array_format_datatype dst_ty
                                   swizzle, normalized, count))
       return;
 
+#if defined(USE_SSE41)
+   if (cpu_has_sse4_1 &&
+       dst_type == MESA_ARRAY_FORMAT_TYPE_UBYTE &&
+       src_type == MESA_ARRAY_FORMAT_TYPE_UBYTE &&
+       num_dst_channels == 4 &&
+       (num_src_channels == 3 || num_src_channels == 4)) {
+      int done = _mesa_ubyte_swizzle_to_rgba_sse41(void_dst, void_src,
+                                                   num_src_channels, swizzle,
+                                                   normalized ? UINT8_MAX : 1,
+                                                   count);
+
+      void_dst = (uint8_t *) void_dst + done * 4;
+      void_src = (const uint8_t *) void_src + done * num_src_channels;
+      count -= done;
+      if (count == 0)
+         return;
+   }
+#endif
+
    switch (dst_type) {
    case MESA_ARRAY_FORMAT_TYPE_FLOAT:
       convert_float(void_dst, num_dst_channels, void_src, src_type,
@@ -0,0 +1,228 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file glthread.c
+ *
+ * Execution of GL calls on a separate thread ("glthread").
+ *
+ * The application thread records calls into batches through the marshal
+ * dispatch table (see glthread.h), and a single worker thread executes
+ * them with ctx->CurrentDispatch.  Display lists and glBegin/glEnd switch
+ * CurrentDispatch from the worker, which keeps its own current dispatch
+ * table in sync as usual, while the application thread keeps MarshalExec.
+ */
+
+#include <stdlib.h>
+
+#include "main/bufferobj.h"
+#include "main/context.h"
+#include "main/glthread.h"
+#include "main/mtypes.h"
+
+
+static void
+glthread_unmarshal_batch(void *job, int thread_index)
+{
+   struct glthread_batch *batch = job;
+   struct gl_context *ctx = batch->ctx;
+   size_t pos = 0;
+
+   /* A synchronous call on the application thread may have switched the
+    * dispatch table since the previous batch.
+    */
+   _glapi_set_dispatch(ctx->CurrentDispatch);
+
+   while (pos < batch->used) {
+      pos += _mesa_unmarshal_dispatch_cmd(ctx,
+                                          (uint8_t *) batch->buffer + pos);
+   }
+
+   assert(pos == batch->used);
+   batch->used = 0;
+}
+
+
+static void
+glthread_thread_initialization(void *job, int thread_index)
+{
+   struct gl_context *ctx = job;
+
+   _glapi_check_multithread();
+   _glapi_set_context(ctx);
+}
+
+
+/**
+ * Starts marshalling the GL calls of \p ctx to a worker thread.  Nothing
+ * changes if that fails.
+ */
+void
+_mesa_glthread_init(struct gl_context *ctx)
+{
+   struct glthread_state *glthread;
+   struct util_queue_fence fence;
+   unsigned i;
+
+   if (ctx->GLThread)
+      return;
+
+   glthread = calloc(1, sizeof(*glthread));
+   if (!glthread)
+      return;
+
+   if (!util_queue_init(&glthread->queue, "glthread", MARSHAL_MAX_BATCHES,
+                        1)) {
+      free(glthread);
+      return;
+   }
+
+   ctx->MarshalExec = _mesa_create_marshal_table(ctx);
+   if (!ctx->MarshalExec) {
+      util_queue_destroy(&glthread->queue);
+      free(glthread);
+      return;
+   }
+
+   for (i = 0; i < MARSHAL_MAX_BATCHES; i++) {
+      glthread->batches[i].ctx = ctx;
+      util_queue_fence_init(&glthread->batches[i].fence);
+   }
+
+   ctx->GLThread = glthread;
+
+   /* The worker thread needs the context to be current there as well. */
+   util_queue_fence_init(&fence);
+   util_queue_add_job(&glthread->queue, ctx, &fence,
+                      glthread_thread_initialization, NULL);
+   util_queue_job_wait(&fence);
+   util_queue_fence_destroy(&fence);
+
+   _glapi_check_multithread();
+   if (_mesa_get_current_context() == ctx)
+      _glapi_set_dispatch(ctx->MarshalExec);
+}
+
+
+void
+_mesa_glthread_destroy(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   unsigned i;
+
+   if (!glthread)
+      return;
+
+   _mesa_glthread_finish(ctx);
+   util_queue_destroy(&glthread->queue);
+
+   for (i = 0; i < MARSHAL_MAX_BATCHES; i++)
+      util_queue_fence_destroy(&glthread->batches[i].fence);
+
+   free(glthread);
+   ctx->GLThread = NULL;
+
+   if (_mesa_get_current_context() == ctx)
+      _glapi_set_dispatch(ctx->CurrentDispatch);
+
+   free(ctx->MarshalExec);
+   ctx->MarshalExec = NULL;
+}
+
+
+/**
+ * Hands the batch being filled over to the worker thread.
+ */
+void
+_mesa_glthread_flush_batch(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_batch *batch;
+
+   if (!glthread)
+      return;
+
+   batch = &glthread->batches[glthread->next];
+   if (!batch->used)
+      return;
+
+   util_queue_add_job(&glthread->queue, batch, &batch->fence,
+                      glthread_unmarshal_batch, NULL);
+   glthread->next = (glthread->next + 1) % MARSHAL_MAX_BATCHES;
+
+   /* The next batch is the oldest one; wait until it has been executed
+    * before filling it again.
+    */
+   util_queue_job_wait(&glthread->batches[glthread->next].fence);
+}
+
+
+/**
+ * Waits for all the calls made so far to be executed.
+ */
+void
+_mesa_glthread_finish(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   unsigned last;
+
+   if (!glthread)
+      return;
+
+   _mesa_glthread_flush_batch(ctx);
+
+   /* Batches are executed in order, so the one submitted last is enough. */
+   last = (glthread->next + MARSHAL_MAX_BATCHES - 1) % MARSHAL_MAX_BATCHES;
+   util_queue_job_wait(&glthread->batches[last].fence);
+}
+
+
+/**
+ * Prepares the application thread for calling into ctx->CurrentDispatch
+ * directly: the worker goes idle, and GL calls made by Mesa itself on this
+ * thread are executed right away instead of being marshalled.
+ */
+void
+_mesa_glthread_begin_sync(struct gl_context *ctx)
+{
+   _mesa_glthread_finish(ctx);
+   _glapi_set_dispatch(ctx->CurrentDispatch);
+}
+
+
+void
+_mesa_glthread_end_sync(struct gl_context *ctx)
+{
+   _glapi_set_dispatch(ctx->MarshalExec);
+}
+
+
+/**
+ * Called after a synchronous gl*Pointer call.
+ */
+void
+_mesa_glthread_check_client_arrays(struct gl_context *ctx)
+{
+   if (!_mesa_is_bufferobj(ctx->Array.ArrayBufferObj))
+      ctx->GLThread->client_arrays = true;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef GLTHREAD_H
+#define GLTHREAD_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "main/mtypes.h"
+#include "util/u_queue.h"
+
+/** Size of a batch of marshalled commands, in bytes. */
+#define MARSHAL_MAX_CMD_SIZE (8 * 1024)
+
+/**
+ * Number of batches: one being filled by the application thread, the rest
+ * queued for or being executed by the worker.
+ */
+#define MARSHAL_MAX_BATCHES 4
+
+/** Header of every command in a batch. */
+struct marshal_cmd_base
+{
+   /** One of enum marshal_dispatch_cmd_id. */
+   uint16_t cmd_id;
+
+   /** Size of the command in bytes, including this header. */
+   uint16_t cmd_size;
+};
+
+struct glthread_batch
+{
+   struct gl_context *ctx;
+
+   /** Signalled once the worker has executed the batch. */
+   struct util_queue_fence fence;
+
+   /** Number of bytes of buffer holding commands. */
+   size_t used;
+
+   uint64_t buffer[MARSHAL_MAX_CMD_SIZE / 8];
+};
+
+/**
+ * State of the GL command marshalling ("glthread").
+ *
+ * With glthread, the application thread gets a dispatch table made of the
+ * _mesa_marshal_* functions generated by gl_marshal.py.  Calls that return
+ * nothing and read no memory beyond their fixed-size arguments are copied
+ * into a batch, and the batches are executed in order on the worker thread,
+ * which has the context current as well.  Every other call first waits for
+ * the worker to go idle, and then runs on the application thread.
+ */
+struct glthread_state
+{
+   /** The worker; a single thread, so that batches run in order. */
+   struct util_queue queue;
+
+   struct glthread_batch batches[MARSHAL_MAX_BATCHES];
+
+   /** Index of the batch the application thread is filling. */
+   unsigned next;
+
+   /**
+    * Whether a vertex array may have been pointed at client memory.  Draws
+    * then need to run before the application can change that memory, so
+    * they aren't marshalled anymore.
+    */
+   bool client_arrays;
+};
+
+void
+_mesa_glthread_init(struct gl_context *ctx);
+
+void
+_mesa_glthread_destroy(struct gl_context *ctx);
+
+void
+_mesa_glthread_flush_batch(struct gl_context *ctx);
+
+void
+_mesa_glthread_finish(struct gl_context *ctx);
+
+void
+_mesa_glthread_begin_sync(struct gl_context *ctx);
+
+void
+_mesa_glthread_end_sync(struct gl_context *ctx);
+
+void
+_mesa_glthread_check_client_arrays(struct gl_context *ctx);
+
+/**
+ * Returns space for a command of \p size bytes in the current batch, after
+ * flushing the batch if it is full.
+ */
+static inline void *
+_mesa_glthread_allocate_command(struct gl_context *ctx, uint16_t cmd_id,
+                                size_t size)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_batch *batch = &glthread->batches[glthread->next];
+   struct marshal_cmd_base *cmd_base;
+
+   /* Keep every command 8-byte aligned. */
+   size = (size + 7) & ~(size_t) 7;
+   assert(size <= MARSHAL_MAX_CMD_SIZE);
+
+   if (batch->used + size > MARSHAL_MAX_CMD_SIZE) {
+      _mesa_glthread_flush_batch(ctx);
+      batch = &glthread->batches[glthread->next];
+   }
+
+   cmd_base = (struct marshal_cmd_base *)
+      ((uint8_t *) batch->buffer + batch->used);
+   batch->used += size;
+   cmd_base->cmd_id = cmd_id;
+   cmd_base->cmd_size = size;
+   return cmd_base;
+}
+
+
+/* Functions generated by gl_marshal.py */
+
+size_t
+_mesa_unmarshal_dispatch_cmd(struct gl_context *ctx, const void *cmd);
+
+struct _glapi_table *
+_mesa_create_marshal_table(const struct gl_context *ctx);
+
+#endif /* GLTHREAD_H */
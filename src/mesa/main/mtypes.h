@@ -47,6 +47,7 @@
 #include "main/formats.h"       /* MESA_FORMAT_COUNT */
 #include "compiler/glsl/list.h"
 #include "util/bitscan.h"
+#include "util/u_queue.h"
 
 
 #ifdef __cplusplus
@@ -84,6 +85,9 @@ struct gl_debug_state;
 struct gl_context;
 struct st_context;
 struct gl_uniform_storage;
+union gl_constant_value;
+struct disk_cache;
+struct glthread_state;
 struct prog_instruction;
 struct gl_program_parameter_list;
 struct set;
@@ -2400,6 +2404,18 @@ static inline GLbitfield gl_external_samplers(struct gl_linked_shader *shader)
    return external_samplers;
 }
 
+/**
+ * Compile status enum. compile_skipped is used to indicate the compile
+ * was skipped due to the shader matching one that's been seen before by
+ * the on-disk cache.
+ */
+enum gl_compile_status
+{
+   compile_failure = 0,
+   compile_success,
+   compile_skipped
+};
+
 /**
  * A GLSL shader object.
  */
@@ -2415,8 +2431,19 @@ struct gl_shader
    GLint RefCount;  /**< Reference count */
    GLchar *Label;   /**< GL_KHR_debug */
    GLboolean DeletePending;
-   GLboolean CompileStatus;
+   enum gl_compile_status CompileStatus;
    bool IsES;              /**< True if this shader uses GLSL ES */
+   unsigned char sha1[20]; /**< Shader cache key, \sa shader_cache.h */
+
+   /**
+    * Unique non-zero value assigned each time \c ir is replaced by a
+    * compile.  Lets the linker tell whether a shader changed between two
+    * links of the same program.
+    */
+   unsigned CompileSerial;
+
+   /** Signalled when no background compile of this shader is pending */
+   struct util_queue_fence CompileFence;
 
 #ifdef DEBUG
    unsigned SourceChecksum;       /**< for debug/logging purposes */
@@ -2640,6 +2667,13 @@ struct gl_shader_program_data
    unsigned NumHiddenUniforms;
    struct gl_uniform_storage *UniformStorage;
 
+   /**
+    * Backing store for the uniform values, shared by all of the entries of
+    * UniformStorage (it is a ralloc child of UniformStorage).
+    */
+   unsigned NumUniformDataSlots;
+   union gl_constant_value *UniformDataSlots;
+
    unsigned NumUniformBlocks;
    struct gl_uniform_block *UniformBlocks;
 
@@ -2657,6 +2691,13 @@ struct gl_shader_program_data
 
    /* Mask of stages this program was linked against */
    unsigned linked_stages;
+
+   /**
+    * The linker's output in serialized form, \sa shader_cache.h.  This is
+    * what glGetProgramBinary returns.  NULL if linking failed.
+    */
+   uint8_t *Binary;
+   unsigned BinarySize;
 };
 
 /**
@@ -2685,6 +2726,12 @@ struct gl_shader_program
    GLuint NumShaders;          /**< number of attached shaders */
    struct gl_shader **Shaders; /**< List of attached the shaders */
 
+   /**
+    * Program cache key of the last link, \sa shader_cache.h.  All zero when
+    * the shader cache is disabled.
+    */
+   unsigned char sha1[20];
+
    /**
     * User-defined attribute bindings
     *
@@ -2840,6 +2887,12 @@ struct gl_shader_program
     */
    struct gl_linked_shader *_LinkedShaders[MESA_SHADER_STAGES];
 
+   /**
+    * Per-stage results of earlier links, reused when a program is relinked
+    * with some stages unchanged.  Private to the linker.
+    */
+   struct gl_link_cache *LinkCache;
+
    /** List of all active resources after linking. */
    struct gl_program_resource *ProgramResourceList;
    unsigned NumProgramResourceList;
@@ -2951,6 +3004,26 @@ struct gl_shader_compiler_options
    GLuint MaxIfDepth;               /**< Maximum nested IF blocks */
    GLuint MaxUnrollIterations;
 
+   /**
+    * \name Loop unrolling cost model.
+    */
+   /*@{*/
+   /**
+    * Largest number of IR nodes (body size times trip count) a loop may
+    * expand to when it is fully unrolled.  Zero means 5 *
+    * MaxUnrollIterations.
+    */
+   GLuint MaxUnrollCost;
+
+   /**
+    * Number of copies of the body to put in each iteration of a fixed trip
+    * count loop that is too expensive to unroll fully.  The leftover
+    * iterations are peeled off in front of the loop.  Zero or one disables
+    * partial unrolling.
+    */
+   GLuint MaxPartialUnrollFactor;
+   /*@}*/
+
    /**
     * Optimize code for array of structures backends.
     *
@@ -4363,8 +4436,17 @@ struct gl_context
     * re-set on glXMakeCurrent().
     */
    struct _glapi_table *CurrentDispatch;
+   /**
+    * The dispatch table installed for the application thread when glthread
+    * is enabled, NULL otherwise.  CurrentDispatch is then the table the
+    * marshalled calls are executed with.
+    */
+   struct _glapi_table *MarshalExec;
    /*@}*/
 
+   /** Command marshalling state, NULL unless glthread is enabled */
+   struct glthread_state *GLThread;
+
    struct gl_config Visual;
    struct gl_framebuffer *DrawBuffer;	/**< buffer for writing */
    struct gl_framebuffer *ReadBuffer;	/**< buffer for reading */
@@ -4491,6 +4573,24 @@ struct gl_context
     */
    struct gl_pipeline_object *_Shader;
 
+   /** On-disk cache of linked GLSL programs, NULL if disabled */
+   struct disk_cache *Cache;
+
+   /**
+    * Worker threads for glCompileShader and for optimizing the stages of a
+    * program in parallel at link time.  Created by the first compile that
+    * is allowed to run in the background.
+    */
+   struct util_queue CompileQueue;
+   GLuint MaxShaderCompilerThreads; /**< GL_ARB_parallel_shader_compile */
+
+   /**
+    * Worker threads splitting up the compression, decompression and format
+    * conversion of large texture images.  Created by the first image big
+    * enough to use them.
+    */
+   struct util_queue TexCompressQueue;
+
    struct gl_query_state Query;  /**< occlusion, timer queries */
 
    struct gl_transform_feedback_state TransformFeedback;
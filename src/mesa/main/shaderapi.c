@@ -38,8 +38,12 @@
 
 
 #include <stdbool.h>
+#ifdef HAVE_PTHREAD
+#include <unistd.h>
+#endif
 #include "main/glheader.h"
 #include "main/context.h"
+#include "main/debug_output.h"
 #include "main/dispatch.h"
 #include "main/enums.h"
 #include "main/hash.h"
@@ -56,10 +60,18 @@
 #include "program/program.h"
 #include "program/prog_print.h"
 #include "program/prog_parameter.h"
+#include "program/ir_to_mesa.h"
 #include "util/ralloc.h"
 #include "util/hash_table.h"
 #include "util/mesa-sha1.h"
 #include "util/crc32.h"
+#include "util/u_queue.h"
+
+/**
+ * Upper bound on the worker threads used for compiling shaders, whatever
+ * glMaxShaderCompilerThreadsARB asks for.
+ */
+#define MAX_SHADER_COMPILER_THREADS 8
 
 /**
  * Return mask of GLSL_x flags by examining the MESA_GLSL env var.
@@ -142,6 +154,9 @@ _mesa_init_shader_state(struct gl_context *ctx)
    ctx->Shader.RefCount = 1;
    mtx_init(&ctx->Shader.Mutex, mtx_plain);
 
+   /* GL_ARB_parallel_shader_compile: "implementation-specific maximum" */
+   ctx->MaxShaderCompilerThreads = 0xffffffff;
+
    ctx->TessCtrlProgram.patch_vertices = 3;
    for (i = 0; i < 4; ++i)
       ctx->TessCtrlProgram.patch_default_outer_level[i] = 1.0;
@@ -150,6 +165,35 @@ _mesa_init_shader_state(struct gl_context *ctx)
 }
 
 
+static void
+wait_shader_compile_cb(GLuint id, void *data, void *userData)
+{
+   struct gl_shader *sh = (struct gl_shader *) data;
+
+   if (sh->Type != GL_SHADER_PROGRAM_MESA)
+      _mesa_wait_shader_compile(sh);
+}
+
+
+/**
+ * Finish all background compiles and stop the compiler threads.
+ *
+ * Every job on the queue belongs to a shader object in the shared state
+ * (deleting a shader waits for its compile), so waiting for all of those
+ * drains the queue.  The threads are started again by the next compile.
+ */
+static void
+destroy_compile_queue(struct gl_context *ctx)
+{
+   if (!util_queue_is_initialized(&ctx->CompileQueue))
+      return;
+
+   _mesa_HashWalk(ctx->Shared->ShaderObjects, wait_shader_compile_cb, NULL);
+   util_queue_destroy(&ctx->CompileQueue);
+   memset(&ctx->CompileQueue, 0, sizeof(ctx->CompileQueue));
+}
+
+
 /**
  * Free the per-context shader-related state.
  */
@@ -157,6 +201,9 @@ void
 _mesa_free_shader_state(struct gl_context *ctx)
 {
    int i;
+
+   destroy_compile_queue(ctx);
+
    for (i = 0; i < MESA_SHADER_STAGES; i++) {
       _mesa_reference_shader_program(ctx, &ctx->Shader.CurrentProgram[i],
                                      NULL);
@@ -639,6 +686,12 @@ get_programiv(struct gl_context *ctx, GLuint program, GLenum pname,
    case GL_LINK_STATUS:
       *params = shProg->data->LinkStatus;
       return;
+   case GL_COMPLETION_STATUS_ARB:
+      if (!_mesa_is_desktop_gl(ctx))
+         break;
+      /* Linking always finishes before glLinkProgram returns. */
+      *params = GL_TRUE;
+      return;
    case GL_VALIDATE_STATUS:
       *params = shProg->data->Validated;
       return;
@@ -787,7 +840,7 @@ get_programiv(struct gl_context *ctx, GLuint program, GLenum pname,
       *params = shProg->BinaryRetreivableHint;
       return;
    case GL_PROGRAM_BINARY_LENGTH:
-      *params = 0;
+      *params = _mesa_glsl_program_binary_length(shProg);
       return;
    case GL_ACTIVE_ATOMIC_COUNTER_BUFFERS:
       if (!ctx->Extensions.ARB_shader_atomic_counters)
@@ -881,6 +934,10 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
       return;
    }
 
+   /* Everything but the completion status depends on the compile. */
+   if (pname != GL_COMPLETION_STATUS_ARB)
+      _mesa_wait_shader_compile(shader);
+
    switch (pname) {
    case GL_SHADER_TYPE:
       *params = shader->Type;
@@ -889,7 +946,7 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
       *params = shader->DeletePending;
       break;
    case GL_COMPILE_STATUS:
-      *params = shader->CompileStatus;
+      *params = shader->CompileStatus ? GL_TRUE : GL_FALSE;
       break;
    case GL_INFO_LOG_LENGTH:
       *params = (shader->InfoLog && shader->InfoLog[0] != '\0') ?
@@ -898,10 +955,18 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
    case GL_SHADER_SOURCE_LENGTH:
       *params = shader->Source ? strlen((char *) shader->Source) + 1 : 0;
       break;
-   default:
-      _mesa_error(ctx, GL_INVALID_ENUM, "glGetShaderiv(pname)");
+   case GL_COMPLETION_STATUS_ARB:
+      if (!_mesa_is_desktop_gl(ctx))
+         goto invalid_pname;
+      *params = util_queue_fence_is_signalled(&shader->CompileFence);
       return;
+   default:
+      goto invalid_pname;
    }
+   return;
+
+invalid_pname:
+   _mesa_error(ctx, GL_INVALID_ENUM, "glGetShaderiv(pname)");
 }
 
 
@@ -954,6 +1019,7 @@ get_shader_info_log(struct gl_context *ctx, GLuint shader, GLsizei bufSize,
       return;
    }
 
+   _mesa_wait_shader_compile(sh);
    _mesa_copy_string(infoLog, bufSize, length, sh->InfoLog);
 }
 
@@ -989,6 +1055,9 @@ shader_source(struct gl_shader *sh, const GLchar *source)
 {
    assert(sh);
 
+   /* a pending compile may still be reading the old source */
+   _mesa_wait_shader_compile(sh);
+
    /* free old shader source string and install new one */
    free((void *)sh->Source);
    sh->Source = source;
@@ -1007,11 +1076,13 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
    if (!sh)
       return;
 
+   _mesa_wait_shader_compile(sh);
+
    if (!sh->Source) {
       /* If the user called glCompileShader without first calling
        * glShaderSource, we should fail to compile, but not raise a GL_ERROR.
        */
-      sh->CompileStatus = GL_FALSE;
+      sh->CompileStatus = compile_failure;
    } else {
       if (ctx->_Shader->Flags & GLSL_DUMP) {
          _mesa_log("GLSL source for %s shader %d:\n",
@@ -1022,7 +1093,7 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
       /* this call will set the shader->CompileStatus field to indicate if
        * compilation was successful.
        */
-      _mesa_glsl_compile_shader(ctx, sh, false, false);
+      _mesa_glsl_compile_shader(ctx, sh, false, false, false);
 
       if (ctx->_Shader->Flags & GLSL_LOG) {
          _mesa_write_shader_to_file(sh);
@@ -1064,6 +1135,100 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
 }
 
 
+struct compile_shader_job {
+   struct gl_context *ctx;
+   struct gl_shader *sh;
+};
+
+
+static void
+compile_shader_job_execute(void *data, int thread_index)
+{
+   struct compile_shader_job *job = (struct compile_shader_job *) data;
+
+   _mesa_glsl_compile_shader(job->ctx, job->sh, false, false, false);
+}
+
+
+static void
+compile_shader_job_cleanup(void *data, int thread_index)
+{
+   free(data);
+}
+
+
+static unsigned
+default_compiler_threads(void)
+{
+#if defined(HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+   long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+   /* Leave one CPU to the application thread. */
+   if (cpus > 1)
+      return MIN2(cpus - 1, MAX_SHADER_COMPILER_THREADS);
+#endif
+   return 0;
+}
+
+
+/**
+ * Return the queue used for background compiles, starting its threads if
+ * needed, or NULL if compiles have to stay on the calling thread.
+ */
+static struct util_queue *
+get_compile_queue(struct gl_context *ctx)
+{
+   if (!util_queue_is_initialized(&ctx->CompileQueue)) {
+      unsigned num_threads = MIN2(ctx->MaxShaderCompilerThreads,
+                                  default_compiler_threads());
+
+      if (num_threads == 0 ||
+          !util_queue_init(&ctx->CompileQueue, "glsl", 64, num_threads))
+         return NULL;
+   }
+
+   return &ctx->CompileQueue;
+}
+
+
+/**
+ * glCompileShader: compile \c sh on a worker thread if possible.
+ *
+ * The GL only observes the result of a compile through queries, linking,
+ * or respecifying the source, and each of those waits for the shader's
+ * CompileFence first.  Shaders compiled while MESA_GLSL output or
+ * synchronous debug output is enabled are compiled right away, so that
+ * messages keep appearing in the order the application expects.
+ */
+static void
+compile_shader_async(struct gl_context *ctx, struct gl_shader *sh)
+{
+   const GLbitfield sync_flags =
+      GLSL_DUMP | GLSL_LOG | GLSL_DUMP_ON_ERROR | GLSL_REPORT_ERRORS;
+   struct compile_shader_job *job;
+   struct util_queue *queue;
+
+   if (!sh)
+      return;
+
+   if (!sh->Source || (ctx->_Shader->Flags & sync_flags) ||
+       (ctx->Debug &&
+        _mesa_get_debug_state_int(ctx, GL_DEBUG_OUTPUT_SYNCHRONOUS)) ||
+       !(queue = get_compile_queue(ctx)) ||
+       !(job = (struct compile_shader_job *) malloc(sizeof(*job)))) {
+      _mesa_compile_shader(ctx, sh);
+      return;
+   }
+
+   _mesa_wait_shader_compile(sh);
+
+   job->ctx = ctx;
+   job->sh = sh;
+   util_queue_add_job(queue, job, &sh->CompileFence,
+                      compile_shader_job_execute, compile_shader_job_cleanup);
+}
+
+
 /**
  * Link a program's shaders.
  */
@@ -1086,6 +1251,9 @@ _mesa_link_program(struct gl_context *ctx, struct gl_shader_program *shProg)
 
    FLUSH_VERTICES(ctx, _NEW_PROGRAM);
 
+   for (unsigned i = 0; i < shProg->NumShaders; i++)
+      _mesa_wait_shader_compile(shProg->Shaders[i]);
+
    _mesa_glsl_link_shader(ctx, shProg);
 
    /* Capture .shader_test files. */
@@ -1344,11 +1512,30 @@ _mesa_CompileShader(GLuint shaderObj)
    GET_CURRENT_CONTEXT(ctx);
    if (MESA_VERBOSE & VERBOSE_API)
       _mesa_debug(ctx, "glCompileShader %u\n", shaderObj);
-   _mesa_compile_shader(ctx, _mesa_lookup_shader_err(ctx, shaderObj,
+   compile_shader_async(ctx, _mesa_lookup_shader_err(ctx, shaderObj,
                                                      "glCompileShader"));
 }
 
 
+/**
+ * glMaxShaderCompilerThreadsARB: bound the number of compiler threads.
+ * Zero makes all compiles synchronous again.
+ */
+void GLAPIENTRY
+_mesa_MaxShaderCompilerThreadsARB(GLuint count)
+{
+   GET_CURRENT_CONTEXT(ctx);
+
+   if (ctx->MaxShaderCompilerThreads == count)
+      return;
+
+   ctx->MaxShaderCompilerThreads = count;
+
+   /* Restarted with the new limit by the next compile. */
+   destroy_compile_queue(ctx);
+}
+
+
 GLuint GLAPIENTRY
 _mesa_CreateShader(GLenum type)
 {
@@ -2007,12 +2194,22 @@ _mesa_GetProgramBinary(GLuint program, GLsizei bufSize, GLsizei *length,
       return;
    }
 
-   *length = 0;
-   _mesa_error(ctx, GL_INVALID_OPERATION,
-               "glGetProgramBinary(driver supports zero binary formats)");
+   /* The ARB_get_program_binary spec says:
+    *
+    *     "If <bufSize> is less than the number of bytes that would be
+    *     written to <binary>, an INVALID_OPERATION error is generated."
+    */
+   const GLsizei binary_length = _mesa_glsl_program_binary_length(shProg);
+   if (binary_length == 0 || bufSize < binary_length) {
+      _mesa_error(ctx, GL_INVALID_OPERATION,
+                  "glGetProgramBinary(bufSize < %d)", binary_length);
+      *length = 0;
+      return;
+   }
 
-   (void) binaryFormat;
-   (void) binary;
+   _mesa_glsl_get_program_binary(ctx, shProg, binary);
+   *binaryFormat = GL_PROGRAM_BINARY_FORMAT_MESA;
+   *length = binary_length;
 }
 
 void GLAPIENTRY
@@ -2026,9 +2223,6 @@ _mesa_ProgramBinary(GLuint program, GLenum binaryFormat,
    if (!shProg)
       return;
 
-   (void) binaryFormat;
-   (void) binary;
-
    /* Section 2.3.1 (Errors) of the OpenGL 4.5 spec says:
     *
     *     "If a negative number is provided where an argument of type sizei or
@@ -2048,11 +2242,31 @@ _mesa_ProgramBinary(GLuint program, GLenum binaryFormat,
     *     setting the LINK_STATUS of <program> to FALSE, if these conditions
     *     are not met."
     *
-    * Since any value of binaryFormat passed "is not one of those specified as
-    * allowable for [this] command, an INVALID_ENUM error is generated."
+    * Only a binaryFormat other than ours is an error; a binary that doesn't
+    * load just makes the link fail.
     */
-   shProg->data->LinkStatus = GL_FALSE;
-   _mesa_error(ctx, GL_INVALID_ENUM, "glProgramBinary");
+   if (binaryFormat != GL_PROGRAM_BINARY_FORMAT_MESA) {
+      shProg->data->LinkStatus = GL_FALSE;
+      _mesa_error(ctx, GL_INVALID_ENUM, "glProgramBinary(binaryFormat)");
+      return;
+   }
+
+   /* Loading a binary replaces the program like glLinkProgram does. */
+   if (_mesa_transform_feedback_is_using_program(ctx, shProg)) {
+      _mesa_error(ctx, GL_INVALID_OPERATION,
+                  "glProgramBinary(transform feedback is using the program)");
+      return;
+   }
+
+   FLUSH_VERTICES(ctx, _NEW_PROGRAM);
+
+   _mesa_glsl_program_binary(ctx, shProg, binary, length);
+
+   if (shProg->data->LinkStatus == GL_FALSE &&
+       (ctx->_Shader->Flags & GLSL_REPORT_ERRORS)) {
+      _mesa_debug(ctx, "Error loading binary of program %u:\n%s\n",
+                  shProg->Name, shProg->data->InfoLog);
+   }
 }
 
 
@@ -93,6 +93,7 @@ static void
 _mesa_init_shader(struct gl_shader *shader)
 {
    shader->RefCount = 1;
+   util_queue_fence_init(&shader->CompileFence);
    shader->info.Geom.VerticesOut = -1;
    shader->info.Geom.InputType = GL_TRIANGLES;
    shader->info.Geom.OutputType = GL_TRIANGLE_STRIP;
@@ -140,6 +141,8 @@ _mesa_new_linked_shader(gl_shader_stage stage)
 void
 _mesa_delete_shader(struct gl_context *ctx, struct gl_shader *sh)
 {
+   _mesa_wait_shader_compile(sh);
+   util_queue_fence_destroy(&sh->CompileFence);
    free((void *)sh->Source);
    free(sh->Label);
    ralloc_free(sh);
@@ -350,6 +353,10 @@ _mesa_clear_shader_program_data(struct gl_context *ctx,
 
    shProg->data->linked_stages = 0;
 
+   ralloc_free(shProg->data->Binary);
+   shProg->data->Binary = NULL;
+   shProg->data->BinarySize = 0;
+
    if (shProg->data->UniformStorage) {
       for (unsigned i = 0; i < shProg->data->NumUniformStorage; ++i)
          _mesa_uniform_detach_all_driver_storage(&shProg->data->
@@ -357,6 +364,8 @@ _mesa_clear_shader_program_data(struct gl_context *ctx,
       ralloc_free(shProg->data->UniformStorage);
       shProg->data->NumUniformStorage = 0;
       shProg->data->UniformStorage = NULL;
+      shProg->data->NumUniformDataSlots = 0;
+      shProg->data->UniformDataSlots = NULL;
    }
 
    if (shProg->UniformRemapTable) {
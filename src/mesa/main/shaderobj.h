@@ -83,6 +83,17 @@ _mesa_reference_shader_program(struct gl_context *ctx,
 extern struct gl_shader *
 _mesa_new_shader(GLuint name, gl_shader_stage type);
 
+/**
+ * Wait for a background compile of \c sh started by glCompileShader, if
+ * any.  Must be called before looking at the results of compiling \c sh or
+ * changing its source.
+ */
+static inline void
+_mesa_wait_shader_compile(struct gl_shader *sh)
+{
+   util_queue_job_wait(&sh->CompileFence);
+}
+
 extern struct gl_linked_shader *
 _mesa_new_linked_shader(gl_shader_stage type);
 
@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "main/formats.h"
+#include "main/sse_format.h"
+#include <smmintrin.h>
+#include <stdint.h>
+
+/**
+ * Swizzles 8-bit pixels of three or four channels to four channels, like
+ * _mesa_swizzle_and_convert() with both types MESA_ARRAY_FORMAT_TYPE_UBYTE,
+ * four pixels at a time.  This covers RGBA8 <-> BGRA8 swaps and RGB8 to
+ * RGBX8 or BGRX8 expansion.
+ *
+ * Only whole groups of pixels are converted, without reading past the end
+ * of \p src.
+ *
+ * \param one    the value written for MESA_FORMAT_SWIZZLE_ONE
+ * \return       the number of pixels converted; the caller converts the
+ *               rest
+ */
+int
+_mesa_ubyte_swizzle_to_rgba_sse41(uint8_t *dst, const uint8_t *src,
+                                  int num_src_channels,
+                                  const uint8_t swizzle[4], uint8_t one,
+                                  int count)
+{
+   uint8_t shuffle[16] __attribute__ ((aligned (16)));
+   uint8_t constant[16] __attribute__ ((aligned (16)));
+   /* Each group reads 16 source bytes, which is more than four pixels of
+    * three channels.
+    */
+   const int group_read = num_src_channels == 3 ? 6 : 4;
+   __m128i shuffle4, constant4;
+   int i, c;
+
+   for (i = 0; i < 4; i++) {
+      for (c = 0; c < 4; c++) {
+         const uint8_t swz = swizzle[c];
+
+         /* pshufb writes zero for indices with the top bit set, which takes
+          * care of MESA_FORMAT_SWIZZLE_ZERO and NONE.
+          */
+         shuffle[i * 4 + c] = swz < num_src_channels ?
+                              i * num_src_channels + swz : 0x80;
+         constant[i * 4 + c] = swz == MESA_FORMAT_SWIZZLE_ONE ? one : 0;
+      }
+   }
+
+   shuffle4 = _mm_load_si128((const __m128i *) shuffle);
+   constant4 = _mm_load_si128((const __m128i *) constant);
+
+   for (i = 0; i + group_read <= count; i += 4) {
+      __m128i pixels =
+         _mm_loadu_si128((const __m128i *) (src + i * num_src_channels));
+
+      pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle4), constant4);
+      _mm_storeu_si128((__m128i *) (dst + i * 4), pixels);
+   }
+
+   return i;
+}
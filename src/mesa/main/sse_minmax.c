@@ -92,3 +92,65 @@ _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
    *min_index = min_ui;
    *max_index = max_ui;
 }
+
+void
+_mesa_ushort_array_min_max(const unsigned short *us_indices,
+                           unsigned *min_index, unsigned *max_index,
+                           const unsigned count)
+{
+   unsigned short max_us = 0;
+   unsigned short min_us = 0xffff;
+   unsigned i = 0;
+   unsigned aligned_count = count;
+
+   /* handle the first few values without SSE until the pointer is aligned */
+   while (((uintptr_t)us_indices & 15) && aligned_count) {
+      if (*us_indices > max_us)
+         max_us = *us_indices;
+      if (*us_indices < min_us)
+         min_us = *us_indices;
+
+      aligned_count--;
+      us_indices++;
+   }
+
+   if (aligned_count >= 16) {
+      unsigned short max_arr[8] __attribute__ ((aligned (16)));
+      unsigned short min_arr[8] __attribute__ ((aligned (16)));
+      unsigned vec_count;
+      __m128i max_us8 = _mm_setzero_si128();
+      __m128i min_us8 = _mm_set1_epi16(-1);
+      __m128i us_indices8;
+      __m128i *us_indices_ptr;
+
+      vec_count = aligned_count & ~0x7;
+      us_indices_ptr = (__m128i *)us_indices;
+      for (i = 0; i < vec_count / 8; i++) {
+         us_indices8 = _mm_load_si128(&us_indices_ptr[i]);
+         max_us8 = _mm_max_epu16(us_indices8, max_us8);
+         min_us8 = _mm_min_epu16(us_indices8, min_us8);
+      }
+
+      _mm_store_si128((__m128i *)max_arr, max_us8);
+      _mm_store_si128((__m128i *)min_arr, min_us8);
+
+      for (i = 0; i < 8; i++) {
+         if (max_arr[i] > max_us)
+            max_us = max_arr[i];
+         if (min_arr[i] < min_us)
+            min_us = min_arr[i];
+      }
+      i = vec_count;
+   }
+
+   for (; i < aligned_count; i++) {
+      if (us_indices[i] > max_us)
+         max_us = us_indices[i];
+      if (us_indices[i] < min_us)
+         min_us = us_indices[i];
+   }
+
+   /* Match the scalar loop, which starts with ~0U for the minimum. */
+   *min_index = count ? min_us : ~0U;
+   *max_index = max_us;
+}
@@ -28,3 +28,8 @@
 void
 _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
                          unsigned *max_index, const unsigned count);
+
+void
+_mesa_ushort_array_min_max(const unsigned short *us_indices,
+                           unsigned *min_index, unsigned *max_index,
+                           const unsigned count);
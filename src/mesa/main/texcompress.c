@@ -30,6 +30,9 @@
  */
 
 
+#ifdef HAVE_PTHREAD
+#include <unistd.h>
+#endif
 #include "glheader.h"
 #include "imports.h"
 #include "context.h"
@@ -42,6 +45,7 @@
 #include "texcompress_s3tc.h"
 #include "texcompress_etc.h"
 #include "texcompress_bptc.h"
+#include "util/u_queue.h"
 
 
 /**
@@ -911,36 +915,134 @@ _mesa_get_compressed_fetch_func(mesa_format format)
 }
 
 
+/** Maximum number of threads compressing or decompressing images */
+#define MAX_TEXCOMPRESS_THREADS 7
+
+/**
+ * Return the queue used to split up texture compression, decompression and
+ * texstore format conversion, starting its threads if needed, or NULL if all the work has to stay on the
+ * calling thread.
+ */
+struct util_queue *
+_mesa_get_texcompress_queue(struct gl_context *ctx)
+{
+   if (!util_queue_is_initialized(&ctx->TexCompressQueue)) {
+      unsigned num_threads = 0;
+
+#if defined(HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+      long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+      /* The calling thread takes a share of the work too. */
+      if (cpus > 1)
+         num_threads = MIN2(cpus - 1, MAX_TEXCOMPRESS_THREADS);
+#endif
+
+      if (num_threads == 0 ||
+          !util_queue_init(&ctx->TexCompressQueue, "texcompress", 16,
+                           num_threads))
+         return NULL;
+   }
+
+   return &ctx->TexCompressQueue;
+}
+
+
+void
+_mesa_free_texcompress_queue(struct gl_context *ctx)
+{
+   if (!util_queue_is_initialized(&ctx->TexCompressQueue))
+      return;
+
+   util_queue_destroy(&ctx->TexCompressQueue);
+   memset(&ctx->TexCompressQueue, 0, sizeof(ctx->TexCompressQueue));
+}
+
+
+struct decompress_image_job {
+   mesa_format format;
+   compressed_fetch_func fetch;
+   GLuint width, height, bh;
+   const GLubyte *src;
+   GLint srcRowStride;
+   GLint stride;
+   GLfloat *dest;
+};
+
+/* Decompresses the block rows [start, end). */
+static void
+decompress_block_rows(void *data, unsigned start, unsigned end)
+{
+   const struct decompress_image_job *job = data;
+   GLuint y0 = start * job->bh;
+   GLuint y1 = MIN2(end * job->bh, job->height);
+   GLfloat *dest = job->dest + y0 * job->width * 4;
+   GLuint i, j;
+
+   switch (_mesa_get_format_layout(job->format)) {
+   case MESA_FORMAT_LAYOUT_RGTC:
+   case MESA_FORMAT_LAYOUT_LATC:
+      _mesa_unpack_rgtc(job->format, job->width, y1 - y0,
+                        job->src + start * job->srcRowStride,
+                        job->srcRowStride, dest);
+      return;
+   default:
+      break;
+   }
+
+   for (j = y0; j < y1; j++) {
+      for (i = 0; i < job->width; i++) {
+         job->fetch(job->src, job->stride, i, j, dest);
+         dest += 4;
+      }
+   }
+}
+
+
 /**
  * Decompress a compressed texture image, returning a GL_RGBA/GL_FLOAT image.
+ *
+ * Large images are split into bands of block rows which are decompressed in
+ * parallel.
+ *
  * \param srcRowStride  stride in bytes between rows of blocks in the
  *                      compressed source image.
  */
 void
-_mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
+_mesa_decompress_image(struct gl_context *ctx,
+                       mesa_format format, GLuint width, GLuint height,
                        const GLubyte *src, GLint srcRowStride,
                        GLfloat *dest)
 {
-   compressed_fetch_func fetch;
-   GLuint i, j;
-   GLuint bytes, bw, bh;
-   GLint stride;
+   struct decompress_image_job job;
+   GLuint bytes, bw, bh, block_rows;
+   struct util_queue *queue = NULL;
 
    bytes = _mesa_get_format_bytes(format);
    _mesa_get_format_block_size(format, &bw, &bh);
 
-   fetch = _mesa_get_compressed_fetch_func(format);
-   if (!fetch) {
+   job.fetch = _mesa_get_compressed_fetch_func(format);
+   if (!job.fetch) {
       _mesa_problem(NULL, "Unexpected format in _mesa_decompress_image()");
       return;
    }
- 
-   stride = srcRowStride * bh / bytes;
 
-   for (j = 0; j < height; j++) {
-      for (i = 0; i < width; i++) {
-         fetch(src, stride, i, j, dest);
-         dest += 4;
-      }
-   }
+   job.format = format;
+   job.width = width;
+   job.height = height;
+   job.bh = bh;
+   job.src = src;
+   job.srcRowStride = srcRowStride;
+   job.stride = srcRowStride * bh / bytes;
+   job.dest = dest;
+
+   block_rows = DIV_ROUND_UP(height, bh);
+
+   /* Don't start threads for images which are decoded quickly anyway. */
+   if (width * height >= TEXCOMPRESS_PARALLEL_MIN_TEXELS)
+      queue = _mesa_get_texcompress_queue(ctx);
+
+   util_queue_run_range(queue, block_rows,
+                        DIV_ROUND_UP(TEXCOMPRESS_PARALLEL_MIN_TEXELS / 4,
+                                     width * bh),
+                        decompress_block_rows, &job);
 }
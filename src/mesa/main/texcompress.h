@@ -29,6 +29,13 @@
 #include "glheader.h"
 
 struct gl_context;
+struct util_queue;
+
+/**
+ * Images with fewer texels than this are compressed and decompressed on the
+ * calling thread only.
+ */
+#define TEXCOMPRESS_PARALLEL_MIN_TEXELS (256 * 256)
 
 extern GLenum
 _mesa_gl_compressed_format_base_format(GLenum format);
@@ -58,8 +65,15 @@ extern compressed_fetch_func
 _mesa_get_compressed_fetch_func(mesa_format format);
 
 
+extern struct util_queue *
+_mesa_get_texcompress_queue(struct gl_context *ctx);
+
+extern void
+_mesa_free_texcompress_queue(struct gl_context *ctx);
+
 extern void
-_mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
+_mesa_decompress_image(struct gl_context *ctx,
+                       mesa_format format, GLuint width, GLuint height,
                        const GLubyte *src, GLint srcRowStride,
                        GLfloat *dest);
 
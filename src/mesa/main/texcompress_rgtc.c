@@ -40,6 +40,7 @@
 #include "mipmap.h"
 #include "texcompress.h"
 #include "util/rgtc.h"
+#include "util/u_queue.h"
 #include "texcompress_rgtc.h"
 #include "texstore.h"
 
@@ -72,17 +73,98 @@ static void extractsrc_s( GLbyte srcpixels[4][4], const GLfloat *srcaddr,
 }
 
 
+/** Compression of a whole temporary image, split up in block rows. */
+struct rgtc_compress_job {
+   const void *tempImage;      /**< GLubyte or GLfloat texels */
+   GLint srcWidth, srcHeight;
+   GLint comps;                /**< 1 for RGTC1, 2 for RGTC2 */
+   GLboolean is_signed;
+   GLubyte *dst;
+   GLint blockRowStride;
+};
+
+/* Compresses the block rows [start, end) of the job. */
+static void
+compress_rgtc_block_rows(void *data, unsigned start, unsigned end)
+{
+   const struct rgtc_compress_job *job = data;
+   const GLint srcWidth = job->srcWidth, comps = job->comps;
+   int i, j, c;
+   int numxpixels, numypixels;
+   unsigned jb;
+
+   for (jb = start; jb < end; jb++) {
+      GLubyte *blkaddr = job->dst + jb * job->blockRowStride;
+
+      j = jb * 4;
+      if (job->srcHeight > j + 3) numypixels = 4;
+      else numypixels = job->srcHeight - j;
+
+      for (i = 0; i < srcWidth; i += 4) {
+	 if (srcWidth > i + 3) numxpixels = 4;
+	 else numxpixels = srcWidth - i;
+
+	 for (c = 0; c < comps; c++) {
+	    if (job->is_signed) {
+	       const GLfloat *srcaddr = (const GLfloat *) job->tempImage +
+		  (j * srcWidth + i) * comps + c;
+	       GLbyte srcpixels[4][4];
+
+	       extractsrc_s(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, comps);
+	       util_format_signed_encode_rgtc_ubyte((GLbyte *) blkaddr, srcpixels, numxpixels, numypixels);
+	    } else {
+	       const GLubyte *srcaddr = (const GLubyte *) job->tempImage +
+		  (j * srcWidth + i) * comps + c;
+	       GLubyte srcpixels[4][4];
+
+	       extractsrc_u(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, comps);
+	       util_format_unsigned_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
+	    }
+	    blkaddr += 8;
+	 }
+      }
+   }
+}
+
+/**
+ * Compress the R or RG temporary image to dst, splitting large images up
+ * between the texture compression threads.
+ */
+static void
+compress_rgtc_image(struct gl_context *ctx, const void *tempImage,
+                    GLint srcWidth, GLint srcHeight, GLint comps,
+                    GLboolean is_signed, GLubyte *dst, GLint dstRowStride)
+{
+   struct rgtc_compress_job job;
+   const GLint rowBytes = ((srcWidth + 3) & ~3) * 2 * comps;
+   const GLint dstRowDiff = dstRowStride >= (srcWidth * 2 * comps) ?
+                            dstRowStride - rowBytes : 0;
+   struct util_queue *queue = NULL;
+
+   job.tempImage = tempImage;
+   job.srcWidth = srcWidth;
+   job.srcHeight = srcHeight;
+   job.comps = comps;
+   job.is_signed = is_signed;
+   job.dst = dst;
+   job.blockRowStride = rowBytes + dstRowDiff;
+
+   if (srcWidth * srcHeight >= TEXCOMPRESS_PARALLEL_MIN_TEXELS)
+      queue = _mesa_get_texcompress_queue(ctx);
+
+   util_queue_run_range(queue, (srcHeight + 3) / 4,
+                        DIV_ROUND_UP(TEXCOMPRESS_PARALLEL_MIN_TEXELS / 4,
+                                     srcWidth * 4),
+                        compress_rgtc_block_rows, &job);
+}
+
+
 GLboolean
 _mesa_texstore_red_rgtc1(TEXSTORE_PARAMS)
 {
    GLubyte *dst;
    const GLubyte *tempImage = NULL;
-   int i, j;
-   int numxpixels, numypixels;
-   const GLubyte *srcaddr;
-   GLubyte srcpixels[4][4];
-   GLubyte *blkaddr;
-   GLint dstRowDiff, redRowStride;
+   GLint redRowStride;
    GLubyte *tempImageSlices[1];
 
    assert(dstFormat == MESA_FORMAT_R_RGTC1_UNORM ||
@@ -103,22 +185,8 @@ _mesa_texstore_red_rgtc1(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   blkaddr = dst;
-   dstRowDiff = dstRowStride >= (srcWidth * 2) ? dstRowStride - (((srcWidth + 3) & ~3) * 2) : 0;
-   for (j = 0; j < srcHeight; j+=4) {
-      if (srcHeight > j + 3) numypixels = 4;
-      else numypixels = srcHeight - j;
-      srcaddr = tempImage + j * srcWidth;
-      for (i = 0; i < srcWidth; i += 4) {
-	 if (srcWidth > i + 3) numxpixels = 4;
-	 else numxpixels = srcWidth - i;
-	 extractsrc_u(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, 1);
-	 util_format_unsigned_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-	 srcaddr += numxpixels;
-	 blkaddr += 8;
-      }
-      blkaddr += dstRowDiff;
-   }
+   compress_rgtc_image(ctx, tempImage, srcWidth, srcHeight, 1, GL_FALSE,
+                       dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -130,12 +198,7 @@ _mesa_texstore_signed_red_rgtc1(TEXSTORE_PARAMS)
 {
    GLbyte *dst;
    const GLfloat *tempImage = NULL;
-   int i, j;
-   int numxpixels, numypixels;
-   const GLfloat *srcaddr;
-   GLbyte srcpixels[4][4];
-   GLbyte *blkaddr;
-   GLint dstRowDiff, redRowStride;
+   GLint redRowStride;
    GLfloat *tempImageSlices[1];
 
    assert(dstFormat == MESA_FORMAT_R_RGTC1_SNORM ||
@@ -156,22 +219,8 @@ _mesa_texstore_signed_red_rgtc1(TEXSTORE_PARAMS)
 
    dst = (GLbyte *) dstSlices[0];
 
-   blkaddr = dst;
-   dstRowDiff = dstRowStride >= (srcWidth * 2) ? dstRowStride - (((srcWidth + 3) & ~3) * 2) : 0;
-   for (j = 0; j < srcHeight; j+=4) {
-      if (srcHeight > j + 3) numypixels = 4;
-      else numypixels = srcHeight - j;
-      srcaddr = tempImage + j * srcWidth;
-      for (i = 0; i < srcWidth; i += 4) {
-	 if (srcWidth > i + 3) numxpixels = 4;
-	 else numxpixels = srcWidth - i;
-	 extractsrc_s(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, 1);
-	 util_format_signed_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-	 srcaddr += numxpixels;
-	 blkaddr += 8;
-      }
-      blkaddr += dstRowDiff;
-   }
+   compress_rgtc_image(ctx, tempImage, srcWidth, srcHeight, 1, GL_TRUE,
+                       (GLubyte *) dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -183,12 +232,7 @@ _mesa_texstore_rg_rgtc2(TEXSTORE_PARAMS)
 {
    GLubyte *dst;
    const GLubyte *tempImage = NULL;
-   int i, j;
-   int numxpixels, numypixels;
-   const GLubyte *srcaddr;
-   GLubyte srcpixels[4][4];
-   GLubyte *blkaddr;
-   GLint dstRowDiff, rgRowStride;
+   GLint rgRowStride;
    mesa_format tempFormat;
    GLubyte *tempImageSlices[1];
 
@@ -217,28 +261,8 @@ _mesa_texstore_rg_rgtc2(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   blkaddr = dst;
-   dstRowDiff = dstRowStride >= (srcWidth * 4) ? dstRowStride - (((srcWidth + 3) & ~3) * 4) : 0;
-   for (j = 0; j < srcHeight; j+=4) {
-      if (srcHeight > j + 3) numypixels = 4;
-      else numypixels = srcHeight - j;
-      srcaddr = tempImage + j * srcWidth * 2;
-      for (i = 0; i < srcWidth; i += 4) {
-	 if (srcWidth > i + 3) numxpixels = 4;
-	 else numxpixels = srcWidth - i;
-	 extractsrc_u(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, 2);
-	 util_format_unsigned_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-
-	 blkaddr += 8;
-	 extractsrc_u(srcpixels, (GLubyte *)srcaddr + 1, srcWidth, numxpixels, numypixels, 2);
-	 util_format_unsigned_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-
-	 blkaddr += 8;
-
-	 srcaddr += numxpixels * 2;
-      }
-      blkaddr += dstRowDiff;
-   }
+   compress_rgtc_image(ctx, tempImage, srcWidth, srcHeight, 2, GL_FALSE,
+                       dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -250,12 +274,7 @@ _mesa_texstore_signed_rg_rgtc2(TEXSTORE_PARAMS)
 {
    GLbyte *dst;
    const GLfloat *tempImage = NULL;
-   int i, j;
-   int numxpixels, numypixels;
-   const GLfloat *srcaddr;
-   GLbyte srcpixels[4][4];
-   GLbyte *blkaddr;
-   GLint dstRowDiff, rgRowStride;
+   GLint rgRowStride;
    mesa_format tempFormat;
    GLfloat *tempImageSlices[1];
 
@@ -282,29 +301,8 @@ _mesa_texstore_signed_rg_rgtc2(TEXSTORE_PARAMS)
 
    dst = (GLbyte *) dstSlices[0];
 
-   blkaddr = dst;
-   dstRowDiff = dstRowStride >= (srcWidth * 4) ? dstRowStride - (((srcWidth + 3) & ~3) * 4) : 0;
-   for (j = 0; j < srcHeight; j += 4) {
-      if (srcHeight > j + 3) numypixels = 4;
-      else numypixels = srcHeight - j;
-      srcaddr = tempImage + j * srcWidth * 2;
-      for (i = 0; i < srcWidth; i += 4) {
-	 if (srcWidth > i + 3) numxpixels = 4;
-	 else numxpixels = srcWidth - i;
-
-	 extractsrc_s(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, 2);
-	 util_format_signed_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-	 blkaddr += 8;
-
-	 extractsrc_s(srcpixels, srcaddr + 1, srcWidth, numxpixels, numypixels, 2);
-	 util_format_signed_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-	 blkaddr += 8;
-
-	 srcaddr += numxpixels * 2;
-
-      }
-      blkaddr += dstRowDiff;
-   }
+   compress_rgtc_image(ctx, tempImage, srcWidth, srcHeight, 2, GL_TRUE,
+                       (GLubyte *) dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -432,6 +430,76 @@ fetch_signed_la_latc2(const GLubyte *map,
 }
 
 
+/**
+ * Decompress height rows of an RGTC/LATC image to RGBA float, with the same
+ * results as the fetch functions above, but decoding each block only once.
+ * src points at the block row containing the first row, and dest is a
+ * packed image of width texels per row.
+ */
+void
+_mesa_unpack_rgtc(mesa_format format, GLuint width, GLuint height,
+                  const GLubyte *src, GLint srcRowStride, GLfloat *dest)
+{
+   const GLboolean is_signed = _mesa_get_format_datatype(format) ==
+                               GL_SIGNED_NORMALIZED;
+   const GLboolean is_latc =
+      _mesa_get_format_layout(format) == MESA_FORMAT_LAYOUT_LATC;
+   const GLuint comps = _mesa_get_format_bytes(format) / 8;
+   GLfloat table[256];
+   GLuint i, j, x, y, c;
+
+   /* Build the conversion of all the possible channel values. */
+   for (i = 0; i < 256; i++) {
+      if (!is_signed)
+         table[i] = UBYTE_TO_FLOAT(i);
+      else if (format == MESA_FORMAT_L_LATC1_SNORM)
+         table[i] = BYTE_TO_FLOAT((GLbyte) i);
+      else
+         table[i] = BYTE_TO_FLOAT_TEX((GLbyte) i);
+   }
+
+   for (y = 0; y < height; y += 4) {
+      const GLubyte *blkaddr = src + (y / 4) * srcRowStride;
+
+      for (x = 0; x < width; x += 4) {
+         GLubyte texels[2][16];
+
+         for (c = 0; c < comps; c++) {
+            if (is_signed)
+               util_format_signed_decode_block_rgtc((const GLbyte *) blkaddr,
+                                                    (GLbyte *) texels[c]);
+            else
+               util_format_unsigned_decode_block_rgtc(blkaddr, texels[c]);
+            blkaddr += 8;
+         }
+
+         for (j = 0; j < MIN2(4, height - y); j++) {
+            GLfloat *texel = dest + ((y + j) * width + x) * 4;
+
+            for (i = 0; i < MIN2(4, width - x); i++) {
+               const GLfloat red = table[texels[0][j * 4 + i]];
+               const GLfloat green =
+                  comps == 2 ? table[texels[1][j * 4 + i]] : 0.0F;
+
+               if (is_latc) {
+                  texel[RCOMP] =
+                  texel[GCOMP] =
+                  texel[BCOMP] = red;
+                  texel[ACOMP] = comps == 2 ? green : 1.0F;
+               } else {
+                  texel[RCOMP] = red;
+                  texel[GCOMP] = green;
+                  texel[BCOMP] = 0.0F;
+                  texel[ACOMP] = 1.0F;
+               }
+               texel += 4;
+            }
+         }
+      }
+   }
+}
+
+
 compressed_fetch_func
 _mesa_get_compressed_rgtc_func(mesa_format format)
 {
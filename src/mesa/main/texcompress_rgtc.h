@@ -43,5 +43,9 @@ _mesa_texstore_signed_rg_rgtc2(TEXSTORE_PARAMS);
 extern compressed_fetch_func
 _mesa_get_compressed_rgtc_func(mesa_format format);
 
+extern void
+_mesa_unpack_rgtc(mesa_format format, GLuint width, GLuint height,
+                  const GLubyte *src, GLint srcRowStride, GLfloat *dest);
+
 
 #endif
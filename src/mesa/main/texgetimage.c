@@ -341,7 +341,7 @@ get_tex_rgba_compressed(struct gl_context *ctx, GLuint dimensions,
                                   GL_MAP_READ_BIT,
                                   &srcMap, &srcRowStride);
       if (srcMap) {
-         _mesa_decompress_image(texFormat, width, height,
+         _mesa_decompress_image(ctx, texFormat, width, height,
                                 srcMap, srcRowStride, tempSlice);
 
          ctx->Driver.UnmapTextureImage(ctx, texImage, zoffset + slice);
@@ -34,6 +34,7 @@
 #include "context.h"
 #include "enums.h"
 #include "macros.h"
+#include "texcompress.h"
 #include "texobj.h"
 #include "teximage.h"
 #include "texstate.h"
@@ -947,6 +948,8 @@ _mesa_free_texture_data(struct gl_context *ctx)
    for (u = 0; u < ARRAY_SIZE(ctx->Texture.Unit); u++) {
       _mesa_reference_sampler_object(ctx, &ctx->Texture.Unit[u].Sampler, NULL);
    }
+
+   _mesa_free_texcompress_queue(ctx);
 }
 
 
@@ -75,6 +75,7 @@
 #include "pixeltransfer.h"
 #include "util/format_rgb9e5.h"
 #include "util/format_r11g11b10f.h"
+#include "util/u_queue.h"
 
 
 enum {
@@ -669,6 +670,64 @@ texstore_compressed(TEXSTORE_PARAMS)
                            srcFormat, srcType, srcAddr, srcPacking);
 }
 
+struct convert_image_job {
+   GLubyte *dst;
+   uint32_t dstFormat;
+   GLint dstRowStride;
+   const GLubyte *src;
+   uint32_t srcFormat;
+   GLint srcRowStride;
+   GLint width;
+   uint8_t *rebaseSwizzle;
+};
+
+/* Converts the rows [start, end). */
+static void
+convert_image_rows(void *data, unsigned start, unsigned end)
+{
+   const struct convert_image_job *job = data;
+
+   _mesa_format_convert(job->dst + (ptrdiff_t) start * job->dstRowStride,
+                        job->dstFormat, job->dstRowStride,
+                        (GLubyte *) job->src +
+                        (ptrdiff_t) start * job->srcRowStride,
+                        job->srcFormat, job->srcRowStride,
+                        job->width, end - start, job->rebaseSwizzle);
+}
+
+/**
+ * _mesa_format_convert() for a 2D image.  Large images are split into bands
+ * of rows which are converted in parallel by the texture compression
+ * threads.
+ */
+static void
+convert_image(struct gl_context *ctx,
+              void *dst, uint32_t dstFormat, GLint dstRowStride,
+              const void *src, uint32_t srcFormat, GLint srcRowStride,
+              GLint width, GLint height, uint8_t *rebaseSwizzle)
+{
+   struct convert_image_job job;
+   struct util_queue *queue = NULL;
+
+   job.dst = dst;
+   job.dstFormat = dstFormat;
+   job.dstRowStride = dstRowStride;
+   job.src = src;
+   job.srcFormat = srcFormat;
+   job.srcRowStride = srcRowStride;
+   job.width = width;
+   job.rebaseSwizzle = rebaseSwizzle;
+
+   /* Don't start threads for images which are converted quickly anyway. */
+   if (width * height >= TEXCOMPRESS_PARALLEL_MIN_TEXELS)
+      queue = _mesa_get_texcompress_queue(ctx);
+
+   util_queue_run_range(queue, height,
+                        DIV_ROUND_UP(TEXCOMPRESS_PARALLEL_MIN_TEXELS / 4,
+                                     width),
+                        convert_image_rows, &job);
+}
+
 static GLboolean
 texstore_rgba(TEXSTORE_PARAMS)
 {
@@ -771,9 +830,9 @@ texstore_rgba(TEXSTORE_PARAMS)
       src = (GLubyte *) srcAddr;
       dst = (GLubyte *) tempRGBA;
       for (img = 0; img < srcDepth; img++) {
-         _mesa_format_convert(dst, RGBA32_FLOAT, 4 * srcWidth * sizeof(float),
-                              src, srcMesaFormat, srcRowStride,
-                              srcWidth, srcHeight, NULL);
+         convert_image(ctx, dst, RGBA32_FLOAT, 4 * srcWidth * sizeof(float),
+                       src, srcMesaFormat, srcRowStride,
+                       srcWidth, srcHeight, NULL);
          src += srcHeight * srcRowStride;
          dst += srcHeight * 4 * srcWidth * sizeof(float);
       }
@@ -806,10 +865,10 @@ texstore_rgba(TEXSTORE_PARAMS)
    }
 
    for (img = 0; img < srcDepth; img++) {
-      _mesa_format_convert(dstSlices[img], dstFormat, dstRowStride,
-                           src, srcMesaFormat, srcRowStride,
-                           srcWidth, srcHeight,
-                           needRebase ? rebaseSwizzle : NULL);
+      convert_image(ctx, dstSlices[img], dstFormat, dstRowStride,
+                    src, srcMesaFormat, srcRowStride,
+                    srcWidth, srcHeight,
+                    needRebase ? rebaseSwizzle : NULL);
       src += srcHeight * srcRowStride;
    }
 
@@ -46,6 +46,7 @@
 #include "compiler/glsl_types.h"
 #include "compiler/glsl/linker.h"
 #include "compiler/glsl/program.h"
+#include "compiler/glsl/shader_cache.h"
 #include "program/prog_instruction.h"
 #include "program/prog_optimize.h"
 #include "program/prog_print.h"
@@ -3080,4 +3081,77 @@ _mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
    }
 }
 
+/**
+ * Binaries of GL_PROGRAM_BINARY_FORMAT_MESA start with the hash of the
+ * build and context state they were linked with, followed by the linked
+ * program as serialized by shader_cache_serialize_program().
+ */
+#define PROGRAM_BINARY_HEADER_SIZE 20
+
+/**
+ * Return the size of the binary of \c prog, or 0 if it has none.
+ */
+GLsizei
+_mesa_glsl_program_binary_length(const struct gl_shader_program *prog)
+{
+   if (!prog->data->LinkStatus || prog->data->Binary == NULL)
+      return 0;
+
+   return PROGRAM_BINARY_HEADER_SIZE + prog->data->BinarySize;
+}
+
+/**
+ * Write the binary of \c prog to \c binary, which must have room for
+ * _mesa_glsl_program_binary_length() bytes.
+ */
+void
+_mesa_glsl_get_program_binary(struct gl_context *ctx,
+                              struct gl_shader_program *prog, void *binary)
+{
+   uint8_t *dst = (uint8_t *) binary;
+
+   shader_cache_compute_driver_sha1(ctx, dst);
+   memcpy(dst + PROGRAM_BINARY_HEADER_SIZE, prog->data->Binary,
+          prog->data->BinarySize);
+}
+
+/**
+ * Load a binary returned by glGetProgramBinary.  Called via
+ * glProgramBinary().
+ *
+ * Binaries from another build, driver or context configuration, as well as
+ * malformed ones, make the link fail; the application is then expected to
+ * link the program from source again.
+ */
+void
+_mesa_glsl_program_binary(struct gl_context *ctx,
+                          struct gl_shader_program *prog,
+                          const void *binary, GLsizei length)
+{
+   const uint8_t *src = (const uint8_t *) binary;
+   unsigned char sha1[20];
+
+   _mesa_clear_shader_program_data(ctx, prog);
+
+   prog->data->LinkStatus = GL_TRUE;
+
+   shader_cache_compute_driver_sha1(ctx, sha1);
+   if (length <= PROGRAM_BINARY_HEADER_SIZE ||
+       memcmp(src, sha1, sizeof(sha1)) != 0) {
+      linker_error(prog, "program binary is not compatible with this "
+                   "driver\n");
+      return;
+   }
+
+   if (!shader_cache_deserialize_program(ctx, prog,
+                                         src + PROGRAM_BINARY_HEADER_SIZE,
+                                         length - PROGRAM_BINARY_HEADER_SIZE)) {
+      linker_error(prog, "invalid program binary\n");
+      return;
+   }
+
+   if (!ctx->Driver.LinkShader(ctx, prog))
+      prog->data->LinkStatus = GL_FALSE;
+}
+
 } /* extern "C" */
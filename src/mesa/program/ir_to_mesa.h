@@ -36,6 +36,18 @@ struct gl_shader_program;
 void _mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog);
 GLboolean _mesa_ir_link_shader(struct gl_context *ctx, struct gl_shader_program *prog);
 
+GLsizei
+_mesa_glsl_program_binary_length(const struct gl_shader_program *prog);
+
+void
+_mesa_glsl_get_program_binary(struct gl_context *ctx,
+                              struct gl_shader_program *prog, void *binary);
+
+void
+_mesa_glsl_program_binary(struct gl_context *ctx,
+                          struct gl_shader_program *prog,
+                          const void *binary, GLsizei length);
+
 void
 _mesa_generate_parameters_list_for_uniforms(struct gl_shader_program
 					    *shader_program,
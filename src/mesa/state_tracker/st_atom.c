@@ -26,11 +26,14 @@
  **************************************************************************/
 
 
+#include <inttypes.h>
 #include <stdio.h>
 #include "main/glheader.h"
 #include "main/context.h"
 
 #include "pipe/p_defines.h"
+#include "os/os_time.h"
+#include "util/u_debug.h"
 #include "st_context.h"
 #include "st_atom.h"
 #include "st_program.h"
@@ -45,16 +48,84 @@ static const struct st_tracked_state *atoms[] =
 #undef ST_STATE
 };
 
+static const char *atom_names[] =
+{
+#define ST_STATE(FLAG, st_update) #st_update,
+#include "st_atom_list.h"
+#undef ST_STATE
+};
+
+
+/**
+ * Number of calls and total time of each atom, printed when the context is
+ * destroyed.  Enabled with ST_ATOM_STATS=true, which works in release
+ * builds too.
+ */
+struct st_atom_stats {
+   uint64_t validations;        /**< st_validate_state calls with dirty atoms */
+   uint64_t calls[ST_NUM_ATOMS];
+   uint64_t time_ns[ST_NUM_ATOMS];
+};
+
+DEBUG_GET_ONCE_BOOL_OPTION(atom_stats, "ST_ATOM_STATS", FALSE)
+
 
 void st_init_atoms( struct st_context *st )
 {
    STATIC_ASSERT(ARRAY_SIZE(atoms) <= 64);
+   STATIC_ASSERT(ARRAY_SIZE(atoms) == ST_NUM_ATOMS);
+
+   if (debug_get_option_atom_stats())
+      st->atom_stats = CALLOC_STRUCT(st_atom_stats);
 }
 
 
 void st_destroy_atoms( struct st_context *st )
 {
-   /* no-op */
+   struct st_atom_stats *stats = st->atom_stats;
+   uint64_t total_ns = 0;
+   unsigned i;
+
+   if (!stats)
+      return;
+
+   for (i = 0; i < ST_NUM_ATOMS; i++)
+      total_ns += stats->time_ns[i];
+
+   fprintf(stderr, "st: atom statistics, %"PRIu64" validations, "
+           "%"PRIu64" us total\n", stats->validations, total_ns / 1000);
+
+   for (i = 0; i < ST_NUM_ATOMS; i++) {
+      if (!stats->calls[i])
+         continue;
+
+      fprintf(stderr, "  %-32s %10"PRIu64" calls %10"PRIu64" us "
+              "%8"PRIu64" ns/call\n", atom_names[i], stats->calls[i],
+              stats->time_ns[i] / 1000,
+              stats->time_ns[i] / stats->calls[i]);
+   }
+
+   free(stats);
+   st->atom_stats = NULL;
+}
+
+
+static void
+update_atoms_timed(struct st_context *st, uint64_t dirty)
+{
+   struct st_atom_stats *stats = st->atom_stats;
+
+   stats->validations++;
+
+   while (dirty) {
+      unsigned i = u_bit_scan64(&dirty);
+      int64_t start = os_time_get_nano();
+
+      atoms[i]->update(st);
+
+      stats->calls[i]++;
+      stats->time_ns[i] += os_time_get_nano() - start;
+   }
 }
 
 
@@ -200,6 +271,12 @@ void st_validate_state( struct st_context *st, enum st_pipeline pipeline )
    if (!dirty)
       return;
 
+   if (unlikely(st->atom_stats)) {
+      update_atoms_timed(st, dirty);
+      st->dirty &= ~pipeline_mask;
+      return;
+   }
+
    dirty_lo = dirty;
    dirty_hi = dirty >> 32;
 
@@ -48,6 +48,39 @@
 #include "st_program.h"
 #include "st_cb_bufferobjects.h"
 
+/**
+ * Whether \p values are the constants already bound to \p shader_type, in
+ * which case uploading and binding them again can be skipped.  Otherwise,
+ * remember them for the next call.
+ *
+ * The parameter list is dirtied as a whole, and the constants always go to
+ * a new allocation, so this is what avoids re-uploading all of them when
+ * glUniform rewrote the same values or the state parameters didn't change.
+ */
+static bool
+constants_unchanged(struct st_context *st, enum pipe_shader_type shader_type,
+                    const void *values, unsigned size)
+{
+   void **last = &st->state.constants[shader_type].last_values;
+   unsigned *last_size = &st->state.constants[shader_type].last_values_size;
+
+   /* With user buffers, the driver may keep the pointer. */
+   if (st->state.constants[shader_type].ptr == values &&
+       st->state.constants[shader_type].size == size &&
+       *last && memcmp(*last, values, size) == 0)
+      return true;
+
+   if (*last_size < size) {
+      free(*last);
+      *last = malloc(size);
+      *last_size = *last ? size : 0;
+   }
+   if (*last)
+      memcpy(*last, values, size);
+   return false;
+}
+
+
 /**
  * Pass the given program parameters to the graphics pipe as a
  * constant buffer.
@@ -96,6 +129,10 @@ void st_upload_constants( struct st_context *st,
 
       _mesa_shader_write_subroutine_indices(st->ctx, stage);
 
+      if (constants_unchanged(st, shader_type, params->ParameterValues,
+                              paramBytes))
+         return;
+
       /* We always need to get a new buffer, to keep the drivers simple and
        * avoid gratuitous rendering synchronization.
        * Let's use a user buffer to avoid an unnecessary copy.
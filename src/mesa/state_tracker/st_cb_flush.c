@@ -44,6 +44,7 @@
 #include "pipe/p_defines.h"
 #include "pipe/p_screen.h"
 #include "util/u_gen_mipmap.h"
+#include "util/u_upload_mgr.h"
 
 
 /** Check if we have a front color buffer and if it's been drawn to. */
@@ -79,12 +80,34 @@ void st_flush(struct st_context *st,
               struct pipe_fence_handle **fence,
               unsigned flags)
 {
+   struct pipe_screen *screen = st->pipe->screen;
+   struct pipe_fence_handle *local_fence = NULL;
+   int64_t start;
+
    FLUSH_VERTICES(st->ctx, 0);
    FLUSH_CURRENT(st->ctx, 0);
 
    st_flush_bitmap_cache(st);
 
+   /* The uploaders need a fence to know when they can reuse their
+    * buffers.
+    */
+   if (!fence)
+      fence = &local_fence;
+
+   start = st_hud_phase_begin(st);
    st->pipe->flush(st->pipe, fence, flags);
+   st_hud_phase_end(st, HUD_FRAME_PHASE_FLUSH, start);
+
+   if (*fence) {
+      u_upload_fence(st->uploader, *fence);
+      if (st->indexbuf_uploader)
+         u_upload_fence(st->indexbuf_uploader, *fence);
+      if (st->constbuf_uploader)
+         u_upload_fence(st->constbuf_uploader, *fence);
+   }
+
+   screen->fence_reference(screen, &local_fence, NULL);
 }
 
 
@@ -98,8 +121,11 @@ void st_finish( struct st_context *st )
    st_flush(st, &fence, 0);
 
    if(fence) {
+      int64_t start = st_hud_phase_begin(st);
+
       st->pipe->screen->fence_finish(st->pipe->screen, NULL, fence,
                                      PIPE_TIMEOUT_INFINITE);
+      st_hud_phase_end(st, HUD_FRAME_PHASE_FENCE_WAIT, start);
       st->pipe->screen->fence_reference(st->pipe->screen, &fence, NULL);
    }
 }
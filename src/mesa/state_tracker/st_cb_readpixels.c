@@ -283,7 +283,7 @@ blit_to_staging(struct st_context *st, struct st_renderbuffer *strb,
                                    &dst_templ.width0, &dst_templ.height0,
                                    &dst_templ.depth0, &dst_templ.array_size);
 
-   dst = screen->resource_create(screen, &dst_templ);
+   dst = st_get_staging_texture(st, &dst_templ);
    if (!dst)
       return NULL;
 
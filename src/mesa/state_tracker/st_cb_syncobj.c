@@ -86,10 +86,13 @@ static void st_client_wait_sync(struct gl_context *ctx,
                                 struct gl_sync_object *obj,
                                 GLbitfield flags, GLuint64 timeout)
 {
-   struct pipe_context *pipe = st_context(ctx)->pipe;
+   struct st_context *st = st_context(ctx);
+   struct pipe_context *pipe = st->pipe;
    struct pipe_screen *screen = pipe->screen;
    struct st_sync_object *so = (struct st_sync_object*)obj;
    struct pipe_fence_handle *fence = NULL;
+   int64_t start;
+   boolean signalled;
 
    /* If the fence doesn't exist, assume it's signalled. */
    mtx_lock(&so->mutex);
@@ -117,7 +120,11 @@ static void st_client_wait_sync(struct gl_context *ctx,
     * Assume GL_SYNC_FLUSH_COMMANDS_BIT is always set, because applications
     * forget to set it.
     */
-   if (screen->fence_finish(screen, pipe, fence, timeout)) {
+   start = st_hud_phase_begin(st);
+   signalled = screen->fence_finish(screen, pipe, fence, timeout);
+   st_hud_phase_end(st, HUD_FRAME_PHASE_FENCE_WAIT, start);
+
+   if (signalled) {
       mtx_lock(&so->mutex);
       screen->fence_reference(screen, &so->fence, NULL);
       mtx_unlock(&so->mutex);
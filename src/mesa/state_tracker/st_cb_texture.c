@@ -1966,7 +1966,7 @@ st_GetTexSubImage(struct gl_context * ctx,
                                    &dst_templ.width0, &dst_templ.height0,
                                    &dst_templ.depth0, &dst_templ.array_size);
 
-   dst = screen->resource_create(screen, &dst_templ);
+   dst = st_get_staging_texture(st, &dst_templ);
    if (!dst) {
       goto fallback;
    }
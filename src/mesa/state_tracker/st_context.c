@@ -29,6 +29,7 @@
 #include "main/accum.h"
 #include "main/api_exec.h"
 #include "main/context.h"
+#include "main/glthread.h"
 #include "main/samplerobj.h"
 #include "main/shaderobj.h"
 #include "main/version.h"
@@ -291,6 +292,9 @@ st_destroy_context_priv(struct st_context *st)
    st_destroy_perfmon(st);
    st_destroy_pbo_helpers(st);
 
+   for (shader = 0; shader < ARRAY_SIZE(st->state.constants); shader++)
+      free(st->state.constants[shader].last_values);
+
    for (shader = 0; shader < ARRAY_SIZE(st->state.sampler_views); shader++) {
       for (i = 0; i < ARRAY_SIZE(st->state.sampler_views[0]); i++) {
          pipe_sampler_view_release(st->pipe,
@@ -312,6 +316,7 @@ st_destroy_context_priv(struct st_context *st)
 
    /* free glReadPixels cache data */
    st_invalidate_readpix_cache(st);
+   st_destroy_staging_textures(st);
 
    cso_destroy_context(st->cso_context);
    free( st );
@@ -358,6 +363,15 @@ st_create_context_priv( struct gl_context *ctx, struct pipe_context *pipe,
                                               PIPE_BIND_CONSTANT_BUFFER,
                                               PIPE_USAGE_STREAM);
 
+   /* Reuse one persistently mapped buffer per uploader; st_flush tells them
+    * when the GPU is done with the data.
+    */
+   u_upload_enable_ring(st->uploader, 256 * 1024);
+   if (st->indexbuf_uploader)
+      u_upload_enable_ring(st->indexbuf_uploader, 1024 * 1024);
+   if (st->constbuf_uploader)
+      u_upload_enable_ring(st->constbuf_uploader, 1024 * 1024);
+
    st->cso_context = cso_create_context(pipe);
 
    st_init_atoms( st );
@@ -583,6 +597,8 @@ void st_destroy_context( struct st_context *st )
    struct gl_context *ctx = st->ctx;
    GLuint i;
 
+   _mesa_glthread_destroy(ctx);
+
    _mesa_HashWalk(ctx->Shared->TexObjects, destroy_tex_sampler_cb, st);
 
    st_reference_fragprog(st, &st->fp, NULL);
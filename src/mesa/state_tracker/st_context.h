@@ -33,6 +33,8 @@
 #include "state_tracker/st_api.h"
 #include "main/fbobject.h"
 #include "state_tracker/st_atom.h"
+#include "hud/hud_context.h"
+#include "os/os_time.h"
 
 
 #ifdef __cplusplus
@@ -45,12 +47,17 @@ struct dd_function_table;
 struct draw_context;
 struct draw_stage;
 struct gen_mipmap_state;
+struct st_atom_stats;
 struct st_context;
 struct st_fragment_program;
 struct st_perf_monitor_group;
 struct u_upload_mgr;
 
 
+/** Number of staging textures kept for blit-based readbacks */
+#define ST_STAGING_TEXTURE_RING_SIZE 4
+
+
 /** For drawing quads for glClear, glDraw/CopyPixels, glBitmap, etc. */
 struct st_util_vertex
 {
@@ -119,6 +126,12 @@ struct st_context
       struct {
          void *ptr;
          unsigned size;
+         /**
+          * Copy of the values bound last, used to skip uploads that
+          * wouldn't change anything.
+          */
+         void *last_values;
+         unsigned last_values_size;
       } constants[PIPE_SHADER_TYPES];
       struct pipe_framebuffer_state framebuffer;
       struct pipe_scissor_state scissor[PIPE_MAX_VIEWPORTS];
@@ -143,6 +156,9 @@ struct st_context
    /** This masks out unused shader resources. Only valid in draw calls. */
    uint64_t active_states;
 
+   /** Time spent in each atom, NULL unless ST_ATOM_STATS is set. */
+   struct st_atom_stats *atom_stats;
+
    /* If true, further analysis of states is required to know if something
     * has changed. Used mainly for shaders.
     */
@@ -208,6 +224,15 @@ struct st_context
       unsigned hits;
    } readpix_cache;
 
+   /**
+    * Staging textures that glReadPixels and glGetTexImage blit into and
+    * read back, kept for the next readbacks of the same size and format.
+    */
+   struct {
+      struct pipe_resource *tex[ST_STAGING_TEXTURE_RING_SIZE];
+      unsigned next;
+   } staging;
+
    /** for glClear */
    struct {
       struct pipe_rasterizer_state raster;
@@ -349,6 +374,25 @@ st_user_clip_planes_enabled(struct gl_context *ctx)
           ctx->Transform.ClipPlanesEnabled;
 }
 
+/**
+ * Time the CPU spends in a phase of the frame, for the HUD. Returns the
+ * start time to pass to st_hud_phase_end, or 0 without a HUD.
+ */
+static inline int64_t
+st_hud_phase_begin(const struct st_context *st)
+{
+   return st->iface.hud ? os_time_get_nano() : 0;
+}
+
+static inline void
+st_hud_phase_end(struct st_context *st, enum hud_frame_phase phase,
+                 int64_t start)
+{
+   if (st->iface.hud)
+      hud_add_frame_phase_time(st->iface.hud, phase,
+                               os_time_get_nano() - start);
+}
+
 /** clear-alloc a struct-sized object, with casting */
 #define ST_CALLOC_STRUCT(T)   (struct T *) calloc(1, sizeof(struct T))
 
@@ -189,6 +189,7 @@ st_draw_vbo(struct gl_context *ctx,
    struct pipe_draw_info info;
    const struct gl_vertex_array **arrays = ctx->Array._DrawArrays;
    unsigned i;
+   int64_t start;
 
    /* Mesa core state should have been validated already */
    assert(ctx->NewState == 0x0);
@@ -199,7 +200,9 @@ st_draw_vbo(struct gl_context *ctx,
    /* Validate state. */
    if ((st->dirty | ctx->NewDriverState) & ST_PIPELINE_RENDER_STATE_MASK ||
        st->gfx_shaders_may_be_dirty) {
+      start = st_hud_phase_begin(st);
       st_validate_state(st, ST_PIPELINE_RENDER);
+      st_hud_phase_end(st, HUD_FRAME_PHASE_VALIDATE, start);
    }
 
    if (st->vertex_array_out_of_memory) {
@@ -242,6 +245,8 @@ st_draw_vbo(struct gl_context *ctx,
 
    assert(!indirect);
 
+   start = st_hud_phase_begin(st);
+
    /* do actual drawing */
    for (i = 0; i < nr_prims; i++) {
       info.mode = translate_prim(ctx, prims[i].mode);
@@ -277,6 +282,8 @@ st_draw_vbo(struct gl_context *ctx,
       }
    }
 
+   st_hud_phase_end(st, HUD_FRAME_PHASE_DRAW, start);
+
    if (ib && st->indexbuf_uploader && !_mesa_is_bufferobj(ib->obj)) {
       pipe_resource_reference(&ibuffer.buffer, NULL);
    }
@@ -419,3 +419,58 @@ st_create_color_map_texture(struct gl_context *ctx)
                           texSize, texSize, 1, 1, 0, PIPE_BIND_SAMPLER_VIEW);
    return pt;
 }
+
+
+/**
+ * Return a PIPE_USAGE_STAGING texture matching \p templ, which the caller
+ * blits into and maps for reading.  Textures are taken from a small ring
+ * instead of being created for every readback, as long as nobody else
+ * holds a reference to them.  Mapping a texture for reading waits for the
+ * blit, so the texture is idle again once the caller has unreferenced it.
+ */
+struct pipe_resource *
+st_get_staging_texture(struct st_context *st,
+                       const struct pipe_resource *templ)
+{
+   struct pipe_screen *screen = st->pipe->screen;
+   struct pipe_resource *pt = NULL;
+   unsigned i;
+
+   assert(templ->usage == PIPE_USAGE_STAGING);
+
+   for (i = 0; i < ST_STAGING_TEXTURE_RING_SIZE; i++) {
+      struct pipe_resource *tex = st->staging.tex[i];
+
+      if (tex &&
+          p_atomic_read(&tex->reference.count) == 1 &&
+          tex->target == templ->target &&
+          tex->format == templ->format &&
+          tex->bind == templ->bind &&
+          tex->width0 == templ->width0 &&
+          tex->height0 == templ->height0 &&
+          tex->depth0 == templ->depth0 &&
+          tex->array_size == templ->array_size) {
+         pipe_resource_reference(&pt, tex);
+         return pt;
+      }
+   }
+
+   pt = screen->resource_create(screen, templ);
+   if (!pt)
+      return NULL;
+
+   /* Replace the oldest texture. */
+   pipe_resource_reference(&st->staging.tex[st->staging.next], pt);
+   st->staging.next = (st->staging.next + 1) % ST_STAGING_TEXTURE_RING_SIZE;
+   return pt;
+}
+
+
+void
+st_destroy_staging_textures(struct st_context *st)
+{
+   unsigned i;
+
+   for (i = 0; i < ST_STAGING_TEXTURE_RING_SIZE; i++)
+      pipe_resource_reference(&st->staging.tex[i], NULL);
+}
@@ -250,6 +250,13 @@ st_texture_image_copy(struct pipe_context *pipe,
 extern struct pipe_resource *
 st_create_color_map_texture(struct gl_context *ctx);
 
+extern struct pipe_resource *
+st_get_staging_texture(struct st_context *st,
+                       const struct pipe_resource *templ);
+
+extern void
+st_destroy_staging_textures(struct st_context *st);
+
 
 bool
 st_etc_fallback(struct st_context *st, struct gl_texture_image *texImage);
@@ -240,11 +240,17 @@ vbo_exec_bind_arrays( struct gl_context *ctx )
          exec->vtx.inputs[attr] = &arrays[attr];
 
          if (_mesa_is_bufferobj(exec->vtx.bufferobj)) {
-            /* a real buffer obj: Ptr is an offset, not a pointer */
-            assert(exec->vtx.bufferobj->Mappings[MAP_INTERNAL].Pointer);
+            const struct gl_buffer_mapping *mapping =
+               &exec->vtx.bufferobj->Mappings[MAP_INTERNAL];
+
+            /* a real buffer obj: Ptr is an offset, not a pointer.  The
+             * vertices don't start at the beginning of a persistent mapping.
+             */
+            assert(mapping->Pointer);
             assert(offset >= 0);
-            arrays[attr].Ptr = (GLubyte *)
-               exec->vtx.bufferobj->Mappings[MAP_INTERNAL].Offset + offset;
+            arrays[attr].Ptr = (GLubyte *) mapping->Offset +
+               ((GLubyte *) exec->vtx.buffer_map -
+                (GLubyte *) mapping->Pointer) + offset;
          }
          else {
             /* Ptr into ordinary app memory */
@@ -280,16 +286,40 @@ vbo_exec_bind_arrays( struct gl_context *ctx )
 }
 
 
+/**
+ * Whether the VBO is mapped once with persistent, coherent mappings and
+ * stays mapped while the vertices are drawn, instead of being mapped and
+ * unmapped around every draw.
+ */
+static inline bool
+vbo_exec_use_persistent_map(const struct gl_context *ctx)
+{
+   return ctx->Extensions.ARB_buffer_storage;
+}
+
+
+static inline bool
+vbo_exec_buffer_has_space(const struct vbo_exec_context *exec)
+{
+   return VBO_VERT_BUFFER_SIZE > exec->vtx.buffer_used + 1024;
+}
+
+
 /**
  * Unmap the VBO.  This is called before drawing.
+ *
+ * A persistent mapping is only released once the buffer is full, so that
+ * vbo_exec_vtx_map() allocates new storage for it.  The vertices written
+ * so far are simply skipped otherwise.
  */
 static void
 vbo_exec_vtx_unmap( struct vbo_exec_context *exec )
 {
    if (_mesa_is_bufferobj(exec->vtx.bufferobj)) {
       struct gl_context *ctx = exec->ctx;
+      const bool persistent = vbo_exec_use_persistent_map(ctx);
 
-      if (ctx->Driver.FlushMappedBufferRange) {
+      if (!persistent && ctx->Driver.FlushMappedBufferRange) {
          GLintptr offset = exec->vtx.buffer_used -
                            exec->vtx.bufferobj->Mappings[MAP_INTERNAL].Offset;
          GLsizeiptr length = (exec->vtx.buffer_ptr - exec->vtx.buffer_map) *
@@ -307,7 +337,8 @@ vbo_exec_vtx_unmap( struct vbo_exec_context *exec )
       assert(exec->vtx.buffer_used <= VBO_VERT_BUFFER_SIZE);
       assert(exec->vtx.buffer_ptr != NULL);
 
-      ctx->Driver.UnmapBuffer(ctx, exec->vtx.bufferobj, MAP_INTERNAL);
+      if (!persistent || !vbo_exec_buffer_has_space(exec))
+         ctx->Driver.UnmapBuffer(ctx, exec->vtx.bufferobj, MAP_INTERNAL);
       exec->vtx.buffer_map = NULL;
       exec->vtx.buffer_ptr = NULL;
       exec->vtx.max_vert = 0;
@@ -322,20 +353,51 @@ void
 vbo_exec_vtx_map( struct vbo_exec_context *exec )
 {
    struct gl_context *ctx = exec->ctx;
-   const GLenum accessRange = GL_MAP_WRITE_BIT |  /* for MapBufferRange */
-                              GL_MAP_INVALIDATE_RANGE_BIT |
-                              GL_MAP_UNSYNCHRONIZED_BIT |
-                              GL_MAP_FLUSH_EXPLICIT_BIT |
-                              MESA_MAP_NOWAIT_BIT;
+   const bool persistent = vbo_exec_use_persistent_map(ctx);
+   GLenum accessRange = GL_MAP_WRITE_BIT;  /* for MapBufferRange */
+   GLbitfield storageFlags = GL_MAP_WRITE_BIT |
+                             GL_DYNAMIC_STORAGE_BIT |
+                             GL_CLIENT_STORAGE_BIT;
    const GLenum usage = GL_STREAM_DRAW_ARB;
 
+   if (persistent) {
+      /* vbo_copy_vertices() reads back the vertices of wrapped primitives.
+       * Only this mapping can be readable, as GL_MAP_READ_BIT doesn't go
+       * with the invalidate and unsynchronized flags used otherwise.
+       */
+      accessRange |= GL_MAP_READ_BIT |
+                     GL_MAP_PERSISTENT_BIT |
+                     GL_MAP_COHERENT_BIT;
+      storageFlags |= GL_MAP_READ_BIT |
+                      GL_MAP_PERSISTENT_BIT |
+                      GL_MAP_COHERENT_BIT;
+   }
+   else {
+      accessRange |= GL_MAP_INVALIDATE_RANGE_BIT |
+                     GL_MAP_UNSYNCHRONIZED_BIT |
+                     GL_MAP_FLUSH_EXPLICIT_BIT |
+                     MESA_MAP_NOWAIT_BIT;
+   }
+
    if (!_mesa_is_bufferobj(exec->vtx.bufferobj))
       return;
 
    assert(!exec->vtx.buffer_map);
    assert(!exec->vtx.buffer_ptr);
 
-   if (VBO_VERT_BUFFER_SIZE > exec->vtx.buffer_used + 1024) {
+   if (persistent) {
+      /* Carry on after the vertices drawn last while there's room.  The
+       * whole buffer is mapped, so that offsets into the mapping are
+       * offsets into the buffer as well.
+       */
+      if (vbo_exec_buffer_has_space(exec) &&
+          _mesa_bufferobj_mapped(exec->vtx.bufferobj, MAP_INTERNAL)) {
+         exec->vtx.buffer_map = (fi_type *)
+            ((GLubyte *) exec->vtx.bufferobj->Mappings[MAP_INTERNAL].Pointer +
+             exec->vtx.buffer_used);
+      }
+   }
+   else if (vbo_exec_buffer_has_space(exec)) {
       /* The VBO exists and there's room for more */
       if (exec->vtx.bufferobj->Size > 0) {
          exec->vtx.buffer_map =
@@ -354,15 +416,17 @@ vbo_exec_vtx_map( struct vbo_exec_context *exec )
    }
 
    if (!exec->vtx.buffer_map) {
-      /* Need to allocate a new VBO */
+      /* Need to allocate a new VBO.  Draws still reading the old storage
+       * keep it alive, so nothing has to wait for them.
+       */
       exec->vtx.buffer_used = 0;
 
+      if (_mesa_bufferobj_mapped(exec->vtx.bufferobj, MAP_INTERNAL))
+         ctx->Driver.UnmapBuffer(ctx, exec->vtx.bufferobj, MAP_INTERNAL);
+
       if (ctx->Driver.BufferData(ctx, GL_ARRAY_BUFFER_ARB,
                                  VBO_VERT_BUFFER_SIZE,
-                                 NULL, usage,
-                                 GL_MAP_WRITE_BIT |
-                                 GL_DYNAMIC_STORAGE_BIT |
-                                 GL_CLIENT_STORAGE_BIT,
+                                 NULL, usage, storageFlags,
                                  exec->vtx.bufferobj)) {
          /* buffer allocation worked, now map the buffer */
          exec->vtx.buffer_map =
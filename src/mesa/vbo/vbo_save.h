@@ -82,6 +82,13 @@ struct vbo_save_vertex_list {
    struct _mesa_prim *prim;
    GLuint prim_count;
 
+   /* When all the primitives are filled polygons, they are also compiled
+    * into a single indexed GL_TRIANGLES draw, which is used at replay time
+    * whenever that draws the same thing.  merged_ib.obj is NULL otherwise.
+    */
+   struct _mesa_prim merged_prim;
+   struct _mesa_index_buffer merged_ib;
+
    struct vbo_save_vertex_store *vertex_store;
    struct vbo_save_primitive_store *prim_store;
 };
@@ -406,6 +406,170 @@ convert_line_loop_to_strip(struct vbo_save_context *save,
 }
 
 
+/**
+ * Writes the triangles that make up the filled primitive \p prim to \p dst
+ * and returns the number of indices.  The triangles keep the winding and,
+ * with the last vertex convention, the provoking vertex of the primitive.
+ */
+static GLuint
+prim_to_triangle_indices(GLuint *dst, const struct _mesa_prim *prim)
+{
+   const GLuint s = prim->start;
+   const GLuint count = prim->count;
+   GLuint *p = dst;
+   GLuint i;
+
+#define TRI(a, b, c) do { *p++ = (a); *p++ = (b); *p++ = (c); } while (0)
+
+   switch (prim->mode) {
+   case GL_TRIANGLES:
+      for (i = 0; i + 2 < count; i += 3)
+         TRI(s + i, s + i + 1, s + i + 2);
+      break;
+   case GL_TRIANGLE_STRIP:
+      for (i = 0; i + 2 < count; i++) {
+         if (i & 1)
+            TRI(s + i + 1, s + i, s + i + 2);
+         else
+            TRI(s + i, s + i + 1, s + i + 2);
+      }
+      break;
+   case GL_TRIANGLE_FAN:
+      for (i = 1; i + 1 < count; i++)
+         TRI(s, s + i, s + i + 1);
+      break;
+   case GL_POLYGON:
+      /* The first vertex provokes a polygon. */
+      for (i = 1; i + 1 < count; i++)
+         TRI(s + i, s + i + 1, s);
+      break;
+   case GL_QUADS:
+      for (i = 0; i + 3 < count; i += 4) {
+         TRI(s + i, s + i + 1, s + i + 3);
+         TRI(s + i + 1, s + i + 2, s + i + 3);
+      }
+      break;
+   case GL_QUAD_STRIP:
+      /* Quad i is made of vertices 2i, 2i+1, 2i+3 and 2i+2, in that order,
+       * and provoked by 2i+3.
+       */
+      for (i = 0; i + 3 < count; i += 2) {
+         TRI(s + i, s + i + 1, s + i + 3);
+         TRI(s + i + 2, s + i, s + i + 3);
+      }
+      break;
+   default:
+      unreachable("not a filled primitive");
+   }
+
+#undef TRI
+
+   return p - dst;
+}
+
+
+static bool
+is_filled_prim_mode(GLenum mode)
+{
+   switch (mode) {
+   case GL_TRIANGLES:
+   case GL_TRIANGLE_STRIP:
+   case GL_TRIANGLE_FAN:
+   case GL_QUADS:
+   case GL_QUAD_STRIP:
+   case GL_POLYGON:
+      return true;
+   default:
+      return false;
+   }
+}
+
+
+/**
+ * Lists drawn as many separate strips, fans, quads or polygons would cost a
+ * draw call for each of them at replay time.  Convert them into a single
+ * indexed draw of triangles, stored in node->merged_prim/merged_ib.
+ */
+static void
+compile_merged_draw(struct gl_context *ctx,
+                    struct vbo_save_vertex_list *node)
+{
+   struct gl_buffer_object *obj;
+   GLuint max_indices = 0, num_indices = 0;
+   GLuint *indices;
+   GLenum type;
+   GLuint i;
+
+   memset(&node->merged_prim, 0, sizeof(node->merged_prim));
+   memset(&node->merged_ib, 0, sizeof(node->merged_ib));
+
+   if (node->prim_count < 2)
+      return;
+
+   for (i = 0; i < node->prim_count; i++) {
+      if (!is_filled_prim_mode(node->prim[i].mode))
+         return;
+      max_indices += node->prim[i].count * 3;
+   }
+
+   indices = malloc(max_indices * sizeof(GLuint));
+   if (!indices)
+      return;
+
+   for (i = 0; i < node->prim_count; i++)
+      num_indices += prim_to_triangle_indices(indices + num_indices,
+                                              &node->prim[i]);
+
+   if (num_indices == 0) {
+      free(indices);
+      return;
+   }
+
+   if (node->count <= 0xffff) {
+      /* Narrow in place, front to back. */
+      GLushort *us_indices = (GLushort *) indices;
+
+      for (i = 0; i < num_indices; i++)
+         us_indices[i] = indices[i];
+      type = GL_UNSIGNED_SHORT;
+   }
+   else {
+      type = GL_UNSIGNED_INT;
+   }
+
+   obj = ctx->Driver.NewBufferObject(ctx, VBO_BUF_ID);
+   if (!obj) {
+      free(indices);
+      return;
+   }
+
+   if (!ctx->Driver.BufferData(ctx, GL_ELEMENT_ARRAY_BUFFER_ARB,
+                               num_indices * vbo_sizeof_ib_type(type),
+                               indices, GL_STATIC_DRAW_ARB,
+                               GL_MAP_WRITE_BIT | GL_DYNAMIC_STORAGE_BIT,
+                               obj)) {
+      _mesa_reference_buffer_object(ctx, &obj, NULL);
+      free(indices);
+      return;
+   }
+
+   free(indices);
+
+   node->merged_prim.mode = GL_TRIANGLES;
+   node->merged_prim.indexed = 1;
+   node->merged_prim.begin = 1;
+   node->merged_prim.end = 1;
+   node->merged_prim.start = 0;
+   node->merged_prim.count = num_indices;
+   node->merged_prim.num_instances = 1;
+
+   node->merged_ib.count = num_indices;
+   node->merged_ib.type = type;
+   node->merged_ib.obj = obj;
+   node->merged_ib.ptr = NULL;
+}
+
+
 /**
  * Insert the active immediate struct onto the display list currently
  * being built.
@@ -494,6 +658,8 @@ _save_compile_vertex_list(struct gl_context *ctx)
 
    merge_prims(node->prim, &node->prim_count);
 
+   compile_merged_draw(ctx, node);
+
    /* Deal with GL_COMPILE_AND_EXECUTE:
     */
    if (ctx->ExecuteFlag) {
@@ -1600,6 +1766,8 @@ vbo_destroy_vertex_list(struct gl_context *ctx, void *data)
 
    free(node->current_data);
    node->current_data = NULL;
+
+   _mesa_reference_buffer_object(ctx, &node->merged_ib.obj, NULL);
 }
 
 
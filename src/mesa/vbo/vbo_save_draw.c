@@ -34,6 +34,7 @@
 #include "main/macros.h"
 #include "main/light.h"
 #include "main/state.h"
+#include "main/transformfeedback.h"
 #include "util/bitscan.h"
 
 #include "vbo_context.h"
@@ -243,6 +244,30 @@ vbo_save_loopback_vertex_list(struct gl_context *ctx,
 }
 
 
+/**
+ * Whether drawing node->merged_prim gives the same result as drawing each
+ * of node->prim.  Splitting the primitives into triangles shows with
+ * polygon modes other than fill, changes the provoking vertex of the first
+ * vertex convention, and changes primitive IDs and counts.
+ */
+static bool
+use_merged_draw(const struct gl_context *ctx,
+                const struct vbo_save_vertex_list *node)
+{
+   const struct gl_program *fp = ctx->FragmentProgram._Current;
+
+   return node->merged_ib.obj &&
+          ctx->Polygon.FrontMode == GL_FILL &&
+          ctx->Polygon.BackMode == GL_FILL &&
+          ctx->Light.ProvokingVertex == GL_LAST_VERTEX_CONVENTION_EXT &&
+          !ctx->GeometryProgram._Current &&
+          !ctx->TessEvalProgram._Current &&
+          !(fp && (fp->info.inputs_read & VARYING_BIT_PRIMITIVE_ID)) &&
+          !_mesa_is_xfb_active_and_unpaused(ctx) &&
+          !ctx->Query.PrimitivesGenerated[0];
+}
+
+
 /**
  * Execute the buffer and save copied verts.
  * This is called from the display list code when executing
@@ -309,7 +334,17 @@ vbo_save_playback_vertex_list(struct gl_context *ctx, void *data)
       if (ctx->NewState)
 	 _mesa_update_state( ctx );
 
-      if (node->count > 0) {
+      if (node->count > 0 && use_merged_draw(ctx, node)) {
+         vbo_context(ctx)->draw_prims(ctx,
+                                      &node->merged_prim,
+                                      1,
+                                      &node->merged_ib,
+                                      GL_TRUE,
+                                      0,
+                                      node->count - 1,
+                                      NULL, 0, NULL);
+      }
+      else if (node->count > 0) {
          vbo_context(ctx)->draw_prims(ctx, 
                                       node->prim,
                                       node->prim_count,
@@ -55,6 +55,15 @@
 #elif !defined(bit_SSE4_1) && !defined(bit_SSE41)
 #define bit_SSE4_1 0x00080000
 #endif
+#ifndef bit_OSXSAVE
+#define bit_OSXSAVE 0x08000000
+#endif
+#ifndef bit_AVX
+#define bit_AVX 0x10000000
+#endif
+#ifndef bit_AVX2
+#define bit_AVX2 0x00000020
+#endif
 #endif
 
 #include "main/imports.h"
@@ -354,6 +363,22 @@ _mesa_get_x86_features(void)
 
       if (ecx & bit_SSE4_1)
          _mesa_x86_cpu_features |= X86_FEATURE_SSE4_1;
+
+      /* AVX2 also needs the OS to save the YMM state on context switches,
+       * which it reports through XCR0.
+       */
+      if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX) &&
+          __get_cpuid_max(0, NULL) >= 7) {
+         unsigned int xcr0_lo, xcr0_hi;
+
+         /* xgetbv, spelled out for assemblers that don't know it. */
+         __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0"
+                              : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+
+         __cpuid_count(7, 0, eax, ebx, ecx, edx);
+         if ((xcr0_lo & 0x6) == 0x6 && (ebx & bit_AVX2))
+            _mesa_x86_cpu_features |= X86_FEATURE_AVX2;
+      }
    }
 #endif /* USE_X86_64_ASM */
 
@@ -33,7 +33,19 @@
  */
 
 
+#include <stdbool.h>
+#include <string.h>
+
 #include "crc32.h"
+#include "u_endian.h"
+#include "c11/threads.h"
+
+#ifdef USE_PCLMUL
+#include <cpuid.h>
+
+/* crc32_pclmul.c */
+uint32_t util_crc32_pclmul(uint32_t crc, const uint8_t *p, size_t size);
+#endif
 
 
 static const uint32_t 
@@ -105,17 +117,103 @@ util_crc32_table[256] = {
 };
 
 
+/* util_crc32_slice[k][i] is the CRC of byte i followed by k zero bytes,
+ * with util_crc32_slice[0] being util_crc32_table.  This allows processing
+ * 8 bytes at a time with independent table lookups ("slicing-by-8").
+ */
+static uint32_t util_crc32_slice[8][256];
+
+static void
+util_crc32_init_slices(void)
+{
+   unsigned i, k;
+
+   for (i = 0; i < 256; i++)
+      util_crc32_slice[0][i] = util_crc32_table[i];
+
+   for (k = 1; k < 8; k++) {
+      for (i = 0; i < 256; i++) {
+         uint32_t crc = util_crc32_slice[k - 1][i];
+         util_crc32_slice[k][i] = util_crc32_table[crc & 0xff] ^ (crc >> 8);
+      }
+   }
+}
+
+#ifdef USE_PCLMUL
+static bool util_crc32_has_pclmul;
+
+static void
+util_crc32_detect_pclmul(void)
+{
+   unsigned eax, ebx, ecx, edx;
+
+   if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      util_crc32_has_pclmul = (ecx & bit_PCLMUL) != 0;
+}
+#endif
+
+static void
+util_crc32_init(void)
+{
+   util_crc32_init_slices();
+#ifdef USE_PCLMUL
+   util_crc32_detect_pclmul();
+#endif
+}
+
+
 /**
  * @sa http://www.w3.org/TR/PNG/#D-CRCAppendix
  */
 uint32_t
 util_hash_crc32(const void *data, size_t size)
 {
-   uint8_t *p = (uint8_t *)data;
+   static once_flag flag = ONCE_FLAG_INIT;
+   const uint8_t *p = (const uint8_t *)data;
    uint32_t crc = 0xffffffff;
- 
+
+   /* Short keys are most common, don't bother with the setup for them. */
+   if (size < 16) {
+      while (size--)
+         crc = util_crc32_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+      return crc;
+   }
+
+   call_once(&flag, util_crc32_init);
+
+#ifdef USE_PCLMUL
+   if (util_crc32_has_pclmul && size >= 64) {
+      size_t n = size & ~(size_t)15;
+
+      crc = util_crc32_pclmul(crc, p, n);
+      p += n;
+      size -= n;
+   }
+#endif
+
+#ifdef PIPE_ARCH_LITTLE_ENDIAN
+   while (size >= 8) {
+      uint32_t lo, hi;
+
+      memcpy(&lo, p, 4);
+      memcpy(&hi, p + 4, 4);
+      lo ^= crc;
+
+      crc = util_crc32_slice[7][lo & 0xff] ^
+            util_crc32_slice[6][(lo >> 8) & 0xff] ^
+            util_crc32_slice[5][(lo >> 16) & 0xff] ^
+            util_crc32_slice[4][lo >> 24] ^
+            util_crc32_slice[3][hi & 0xff] ^
+            util_crc32_slice[2][(hi >> 8) & 0xff] ^
+            util_crc32_slice[1][(hi >> 16) & 0xff] ^
+            util_crc32_slice[0][hi >> 24];
+      p += 8;
+      size -= 8;
+   }
+#endif
+
    while (size--)
       crc = util_crc32_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
-   
+
    return crc;
 }
@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * CRC32 of large buffers using carry-less multiplication, following
+ * "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+ * Instruction" (Gopal et al., Intel, 2009).  This file is built with
+ * PCLMUL_CFLAGS, and only called after checking that the CPU supports it.
+ */
+
+#ifdef USE_PCLMUL
+
+#include <stddef.h>
+#include <stdint.h>
+#include <wmmintrin.h>
+
+uint32_t util_crc32_pclmul(uint32_t crc, const uint8_t *p, size_t size);
+
+/**
+ * Updates crc with size bytes at p.  size must be a multiple of 16, and at
+ * least 64.
+ */
+uint32_t
+util_crc32_pclmul(uint32_t crc, const uint8_t *p, size_t size)
+{
+   /* Folding constants for the bit-reflected polynomial 0xedb88320:
+    * x^(4*128+32) mod P, x^(4*128-32) mod P, x^(128+32) mod P,
+    * x^(128-32) mod P, x^64 mod P, then P itself and floor(x^64 / P) for
+    * the Barrett reduction.
+    */
+   const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+   const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+   const __m128i k5 = _mm_set_epi64x(0, 0x0163cd6124);
+   const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+   const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+   __m128i x1, x2, x3, x4, x5, x6, x7, x8;
+
+   x1 = _mm_loadu_si128((const __m128i *)(p + 0x00));
+   x2 = _mm_loadu_si128((const __m128i *)(p + 0x10));
+   x3 = _mm_loadu_si128((const __m128i *)(p + 0x20));
+   x4 = _mm_loadu_si128((const __m128i *)(p + 0x30));
+   x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+   p += 64;
+   size -= 64;
+
+   /* Fold 64 bytes at a time into four accumulators. */
+   while (size >= 64) {
+      x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+      x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+      x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+      x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+      x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+      x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+      x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+      x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                         _mm_loadu_si128((const __m128i *)(p + 0x00)));
+      x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+                         _mm_loadu_si128((const __m128i *)(p + 0x10)));
+      x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+                         _mm_loadu_si128((const __m128i *)(p + 0x20)));
+      x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+                         _mm_loadu_si128((const __m128i *)(p + 0x30)));
+      p += 64;
+      size -= 64;
+   }
+
+   /* Fold the accumulators into one, then 16 bytes at a time. */
+   x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+   x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+   x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+   x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+   x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+   x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+   x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+   x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+   x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+   while (size >= 16) {
+      x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+      x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+      x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                         _mm_loadu_si128((const __m128i *)p));
+      p += 16;
+      size -= 16;
+   }
+
+   /* Fold 128 bits down to 64. */
+   x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+   x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+   x2 = _mm_srli_si128(x1, 4);
+   x1 = _mm_and_si128(x1, mask32);
+   x1 = _mm_clmulepi64_si128(x1, k5, 0x00);
+   x1 = _mm_xor_si128(x1, x2);
+
+   /* Barrett reduction to 32 bits. */
+   x2 = _mm_and_si128(x1, mask32);
+   x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+   x2 = _mm_and_si128(x2, mask32);
+   x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+   x1 = _mm_xor_si128(x1, x2);
+
+   return _mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+
+#endif
@@ -37,12 +37,15 @@
 #include <errno.h>
 #include <dirent.h>
 
+#include "util/list.h"
 #include "util/u_atomic.h"
+#include "util/u_queue.h"
 #include "util/mesa-sha1.h"
 #include "util/ralloc.h"
 #include "main/errors.h"
 
 #include "disk_cache.h"
+#include "disk_cache_archive.h"
 
 /* Number of bits to mask off from a cache key to get an index. */
 #define CACHE_INDEX_KEY_BITS 16
@@ -69,6 +72,29 @@ struct disk_cache {
 
    /* Maximum size of all cached objects (in bytes). */
    uint64_t max_size;
+
+   /* Single-file storage used instead of one file per object, if enabled. */
+   struct disk_cache_archive *archive;
+
+   /* Thread writing the objects passed to disk_cache_put. */
+   struct util_queue put_queue;
+
+   /* Objects queued for writing and not written yet, so that
+    * disk_cache_get can find them. Protected by put_mutex.
+    */
+   mtx_t put_mutex;
+   cnd_t put_done;
+   struct list_head puts_in_flight;
+   unsigned num_puts;
+};
+
+struct disk_cache_put_job {
+   struct list_head link;
+   struct util_queue_fence fence;
+   struct disk_cache *cache;
+   cache_key key;
+   void *data;
+   size_t size;
 };
 
 /* Create a directory named 'path' if it does not already exist.
@@ -210,7 +236,7 @@ disk_cache_create(void)
          goto fail;
    }
 
-   cache = ralloc(NULL, struct disk_cache);
+   cache = rzalloc(NULL, struct disk_cache);
    if (cache == NULL)
       goto fail;
 
@@ -298,6 +324,22 @@ disk_cache_create(void)
 
    cache->max_size = max_size;
 
+   /* With lots of objects, one file per object gets slow on some file
+    * systems, so objects can be packed into a single archive instead. Fall
+    * back to separate files if the archive can't be opened.
+    */
+   if (getenv("MESA_GLSL_CACHE_ARCHIVE"))
+      cache->archive = disk_cache_archive_create(cache, cache->path, max_size);
+
+   /* Writes go through a thread, so that storing an object doesn't stall
+    * the thread which compiled it. Without the thread, they are done
+    * synchronously.
+    */
+   mtx_init(&cache->put_mutex, mtx_plain);
+   cnd_init(&cache->put_done);
+   LIST_INITHEAD(&cache->puts_in_flight);
+   util_queue_init(&cache->put_queue, "disk_cache", 32, 1);
+
    ralloc_free(local);
 
    return cache;
@@ -312,16 +354,37 @@ disk_cache_create(void)
    return NULL;
 }
 
+void
+disk_cache_wait_for_idle(struct disk_cache *cache)
+{
+   mtx_lock(&cache->put_mutex);
+   while (cache->num_puts)
+      cnd_wait(&cache->put_done, &cache->put_mutex);
+   mtx_unlock(&cache->put_mutex);
+}
+
 void
 disk_cache_destroy(struct disk_cache *cache)
 {
+   /* The queue drops the jobs it hasn't started, wait for all of them. */
+   disk_cache_wait_for_idle(cache);
+
+   if (util_queue_is_initialized(&cache->put_queue))
+      util_queue_destroy(&cache->put_queue);
+   cnd_destroy(&cache->put_done);
+   mtx_destroy(&cache->put_mutex);
+
+   if (cache->archive)
+      disk_cache_archive_destroy(cache->archive);
+
    munmap(cache->index_mmap, cache->index_mmap_size);
 
    ralloc_free(cache);
 }
 
 /* Return a filename within the cache's directory corresponding to 'key'. The
- * returned filename is ralloced with 'cache' as the parent context.
+ * returned filename is ralloced without a parent context, since the cache is
+ * used from several threads.
  *
  * Returns NULL if out of memory.
  */
@@ -332,7 +395,7 @@ get_cache_file(struct disk_cache *cache, cache_key key)
 
    _mesa_sha1_format(buf, key);
 
-   return ralloc_asprintf(cache, "%s/%c%c/%s",
+   return ralloc_asprintf(NULL, "%s/%c%c/%s",
                           cache->path, buf[0], buf[1], buf + 2);
 }
 
@@ -349,7 +412,7 @@ make_cache_file_directory(struct disk_cache *cache, cache_key key)
 
    _mesa_sha1_format(buf, key);
 
-   dir = ralloc_asprintf(cache, "%s/%c%c", cache->path, buf[0], buf[1]);
+   dir = ralloc_asprintf(NULL, "%s/%c%c", cache->path, buf[0], buf[1]);
 
    mkdir_if_needed(dir);
 
@@ -530,17 +593,22 @@ evict_random_item(struct disk_cache *cache)
       p_atomic_add(cache->size, - size);
 }
 
-void
-disk_cache_put(struct disk_cache *cache,
-          cache_key key,
-          const void *data,
-          size_t size)
+static void
+write_item(struct disk_cache *cache,
+           cache_key key,
+           const void *data,
+           size_t size)
 {
    int fd = -1, fd_final = -1, err, ret;
    size_t len;
    char *filename = NULL, *filename_tmp = NULL;
    const char *p = data;
 
+   if (cache->archive) {
+      disk_cache_archive_put(cache->archive, key, data, size);
+      return;
+   }
+
    filename = get_cache_file(cache, key);
    if (filename == NULL)
       goto done;
@@ -549,7 +617,7 @@ disk_cache_put(struct disk_cache *cache,
     * final destination filename, (to prevent any readers from seeing
     * a partially written file).
     */
-   filename_tmp = ralloc_asprintf(cache, "%s.tmp", filename);
+   filename_tmp = ralloc_asprintf(NULL, "%s.tmp", filename);
    if (filename_tmp == NULL)
       goto done;
 
@@ -626,6 +694,100 @@ disk_cache_put(struct disk_cache *cache,
       ralloc_free(filename);
 }
 
+static void
+put_job_execute(void *data, int thread_index)
+{
+   struct disk_cache_put_job *job = data;
+   struct disk_cache *cache = job->cache;
+
+   write_item(cache, job->key, job->data, job->size);
+
+   mtx_lock(&cache->put_mutex);
+   LIST_DEL(&job->link);
+   mtx_unlock(&cache->put_mutex);
+}
+
+static void
+put_job_cleanup(void *data, int thread_index)
+{
+   struct disk_cache_put_job *job = data;
+   struct disk_cache *cache = job->cache;
+
+   util_queue_fence_destroy(&job->fence);
+   free(job->data);
+   free(job);
+
+   mtx_lock(&cache->put_mutex);
+   if (--cache->num_puts == 0)
+      cnd_broadcast(&cache->put_done);
+   mtx_unlock(&cache->put_mutex);
+}
+
+void
+disk_cache_put(struct disk_cache *cache,
+          cache_key key,
+          const void *data,
+          size_t size)
+{
+   struct disk_cache_put_job *job;
+
+   if (!util_queue_is_initialized(&cache->put_queue))
+      goto sync;
+
+   job = malloc(sizeof(*job));
+   if (!job)
+      goto sync;
+
+   job->data = malloc(size);
+   if (!job->data) {
+      free(job);
+      goto sync;
+   }
+
+   memcpy(job->data, data, size);
+   memcpy(job->key, key, CACHE_KEY_SIZE);
+   job->size = size;
+   job->cache = cache;
+   util_queue_fence_init(&job->fence);
+
+   mtx_lock(&cache->put_mutex);
+   LIST_ADDTAIL(&job->link, &cache->puts_in_flight);
+   cache->num_puts++;
+   mtx_unlock(&cache->put_mutex);
+
+   util_queue_add_job(&cache->put_queue, job, &job->fence,
+                      put_job_execute, put_job_cleanup);
+   return;
+
+ sync:
+   write_item(cache, key, data, size);
+}
+
+/* Return a copy of an object which is still being written, if any. */
+static void *
+get_in_flight(struct disk_cache *cache, cache_key key, size_t *size)
+{
+   void *data = NULL;
+
+   mtx_lock(&cache->put_mutex);
+   list_for_each_entry(struct disk_cache_put_job, job,
+                       &cache->puts_in_flight, link) {
+      if (memcmp(job->key, key, CACHE_KEY_SIZE) != 0)
+         continue;
+
+      data = malloc(job->size);
+      if (data) {
+         memcpy(data, job->data, job->size);
+         if (size)
+            *size = job->size;
+      }
+      break;
+   }
+   mtx_unlock(&cache->put_mutex);
+
+   return data;
+}
+
 void *
 disk_cache_get(struct disk_cache *cache, cache_key key, size_t *size)
 {
@@ -637,6 +799,13 @@ disk_cache_get(struct disk_cache *cache, cache_key key, size_t *size)
    if (size)
       *size = 0;
 
+   data = get_in_flight(cache, key, size);
+   if (data)
+      return data;
+
+   if (cache->archive)
+      return disk_cache_archive_get(cache->archive, key, size);
+
    filename = get_cache_file(cache, key);
    if (filename == NULL)
       goto fail;
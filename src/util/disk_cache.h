@@ -48,6 +48,11 @@ struct disk_cache;
  * This function creates the handle necessary for all subsequent cache_*
  * functions.
  *
+ * If MESA_GLSL_CACHE_ARCHIVE is set, objects are stored in a single archive
+ * file with an LRU eviction policy instead of one file each. Stores to the
+ * archive are batched, and only guaranteed to be written out once the cache
+ * is destroyed.
+ *
  * This cache provides two distinct operations:
  *
  *   o Storage and retrieval of arbitrary objects by cryptographic
@@ -77,12 +82,21 @@ disk_cache_create(void);
 void
 disk_cache_destroy(struct disk_cache *cache);
 
+/**
+ * Wait until all the items passed to disk_cache_put() have been written.
+ */
+void
+disk_cache_wait_for_idle(struct disk_cache *cache);
+
 /**
  * Store an item in the cache under the name \key.
  *
  * The item can be retrieved later with disk_cache_get(), (unless the item has
  * been evicted in the interim).
  *
+ * The data is copied and written by a separate thread, the item can be
+ * retrieved with disk_cache_get() while it is being written.
+ *
  * Any call to disk_cache_put() may cause an existing, random item to be
  * evicted from the cache.
  */
@@ -144,6 +158,12 @@ disk_cache_destroy(struct disk_cache *cache) {
    return;
 }
 
+static inline void
+disk_cache_wait_for_idle(struct disk_cache *cache)
+{
+   return;
+}
+
 static inline void
 disk_cache_put(struct disk_cache *cache, cache_key key,
           const void *data, size_t size)
@@ -0,0 +1,884 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifdef ENABLE_SHADER_CACHE
+
+/* The archive is made of two files in the cache directory:
+ *
+ *   o "archive", where objects are appended one after the other, each
+ *     preceded by a struct archive_record.
+ *
+ *   o "archive.idx", a fixed-size open-addressing hash table from keys to
+ *     records, mapped shared by every process using the cache. Each slot
+ *     also holds the value of a clock bumped by every hit, which gives a
+ *     true LRU order for eviction.
+ *
+ * Lookups take no lock and no syscall besides the pread of the object. All
+ * modifications are done while holding an exclusive flock on the index.
+ * Readers verify the key and the checksum of every record they read, so
+ * racing with a writer can only cause a miss.
+ *
+ * Evicted records are only dropped from the index. Once more than half of
+ * the archive is dead, the live records are copied to new files which are
+ * renamed over the old ones, and the old index is flagged as stale so that
+ * other processes reopen the files.
+ *
+ * Puts are batched in memory, and compressed with zlib when available.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/file.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "c11/threads.h"
+#include "util/crc32.h"
+#include "util/macros.h"
+#include "util/ralloc.h"
+#include "util/u_atomic.h"
+
+#include "disk_cache_archive.h"
+
+#define ARCHIVE_MAGIC 0x4143434d /* "MCCA" */
+#define ARCHIVE_VERSION 1
+
+/* Number of slots in the index, a power of two. */
+#define ARCHIVE_INDEX_SLOTS (1 << 17)
+
+/* Evict when more than this many slots are used, to keep probing short. */
+#define ARCHIVE_MAX_ENTRIES (ARCHIVE_INDEX_SLOTS / 4 * 3)
+
+#define ARCHIVE_SLOT_EMPTY 0
+#define ARCHIVE_SLOT_DELETED UINT32_MAX
+
+/* Pending puts are written out once they reach either limit. */
+#define ARCHIVE_BATCH_SIZE (256 * 1024)
+#define ARCHIVE_BATCH_COUNT 64
+
+#define ARCHIVE_RECORD_COMPRESSED 0x1
+
+struct archive_header {
+   uint32_t magic;
+   uint32_t version;
+   uint32_t num_slots;
+   /* Set once the files have been replaced by a compaction. */
+   uint32_t stale;
+   /* Total size of the records referenced by the index. */
+   uint64_t live_size;
+   /* End of the data in the archive file, where the next record goes. */
+   uint64_t data_size;
+   uint64_t num_entries;
+   uint64_t clock;
+};
+
+struct archive_slot {
+   uint8_t key[CACHE_KEY_SIZE];
+   /* Size of the record including its header, or EMPTY / DELETED. */
+   uint32_t size;
+   uint64_t offset;
+   uint64_t last_used;
+};
+
+struct archive_record {
+   uint8_t key[CACHE_KEY_SIZE];
+   uint32_t flags;
+   /* Size of the data following this header in the archive. */
+   uint32_t stored_size;
+   /* Size of the object once uncompressed. */
+   uint32_t size;
+   uint32_t crc;
+   uint32_t pad;
+};
+
+struct disk_cache_archive {
+   char *data_path;
+   char *index_path;
+
+   int data_fd;
+   int index_fd;
+
+   struct archive_header *header;
+   struct archive_slot *slots;
+   size_t index_size;
+
+   uint64_t max_size;
+
+   /* Protects everything below and the file descriptors, which are replaced
+    * when another process compacts the archive.
+    */
+   mtx_t mutex;
+
+   /* Records not written to the archive yet. */
+   uint8_t *pending;
+   size_t pending_size;
+   size_t pending_alloc;
+   unsigned num_pending;
+};
+
+/* Records are padded to keep their headers aligned. */
+static uint32_t
+record_size(const struct archive_record *rec)
+{
+   return (sizeof(*rec) + rec->stored_size + 7) & ~7;
+}
+
+static bool
+write_all(int fd, const void *data, size_t size, off_t offset)
+{
+   const uint8_t *p = data;
+   ssize_t ret;
+   size_t len;
+
+   for (len = 0; len < size; len += ret) {
+      ret = pwrite(fd, p + len, size - len, offset + len);
+      if (ret == -1 && errno != EINTR)
+         return false;
+      if (ret == -1)
+         ret = 0;
+   }
+
+   return true;
+}
+
+static bool
+read_all(int fd, void *data, size_t size, off_t offset)
+{
+   uint8_t *p = data;
+   ssize_t ret;
+   size_t len;
+
+   for (len = 0; len < size; len += ret) {
+      ret = pread(fd, p + len, size - len, offset + len);
+      if (ret == 0 || (ret == -1 && errno != EINTR))
+         return false;
+      if (ret == -1)
+         ret = 0;
+   }
+
+   return true;
+}
+
+static void
+close_files(struct disk_cache_archive *archive)
+{
+   if (archive->header)
+      munmap(archive->header, archive->index_size);
+   if (archive->index_fd != -1)
+      close(archive->index_fd);
+   if (archive->data_fd != -1)
+      close(archive->data_fd);
+
+   archive->header = NULL;
+   archive->slots = NULL;
+   archive->index_fd = -1;
+   archive->data_fd = -1;
+}
+
+static void
+reset_index(struct archive_header *header)
+{
+   memset(header, 0, sizeof(*header) +
+          ARCHIVE_INDEX_SLOTS * sizeof(struct archive_slot));
+   header->version = ARCHIVE_VERSION;
+   header->num_slots = ARCHIVE_INDEX_SLOTS;
+   header->magic = ARCHIVE_MAGIC;
+}
+
+static bool
+open_files(struct disk_cache_archive *archive)
+{
+   struct stat sb;
+   void *map;
+
+ retry:
+   archive->index_fd = open(archive->index_path,
+                            O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+   if (archive->index_fd == -1)
+      goto fail;
+
+   archive->data_fd = open(archive->data_path,
+                           O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+   if (archive->data_fd == -1)
+      goto fail;
+
+   /* Lock while checking the index, so that two processes creating the
+    * archive at the same time don't both initialize it.
+    */
+   if (flock(archive->index_fd, LOCK_EX) == -1)
+      goto fail;
+
+   if (fstat(archive->index_fd, &sb) == -1)
+      goto fail_unlock;
+
+   if (sb.st_size != archive->index_size &&
+       ftruncate(archive->index_fd, archive->index_size) == -1)
+      goto fail_unlock;
+
+   map = mmap(NULL, archive->index_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED, archive->index_fd, 0);
+   if (map == MAP_FAILED)
+      goto fail_unlock;
+
+   archive->header = map;
+   archive->slots = (struct archive_slot *)(archive->header + 1);
+
+   /* Replaced by a compaction since we opened it. */
+   if (archive->header->stale) {
+      flock(archive->index_fd, LOCK_UN);
+      close_files(archive);
+      goto retry;
+   }
+
+   /* A new file, or one written by an incompatible version: start over. */
+   if (archive->header->magic != ARCHIVE_MAGIC ||
+       archive->header->version != ARCHIVE_VERSION ||
+       archive->header->num_slots != ARCHIVE_INDEX_SLOTS) {
+      if (ftruncate(archive->data_fd, 0) == -1)
+         goto fail_unlock;
+      reset_index(archive->header);
+   }
+
+   flock(archive->index_fd, LOCK_UN);
+   return true;
+
+ fail_unlock:
+   flock(archive->index_fd, LOCK_UN);
+ fail:
+   close_files(archive);
+   return false;
+}
+
+/* Reopen the files if another process compacted the archive.
+ */
+static bool
+reopen_if_stale(struct disk_cache_archive *archive)
+{
+   if (archive->header && !p_atomic_read(&archive->header->stale))
+      return true;
+
+   close_files(archive);
+   return open_files(archive);
+}
+
+/* Take the lock on the index, making sure it is the current one.
+ */
+static bool
+lock_index(struct disk_cache_archive *archive)
+{
+   while (true) {
+      if (!reopen_if_stale(archive))
+         return false;
+
+      if (flock(archive->index_fd, LOCK_EX) == -1)
+         return false;
+
+      if (!archive->header->stale)
+         return true;
+
+      flock(archive->index_fd, LOCK_UN);
+   }
+}
+
+static void
+unlock_index(struct disk_cache_archive *archive)
+{
+   flock(archive->index_fd, LOCK_UN);
+}
+
+static struct archive_slot *
+lookup_slot(struct archive_slot *slots, const uint8_t *key)
+{
+   const uint32_t mask = ARCHIVE_INDEX_SLOTS - 1;
+   uint32_t hash, i;
+
+   memcpy(&hash, key, sizeof(hash));
+
+   for (i = 0; i < ARCHIVE_INDEX_SLOTS; i++) {
+      struct archive_slot *slot = &slots[(hash + i) & mask];
+
+      if (slot->size == ARCHIVE_SLOT_EMPTY)
+         return NULL;
+
+      if (slot->size != ARCHIVE_SLOT_DELETED &&
+          memcmp(slot->key, key, CACHE_KEY_SIZE) == 0)
+         return slot;
+   }
+
+   return NULL;
+}
+
+/* Add a record to the index. The lock on the index must be held.
+ *
+ * Returns false if the key is already present.
+ */
+static bool
+insert_slot(struct archive_header *header, struct archive_slot *slots,
+            const uint8_t *key, uint64_t offset, uint32_t size,
+            uint64_t last_used)
+{
+   const uint32_t mask = ARCHIVE_INDEX_SLOTS - 1;
+   struct archive_slot *free_slot = NULL;
+   uint32_t hash, i;
+
+   memcpy(&hash, key, sizeof(hash));
+
+   for (i = 0; i < ARCHIVE_INDEX_SLOTS; i++) {
+      struct archive_slot *slot = &slots[(hash + i) & mask];
+
+      if (slot->size == ARCHIVE_SLOT_EMPTY) {
+         if (!free_slot)
+            free_slot = slot;
+         break;
+      }
+
+      if (slot->size == ARCHIVE_SLOT_DELETED) {
+         if (!free_slot)
+            free_slot = slot;
+         continue;
+      }
+
+      if (memcmp(slot->key, key, CACHE_KEY_SIZE) == 0)
+         return false;
+   }
+
+   if (!free_slot)
+      return false;
+
+   /* Lockless readers check the size first, so write it last. */
+   free_slot->size = ARCHIVE_SLOT_DELETED;
+   memcpy(free_slot->key, key, CACHE_KEY_SIZE);
+   free_slot->offset = offset;
+   free_slot->last_used = last_used;
+   p_atomic_set(&free_slot->size, size);
+
+   header->live_size += size;
+   header->num_entries++;
+
+   return true;
+}
+
+struct lru_entry {
+   uint64_t last_used;
+   uint32_t slot;
+};
+
+static int
+compare_lru_entries(const void *a, const void *b)
+{
+   const struct lru_entry *ea = a, *eb = b;
+
+   if (ea->last_used != eb->last_used)
+      return ea->last_used < eb->last_used ? -1 : 1;
+   return 0;
+}
+
+/* Drop the least recently used records until \size bytes in \count records
+ * fit. The lock on the index must be held.
+ */
+static void
+evict_locked(struct disk_cache_archive *archive, size_t size, unsigned count)
+{
+   struct archive_header *header = archive->header;
+   const uint64_t low_water = archive->max_size - archive->max_size / 10;
+   const uint64_t low_water_entries =
+      ARCHIVE_MAX_ENTRIES - ARCHIVE_MAX_ENTRIES / 10;
+   struct lru_entry *entries;
+   uint64_t num_entries = 0;
+   uint32_t i;
+
+   if (header->live_size + size <= archive->max_size &&
+       header->num_entries + count <= ARCHIVE_MAX_ENTRIES)
+      return;
+
+   entries = malloc(header->num_entries * sizeof(*entries));
+   if (!entries)
+      return;
+
+   for (i = 0; i < ARCHIVE_INDEX_SLOTS && num_entries < header->num_entries;
+        i++) {
+      const struct archive_slot *slot = &archive->slots[i];
+
+      if (slot->size == ARCHIVE_SLOT_EMPTY ||
+          slot->size == ARCHIVE_SLOT_DELETED)
+         continue;
+
+      entries[num_entries].last_used = slot->last_used;
+      entries[num_entries].slot = i;
+      num_entries++;
+   }
+
+   qsort(entries, num_entries, sizeof(*entries), compare_lru_entries);
+
+   /* Evict a bit more than needed so that this doesn't happen on every put
+    * of a full cache.
+    */
+   for (i = 0; i < num_entries; i++) {
+      struct archive_slot *slot = &archive->slots[entries[i].slot];
+
+      if (header->live_size + size <= low_water &&
+          header->num_entries + count <= low_water_entries)
+         break;
+
+      header->live_size -= slot->size;
+      header->num_entries--;
+      p_atomic_set(&slot->size, ARCHIVE_SLOT_DELETED);
+   }
+
+   free(entries);
+}
+
+static int
+compare_offsets(const void *a, const void *b)
+{
+   const struct archive_slot *sa = *(const struct archive_slot **)a;
+   const struct archive_slot *sb = *(const struct archive_slot **)b;
+
+   if (sa->offset != sb->offset)
+      return sa->offset < sb->offset ? -1 : 1;
+   return 0;
+}
+
+/* Copy the live records to new files and replace the current ones with them.
+ * The lock on the index must be held, and is kept on the new index.
+ */
+static void
+compact_locked(struct disk_cache_archive *archive)
+{
+   struct archive_header *header = archive->header;
+   struct archive_slot **live = NULL;
+   struct archive_header *new_header = NULL;
+   struct archive_slot *new_slots;
+   char *data_tmp = NULL, *index_tmp = NULL;
+   int data_fd = -1, index_fd = -1;
+   uint8_t *buf = NULL;
+   size_t buf_size = 0;
+   uint64_t num_live = 0, offset = 0;
+   uint32_t i;
+   void *map;
+
+   data_tmp = ralloc_asprintf(archive, "%s.tmp", archive->data_path);
+   index_tmp = ralloc_asprintf(archive, "%s.tmp", archive->index_path);
+   if (!data_tmp || !index_tmp)
+      goto fail;
+
+   data_fd = open(data_tmp, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+   if (data_fd == -1)
+      goto fail;
+
+   index_fd = open(index_tmp, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+   if (index_fd == -1)
+      goto fail;
+
+   if (flock(index_fd, LOCK_EX) == -1 ||
+       ftruncate(index_fd, archive->index_size) == -1)
+      goto fail;
+
+   map = mmap(NULL, archive->index_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED, index_fd, 0);
+   if (map == MAP_FAILED)
+      goto fail;
+
+   new_header = map;
+   new_slots = (struct archive_slot *)(new_header + 1);
+   reset_index(new_header);
+   new_header->clock = header->clock;
+
+   /* Copy the records in file order, to keep the reads sequential. */
+   live = malloc(header->num_entries * sizeof(*live));
+   if (!live)
+      goto fail;
+
+   for (i = 0; i < ARCHIVE_INDEX_SLOTS && num_live < header->num_entries;
+        i++) {
+      struct archive_slot *slot = &archive->slots[i];
+
+      if (slot->size != ARCHIVE_SLOT_EMPTY &&
+          slot->size != ARCHIVE_SLOT_DELETED)
+         live[num_live++] = slot;
+   }
+
+   qsort(live, num_live, sizeof(*live), compare_offsets);
+
+   for (i = 0; i < num_live; i++) {
+      const struct archive_slot *slot = live[i];
+
+      if (slot->size > buf_size) {
+         uint8_t *new_buf = realloc(buf, slot->size);
+         if (!new_buf)
+            goto fail;
+         buf = new_buf;
+         buf_size = slot->size;
+      }
+
+      if (!read_all(archive->data_fd, buf, slot->size, slot->offset) ||
+          !write_all(data_fd, buf, slot->size, offset))
+         goto fail;
+
+      insert_slot(new_header, new_slots, slot->key, offset, slot->size,
+                  slot->last_used);
+      offset += slot->size;
+   }
+
+   new_header->data_size = offset;
+
+   if (rename(data_tmp, archive->data_path) == -1)
+      goto fail;
+   if (rename(index_tmp, archive->index_path) == -1)
+      goto fail;
+
+   /* Send the other processes to the new files. */
+   p_atomic_set(&header->stale, 1);
+   unlock_index(archive);
+   close_files(archive);
+
+   archive->data_fd = data_fd;
+   archive->index_fd = index_fd;
+   archive->header = new_header;
+   archive->slots = new_slots;
+
+   free(buf);
+   free(live);
+   ralloc_free(data_tmp);
+   ralloc_free(index_tmp);
+   return;
+
+ fail:
+   /* The current files are still fine, just keep using them. */
+   if (new_header)
+      munmap(new_header, archive->index_size);
+   if (index_fd != -1) {
+      unlink(index_tmp);
+      close(index_fd);
+   }
+   if (data_fd != -1) {
+      unlink(data_tmp);
+      close(data_fd);
+   }
+   free(buf);
+   free(live);
+   ralloc_free(data_tmp);
+   ralloc_free(index_tmp);
+}
+
+/* Write out the pending records. */
+static void
+flush_locked(struct disk_cache_archive *archive)
+{
+   struct archive_header *header;
+   uint64_t offset, dead;
+   size_t pos;
+
+   if (!archive->num_pending)
+      return;
+
+   if (!lock_index(archive))
+      goto done;
+
+   header = archive->header;
+
+   evict_locked(archive, archive->pending_size, archive->num_pending);
+
+   offset = header->data_size;
+   if (!write_all(archive->data_fd, archive->pending, archive->pending_size,
+                  offset)) {
+      unlock_index(archive);
+      goto done;
+   }
+
+   for (pos = 0; pos < archive->pending_size;) {
+      const struct archive_record *rec =
+         (const struct archive_record *)(archive->pending + pos);
+      const uint32_t size = record_size(rec);
+
+      /* Another process may have stored the same object in the meantime,
+       * this copy is then simply left unreferenced.
+       */
+      insert_slot(header, archive->slots, rec->key, offset + pos, size,
+                  p_atomic_inc_return(&header->clock));
+      pos += size;
+   }
+
+   header->data_size = offset + archive->pending_size;
+
+   dead = header->data_size - header->live_size;
+   if (dead > ARCHIVE_BATCH_SIZE && dead > header->live_size)
+      compact_locked(archive);
+
+   unlock_index(archive);
+
+ done:
+   archive->pending_size = 0;
+   archive->num_pending = 0;
+}
+
+static bool
+pending_reserve(struct disk_cache_archive *archive, size_t size)
+{
+   uint8_t *pending;
+   size_t alloc;
+
+   if (archive->pending_size + size <= archive->pending_alloc)
+      return true;
+
+   alloc = MAX2(archive->pending_alloc * 2, archive->pending_size + size);
+   pending = realloc(archive->pending, alloc);
+   if (!pending)
+      return false;
+
+   archive->pending = pending;
+   archive->pending_alloc = alloc;
+   return true;
+}
+
+static const struct archive_record *
+lookup_pending(struct disk_cache_archive *archive, const uint8_t *key)
+{
+   size_t pos;
+
+   for (pos = 0; pos < archive->pending_size;) {
+      const struct archive_record *rec =
+         (const struct archive_record *)(archive->pending + pos);
+
+      if (memcmp(rec->key, key, CACHE_KEY_SIZE) == 0)
+         return rec;
+      pos += record_size(rec);
+   }
+
+   return NULL;
+}
+
+/* Return a malloc'ed copy of the object stored in a record. */
+static void *
+decode_record(const struct archive_record *rec, const uint8_t *stored)
+{
+   uint8_t *data = malloc(MAX2(rec->size, 1));
+
+   if (!data)
+      return NULL;
+
+   if (rec->flags & ARCHIVE_RECORD_COMPRESSED) {
+#ifdef HAVE_ZLIB
+      uLongf size = rec->size;
+
+      if (uncompress(data, &size, stored, rec->stored_size) != Z_OK ||
+          size != rec->size) {
+         free(data);
+         return NULL;
+      }
+#else
+      free(data);
+      return NULL;
+#endif
+   } else {
+      memcpy(data, stored, rec->size);
+   }
+
+   return data;
+}
+
+struct disk_cache_archive *
+disk_cache_archive_create(void *mem_ctx, const char *path, uint64_t max_size)
+{
+   struct disk_cache_archive *archive;
+
+   archive = rzalloc(mem_ctx, struct disk_cache_archive);
+   if (!archive)
+      return NULL;
+
+   archive->data_path = ralloc_asprintf(archive, "%s/archive", path);
+   archive->index_path = ralloc_asprintf(archive, "%s/archive.idx", path);
+   if (!archive->data_path || !archive->index_path)
+      goto fail;
+
+   archive->data_fd = -1;
+   archive->index_fd = -1;
+   archive->index_size = sizeof(struct archive_header) +
+                         ARCHIVE_INDEX_SLOTS * sizeof(struct archive_slot);
+   archive->max_size = max_size;
+
+   if (!open_files(archive))
+      goto fail;
+
+   mtx_init(&archive->mutex, mtx_plain);
+
+   return archive;
+
+ fail:
+   ralloc_free(archive);
+   return NULL;
+}
+
+void
+disk_cache_archive_destroy(struct disk_cache_archive *archive)
+{
+   mtx_lock(&archive->mutex);
+   flush_locked(archive);
+   mtx_unlock(&archive->mutex);
+
+   close_files(archive);
+   free(archive->pending);
+   mtx_destroy(&archive->mutex);
+   ralloc_free(archive);
+}
+
+void
+disk_cache_archive_flush(struct disk_cache_archive *archive)
+{
+   mtx_lock(&archive->mutex);
+   flush_locked(archive);
+   mtx_unlock(&archive->mutex);
+}
+
+void
+disk_cache_archive_put(struct disk_cache_archive *archive, cache_key key,
+                       const void *data, size_t size)
+{
+   struct archive_record *rec;
+   size_t max_stored = size;
+
+   if (size > UINT32_MAX / 2)
+      return;
+
+#ifdef HAVE_ZLIB
+   max_stored = MAX2(compressBound(size), size);
+#endif
+
+   mtx_lock(&archive->mutex);
+
+   if (lookup_pending(archive, key) ||
+       (reopen_if_stale(archive) && lookup_slot(archive->slots, key)))
+      goto done;
+
+   if (!pending_reserve(archive, sizeof(*rec) + max_stored + 7))
+      goto done;
+
+   rec = (struct archive_record *)(archive->pending + archive->pending_size);
+   memcpy(rec->key, key, CACHE_KEY_SIZE);
+   rec->flags = 0;
+   rec->pad = 0;
+   rec->size = size;
+   rec->stored_size = size;
+
+#ifdef HAVE_ZLIB
+   {
+      uLongf stored_size = max_stored;
+
+      /* Only keep the compressed data if it is any smaller. */
+      if (compress2((uint8_t *)(rec + 1), &stored_size, data, size,
+                    Z_BEST_SPEED) == Z_OK && stored_size < size) {
+         rec->flags |= ARCHIVE_RECORD_COMPRESSED;
+         rec->stored_size = stored_size;
+      }
+   }
+#endif
+
+   if (!(rec->flags & ARCHIVE_RECORD_COMPRESSED))
+      memcpy(rec + 1, data, size);
+
+   rec->crc = util_hash_crc32(rec + 1, rec->stored_size);
+   memset((uint8_t *)(rec + 1) + rec->stored_size, 0,
+          record_size(rec) - sizeof(*rec) - rec->stored_size);
+
+   archive->pending_size += record_size(rec);
+   archive->num_pending++;
+
+   if (archive->pending_size >= ARCHIVE_BATCH_SIZE ||
+       archive->num_pending >= ARCHIVE_BATCH_COUNT)
+      flush_locked(archive);
+
+ done:
+   mtx_unlock(&archive->mutex);
+}
+
+void *
+disk_cache_archive_get(struct disk_cache_archive *archive, cache_key key,
+                       size_t *size)
+{
+   const struct archive_record *pending;
+   struct archive_record *rec = NULL;
+   struct archive_slot *slot;
+   uint64_t offset;
+   uint32_t rec_size;
+   void *data = NULL;
+
+   mtx_lock(&archive->mutex);
+
+   pending = lookup_pending(archive, key);
+   if (pending) {
+      data = decode_record(pending, (const uint8_t *)(pending + 1));
+      if (data && size)
+         *size = pending->size;
+      goto done;
+   }
+
+   if (!reopen_if_stale(archive))
+      goto done;
+
+   slot = lookup_slot(archive->slots, key);
+   if (!slot)
+      goto done;
+
+   offset = slot->offset;
+   rec_size = p_atomic_read(&slot->size);
+   if (rec_size < sizeof(*rec) || rec_size == ARCHIVE_SLOT_DELETED)
+      goto done;
+
+   rec = malloc(rec_size);
+   if (!rec)
+      goto done;
+
+   if (!read_all(archive->data_fd, rec, rec_size, offset))
+      goto done;
+
+   /* The slot may have been reused under us, or the record be corrupt. */
+   if (memcmp(rec->key, key, CACHE_KEY_SIZE) != 0 ||
+       record_size(rec) != rec_size ||
+       util_hash_crc32(rec + 1, rec->stored_size) != rec->crc)
+      goto done;
+
+   data = decode_record(rec, (const uint8_t *)(rec + 1));
+   if (!data)
+      goto done;
+
+   if (size)
+      *size = rec->size;
+
+   slot->last_used = p_atomic_inc_return(&archive->header->clock);
+
+ done:
+   mtx_unlock(&archive->mutex);
+   free(rec);
+   return data;
+}
+
+#endif /* ENABLE_SHADER_CACHE */
@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef DISK_CACHE_ARCHIVE_H
+#define DISK_CACHE_ARCHIVE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "disk_cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Single-file storage backend of the disk cache, used instead of one file
+ * per object when MESA_GLSL_CACHE_ARCHIVE is set. Only meant to be used by
+ * disk_cache.c.
+ */
+struct disk_cache_archive;
+
+/**
+ * Open (creating it if needed) the archive within the cache directory
+ * \path. The archive is ralloc'ed off \mem_ctx.
+ *
+ * Returns NULL on any error.
+ */
+struct disk_cache_archive *
+disk_cache_archive_create(void *mem_ctx, const char *path, uint64_t max_size);
+
+/**
+ * Write out all pending objects and close the archive.
+ */
+void
+disk_cache_archive_destroy(struct disk_cache_archive *archive);
+
+void
+disk_cache_archive_put(struct disk_cache_archive *archive, cache_key key,
+                       const void *data, size_t size);
+
+void *
+disk_cache_archive_get(struct disk_cache_archive *archive, cache_key key,
+                       size_t *size);
+
+/**
+ * Write out all pending objects.
+ */
+void
+disk_cache_archive_flush(struct disk_cache_archive *archive);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISK_CACHE_ARCHIVE_H */
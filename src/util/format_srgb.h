@@ -109,6 +109,15 @@ util_format_linear_float_to_srgb_8unorm(float x)
 }
 
 
+/**
+ * Convert an array of unclamped linear floats to srgb values in [0,255],
+ * with the same results as util_format_linear_float_to_srgb_8unorm().
+ */
+void
+util_format_linear_float_to_srgb_8unorm_array(uint8_t *dst, const float *src,
+                                              unsigned count);
+
+
 /**
  * Convert an 8-bit sRGB value from non-linear space to a
  * linear RGB value in [0, 1].
@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Conversion of whole arrays of linear floats to sRGB, giving the same
+ * results as util_format_linear_float_to_srgb_8unorm().
+ */
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "format_srgb.h"
+
+#ifdef __SSE2__
+
+/* Converts 4 floats, following util_format_linear_float_to_srgb_8unorm()
+ * step by step.  Returns the results in the low byte of each lane.
+ */
+static inline __m128i
+linear_float_to_srgb_8unorm_sse2(__m128 x)
+{
+   const __m128i minval = _mm_set1_epi32((127 - 13) << 23);
+   const __m128i almostone = _mm_set1_epi32(0x3f7fffff);
+   __m128i ui, idx, tab, t, bias, scale, lo, hi;
+
+   /* maxps returns its second operand if either is a NaN, so NaNs map to 0
+    * like in the scalar version.
+    */
+   x = _mm_max_ps(x, _mm_castsi128_ps(minval));
+   x = _mm_min_ps(x, _mm_castsi128_ps(almostone));
+   ui = _mm_castps_si128(x);
+
+   /* There is no gather, so do the table lookups one lane at a time.  The
+    * indices are below 104, so the low word of each lane is enough.
+    */
+   idx = _mm_srli_epi32(_mm_sub_epi32(ui, minval), 20);
+   tab = _mm_setr_epi32(
+      util_format_linear_to_srgb_helper_table[_mm_extract_epi16(idx, 0)],
+      util_format_linear_to_srgb_helper_table[_mm_extract_epi16(idx, 2)],
+      util_format_linear_to_srgb_helper_table[_mm_extract_epi16(idx, 4)],
+      util_format_linear_to_srgb_helper_table[_mm_extract_epi16(idx, 6)]);
+
+   bias = _mm_slli_epi32(_mm_srli_epi32(tab, 16), 9);
+   scale = _mm_and_si128(tab, _mm_set1_epi32(0xffff));
+   t = _mm_and_si128(_mm_srli_epi32(ui, 12), _mm_set1_epi32(0xff));
+
+   /* scale and t both fit in 16 bits, so their 32-bit product can be put
+    * together from the 16-bit multiplies that SSE2 has.
+    */
+   lo = _mm_mullo_epi16(scale, t);
+   hi = _mm_mulhi_epu16(scale, t);
+
+   return _mm_srli_epi32(_mm_add_epi32(bias,
+                                       _mm_or_si128(lo,
+                                                    _mm_slli_epi32(hi, 16))),
+                         16);
+}
+
+#endif
+
+/**
+ * Converts \count unclamped linear floats to sRGB values in [0,255].
+ */
+void
+util_format_linear_float_to_srgb_8unorm_array(uint8_t *dst, const float *src,
+                                              unsigned count)
+{
+   unsigned i = 0;
+
+#ifdef __SSE2__
+   for (; i + 16 <= count; i += 16) {
+      __m128i a = linear_float_to_srgb_8unorm_sse2(_mm_loadu_ps(src + i));
+      __m128i b = linear_float_to_srgb_8unorm_sse2(_mm_loadu_ps(src + i + 4));
+      __m128i c = linear_float_to_srgb_8unorm_sse2(_mm_loadu_ps(src + i + 8));
+      __m128i d = linear_float_to_srgb_8unorm_sse2(_mm_loadu_ps(src + i + 12));
+
+      _mm_storeu_si128((__m128i *)(dst + i),
+                       _mm_packus_epi16(_mm_packs_epi32(a, b),
+                                        _mm_packs_epi32(c, d)));
+   }
+#endif
+
+   for (; i < count; i++)
+      dst[i] = util_format_linear_float_to_srgb_8unorm(src[i]);
+}
@@ -24,9 +24,25 @@
 
 #include <math.h>
 #include <assert.h>
+#include <stdbool.h>
 #include "half_float.h"
 #include "rounding.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef USE_F16C
+#include <cpuid.h>
+#include "c11/threads.h"
+
+/* half_float_f16c.c */
+void _mesa_float_to_half_array_f16c(uint16_t *dst, const float *src,
+                                    unsigned count);
+void _mesa_half_to_float_array_f16c(float *dst, const uint16_t *src,
+                                    unsigned count);
+#endif
+
 typedef union { float f; int32_t i; uint32_t u; } fi_type;
 
 /**
@@ -175,3 +191,177 @@ _mesa_half_to_float(uint16_t val)
    result = fi.f;
    return result;
 }
+
+
+#ifdef USE_F16C
+static bool f16c_supported;
+
+static void
+detect_f16c(void)
+{
+   unsigned eax, ebx, ecx, edx, xcr0;
+
+   if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return;
+
+   /* The F16C instructions are VEX encoded, so they also need the OS to
+    * save the AVX state.
+    */
+   if (!(ecx & bit_F16C) || !(ecx & bit_AVX) || !(ecx & bit_OSXSAVE))
+      return;
+
+   __asm__ ("xgetbv" : "=a" (xcr0) : "c" (0) : "%edx");
+   f16c_supported = (xcr0 & 6) == 6;
+}
+
+static bool
+has_f16c(void)
+{
+   static once_flag flag = ONCE_FLAG_INIT;
+
+   call_once(&flag, detect_f16c);
+   return f16c_supported;
+}
+#endif
+
+#ifdef __SSE2__
+/* Bit-twiddling versions of the scalar conversions for four values at a
+ * time, returning the same results for anything but NaNs.
+ */
+static inline __m128i
+float_to_half_sse2(__m128 val)
+{
+   const __m128i sign_mask = _mm_set1_epi32(0x80000000);
+   const __m128i f16max = _mm_set1_epi32((127 + 16) << 23);
+   const __m128i f32infty = _mm_set1_epi32(255 << 23);
+   const __m128i min_normal = _mm_set1_epi32(113 << 23);
+   const __m128i denorm_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+   __m128i f = _mm_castps_si128(val);
+   __m128i sign = _mm_and_si128(f, sign_mask);
+   __m128i inf_nan, denorm, normal, is_denorm, is_inf_nan, res;
+
+   f = _mm_xor_si128(f, sign);
+
+   /* Too large values become infinity, NaNs stay NaNs. */
+   inf_nan = _mm_or_si128(_mm_set1_epi32(0x7c00),
+                          _mm_srli_epi32(_mm_cmpgt_epi32(f, f32infty), 31));
+
+   /* Values below the smallest normal half are rounded by the FPU by
+    * adding a magic number that aligns the mantissa bits we want at the
+    * bottom of the float.
+    */
+   denorm = _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f),
+                                        _mm_castsi128_ps(denorm_magic)));
+   denorm = _mm_sub_epi32(denorm, denorm_magic);
+
+   /* Normal values: rebias the exponent and round to nearest even. */
+   normal = _mm_add_epi32(f, _mm_set1_epi32(((15 - 127) << 23) + 0xfff));
+   normal = _mm_add_epi32(normal,
+                          _mm_and_si128(_mm_srli_epi32(f, 13),
+                                        _mm_set1_epi32(1)));
+   normal = _mm_srli_epi32(normal, 13);
+
+   is_denorm = _mm_cmplt_epi32(f, min_normal);
+   is_inf_nan = _mm_cmplt_epi32(_mm_sub_epi32(f16max, _mm_set1_epi32(1)), f);
+
+   res = _mm_or_si128(_mm_and_si128(is_denorm, denorm),
+                      _mm_andnot_si128(is_denorm, normal));
+   res = _mm_or_si128(_mm_and_si128(is_inf_nan, inf_nan),
+                      _mm_andnot_si128(is_inf_nan, res));
+
+   /* Arithmetic shift so that the sign bit survives the signed saturation
+    * of packs.
+    */
+   return _mm_or_si128(res, _mm_srai_epi32(sign, 16));
+}
+
+static inline __m128
+half_to_float_sse2(__m128i val)
+{
+   const __m128i shifted_exp = _mm_set1_epi32(0x7c00 << 13);
+   const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+   __m128i o = _mm_slli_epi32(_mm_and_si128(val, _mm_set1_epi32(0x7fff)), 13);
+   __m128i exp = _mm_and_si128(o, shifted_exp);
+   __m128i is_inf_nan = _mm_cmpeq_epi32(exp, shifted_exp);
+   __m128i is_denorm = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+   __m128i is_nan, denorm;
+
+   o = _mm_add_epi32(o, _mm_set1_epi32((127 - 15) << 23));
+
+   /* Infinities and NaNs: adjust the exponent to all ones. */
+   o = _mm_add_epi32(o, _mm_and_si128(is_inf_nan,
+                                      _mm_set1_epi32((128 - 16) << 23)));
+
+   /* Zeros and denormals: renormalize with the FPU. */
+   denorm = _mm_add_epi32(o, _mm_set1_epi32(1 << 23));
+   denorm = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(denorm), magic));
+   o = _mm_or_si128(_mm_and_si128(is_denorm, denorm),
+                    _mm_andnot_si128(is_denorm, o));
+
+   /* Match the scalar version which always returns the same NaN. */
+   is_nan = _mm_cmpgt_epi32(o, _mm_set1_epi32(0x7f800000));
+   o = _mm_or_si128(_mm_and_si128(is_nan, _mm_set1_epi32(0x7f800001)),
+                    _mm_andnot_si128(is_nan, o));
+
+   return _mm_castsi128_ps(
+      _mm_or_si128(o, _mm_slli_epi32(_mm_and_si128(val,
+                                                   _mm_set1_epi32(0x8000)),
+                                     16)));
+}
+#endif
+
+/**
+ * Convert an array of floats to half floats.
+ */
+void
+_mesa_float_to_half_array(uint16_t *dst, const float *src, unsigned count)
+{
+   unsigned i = 0;
+
+#ifdef USE_F16C
+   if (has_f16c()) {
+      _mesa_float_to_half_array_f16c(dst, src, count);
+      return;
+   }
+#endif
+
+#ifdef __SSE2__
+   for (; i + 8 <= count; i += 8) {
+      __m128i lo = float_to_half_sse2(_mm_loadu_ps(src + i));
+      __m128i hi = float_to_half_sse2(_mm_loadu_ps(src + i + 4));
+      _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+   }
+#endif
+
+   for (; i < count; i++)
+      dst[i] = _mesa_float_to_half(src[i]);
+}
+
+/**
+ * Convert an array of half floats to floats.
+ */
+void
+_mesa_half_to_float_array(float *dst, const uint16_t *src, unsigned count)
+{
+   unsigned i = 0;
+
+#ifdef USE_F16C
+   if (has_f16c()) {
+      _mesa_half_to_float_array_f16c(dst, src, count);
+      return;
+   }
+#endif
+
+#ifdef __SSE2__
+   for (; i + 8 <= count; i += 8) {
+      __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+      __m128i zero = _mm_setzero_si128();
+      _mm_storeu_ps(dst + i, half_to_float_sse2(_mm_unpacklo_epi16(h, zero)));
+      _mm_storeu_ps(dst + i + 4,
+                    half_to_float_sse2(_mm_unpackhi_epi16(h, zero)));
+   }
+#endif
+
+   for (; i < count; i++)
+      dst[i] = _mesa_half_to_float(src[i]);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Array half float conversions using the F16C instructions.  This file is
+ * built with F16C_CFLAGS, and only called after checking that the CPU
+ * supports them.
+ */
+
+#ifdef USE_F16C
+
+#include <immintrin.h>
+#include "half_float.h"
+
+void _mesa_float_to_half_array_f16c(uint16_t *dst, const float *src,
+                                    unsigned count);
+void _mesa_half_to_float_array_f16c(float *dst, const uint16_t *src,
+                                    unsigned count);
+
+void
+_mesa_float_to_half_array_f16c(uint16_t *dst, const float *src,
+                               unsigned count)
+{
+   unsigned i = 0;
+
+   for (; i + 8 <= count; i += 8) {
+      __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                  _MM_FROUND_TO_NEAREST_INT);
+      _mm_storeu_si128((__m128i *)(dst + i), h);
+   }
+
+   for (; i < count; i++)
+      dst[i] = _mesa_float_to_half(src[i]);
+}
+
+void
+_mesa_half_to_float_array_f16c(float *dst, const uint16_t *src,
+                               unsigned count)
+{
+   unsigned i = 0;
+
+   for (; i + 8 <= count; i += 8) {
+      __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+      _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+   }
+
+   for (; i < count; i++)
+      dst[i] = _mesa_half_to_float(src[i]);
+}
+
+#endif
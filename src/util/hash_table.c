@@ -219,7 +219,11 @@ hash_table_search(struct hash_table *ht, uint32_t hash, const void *key)
       if (entry_is_free(entry)) {
          return NULL;
       } else if (entry_is_present(ht, entry) && entry->hash == hash) {
-         if (ht->key_equals_function(key, entry->key)) {
+         /* Identical keys are always equal; this saves the indirect call
+          * for tables keyed on pointers, where it is the common case.
+          */
+         if (key == entry->key ||
+             ht->key_equals_function(key, entry->key)) {
             return entry;
          }
       }
@@ -330,7 +334,8 @@ hash_table_insert(struct hash_table *ht, uint32_t hash,
        */
       if (!entry_is_deleted(ht, entry) &&
           entry->hash == hash &&
-          ht->key_equals_function(key, entry->key)) {
+          (key == entry->key ||
+           ht->key_equals_function(key, entry->key))) {
          entry->key = key;
          entry->data = data;
          return entry;
@@ -0,0 +1,375 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Implements an open-addressing hash table for pointer and uint32_t keys.
+ *
+ * Every slot has a control byte, which is either EMPTY, DELETED, or holds
+ * the top 7 bits of the hash of the key stored in the slot.  The table is
+ * probed a group of 16 control bytes at a time (with a single SSE2 compare
+ * when available), so only the slots whose hash bits match have their key
+ * loaded.  A probe stops at the first group containing an EMPTY slot.
+ *
+ * The first GROUP_SIZE control bytes are duplicated after the end of the
+ * control array, so that a group can start at any slot without wrapping.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "pointer_hash_table.h"
+#include "bitscan.h"
+#include "ralloc.h"
+
+#define GROUP_SIZE 16
+#define MIN_SIZE   16
+
+#define CTRL_EMPTY   0x80
+#define CTRL_DELETED 0xfe
+
+static inline uint64_t
+hash_key(const void *key)
+{
+   return (uint64_t)(uintptr_t)key * 0x9e3779b97f4a7c15ull;
+}
+
+static inline uint32_t
+hash_h1(uint64_t hash)
+{
+   return (uint32_t)(hash >> 32);
+}
+
+static inline uint8_t
+hash_h2(uint64_t hash)
+{
+   return hash >> 57;
+}
+
+static inline bool
+ctrl_is_full(uint8_t ctrl)
+{
+   return (ctrl & 0x80) == 0;
+}
+
+/* Largest number of used (full or deleted) slots before the table needs to
+ * be rehashed: 7/8 of the slots.
+ */
+static inline uint32_t
+max_used(uint32_t size)
+{
+   return size - size / 8;
+}
+
+/* Returns a bitmask of the slots of the group at ctrl with the byte value b.
+ */
+static inline unsigned
+group_match(const uint8_t *ctrl, uint8_t b)
+{
+#ifdef __SSE2__
+   __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+   return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(b)));
+#else
+   unsigned mask = 0;
+   for (unsigned i = 0; i < GROUP_SIZE; i++) {
+      if (ctrl[i] == b)
+         mask |= 1u << i;
+   }
+   return mask;
+#endif
+}
+
+/* Returns a bitmask of the EMPTY or DELETED slots of the group at ctrl. */
+static inline unsigned
+group_match_free(const uint8_t *ctrl)
+{
+#ifdef __SSE2__
+   __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+   return _mm_movemask_epi8(group);
+#else
+   unsigned mask = 0;
+   for (unsigned i = 0; i < GROUP_SIZE; i++) {
+      if (!ctrl_is_full(ctrl[i]))
+         mask |= 1u << i;
+   }
+   return mask;
+#endif
+}
+
+static inline void
+set_ctrl(struct pointer_hash_table *ht, uint32_t i, uint8_t ctrl)
+{
+   ht->ctrl[i] = ctrl;
+   if (i < GROUP_SIZE)
+      ht->ctrl[ht->size + i] = ctrl;
+}
+
+static bool
+alloc_arrays(void *mem_ctx, uint32_t size,
+             uint8_t **ctrl, struct pointer_hash_entry **table)
+{
+   *ctrl = ralloc_array(mem_ctx, uint8_t, size + GROUP_SIZE);
+   *table = ralloc_array(mem_ctx, struct pointer_hash_entry, size);
+   if (*ctrl == NULL || *table == NULL) {
+      ralloc_free(*ctrl);
+      ralloc_free(*table);
+      return false;
+   }
+
+   memset(*ctrl, CTRL_EMPTY, size + GROUP_SIZE);
+   return true;
+}
+
+struct pointer_hash_table *
+_mesa_pointer_hash_table_create(void *mem_ctx)
+{
+   struct pointer_hash_table *ht;
+
+   ht = ralloc(mem_ctx, struct pointer_hash_table);
+   if (ht == NULL)
+      return NULL;
+
+   ht->size = MIN_SIZE;
+   ht->entries = 0;
+   ht->deleted_entries = 0;
+
+   if (!alloc_arrays(ht, ht->size, &ht->ctrl, &ht->table)) {
+      ralloc_free(ht);
+      return NULL;
+   }
+
+   return ht;
+}
+
+/**
+ * Frees the given hash table.
+ *
+ * If delete_function is passed, it gets called on each entry present before
+ * freeing.
+ */
+void
+_mesa_pointer_hash_table_destroy(struct pointer_hash_table *ht,
+                                 void (*delete_function)(struct pointer_hash_entry *entry))
+{
+   if (!ht)
+      return;
+
+   if (delete_function) {
+      struct pointer_hash_entry *entry;
+
+      pointer_hash_table_foreach(ht, entry) {
+         delete_function(entry);
+      }
+   }
+   ralloc_free(ht);
+}
+
+/**
+ * Deletes all entries of the given hash table, keeping its current size.
+ */
+void
+_mesa_pointer_hash_table_clear(struct pointer_hash_table *ht)
+{
+   memset(ht->ctrl, CTRL_EMPTY, ht->size + GROUP_SIZE);
+   ht->entries = 0;
+   ht->deleted_entries = 0;
+}
+
+/**
+ * Finds a hash table entry with the given key.
+ *
+ * Returns NULL if no entry is found.
+ */
+struct pointer_hash_entry *
+_mesa_pointer_hash_table_search(struct pointer_hash_table *ht,
+                                const void *key)
+{
+   uint64_t hash = hash_key(key);
+   uint8_t h2 = hash_h2(hash);
+   uint32_t mask = ht->size - 1;
+   uint32_t pos = hash_h1(hash) & mask;
+   uint32_t stride = 0;
+
+   for (;;) {
+      const uint8_t *group = ht->ctrl + pos;
+      unsigned match = group_match(group, h2);
+
+      while (match) {
+         uint32_t i = (pos + u_bit_scan(&match)) & mask;
+         if (ht->table[i].key == key)
+            return &ht->table[i];
+      }
+
+      if (group_match(group, CTRL_EMPTY))
+         return NULL;
+
+      stride += GROUP_SIZE;
+      pos = (pos + stride) & mask;
+   }
+}
+
+/* Returns the first EMPTY or DELETED slot in the probe sequence of hash.
+ * The table must have at least one such slot.
+ */
+static uint32_t
+find_free_slot(const struct pointer_hash_table *ht, uint64_t hash)
+{
+   uint32_t mask = ht->size - 1;
+   uint32_t pos = hash_h1(hash) & mask;
+   uint32_t stride = 0;
+
+   for (;;) {
+      unsigned match = group_match_free(ht->ctrl + pos);
+
+      if (match)
+         return (pos + ffs(match) - 1) & mask;
+
+      stride += GROUP_SIZE;
+      pos = (pos + stride) & mask;
+   }
+}
+
+static bool
+pointer_hash_table_rehash(struct pointer_hash_table *ht, uint32_t new_size)
+{
+   uint8_t *old_ctrl = ht->ctrl;
+   struct pointer_hash_entry *old_table = ht->table;
+   uint32_t old_size = ht->size;
+
+   if (!alloc_arrays(ht, new_size, &ht->ctrl, &ht->table)) {
+      ht->ctrl = old_ctrl;
+      ht->table = old_table;
+      return false;
+   }
+
+   ht->size = new_size;
+   ht->deleted_entries = 0;
+
+   for (uint32_t i = 0; i < old_size; i++) {
+      if (!ctrl_is_full(old_ctrl[i]))
+         continue;
+
+      uint64_t hash = hash_key(old_table[i].key);
+      uint32_t slot = find_free_slot(ht, hash);
+
+      set_ctrl(ht, slot, hash_h2(hash));
+      ht->table[slot] = old_table[i];
+   }
+
+   ralloc_free(old_ctrl);
+   ralloc_free(old_table);
+   return true;
+}
+
+/**
+ * Inserts the key into the table, replacing the data of any existing entry
+ * with that key.
+ *
+ * Returns the entry, or NULL if the table could not be grown.
+ */
+struct pointer_hash_entry *
+_mesa_pointer_hash_table_insert(struct pointer_hash_table *ht,
+                                const void *key, void *data)
+{
+   struct pointer_hash_entry *entry;
+   uint64_t hash = hash_key(key);
+   uint32_t slot;
+
+   entry = _mesa_pointer_hash_table_search(ht, key);
+   if (entry) {
+      entry->data = data;
+      return entry;
+   }
+
+   slot = find_free_slot(ht, hash);
+
+   /* Reusing a DELETED slot doesn't change the number of used slots, so
+    * only check the load factor when taking an EMPTY one.
+    */
+   if (ht->ctrl[slot] == CTRL_EMPTY &&
+       ht->entries + ht->deleted_entries + 1 > max_used(ht->size)) {
+      /* Grow if more than half of the limit are live entries, otherwise
+       * just get rid of the DELETED slots.
+       */
+      uint32_t new_size = ht->size;
+      if (ht->entries + 1 > max_used(ht->size) / 2)
+         new_size *= 2;
+
+      if (!pointer_hash_table_rehash(ht, new_size))
+         return NULL;
+
+      slot = find_free_slot(ht, hash);
+   }
+
+   if (ht->ctrl[slot] == CTRL_DELETED)
+      ht->deleted_entries--;
+
+   set_ctrl(ht, slot, hash_h2(hash));
+   ht->table[slot].key = key;
+   ht->table[slot].data = data;
+   ht->entries++;
+
+   return &ht->table[slot];
+}
+
+/**
+ * This function deletes the given hash table entry.
+ *
+ * Note that deletion doesn't otherwise modify the table, so an iteration over
+ * the table deleting entries is safe.
+ */
+void
+_mesa_pointer_hash_table_remove(struct pointer_hash_table *ht,
+                                struct pointer_hash_entry *entry)
+{
+   if (!entry)
+      return;
+
+   set_ctrl(ht, entry - ht->table, CTRL_DELETED);
+   ht->entries--;
+   ht->deleted_entries++;
+}
+
+/**
+ * This function is an iterator over the hash table.
+ *
+ * Pass in NULL for the first entry, as in the start of a for loop.  Note that
+ * an iteration over the table is O(table_size) not O(entries).
+ */
+struct pointer_hash_entry *
+_mesa_pointer_hash_table_next_entry(struct pointer_hash_table *ht,
+                                    struct pointer_hash_entry *entry)
+{
+   uint32_t i = entry ? entry - ht->table + 1 : 0;
+
+   for (; i < ht->size; i++) {
+      if (ctrl_is_full(ht->ctrl[i]))
+         return &ht->table[i];
+   }
+
+   return NULL;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef _POINTER_HASH_TABLE_H
+#define _POINTER_HASH_TABLE_H
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "c99_compat.h"
+#include "macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Hash table specialized for pointer and uint32_t keys.
+ *
+ * Unlike hash_table, keys are compared by value, without going through a
+ * function pointer, and any key value can be stored (including NULL and 0).
+ *
+ * The table has a power-of-two size, and a byte of metadata per slot which
+ * holds 7 bits of the key's hash. Lookups compare the metadata of 16 slots
+ * at a time and only look at the slots whose hash bits match.
+ *
+ * Entry pointers are only valid until the next insertion.
+ */
+struct pointer_hash_entry {
+   const void *key;
+   void *data;
+};
+
+struct pointer_hash_table {
+   uint8_t *ctrl;
+   struct pointer_hash_entry *table;
+   uint32_t size;
+   uint32_t entries;
+   uint32_t deleted_entries;
+};
+
+struct pointer_hash_table *
+_mesa_pointer_hash_table_create(void *mem_ctx);
+void
+_mesa_pointer_hash_table_destroy(struct pointer_hash_table *ht,
+                                 void (*delete_function)(struct pointer_hash_entry *entry));
+void
+_mesa_pointer_hash_table_clear(struct pointer_hash_table *ht);
+
+static inline uint32_t
+_mesa_pointer_hash_table_num_entries(struct pointer_hash_table *ht)
+{
+   return ht->entries;
+}
+
+struct pointer_hash_entry *
+_mesa_pointer_hash_table_insert(struct pointer_hash_table *ht,
+                                const void *key, void *data);
+struct pointer_hash_entry *
+_mesa_pointer_hash_table_search(struct pointer_hash_table *ht,
+                                const void *key);
+void
+_mesa_pointer_hash_table_remove(struct pointer_hash_table *ht,
+                                struct pointer_hash_entry *entry);
+
+struct pointer_hash_entry *
+_mesa_pointer_hash_table_next_entry(struct pointer_hash_table *ht,
+                                    struct pointer_hash_entry *entry);
+
+static inline struct pointer_hash_entry *
+_mesa_pointer_hash_table_insert_u32(struct pointer_hash_table *ht,
+                                    uint32_t key, void *data)
+{
+   return _mesa_pointer_hash_table_insert(ht, (const void *)(uintptr_t)key,
+                                          data);
+}
+
+static inline struct pointer_hash_entry *
+_mesa_pointer_hash_table_search_u32(struct pointer_hash_table *ht,
+                                    uint32_t key)
+{
+   return _mesa_pointer_hash_table_search(ht, (const void *)(uintptr_t)key);
+}
+
+/**
+ * This foreach function is safe against deletion, but not against insertion
+ * (which may rehash the table, making entry a dangling pointer).
+ */
+#define pointer_hash_table_foreach(ht, entry)                   \
+   for (entry = _mesa_pointer_hash_table_next_entry(ht, NULL);  \
+        entry != NULL;                                          \
+        entry = _mesa_pointer_hash_table_next_entry(ht, entry))
+
+#ifdef __cplusplus
+} /* extern C */
+#endif
+
+#endif /* _POINTER_HASH_TABLE_H */
@@ -174,6 +174,19 @@ struct ra_graph {
     * stack.
     */
    unsigned int stack_optimistic_start;
+
+   /** @{
+    *
+    * Worklists of ra_simplify() once it has to make optimistic choices: the
+    * set of trivially colorable nodes still in the graph, and a binary heap
+    * of all the nodes still in the graph ordered by q total.  heap_pos[n] is
+    * the position of node n in the heap, or NO_REG if it isn't in it.
+    */
+   BITSET_WORD *colorable;
+   unsigned int *heap;
+   unsigned int *heap_pos;
+   unsigned int heap_count;
+   /** @} */
 };
 
 /**
@@ -423,9 +436,15 @@ ra_alloc_interference_graph(struct ra_regs *regs, unsigned int count)
 
    g->stack = rzalloc_array(g, unsigned int, count);
 
+   /* The adjacency bitsets of all the nodes are rows of a single matrix, so
+    * that building the graph doesn't take one allocation per node.
+    */
+   unsigned int bitset_count = BITSET_WORDS(count);
+   BITSET_WORD *adjacency = rzalloc_array(g, BITSET_WORD,
+                                          (size_t) count * bitset_count);
+
    for (i = 0; i < count; i++) {
-      int bitset_count = BITSET_WORDS(count);
-      g->nodes[i].adjacency = rzalloc_array(g, BITSET_WORD, bitset_count);
+      g->nodes[i].adjacency = adjacency + (size_t) i * bitset_count;
 
       g->nodes[i].adjacency_list_size = 4;
       g->nodes[i].adjacency_list =
@@ -465,6 +484,105 @@ pq_test(struct ra_graph *g, unsigned int n)
    return g->nodes[n].q_total < g->regs->classes[n_class]->p;
 }
 
+/**
+ * Returns whether node a should be chosen over node b as an optimistically
+ * colored node: lowest q total first, then highest node index.
+ */
+static bool
+heap_less(struct ra_graph *g, unsigned int a, unsigned int b)
+{
+   if (g->nodes[a].q_total != g->nodes[b].q_total)
+      return g->nodes[a].q_total < g->nodes[b].q_total;
+   return a > b;
+}
+
+static void
+heap_set(struct ra_graph *g, unsigned int pos, unsigned int n)
+{
+   g->heap[pos] = n;
+   g->heap_pos[n] = pos;
+}
+
+static void
+heap_sift_up(struct ra_graph *g, unsigned int pos)
+{
+   unsigned int n = g->heap[pos];
+
+   while (pos > 0) {
+      unsigned int parent = (pos - 1) / 2;
+
+      if (!heap_less(g, n, g->heap[parent]))
+         break;
+
+      heap_set(g, pos, g->heap[parent]);
+      pos = parent;
+   }
+   heap_set(g, pos, n);
+}
+
+static void
+heap_sift_down(struct ra_graph *g, unsigned int pos)
+{
+   unsigned int n = g->heap[pos];
+
+   for (;;) {
+      unsigned int child = pos * 2 + 1;
+
+      if (child >= g->heap_count)
+         break;
+      if (child + 1 < g->heap_count &&
+          heap_less(g, g->heap[child + 1], g->heap[child]))
+         child++;
+      if (!heap_less(g, g->heap[child], n))
+         break;
+
+      heap_set(g, pos, g->heap[child]);
+      pos = child;
+   }
+   heap_set(g, pos, n);
+}
+
+static void
+heap_remove(struct ra_graph *g, unsigned int n)
+{
+   unsigned int pos = g->heap_pos[n];
+   unsigned int last = g->heap[--g->heap_count];
+
+   g->heap_pos[n] = NO_REG;
+   if (last == n)
+      return;
+
+   heap_set(g, pos, last);
+   heap_sift_up(g, pos);
+   heap_sift_down(g, g->heap_pos[last]);
+}
+
+static void
+heap_build(struct ra_graph *g)
+{
+   unsigned int i;
+
+   g->heap = ralloc_array(g, unsigned int, g->count);
+   g->heap_pos = ralloc_array(g, unsigned int, g->count);
+   g->heap_count = 0;
+
+   for (i = 0; i < g->count; i++) {
+      if (g->nodes[i].in_stack || g->nodes[i].reg != NO_REG) {
+         g->heap_pos[i] = NO_REG;
+         continue;
+      }
+
+      heap_set(g, g->heap_count++, i);
+   }
+
+   for (i = g->heap_count / 2; i-- > 0;)
+      heap_sift_down(g, i);
+}
+
+/**
+ * Removes node n from the graph by decrementing the q totals of its
+ * neighbors, keeping the simplify worklists up to date if there are any.
+ */
 static void
 decrement_q(struct ra_graph *g, unsigned int n)
 {
@@ -478,8 +596,104 @@ decrement_q(struct ra_graph *g, unsigned int n)
       if (n != n2 && !g->nodes[n2].in_stack) {
          assert(g->nodes[n2].q_total >= g->regs->classes[n2_class]->q[n_class]);
          g->nodes[n2].q_total -= g->regs->classes[n2_class]->q[n_class];
+
+         if (g->heap && g->heap_pos[n2] != NO_REG) {
+            if (pq_test(g, n2))
+               BITSET_SET(g->colorable, n2);
+            heap_sift_up(g, g->heap_pos[n2]);
+         }
+      }
+   }
+}
+
+static void
+ra_push_node(struct ra_graph *g, unsigned int n)
+{
+   if (g->heap) {
+      BITSET_CLEAR(g->colorable, n);
+      heap_remove(g, n);
+   }
+
+   decrement_q(g, n);
+   g->stack[g->stack_count] = n;
+   g->stack_count++;
+   g->nodes[n].in_stack = true;
+}
+
+/**
+ * Returns the highest node index set in the given set that is not greater
+ * than max, or -1 if there is none.
+ */
+static int
+ra_find_last_set(const BITSET_WORD *set, int max)
+{
+   const int word_bits = BITSET_WORDBITS;
+   int w;
+
+   if (max < 0)
+      return -1;
+
+   for (w = max / word_bits; w >= 0; w--) {
+      BITSET_WORD word = set[w];
+
+      if (w == max / word_bits && max % word_bits != word_bits - 1)
+         word &= (1u << (max % word_bits + 1)) - 1;
+
+      if (word)
+         return w * word_bits + util_last_bit(word) - 1;
+   }
+
+   return -1;
+}
+
+/**
+ * Pushes all the nodes left in the graph once no node is trivially colorable
+ * anymore, optimistically choosing the node with the lowest q total each
+ * time that happens.
+ *
+ * Sweeping over all the nodes after every optimistic choice would make this
+ * quadratic for large graphs, so this keeps the set of trivially colorable
+ * nodes and a heap of the q totals up to date as nodes are removed from the
+ * graph instead (q totals only ever go down, so a node stays colorable once
+ * it is).  A cursor walking down the node indices and wrapping around picks
+ * the colorable nodes in the same order as the sweeps of ra_simplify()
+ * would.
+ */
+static void
+ra_simplify_optimistic(struct ra_graph *g)
+{
+   int cursor = g->count - 1;
+
+   g->colorable = rzalloc_array(g, BITSET_WORD, BITSET_WORDS(g->count));
+   heap_build(g);
+
+   g->stack_optimistic_start = g->stack_count;
+
+   while (g->heap_count > 0) {
+      int n = ra_find_last_set(g->colorable, cursor);
+
+      if (n < 0 && cursor != (int) g->count - 1) {
+         /* Start a new sweep from the top. */
+         cursor = g->count - 1;
+         n = ra_find_last_set(g->colorable, cursor);
+      }
+
+      if (n >= 0) {
+         cursor = n - 1;
+      } else {
+         n = g->heap[0];
+         cursor = g->count - 1;
       }
+
+      ra_push_node(g, n);
    }
+
+   ralloc_free(g->colorable);
+   ralloc_free(g->heap);
+   ralloc_free(g->heap_pos);
+   g->colorable = NULL;
+   g->heap = NULL;
+   g->heap_pos = NULL;
 }
 
 /**
@@ -496,47 +710,30 @@ static void
 ra_simplify(struct ra_graph *g)
 {
    bool progress = true;
-   unsigned int stack_optimistic_start = UINT_MAX;
+   bool remaining = false;
    int i;
 
-   while (progress) {
-      unsigned int best_optimistic_node = ~0;
-      unsigned int lowest_q_total = ~0;
+   g->stack_optimistic_start = UINT_MAX;
 
+   while (progress) {
       progress = false;
+      remaining = false;
 
       for (i = g->count - 1; i >= 0; i--) {
 	 if (g->nodes[i].in_stack || g->nodes[i].reg != NO_REG)
 	    continue;
 
 	 if (pq_test(g, i)) {
-	    decrement_q(g, i);
-	    g->stack[g->stack_count] = i;
-	    g->stack_count++;
-	    g->nodes[i].in_stack = true;
+	    ra_push_node(g, i);
 	    progress = true;
 	 } else {
-	    unsigned int new_q_total = g->nodes[i].q_total;
-	    if (new_q_total < lowest_q_total) {
-	       best_optimistic_node = i;
-	       lowest_q_total = new_q_total;
-	    }
+	    remaining = true;
 	 }
       }
-
-      if (!progress && best_optimistic_node != ~0U) {
-         if (stack_optimistic_start == UINT_MAX)
-            stack_optimistic_start = g->stack_count;
-
-	 decrement_q(g, best_optimistic_node);
-	 g->stack[g->stack_count] = best_optimistic_node;
-	 g->stack_count++;
-	 g->nodes[best_optimistic_node].in_stack = true;
-	 progress = true;
-      }
    }
 
-   g->stack_optimistic_start = stack_optimistic_start;
+   if (remaining)
+      ra_simplify_optimistic(g);
 }
 
 /**
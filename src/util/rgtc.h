@@ -31,6 +31,12 @@ void util_format_unsigned_fetch_texel_rgtc(unsigned srcRowStride, const unsigned
 void util_format_signed_fetch_texel_rgtc(unsigned srcRowStride, const signed char *pixdata,
                                            unsigned i, unsigned j, signed char *value, unsigned comps);
 
+void util_format_unsigned_decode_block_rgtc(const unsigned char *blkaddr,
+                                            unsigned char texels[16]);
+
+void util_format_signed_decode_block_rgtc(const signed char *blkaddr,
+                                          signed char texels[16]);
+
 void util_format_unsigned_encode_rgtc_ubyte(unsigned char *blkaddr, unsigned char srccolors[4][4],
                                             int numxpixels, int numypixels);
 
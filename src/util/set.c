@@ -174,7 +174,9 @@ set_search(const struct set *ht, uint32_t hash, const void *key)
       if (entry_is_free(entry)) {
          return NULL;
       } else if (entry_is_present(entry) && entry->hash == hash) {
-         if (ht->key_equals_function(key, entry->key)) {
+         /* Identical keys are always equal; see hash_table.c. */
+         if (key == entry->key ||
+             ht->key_equals_function(key, entry->key)) {
             return entry;
          }
       }
@@ -284,7 +286,8 @@ set_add(struct set *ht, uint32_t hash, const void *key)
        */
       if (!entry_is_deleted(entry) &&
           entry->hash == hash &&
-          ht->key_equals_function(key, entry->key)) {
+          (key == entry->key ||
+           ht->key_equals_function(key, entry->key))) {
          entry->key = key;
          return entry;
       }
@@ -22,14 +22,21 @@
  * USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
 #include "slab.h"
+#include "debug.h"
 #include "macros.h"
 #include "u_atomic.h"
 #include <stdint.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 #define ALIGN(value, align) (((value) + (align) - 1) & ~((align) - 1))
 
+#define SLAB_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
 #define SLAB_MAGIC_ALLOCATED 0xcafe4321
 #define SLAB_MAGIC_FREE 0x7ee01234
 
@@ -112,6 +119,14 @@ slab_create_parent(struct slab_parent_pool *parent,
    parent->element_size = ALIGN(sizeof(struct slab_element_header) + item_size,
                                 sizeof(intptr_t));
    parent->num_elements = num_items;
+   parent->huge_pages = env_var_as_boolean("MESA_SLAB_HUGE_PAGES", false);
+
+   if (parent->huge_pages) {
+      /* Fill the whole huge page, minus the page header. */
+      unsigned n = (SLAB_HUGE_PAGE_SIZE - sizeof(struct slab_page_header)) /
+                   parent->element_size;
+      parent->num_elements = MAX2(num_items, n);
+   }
 }
 
 void
@@ -130,6 +145,49 @@ void slab_create_child(struct slab_child_pool *pool,
    pool->pages = NULL;
    pool->free = NULL;
    pool->migrated = NULL;
+   pool->remote = NULL;
+   pool->num_remote = 0;
+}
+
+/* Hand the elements freed to this pool on behalf of other pools back to their
+ * owners. Must be called with the parent mutex held.
+ *
+ * Returns the list of elements whose owner has been destroyed in the
+ * meantime; they must be freed with slab_free_orphaned after unlocking.
+ */
+static struct slab_element_header *
+slab_return_remote_locked(struct slab_child_pool *pool)
+{
+   struct slab_element_header *orphaned = NULL;
+
+   while (pool->remote) {
+      struct slab_element_header *elt = pool->remote;
+      intptr_t owner_int = p_atomic_read(&elt->owner);
+
+      pool->remote = elt->next;
+
+      if (!(owner_int & 1)) {
+         struct slab_child_pool *owner = (struct slab_child_pool *)owner_int;
+         elt->next = owner->migrated;
+         owner->migrated = elt;
+      } else {
+         elt->next = orphaned;
+         orphaned = elt;
+      }
+   }
+   pool->num_remote = 0;
+
+   return orphaned;
+}
+
+static void
+slab_free_orphaned_list(struct slab_element_header *list)
+{
+   while (list) {
+      struct slab_element_header *elt = list;
+      list = elt->next;
+      slab_free_orphaned(elt);
+   }
 }
 
 /**
@@ -140,8 +198,12 @@ void slab_create_child(struct slab_child_pool *pool,
  */
 void slab_destroy_child(struct slab_child_pool *pool)
 {
+   struct slab_element_header *orphaned;
+
    mtx_lock(&pool->parent->mutex);
 
+   orphaned = slab_return_remote_locked(pool);
+
    while (pool->pages) {
       struct slab_page_header *page = pool->pages;
       pool->pages = page->u.next;
@@ -161,6 +223,8 @@ void slab_destroy_child(struct slab_child_pool *pool)
 
    mtx_unlock(&pool->parent->mutex);
 
+   slab_free_orphaned_list(orphaned);
+
    while (pool->free) {
       struct slab_element_header *elt = pool->free;
       pool->free = elt->next;
@@ -174,8 +238,23 @@ void slab_destroy_child(struct slab_child_pool *pool)
 static bool
 slab_add_new_page(struct slab_child_pool *pool)
 {
-   struct slab_page_header *page = malloc(sizeof(struct slab_page_header) +
-      pool->parent->num_elements * pool->parent->element_size);
+   size_t size = sizeof(struct slab_page_header) +
+                 pool->parent->num_elements * pool->parent->element_size;
+   struct slab_page_header *page = NULL;
+
+   if (pool->parent->huge_pages) {
+      void *ptr;
+
+      size = ALIGN(size, SLAB_HUGE_PAGE_SIZE);
+      if (posix_memalign(&ptr, SLAB_HUGE_PAGE_SIZE, size) == 0) {
+         page = ptr;
+#ifdef MADV_HUGEPAGE
+         madvise(page, size, MADV_HUGEPAGE);
+#endif
+      }
+   } else {
+      page = malloc(size);
+   }
 
    if (!page)
       return false;
@@ -207,14 +286,20 @@ slab_alloc(struct slab_child_pool *pool)
    struct slab_element_header *elt;
 
    if (!pool->free) {
+      struct slab_element_header *orphaned;
+
       /* First, collect elements that belong to us but were freed from a
-       * different child pool.
+       * different child pool. Since we hold the mutex anyway, also return
+       * the elements we've been holding on behalf of other pools.
        */
       mtx_lock(&pool->parent->mutex);
       pool->free = pool->migrated;
       pool->migrated = NULL;
+      orphaned = slab_return_remote_locked(pool);
       mtx_unlock(&pool->parent->mutex);
 
+      slab_free_orphaned_list(orphaned);
+
       /* Now allocate a new page. */
       if (!pool->free && !slab_add_new_page(pool))
          return NULL;
@@ -236,12 +321,13 @@ slab_alloc(struct slab_child_pool *pool)
  *
  * Freeing an object in a different child pool from the one where it was
  * allocated is allowed, as long the pool belong to the same parent. No
- * additional locking is required in this case.
+ * additional locking is required in this case. Such elements are kept in
+ * this pool and handed back to their owner in batches.
  */
 void slab_free(struct slab_child_pool *pool, void *ptr)
 {
    struct slab_element_header *elt = ((struct slab_element_header*)ptr - 1);
-   intptr_t owner_int;
+   struct slab_element_header *orphaned;
 
    CHECK_MAGIC(elt, SLAB_MAGIC_ALLOCATED);
    SET_MAGIC(elt, SLAB_MAGIC_FREE);
@@ -255,24 +341,21 @@ void slab_free(struct slab_child_pool *pool, void *ptr)
       return;
    }
 
-   /* The slow case: migration or an orphaned page. */
-   mtx_lock(&pool->parent->mutex);
-
-   /* Note: we _must_ re-read elt->owner here because the owning child pool
-    * may have been destroyed by another thread in the meantime.
+   /* The slow case: migration or an orphaned page. Whichever it is will be
+    * sorted out when the batch is returned, because the owning child pool
+    * may be destroyed by another thread in the meantime.
     */
-   owner_int = p_atomic_read(&elt->owner);
+   elt->next = pool->remote;
+   pool->remote = elt;
 
-   if (!(owner_int & 1)) {
-      struct slab_child_pool *owner = (struct slab_child_pool *)owner_int;
-      elt->next = owner->migrated;
-      owner->migrated = elt;
-      mtx_unlock(&pool->parent->mutex);
-   } else {
-      mtx_unlock(&pool->parent->mutex);
+   if (++pool->num_remote < SLAB_REMOTE_BATCH)
+      return;
 
-      slab_free_orphaned(elt);
-   }
+   mtx_lock(&pool->parent->mutex);
+   orphaned = slab_return_remote_locked(pool);
+   mtx_unlock(&pool->parent->mutex);
+
+   slab_free_orphaned_list(orphaned);
 }
 
 /**
@@ -33,7 +33,13 @@
  * Allocations obtained from one child pool should usually be freed in the
  * same child pool. Freeing an allocation in a different child pool associated
  * to the same parent is allowed (and requires no locking by the caller), but
- * it is discouraged because it implies a performance penalty.
+ * it is discouraged because it implies a performance penalty. Such frees are
+ * batched in the freeing child pool and handed back to their owners in
+ * groups of SLAB_REMOTE_BATCH under a single lock of the parent mutex.
+ *
+ * Setting MESA_SLAB_HUGE_PAGES=1 makes pools allocate their pages as
+ * 2 MiB-aligned blocks that the kernel can back with transparent huge pages.
+ * Each page then holds at least 2 MiB worth of objects.
  *
  * For convenience and to ease the transition, there is also a set of wrapper
  * functions around a single parent-child pair.
@@ -44,6 +50,10 @@
 
 #include "c11/threads.h"
 
+#include <stdbool.h>
+
+#define SLAB_REMOTE_BATCH 32
+
 struct slab_element_header;
 struct slab_page_header;
 
@@ -51,6 +61,7 @@ struct slab_parent_pool {
    mtx_t mutex;
    unsigned element_size;
    unsigned num_elements;
+   bool huge_pages;
 };
 
 struct slab_child_pool {
@@ -67,6 +78,13 @@ struct slab_child_pool {
     * This list is protected by the parent mutex.
     */
    struct slab_element_header *migrated;
+
+   /* Elements owned by other pools that were freed with this pool as the
+    * argument to slab_free, and that haven't been returned to their owner
+    * yet. Only accessed by the thread using this pool.
+    */
+   struct slab_element_header *remote;
+   unsigned num_remote;
 };
 
 void slab_create_parent(struct slab_parent_pool *parent,
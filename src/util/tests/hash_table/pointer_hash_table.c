@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+#include "pointer_hash_table.h"
+
+#define SIZE 10000
+
+int
+main(int argc, char **argv)
+{
+   struct pointer_hash_table *ht;
+   struct pointer_hash_entry *entry;
+   static uint32_t keys[SIZE];
+   unsigned i, count;
+
+   (void) argc;
+   (void) argv;
+
+   ht = _mesa_pointer_hash_table_create(NULL);
+
+   /* Pointer keys, including NULL. */
+   _mesa_pointer_hash_table_insert(ht, NULL, &keys[0]);
+   for (i = 1; i < SIZE; i++)
+      _mesa_pointer_hash_table_insert(ht, &keys[i], &keys[i]);
+
+   assert(_mesa_pointer_hash_table_num_entries(ht) == SIZE);
+
+   entry = _mesa_pointer_hash_table_search(ht, NULL);
+   assert(entry && entry->key == NULL && entry->data == &keys[0]);
+   for (i = 1; i < SIZE; i++) {
+      entry = _mesa_pointer_hash_table_search(ht, &keys[i]);
+      assert(entry && entry->key == &keys[i] && entry->data == &keys[i]);
+   }
+
+   /* Replacement keeps a single entry per key. */
+   _mesa_pointer_hash_table_insert(ht, &keys[1], &keys[2]);
+   assert(_mesa_pointer_hash_table_num_entries(ht) == SIZE);
+   entry = _mesa_pointer_hash_table_search(ht, &keys[1]);
+   assert(entry->data == &keys[2]);
+
+   /* Delete every other entry while iterating. */
+   pointer_hash_table_foreach(ht, entry) {
+      const uint32_t *key = entry->key;
+      if (key && (key - keys) % 2 == 0)
+         _mesa_pointer_hash_table_remove(ht, entry);
+   }
+
+   for (i = 1; i < SIZE; i++) {
+      entry = _mesa_pointer_hash_table_search(ht, &keys[i]);
+      assert((entry != NULL) == (i % 2 == 1));
+   }
+
+   count = 0;
+   pointer_hash_table_foreach(ht, entry)
+      count++;
+   assert(count == _mesa_pointer_hash_table_num_entries(ht));
+   assert(count == SIZE / 2 + 1);
+
+   _mesa_pointer_hash_table_clear(ht);
+   assert(_mesa_pointer_hash_table_num_entries(ht) == 0);
+   assert(_mesa_pointer_hash_table_search(ht, NULL) == NULL);
+   _mesa_pointer_hash_table_destroy(ht, NULL);
+
+   ht = _mesa_pointer_hash_table_create(NULL);
+
+   /* uint32_t keys, inserted and removed repeatedly so that the table has
+    * to get rid of deleted slots without growing.
+    */
+   for (i = 0; i < SIZE * 10; i++) {
+      uint32_t key = i * 7;
+
+      _mesa_pointer_hash_table_insert_u32(ht, key, NULL);
+      if (i >= 100) {
+         entry = _mesa_pointer_hash_table_search_u32(ht, (i - 100) * 7);
+         assert(entry);
+         _mesa_pointer_hash_table_remove(ht, entry);
+      }
+      assert(_mesa_pointer_hash_table_search_u32(ht, key));
+   }
+   assert(_mesa_pointer_hash_table_num_entries(ht) == 100);
+   assert(ht->size <= 256);
+
+   _mesa_pointer_hash_table_destroy(ht, NULL);
+
+   return 0;
+}
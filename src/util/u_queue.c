@@ -0,0 +1,460 @@
+/*
+ * Copyright © 2016 Advanced Micro Devices, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS, AUTHORS
+ * AND/OR ITS SUPPLIERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ */
+
+#include "u_queue.h"
+#include "macros.h"
+
+#include <assert.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+static void
+util_queue_fence_signal(struct util_queue_fence *fence)
+{
+   mtx_lock(&fence->mutex);
+   fence->signalled = true;
+   cnd_broadcast(&fence->cond);
+   mtx_unlock(&fence->mutex);
+}
+
+void
+util_queue_job_wait(struct util_queue_fence *fence)
+{
+   mtx_lock(&fence->mutex);
+   while (!fence->signalled)
+      cnd_wait(&fence->cond, &fence->mutex);
+   mtx_unlock(&fence->mutex);
+}
+
+static int64_t
+util_queue_get_time_ns(void)
+{
+#ifdef HAVE_PTHREAD
+   struct timespec t;
+
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+#else
+   xtime t;
+
+   xtime_get(&t, TIME_UTC);
+   return (int64_t)t.sec * 1000000000 + t.nsec;
+#endif
+}
+
+static void
+util_queue_record_wait(struct util_queue_stats *stats, int64_t queued_time)
+{
+   int64_t wait = util_queue_get_time_ns() - queued_time;
+
+   if (wait < 0)
+      wait = 0;
+
+   stats->num_jobs++;
+   stats->total_wait_ns += wait;
+   if ((uint64_t)wait > stats->max_wait_ns)
+      stats->max_wait_ns = wait;
+}
+
+/* Double the size of a ring, keeping its jobs in order. */
+static bool
+util_queue_ring_grow(struct util_queue_ring *ring)
+{
+   int max_jobs = ring->max_jobs * 2;
+   struct util_queue_job *jobs = (struct util_queue_job*)
+                                 calloc(max_jobs, sizeof(struct util_queue_job));
+   int i;
+
+   if (!jobs)
+      return false;
+
+   for (i = 0; i < ring->num_queued; i++)
+      jobs[i] = ring->jobs[(ring->read_idx + i) % ring->max_jobs];
+
+   free(ring->jobs);
+   ring->jobs = jobs;
+   ring->max_jobs = max_jobs;
+   ring->read_idx = 0;
+   ring->write_idx = ring->num_queued;
+   return true;
+}
+
+struct thread_input {
+   struct util_queue *queue;
+   int thread_index;
+};
+
+static void
+util_queue_thread_setname(const char *name)
+{
+#if defined(HAVE_PTHREAD)
+#  if defined(__GNU_LIBRARY__) && defined(__GLIBC__) && defined(__GLIBC_MINOR__) && \
+      (__GLIBC__ >= 3 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 12))
+   pthread_setname_np(pthread_self(), name);
+#  endif
+#endif
+   (void)name;
+}
+
+static int
+util_queue_thread_create(thrd_t *thread, thrd_start_t routine, void *param)
+{
+   int ret;
+#ifdef HAVE_PTHREAD
+   sigset_t saved_set, new_set;
+
+   /* Leave signal handling to the application's threads. */
+   sigfillset(&new_set);
+   pthread_sigmask(SIG_SETMASK, &new_set, &saved_set);
+   ret = thrd_create(thread, routine, param);
+   pthread_sigmask(SIG_SETMASK, &saved_set, NULL);
+#else
+   ret = thrd_create(thread, routine, param);
+#endif
+   return ret;
+}
+
+static int
+util_queue_thread_func(void *input)
+{
+   struct util_queue *queue = ((struct thread_input*)input)->queue;
+   int thread_index = ((struct thread_input*)input)->thread_index;
+
+   free(input);
+
+   if (queue->name) {
+      char name[16];
+      snprintf(name, sizeof(name), "%s:%i", queue->name, thread_index);
+      util_queue_thread_setname(name);
+   }
+
+   while (1) {
+      struct util_queue_job job;
+      struct util_queue_ring *ring = NULL;
+      int p;
+
+      mtx_lock(&queue->lock);
+
+      /* wait if the queue is empty */
+      while (!queue->kill_threads) {
+         for (p = UTIL_QUEUE_NUM_PRIORITIES - 1; p >= 0; p--) {
+            assert(queue->rings[p].num_queued >= 0 &&
+                   queue->rings[p].num_queued <= queue->rings[p].max_jobs);
+            if (queue->rings[p].num_queued) {
+               ring = &queue->rings[p];
+               break;
+            }
+         }
+         if (ring)
+            break;
+         cnd_wait(&queue->has_queued_cond, &queue->lock);
+      }
+
+      if (queue->kill_threads) {
+         mtx_unlock(&queue->lock);
+         break;
+      }
+
+      job = ring->jobs[ring->read_idx];
+      memset(&ring->jobs[ring->read_idx], 0, sizeof(struct util_queue_job));
+      ring->read_idx = (ring->read_idx + 1) % ring->max_jobs;
+
+      ring->num_queued--;
+      util_queue_record_wait(&queue->stats[p], job.queued_time);
+      cnd_broadcast(&queue->has_space_cond);
+      mtx_unlock(&queue->lock);
+
+      if (job.job) {
+         job.execute(job.job, thread_index);
+         util_queue_fence_signal(job.fence);
+         if (job.cleanup)
+            job.cleanup(job.job, thread_index);
+      }
+   }
+
+   /* signal remaining jobs before terminating */
+   mtx_lock(&queue->lock);
+   for (unsigned p = 0; p < UTIL_QUEUE_NUM_PRIORITIES; p++) {
+      struct util_queue_ring *ring = &queue->rings[p];
+
+      while (ring->jobs[ring->read_idx].job) {
+         util_queue_fence_signal(ring->jobs[ring->read_idx].fence);
+
+         ring->jobs[ring->read_idx].job = NULL;
+         ring->read_idx = (ring->read_idx + 1) % ring->max_jobs;
+      }
+   }
+   mtx_unlock(&queue->lock);
+   return 0;
+}
+
+bool
+util_queue_init(struct util_queue *queue,
+                const char *name,
+                unsigned max_jobs,
+                unsigned num_threads)
+{
+   unsigned i;
+
+   memset(queue, 0, sizeof(*queue));
+   queue->name = name;
+   queue->num_threads = num_threads;
+
+   for (i = 0; i < UTIL_QUEUE_NUM_PRIORITIES; i++) {
+      queue->rings[i].max_jobs = max_jobs;
+      queue->rings[i].jobs = (struct util_queue_job*)
+                             calloc(max_jobs, sizeof(struct util_queue_job));
+      if (!queue->rings[i].jobs)
+         goto fail_rings;
+   }
+
+   (void) mtx_init(&queue->lock, mtx_plain);
+
+   cnd_init(&queue->has_queued_cond);
+   cnd_init(&queue->has_space_cond);
+
+   queue->threads = (thrd_t*)calloc(num_threads, sizeof(thrd_t));
+   if (!queue->threads)
+      goto fail;
+
+   /* start threads */
+   for (i = 0; i < num_threads; i++) {
+      struct thread_input *input =
+         (struct thread_input*)malloc(sizeof(struct thread_input));
+
+      if (!input) {
+         if (i == 0)
+            goto fail;
+         queue->num_threads = i;
+         break;
+      }
+
+      input->queue = queue;
+      input->thread_index = i;
+
+      if (util_queue_thread_create(&queue->threads[i], util_queue_thread_func,
+                                   input) != thrd_success) {
+         free(input);
+
+         if (i == 0) {
+            /* no threads created, fail */
+            goto fail;
+         } else {
+            /* at least one thread created, so use it */
+            queue->num_threads = i;
+            break;
+         }
+      }
+   }
+   return true;
+
+fail:
+   free(queue->threads);
+
+   cnd_destroy(&queue->has_space_cond);
+   cnd_destroy(&queue->has_queued_cond);
+   mtx_destroy(&queue->lock);
+
+fail_rings:
+   for (i = 0; i < UTIL_QUEUE_NUM_PRIORITIES; i++)
+      free(queue->rings[i].jobs);
+
+   /* also util_queue_is_initialized can be used to check for success */
+   memset(queue, 0, sizeof(*queue));
+   return false;
+}
+
+void
+util_queue_destroy(struct util_queue *queue)
+{
+   unsigned i;
+
+   /* Signal all threads to terminate. */
+   mtx_lock(&queue->lock);
+   queue->kill_threads = 1;
+   cnd_broadcast(&queue->has_queued_cond);
+   mtx_unlock(&queue->lock);
+
+   for (i = 0; i < queue->num_threads; i++)
+      thrd_join(queue->threads[i], NULL);
+
+   cnd_destroy(&queue->has_space_cond);
+   cnd_destroy(&queue->has_queued_cond);
+   mtx_destroy(&queue->lock);
+   for (i = 0; i < UTIL_QUEUE_NUM_PRIORITIES; i++)
+      free(queue->rings[i].jobs);
+   free(queue->threads);
+}
+
+void
+util_queue_fence_init(struct util_queue_fence *fence)
+{
+   memset(fence, 0, sizeof(*fence));
+   (void) mtx_init(&fence->mutex, mtx_plain);
+   cnd_init(&fence->cond);
+   fence->signalled = true;
+}
+
+void
+util_queue_fence_destroy(struct util_queue_fence *fence)
+{
+   assert(fence->signalled);
+   cnd_destroy(&fence->cond);
+   mtx_destroy(&fence->mutex);
+}
+
+void
+util_queue_add_job_with_priority(struct util_queue *queue,
+                                 void *job,
+                                 struct util_queue_fence *fence,
+                                 util_queue_execute_func execute,
+                                 util_queue_execute_func cleanup,
+                                 enum util_queue_priority priority)
+{
+   struct util_queue_ring *ring = &queue->rings[priority];
+   struct util_queue_job *ptr;
+
+   assert(priority < UTIL_QUEUE_NUM_PRIORITIES);
+   assert(fence->signalled);
+   fence->signalled = false;
+
+   mtx_lock(&queue->lock);
+   assert(ring->num_queued >= 0 && ring->num_queued <= ring->max_jobs);
+
+   /* High priority jobs grow the queue if it's full, others wait until
+    * there is space.
+    */
+   if (ring->num_queued == ring->max_jobs &&
+       priority == UTIL_QUEUE_PRIORITY_HIGH)
+      util_queue_ring_grow(ring);
+
+   while (ring->num_queued == ring->max_jobs)
+      cnd_wait(&queue->has_space_cond, &queue->lock);
+
+   ptr = &ring->jobs[ring->write_idx];
+   assert(ptr->job == NULL);
+   ptr->job = job;
+   ptr->fence = fence;
+   ptr->execute = execute;
+   ptr->cleanup = cleanup;
+   ptr->queued_time = util_queue_get_time_ns();
+   ring->write_idx = (ring->write_idx + 1) % ring->max_jobs;
+
+   ring->num_queued++;
+   cnd_signal(&queue->has_queued_cond);
+   mtx_unlock(&queue->lock);
+}
+
+void
+util_queue_add_job(struct util_queue *queue,
+                   void *job,
+                   struct util_queue_fence *fence,
+                   util_queue_execute_func execute,
+                   util_queue_execute_func cleanup)
+{
+   util_queue_add_job_with_priority(queue, job, fence, execute, cleanup,
+                                    UTIL_QUEUE_PRIORITY_NORMAL);
+}
+
+void
+util_queue_get_stats(struct util_queue *queue,
+                     enum util_queue_priority priority,
+                     struct util_queue_stats *stats)
+{
+   assert(priority < UTIL_QUEUE_NUM_PRIORITIES);
+
+   mtx_lock(&queue->lock);
+   *stats = queue->stats[priority];
+   mtx_unlock(&queue->lock);
+}
+
+struct util_queue_range_job {
+   util_queue_range_func func;
+   void *data;
+   unsigned start, end;
+   struct util_queue_fence fence;
+};
+
+static void
+util_queue_range_job_execute(void *job, int thread_index)
+{
+   struct util_queue_range_job *range = (struct util_queue_range_job *)job;
+
+   range->func(range->data, range->start, range->end);
+}
+
+void
+util_queue_run_range(struct util_queue *queue,
+                     unsigned count,
+                     unsigned min_per_job,
+                     util_queue_range_func func,
+                     void *data)
+{
+   struct util_queue_range_job jobs[UTIL_QUEUE_MAX_RANGE_JOBS];
+   unsigned num_jobs = 1, per_job, i;
+
+   if (queue && util_queue_is_initialized(queue))
+      num_jobs = MIN2(queue->num_threads + 1, UTIL_QUEUE_MAX_RANGE_JOBS);
+   num_jobs = MIN2(num_jobs, count / MAX2(min_per_job, 1));
+
+   if (num_jobs <= 1) {
+      func(data, 0, count);
+      return;
+   }
+
+   per_job = DIV_ROUND_UP(count, num_jobs);
+   num_jobs = DIV_ROUND_UP(count, per_job);
+
+   for (i = 0; i < num_jobs; i++) {
+      jobs[i].func = func;
+      jobs[i].data = data;
+      jobs[i].start = i * per_job;
+      jobs[i].end = MIN2(jobs[i].start + per_job, count);
+   }
+
+   /* The first range is run by the calling thread while the others are in
+    * the queue.
+    */
+   for (i = 1; i < num_jobs; i++) {
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(queue, &jobs[i], &jobs[i].fence,
+                         util_queue_range_job_execute, NULL);
+   }
+
+   func(data, jobs[0].start, jobs[0].end);
+
+   for (i = 1; i < num_jobs; i++) {
+      util_queue_job_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+}
@@ -33,39 +33,70 @@
 #ifndef U_QUEUE_H
 #define U_QUEUE_H
 
-#include "os/os_thread.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "c11/threads.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /* Job completion fence.
  * Put this into your job structure.
  */
 struct util_queue_fence {
-   pipe_mutex mutex;
-   pipe_condvar cond;
+   mtx_t mutex;
+   cnd_t cond;
    int signalled;
 };
 
 typedef void (*util_queue_execute_func)(void *job, int thread_index);
 
+/* Threads always pick the oldest job of the highest priority first.
+ *
+ * Normal jobs block the caller while the queue is full. High priority jobs
+ * are meant for work somebody is about to wait for (e.g. a shader compile
+ * that blocks a draw), so they never block: their ring grows instead.
+ */
+enum util_queue_priority {
+   UTIL_QUEUE_PRIORITY_NORMAL,
+   UTIL_QUEUE_PRIORITY_HIGH,
+   UTIL_QUEUE_NUM_PRIORITIES
+};
+
 struct util_queue_job {
    void *job;
    struct util_queue_fence *fence;
    util_queue_execute_func execute;
    util_queue_execute_func cleanup;
+   int64_t queued_time; /* in nanoseconds */
+};
+
+struct util_queue_ring {
+   int num_queued;
+   int max_jobs;
+   int write_idx, read_idx; /* ring buffer pointers */
+   struct util_queue_job *jobs;
+};
+
+/* Time spent by jobs in the queue before a thread started them. */
+struct util_queue_stats {
+   uint64_t num_jobs;
+   uint64_t total_wait_ns;
+   uint64_t max_wait_ns;
 };
 
 /* Put this into your context. */
 struct util_queue {
    const char *name;
-   pipe_mutex lock;
-   pipe_condvar has_queued_cond;
-   pipe_condvar has_space_cond;
-   pipe_thread *threads;
-   int num_queued;
+   mtx_t lock;
+   cnd_t has_queued_cond;
+   cnd_t has_space_cond;
+   thrd_t *threads;
    unsigned num_threads;
    int kill_threads;
-   int max_jobs;
-   int write_idx, read_idx; /* ring buffer pointers */
-   struct util_queue_job *jobs;
+   struct util_queue_ring rings[UTIL_QUEUE_NUM_PRIORITIES];
+   struct util_queue_stats stats[UTIL_QUEUE_NUM_PRIORITIES];
 };
 
 bool util_queue_init(struct util_queue *queue,
@@ -83,8 +114,38 @@ void util_queue_add_job(struct util_queue *queue,
                         util_queue_execute_func execute,
                         util_queue_execute_func cleanup);
 
+void util_queue_add_job_with_priority(struct util_queue *queue,
+                                      void *job,
+                                      struct util_queue_fence *fence,
+                                      util_queue_execute_func execute,
+                                      util_queue_execute_func cleanup,
+                                      enum util_queue_priority priority);
+
+void util_queue_get_stats(struct util_queue *queue,
+                          enum util_queue_priority priority,
+                          struct util_queue_stats *stats);
+
 void util_queue_job_wait(struct util_queue_fence *fence);
 
+#define UTIL_QUEUE_MAX_RANGE_JOBS 16
+
+typedef void (*util_queue_range_func)(void *data, unsigned start,
+                                      unsigned end);
+
+/* Split [0, count) into ranges of at least min_per_job elements, one per
+ * thread of the queue plus one for the calling thread, and call func on
+ * each of them.  Returns once all the ranges are done.
+ *
+ * The queue may be NULL or uninitialized, in which case func is called
+ * once for the whole range.  It must not be called from a job of the same
+ * queue.
+ */
+void util_queue_run_range(struct util_queue *queue,
+                          unsigned count,
+                          unsigned min_per_job,
+                          util_queue_range_func func,
+                          void *data);
+
 /* util_queue needs to be cleared to zeroes for this to work */
 static inline bool
 util_queue_is_initialized(struct util_queue *queue)
@@ -98,4 +159,8 @@ util_queue_fence_is_signalled(struct util_queue_fence *fence)
    return fence->signalled != 0;
 }
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Force assertions, even on release builds. */
+#undef NDEBUG
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "c11/threads.h"
+#include "util/u_vector.h"
+
+#define NUM_ELEMENTS (1 << 20)
+
+struct element {
+   uint64_t value;
+   uint32_t check;
+};
+
+static int
+producer(void *data)
+{
+   struct u_spsc_vector *vector = data;
+   uint64_t i;
+
+   for (i = 0; i < NUM_ELEMENTS; i++) {
+      struct element e = { i, (uint32_t) ~i };
+      bool ok = u_spsc_vector_push(vector, &e);
+      assert(ok);
+      (void) ok;
+   }
+
+   return 0;
+}
+
+int
+main(void)
+{
+   struct u_spsc_vector vector;
+   struct element e;
+   thrd_t thread;
+   uint64_t expected = 0;
+
+   /* Single threaded: pop what was pushed, across chunk boundaries. */
+   assert(u_spsc_vector_init(&vector, sizeof(struct element), 3));
+   assert(!u_spsc_vector_pop(&vector, &e));
+   for (expected = 0; expected < 10; expected++) {
+      e.value = expected;
+      assert(u_spsc_vector_push(&vector, &e));
+   }
+   for (expected = 0; expected < 10; expected++) {
+      assert(u_spsc_vector_pop(&vector, &e));
+      assert(e.value == expected);
+   }
+   assert(!u_spsc_vector_pop(&vector, &e));
+   u_spsc_vector_finish(&vector);
+
+   /* One producer and one consumer thread, with small chunks so that they
+    * get allocated and freed concurrently.
+    */
+   assert(u_spsc_vector_init(&vector, sizeof(struct element), 16));
+   assert(thrd_create(&thread, producer, &vector) == thrd_success);
+
+   expected = 0;
+   while (expected < NUM_ELEMENTS) {
+      if (!u_spsc_vector_pop(&vector, &e)) {
+         thrd_yield();
+         continue;
+      }
+
+      if (e.value != expected || e.check != (uint32_t) ~expected) {
+         fprintf(stderr, "got element %" PRIu64 ", expected %" PRIu64 "\n",
+                 e.value, expected);
+         return 1;
+      }
+      expected++;
+   }
+
+   thrd_join(thread, NULL);
+   assert(!u_spsc_vector_pop(&vector, &e));
+   u_spsc_vector_finish(&vector);
+
+   return 0;
+}
@@ -96,3 +96,106 @@ u_vector_remove(struct u_vector *vector)
 
    return (char *)vector->data + offset;
 }
+
+static struct u_spsc_vector_chunk *
+u_spsc_vector_chunk_create(struct u_spsc_vector *vector)
+{
+   struct u_spsc_vector_chunk *chunk =
+      malloc(sizeof(*chunk) + vector->element_size * vector->chunk_elements);
+
+   if (chunk == NULL)
+      return NULL;
+
+   chunk->next = NULL;
+   chunk->count = 0;
+   return chunk;
+}
+
+int
+u_spsc_vector_init(struct u_spsc_vector *vector, uint32_t element_size,
+                   uint32_t chunk_elements)
+{
+   assert(element_size > 0 && chunk_elements > 0);
+
+   vector->element_size = element_size;
+   vector->chunk_elements = chunk_elements;
+   vector->head = u_spsc_vector_chunk_create(vector);
+   vector->tail = vector->head;
+   vector->tail_index = 0;
+
+   return vector->head != NULL;
+}
+
+/* Frees all the chunks, which requires both threads to be done with the
+ * vector.
+ */
+void
+u_spsc_vector_finish(struct u_spsc_vector *vector)
+{
+   struct u_spsc_vector_chunk *chunk = vector->tail;
+
+   while (chunk) {
+      struct u_spsc_vector_chunk *next = chunk->next;
+      free(chunk);
+      chunk = next;
+   }
+}
+
+/* Copies elem to the end of the queue.  Returns false if a new chunk was
+ * needed but couldn't be allocated.
+ */
+bool
+u_spsc_vector_push(struct u_spsc_vector *vector, const void *elem)
+{
+   struct u_spsc_vector_chunk *chunk = vector->head;
+   uint32_t count = chunk->count;
+
+   if (count == vector->chunk_elements) {
+      struct u_spsc_vector_chunk *next = u_spsc_vector_chunk_create(vector);
+
+      if (next == NULL)
+         return false;
+
+      p_atomic_set(&chunk->next, next);
+      vector->head = chunk = next;
+      count = 0;
+   }
+
+   memcpy(chunk->data + count * vector->element_size, elem,
+          vector->element_size);
+
+   /* Publish the element only once it's written. */
+   p_atomic_set(&chunk->count, count + 1);
+   return true;
+}
+
+/* Copies the oldest element to elem and removes it from the queue.  Returns
+ * false if the queue is empty.
+ */
+bool
+u_spsc_vector_pop(struct u_spsc_vector *vector, void *elem)
+{
+   struct u_spsc_vector_chunk *chunk = vector->tail;
+
+   if (vector->tail_index == vector->chunk_elements) {
+      struct u_spsc_vector_chunk *next = p_atomic_read(&chunk->next);
+
+      if (next == NULL)
+         return false;
+
+      /* The chunk is full and the producer has moved on to the next one,
+       * so nobody uses it anymore.
+       */
+      free(chunk);
+      vector->tail = chunk = next;
+      vector->tail_index = 0;
+   }
+
+   if (vector->tail_index == p_atomic_read(&chunk->count))
+      return false;
+
+   memcpy(elem, chunk->data + vector->tail_index * vector->element_size,
+          vector->element_size);
+   vector->tail_index++;
+   return true;
+}
@@ -29,10 +29,12 @@
 #ifndef U_VECTOR_H
 #define U_VECTOR_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include "util/u_math.h"
 #include "util/macros.h"
+#include "util/u_atomic.h"
 
 /* TODO - move to u_math.h - name it better etc */
 static inline uint32_t
@@ -88,5 +90,40 @@ u_vector_finish(struct u_vector *queue)
         __u_vector_offset += (queue)->element_size)
 
 
+/*
+ * u_spsc_vector is a queue of fixed size elements for handing objects from
+ * one thread to another without locks.  Only one thread may push and only
+ * one thread may pop at a time; several producers have to serialize their
+ * pushes themselves.
+ *
+ * Elements are copied in and out.  Instead of a ring that is copied when it
+ * grows, the queue is a list of chunks of chunk_elements elements: the
+ * producer appends a new chunk when the last one is full, and the consumer
+ * frees each chunk once it has popped all of its elements.
+ */
+struct u_spsc_vector_chunk {
+   struct u_spsc_vector_chunk *next;  /* written once by the producer */
+   uint32_t count;                    /* elements pushed into this chunk */
+   char data[];
+};
+
+struct u_spsc_vector {
+   uint32_t element_size;
+   uint32_t chunk_elements;
+
+   /* Only used by the producer. */
+   struct u_spsc_vector_chunk *head;
+
+   /* Only used by the consumer. */
+   struct u_spsc_vector_chunk *tail;
+   uint32_t tail_index;
+};
+
+int u_spsc_vector_init(struct u_spsc_vector *vector, uint32_t element_size,
+                       uint32_t chunk_elements);
+void u_spsc_vector_finish(struct u_spsc_vector *vector);
+bool u_spsc_vector_push(struct u_spsc_vector *vector, const void *elem);
+bool u_spsc_vector_pop(struct u_spsc_vector *vector, void *elem);
+
 #endif
 
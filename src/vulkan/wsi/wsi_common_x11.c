@@ -34,7 +34,6 @@
 #include <errno.h>
 #include <string.h>
 
-#include <poll.h>
 #include "util/hash_table.h"
 
 #include "wsi_common.h"
@@ -495,7 +494,6 @@ struct x11_swapchain {
    uint64_t                                     last_present_msc;
    uint32_t                                     stamp;
 
-   bool                                         threaded;
    VkResult                                     status;
    struct wsi_queue                             present_queue;
    struct wsi_queue                             acquire_queue;
@@ -551,8 +549,11 @@ x11_handle_dri3_present_event(struct x11_swapchain *chain,
       for (unsigned i = 0; i < chain->image_count; i++) {
          if (chain->images[i].pixmap == idle->pixmap) {
             chain->images[i].busy = false;
-            if (chain->threaded)
-               wsi_queue_push(&chain->acquire_queue, i);
+            /* Wait for the fence here, on the queue manager thread, so
+             * that acquiring the image never blocks.
+             */
+            xshmfence_await(chain->images[i].shm_fence);
+            wsi_queue_push(&chain->acquire_queue, i);
             break;
          }
       }
@@ -575,102 +576,23 @@ x11_handle_dri3_present_event(struct x11_swapchain *chain,
 }
 
 
-static uint64_t wsi_get_current_time(void)
-{
-   uint64_t current_time;
-   struct timespec tv;
-
-   clock_gettime(CLOCK_MONOTONIC, &tv);
-   current_time = tv.tv_nsec + tv.tv_sec*1000000000ull;
-   return current_time;
-}
-
-static uint64_t wsi_get_absolute_timeout(uint64_t timeout)
-{
-   uint64_t current_time = wsi_get_current_time();
-
-   timeout = MIN2(UINT64_MAX - current_time, timeout);
-
-   return current_time + timeout;
-}
-
-static VkResult
-x11_acquire_next_image_poll_x11(struct x11_swapchain *chain,
-                                uint32_t *image_index, uint64_t timeout)
-{
-   xcb_generic_event_t *event;
-   struct pollfd pfds;
-   uint64_t atimeout;
-   while (1) {
-      for (uint32_t i = 0; i < chain->image_count; i++) {
-         if (!chain->images[i].busy) {
-            /* We found a non-busy image */
-            xshmfence_await(chain->images[i].shm_fence);
-            *image_index = i;
-            chain->images[i].busy = true;
-            return VK_SUCCESS;
-         }
-      }
-
-      xcb_flush(chain->conn);
-
-      if (timeout == UINT64_MAX) {
-         event = xcb_wait_for_special_event(chain->conn, chain->special_event);
-         if (!event)
-            return VK_ERROR_OUT_OF_DATE_KHR;
-      } else {
-         event = xcb_poll_for_special_event(chain->conn, chain->special_event);
-         if (!event) {
-            int ret;
-            if (timeout == 0)
-               return VK_NOT_READY;
-
-            atimeout = wsi_get_absolute_timeout(timeout);
-
-            pfds.fd = xcb_get_file_descriptor(chain->conn);
-            pfds.events = POLLIN;
-            ret = poll(&pfds, 1, timeout / 1000 / 1000);
-            if (ret == 0)
-               return VK_TIMEOUT;
-            if (ret == -1)
-               return VK_ERROR_OUT_OF_DATE_KHR;
-
-            /* If a non-special event happens, the fd will still
-             * poll. So recalculate the timeout now just in case.
-             */
-            uint64_t current_time = wsi_get_current_time();
-            if (atimeout > current_time)
-               timeout = atimeout - current_time;
-            else
-               timeout = 0;
-            continue;
-         }
-      }
-
-      VkResult result = x11_handle_dri3_present_event(chain, (void *)event);
-      free(event);
-      if (result != VK_SUCCESS)
-         return result;
-   }
-}
-
 static VkResult
 x11_acquire_next_image_from_queue(struct x11_swapchain *chain,
                                   uint32_t *image_index_out, uint64_t timeout)
 {
-   assert(chain->threaded);
-
    uint32_t image_index;
    VkResult result = wsi_queue_pull(&chain->acquire_queue,
                                     &image_index, timeout);
-   if (result != VK_SUCCESS) {
+   if (result == VK_TIMEOUT && timeout == 0) {
+      return VK_NOT_READY;
+   } else if (result != VK_SUCCESS) {
       return result;
    } else if (chain->status != VK_SUCCESS) {
       return chain->status;
    }
 
+   /* The queue manager already waited for the image's fence. */
    assert(image_index < chain->image_count);
-   xshmfence_await(chain->images[image_index].shm_fence);
 
    *image_index_out = image_index;
 
@@ -728,11 +650,7 @@ x11_acquire_next_image(struct wsi_swapchain *anv_chain,
 {
    struct x11_swapchain *chain = (struct x11_swapchain *)anv_chain;
 
-   if (chain->threaded) {
-      return x11_acquire_next_image_from_queue(chain, image_index, timeout);
-   } else {
-      return x11_acquire_next_image_poll_x11(chain, image_index, timeout);
-   }
+   return x11_acquire_next_image_from_queue(chain, image_index, timeout);
 }
 
 static VkResult
@@ -741,14 +659,50 @@ x11_queue_present(struct wsi_swapchain *anv_chain,
 {
    struct x11_swapchain *chain = (struct x11_swapchain *)anv_chain;
 
-   if (chain->threaded) {
+   if (chain->base.present_mode == VK_PRESENT_MODE_FIFO_KHR) {
       wsi_queue_push(&chain->present_queue, image_index);
       return chain->status;
    } else {
-      return x11_present_to_x11(chain, image_index, 0);
+      VkResult result = x11_present_to_x11(chain, image_index, 0);
+      if (result != VK_SUCCESS)
+         return result;
+      return chain->status;
    }
 }
 
+/* Queue manager for the MAILBOX and IMMEDIATE modes: presents don't wait
+ * for anything, so they are sent right from vkQueuePresentKHR, and this
+ * thread only turns IDLE_NOTIFY events into acquirable images.
+ */
+static void *
+x11_manage_event_queue(void *state)
+{
+   struct x11_swapchain *chain = state;
+   VkResult result = VK_SUCCESS;
+
+   assert(chain->base.present_mode != VK_PRESENT_MODE_FIFO_KHR);
+
+   while (chain->status == VK_SUCCESS) {
+      xcb_generic_event_t *event =
+         xcb_wait_for_special_event(chain->conn, chain->special_event);
+      if (!event) {
+         result = VK_ERROR_OUT_OF_DATE_KHR;
+         break;
+      }
+
+      result = x11_handle_dri3_present_event(chain, (void *)event);
+      free(event);
+      if (result != VK_SUCCESS)
+         break;
+   }
+
+   if (result != VK_SUCCESS)
+      chain->status = result;
+   wsi_queue_push(&chain->acquire_queue, UINT32_MAX);
+
+   return NULL;
+}
+
 static void *
 x11_manage_fifo_queues(void *state)
 {
@@ -893,17 +847,23 @@ x11_swapchain_destroy(struct wsi_swapchain *anv_chain,
    struct x11_swapchain *chain = (struct x11_swapchain *)anv_chain;
    xcb_void_cookie_t cookie;
 
-   for (uint32_t i = 0; i < chain->image_count; i++)
-      x11_image_finish(chain, pAllocator, &chain->images[i]);
-
-   if (chain->threaded) {
-      chain->status = VK_ERROR_OUT_OF_DATE_KHR;
+   chain->status = VK_ERROR_OUT_OF_DATE_KHR;
+   if (chain->base.present_mode == VK_PRESENT_MODE_FIFO_KHR) {
       /* Push a UINT32_MAX to wake up the manager */
       wsi_queue_push(&chain->present_queue, UINT32_MAX);
-      pthread_join(chain->queue_manager, NULL);
-      wsi_queue_destroy(&chain->acquire_queue);
-      wsi_queue_destroy(&chain->present_queue);
+   } else {
+      /* The manager waits for present events; ask for one. */
+      cookie = xcb_present_notify_msc(chain->conn, chain->window,
+                                      0, 0, 0, 0);
+      xcb_discard_reply(chain->conn, cookie.sequence);
+      xcb_flush(chain->conn);
    }
+   pthread_join(chain->queue_manager, NULL);
+   wsi_queue_destroy(&chain->acquire_queue);
+   wsi_queue_destroy(&chain->present_queue);
+
+   for (uint32_t i = 0; i < chain->image_count; i++)
+      x11_image_finish(chain, pAllocator, &chain->images[i]);
 
    xcb_unregister_for_special_event(chain->conn, chain->special_event);
    cookie = xcb_present_select_input_checked(chain->conn, chain->event_id,
@@ -961,7 +921,6 @@ x11_surface_create_swapchain(VkIcdSurfaceBase *icd_surface,
    chain->image_count = num_images;
    chain->send_sbc = 0;
    chain->last_present_msc = 0;
-   chain->threaded = false;
    chain->status = VK_SUCCESS;
 
    free(geometry);
@@ -1001,35 +960,37 @@ x11_surface_create_swapchain(VkIcdSurfaceBase *icd_surface,
          goto fail_init_images;
    }
 
-   if (chain->base.present_mode == VK_PRESENT_MODE_FIFO_KHR) {
-      chain->threaded = true;
-
-      /* Initialize our queues.  We make them image_count + 1 because we will
-       * occasionally use UINT32_MAX to signal the other thread that an error
-       * has occurred and we don't want an overflow.
-       */
-      int ret;
-      ret = wsi_queue_init(&chain->acquire_queue, chain->image_count + 1);
-      if (ret) {
-         goto fail_init_images;
-      }
+   /* Every present mode gets a queue manager thread, which waits for the
+    * X server to release images, so that vkAcquireNextImageKHR only has to
+    * pull an idle image from a queue.
+    *
+    * Initialize our queues.  We make them image_count + 1 because we will
+    * occasionally use UINT32_MAX to signal the other thread that an error
+    * has occurred and we don't want an overflow.
+    */
+   int ret;
+   ret = wsi_queue_init(&chain->acquire_queue, chain->image_count + 1);
+   if (ret) {
+      goto fail_init_images;
+   }
 
-      ret = wsi_queue_init(&chain->present_queue, chain->image_count + 1);
-      if (ret) {
-         wsi_queue_destroy(&chain->acquire_queue);
-         goto fail_init_images;
-      }
+   ret = wsi_queue_init(&chain->present_queue, chain->image_count + 1);
+   if (ret) {
+      wsi_queue_destroy(&chain->acquire_queue);
+      goto fail_init_images;
+   }
 
-      for (unsigned i = 0; i < chain->image_count; i++)
-         wsi_queue_push(&chain->acquire_queue, i);
+   for (unsigned i = 0; i < chain->image_count; i++)
+      wsi_queue_push(&chain->acquire_queue, i);
 
-      ret = pthread_create(&chain->queue_manager, NULL,
-                           x11_manage_fifo_queues, chain);
-      if (ret) {
-         wsi_queue_destroy(&chain->present_queue);
-         wsi_queue_destroy(&chain->acquire_queue);
-         goto fail_init_images;
-      }
+   ret = pthread_create(&chain->queue_manager, NULL,
+                        chain->base.present_mode == VK_PRESENT_MODE_FIFO_KHR ?
+                        x11_manage_fifo_queues : x11_manage_event_queue,
+                        chain);
+   if (ret) {
+      wsi_queue_destroy(&chain->present_queue);
+      wsi_queue_destroy(&chain->acquire_queue);
+      goto fail_init_images;
    }
 
    *swapchain_out = &chain->base;